@@ -0,0 +1,707 @@
+/*
+  Filename: capacity_sim.cpp
+  Accelerated-time fleet capacity simulator (Linux host)
+
+  Description: Answers "with this threshold and capture length, how many
+               events a day, how long until the card is full, and how long
+               will the offload take?" without deploying. A statistical
+               road profile (trips a day, road classes with their own bump
+               rate and size, loading impacts at each stop) drives a
+               discrete-event model of the receiver's trigger. The model
+               runs on the native build's virtual clock (SimHost.h), so
+               millis() and delay() cost nothing and a week takes seconds.
+
+               What it models, from the firmware:
+                 - loop() reads the LIS3DH every sensor.interval_ms and
+                   triggers on any axis above event.threshold_g. Gravity
+                   sits on Z and the LIS3DH saturates at +-2 g, so short or
+                   clipped bumps are missed the way they are on the truck.
+                 - captureEvent() pairs one accel read with each NAU7802
+                   conversion for event.duration_ms or event.max_samples,
+                   then reads the SHT45 and saves. Bumps during a capture
+                   and its save are inside that event.
+               What it runs, unchanged: EventLogger_Module::saveEventCsv()
+               and SDCard_Module against the native SD folder, so the bytes,
+               file names and SD operations (the getNextEventNumber() scan
+               included) are the firmware's own. Offloads replay the LoRa
+               and Wi-Fi stream loops over the files on the card, with
+               CsvChunker and the SX1262 time on air, then clear the card
+               as the firmware does.
+
+               SD, SHT45 and Wi-Fi times are model parameters (defaults are
+               typical; calibrate them against the 'p' metrics of a real
+               unit). Firmware serial output goes to serial.txt in the run
+               directory; the report goes to stdout.
+
+               Arguments are name=value, with the receiver's SET: names
+               where one exists:
+                 days=7 seed=1
+                 event.threshold_g=2.0 event.duration_ms=2000
+                 event.max_samples=80 sensor.interval_ms=100 nau.rate_sps=20
+                 lora.sf=9 lora.bw_khz=125 lora.cr=7
+                 trips_per_day=3 trip_hours=2.5 roughness=1 stop_impacts=8
+                 offload_days=7 (0: never) card_gb=16
+                 sd_open_ms=1.5 sd_close_ms=8 sd_write_kbps=300 sht_ms=10
+                 wifi_kbps=500 site_connect_s=5 softap_connect_s=3
+
+  Build/run (from the Native folder):
+    g++ -O2 -std=gnu++17 -pthread -Isrc $(find ../Shared -mindepth 1 -maxdepth 1 -type d -printf "-I%p ") \
+        -I"../Receiver Firmware/src" examples/capacity_sim/capacity_sim.cpp \
+        $(ls src/[A-Z]*.cpp | grep -v NativeMain) \
+        "../Receiver Firmware/src/EventLogger_Module.cpp" "../Receiver Firmware/src/SDCard_Module.cpp" \
+        -o capacity_sim
+    ./capacity_sim days=28 event.threshold_g=1.5 event.duration_ms=4000
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "main.h"
+#include "SimHost.h"
+
+#define CAP_DIR_DEFAULT        "/tmp/wabash-capacity"
+#define CAP_START_EPOCH        1767571200    // 2026-01-05 00:00, printed like getFormattedTime()
+#define CAP_DAY_US             86400000000ULL
+#define CAP_DAY_START_H        5.0           // Trips run between these hours
+#define CAP_DAY_END_H          21.0
+#define CAP_SEGMENT_MEAN_S     600.0         // Mean length of one stretch of a road class
+#define CAP_DOCK_WINDOW_S      1200.0        // Loading impacts spread over this after a trip
+#define CAP_RANGE_G            (2.0 * 2047.0 / 2048.0)   // LIS3DH +-2 g, 12-bit: largest reading
+#define CAP_FAT_DIR_ENTRIES    65536         // 32-byte entries one FAT directory can hold
+#define CAP_FAT_LFN_CHARS      13            // Name characters per long-file-name entry
+#define CAP_LORA_FILE_GAP_MS   10            // streamStoredEventsOverLoRa(): after the file marker
+#define CAP_LORA_CHUNK_GAP_MS  10            // sendCsvChunkOverLoRa(): after DATC:
+#define CAP_LORA_FINAL_GAP_MS  15            // ... and after DATA:
+#define CAP_WIFI_LINE_GAP_MS   5             // startWifiLocalOffload(): after each DATA: line
+
+struct Settings {
+  double days = 7;
+  double seed = 1;
+  double thresholdG = 2.0;         // main.cpp defaults
+  double durationMs = 2000;
+  double maxSamples = EVENT_MAX_SAMPLES;
+  double intervalMs = 100;
+  double nauRateSps = 20;
+  double loraSf = LORA_SPREADING_FACTOR;
+  double loraBwKhz = LORA_BANDWIDTH_KHZ;
+  double loraCr = LORA_CODING_RATE;
+  double tripsPerDay = 3;
+  double tripHours = 2.5;
+  double roughness = 1;
+  double stopImpacts = 8;
+  double offloadDays = 7;
+  double cardGb = SIM_SD_CARD_BYTES / 1e9;
+  double sdOpenMs = 1.5;
+  double sdCloseMs = 8;
+  double sdWriteKBps = 300;
+  double shtMs = 10;
+  double wifiKBps = 500;
+  double siteConnectS = 5;
+  double softApConnectS = 3;
+};
+
+struct SettingName {
+  const char* name;
+  double Settings::*field;
+};
+
+static const SettingName kSettingNames[] = {
+  {"days", &Settings::days},
+  {"seed", &Settings::seed},
+  {"event.threshold_g", &Settings::thresholdG},
+  {"event.duration_ms", &Settings::durationMs},
+  {"event.max_samples", &Settings::maxSamples},
+  {"sensor.interval_ms", &Settings::intervalMs},
+  {"nau.rate_sps", &Settings::nauRateSps},
+  {"lora.sf", &Settings::loraSf},
+  {"lora.bw_khz", &Settings::loraBwKhz},
+  {"lora.cr", &Settings::loraCr},
+  {"trips_per_day", &Settings::tripsPerDay},
+  {"trip_hours", &Settings::tripHours},
+  {"roughness", &Settings::roughness},
+  {"stop_impacts", &Settings::stopImpacts},
+  {"offload_days", &Settings::offloadDays},
+  {"card_gb", &Settings::cardGb},
+  {"sd_open_ms", &Settings::sdOpenMs},
+  {"sd_close_ms", &Settings::sdCloseMs},
+  {"sd_write_kbps", &Settings::sdWriteKBps},
+  {"sht_ms", &Settings::shtMs},
+  {"wifi_kbps", &Settings::wifiKBps},
+  {"site_connect_s", &Settings::siteConnectS},
+  {"softap_connect_s", &Settings::softApConnectS},
+};
+
+// Vertical bump sizes are log-normal: median and spread (sigma of the log)
+struct RoadClass {
+  const char* name;
+  double share;             // Of driving time
+  double impactsPerHour;    // At roughness 1
+  double medianG;
+  double sigma;
+};
+
+static const RoadClass kRoads[] = {
+  {"highway",  0.55,  40.0, 0.30, 0.45},
+  {"arterial", 0.30, 120.0, 0.40, 0.50},
+  {"rough",    0.15, 300.0, 0.55, 0.55},   // Gravel, yards, rail crossings
+};
+static const RoadClass kDock = {"dock", 0.0, 0.0, 0.90, 0.50};   // Forklift over the dock plate
+
+#define CAP_WIDTH_MEDIAN_MS  40.0    // Half-sine pulse length, log-normal
+#define CAP_WIDTH_SIGMA      0.6
+#define CAP_DOCK_WIDTH_MS    80.0
+
+struct Impact {
+  uint64_t atUs;
+  float verticalG;          // Signed: added to the 1 g on Z
+  float lateralG;
+  uint8_t lateralAxis;      // 0 = X, 1 = Y
+  float widthMs;
+  float loadUe;             // Static strain of the trip's load
+};
+
+struct DayStats {
+  uint32_t trips = 0;
+  double driveHours = 0;
+  uint32_t impacts = 0;
+  uint32_t overThreshold = 0;   // True peak above the threshold
+  uint32_t clipped = 0;         // ... but the LIS3DH saturates below it
+  uint32_t betweenSamples = 0;  // ... and no read landed on it
+  uint32_t inCapture = 0;       // Arrived during a capture or save
+  uint32_t events = 0;
+  uint32_t saveFailures = 0;
+  uint64_t bytes = 0;
+  uint64_t sdOpens = 0;
+  double saveMsMax = 0;
+  double saveMsTotal = 0;
+};
+
+struct OffloadStats {
+  uint32_t day;
+  uint32_t files = 0;
+  uint64_t bytes = 0;
+  uint64_t allocated = 0;
+  uint32_t loraPackets = 0;
+  double loraS = 0;
+  uint32_t wifiLines = 0;
+  uint64_t wifiBytes = 0;
+};
+
+static Settings g_settings;
+static std::mt19937 g_random;
+static FILE* g_out = stdout;
+
+SPIClass spiSD(HSPI);
+SDCard_Module sdCard(&spiSD, SDCARD_CS);
+EventLogger_Module eventLogger(&sdCard);
+SX1262 loraRadio = new Module(LORA_NSS, LORA_DIO1, LORA_RST, LORA_BUSY);
+
+static bool parseSetting(const char* arg) {
+  const char* eq = strchr(arg, '=');
+  if (eq == nullptr) {
+    return false;
+  }
+  for (const SettingName& setting : kSettingNames) {
+    if (strlen(setting.name) == (size_t)(eq - arg) && strncmp(setting.name, arg, eq - arg) == 0) {
+      g_settings.*setting.field = atof(eq + 1);
+      return true;
+    }
+  }
+  return false;
+}
+
+static double uniform(double lo, double hi) {
+  return std::uniform_real_distribution<double>(lo, hi)(g_random);
+}
+
+static double exponential(double rate) {
+  return std::exponential_distribution<double>(rate)(g_random);
+}
+
+static double logNormal(double median, double sigma) {
+  return std::lognormal_distribution<double>(std::log(median), sigma)(g_random);
+}
+
+static Impact makeImpact(double atS, const RoadClass& road, double widthMedianMs, float loadUe) {
+  Impact impact;
+  impact.atUs = (uint64_t)(atS * 1e6);
+  double g = logNormal(road.medianG, road.sigma);
+  impact.verticalG = (float)((uniform(0, 1) < 0.6) ? g : -g);   // Bumps lift more often than they drop
+  impact.lateralG = (float)(g * uniform(0.0, 0.4) * ((uniform(0, 1) < 0.5) ? 1 : -1));
+  impact.lateralAxis = (uniform(0, 1) < 0.5) ? 0 : 1;
+  impact.widthMs = (float)std::min(400.0, std::max(5.0, logNormal(widthMedianMs, CAP_WIDTH_SIGMA)));
+  impact.loadUe = loadUe;
+  return impact;
+}
+
+static const RoadClass& pickRoad() {
+  double r = uniform(0, 1);
+  for (const RoadClass& road : kRoads) {
+    if (r < road.share) {
+      return road;
+    }
+    r -= road.share;
+  }
+  return kRoads[0];
+}
+
+/**
+ * One day of trips: start times spread over the working day, each trip a
+ * run of road-class stretches, each ending with loading at a dock
+ */
+static void generateDay(uint32_t day, std::vector<Impact>& impacts, DayStats& stats) {
+  impacts.clear();
+  uint32_t trips = std::poisson_distribution<uint32_t>(g_settings.tripsPerDay)(g_random);
+  double daySpanS = (CAP_DAY_END_H - CAP_DAY_START_H) * 3600.0;
+  double slotS = (trips > 0) ? daySpanS / trips : daySpanS;
+  double dayStartS = (double)day * 86400.0 + CAP_DAY_START_H * 3600.0;
+
+  for (uint32_t trip = 0; trip < trips; trip++) {
+    double lengthS = std::min(slotS - CAP_DOCK_WINDOW_S, g_settings.tripHours * 3600.0 * logNormal(1.0, 0.3));
+    if (lengthS <= 0) {
+      continue;
+    }
+    double startS = dayStartS + trip * slotS + uniform(0, slotS - lengthS - CAP_DOCK_WINDOW_S);
+    double endS = startS + lengthS;
+    float loadUe = (float)uniform(80.0, 300.0);
+    stats.trips++;
+    stats.driveHours += lengthS / 3600.0;
+
+    for (double t = startS; t < endS;) {
+      const RoadClass& road = pickRoad();
+      double stretchEnd = std::min(endS, t + exponential(1.0 / CAP_SEGMENT_MEAN_S));
+      double rate = road.impactsPerHour * g_settings.roughness / 3600.0;
+      if (rate > 0) {
+        for (double at = t + exponential(rate); at < stretchEnd; at += exponential(rate)) {
+          impacts.push_back(makeImpact(at, road, CAP_WIDTH_MEDIAN_MS, loadUe));
+        }
+      }
+      t = stretchEnd;
+    }
+
+    uint32_t dockImpacts = std::poisson_distribution<uint32_t>(g_settings.stopImpacts)(g_random);
+    for (uint32_t i = 0; i < dockImpacts; i++) {
+      impacts.push_back(makeImpact(endS + uniform(0, CAP_DOCK_WINDOW_S), kDock, CAP_DOCK_WIDTH_MS, loadUe));
+    }
+  }
+  std::sort(impacts.begin(), impacts.end(), [](const Impact& a, const Impact& b) { return a.atUs < b.atUs; });
+  stats.impacts = (uint32_t)impacts.size();
+}
+
+static float clampReading(double g) {
+  return (float)std::max(-CAP_RANGE_G, std::min(CAP_RANGE_G, g));
+}
+
+/**
+ * What the LIS3DH reads at atUs, from one impact
+ * @param decay false: the half-sine pulse; true: the ring-down after it (capture samples)
+ */
+static void readingAt(const Impact& impact, uint64_t atUs, bool decay, float& x, float& y, float& z) {
+  double dtS = ((double)atUs - (double)impact.atUs) / 1e6;
+  double widthS = impact.widthMs / 1000.0;
+  double shape = 0.0;
+  if (dtS >= 0 && dtS <= widthS) {
+    shape = std::sin(M_PI * dtS / widthS);
+  } else if (decay && dtS > widthS) {
+    shape = std::exp(-(dtS - widthS) / 0.15) * std::cos(2.0 * M_PI * 8.0 * (dtS - widthS));
+  }
+  double lateral = impact.lateralG * shape;
+  x = clampReading(((impact.lateralAxis == 0) ? lateral : 0.0) + (decay ? uniform(-0.01, 0.01) : 0.0));
+  y = clampReading(((impact.lateralAxis == 1) ? lateral : 0.0) + (decay ? uniform(-0.01, 0.01) : 0.0));
+  z = clampReading(1.0 + impact.verticalG * shape + (decay ? uniform(-0.01, 0.01) : 0.0));
+}
+
+static bool overThreshold(float x, float y, float z) {
+  double threshold = g_settings.thresholdG;
+  return std::fabs(x) > threshold || std::fabs(y) > threshold || std::fabs(z) > threshold;
+}
+
+static double trueMaxG(const Impact& impact) {
+  return std::max(std::fabs(1.0 + impact.verticalG), (double)std::fabs(impact.lateralG));
+}
+
+static const char* formatTimestamp(char* out, size_t outSize) {
+  time_t at = (time_t)(CAP_START_EPOCH + sim::bootUs() / 1000000ULL);
+  struct tm timeinfo;
+  gmtime_r(&at, &timeinfo);
+  strftime(out, outSize, "%Y-%m-%d %H:%M:%S EST", &timeinfo);
+  return out;
+}
+
+/**
+ * captureEvent() from the trigger read on: paired samples, SHT45, save
+ * @return the save time charged, ms
+ */
+static double captureAndSave(const Impact& impact, uint64_t triggerUs, float tx, float ty, float tz, DayStats& stats) {
+  static EventLogger_Module::EventSample samples[EVENT_SAMPLE_CAPACITY];
+  sim::advanceUs(triggerUs - sim::bootUs());
+
+  uint32_t maxSamples = std::min<uint32_t>((uint32_t)g_settings.maxSamples, EVENT_SAMPLE_CAPACITY);
+  double pairMs = 1000.0 / g_settings.nauRateSps;   // readStrainTimed() waits for each conversion
+  uint32_t count = 1 + (uint32_t)std::ceil(g_settings.durationMs / pairMs);
+  count = std::min(count, maxSamples);
+
+  samples[0] = {tx, ty, tz, impact.loadUe};
+  for (uint32_t i = 1; i < count; i++) {
+    uint64_t atUs = triggerUs + (uint64_t)(i * pairMs * 1000.0);
+    readingAt(impact, atUs, true, samples[i].x, samples[i].y, samples[i].z);
+    samples[i].strainMicro = impact.loadUe + 40.0f * (samples[i].z - 1.0f) + (float)uniform(-0.5, 0.5);
+  }
+  sim::advanceUs((uint64_t)((count - 1) * pairMs * 1000.0));
+
+  // Temperature and humidity follow the time of day
+  double hour = (double)(sim::bootUs() % CAP_DAY_US) / 3.6e9;
+  float temp = (float)(12.0 + 8.0 * std::sin(2.0 * M_PI * (hour - 9.0) / 24.0));
+  float humidity = (float)(60.0 - 15.0 * std::sin(2.0 * M_PI * (hour - 9.0) / 24.0));
+
+  char timeText[TIME_TEXT_SIZE];
+  fs::OpCounts before = fs::opCounts();
+  bool saved = eventLogger.saveEventCsv(samples, (int)count, temp, humidity, formatTimestamp(timeText, sizeof(timeText)));
+  fs::OpCounts after = fs::opCounts();
+
+  uint64_t opens = after.opens - before.opens;
+  uint64_t written = after.bytesWritten - before.bytesWritten;
+  double saveMs = g_settings.shtMs + opens * g_settings.sdOpenMs + g_settings.sdCloseMs +
+                  (double)written / (g_settings.sdWriteKBps * 1.024);
+  sim::advanceUs((uint64_t)(saveMs * 1000.0));
+
+  if (saved) {
+    stats.events++;
+  } else {
+    stats.saveFailures++;
+  }
+  stats.bytes += written;
+  stats.saveMsMax = std::max(stats.saveMsMax, saveMs);
+  stats.saveMsTotal += saveMs;
+  return saveMs;
+}
+
+/**
+ * loop()'s trigger check over one day of impacts
+ */
+static void runDay(const std::vector<Impact>& impacts, DayStats& stats) {
+  uint64_t intervalUs = (uint64_t)(g_settings.intervalMs * 1000.0);
+  uint64_t busyUntilUs = sim::bootUs();
+  uint64_t gridUs = busyUntilUs;   // loop() reads on this grid until the next capture
+  fs::OpCounts start = fs::opCounts();
+
+  for (const Impact& impact : impacts) {
+    bool overTrue = trueMaxG(impact) > g_settings.thresholdG;
+    if (overTrue) {
+      stats.overThreshold++;
+      if (std::min(trueMaxG(impact), CAP_RANGE_G) <= g_settings.thresholdG) {
+        stats.clipped++;
+      }
+    }
+    if (impact.atUs < busyUntilUs) {
+      stats.inCapture++;
+      continue;
+    }
+
+    uint64_t endUs = impact.atUs + (uint64_t)(impact.widthMs * 1000.0f);
+    uint64_t readUs = gridUs + (impact.atUs - gridUs + intervalUs - 1) / intervalUs * intervalUs;
+    bool triggered = false;
+    for (; readUs <= endUs; readUs += intervalUs) {
+      float x, y, z;
+      readingAt(impact, readUs, false, x, y, z);
+      if (overThreshold(x, y, z)) {
+        captureAndSave(impact, readUs, x, y, z, stats);
+        busyUntilUs = sim::bootUs();
+        gridUs = busyUntilUs;
+        triggered = true;
+        break;
+      }
+    }
+    if (!triggered && overTrue && std::min(trueMaxG(impact), CAP_RANGE_G) > g_settings.thresholdG) {
+      stats.betweenSamples++;
+    }
+  }
+  stats.sdOpens = fs::opCounts().opens - start.opens;
+}
+
+/**
+ * The LoRa and Wi-Fi stream loops over every event file, then the
+ * post-offload clear
+ */
+static OffloadStats offload(uint32_t day) {
+  OffloadStats stats;
+  stats.day = day;
+  if (!sdCard.fileExists("/events")) {
+    return stats;
+  }
+  File root = SD.open("/events");
+  if (!root || !root.isDirectory()) {
+    return stats;
+  }
+
+  uint32_t turnaroundUs = SIM_LORA_DEFAULT_TURNAROUND_US;
+  auto loraPacket = [&stats, turnaroundUs](size_t len, uint32_t gapMs) {
+    stats.loraPackets++;
+    stats.loraS += (turnaroundUs + loraRadio.getTimeOnAir(len)) / 1e6 + gapMs / 1000.0;
+  };
+  auto chunkSent = [&loraPacket](const char* data, size_t len, bool finalChunk) {
+    (void)data;
+    loraPacket(5 + len, finalChunk ? CAP_LORA_FINAL_GAP_MS : CAP_LORA_CHUNK_GAP_MS);
+  };
+  static CsvChunker<LORA_DATA_CHUNK_SIZE> chunker("timestamp,");
+  static char block[LINE_POOL_BLOCK_BYTES];
+  std::string line;
+
+  File file = root.openNextFile();
+  while (file) {
+    const char* name = file.name();
+    size_t nameLen = strlen(name);
+    if (!file.isDirectory() && strncmp(name, "event ", 6) == 0 && nameLen >= 4 &&
+        strcmp(name + nameLen - 4, ".csv") == 0) {
+      stats.files++;
+      stats.bytes += file.size();
+      stats.allocated += (file.size() + SIM_SD_CLUSTER_BYTES - 1) / SIM_SD_CLUSTER_BYTES * SIM_SD_CLUSTER_BYTES;
+
+      loraPacket(strlen("DATA:EVENT_FILE:") + nameLen, CAP_LORA_FILE_GAP_MS);
+      stats.wifiLines++;
+      stats.wifiBytes += strlen("DATA:EVENT_FILE:") + nameLen + 2;
+
+      chunker.reset();
+      size_t got;
+      while ((got = file.read((uint8_t*)block, sizeof(block))) > 0) {
+        chunker.push(block, got, chunkSent);
+        // Wi-Fi sends whole lines: "DATA:" + line + CRLF
+        for (size_t i = 0; i < got; i++) {
+          if (block[i] != '\n') {
+            line += block[i];
+            continue;
+          }
+          if (!line.empty() && line.compare(0, 10, "timestamp,") != 0) {
+            stats.wifiLines++;
+            stats.wifiBytes += 5 + line.size() + 2;
+          }
+          line.clear();
+        }
+      }
+      chunker.finish(chunkSent);
+      if (!line.empty()) {
+        stats.wifiLines++;
+        stats.wifiBytes += 5 + line.size() + 2;
+        line.clear();
+      }
+    }
+    file.close();
+    file = root.openNextFile();
+  }
+  root.close();
+
+  sdCard.deleteAllFilesInDirectory("/events");
+  return stats;
+}
+
+/**
+ * Event files one FAT directory holds: "event N.csv" is not an 8.3 name, so
+ * each takes a short entry plus one long-name entry per 13 characters
+ */
+static uint32_t filesPerDirectory() {
+  uint32_t entries = 2;   // "." and ".."
+  uint32_t files = 0;
+  for (;;) {
+    char name[32];
+    int nameLen = snprintf(name, sizeof(name), "event %u.csv", files + 1);
+    uint32_t need = 1 + (uint32_t)((nameLen + CAP_FAT_LFN_CHARS - 1) / CAP_FAT_LFN_CHARS);
+    if (entries + need > CAP_FAT_DIR_ENTRIES) {
+      return files;
+    }
+    entries += need;
+    files++;
+  }
+}
+
+static double wifiSeconds(const OffloadStats& stats, double connectS) {
+  return connectS + stats.wifiLines * CAP_WIFI_LINE_GAP_MS / 1000.0 + stats.wifiBytes / (g_settings.wifiKBps * 1024.0);
+}
+
+static void printDuration(char* out, size_t outSize, double seconds) {
+  if (seconds < 120) {
+    snprintf(out, outSize, "%.1f s", seconds);
+  } else if (seconds < 7200) {
+    snprintf(out, outSize, "%.1f min", seconds / 60.0);
+  } else {
+    snprintf(out, outSize, "%.1f h", seconds / 3600.0);
+  }
+}
+
+int main(int argc, char** argv) {
+  for (int i = 1; i < argc; i++) {
+    if (!parseSetting(argv[i])) {
+      fprintf(stderr, "unknown argument %s; names are:", argv[i]);
+      for (const SettingName& setting : kSettingNames) {
+        fprintf(stderr, " %s", setting.name);
+      }
+      fprintf(stderr, "\n");
+      return 2;
+    }
+  }
+  Settings& s = g_settings;
+  if (s.days < 1 || s.intervalMs < 1 || s.nauRateSps <= 0 || s.maxSamples < 2 || s.sdWriteKBps <= 0 ||
+      s.wifiKBps <= 0) {
+    fprintf(stderr, "days, sensor.interval_ms, nau.rate_sps, event.max_samples and the rates must be positive\n");
+    return 2;
+  }
+  g_random.seed((uint32_t)s.seed);
+
+  // The run directory holds the simulated card and the firmware's serial output
+  if (getenv("WABASH_SIM_DIR") == nullptr) {
+    setenv("WABASH_SIM_DIR", CAP_DIR_DEFAULT, 1);
+  }
+  setenv("WABASH_SIM_NODE", "capacity", 1);
+  setenv("WABASH_SIM_QUIET", "1", 1);
+  sim::useVirtualClock();
+  std::string serialLog = sim::nodePath("") + "/serial.txt";
+  g_out = fdopen(dup(STDOUT_FILENO), "w");
+  if (g_out == nullptr || freopen(serialLog.c_str(), "w", stdout) == nullptr) {
+    fprintf(stderr, "cannot redirect serial output to %s\n", serialLog.c_str());
+    return 2;
+  }
+
+  if (!sdCard.begin()) {
+    fprintf(stderr, "SD begin failed\n");
+    return 2;
+  }
+  sdCard.deleteAllFilesInDirectory("/events");
+  if (loraRadio.setSpreadingFactor((uint8_t)s.loraSf) != RADIOLIB_ERR_NONE ||
+      loraRadio.setBandwidth((float)s.loraBwKhz) != RADIOLIB_ERR_NONE ||
+      loraRadio.setCodingRate((uint8_t)s.loraCr) != RADIOLIB_ERR_NONE) {
+    fprintf(stderr, "unsupported LoRa settings\n");
+    return 2;
+  }
+  loraRadio.setPreambleLength(LORA_PREAMBLE_LEN);
+
+  fprintf(g_out, "=== CAPACITY SIM days=%.0f seed=%.0f ===\n", s.days, s.seed);
+  fprintf(g_out, "receiver: threshold %.2f g, capture %.0f ms / %.0f samples max, read every %.0f ms, NAU7802 %.0f SPS\n",
+          s.thresholdG, s.durationMs, s.maxSamples, s.intervalMs, s.nauRateSps);
+  fprintf(g_out, "road:     %.1f trips/day of %.1f h, roughness %.2f, %.0f dock impacts per stop\n",
+          s.tripsPerDay, s.tripHours, s.roughness, s.stopImpacts);
+  if (s.offloadDays >= 1) {
+    fprintf(g_out, "offload:  every %.0f days\n\n", s.offloadDays);
+  } else {
+    fprintf(g_out, "offload:  at the end only\n\n");
+  }
+  fprintf(g_out, "%4s %5s %7s %8s %8s %7s %7s %7s %7s %9s %8s %8s\n", "day", "trips", "drive_h", "impacts",
+          "over_thr", "clipped", "between", "in_capt", "events", "kB_saved", "sd_opens", "save_max");
+
+  auto hostStart = std::chrono::steady_clock::now();
+  std::vector<Impact> impacts;
+  std::vector<OffloadStats> offloads;
+  DayStats total;
+  uint32_t days = (uint32_t)s.days;
+  for (uint32_t day = 0; day < days; day++) {
+    DayStats stats;
+    generateDay(day, impacts, stats);
+    runDay(impacts, stats);
+    uint64_t dayEndUs = (uint64_t)(day + 1) * CAP_DAY_US;
+    if (sim::bootUs() < dayEndUs) {
+      sim::advanceUs(dayEndUs - sim::bootUs());
+    }
+
+    fprintf(g_out, "%4u %5u %7.1f %8u %8u %7u %7u %7u %7u %9.1f %8llu %5.0f ms\n", day + 1, stats.trips,
+            stats.driveHours, stats.impacts, stats.overThreshold, stats.clipped, stats.betweenSamples, stats.inCapture,
+            stats.events, stats.bytes / 1024.0, (unsigned long long)stats.sdOpens, stats.saveMsMax);
+
+    total.trips += stats.trips;
+    total.driveHours += stats.driveHours;
+    total.impacts += stats.impacts;
+    total.overThreshold += stats.overThreshold;
+    total.clipped += stats.clipped;
+    total.betweenSamples += stats.betweenSamples;
+    total.inCapture += stats.inCapture;
+    total.events += stats.events;
+    total.saveFailures += stats.saveFailures;
+    total.bytes += stats.bytes;
+    total.sdOpens += stats.sdOpens;
+    total.saveMsMax = std::max(total.saveMsMax, stats.saveMsMax);
+    total.saveMsTotal += stats.saveMsTotal;
+
+    bool last = (day + 1 == days);
+    if (last || (s.offloadDays >= 1 && (day + 1) % (uint32_t)s.offloadDays == 0)) {
+      offloads.push_back(offload(day + 1));
+    }
+  }
+  double hostS = std::chrono::duration<double>(std::chrono::steady_clock::now() - hostStart).count();
+
+  fprintf(g_out, "%4s %5u %7.1f %8u %8u %7u %7u %7u %7u %9.1f %8llu %5.0f ms\n", "all", total.trips, total.driveHours,
+          total.impacts, total.overThreshold, total.clipped, total.betweenSamples, total.inCapture, total.events,
+          total.bytes / 1024.0, (unsigned long long)total.sdOpens, total.saveMsMax);
+  fs::OpCounts ops = fs::opCounts();
+  fprintf(g_out, "\nSD: %llu opens (%llu directory entries listed), %llu writes, %.1f kB written, %.1f kB read, "
+          "%llu removes; save %.0f ms mean, %u failed\n",
+          (unsigned long long)ops.opens, (unsigned long long)ops.entriesListed, (unsigned long long)ops.writes,
+          ops.bytesWritten / 1024.0, ops.bytesRead / 1024.0, (unsigned long long)ops.removes,
+          (total.events > 0) ? total.saveMsTotal / (total.events + total.saveFailures) : 0.0, total.saveFailures);
+
+  fprintf(g_out, "\nOffloads (stream time, then the card is cleared):\n");
+  fprintf(g_out, "%4s %6s %9s %10s %8s %10s %10s %10s\n", "day", "files", "kB", "kB_on_card", "packets", "lora",
+          "site_wifi", "softap");
+  OffloadStats all;
+  char lora[16];
+  char site[16];
+  char softAp[16];
+  for (const OffloadStats& o : offloads) {
+    if (o.files == 0) {
+      // Nothing to send: the transmitter gets END:D straight away
+      snprintf(lora, sizeof(lora), "-");
+      snprintf(site, sizeof(site), "-");
+      snprintf(softAp, sizeof(softAp), "-");
+    } else {
+      printDuration(lora, sizeof(lora), o.loraS);
+      printDuration(site, sizeof(site), wifiSeconds(o, s.siteConnectS));
+      printDuration(softAp, sizeof(softAp), wifiSeconds(o, s.softApConnectS));
+    }
+    fprintf(g_out, "%4u %6u %9.1f %10.1f %8u %10s %10s %10s\n", o.day, o.files, o.bytes / 1024.0,
+            o.allocated / 1024.0, o.loraPackets, lora, site, softAp);
+    all.files += o.files;
+    all.bytes += o.bytes;
+    all.allocated += o.allocated;
+    all.loraPackets += o.loraPackets;
+    all.loraS += o.loraS;
+    all.wifiLines += o.wifiLines;
+    all.wifiBytes += o.wifiBytes;
+  }
+
+  // Without offloads the card fills by clusters or by /events directory entries, whichever is first
+  fprintf(g_out, "\nProjection without offloads:\n");
+  if (all.files == 0) {
+    fprintf(g_out, "  no events saved; nothing fills\n");
+  } else {
+    double perDayFiles = (double)all.files / days;
+    double byClusters = s.cardGb * 1e9 / ((double)all.allocated / days);
+    double byEntries = filesPerDirectory() / perDayFiles;
+    double fullDays = std::min(byClusters, byEntries);
+    double filesAtFull = perDayFiles * fullDays;
+    double scale = filesAtFull / all.files;
+    OffloadStats full;
+    full.wifiLines = (uint32_t)(all.wifiLines * scale);
+    full.wifiBytes = (uint64_t)(all.wifiBytes * scale);
+    printDuration(lora, sizeof(lora), all.loraS * scale);
+    printDuration(site, sizeof(site), wifiSeconds(full, s.siteConnectS));
+    printDuration(softAp, sizeof(softAp), wifiSeconds(full, s.softApConnectS));
+    fprintf(g_out, "  %.1f events/day, %.1f kB/day (%.1f kB on the card in %u-byte clusters)\n", perDayFiles,
+            all.bytes / 1024.0 / days, all.allocated / 1024.0 / days, (unsigned)SIM_SD_CLUSTER_BYTES);
+    fprintf(g_out, "  full after %.1f weeks (%s), %.0f events\n", fullDays / 7.0,
+            (byEntries < byClusters) ? "/events directory entries" : "card clusters", filesAtFull);
+    fprintf(g_out, "  by then each save scans %.0f files: about %.1f s of SD opens per event\n", filesAtFull,
+            filesAtFull * s.sdOpenMs / 1000.0);
+    fprintf(g_out, "  offloading a full card: LoRa %s, site Wi-Fi %s, SoftAP %s\n", lora, site, softAp);
+  }
+
+  double simulatedS = sim::bootUs() / 1e6;
+  fprintf(g_out, "\n%.1f days simulated in %.2f s host (%.0fx)\n", simulatedS / 86400.0, hostS,
+          (hostS > 0) ? simulatedS / hostS : 0.0);
+  fprintf(g_out, "===============\n");
+  fclose(g_out);
+  return 0;
+}
@@ -0,0 +1,439 @@
+/*
+  Filename: offload_bench.cpp
+  End-to-end LoRa offload benchmark (Linux host)
+
+  Description: Runs the native Receiver and Transmitter programs on one
+               simulated air, seeds the receiver's SD card with N event
+               files and offloads them with the transmitter's 'd' command,
+               the way the UI does. The link loses packets as set by the
+               loss and burst arguments (see RadioLib.h). The transmitter
+               holds the offload on flash (SFHOLD:1) until the air is quiet,
+               then drains it here, so the spool's serial traffic never
+               mixes with the transfer.
+
+               Reports the offload time (the transmitter's own [TRANSFER]
+               duration, or 'd' to the receiver clearing its card if END:D
+               was lost), raw and good throughput, how many events arrived
+               intact, corrupt or not at all, and each radio's packet
+               counts. The receiver clears its card after a LoRa offload, so
+               every event that is not intact is gone for good. Exits 0
+               when every event arrived intact, 1 otherwise, 2 on a setup
+               failure.
+
+               WABASH_SIM_SPEED is passed to both programs; 20 keeps an SF9
+               run of ten events under ten seconds. The run directory is
+               kept for inspection (logs, lora.txt counters, spooled data).
+
+  Build/run (from this folder):
+    g++ -O2 -std=c++17 offload_bench.cpp -o offload_bench
+    ./offload_bench <receiver program> <transmitter program> [events=10] [loss=0] [burst=1] [sf=9]
+*/
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#define BENCH_SAMPLES_PER_EVENT  41       // One capture window at the default rates
+#define BENCH_RETRY_S            8.0      // Re-send 'd' if the receiver has not heard it
+#define BENCH_SETTLE_S           3.0      // Quiet air after the receiver clears its card
+#define BENCH_DRAIN_IDLE_S       4.0      // No new spool segment for this long ends the drain
+#define BENCH_TIMEOUT_S          3600.0   // Simulated seconds before giving up
+
+struct Node {
+  const char* name;
+  pid_t pid = -1;
+  int in = -1;
+  int out = -1;
+  std::string pending;    // Unparsed stdout
+};
+
+static double g_speed = 1.0;
+static std::chrono::steady_clock::time_point g_start;
+
+// Simulated seconds since the bench started
+static double simNow() {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - g_start).count() * g_speed;
+}
+
+static bool makeDirs(const std::string& path) {
+  for (size_t pos = 1; pos != std::string::npos;) {
+    pos = path.find('/', pos + 1);
+    std::string partial = path.substr(0, pos);
+    if (mkdir(partial.c_str(), 0755) != 0 && errno != EEXIST) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static std::string makeRow(std::mt19937& rng, int index) {
+  std::uniform_real_distribution<double> noise(-0.05, 0.05);
+  char cell[64];
+  snprintf(cell, sizeof(cell), "\"2026-03-12 10:%02d:%02d EST\",21.50,40.10", (index / 60) % 60, index % 60);
+  std::string row = cell;
+  for (int i = 0; i < BENCH_SAMPLES_PER_EVENT; i++) {
+    double shape = (i < 20) ? i / 20.0 : (40 - i) / 20.0;
+    snprintf(cell, sizeof(cell), ",%.3f,%.3f,%.3f,%.2f", noise(rng), noise(rng), 1.0 + 0.8 * shape + noise(rng),
+             120.0 * shape + 100.0 * noise(rng));
+    row += cell;
+  }
+  return row;
+}
+
+static bool startNode(Node& node, const char* program, const std::string& dir, const char* loss, const char* burst) {
+  int toChild[2];
+  int fromChild[2];
+  if (pipe(toChild) != 0 || pipe(fromChild) != 0) {
+    return false;
+  }
+  node.pid = fork();
+  if (node.pid < 0) {
+    return false;
+  }
+  if (node.pid == 0) {
+    dup2(toChild[0], STDIN_FILENO);
+    dup2(fromChild[1], STDOUT_FILENO);
+    std::string log = dir + "/" + node.name + ".log";
+    int err = open(log.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (err >= 0) {
+      dup2(err, STDERR_FILENO);
+    }
+    close(toChild[1]);
+    close(fromChild[0]);
+    setenv("WABASH_SIM_DIR", dir.c_str(), 1);
+    setenv("WABASH_SIM_NODE", node.name, 1);
+    setenv("WABASH_SIM_QUIET", "1", 0);
+    setenv("WABASH_SIM_SEED", "1", 0);
+    setenv("WABASH_SIM_LORA_LOSS", loss, 1);
+    setenv("WABASH_SIM_LORA_BURST", burst, 1);
+    execl(program, program, (char*)nullptr);
+    perror(program);
+    _exit(127);
+  }
+  close(toChild[0]);
+  close(fromChild[1]);
+  node.in = toChild[1];
+  node.out = fromChild[0];
+  fcntl(node.out, F_SETFL, O_NONBLOCK);
+  return true;
+}
+
+static void sendLine(Node& node, const std::string& line) {
+  std::string text = line + "\n";
+  if (write(node.in, text.data(), text.size()) < 0) {
+    fprintf(stderr, "write to %s failed\n", node.name);
+  }
+}
+
+// Read whatever both programs printed, waiting up to timeoutMs for the first byte
+static void pump(Node* nodes, size_t count, int timeoutMs) {
+  struct pollfd pfds[2];
+  for (size_t i = 0; i < count; i++) {
+    pfds[i] = {nodes[i].out, POLLIN, 0};
+  }
+  if (poll(pfds, count, timeoutMs) <= 0) {
+    return;
+  }
+  char buf[4096];
+  for (size_t i = 0; i < count; i++) {
+    ssize_t got;
+    while ((got = read(nodes[i].out, buf, sizeof(buf))) > 0) {
+      nodes[i].pending.append(buf, (size_t)got);
+    }
+  }
+}
+
+// Pop one complete line from a node's output
+static bool takeLine(Node& node, std::string& line) {
+  size_t end = node.pending.find('\n');
+  if (end == std::string::npos) {
+    return false;
+  }
+  line = node.pending.substr(0, end);
+  node.pending.erase(0, end + 1);
+  if (!line.empty() && line.back() == '\r') {
+    line.pop_back();
+  }
+  return true;
+}
+
+static size_t countEventFiles(const std::string& dir) {
+  DIR* events = opendir(dir.c_str());
+  if (events == nullptr) {
+    return 0;
+  }
+  size_t count = 0;
+  struct dirent* entry;
+  while ((entry = readdir(events)) != nullptr) {
+    if (strncmp(entry->d_name, "event ", 6) == 0) {
+      count++;
+    }
+  }
+  closedir(events);
+  return count;
+}
+
+static std::map<std::string, unsigned long> readStats(const std::string& path) {
+  std::map<std::string, unsigned long> stats;
+  FILE* file = fopen(path.c_str(), "r");
+  if (file == nullptr) {
+    return stats;
+  }
+  char line[64];
+  while (fgets(line, sizeof(line), file) != nullptr) {
+    char* eq = strchr(line, '=');
+    if (eq != nullptr) {
+      *eq = '\0';
+      stats[line] = strtoul(eq + 1, nullptr, 10);
+    }
+  }
+  fclose(file);
+  return stats;
+}
+
+static void printStats(const char* name, const std::map<std::string, unsigned long>& stats) {
+  printf("  %-11s", name);
+  for (const auto& counter : stats) {
+    printf(" %s=%lu", counter.first.c_str(), counter.second);
+  }
+  printf("\n");
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    fprintf(stderr, "usage: %s <receiver program> <transmitter program> [events=10] [loss=0] [burst=1] [sf=9]\n",
+            argv[0]);
+    return 2;
+  }
+  int eventCount = argc > 3 ? atoi(argv[3]) : 10;
+  const char* loss = argc > 4 ? argv[4] : "0";
+  const char* burst = argc > 5 ? argv[5] : "1";
+  int sf = argc > 6 ? atoi(argv[6]) : 9;
+  const char* speed = getenv("WABASH_SIM_SPEED");
+  g_speed = (speed != nullptr && atof(speed) > 0.0) ? atof(speed) : 1.0;
+  signal(SIGPIPE, SIG_IGN);
+
+  char dirTemplate[] = "/tmp/offload-bench-XXXXXX";
+  if (mkdtemp(dirTemplate) == nullptr) {
+    perror("mkdtemp");
+    return 2;
+  }
+  std::string dir = dirTemplate;
+  std::string eventsDir = dir + "/receiver/sd/events";
+  if (!makeDirs(eventsDir)) {
+    fprintf(stderr, "cannot create %s\n", eventsDir.c_str());
+    return 2;
+  }
+
+  // Seed the card: one header and one capture row per file, as the receiver writes them
+  std::mt19937 rng(1);
+  std::map<std::string, std::string> originals;
+  size_t originalBytes = 0;
+  for (int i = 1; i <= eventCount; i++) {
+    std::string name = "event " + std::to_string(i) + ".csv";
+    std::string row = makeRow(rng, i);
+    FILE* file = fopen((eventsDir + "/" + name).c_str(), "w");
+    if (file == nullptr) {
+      return 2;
+    }
+    fprintf(file, "timestamp,temperature_c,humidity_pct,samples...\n%s\n", row.c_str());
+    fclose(file);
+    originals[name] = row + "\n";
+    originalBytes += row.size() + 1;
+  }
+
+  Node nodes[2];
+  nodes[0].name = "receiver";
+  nodes[1].name = "transmitter";
+  Node& receiver = nodes[0];
+  Node& transmitter = nodes[1];
+  g_start = std::chrono::steady_clock::now();
+  if (!startNode(receiver, argv[1], dir, loss, burst) || !startNode(transmitter, argv[2], dir, loss, burst)) {
+    fprintf(stderr, "cannot start the firmware programs\n");
+    return 2;
+  }
+
+  printf("offload_bench: %d events (%zu bytes), loss %s, burst %s, SF%d, speed %.0fx, in %s\n",
+         eventCount, originalBytes, loss, burst, sf, g_speed, dir.c_str());
+
+  // Boot both, then configure: no deep sleep mid-run, spool held, same SF on both ends
+  bool receiverUp = false;
+  bool transmitterUp = false;
+  std::string line;
+  while (!(receiverUp && transmitterUp) && simNow() < 120.0) {
+    pump(nodes, 2, 100);
+    while (takeLine(receiver, line)) {
+      receiverUp |= (line == "=== Setup Complete ===");
+    }
+    while (takeLine(transmitter, line)) {
+      transmitterUp |= (line == "LoRa: OK");
+    }
+  }
+  if (!(receiverUp && transmitterUp)) {
+    fprintf(stderr, "firmware did not boot (see %s/*.log)\n", dir.c_str());
+    kill(receiver.pid, SIGKILL);
+    kill(transmitter.pid, SIGKILL);
+    return 2;
+  }
+  sendLine(receiver, "SET:sleep.enable=0");
+  sendLine(receiver, "SET:lora.sf=" + std::to_string(sf));
+  sendLine(transmitter, "TXSET:lora.sf=" + std::to_string(sf));
+  sendLine(transmitter, "SFHOLD:1");
+  double settleUntil = simNow() + 1.0;
+  while (simNow() < settleUntil) {
+    pump(nodes, 2, 50);
+    while (takeLine(receiver, line) || takeLine(transmitter, line)) {
+    }
+  }
+
+  // Offload: retry 'd' until the receiver hears it, then wait for the card to clear
+  double startS = simNow();
+  double lastAskS = -1e9;
+  bool heard = false;
+  int requests = 0;
+  double clearedS = -1.0;
+  double quietFromS = -1.0;
+  while (simNow() - startS < BENCH_TIMEOUT_S) {
+    if (!heard && simNow() - lastAskS > BENCH_RETRY_S) {
+      sendLine(transmitter, "d");
+      lastAskS = simNow();
+      requests++;
+    }
+    pump(nodes, 2, 100);
+    while (takeLine(receiver, line)) {
+      heard |= (line == "LoRa CMD received: d");
+    }
+    while (takeLine(transmitter, line)) {
+      quietFromS = simNow();
+    }
+    if (heard && clearedS < 0.0 && countEventFiles(eventsDir) == 0) {
+      clearedS = simNow();
+      quietFromS = clearedS;
+    }
+    if (clearedS >= 0.0 && simNow() - quietFromS > BENCH_SETTLE_S) {
+      break;
+    }
+  }
+  if (clearedS < 0.0) {
+    fprintf(stderr, "offload did not finish in %.0f s (see %s/*.log)\n", BENCH_TIMEOUT_S, dir.c_str());
+    kill(receiver.pid, SIGKILL);
+    kill(transmitter.pid, SIGKILL);
+    return 2;
+  }
+
+  // Drain the spool: [SF_SEG_BEGIN] seq=<n> bytes=<size>, payload, [SF_SEG_END] seq=<n>
+  sendLine(transmitter, "SFHOLD:0");
+  std::string spooled;
+  double lastSegmentS = simNow();
+  while (simNow() - lastSegmentS < BENCH_DRAIN_IDLE_S) {
+    pump(&transmitter, 1, 100);
+    unsigned long seq;
+    unsigned int bytes;
+    size_t end = transmitter.pending.find('\n');
+    if (end == std::string::npos) {
+      continue;
+    }
+    if (sscanf(transmitter.pending.c_str(), "[SF_SEG_BEGIN] seq=%lu bytes=%u", &seq, &bytes) != 2) {
+      transmitter.pending.erase(0, end + 1);
+      continue;
+    }
+    // Exactly bytes= payload bytes, then the end marker; anything else is a corrupt segment
+    std::string tail = "[SF_SEG_END] seq=" + std::to_string(seq) + "\n";
+    size_t tailAt = end + 1 + bytes;
+    if (transmitter.pending.size() < tailAt + tail.size()) {
+      continue;
+    }
+    if (transmitter.pending.compare(tailAt, tail.size(), tail) != 0) {
+      transmitter.pending.erase(0, end + 1);
+      sendLine(transmitter, "SFNAK:" + std::to_string(seq));
+      continue;
+    }
+    spooled.append(transmitter.pending, end + 1, bytes);
+    transmitter.pending.erase(0, tailAt + tail.size());
+    sendLine(transmitter, "SFACK:" + std::to_string(seq));
+    lastSegmentS = simNow();
+  }
+  kill(receiver.pid, SIGTERM);
+  kill(transmitter.pid, SIGTERM);
+  waitpid(receiver.pid, nullptr, 0);
+  waitpid(transmitter.pid, nullptr, 0);
+
+  FILE* spool = fopen((dir + "/spooled.txt").c_str(), "w");
+  if (spool != nullptr) {
+    fwrite(spooled.data(), 1, spooled.size(), spool);
+    fclose(spool);
+  }
+
+  // Split the spool back into files the way the UI does: EVENT_FILE:<name> starts one
+  std::map<std::string, std::string> received;
+  std::string* current = nullptr;
+  size_t strayBytes = 0;
+  long transferMs = -1;
+  bool sawEnd = false;
+  size_t pos = 0;
+  while (pos < spooled.size()) {
+    size_t end = spooled.find('\n', pos);
+    if (end == std::string::npos) {
+      end = spooled.size();
+    }
+    std::string row = spooled.substr(pos, end - pos);
+    pos = end + 1;
+    long ms;
+    if (row.compare(0, 11, "EVENT_FILE:") == 0) {
+      current = &received[row.substr(11)];
+    } else if (row == "END:D") {
+      sawEnd = true;
+      current = nullptr;
+    } else if (sscanf(row.c_str(), "[TRANSFER] duration=%ldms", &ms) == 1) {
+      transferMs = ms;
+    } else if (current != nullptr) {
+      *current += row + "\n";
+    } else {
+      strayBytes += row.size() + 1;
+    }
+  }
+
+  int intact = 0;
+  int corrupt = 0;
+  int missing = 0;
+  size_t intactBytes = 0;
+  for (const auto& original : originals) {
+    auto found = received.find(original.first);
+    if (found == received.end()) {
+      missing++;
+    } else if (found->second == original.second) {
+      intact++;
+      intactBytes += original.second.size();
+    } else {
+      corrupt++;
+    }
+  }
+
+  double offloadS = (transferMs >= 0) ? transferMs / 1000.0 : clearedS - startS;
+  printf("offload: %.1f s (%s), %d request(s), END:D %s\n", offloadS,
+         (transferMs >= 0) ? "transmitter [TRANSFER]" : "'d' to card cleared", requests,
+         sawEnd ? "received" : "lost");
+  printf("data:    %zu bytes spooled, %.1f B/s raw, %.1f B/s goodput (%.0f%% of sent)\n", spooled.size(),
+         offloadS > 0.0 ? spooled.size() / offloadS : 0.0, offloadS > 0.0 ? intactBytes / offloadS : 0.0,
+         originalBytes > 0 ? 100.0 * intactBytes / originalBytes : 0.0);
+  printf("events:  %d intact, %d corrupt, %d missing of %d; %zu stray bytes; receiver card cleared\n", intact,
+         corrupt, missing, eventCount, strayBytes);
+  printf("packets:\n");
+  printStats("receiver", readStats(dir + "/receiver/lora.txt"));
+  printStats("transmitter", readStats(dir + "/transmitter/lora.txt"));
+  return (intact == eventCount) ? 0 : 1;
+}
@@ -0,0 +1,259 @@
+/*
+  Filename: Arduino.cpp
+  Arduino-ESP32 Core Implementation (native)
+
+  Description: Timing, the GPIO pin table and interrupt dispatch, random()
+               and the CPU clock setting. An interrupt handler runs on the
+               thread of the simulated device that drove the pin, standing in
+               for the ESP32's ISR context.
+*/
+
+#include "Arduino.h"
+
+#include <mutex>
+#include <random>
+
+#include "SimHost.h"
+#include "esp_sleep.h"
+
+struct SimPin {
+  uint8_t mode;
+  int outputLevel;
+  int inputLevel;
+  int interruptMode;
+  void (*handler)(void);
+  void (*handlerArg)(void*);
+  void* arg;
+};
+
+static std::mutex s_pinMutex;
+static SimPin s_pins[SIM_GPIO_COUNT];
+
+static std::mutex s_randomMutex;
+static std::mt19937 s_random(sim::seed());
+
+static uint32_t s_cpuMhz = 240;
+static long s_gmtOffsetSec = 0;
+static int s_daylightOffsetSec = 0;
+
+unsigned long millis() {
+  return (unsigned long)(uint32_t)(sim::bootUs() / 1000ULL);
+}
+
+unsigned long micros() {
+  return (unsigned long)(uint32_t)sim::bootUs();
+}
+
+void delay(uint32_t ms) {
+  if (ms == 0) {
+    sched_yield();
+    return;
+  }
+  sim::sleepUs((uint64_t)ms * 1000ULL);
+}
+
+void delayMicroseconds(uint32_t us) {
+  // The core busy-waits; short waits are spun so timing-sensitive code keeps its timing
+  if (us < 100 && !sim::virtualClock()) {
+    uint64_t end = sim::bootUs() + us;
+    while (sim::bootUs() < end) {
+    }
+    return;
+  }
+  sim::sleepUs(us);
+}
+
+void yield() {
+  sched_yield();
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  if (pin >= SIM_GPIO_COUNT) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(s_pinMutex);
+  s_pins[pin].mode = mode;
+  if (mode == INPUT_PULLUP) {
+    s_pins[pin].inputLevel = HIGH;
+  } else if (mode == INPUT_PULLDOWN) {
+    s_pins[pin].inputLevel = LOW;
+  }
+}
+
+void digitalWrite(uint8_t pin, uint8_t level) {
+  if (pin >= SIM_GPIO_COUNT) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(s_pinMutex);
+  s_pins[pin].outputLevel = level ? HIGH : LOW;
+}
+
+int digitalRead(uint8_t pin) {
+  if (pin >= SIM_GPIO_COUNT) {
+    return LOW;
+  }
+  std::lock_guard<std::mutex> guard(s_pinMutex);
+  const SimPin& p = s_pins[pin];
+  return (p.mode == OUTPUT) ? p.outputLevel : p.inputLevel;
+}
+
+uint16_t analogRead(uint8_t) {
+  return 0;
+}
+
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode) {
+  if (pin >= SIM_GPIO_COUNT) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(s_pinMutex);
+  s_pins[pin].handler = handler;
+  s_pins[pin].handlerArg = nullptr;
+  s_pins[pin].arg = nullptr;
+  s_pins[pin].interruptMode = mode;
+}
+
+void attachInterruptArg(uint8_t pin, void (*handler)(void*), void* arg, int mode) {
+  if (pin >= SIM_GPIO_COUNT) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(s_pinMutex);
+  s_pins[pin].handler = nullptr;
+  s_pins[pin].handlerArg = handler;
+  s_pins[pin].arg = arg;
+  s_pins[pin].interruptMode = mode;
+}
+
+void detachInterrupt(uint8_t pin) {
+  if (pin >= SIM_GPIO_COUNT) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(s_pinMutex);
+  s_pins[pin].handler = nullptr;
+  s_pins[pin].handlerArg = nullptr;
+  s_pins[pin].interruptMode = 0;
+}
+
+namespace sim {
+
+void driveGpio(uint8_t pin, int level) {
+  if (pin >= SIM_GPIO_COUNT) {
+    return;
+  }
+  level = level ? HIGH : LOW;
+  void (*handler)(void) = nullptr;
+  void (*handlerArg)(void*) = nullptr;
+  void* arg = nullptr;
+  {
+    std::lock_guard<std::mutex> guard(s_pinMutex);
+    SimPin& p = s_pins[pin];
+    int previous = p.inputLevel;
+    p.inputLevel = level;
+    bool fire = false;
+    switch (p.interruptMode) {
+      case RISING:
+        fire = (previous == LOW && level == HIGH);
+        break;
+      case FALLING:
+        fire = (previous == HIGH && level == LOW);
+        break;
+      case CHANGE:
+        fire = (previous != level);
+        break;
+      case ONHIGH:
+        fire = (level == HIGH);
+        break;
+      case ONLOW:
+        fire = (level == LOW);
+        break;
+    }
+    if (fire) {
+      handler = p.handler;
+      handlerArg = p.handlerArg;
+      arg = p.arg;
+    }
+  }
+  // Outside the pin lock: the handler may read pins or notify tasks
+  if (handler != nullptr) {
+    handler();
+  } else if (handlerArg != nullptr) {
+    handlerArg(arg);
+  }
+  wake(ESP_SLEEP_WAKEUP_GPIO);
+}
+
+}  // namespace sim
+
+long random(long howBig) {
+  if (howBig <= 0) {
+    return 0;
+  }
+  std::lock_guard<std::mutex> guard(s_randomMutex);
+  return (long)(s_random() % (unsigned long)howBig);
+}
+
+long random(long howSmall, long howBig) {
+  if (howSmall >= howBig) {
+    return howSmall;
+  }
+  return howSmall + random(howBig - howSmall);
+}
+
+void randomSeed(unsigned long seed) {
+  if (seed != 0) {
+    std::lock_guard<std::mutex> guard(s_randomMutex);
+    s_random.seed((uint32_t)seed);
+  }
+}
+
+uint32_t esp_random() {
+  std::lock_guard<std::mutex> guard(s_randomMutex);
+  return (uint32_t)s_random();
+}
+
+void esp_fill_random(void* buffer, uint32_t length) {
+  uint8_t* out = static_cast<uint8_t*>(buffer);
+  for (uint32_t i = 0; i < length; i++) {
+    out[i] = (uint8_t)esp_random();
+  }
+}
+
+uint32_t getCpuFrequencyMhz() {
+  return __atomic_load_n(&s_cpuMhz, __ATOMIC_RELAXED);
+}
+
+bool setCpuFrequencyMhz(uint32_t mhz) {
+  // The steps the ESP32-S3 accepts with a 40 MHz crystal
+  switch (mhz) {
+    case 240:
+    case 160:
+    case 80:
+    case 40:
+    case 20:
+    case 10:
+      __atomic_store_n(&s_cpuMhz, mhz, __ATOMIC_RELAXED);
+      return true;
+    default:
+      sim::log("setCpuFrequencyMhz(%u) rejected", (unsigned)mhz);
+      return false;
+  }
+}
+
+uint32_t getXtalFrequencyMhz() {
+  return 40;
+}
+
+uint32_t getApbFrequency() {
+  return getCpuFrequencyMhz() >= 80 ? 80000000 : getCpuFrequencyMhz() * 1000000;
+}
+
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char*, const char*, const char*) {
+  // The host clock is already synchronised; only the offsets matter
+  s_gmtOffsetSec = gmtOffsetSec;
+  s_daylightOffsetSec = daylightOffsetSec;
+}
+
+bool getLocalTime(struct tm* info, uint32_t) {
+  time_t now = time(nullptr) + s_gmtOffsetSec + s_daylightOffsetSec;
+  gmtime_r(&now, info);
+  return info->tm_year > (2016 - 1900);
+}
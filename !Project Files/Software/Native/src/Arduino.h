@@ -0,0 +1,148 @@
+/*
+  Filename: Arduino.h
+  Arduino-ESP32 Core (native)
+
+  Description: The slice of the Arduino-ESP32 core the Wabash firmware
+               uses, on Linux: timing from CLOCK_MONOTONIC, Serial on
+               stdin/stdout, GPIO levels and interrupts in a pin table that
+               the simulated devices drive, and the CPU clock as a plain
+               setting. main() (NativeMain.cpp) runs setup() and loop() in a
+               FreeRTOS task named "loopTask", as the ESP32 core does.
+
+               RTC_DATA_ATTR variables are placed in their own section and
+               saved across deep sleep and ESP.restart() (see EspSystem.cpp).
+*/
+
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+#include <algorithm>
+#include <cmath>
+#include <ctype.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+
+#include "WString.h"
+#include "Print.h"
+#include "Stream.h"
+#include "HardwareSerial.h"
+#include "Esp.h"
+
+#define ARDUINO 10819
+
+typedef bool boolean;
+typedef uint8_t byte;
+typedef uint16_t word;
+
+#define LOW               0x0
+#define HIGH              0x1
+
+#define INPUT             0x01
+#define OUTPUT            0x03
+#define PULLUP            0x04
+#define INPUT_PULLUP      0x05
+#define PULLDOWN          0x08
+#define INPUT_PULLDOWN    0x09
+#define OPEN_DRAIN        0x10
+
+#define RISING            0x01
+#define FALLING           0x02
+#define CHANGE            0x03
+#define ONLOW             0x04
+#define ONHIGH            0x05
+
+#define SIM_GPIO_COUNT    49    // ESP32-S3 GPIO0..GPIO48
+#define NOT_AN_INTERRUPT  -1
+#define digitalPinToInterrupt(p)  (((p) < SIM_GPIO_COUNT) ? (p) : NOT_AN_INTERRUPT)
+
+#define IRAM_ATTR
+#define ICACHE_RAM_ATTR
+#define DRAM_ATTR
+#define RTC_DATA_ATTR     __attribute__((section("rtc_data")))
+#define RTC_NOINIT_ATTR   __attribute__((section("rtc_noinit")))
+#define PROGMEM
+#define F(text)           (text)
+
+#define PI                3.1415926535897932384626433832795
+#define DEG_TO_RAD        0.017453292519943295769236907684886
+#define RAD_TO_DEG        57.295779513082320876798154814105
+
+#define lowByte(w)        ((uint8_t)((w) & 0xff))
+#define highByte(w)       ((uint8_t)((w) >> 8))
+#define bitRead(value, bit)   (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit)    ((value) |= (1UL << (bit)))
+#define bitClear(value, bit)  ((value) &= ~(1UL << (bit)))
+
+using std::abs;
+using std::isinf;
+using std::isnan;
+using std::max;
+using std::min;
+using ::round;
+
+template <typename T, typename L, typename H>
+inline T constrain(T value, L low, H high) {
+  return value < (T)low ? (T)low : (value > (T)high ? (T)high : value);
+}
+
+inline long map(long x, long inMin, long inMax, long outMin, long outMax) {
+  if (inMax == inMin) {
+    return outMin;
+  }
+  return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+inline bool isDigit(int c) { return isdigit(c) != 0; }
+inline bool isAlpha(int c) { return isalpha(c) != 0; }
+inline bool isAlphaNumeric(int c) { return isalnum(c) != 0; }
+inline bool isSpace(int c) { return isspace(c) != 0; }
+inline bool isWhitespace(int c) { return c == ' ' || c == '\t'; }
+inline bool isPunct(int c) { return ispunct(c) != 0; }
+inline bool isPrintable(int c) { return isprint(c) != 0; }
+inline bool isUpperCase(int c) { return isupper(c) != 0; }
+inline bool isLowerCase(int c) { return islower(c) != 0; }
+inline bool isHexadecimalDigit(int c) { return isxdigit(c) != 0; }
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t level);
+int digitalRead(uint8_t pin);
+uint16_t analogRead(uint8_t pin);
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode);
+void attachInterruptArg(uint8_t pin, void (*handler)(void*), void* arg, int mode);
+void detachInterrupt(uint8_t pin);
+
+long random(long howBig);
+long random(long howSmall, long howBig);
+void randomSeed(unsigned long seed);
+
+uint32_t getCpuFrequencyMhz();
+bool setCpuFrequencyMhz(uint32_t mhz);
+uint32_t getXtalFrequencyMhz();
+uint32_t getApbFrequency();
+
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char* server1,
+                const char* server2 = nullptr, const char* server3 = nullptr);
+bool getLocalTime(struct tm* info, uint32_t ms = 5000);
+
+void setup();
+void loop();
+
+#endif
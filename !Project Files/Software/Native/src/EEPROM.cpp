@@ -0,0 +1,87 @@
+/*
+  Filename: EEPROM.cpp
+  Arduino-ESP32 EEPROM Emulation Implementation (native)
+*/
+
+#include "EEPROM.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+#include "SimHost.h"
+
+EEPROMClass EEPROM;
+
+static std::string imagePath() {
+  return sim::nodePath("") + "/eeprom.bin";
+}
+
+EEPROMClass::~EEPROMClass() {
+  free(_data);
+}
+
+bool EEPROMClass::begin(size_t size) {
+  if (size == 0) {
+    return false;
+  }
+  end();
+  _data = (uint8_t*)calloc(1, size);
+  if (_data == nullptr) {
+    return false;
+  }
+  _size = size;
+  FILE* file = fopen(imagePath().c_str(), "rb");
+  if (file != nullptr) {
+    size_t got = fread(_data, 1, size, file);
+    (void)got;   // A shorter image leaves the rest zeroed
+    fclose(file);
+  }
+  _dirty = false;
+  return true;
+}
+
+void EEPROMClass::end() {
+  if (_data == nullptr) {
+    return;
+  }
+  commit();
+  free(_data);
+  _data = nullptr;
+  _size = 0;
+}
+
+bool EEPROMClass::commit() {
+  if (_data == nullptr) {
+    return false;
+  }
+  if (!_dirty) {
+    return true;
+  }
+  FILE* file = fopen(imagePath().c_str(), "wb");
+  if (file == nullptr) {
+    return false;
+  }
+  bool ok = fwrite(_data, 1, _size, file) == _size;
+  fclose(file);
+  _dirty = !ok;
+  return ok;
+}
+
+String EEPROMClass::readString(int address) {
+  String value;
+  while (inRange(address, 1) && _data[address] != 0) {
+    value += (char)_data[address++];
+  }
+  return value;
+}
+
+size_t EEPROMClass::writeString(int address, const char* value) {
+  size_t len = strlen(value);
+  if (!inRange(address, len + 1)) {
+    return 0;
+  }
+  memcpy(_data + address, value, len + 1);
+  _dirty = true;
+  return len;
+}
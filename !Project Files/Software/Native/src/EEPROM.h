@@ -0,0 +1,93 @@
+/*
+  Filename: EEPROM.h
+  Arduino-ESP32 EEPROM Emulation (native)
+
+  Description: The emulated EEPROM is <node>/eeprom.bin. A fresh one reads
+               as zeros, like the core's first NVS blob; commit() writes the
+               whole image back.
+*/
+
+#ifndef EEPROM_H
+#define EEPROM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "WString.h"
+
+class EEPROMClass {
+  public:
+    EEPROMClass() : _data(nullptr), _size(0), _dirty(false) {}
+    ~EEPROMClass();
+
+    bool begin(size_t size);
+    void end();
+    bool commit();
+    size_t length() const { return _size; }
+
+    uint8_t read(int address) { return readByte(address); }
+    void write(int address, uint8_t value) { writeByte(address, value); }
+    uint8_t* getDataPtr() { _dirty = true; return _data; }
+
+    uint8_t readByte(int address) { return readValue<uint8_t>(address); }
+    int8_t readChar(int address) { return readValue<int8_t>(address); }
+    int16_t readShort(int address) { return readValue<int16_t>(address); }
+    uint16_t readUShort(int address) { return readValue<uint16_t>(address); }
+    int32_t readInt(int address) { return readValue<int32_t>(address); }
+    uint32_t readUInt(int address) { return readValue<uint32_t>(address); }
+    float readFloat(int address) { return readValue<float>(address); }
+    String readString(int address);
+
+    size_t writeByte(int address, uint8_t value) { return writeValue(address, value); }
+    size_t writeChar(int address, int8_t value) { return writeValue(address, value); }
+    size_t writeShort(int address, int16_t value) { return writeValue(address, value); }
+    size_t writeUShort(int address, uint16_t value) { return writeValue(address, value); }
+    size_t writeInt(int address, int32_t value) { return writeValue(address, value); }
+    size_t writeUInt(int address, uint32_t value) { return writeValue(address, value); }
+    size_t writeFloat(int address, float value) { return writeValue(address, value); }
+    size_t writeString(int address, const char* value);
+
+    template <typename T>
+    T& get(int address, T& value) {
+      if (inRange(address, sizeof(T))) {
+        memcpy(&value, _data + address, sizeof(T));
+      }
+      return value;
+    }
+
+    template <typename T>
+    const T& put(int address, const T& value) {
+      writeValue(address, value);
+      return value;
+    }
+
+  private:
+    uint8_t* _data;
+    size_t _size;
+    bool _dirty;
+
+    bool inRange(int address, size_t bytes) const {
+      return _data != nullptr && address >= 0 && (size_t)address + bytes <= _size;
+    }
+
+    template <typename T>
+    T readValue(int address) {
+      T value = T();
+      return get(address, value);
+    }
+
+    template <typename T>
+    size_t writeValue(int address, const T& value) {
+      if (!inRange(address, sizeof(T))) {
+        return 0;
+      }
+      memcpy(_data + address, &value, sizeof(T));
+      _dirty = true;
+      return sizeof(T);
+    }
+};
+
+extern EEPROMClass EEPROM;
+
+#endif
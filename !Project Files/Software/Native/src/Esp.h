@@ -0,0 +1,44 @@
+/*
+  Filename: Esp.h
+  ESP Chip Services (native)
+
+  Description: ESP.getFreeHeap() and friends report a simulated internal
+               heap: WABASH_SIM_HEAP bytes (default 320 KB) less what the
+               process has allocated since boot, so leaks and fragmentation
+               trends show up even though the host heap is far larger.
+               ESP.restart() keeps RTC memory and re-executes the program.
+*/
+
+#ifndef ESP_H
+#define ESP_H
+
+#include <stdint.h>
+
+#include "esp_system.h"
+
+#define SIM_DEFAULT_HEAP  (320 * 1024)    // Override with WABASH_SIM_HEAP
+
+class EspClass {
+  public:
+    uint32_t getHeapSize();
+    uint32_t getFreeHeap();
+    uint32_t getMinFreeHeap();
+    uint32_t getMaxAllocHeap();
+    uint32_t getPsramSize() { return 0; }
+    uint32_t getFreePsram() { return 0; }
+
+    const char* getChipModel() { return "ESP32-S3 (native sim)"; }
+    uint8_t getChipRevision() { return 0; }
+    uint8_t getChipCores() { return 2; }
+    uint32_t getCpuFreqMHz();
+    uint32_t getCycleCount();
+    const char* getSdkVersion() { return "native"; }
+    uint32_t getFlashChipSize() { return 8 * 1024 * 1024; }
+    uint64_t getEfuseMac();
+
+    [[noreturn]] void restart() { esp_restart(); }
+};
+
+extern EspClass ESP;
+
+#endif
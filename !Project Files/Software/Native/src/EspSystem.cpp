@@ -0,0 +1,401 @@
+/*
+  Filename: EspSystem.cpp
+  ESP-IDF System, Heap and Sleep Implementation (native)
+
+  Description: The simulated heap, reset/wake bookkeeping, light and deep
+               sleep, and the RTC memory image that carries RTC_DATA_ATTR and
+               RTC_NOINIT_ATTR variables across a re-exec.
+
+               RTC image rules match the ESP32: deep sleep keeps both
+               sections, a software restart keeps only RTC_NOINIT_ATTR, and
+               anything else (starting the program by hand) is a power-on.
+               The image is deleted once restored so a crash or Ctrl-C is
+               never mistaken for a deep sleep wake.
+*/
+
+#include <fcntl.h>
+#include <malloc.h>
+#include <mutex>
+#include <string.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "Arduino.h"
+#include "SimHost.h"
+#include "driver/gpio.h"
+#include "driver/rtc_io.h"
+#include "driver/uart.h"
+#include "esp_heap_caps.h"
+#include "esp_sleep.h"
+#include "esp_timer.h"
+
+#define SIM_RTC_MAGIC  0x52544353   // "SCTR"
+
+// Section bounds from the linker; null when a firmware has no RTC variables
+extern "C" char __start_rtc_data[] __attribute__((weak));
+extern "C" char __stop_rtc_data[] __attribute__((weak));
+extern "C" char __start_rtc_noinit[] __attribute__((weak));
+extern "C" char __stop_rtc_noinit[] __attribute__((weak));
+
+struct SimRtcHeader {
+  uint32_t magic;
+  uint32_t dataSize;
+  uint32_t noinitSize;
+  int32_t resetReason;
+  int32_t wakeCause;
+};
+
+EspClass ESP;
+
+static esp_reset_reason_t s_resetReason = ESP_RST_POWERON;
+static esp_sleep_wakeup_cause_t s_wakeCause = ESP_SLEEP_WAKEUP_UNDEFINED;
+
+static std::mutex s_sleepMutex;
+static uint64_t s_timerWakeUs = 0;              // 0 = timer wake disabled
+static int s_ext0Pin = -1;
+static int s_ext0Level = 1;
+static bool s_gpioWakeEnabled = false;
+static bool s_uartWakeEnabled = false;
+static int8_t s_gpioWakeLevel[SIM_GPIO_COUNT];  // -1 = not a wake pin
+static bool s_gpioWakeInit = false;
+
+static size_t s_heapSize = SIM_DEFAULT_HEAP;
+static size_t s_heapBaseline = 0;
+static size_t s_minFreeHeap = SIM_DEFAULT_HEAP;
+
+static size_t sectionSize(const char* start, const char* stop) {
+  return (start != nullptr && stop != nullptr && stop > start) ? (size_t)(stop - start) : 0;
+}
+
+static std::string rtcImagePath() {
+  return sim::nodePath("") + "/rtc.bin";
+}
+
+// ------------------------------------------------------------ RTC memory
+
+static void writeAll(int fd, const void* data, size_t size) {
+  const uint8_t* p = static_cast<const uint8_t*>(data);
+  while (size > 0) {
+    ssize_t n = ::write(fd, p, size);
+    if (n <= 0) {
+      return;
+    }
+    p += n;
+    size -= (size_t)n;
+  }
+}
+
+static void saveRtc(esp_reset_reason_t reason, esp_sleep_wakeup_cause_t cause) {
+  SimRtcHeader header;
+  header.magic = SIM_RTC_MAGIC;
+  header.dataSize = (uint32_t)sectionSize(__start_rtc_data, __stop_rtc_data);
+  header.noinitSize = (uint32_t)sectionSize(__start_rtc_noinit, __stop_rtc_noinit);
+  header.resetReason = reason;
+  header.wakeCause = cause;
+
+  std::string path = rtcImagePath();
+  int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    sim::log("cannot save RTC memory to %s", path.c_str());
+    return;
+  }
+  writeAll(fd, &header, sizeof(header));
+  writeAll(fd, __start_rtc_data, header.dataSize);
+  writeAll(fd, __start_rtc_noinit, header.noinitSize);
+  ::close(fd);
+}
+
+namespace sim {
+
+void restoreRtc() {
+  std::string path = rtcImagePath();
+  FILE* file = fopen(path.c_str(), "rb");
+  if (file == nullptr) {
+    return;   // Power-on
+  }
+  SimRtcHeader header;
+  size_t dataSize = sectionSize(__start_rtc_data, __stop_rtc_data);
+  size_t noinitSize = sectionSize(__start_rtc_noinit, __stop_rtc_noinit);
+  bool valid = fread(&header, sizeof(header), 1, file) == 1 && header.magic == SIM_RTC_MAGIC &&
+               header.dataSize == dataSize && header.noinitSize == noinitSize;
+  if (!valid) {
+    // A rebuilt binary lays the sections out differently; treat as power-on
+    log("RTC image does not match this build, ignored");
+  } else {
+    std::vector<uint8_t> data(dataSize);
+    std::vector<uint8_t> noinit(noinitSize);
+    bool complete = (dataSize == 0 || fread(data.data(), 1, dataSize, file) == dataSize) &&
+                    (noinitSize == 0 || fread(noinit.data(), 1, noinitSize, file) == noinitSize);
+    if (complete) {
+      s_resetReason = (esp_reset_reason_t)header.resetReason;
+      if (s_resetReason == ESP_RST_DEEPSLEEP) {
+        s_wakeCause = (esp_sleep_wakeup_cause_t)header.wakeCause;
+        memcpy(__start_rtc_data, data.data(), dataSize);
+      }
+      memcpy(__start_rtc_noinit, noinit.data(), noinitSize);
+    }
+  }
+  fclose(file);
+  unlink(path.c_str());
+}
+
+// ------------------------------------------------------------ Heap
+
+static size_t hostHeapInUse() {
+  struct mallinfo2 info = mallinfo2();
+  return info.uordblks + info.hblkhd;
+}
+
+void markHeapBaseline() {
+  const char* env = getenv("WABASH_SIM_HEAP");
+  if (env != nullptr && env[0] != '\0') {
+    s_heapSize = (size_t)strtoul(env, nullptr, 0);
+  }
+  s_minFreeHeap = s_heapSize;
+  s_heapBaseline = hostHeapInUse();
+}
+
+}  // namespace sim
+
+static size_t freeHeap() {
+  size_t inUse = sim::hostHeapInUse();
+  size_t grown = (inUse > s_heapBaseline) ? inUse - s_heapBaseline : 0;
+  size_t free = (grown < s_heapSize) ? s_heapSize - grown : 0;
+  // Only updated when someone looks; the firmware samples it periodically anyway
+  size_t seenMin = __atomic_load_n(&s_minFreeHeap, __ATOMIC_RELAXED);
+  while (free < seenMin &&
+         !__atomic_compare_exchange_n(&s_minFreeHeap, &seenMin, free, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+  }
+  return free;
+}
+
+size_t heap_caps_get_total_size(uint32_t) {
+  return s_heapSize;
+}
+
+size_t heap_caps_get_free_size(uint32_t) {
+  return freeHeap();
+}
+
+size_t heap_caps_get_minimum_free_size(uint32_t) {
+  freeHeap();
+  return __atomic_load_n(&s_minFreeHeap, __ATOMIC_RELAXED);
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t) {
+  // The host allocator does not fragment the simulated heap
+  return freeHeap();
+}
+
+uint32_t EspClass::getHeapSize() {
+  return (uint32_t)heap_caps_get_total_size(MALLOC_CAP_DEFAULT);
+}
+
+uint32_t EspClass::getFreeHeap() {
+  return (uint32_t)heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+  return (uint32_t)heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT);
+}
+
+uint32_t EspClass::getMaxAllocHeap() {
+  return (uint32_t)heap_caps_get_largest_free_block(MALLOC_CAP_DEFAULT);
+}
+
+uint32_t EspClass::getCpuFreqMHz() {
+  return getCpuFrequencyMhz();
+}
+
+uint32_t EspClass::getCycleCount() {
+  return (uint32_t)(sim::bootUs() * getCpuFrequencyMhz());
+}
+
+uint64_t EspClass::getEfuseMac() {
+  // Stable per node name so several simulated boards get distinct IDs
+  uint64_t hash = 1469598103934665603ULL;
+  for (const char* p = sim::nodeName(); *p != '\0'; p++) {
+    hash = (hash ^ (uint8_t)*p) * 1099511628211ULL;
+  }
+  return hash & 0xFFFFFFFFFFFFULL;
+}
+
+// ------------------------------------------------------------ System
+
+int64_t esp_timer_get_time() {
+  return (int64_t)sim::bootUs();
+}
+
+esp_reset_reason_t esp_reset_reason() {
+  return s_resetReason;
+}
+
+void esp_restart() {
+  sim::log("restart");
+  saveRtc(ESP_RST_SW, ESP_SLEEP_WAKEUP_UNDEFINED);
+  sim::reboot();
+}
+
+// ------------------------------------------------------------ Sleep
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t timeUs) {
+  std::lock_guard<std::mutex> guard(s_sleepMutex);
+  s_timerWakeUs = (timeUs > 0) ? timeUs : 1;
+  return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_ext0_wakeup(gpio_num_t pin, int level) {
+  if (!rtc_gpio_is_valid_gpio(pin)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  std::lock_guard<std::mutex> guard(s_sleepMutex);
+  s_ext0Pin = pin;
+  s_ext0Level = level ? HIGH : LOW;
+  return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_gpio_wakeup() {
+  std::lock_guard<std::mutex> guard(s_sleepMutex);
+  s_gpioWakeEnabled = true;
+  return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_uart_wakeup(int uartNum) {
+  if (uartNum != UART_NUM_0) {
+    return ESP_ERR_INVALID_ARG;   // Only UART0 has a stand-in (stdin)
+  }
+  std::lock_guard<std::mutex> guard(s_sleepMutex);
+  s_uartWakeEnabled = true;
+  return ESP_OK;
+}
+
+esp_err_t esp_sleep_disable_wakeup_source(esp_sleep_source_t source) {
+  std::lock_guard<std::mutex> guard(s_sleepMutex);
+  if (source == ESP_SLEEP_WAKEUP_ALL || source == ESP_SLEEP_WAKEUP_TIMER) {
+    s_timerWakeUs = 0;
+  }
+  if (source == ESP_SLEEP_WAKEUP_ALL || source == ESP_SLEEP_WAKEUP_EXT0) {
+    s_ext0Pin = -1;
+  }
+  if (source == ESP_SLEEP_WAKEUP_ALL || source == ESP_SLEEP_WAKEUP_GPIO) {
+    s_gpioWakeEnabled = false;
+  }
+  if (source == ESP_SLEEP_WAKEUP_ALL || source == ESP_SLEEP_WAKEUP_UART) {
+    s_uartWakeEnabled = false;
+  }
+  return ESP_OK;
+}
+
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause() {
+  return s_wakeCause;
+}
+
+esp_err_t gpio_wakeup_enable(gpio_num_t pin, gpio_int_type_t type) {
+  if (pin < 0 || pin >= SIM_GPIO_COUNT ||
+      (type != GPIO_INTR_LOW_LEVEL && type != GPIO_INTR_HIGH_LEVEL)) {
+    return ESP_ERR_INVALID_ARG;   // Light sleep wake is level triggered only
+  }
+  std::lock_guard<std::mutex> guard(s_sleepMutex);
+  if (!s_gpioWakeInit) {
+    memset(s_gpioWakeLevel, -1, sizeof(s_gpioWakeLevel));
+    s_gpioWakeInit = true;
+  }
+  s_gpioWakeLevel[pin] = (type == GPIO_INTR_HIGH_LEVEL) ? HIGH : LOW;
+  return ESP_OK;
+}
+
+esp_err_t gpio_wakeup_disable(gpio_num_t pin) {
+  if (pin < 0 || pin >= SIM_GPIO_COUNT) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  std::lock_guard<std::mutex> guard(s_sleepMutex);
+  if (s_gpioWakeInit) {
+    s_gpioWakeLevel[pin] = -1;
+  }
+  return ESP_OK;
+}
+
+esp_err_t uart_set_wakeup_threshold(uart_port_t uartNum, int edges) {
+  // Any byte wakes the simulator; the threshold only has to be legal
+  return (uartNum == UART_NUM_0 && edges >= 3 && edges <= 0x3FF) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+struct SleepConfig {
+  uint64_t timerUs;
+  int ext0Pin;
+  int ext0Level;
+  bool gpio;
+  bool uart;
+  int8_t gpioLevel[SIM_GPIO_COUNT];
+};
+
+static SleepConfig sleepConfig() {
+  std::lock_guard<std::mutex> guard(s_sleepMutex);
+  SleepConfig config;
+  config.timerUs = s_timerWakeUs;
+  config.ext0Pin = s_ext0Pin;
+  config.ext0Level = s_ext0Level;
+  config.gpio = s_gpioWakeEnabled && s_gpioWakeInit;
+  config.uart = s_uartWakeEnabled;
+  if (s_gpioWakeInit) {
+    memcpy(config.gpioLevel, s_gpioWakeLevel, sizeof(config.gpioLevel));
+  } else {
+    memset(config.gpioLevel, -1, sizeof(config.gpioLevel));
+  }
+  return config;
+}
+
+/**
+ * Level-check the wake sources, then block until one changes or the timer
+ * expires. The checks come after reading the wake sequence so an edge that
+ * lands between the check and the wait still ends the wait.
+ */
+static esp_sleep_wakeup_cause_t sleepUntilWake(const SleepConfig& config, bool lightSleep) {
+  uint64_t deadline = (config.timerUs > 0) ? sim::bootUs() + config.timerUs : 0;
+  for (;;) {
+    uint32_t seen = sim::wakeSequence();
+    if (config.ext0Pin >= 0 && digitalRead(config.ext0Pin) == config.ext0Level) {
+      return ESP_SLEEP_WAKEUP_EXT0;
+    }
+    if (lightSleep && config.gpio) {
+      for (int pin = 0; pin < SIM_GPIO_COUNT; pin++) {
+        if (config.gpioLevel[pin] >= 0 && digitalRead(pin) == config.gpioLevel[pin]) {
+          return ESP_SLEEP_WAKEUP_GPIO;
+        }
+      }
+    }
+    if (lightSleep && config.uart && Serial.available() > 0) {
+      return ESP_SLEEP_WAKEUP_UART;
+    }
+    uint64_t now = sim::bootUs();
+    if (deadline != 0 && now >= deadline) {
+      return ESP_SLEEP_WAKEUP_TIMER;
+    }
+    sim::waitForWake(seen, (deadline != 0) ? deadline - now : 0);
+  }
+}
+
+esp_err_t esp_light_sleep_start() {
+  SleepConfig config = sleepConfig();
+  if (config.timerUs == 0 && config.ext0Pin < 0 && !config.gpio && !config.uart) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  fflush(stdout);
+  s_wakeCause = sleepUntilWake(config, true);
+  return ESP_OK;
+}
+
+void esp_deep_sleep_start() {
+  SleepConfig config = sleepConfig();
+  if (config.timerUs == 0 && config.ext0Pin < 0) {
+    sim::log("deep sleep with no wake source; only a restart of the program ends it");
+  } else {
+    sim::log("deep sleep (timer %llu ms, ext0 GPIO%d)", (unsigned long long)(config.timerUs / 1000), config.ext0Pin);
+  }
+  fflush(stdout);
+  esp_sleep_wakeup_cause_t cause = sleepUntilWake(config, false);
+  sim::log("deep sleep wake (%s)", cause == ESP_SLEEP_WAKEUP_EXT0 ? "EXT0" : "timer");
+  saveRtc(ESP_RST_DEEPSLEEP, cause);
+  sim::reboot();
+}
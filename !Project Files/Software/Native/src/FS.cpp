@@ -0,0 +1,342 @@
+/*
+  Filename: FS.cpp
+  Arduino-ESP32 File System Implementation (native)
+
+  Description: A File shares one open FILE* or DIR* between its copies, like
+               the core's shared FileImpl; the handle closes when the last
+               copy goes away or close() is called.
+*/
+
+#include "FS.h"
+
+#include <atomic>
+#include <dirent.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "SimHost.h"
+
+namespace fs {
+
+static std::atomic<uint64_t> s_opens(0);
+static std::atomic<uint64_t> s_entriesListed(0);
+static std::atomic<uint64_t> s_writes(0);
+static std::atomic<uint64_t> s_bytesWritten(0);
+static std::atomic<uint64_t> s_bytesRead(0);
+static std::atomic<uint64_t> s_removes(0);
+
+OpCounts opCounts() {
+  OpCounts counts;
+  counts.opens = s_opens.load();
+  counts.entriesListed = s_entriesListed.load();
+  counts.writes = s_writes.load();
+  counts.bytesWritten = s_bytesWritten.load();
+  counts.bytesRead = s_bytesRead.load();
+  counts.removes = s_removes.load();
+  return counts;
+}
+
+struct FileImpl {
+  std::string path;       // Path inside the mount, "/dir/name"
+  std::string host;       // Host path
+  FILE* file = nullptr;
+  DIR* dir = nullptr;
+
+  ~FileImpl() { closeHandles(); }
+
+  void closeHandles() {
+    if (file != nullptr) {
+      fclose(file);
+      file = nullptr;
+    }
+    if (dir != nullptr) {
+      closedir(dir);
+      dir = nullptr;
+    }
+  }
+};
+
+File::operator bool() const {
+  return _impl && (_impl->file != nullptr || _impl->dir != nullptr);
+}
+
+size_t File::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t File::write(const uint8_t* buffer, size_t size) {
+  if (!_impl || _impl->file == nullptr) {
+    return 0;
+  }
+  size_t written = fwrite(buffer, 1, size, _impl->file);
+  s_writes++;
+  s_bytesWritten += written;
+  return written;
+}
+
+int File::available() {
+  if (!_impl || _impl->file == nullptr) {
+    return 0;
+  }
+  size_t total = size();
+  size_t at = position();
+  return (at < total) ? (int)(total - at) : 0;
+}
+
+int File::read() {
+  if (!_impl || _impl->file == nullptr) {
+    return -1;
+  }
+  int c = fgetc(_impl->file);
+  if (c == EOF) {
+    return -1;
+  }
+  s_bytesRead++;
+  return c;
+}
+
+int File::peek() {
+  if (!_impl || _impl->file == nullptr) {
+    return -1;
+  }
+  int c = fgetc(_impl->file);
+  if (c == EOF) {
+    return -1;
+  }
+  ungetc(c, _impl->file);
+  return c;
+}
+
+void File::flush() {
+  if (_impl && _impl->file != nullptr) {
+    fflush(_impl->file);
+  }
+}
+
+size_t File::read(uint8_t* buffer, size_t size) {
+  if (!_impl || _impl->file == nullptr) {
+    return 0;
+  }
+  size_t got = fread(buffer, 1, size, _impl->file);
+  s_bytesRead += got;
+  return got;
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+  if (!_impl || _impl->file == nullptr) {
+    return false;
+  }
+  static const int WHENCE[3] = {SEEK_SET, SEEK_CUR, SEEK_END};
+  return fseek(_impl->file, (long)pos, WHENCE[mode]) == 0;
+}
+
+size_t File::position() const {
+  if (!_impl || _impl->file == nullptr) {
+    return 0;
+  }
+  long at = ftell(_impl->file);
+  return (at < 0) ? 0 : (size_t)at;
+}
+
+size_t File::size() const {
+  if (!_impl || _impl->file == nullptr) {
+    return 0;
+  }
+  // Buffered writes count, as on the ESP32 VFS
+  fflush(_impl->file);
+  struct stat st;
+  return (fstat(fileno(_impl->file), &st) == 0) ? (size_t)st.st_size : 0;
+}
+
+void File::close() {
+  if (_impl) {
+    _impl->closeHandles();
+  }
+}
+
+time_t File::getLastWrite() {
+  if (!_impl) {
+    return 0;
+  }
+  if (_impl->file != nullptr) {
+    fflush(_impl->file);
+  }
+  struct stat st;
+  return (stat(_impl->host.c_str(), &st) == 0) ? st.st_mtime : 0;
+}
+
+const char* File::path() const {
+  return _impl ? _impl->path.c_str() : nullptr;
+}
+
+const char* File::name() const {
+  if (!_impl) {
+    return nullptr;
+  }
+  size_t slash = _impl->path.find_last_of('/');
+  return _impl->path.c_str() + ((slash == std::string::npos) ? 0 : slash + 1);
+}
+
+bool File::isDirectory() const {
+  return _impl && _impl->dir != nullptr;
+}
+
+File File::openNextFile(const char* mode) {
+  if (!_impl || _impl->dir == nullptr) {
+    return File();
+  }
+  for (;;) {
+    struct dirent* entry = readdir(_impl->dir);
+    if (entry == nullptr) {
+      return File();
+    }
+    if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+      continue;
+    }
+    std::shared_ptr<FileImpl> child = std::make_shared<FileImpl>();
+    child->path = _impl->path + ((_impl->path.size() > 1) ? "/" : "") + entry->d_name;
+    child->host = _impl->host + "/" + entry->d_name;
+    struct stat st;
+    if (stat(child->host.c_str(), &st) != 0) {
+      continue;
+    }
+    if (S_ISDIR(st.st_mode)) {
+      child->dir = opendir(child->host.c_str());
+    } else {
+      child->file = fopen(child->host.c_str(), mode);
+    }
+    s_entriesListed++;
+    s_opens++;
+    return File(child);
+  }
+}
+
+void File::rewindDirectory() {
+  if (_impl && _impl->dir != nullptr) {
+    rewinddir(_impl->dir);
+  }
+}
+
+// ---------------------------------------------------------------- FS
+
+bool FS::mountHost(const char* nodeSub) {
+  _root = sim::nodePath(nodeSub);
+  return !_root.empty();
+}
+
+std::string FS::hostPath(const char* path) const {
+  std::string host = _root;
+  if (path == nullptr || path[0] != '/') {
+    host += "/";
+  }
+  if (path != nullptr) {
+    host += path;
+  }
+  while (host.size() > _root.size() + 1 && host.back() == '/') {
+    host.pop_back();
+  }
+  return host;
+}
+
+File FS::open(const char* path, const char* mode, bool create) {
+  if (_root.empty() || path == nullptr || path[0] != '/') {
+    return File();
+  }
+  std::shared_ptr<FileImpl> impl = std::make_shared<FileImpl>();
+  impl->path = path;
+  if (impl->path.size() > 1 && impl->path.back() == '/') {
+    impl->path.pop_back();
+  }
+  impl->host = hostPath(path);
+
+  struct stat st;
+  bool found = stat(impl->host.c_str(), &st) == 0;
+  if (found && S_ISDIR(st.st_mode)) {
+    impl->dir = opendir(impl->host.c_str());
+    s_opens++;
+    return File(impl);
+  }
+  bool writing = (mode[0] == 'w' || mode[0] == 'a');
+  if (!found && !writing) {
+    return File();
+  }
+  if (!found && create) {
+    size_t slash = impl->host.find_last_of('/');
+    sim::makeDirs(impl->host.substr(0, slash));
+  }
+  impl->file = fopen(impl->host.c_str(), mode);
+  if (impl->file == nullptr) {
+    return File();
+  }
+  s_opens++;
+  return File(impl);
+}
+
+bool FS::exists(const char* path) {
+  if (_root.empty() || path == nullptr) {
+    return false;
+  }
+  struct stat st;
+  return stat(hostPath(path).c_str(), &st) == 0;
+}
+
+bool FS::remove(const char* path) {
+  if (_root.empty() || path == nullptr || unlink(hostPath(path).c_str()) != 0) {
+    return false;
+  }
+  s_removes++;
+  return true;
+}
+
+bool FS::rename(const char* pathFrom, const char* pathTo) {
+  if (_root.empty() || pathFrom == nullptr || pathTo == nullptr) {
+    return false;
+  }
+  return ::rename(hostPath(pathFrom).c_str(), hostPath(pathTo).c_str()) == 0;
+}
+
+bool FS::mkdir(const char* path) {
+  if (_root.empty() || path == nullptr) {
+    return false;
+  }
+  return ::mkdir(hostPath(path).c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+bool FS::rmdir(const char* path) {
+  return !_root.empty() && path != nullptr && ::rmdir(hostPath(path).c_str()) == 0;
+}
+
+static uint64_t usedBelow(const std::string& host, uint32_t blockSize) {
+  DIR* dir = opendir(host.c_str());
+  if (dir == nullptr) {
+    return 0;
+  }
+  uint64_t used = blockSize;   // The directory's own metadata block
+  struct dirent* entry;
+  while ((entry = readdir(dir)) != nullptr) {
+    if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+      continue;
+    }
+    std::string child = host + "/" + entry->d_name;
+    struct stat st;
+    if (stat(child.c_str(), &st) != 0) {
+      continue;
+    }
+    if (S_ISDIR(st.st_mode)) {
+      used += usedBelow(child, blockSize);
+    } else {
+      used += ((uint64_t)st.st_size + blockSize - 1) / blockSize * blockSize;
+    }
+  }
+  closedir(dir);
+  return used;
+}
+
+uint64_t FS::hostUsedBytes(uint32_t blockSize) const {
+  return _root.empty() ? 0 : usedBelow(_root, blockSize);
+}
+
+}  // namespace fs
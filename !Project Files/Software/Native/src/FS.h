@@ -0,0 +1,114 @@
+/*
+  Filename: FS.h
+  Arduino-ESP32 File System (native)
+
+  Description: fs::FS and fs::File over a host directory. SD, LittleFS and
+               SPIFFS each mount a folder under the node's directory, so
+               what the firmware writes can be inspected (and seeded) with
+               ordinary tools. Paths are absolute within the mount, as on the
+               ESP32; File::name() is the last path component.
+*/
+
+#ifndef FS_H
+#define FS_H
+
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <time.h>
+
+#include "Stream.h"
+
+#define FILE_READ   "r"
+#define FILE_WRITE  "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+// Work done on every mount since start, for models that count SD operations
+struct OpCounts {
+  uint64_t opens;           // Files and directories, openNextFile() included
+  uint64_t entriesListed;   // openNextFile() results
+  uint64_t writes;          // write() calls
+  uint64_t bytesWritten;
+  uint64_t bytesRead;
+  uint64_t removes;
+};
+
+OpCounts opCounts();
+
+enum SeekMode {
+  SeekSet = 0,
+  SeekCur = 1,
+  SeekEnd = 2
+};
+
+struct FileImpl;
+
+class File : public Stream {
+  public:
+    File() {}
+    explicit File(std::shared_ptr<FileImpl> impl) : _impl(impl) {}
+
+    operator bool() const;
+
+    using Print::write;
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    int available() override;
+    int read() override;
+    int peek() override;
+    void flush() override;
+    size_t read(uint8_t* buffer, size_t size);
+
+    bool seek(uint32_t pos, SeekMode mode = SeekSet);
+    size_t position() const;
+    size_t size() const;
+    void close();
+    time_t getLastWrite();
+
+    const char* path() const;
+    const char* name() const;
+
+    bool isDirectory() const;
+    File openNextFile(const char* mode = FILE_READ);
+    void rewindDirectory();
+
+  private:
+    std::shared_ptr<FileImpl> _impl;
+};
+
+class FS {
+  public:
+    File open(const char* path, const char* mode = FILE_READ, bool create = false);
+    File open(const String& path, const char* mode = FILE_READ, bool create = false) {
+      return open(path.c_str(), mode, create);
+    }
+    bool exists(const char* path);
+    bool exists(const String& path) { return exists(path.c_str()); }
+    bool remove(const char* path);
+    bool remove(const String& path) { return remove(path.c_str()); }
+    bool rename(const char* pathFrom, const char* pathTo);
+    bool rename(const String& pathFrom, const String& pathTo) { return rename(pathFrom.c_str(), pathTo.c_str()); }
+    bool mkdir(const char* path);
+    bool mkdir(const String& path) { return mkdir(path.c_str()); }
+    bool rmdir(const char* path);
+    bool rmdir(const String& path) { return rmdir(path.c_str()); }
+
+  protected:
+    std::string _root;      // Host directory backing "/"; empty until mounted
+
+    bool mountHost(const char* nodeSub);
+    void unmountHost() { _root.clear(); }
+    std::string hostPath(const char* path) const;
+    // Bytes in use below the root, each file rounded up to blockSize
+    uint64_t hostUsedBytes(uint32_t blockSize) const;
+};
+
+}  // namespace fs
+
+using fs::File;
+using fs::FS;
+
+#endif
@@ -0,0 +1,612 @@
+/*
+  Filename: FreeRTOS.cpp
+  FreeRTOS Kernel on POSIX Threads Implementation (native)
+
+  Description: Tasks, notifications, queues and semaphores. Blocking calls
+               wait on condition variables with the tick timeout converted to
+               milliseconds; portMAX_DELAY waits forever.
+*/
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+#include "SimHost.h"
+
+#define SIM_STACK_PAINT 0xA5
+
+struct tskTaskControlBlock {
+  std::string name;
+  TaskFunction_t code = nullptr;
+  void* params = nullptr;
+  uint32_t stackDepth = 0;        // Bytes the firmware asked for
+  UBaseType_t priority = 0;
+  BaseType_t coreId = tskNO_AFFINITY;
+  uint8_t* stackBase = nullptr;   // Lowest usable byte, just above the guard page
+  size_t stackSize = 0;
+  pthread_t thread;
+
+  std::mutex notifyMutex;
+  std::condition_variable notifyCv;
+  uint32_t notifyValue = 0;
+  bool notifyPending = false;
+};
+
+enum QueueKind {
+  QUEUE_PLAIN,
+  QUEUE_MUTEX,
+  QUEUE_RECURSIVE_MUTEX,
+  QUEUE_BINARY,
+  QUEUE_COUNTING
+};
+
+struct QueueDefinition {
+  std::mutex mutex;
+  std::condition_variable changed;
+  QueueKind kind = QUEUE_PLAIN;
+  UBaseType_t length = 0;
+  UBaseType_t itemSize = 0;
+  UBaseType_t head = 0;
+  UBaseType_t count = 0;
+  std::vector<uint8_t> storage;
+  tskTaskControlBlock* holder = nullptr;
+  UBaseType_t recursion = 0;
+};
+
+static std::mutex s_tasksMutex;
+static std::vector<tskTaskControlBlock*> s_tasks;
+static thread_local tskTaskControlBlock* t_current = nullptr;
+
+static void registerTask(tskTaskControlBlock* tcb) {
+  std::lock_guard<std::mutex> guard(s_tasksMutex);
+  s_tasks.push_back(tcb);
+}
+
+static void unregisterTask(tskTaskControlBlock* tcb) {
+  std::lock_guard<std::mutex> guard(s_tasksMutex);
+  s_tasks.erase(std::remove(s_tasks.begin(), s_tasks.end(), tcb), s_tasks.end());
+}
+
+// Threads FreeRTOS did not create (main, simulator threads) get a handle on first use
+static tskTaskControlBlock* currentTask() {
+  if (t_current == nullptr) {
+    tskTaskControlBlock* tcb = new tskTaskControlBlock();
+    tcb->name = (getpid() == (pid_t)syscall(SYS_gettid)) ? "main" : "sim";
+    tcb->thread = pthread_self();
+    t_current = tcb;
+    registerTask(tcb);
+  }
+  return t_current;
+}
+
+/**
+ * Wait on cv until ready() or the tick timeout
+ * @return the final ready() result
+ */
+template <typename Ready>
+static bool waitTicks(std::unique_lock<std::mutex>& lock, std::condition_variable& cv, TickType_t ticks,
+                      Ready ready) {
+  if (ticks == portMAX_DELAY) {
+    cv.wait(lock, ready);
+    return true;
+  }
+  return cv.wait_for(lock, std::chrono::microseconds(sim::hostUs((uint64_t)pdTICKS_TO_MS(ticks) * 1000ULL)), ready);
+}
+
+void vPortMuxInitialize(portMUX_TYPE* mux) {
+  pthread_mutexattr_t attr;
+  pthread_mutexattr_init(&attr);
+  pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+  pthread_mutex_init(&mux->mutex, &attr);
+  pthread_mutexattr_destroy(&attr);
+}
+
+BaseType_t xPortGetCoreID() {
+  BaseType_t core = currentTask()->coreId;
+  return (core >= 0 && core < portNUM_PROCESSORS) ? core : 0;
+}
+
+BaseType_t xPortInIsrContext() {
+  return pdFALSE;
+}
+
+// ---------------------------------------------------------------- Tasks
+
+static void* taskEntry(void* arg) {
+  tskTaskControlBlock* tcb = static_cast<tskTaskControlBlock*>(arg);
+  t_current = tcb;
+  pthread_setname_np(pthread_self(), tcb->name.substr(0, 15).c_str());
+  tcb->code(tcb->params);
+  // Same rule as the ESP-IDF port: a task function must never return
+  sim::log("task \"%s\" returned without vTaskDelete(), aborting", tcb->name.c_str());
+  abort();
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char* name, uint32_t stackDepth, void* params,
+                                   UBaseType_t priority, TaskHandle_t* created, BaseType_t coreId) {
+  size_t page = (size_t)sysconf(_SC_PAGESIZE);
+  size_t size = std::max<size_t>((size_t)stackDepth * SIM_TASK_STACK_SCALE, SIM_TASK_STACK_MIN);
+  size = (size + page - 1) / page * page;
+  void* map = mmap(nullptr, size + page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+  if (map == MAP_FAILED) {
+    sim::log("no memory for task \"%s\" stack", name);
+    return pdFAIL;
+  }
+  mprotect(map, page, PROT_NONE);   // Guard page: an overflow faults here
+
+  tskTaskControlBlock* tcb = new tskTaskControlBlock();
+  tcb->name = name != nullptr ? name : "";
+  tcb->code = code;
+  tcb->params = params;
+  tcb->stackDepth = stackDepth;
+  tcb->priority = priority;
+  tcb->coreId = coreId;
+  tcb->stackBase = static_cast<uint8_t*>(map) + page;
+  tcb->stackSize = size;
+  memset(tcb->stackBase, SIM_STACK_PAINT, size);
+
+  registerTask(tcb);
+  if (created != nullptr) {
+    *created = tcb;   // Visible before the task runs, as in FreeRTOS
+  }
+
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setstack(&attr, tcb->stackBase, size);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+  int rc = pthread_create(&tcb->thread, &attr, taskEntry, tcb);
+  pthread_attr_destroy(&attr);
+  if (rc != 0) {
+    sim::log("pthread_create for \"%s\" failed (%d)", tcb->name.c_str(), rc);
+    if (created != nullptr) {
+      *created = nullptr;
+    }
+    unregisterTask(tcb);
+    munmap(map, size + page);
+    delete tcb;
+    return pdFAIL;
+  }
+  return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t code, const char* name, uint32_t stackDepth, void* params,
+                       UBaseType_t priority, TaskHandle_t* created) {
+  return xTaskCreatePinnedToCore(code, name, stackDepth, params, priority, created, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+  tskTaskControlBlock* self = currentTask();
+  if (task == nullptr || task == self) {
+    unregisterTask(self);
+    // The stack mapping is still in use until the thread is gone; it is left mapped
+    pthread_exit(nullptr);
+  }
+  sim::log("vTaskDelete(\"%s\") from another task is not simulated; the task keeps running",
+           task->name.c_str());
+}
+
+void vTaskDelay(TickType_t ticks) {
+  if (ticks == 0) {
+    sched_yield();
+    return;
+  }
+  sim::sleepUs((uint64_t)pdTICKS_TO_MS(ticks) * 1000ULL);
+}
+
+BaseType_t xTaskDelayUntil(TickType_t* previousWake, TickType_t increment) {
+  TickType_t target = *previousWake + increment;
+  int32_t remaining = (int32_t)(target - xTaskGetTickCount());
+  *previousWake = target;
+  if (remaining > 0) {
+    vTaskDelay((TickType_t)remaining);
+    return pdTRUE;
+  }
+  return pdFALSE;
+}
+
+void vTaskDelayUntil(TickType_t* previousWake, TickType_t increment) {
+  xTaskDelayUntil(previousWake, increment);
+}
+
+TickType_t xTaskGetTickCount() {
+  return (TickType_t)(sim::bootUs() / (1000000ULL / configTICK_RATE_HZ));
+}
+
+TickType_t xTaskGetTickCountFromISR() {
+  return xTaskGetTickCount();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+  return currentTask();
+}
+
+TaskHandle_t xTaskGetHandle(const char* name) {
+  std::lock_guard<std::mutex> guard(s_tasksMutex);
+  for (tskTaskControlBlock* tcb : s_tasks) {
+    if (tcb->name == name) {
+      return tcb;
+    }
+  }
+  return nullptr;
+}
+
+char* pcTaskGetName(TaskHandle_t task) {
+  tskTaskControlBlock* tcb = task != nullptr ? task : currentTask();
+  return const_cast<char*>(tcb->name.c_str());
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+  tskTaskControlBlock* tcb = task != nullptr ? task : currentTask();
+  if (tcb->stackBase == nullptr) {
+    return 0;   // Not a FreeRTOS task: nothing was painted
+  }
+  // The stack grows down, so untouched paint sits at the low end
+  size_t untouched = 0;
+  while (untouched < tcb->stackSize && tcb->stackBase[untouched] == SIM_STACK_PAINT) {
+    untouched++;
+  }
+  size_t used = tcb->stackSize - untouched;
+  return used >= tcb->stackDepth ? 0 : (UBaseType_t)(tcb->stackDepth - used);
+}
+
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task) {
+  return (task != nullptr ? task : currentTask())->priority;
+}
+
+void vTaskPrioritySet(TaskHandle_t task, UBaseType_t priority) {
+  (task != nullptr ? task : currentTask())->priority = priority;
+}
+
+UBaseType_t uxTaskGetNumberOfTasks() {
+  std::lock_guard<std::mutex> guard(s_tasksMutex);
+  return (UBaseType_t)s_tasks.size();
+}
+
+BaseType_t xTaskGetAffinity(TaskHandle_t task) {
+  return (task != nullptr ? task : currentTask())->coreId;
+}
+
+// -------------------------------------------------------- Notifications
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action) {
+  if (task == nullptr) {
+    return pdFAIL;
+  }
+  std::lock_guard<std::mutex> guard(task->notifyMutex);
+  BaseType_t result = pdPASS;
+  switch (action) {
+    case eSetBits:
+      task->notifyValue |= value;
+      break;
+    case eIncrement:
+      task->notifyValue++;
+      break;
+    case eSetValueWithOverwrite:
+      task->notifyValue = value;
+      break;
+    case eSetValueWithoutOverwrite:
+      if (task->notifyPending) {
+        result = pdFAIL;
+      } else {
+        task->notifyValue = value;
+      }
+      break;
+    case eNoAction:
+      break;
+  }
+  task->notifyPending = true;
+  task->notifyCv.notify_all();
+  return result;
+}
+
+BaseType_t xTaskNotifyFromISR(TaskHandle_t task, uint32_t value, eNotifyAction action,
+                              BaseType_t* higherPriorityTaskWoken) {
+  if (higherPriorityTaskWoken != nullptr) {
+    *higherPriorityTaskWoken = pdFALSE;
+  }
+  return xTaskNotify(task, value, action);
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+  return xTaskNotify(task, 0, eIncrement);
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higherPriorityTaskWoken) {
+  xTaskNotifyFromISR(task, 0, eIncrement, higherPriorityTaskWoken);
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait) {
+  tskTaskControlBlock* self = currentTask();
+  std::unique_lock<std::mutex> lock(self->notifyMutex);
+  waitTicks(lock, self->notifyCv, ticksToWait, [self] { return self->notifyValue != 0; });
+  uint32_t value = self->notifyValue;
+  if (value != 0) {
+    self->notifyValue = clearCountOnExit ? 0 : value - 1;
+  }
+  self->notifyPending = false;
+  return value;
+}
+
+BaseType_t xTaskNotifyWait(uint32_t clearOnEntry, uint32_t clearOnExit, uint32_t* value, TickType_t ticksToWait) {
+  tskTaskControlBlock* self = currentTask();
+  std::unique_lock<std::mutex> lock(self->notifyMutex);
+  if (!self->notifyPending) {
+    self->notifyValue &= ~clearOnEntry;
+  }
+  bool received = waitTicks(lock, self->notifyCv, ticksToWait, [self] { return self->notifyPending; });
+  if (value != nullptr) {
+    *value = self->notifyValue;
+  }
+  if (!received) {
+    return pdFALSE;
+  }
+  self->notifyValue &= ~clearOnExit;
+  self->notifyPending = false;
+  return pdTRUE;
+}
+
+// --------------------------------------------------------------- Queues
+
+static QueueDefinition* createQueue(QueueKind kind, UBaseType_t length, UBaseType_t itemSize, UBaseType_t count) {
+  if (length == 0) {
+    return nullptr;
+  }
+  QueueDefinition* queue = new QueueDefinition();
+  queue->kind = kind;
+  queue->length = length;
+  queue->itemSize = itemSize;
+  queue->count = count;
+  queue->storage.resize((size_t)length * itemSize);
+  return queue;
+}
+
+static BaseType_t queueSend(QueueHandle_t queue, const void* item, TickType_t ticksToWait, bool front,
+                            bool overwrite) {
+  if (queue == nullptr) {
+    return errQUEUE_FULL;
+  }
+  std::unique_lock<std::mutex> lock(queue->mutex);
+  if (overwrite && queue->count == queue->length) {
+    queue->count--;   // Length-1 queue: replace the waiting item
+  }
+  if (!waitTicks(lock, queue->changed, ticksToWait, [queue] { return queue->count < queue->length; })) {
+    return errQUEUE_FULL;
+  }
+  if (queue->itemSize > 0) {
+    UBaseType_t slot;
+    if (front) {
+      queue->head = (queue->head + queue->length - 1) % queue->length;
+      slot = queue->head;
+    } else {
+      slot = (queue->head + queue->count) % queue->length;
+    }
+    memcpy(&queue->storage[(size_t)slot * queue->itemSize], item, queue->itemSize);
+  }
+  queue->count++;
+  queue->changed.notify_all();
+  return pdPASS;
+}
+
+static BaseType_t queueReceive(QueueHandle_t queue, void* item, TickType_t ticksToWait, bool peek) {
+  if (queue == nullptr) {
+    return errQUEUE_EMPTY;
+  }
+  std::unique_lock<std::mutex> lock(queue->mutex);
+  if (!waitTicks(lock, queue->changed, ticksToWait, [queue] { return queue->count > 0; })) {
+    return errQUEUE_EMPTY;
+  }
+  if (queue->itemSize > 0 && item != nullptr) {
+    memcpy(item, &queue->storage[(size_t)queue->head * queue->itemSize], queue->itemSize);
+  }
+  if (!peek) {
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    queue->changed.notify_all();
+  }
+  return pdPASS;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+  return createQueue(QUEUE_PLAIN, length, itemSize, 0);
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+  delete queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticksToWait) {
+  return queueSend(queue, item, ticksToWait, false, false);
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void* item, TickType_t ticksToWait) {
+  return queueSend(queue, item, ticksToWait, false, false);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t queue, const void* item, TickType_t ticksToWait) {
+  return queueSend(queue, item, ticksToWait, true, false);
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void* item, BaseType_t* higherPriorityTaskWoken) {
+  if (higherPriorityTaskWoken != nullptr) {
+    *higherPriorityTaskWoken = pdFALSE;
+  }
+  return queueSend(queue, item, 0, false, false);
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void* item) {
+  return queueSend(queue, item, 0, false, true);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticksToWait) {
+  return queueReceive(queue, item, ticksToWait, false);
+}
+
+BaseType_t xQueueReceiveFromISR(QueueHandle_t queue, void* item, BaseType_t* higherPriorityTaskWoken) {
+  if (higherPriorityTaskWoken != nullptr) {
+    *higherPriorityTaskWoken = pdFALSE;
+  }
+  return queueReceive(queue, item, 0, false);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void* item, TickType_t ticksToWait) {
+  return queueReceive(queue, item, ticksToWait, true);
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+  if (queue == nullptr) {
+    return 0;
+  }
+  std::lock_guard<std::mutex> guard(queue->mutex);
+  return queue->count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue) {
+  if (queue == nullptr) {
+    return 0;
+  }
+  std::lock_guard<std::mutex> guard(queue->mutex);
+  return queue->length - queue->count;
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue) {
+  if (queue == nullptr) {
+    return pdFAIL;
+  }
+  std::lock_guard<std::mutex> guard(queue->mutex);
+  queue->head = 0;
+  queue->count = 0;
+  queue->changed.notify_all();
+  return pdPASS;
+}
+
+// ----------------------------------------------------------- Semaphores
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+  return createQueue(QUEUE_MUTEX, 1, 0, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() {
+  return createQueue(QUEUE_RECURSIVE_MUTEX, 1, 0, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+  return createQueue(QUEUE_BINARY, 1, 0, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initialCount) {
+  return createQueue(QUEUE_COUNTING, maxCount, 0, std::min(initialCount, maxCount));
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+  delete semaphore;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait) {
+  if (semaphore == nullptr) {
+    return pdFAIL;
+  }
+  tskTaskControlBlock* self = currentTask();
+  std::unique_lock<std::mutex> lock(semaphore->mutex);
+  if (semaphore->kind == QUEUE_MUTEX && semaphore->holder == self && ticksToWait == portMAX_DELAY) {
+    sim::log("task \"%s\" takes a mutex it already holds and will block forever", self->name.c_str());
+  }
+  if (!waitTicks(lock, semaphore->changed, ticksToWait, [semaphore] { return semaphore->count > 0; })) {
+    return pdFAIL;
+  }
+  semaphore->count--;
+  if (semaphore->kind == QUEUE_MUTEX || semaphore->kind == QUEUE_RECURSIVE_MUTEX) {
+    semaphore->holder = self;
+    semaphore->recursion = 1;
+  }
+  return pdPASS;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+  if (semaphore == nullptr) {
+    return pdFAIL;
+  }
+  std::lock_guard<std::mutex> guard(semaphore->mutex);
+  if (semaphore->kind == QUEUE_MUTEX || semaphore->kind == QUEUE_RECURSIVE_MUTEX) {
+    if (semaphore->holder != currentTask()) {
+      return pdFAIL;
+    }
+    semaphore->holder = nullptr;
+    semaphore->recursion = 0;
+  }
+  if (semaphore->count >= semaphore->length) {
+    return pdFAIL;
+  }
+  semaphore->count++;
+  semaphore->changed.notify_all();
+  return pdPASS;
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t mutex, TickType_t ticksToWait) {
+  if (mutex == nullptr) {
+    return pdFAIL;
+  }
+  {
+    std::lock_guard<std::mutex> guard(mutex->mutex);
+    if (mutex->holder == currentTask()) {
+      mutex->recursion++;
+      return pdPASS;
+    }
+  }
+  return xSemaphoreTake(mutex, ticksToWait);
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t mutex) {
+  if (mutex == nullptr) {
+    return pdFAIL;
+  }
+  {
+    std::lock_guard<std::mutex> guard(mutex->mutex);
+    if (mutex->holder != currentTask()) {
+      return pdFAIL;
+    }
+    if (mutex->recursion > 1) {
+      mutex->recursion--;
+      return pdPASS;
+    }
+  }
+  return xSemaphoreGive(mutex);
+}
+
+BaseType_t xSemaphoreTakeFromISR(SemaphoreHandle_t semaphore, BaseType_t* higherPriorityTaskWoken) {
+  if (higherPriorityTaskWoken != nullptr) {
+    *higherPriorityTaskWoken = pdFALSE;
+  }
+  return xSemaphoreTake(semaphore, 0);
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t* higherPriorityTaskWoken) {
+  if (higherPriorityTaskWoken != nullptr) {
+    *higherPriorityTaskWoken = pdFALSE;
+  }
+  return xSemaphoreGive(semaphore);
+}
+
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t semaphore) {
+  return uxQueueMessagesWaiting(semaphore);
+}
+
+TaskHandle_t xSemaphoreGetMutexHolder(SemaphoreHandle_t mutex) {
+  if (mutex == nullptr) {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> guard(mutex->mutex);
+  return mutex->holder;
+}
@@ -0,0 +1,108 @@
+/*
+  Filename: HardwareSerial.cpp
+  Serial Port on stdin/stdout Implementation (native)
+
+  Description: Input is paced at the baud rate and the RX ring drops bytes
+               when full, like the UART driver does, so a loop() that drains
+               too slowly sees realistic overruns.
+*/
+
+#include "HardwareSerial.h"
+
+#include <mutex>
+#include <pthread.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "SimHost.h"
+#include "esp_sleep.h"
+
+HardwareSerial Serial(0);
+
+static std::mutex s_rxMutex;
+static uint8_t s_rxRing[SERIAL_RX_RING_SIZE];
+static size_t s_rxHead = 0;
+static size_t s_rxCount = 0;
+static bool s_readerStarted = false;
+static unsigned long s_baud = 115200;
+
+static void* stdinReader(void*) {
+  uint8_t chunk[64];
+  for (;;) {
+    ssize_t got = ::read(STDIN_FILENO, chunk, sizeof(chunk));
+    if (got <= 0) {
+      sim::log("stdin closed, serial RX idle");
+      return nullptr;
+    }
+    // Bytes reach the ring at the line rate (10 bits per byte), so piped
+    // scripts arrive the way a terminal at SERIAL_BAUD_RATE would send them
+    sim::sleepUs((uint64_t)got * 10000000ULL / s_baud);
+    uint32_t dropped = 0;
+    {
+      std::lock_guard<std::mutex> guard(s_rxMutex);
+      for (ssize_t i = 0; i < got; i++) {
+        if (s_rxCount == SERIAL_RX_RING_SIZE) {
+          dropped++;
+          continue;
+        }
+        s_rxRing[(s_rxHead + s_rxCount) % SERIAL_RX_RING_SIZE] = chunk[i];
+        s_rxCount++;
+      }
+    }
+    if (dropped > 0) {
+      sim::log("serial RX ring full, %u bytes dropped", (unsigned)dropped);
+    }
+    sim::wake(ESP_SLEEP_WAKEUP_UART);
+  }
+}
+
+HardwareSerial::HardwareSerial(int uartNum) : _uartNum(uartNum) {}
+
+void HardwareSerial::begin(unsigned long baud, uint32_t, int8_t, int8_t) {
+  std::lock_guard<std::mutex> guard(s_rxMutex);
+  if (s_readerStarted || _uartNum != 0) {
+    return;
+  }
+  if (baud > 0) {
+    s_baud = baud;
+  }
+  s_readerStarted = true;
+  setvbuf(stdout, nullptr, _IOLBF, 0);
+  pthread_t thread;
+  if (pthread_create(&thread, nullptr, stdinReader, nullptr) == 0) {
+    pthread_detach(thread);
+  }
+}
+
+int HardwareSerial::available() {
+  std::lock_guard<std::mutex> guard(s_rxMutex);
+  return (int)s_rxCount;
+}
+
+int HardwareSerial::read() {
+  std::lock_guard<std::mutex> guard(s_rxMutex);
+  if (s_rxCount == 0) {
+    return -1;
+  }
+  uint8_t c = s_rxRing[s_rxHead];
+  s_rxHead = (s_rxHead + 1) % SERIAL_RX_RING_SIZE;
+  s_rxCount--;
+  return c;
+}
+
+int HardwareSerial::peek() {
+  std::lock_guard<std::mutex> guard(s_rxMutex);
+  return s_rxCount > 0 ? s_rxRing[s_rxHead] : -1;
+}
+
+void HardwareSerial::flush() {
+  fflush(stdout);
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  return fputc(c, stdout) == EOF ? 0 : 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+  return fwrite(buffer, 1, size, stdout);
+}
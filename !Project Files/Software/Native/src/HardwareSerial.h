@@ -0,0 +1,50 @@
+/*
+  Filename: HardwareSerial.h
+  Serial Port on stdin/stdout (native)
+
+  Description: Serial reads the process's stdin through a reader thread
+               and an RX ring sized like the ESP32 UART driver's, and writes
+               to stdout. A byte arriving on stdin also wakes light sleep
+               (the UART wake source). Close stdin (or redirect it from
+               /dev/null) to run headless.
+*/
+
+#ifndef HARDWARE_SERIAL_H
+#define HARDWARE_SERIAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Stream.h"
+
+#define SERIAL_RX_RING_SIZE   256
+#define SERIAL_TX_RING_SIZE   128
+#define SERIAL_8N1            0x800001c
+
+class HardwareSerial : public Stream {
+  public:
+    explicit HardwareSerial(int uartNum);
+
+    void begin(unsigned long baud, uint32_t config = SERIAL_8N1, int8_t rxPin = -1, int8_t txPin = -1);
+    void end() {}
+    void setRxBufferSize(size_t) {}
+    void setTxBufferSize(size_t) {}
+    operator bool() const { return true; }
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    int availableForWrite() override { return SERIAL_TX_RING_SIZE; }
+    void flush() override;
+
+    using Print::write;
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+
+  private:
+    int _uartNum;
+};
+
+extern HardwareSerial Serial;
+
+#endif
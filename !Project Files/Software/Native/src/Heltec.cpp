@@ -0,0 +1,59 @@
+/*
+  Filename: Heltec.cpp
+  Heltec ESP32 Dev-Boards Implementation (native)
+*/
+
+#include "heltec.h"
+
+#include <algorithm>
+#include <stdio.h>
+
+#include "SimHost.h"
+
+const uint8_t ArialMT_Plain_10[] = {10};
+const uint8_t ArialMT_Plain_16[] = {16};
+const uint8_t ArialMT_Plain_24[] = {24};
+
+Heltec_ESP32 Heltec;
+
+static SSD1306Wire s_display;
+
+void Heltec_ESP32::begin(bool displayEnable, bool, bool serialEnable, bool, long) {
+  if (serialEnable) {
+    Serial.begin(115200);
+  }
+  if (displayEnable) {
+    s_display.init();
+    display = &s_display;
+  }
+}
+
+void SSD1306Wire::setContrast(uint8_t contrast, uint8_t, uint8_t) {
+  _contrast = contrast;
+}
+
+void SSD1306Wire::drawString(int16_t x, int16_t y, const char* text) {
+  if (text == nullptr || y >= SIM_OLED_HEIGHT || x >= SIM_OLED_WIDTH) {
+    return;
+  }
+  _lines.push_back({x, y, text});
+}
+
+void SSD1306Wire::display() {
+  // Page address commands plus the 1024-byte buffer, 9 clocks per byte
+  delayMicroseconds((uint32_t)((SIM_OLED_WIDTH * SIM_OLED_HEIGHT / 8 + 6) * 9ULL * 1000000ULL / SIM_OLED_I2C_HZ));
+
+  std::vector<Line> lines = _lines;
+  std::stable_sort(lines.begin(), lines.end(), [](const Line& a, const Line& b) { return a.y < b.y; });
+  std::string path = sim::nodePath("") + "/oled.txt";
+  std::string temp = path + ".tmp";
+  FILE* file = fopen(temp.c_str(), "w");
+  if (file == nullptr) {
+    return;
+  }
+  for (const Line& line : lines) {
+    fprintf(file, "%*s%s\n", line.x / 6, "", line.text.c_str());
+  }
+  fclose(file);
+  rename(temp.c_str(), path.c_str());
+}
@@ -0,0 +1,31 @@
+/*
+  Filename: LittleFS.h
+  LittleFS on Flash (native)
+
+  Description: The partition is <node>/littlefs with the capacity of the
+               V3's default "spiffs" partition. Used space counts whole 4 KB
+               blocks per file and directory, so StoreForward's fill checks
+               see roughly what the flash would report.
+*/
+
+#ifndef LITTLEFS_H
+#define LITTLEFS_H
+
+#include "FS.h"
+
+#define SIM_FLASH_FS_BYTES  (1408 * 1024)
+#define SIM_FLASH_FS_BLOCK  4096
+
+class LittleFSFS : public fs::FS {
+  public:
+    bool begin(bool formatOnFail = false, const char* basePath = "/littlefs", uint8_t maxOpenFiles = 10,
+               const char* partitionLabel = "spiffs");
+    void end() { unmountHost(); }
+    bool format();
+    size_t totalBytes() { return SIM_FLASH_FS_BYTES; }
+    size_t usedBytes() { return (size_t)hostUsedBytes(SIM_FLASH_FS_BLOCK); }
+};
+
+extern LittleFSFS LittleFS;
+
+#endif
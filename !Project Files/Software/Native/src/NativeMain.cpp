@@ -0,0 +1,64 @@
+/*
+  Filename: NativeMain.cpp
+  Native Program Entry
+
+  Description: Boots a simulated board: restores RTC memory and the I2C
+               chips' state (deep sleep wake or restart), starts the "loopTask" that runs setup() and
+               loop() like the Arduino-ESP32 core, and turns SIGUSR1 into a
+               load event on the simulated sensors. WABASH_SIM_REPLAY
+               swaps in recorded sensor data first (SimReplay.h).
+*/
+
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "Arduino.h"
+#include "SimHost.h"
+#include "SimI2C.h"
+#include "SimReplay.h"
+#include "SimSensors.h"
+
+#define SIM_LOOP_TASK_STACK  8192    // CONFIG_ARDUINO_LOOP_STACK_SIZE
+#define SIM_LOOP_TASK_CORE   1       // ARDUINO_RUNNING_CORE
+
+static void loopTask(void*) {
+  setup();
+  for (;;) {
+    loop();
+  }
+}
+
+static void onLoadSignal(int) {
+  sim::triggerLoadEvent();
+}
+
+int main(int argc, char** argv) {
+  sim::bootUs();
+  sim::setArgs(argc, argv);
+  sim::restoreRtc();
+  // External chips kept power through a deep sleep or restart, not a power cycle
+  sim::restoreI2CDevices(esp_reset_reason() != ESP_RST_POWERON);
+
+  // A peer closing its socket must not kill the board
+  signal(SIGPIPE, SIG_IGN);
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = onLoadSignal;
+  action.sa_flags = SA_RESTART;
+  sigaction(SIGUSR1, &action, nullptr);
+
+  sim::log("boot (pid %d, reset reason %d, files in %s)", (int)getpid(), (int)esp_reset_reason(),
+           sim::nodePath("").c_str());
+  sim::markHeapBaseline();
+  sim::startReplay();
+
+  TaskHandle_t loopHandle = nullptr;
+  if (xTaskCreatePinnedToCore(loopTask, "loopTask", SIM_LOOP_TASK_STACK, nullptr, 1, &loopHandle,
+                              SIM_LOOP_TASK_CORE) != pdPASS) {
+    return 1;
+  }
+  for (;;) {
+    pause();
+  }
+}
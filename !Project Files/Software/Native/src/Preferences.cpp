@@ -0,0 +1,187 @@
+/*
+  Filename: Preferences.cpp
+  Arduino-ESP32 Preferences Implementation (native)
+*/
+
+#include "Preferences.h"
+
+#include <dirent.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "SimHost.h"
+
+#define SIM_NVS_ENTRIES 504   // 24 KB default NVS partition, 32-byte entries, 3 pages reserved
+
+bool Preferences::begin(const char* name, bool readOnly, const char*) {
+  if (name == nullptr || name[0] == '\0' || strlen(name) > SIM_NVS_KEY_MAX) {
+    sim::log("Preferences: bad namespace \"%s\"", name != nullptr ? name : "");
+    return false;
+  }
+  std::string dir = sim::rootDir() + std::string("/") + sim::nodeName() + "/nvs/" + name;
+  struct stat st;
+  if (stat(dir.c_str(), &st) != 0) {
+    if (readOnly) {
+      return false;   // nvs_open(NVS_READONLY) on a namespace never written
+    }
+    if (!sim::makeDirs(dir)) {
+      return false;
+    }
+  }
+  _dir = dir;
+  _readOnly = readOnly;
+  _open = true;
+  return true;
+}
+
+bool Preferences::validKey(const char* key) const {
+  return _open && key != nullptr && key[0] != '\0' && strlen(key) <= SIM_NVS_KEY_MAX &&
+         strchr(key, '/') == nullptr;
+}
+
+bool Preferences::clear() {
+  if (!_open || _readOnly) {
+    return false;
+  }
+  DIR* dir = opendir(_dir.c_str());
+  if (dir == nullptr) {
+    return false;
+  }
+  struct dirent* entry;
+  while ((entry = readdir(dir)) != nullptr) {
+    if (entry->d_name[0] != '.') {
+      unlink((_dir + "/" + entry->d_name).c_str());
+    }
+  }
+  closedir(dir);
+  return true;
+}
+
+bool Preferences::remove(const char* key) {
+  return validKey(key) && !_readOnly && unlink(keyPath(key).c_str()) == 0;
+}
+
+bool Preferences::isKey(const char* key) {
+  struct stat st;
+  return validKey(key) && stat(keyPath(key).c_str(), &st) == 0;
+}
+
+size_t Preferences::freeEntries() {
+  // Roughly one entry per key plus one per 32 bytes of value, over every namespace
+  size_t used = 0;
+  std::string nvs = sim::nodePath("nvs");
+  DIR* namespaces = opendir(nvs.c_str());
+  if (namespaces == nullptr) {
+    return SIM_NVS_ENTRIES;
+  }
+  struct dirent* ns;
+  while ((ns = readdir(namespaces)) != nullptr) {
+    if (ns->d_name[0] == '.') {
+      continue;
+    }
+    std::string nsDir = nvs + "/" + ns->d_name;
+    DIR* keys = opendir(nsDir.c_str());
+    if (keys == nullptr) {
+      continue;
+    }
+    used++;
+    struct dirent* key;
+    while ((key = readdir(keys)) != nullptr) {
+      struct stat st;
+      if (key->d_name[0] != '.' && stat((nsDir + "/" + key->d_name).c_str(), &st) == 0) {
+        used += 1 + (size_t)(st.st_size + 31) / 32;
+      }
+    }
+    closedir(keys);
+  }
+  closedir(namespaces);
+  return (used < SIM_NVS_ENTRIES) ? SIM_NVS_ENTRIES - used : 0;
+}
+
+size_t Preferences::putValue(const char* key, Type type, const void* value, size_t len) {
+  if (!validKey(key) || _readOnly) {
+    return 0;
+  }
+  // Write then rename, so a crash mid-write keeps the old value like NVS does
+  std::string path = keyPath(key);
+  std::string temp = path + ".tmp";
+  FILE* file = fopen(temp.c_str(), "wb");
+  if (file == nullptr) {
+    return 0;
+  }
+  bool ok = fwrite(&type, 1, 1, file) == 1 && (len == 0 || fwrite(value, 1, len, file) == len);
+  ok = (fclose(file) == 0) && ok;
+  if (!ok || rename(temp.c_str(), path.c_str()) != 0) {
+    unlink(temp.c_str());
+    return 0;
+  }
+  return len;
+}
+
+long Preferences::readValue(const char* key, Type type, void* buffer, size_t maxLen) {
+  if (!validKey(key)) {
+    return -1;
+  }
+  FILE* file = fopen(keyPath(key).c_str(), "rb");
+  if (file == nullptr) {
+    return -1;
+  }
+  uint8_t stored = 0;
+  long len = -1;
+  if (fread(&stored, 1, 1, file) == 1 && stored == type) {
+    std::vector<uint8_t> data;
+    uint8_t chunk[256];
+    size_t got;
+    while ((got = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+      data.insert(data.end(), chunk, chunk + got);
+    }
+    len = (long)data.size();
+    if (buffer != nullptr) {
+      memcpy(buffer, data.data(), (data.size() < maxLen) ? data.size() : maxLen);
+    }
+  }
+  fclose(file);
+  return len;
+}
+
+size_t Preferences::putString(const char* key, const char* value) {
+  // NVS keeps the terminator
+  return putValue(key, TYPE_STR, value, strlen(value) + 1);
+}
+
+size_t Preferences::getString(const char* key, char* value, size_t maxLen) {
+  long len = readValue(key, TYPE_STR, nullptr, 0);
+  if (len <= 0 || value == nullptr || (size_t)len > maxLen) {
+    return 0;
+  }
+  readValue(key, TYPE_STR, value, maxLen);
+  return (size_t)len;
+}
+
+String Preferences::getString(const char* key, const String& defaultValue) {
+  long len = readValue(key, TYPE_STR, nullptr, 0);
+  if (len <= 0) {
+    return defaultValue;
+  }
+  std::vector<char> text((size_t)len);
+  readValue(key, TYPE_STR, text.data(), text.size());
+  text.back() = '\0';
+  return String(text.data());
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+  long len = readValue(key, TYPE_BLOB, nullptr, 0);
+  return (len < 0) ? 0 : (size_t)len;
+}
+
+size_t Preferences::getBytes(const char* key, void* buffer, size_t maxLen) {
+  long len = readValue(key, TYPE_BLOB, nullptr, 0);
+  if (len < 0 || buffer == nullptr || (size_t)len > maxLen) {
+    return 0;   // The core refuses a short buffer rather than truncating
+  }
+  readValue(key, TYPE_BLOB, buffer, maxLen);
+  return (size_t)len;
+}
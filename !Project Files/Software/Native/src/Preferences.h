@@ -0,0 +1,92 @@
+/*
+  Filename: Preferences.h
+  Arduino-ESP32 Preferences (native)
+
+  Description: NVS namespaces are folders under <node>/nvs and each key is
+               one file: a type byte, then the value. Names follow the NVS
+               limit of 15 characters, a read-only begin() on a namespace
+               that was never written fails, and reading a key as the wrong
+               type returns the default, all as on the ESP32.
+*/
+
+#ifndef PREFERENCES_H
+#define PREFERENCES_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+#include "WString.h"
+
+#define SIM_NVS_KEY_MAX 15
+
+class Preferences {
+  public:
+    Preferences() : _open(false), _readOnly(false) {}
+
+    bool begin(const char* name, bool readOnly = false, const char* partitionLabel = nullptr);
+    void end() { _open = false; }
+    bool clear();
+    bool remove(const char* key);
+    bool isKey(const char* key);
+    size_t freeEntries();
+
+    size_t putChar(const char* key, int8_t value) { return putValue(key, TYPE_I8, &value, sizeof(value)); }
+    size_t putUChar(const char* key, uint8_t value) { return putValue(key, TYPE_U8, &value, sizeof(value)); }
+    size_t putShort(const char* key, int16_t value) { return putValue(key, TYPE_I16, &value, sizeof(value)); }
+    size_t putUShort(const char* key, uint16_t value) { return putValue(key, TYPE_U16, &value, sizeof(value)); }
+    size_t putInt(const char* key, int32_t value) { return putValue(key, TYPE_I32, &value, sizeof(value)); }
+    size_t putUInt(const char* key, uint32_t value) { return putValue(key, TYPE_U32, &value, sizeof(value)); }
+    size_t putLong(const char* key, int32_t value) { return putInt(key, value); }
+    size_t putULong(const char* key, uint32_t value) { return putUInt(key, value); }
+    size_t putLong64(const char* key, int64_t value) { return putValue(key, TYPE_I64, &value, sizeof(value)); }
+    size_t putULong64(const char* key, uint64_t value) { return putValue(key, TYPE_U64, &value, sizeof(value)); }
+    size_t putFloat(const char* key, float value) { return putValue(key, TYPE_BLOB, &value, sizeof(value)); }
+    size_t putDouble(const char* key, double value) { return putValue(key, TYPE_BLOB, &value, sizeof(value)); }
+    size_t putBool(const char* key, bool value) { return putUChar(key, value ? 1 : 0); }
+    size_t putString(const char* key, const char* value);
+    size_t putString(const char* key, const String& value) { return putString(key, value.c_str()); }
+    size_t putBytes(const char* key, const void* value, size_t len) { return putValue(key, TYPE_BLOB, value, len); }
+
+    int8_t getChar(const char* key, int8_t defaultValue = 0) { return getValue(key, TYPE_I8, defaultValue); }
+    uint8_t getUChar(const char* key, uint8_t defaultValue = 0) { return getValue(key, TYPE_U8, defaultValue); }
+    int16_t getShort(const char* key, int16_t defaultValue = 0) { return getValue(key, TYPE_I16, defaultValue); }
+    uint16_t getUShort(const char* key, uint16_t defaultValue = 0) { return getValue(key, TYPE_U16, defaultValue); }
+    int32_t getInt(const char* key, int32_t defaultValue = 0) { return getValue(key, TYPE_I32, defaultValue); }
+    uint32_t getUInt(const char* key, uint32_t defaultValue = 0) { return getValue(key, TYPE_U32, defaultValue); }
+    int32_t getLong(const char* key, int32_t defaultValue = 0) { return getInt(key, defaultValue); }
+    uint32_t getULong(const char* key, uint32_t defaultValue = 0) { return getUInt(key, defaultValue); }
+    int64_t getLong64(const char* key, int64_t defaultValue = 0) { return getValue(key, TYPE_I64, defaultValue); }
+    uint64_t getULong64(const char* key, uint64_t defaultValue = 0) { return getValue(key, TYPE_U64, defaultValue); }
+    float getFloat(const char* key, float defaultValue = 0) { return getValue(key, TYPE_BLOB, defaultValue); }
+    double getDouble(const char* key, double defaultValue = 0) { return getValue(key, TYPE_BLOB, defaultValue); }
+    bool getBool(const char* key, bool defaultValue = false) { return getUChar(key, defaultValue ? 1 : 0) != 0; }
+    String getString(const char* key, const String& defaultValue = String());
+    size_t getString(const char* key, char* value, size_t maxLen);
+    size_t getBytesLength(const char* key);
+    size_t getBytes(const char* key, void* buffer, size_t maxLen);
+
+  private:
+    enum Type : uint8_t {
+      TYPE_U8 = 0x01, TYPE_I8 = 0x11, TYPE_U16 = 0x02, TYPE_I16 = 0x12, TYPE_U32 = 0x04, TYPE_I32 = 0x14,
+      TYPE_U64 = 0x08, TYPE_I64 = 0x18, TYPE_STR = 0x21, TYPE_BLOB = 0x42
+    };
+
+    std::string _dir;
+    bool _open;
+    bool _readOnly;
+
+    bool validKey(const char* key) const;
+    std::string keyPath(const char* key) const { return _dir + "/" + key; }
+    size_t putValue(const char* key, Type type, const void* value, size_t len);
+    // Value length, or -1 if the key is missing or of another type
+    long readValue(const char* key, Type type, void* buffer, size_t maxLen);
+
+    template <typename T>
+    T getValue(const char* key, Type type, T defaultValue) {
+      T value;
+      return (readValue(key, type, &value, sizeof(T)) == (long)sizeof(T)) ? value : defaultValue;
+    }
+};
+
+#endif
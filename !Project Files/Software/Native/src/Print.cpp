@@ -0,0 +1,117 @@
+/*
+  Filename: Print.cpp
+  Arduino Print Implementation (native)
+
+  Description: Numbers are formatted into a stack buffer and written in one
+               write() call, as the ESP32 core does, so a println() of a
+               String costs two writes (text, then CR LF).
+*/
+
+#include "Print.h"
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static size_t printNumber(Print& out, unsigned long long value, bool negative, int base) {
+  char text[68];
+  char* pos = &text[sizeof(text) - 1];
+  *pos = '\0';
+  if (base < 2) {
+    base = 10;
+  }
+  do {
+    int digit = (int)(value % (unsigned)base);
+    *--pos = (char)(digit < 10 ? '0' + digit : 'A' + digit - 10);
+    value /= (unsigned)base;
+  } while (value != 0);
+  if (negative) {
+    *--pos = '-';
+  }
+  return out.write(pos);
+}
+
+static size_t printSigned(Print& out, long long value, int base, unsigned long long mask) {
+  if (base == DEC) {
+    if (value < 0) {
+      return printNumber(out, 0ULL - (unsigned long long)value, true, base);
+    }
+    return printNumber(out, (unsigned long long)value, false, base);
+  }
+  // Non-decimal bases print the two's complement bit pattern of the original width
+  return printNumber(out, (unsigned long long)value & mask, false, base);
+}
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+  size_t n = 0;
+  while (size-- > 0) {
+    if (write(*buffer++) == 0) {
+      break;
+    }
+    n++;
+  }
+  return n;
+}
+
+size_t Print::printf(const char* format, ...) {
+  char stackBuffer[128];
+  va_list args;
+  va_start(args, format);
+  int len = vsnprintf(stackBuffer, sizeof(stackBuffer), format, args);
+  va_end(args);
+  if (len < 0) {
+    return 0;
+  }
+  if ((size_t)len < sizeof(stackBuffer)) {
+    return write((const uint8_t*)stackBuffer, (size_t)len);
+  }
+  char* heapBuffer = (char*)malloc((size_t)len + 1);
+  if (heapBuffer == nullptr) {
+    return 0;
+  }
+  va_start(args, format);
+  vsnprintf(heapBuffer, (size_t)len + 1, format, args);
+  va_end(args);
+  size_t n = write((const uint8_t*)heapBuffer, (size_t)len);
+  free(heapBuffer);
+  return n;
+}
+
+size_t Print::print(const String& text) { return write((const uint8_t*)text.c_str(), text.length()); }
+size_t Print::print(const char* text) { return write(text); }
+size_t Print::print(char c) { return write((uint8_t)c); }
+size_t Print::print(unsigned char value, int base) { return printNumber(*this, value, false, base); }
+size_t Print::print(int value, int base) { return printSigned(*this, value, base, 0xFFFFFFFFULL); }
+size_t Print::print(unsigned int value, int base) { return printNumber(*this, value, false, base); }
+size_t Print::print(long value, int base) { return printSigned(*this, value, base, ~0ULL); }
+size_t Print::print(unsigned long value, int base) { return printNumber(*this, value, false, base); }
+size_t Print::print(long long value, int base) { return printSigned(*this, value, base, ~0ULL); }
+size_t Print::print(unsigned long long value, int base) { return printNumber(*this, value, false, base); }
+size_t Print::print(const Printable& value) { return value.printTo(*this); }
+
+size_t Print::print(double value, int digits) {
+  if (isnan(value)) {
+    return write("nan");
+  }
+  if (isinf(value)) {
+    return write(value < 0 ? "-inf" : "inf");
+  }
+  char text[64];
+  int len = snprintf(text, sizeof(text), "%.*f", digits < 0 ? 0 : digits, value);
+  return len > 0 ? write((const uint8_t*)text, (size_t)len) : 0;
+}
+
+size_t Print::println() { return write("\r\n"); }
+size_t Print::println(const String& text) { return print(text) + println(); }
+size_t Print::println(const char* text) { return print(text) + println(); }
+size_t Print::println(char c) { return print(c) + println(); }
+size_t Print::println(unsigned char value, int base) { return print(value, base) + println(); }
+size_t Print::println(int value, int base) { return print(value, base) + println(); }
+size_t Print::println(unsigned int value, int base) { return print(value, base) + println(); }
+size_t Print::println(long value, int base) { return print(value, base) + println(); }
+size_t Print::println(unsigned long value, int base) { return print(value, base) + println(); }
+size_t Print::println(long long value, int base) { return print(value, base) + println(); }
+size_t Print::println(unsigned long long value, int base) { return print(value, base) + println(); }
+size_t Print::println(double value, int digits) { return print(value, digits) + println(); }
+size_t Print::println(const Printable& value) { return print(value) + println(); }
@@ -0,0 +1,509 @@
+/*
+  Filename: RadioLib.cpp
+  RadioLib SX1262 Implementation (native)
+
+  Description: One datagram per transmission, sent to every other node's
+               socket as the transmission starts. The receiving air thread
+               holds it until its time on air has passed, so overlaps can be
+               detected, then completes it into the FIFO and raises DIO1.
+               Loss is decided per receiving node when a packet arrives.
+*/
+
+#include "RadioLib.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <functional>
+#include <math.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "Arduino.h"
+#include "SimHost.h"
+
+#define SIM_AIR_MAGIC    0x4C4F5241   // "LORA"
+#define SIM_AIR_POLL_MS  50
+
+// One transmission on the shared air; times are on sim::sharedClockUs() so every node agrees
+struct SimAirPacket {
+  uint32_t magic;
+  float freq;
+  float bw;
+  uint8_t sf;
+  uint8_t cr;
+  uint8_t syncWord;
+  uint8_t length;
+  uint64_t startUs;
+  uint32_t airtimeUs;
+  char sender[32];
+  uint8_t data[RADIOLIB_SX126X_MAX_PACKET_LENGTH];
+};
+
+#define SIM_AIR_HEADER_SIZE  offsetof(SimAirPacket, data)
+
+static float envFloat(const char* name, float fallback) {
+  const char* value = getenv(name);
+  return (value != nullptr && value[0] != '\0') ? strtof(value, nullptr) : fallback;
+}
+
+static bool validBandwidth(float bw) {
+  static const float VALID[] = {7.8f, 10.4f, 15.6f, 20.8f, 31.25f, 41.7f, 62.5f, 125.0f, 250.0f, 500.0f};
+  for (size_t i = 0; i < sizeof(VALID) / sizeof(VALID[0]); i++) {
+    if (fabsf(VALID[i] - bw) < 0.01f) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Lowest SNR the SX1262 demodulates at a spreading factor (datasheet table 6-1)
+static float snrFloor(uint8_t sf) {
+  return -2.5f * (float)(sf - 4);
+}
+
+static std::string socketPath(const char* node) {
+  return sim::sharedPath("lora") + "/" + node + ".sock";
+}
+
+SX1262::SX1262(Module* module)
+    : _module(module), _dio1(module->getIrq()), _mode(MODE_SLEEP), _irq(IRQ_NONE), _freq(434.0f),
+      _bw(125.0f), _sf(9), _cr(7), _syncWord(RADIOLIB_SX126X_SYNC_WORD_PRIVATE), _power(10), _preamble(8),
+      _rxLength(0), _rxReadyUs(0), _lossGoodToBad(0.0), _lossBadToGood(1.0), _lossBad(false), _socket(-1),
+      _airRunning(false) {
+  memset(_fifo, 0, sizeof(_fifo));
+  memset(&_stats, 0, sizeof(_stats));
+  _turnaroundUs = (uint32_t)envFloat("WABASH_SIM_LORA_TURNAROUND_US", SIM_LORA_DEFAULT_TURNAROUND_US);
+
+  // Gilbert-Elliott: bad-state share = loss, mean bad run = burst packets
+  double loss = envFloat("WABASH_SIM_LORA_LOSS", 0.0f);
+  double burst = envFloat("WABASH_SIM_LORA_BURST", 1.0f);
+  loss = (loss < 0.0) ? 0.0 : (loss > 1.0) ? 1.0 : loss;
+  if (burst <= 1.0 || loss >= 1.0) {
+    // Independent losses: both states draw with the same odds
+    _lossGoodToBad = loss;
+    _lossBadToGood = 1.0 - loss;
+  } else if (loss > 0.0) {
+    _lossBadToGood = 1.0 / burst;
+    _lossGoodToBad = loss / (burst * (1.0 - loss));
+    if (_lossGoodToBad > 1.0) {
+      sim::log("LoRa: loss %.2f cannot be reached with bursts of %.1f; using %.2f", loss, burst, burst / (burst + 1.0));
+      _lossGoodToBad = 1.0;
+    }
+  }
+  _lossRng.seed(sim::seed() ^ (uint32_t)std::hash<std::string>()(sim::nodeName()));
+}
+
+SX1262::~SX1262() {
+  if (_airRunning.exchange(false) && _airThread.joinable()) {
+    _airThread.join();
+  }
+  if (_socket >= 0) {
+    close(_socket);
+    unlink(socketPath(sim::nodeName()).c_str());
+  }
+}
+
+int16_t SX1262::begin(float freq, float bw, uint8_t sf, uint8_t cr, uint8_t syncWord, int8_t power,
+                      uint16_t preambleLength, float, bool) {
+  int16_t state = setFrequency(freq);
+  if (state == RADIOLIB_ERR_NONE) state = setBandwidth(bw);
+  if (state == RADIOLIB_ERR_NONE) state = setSpreadingFactor(sf);
+  if (state == RADIOLIB_ERR_NONE) state = setCodingRate(cr);
+  if (state == RADIOLIB_ERR_NONE) state = setSyncWord(syncWord);
+  if (state == RADIOLIB_ERR_NONE) state = setOutputPower(power);
+  if (state == RADIOLIB_ERR_NONE) state = setPreambleLength(preambleLength);
+  if (state != RADIOLIB_ERR_NONE) {
+    return state;
+  }
+  if (!openAir()) {
+    return RADIOLIB_ERR_CHIP_NOT_FOUND;
+  }
+  pinMode(_dio1, INPUT);
+  return standby();
+}
+
+bool SX1262::openAir() {
+  if (_socket >= 0) {
+    return true;
+  }
+  std::string path = socketPath(sim::nodeName());
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(addr.sun_path)) {
+    sim::log("LoRa: socket path too long: %s", path.c_str());
+    return false;
+  }
+  strcpy(addr.sun_path, path.c_str());
+
+  int fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    sim::log("LoRa: socket failed: %s", strerror(errno));
+    return false;
+  }
+  // A previous run (or this node before a deep sleep re-exec) may have left it behind
+  unlink(path.c_str());
+  if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+    sim::log("LoRa: bind %s failed: %s", path.c_str(), strerror(errno));
+    close(fd);
+    return false;
+  }
+  _socket = fd;
+  _airRunning = true;
+  _airThread = std::thread(&SX1262::airLoop, this);
+  return true;
+}
+
+uint32_t SX1262::getTimeOnAir(size_t len) {
+  std::lock_guard<std::mutex> guard(_mutex);
+  // SX1261/2 datasheet 6.1.4, CRC on, explicit header
+  double symbolUs = (double)(1UL << _sf) * 1000.0 / _bw;
+  bool lowDataRate = symbolUs >= 16000.0;
+  int bits = 8 * (int)len + 16 - 4 * _sf + 8 + 20;
+  int bitsPerBlock = 4 * (_sf - (lowDataRate ? 2 : 0));
+  int blocks = (bits > 0) ? (bits + bitsPerBlock - 1) / bitsPerBlock : 0;
+  double symbols = (double)_preamble + 4.25 + 8.0 + (double)(blocks * _cr);
+  return (uint32_t)(symbols * symbolUs);
+}
+
+int16_t SX1262::transmit(const char* str, uint8_t addr) {
+  return transmit((const uint8_t*)str, strlen(str), addr);
+}
+
+int16_t SX1262::transmit(const uint8_t* data, size_t len, uint8_t) {
+  if (len > RADIOLIB_SX126X_MAX_PACKET_LENGTH) {
+    return RADIOLIB_ERR_PACKET_TOO_LONG;
+  }
+  if (_socket < 0) {
+    return RADIOLIB_ERR_CHIP_NOT_FOUND;
+  }
+  uint32_t airtimeUs = getTimeOnAir(len);
+  clearIrq();
+
+  SimAirPacket packet;
+  memset(&packet, 0, SIM_AIR_HEADER_SIZE);
+  {
+    std::lock_guard<std::mutex> guard(_mutex);
+    _mode = MODE_TX;
+    memcpy(_fifo, data, len);
+    packet.magic = SIM_AIR_MAGIC;
+    packet.freq = _freq;
+    packet.bw = _bw;
+    packet.sf = _sf;
+    packet.cr = _cr;
+    packet.syncWord = _syncWord;
+    _stats.sent++;
+  }
+  saveStats();
+  // PA ramp and mode switch before the preamble goes out
+  sim::sleepUs(_turnaroundUs);
+  packet.length = (uint8_t)len;
+  packet.startUs = sim::sharedClockUs();
+  packet.airtimeUs = airtimeUs;
+  strncpy(packet.sender, sim::nodeName(), sizeof(packet.sender) - 1);
+  memcpy(packet.data, data, len);
+
+  std::string dir = sim::sharedPath("lora");
+  std::string self = std::string(sim::nodeName()) + ".sock";
+  DIR* peers = opendir(dir.c_str());
+  if (peers != nullptr) {
+    struct dirent* entry;
+    while ((entry = readdir(peers)) != nullptr) {
+      size_t nameLen = strlen(entry->d_name);
+      if (nameLen < 6 || strcmp(entry->d_name + nameLen - 5, ".sock") != 0 || self == entry->d_name) {
+        continue;
+      }
+      struct sockaddr_un peer;
+      memset(&peer, 0, sizeof(peer));
+      peer.sun_family = AF_UNIX;
+      snprintf(peer.sun_path, sizeof(peer.sun_path), "%s/%s", dir.c_str(), entry->d_name);
+      // A node that is down (socket left behind) simply does not hear it
+      sendto(_socket, &packet, SIM_AIR_HEADER_SIZE + len, MSG_DONTWAIT, (struct sockaddr*)&peer, sizeof(peer));
+    }
+    closedir(peers);
+  }
+
+  // Blocking transmit polls for TX done, then the chip drops to standby
+  sim::sleepUs(airtimeUs);
+  {
+    std::lock_guard<std::mutex> guard(_mutex);
+    _mode = MODE_STANDBY;
+  }
+  raiseDio1(IRQ_TX_DONE);
+  return RADIOLIB_ERR_NONE;
+}
+
+int16_t SX1262::startReceive() {
+  if (_socket < 0) {
+    return RADIOLIB_ERR_CHIP_NOT_FOUND;
+  }
+  clearIrq();
+  std::lock_guard<std::mutex> guard(_mutex);
+  if (_mode != MODE_RX) {
+    _rxReadyUs = sim::sharedClockUs() + _turnaroundUs;
+  }
+  _mode = MODE_RX;
+  return RADIOLIB_ERR_NONE;
+}
+
+int16_t SX1262::readData(uint8_t* data, size_t len) {
+  bool crcError;
+  {
+    std::lock_guard<std::mutex> guard(_mutex);
+    crcError = (_irq & IRQ_CRC_ERR) != 0;
+    size_t count = (len == 0 || len > _rxLength) ? _rxLength : len;
+    memcpy(data, _fifo, count);
+  }
+  clearIrq();
+  return crcError ? RADIOLIB_ERR_CRC_MISMATCH : RADIOLIB_ERR_NONE;
+}
+
+int16_t SX1262::readData(String& str, size_t len) {
+  size_t length = (len == 0) ? getPacketLength() : len;
+  char text[RADIOLIB_SX126X_MAX_PACKET_LENGTH + 1];
+  if (length > RADIOLIB_SX126X_MAX_PACKET_LENGTH) {
+    length = RADIOLIB_SX126X_MAX_PACKET_LENGTH;
+  }
+  int16_t state = readData((uint8_t*)text, length);
+  text[length] = '\0';
+  str = String(text);
+  return state;
+}
+
+size_t SX1262::getPacketLength(bool) {
+  std::lock_guard<std::mutex> guard(_mutex);
+  return _rxLength;
+}
+
+float SX1262::getRSSI() {
+  return envFloat("WABASH_SIM_RSSI", SIM_LORA_DEFAULT_RSSI);
+}
+
+float SX1262::getSNR() {
+  return envFloat("WABASH_SIM_SNR", SIM_LORA_DEFAULT_SNR);
+}
+
+int16_t SX1262::standby() {
+  std::lock_guard<std::mutex> guard(_mutex);
+  _mode = MODE_STANDBY;
+  return RADIOLIB_ERR_NONE;
+}
+
+int16_t SX1262::sleep(bool) {
+  std::lock_guard<std::mutex> guard(_mutex);
+  _mode = MODE_SLEEP;
+  return RADIOLIB_ERR_NONE;
+}
+
+void SX1262::setDio1Action(void (*func)(void)) {
+  attachInterrupt(digitalPinToInterrupt(_dio1), func, RISING);
+}
+
+void SX1262::clearDio1Action() {
+  detachInterrupt(digitalPinToInterrupt(_dio1));
+}
+
+int16_t SX1262::setFrequency(float freq) {
+  if (freq < 150.0f || freq > 960.0f) {
+    return RADIOLIB_ERR_INVALID_FREQUENCY;
+  }
+  std::lock_guard<std::mutex> guard(_mutex);
+  _freq = freq;
+  return RADIOLIB_ERR_NONE;
+}
+
+int16_t SX1262::setBandwidth(float bw) {
+  if (!validBandwidth(bw)) {
+    return RADIOLIB_ERR_INVALID_BANDWIDTH;
+  }
+  std::lock_guard<std::mutex> guard(_mutex);
+  _bw = bw;
+  return RADIOLIB_ERR_NONE;
+}
+
+int16_t SX1262::setSpreadingFactor(uint8_t sf) {
+  if (sf < 5 || sf > 12) {
+    return RADIOLIB_ERR_INVALID_SPREADING_FACTOR;
+  }
+  std::lock_guard<std::mutex> guard(_mutex);
+  _sf = sf;
+  return RADIOLIB_ERR_NONE;
+}
+
+int16_t SX1262::setCodingRate(uint8_t cr) {
+  if (cr < 5 || cr > 8) {
+    return RADIOLIB_ERR_INVALID_CODING_RATE;
+  }
+  std::lock_guard<std::mutex> guard(_mutex);
+  _cr = cr;
+  return RADIOLIB_ERR_NONE;
+}
+
+int16_t SX1262::setSyncWord(uint8_t syncWord) {
+  std::lock_guard<std::mutex> guard(_mutex);
+  _syncWord = syncWord;
+  return RADIOLIB_ERR_NONE;
+}
+
+int16_t SX1262::setOutputPower(int8_t power) {
+  if (power < -9 || power > 22) {
+    return RADIOLIB_ERR_INVALID_OUTPUT_POWER;
+  }
+  std::lock_guard<std::mutex> guard(_mutex);
+  _power = power;
+  return RADIOLIB_ERR_NONE;
+}
+
+int16_t SX1262::setPreambleLength(uint16_t preambleLength) {
+  if (preambleLength == 0) {
+    return RADIOLIB_ERR_INVALID_PREAMBLE_LENGTH;
+  }
+  std::lock_guard<std::mutex> guard(_mutex);
+  _preamble = preambleLength;
+  return RADIOLIB_ERR_NONE;
+}
+
+void SX1262::raiseDio1(uint8_t irq) {
+  {
+    std::lock_guard<std::mutex> guard(_mutex);
+    _irq |= irq;
+  }
+  // Outside the lock: the attached handler runs from here
+  sim::driveGpio((uint8_t)_dio1, HIGH);
+}
+
+void SX1262::clearIrq() {
+  {
+    std::lock_guard<std::mutex> guard(_mutex);
+    _irq = IRQ_NONE;
+  }
+  sim::driveGpio((uint8_t)_dio1, LOW);
+}
+
+// Called with _mutex held
+bool SX1262::channelLoses() {
+  if (_lossGoodToBad <= 0.0) {
+    return false;
+  }
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  double draw = uniform(_lossRng);
+  _lossBad = _lossBad ? (draw >= _lossBadToGood) : (draw < _lossGoodToBad);
+  return _lossBad;
+}
+
+void SX1262::saveStats() {
+  SimLoraStats stats;
+  {
+    std::lock_guard<std::mutex> guard(_mutex);
+    stats = _stats;
+  }
+  // The transmitting task and the air thread both save; one writer at a time
+  std::lock_guard<std::mutex> guard(_statsFileMutex);
+  std::string path = sim::nodePath("") + "/lora.txt";
+  std::string temp = path + ".tmp";
+  FILE* file = fopen(temp.c_str(), "w");
+  if (file == nullptr) {
+    return;
+  }
+  fprintf(file, "sent=%u\nreceived=%u\ncrc_errors=%u\ncollided=%u\nlost=%u\nmissed=%u\nweak=%u\nignored=%u\n",
+          stats.sent, stats.received, stats.crcErrors, stats.collided, stats.lost, stats.missed, stats.weak,
+          stats.ignored);
+  fclose(file);
+  rename(temp.c_str(), path.c_str());
+}
+
+void SX1262::completeReception(const SimAirPacket& packet, bool corrupt) {
+  uint8_t irq = IRQ_NONE;
+  {
+    std::lock_guard<std::mutex> guard(_mutex);
+    if (_mode != MODE_RX) {
+      _stats.missed++;   // Left receive mid-packet
+    } else {
+      memcpy(_fifo, packet.data, packet.length);
+      _rxLength = packet.length;
+      irq = IRQ_RX_DONE | (corrupt ? IRQ_CRC_ERR : IRQ_NONE);
+      if (corrupt) {
+        _stats.crcErrors++;
+      } else {
+        _stats.received++;
+      }
+    }
+  }
+  saveStats();
+  if (irq != IRQ_NONE) {
+    raiseDio1(irq);
+  }
+}
+
+void SX1262::airLoop() {
+  SimAirPacket incoming;
+  SimAirPacket pending;
+  bool havePending = false;
+  bool pendingCorrupt = false;
+
+  while (_airRunning) {
+    int timeoutMs = SIM_AIR_POLL_MS;
+    if (havePending) {
+      uint64_t endUs = pending.startUs + pending.airtimeUs;
+      uint64_t now = sim::sharedClockUs();
+      timeoutMs = (endUs > now) ? (int)((sim::hostUs(endUs - now) + 999) / 1000) : 0;
+    }
+    struct pollfd pfd = {_socket, POLLIN, 0};
+    int ready = poll(&pfd, 1, timeoutMs);
+
+    if (ready > 0 && (pfd.revents & POLLIN)) {
+      ssize_t got = recv(_socket, &incoming, sizeof(incoming), 0);
+      if (got < (ssize_t)SIM_AIR_HEADER_SIZE || incoming.magic != SIM_AIR_MAGIC ||
+          got != (ssize_t)(SIM_AIR_HEADER_SIZE + incoming.length)) {
+        continue;
+      }
+      // A back-to-back packet can be read before the wait for the previous one ran out
+      if (havePending && incoming.startUs >= pending.startUs + pending.airtimeUs) {
+        havePending = false;
+        completeReception(pending, pendingCorrupt);
+      }
+      bool counted = true;
+      {
+        std::lock_guard<std::mutex> guard(_mutex);
+        if (_mode != MODE_RX || incoming.startUs < _rxReadyUs) {
+          _stats.missed++;   // Asleep, in standby, transmitting or still turning around: not heard
+        } else if (fabsf(incoming.freq - _freq) > 0.001f || fabsf(incoming.bw - _bw) > 0.01f ||
+                   incoming.sf != _sf || incoming.syncWord != _syncWord) {
+          sim::log("LoRa: ignored %s (%.1f MHz BW%.1f SF%u sync 0x%02X, listening %.1f MHz BW%.1f SF%u sync 0x%02X)",
+                   incoming.sender, incoming.freq, incoming.bw, incoming.sf, incoming.syncWord,
+                   _freq, _bw, _sf, _syncWord);
+          _stats.ignored++;
+        } else if (getSNR() < snrFloor(_sf)) {
+          _stats.weak++;     // Below the demodulation floor
+        } else if (channelLoses()) {
+          _stats.lost++;     // Faded: never detected, so it cannot collide either
+        } else if (havePending) {
+          // Already locked onto an earlier preamble; the overlap corrupts it
+          if (!pendingCorrupt) {
+            sim::log("LoRa: %s collided with %s", incoming.sender, pending.sender);
+          }
+          pendingCorrupt = true;
+          _stats.collided++;
+        } else {
+          memcpy(&pending, &incoming, SIM_AIR_HEADER_SIZE + incoming.length);
+          havePending = true;
+          pendingCorrupt = false;
+          counted = false;   // Counted when it completes
+        }
+      }
+      if (counted) {
+        saveStats();
+      }
+      continue;
+    }
+
+    if (havePending && sim::sharedClockUs() >= pending.startUs + pending.airtimeUs) {
+      havePending = false;
+      completeReception(pending, pendingCorrupt);
+    }
+  }
+}
@@ -0,0 +1,176 @@
+/*
+  Filename: RadioLib.h
+  RadioLib SX1262 (native)
+
+  Description: The SX1262 calls the firmware makes, over a shared "air":
+               every node on the same WABASH_SIM_DIR binds a datagram socket
+               in lora/ and a transmission goes to all of them. A packet is
+               heard only by a node that is in receive with the same
+               frequency, bandwidth, spreading factor and sync word, and it
+               lands after its time on air (Semtech formula, CRC on, explicit
+               header). Two packets overlapping at a receiver collide and the
+               first completes with a CRC error. transmit() blocks for the
+               time on air and leaves the radio in standby.
+
+               DIO1 is a simulated GPIO, raised on RX done and TX done and
+               lowered when the IRQ is cleared (startReceive / readData), so
+               attached interrupts and DIO1 light-sleep wake behave as on
+               hardware. As on the chip, TX and RX share the FIFO from
+               address 0.
+
+               The link can lose packets. Each receiving node runs a
+               two-state (Gilbert-Elliott) channel: a packet that arrives in
+               the bad state is never detected, so it neither lands nor
+               collides. The radio is deaf for a turnaround time after it
+               enters receive and waits the same before a transmission
+               starts. What each node sent, heard and missed is kept in
+               <node>/lora.txt.
+
+  Environment:
+    WABASH_SIM_RSSI                packet RSSI reported by getRSSI(), dBm (default -70)
+    WABASH_SIM_SNR                 packet SNR reported by getSNR(), dB (default 8); below
+                                   the spreading factor's demodulation floor nothing is heard
+    WABASH_SIM_LORA_LOSS           long-run fraction of packets this node loses (default 0)
+    WABASH_SIM_LORA_BURST          mean length of a loss burst in packets (default 1,
+                                   independent losses)
+    WABASH_SIM_LORA_TURNAROUND_US  standby/TX to RX and RX to TX switch time (default 300)
+*/
+
+#ifndef RADIOLIB_H
+#define RADIOLIB_H
+
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <stddef.h>
+#include <stdint.h>
+#include <thread>
+
+#include "WString.h"
+
+#define RADIOLIB_ERR_NONE                     0
+#define RADIOLIB_ERR_UNKNOWN                  -1
+#define RADIOLIB_ERR_CHIP_NOT_FOUND           -2
+#define RADIOLIB_ERR_PACKET_TOO_LONG          -4
+#define RADIOLIB_ERR_TX_TIMEOUT               -5
+#define RADIOLIB_ERR_RX_TIMEOUT               -6
+#define RADIOLIB_ERR_CRC_MISMATCH             -7
+#define RADIOLIB_ERR_INVALID_BANDWIDTH        -8
+#define RADIOLIB_ERR_INVALID_SPREADING_FACTOR -9
+#define RADIOLIB_ERR_INVALID_CODING_RATE      -10
+#define RADIOLIB_ERR_INVALID_FREQUENCY        -12
+#define RADIOLIB_ERR_INVALID_OUTPUT_POWER     -13
+#define RADIOLIB_ERR_INVALID_PREAMBLE_LENGTH  -18
+
+#define RADIOLIB_SX126X_MAX_PACKET_LENGTH     255
+#define RADIOLIB_SX126X_SYNC_WORD_PRIVATE     0x12
+
+#define SIM_LORA_DEFAULT_RSSI  -70.0f
+#define SIM_LORA_DEFAULT_SNR   8.0f
+#define SIM_LORA_DEFAULT_TURNAROUND_US  300
+
+// Per-node packet counts, written to <node>/lora.txt
+struct SimLoraStats {
+  uint32_t sent;          // Transmissions started
+  uint32_t received;      // Completed into the FIFO with a good CRC
+  uint32_t crcErrors;     // Completed with a CRC error (collisions)
+  uint32_t collided;      // Arrived while an earlier packet was still being received
+  uint32_t lost;          // Dropped by the loss model
+  uint32_t missed;        // Not in receive, still turning around or left receive mid-packet
+  uint32_t weak;          // Below the demodulation floor
+  uint32_t ignored;       // Other frequency, bandwidth, SF or sync word
+};
+
+class Module {
+  public:
+    Module(int cs, int irq, int rst, int gpio) : _cs(cs), _irq(irq), _rst(rst), _gpio(gpio) {}
+
+    int getIrq() const { return _irq; }
+
+  private:
+    int _cs;
+    int _irq;
+    int _rst;
+    int _gpio;
+};
+
+struct SimAirPacket;
+
+class SX1262 {
+  public:
+    // Not explicit: the firmware writes "SX1262 radio = new Module(...)"
+    SX1262(Module* module);
+    ~SX1262();
+
+    int16_t begin(float freq = 434.0f, float bw = 125.0f, uint8_t sf = 9, uint8_t cr = 7,
+                  uint8_t syncWord = RADIOLIB_SX126X_SYNC_WORD_PRIVATE, int8_t power = 10,
+                  uint16_t preambleLength = 8, float tcxoVoltage = 1.6f, bool useRegulatorLDO = false);
+
+    int16_t transmit(const uint8_t* data, size_t len, uint8_t addr = 0);
+    int16_t transmit(const char* str, uint8_t addr = 0);
+    int16_t transmit(String& str, uint8_t addr = 0) { return transmit(str.c_str(), addr); }
+    int16_t startReceive();
+    int16_t readData(uint8_t* data, size_t len);
+    int16_t readData(String& str, size_t len = 0);
+    size_t getPacketLength(bool update = true);
+    float getRSSI();
+    float getSNR();
+    uint32_t getTimeOnAir(size_t len);
+
+    int16_t standby();
+    int16_t sleep(bool retainConfig = true);
+
+    void setDio1Action(void (*func)(void));
+    void clearDio1Action();
+
+    int16_t setFrequency(float freq);
+    int16_t setBandwidth(float bw);
+    int16_t setSpreadingFactor(uint8_t sf);
+    int16_t setCodingRate(uint8_t cr);
+    int16_t setSyncWord(uint8_t syncWord);
+    int16_t setOutputPower(int8_t power);
+    int16_t setPreambleLength(uint16_t preambleLength);
+
+  private:
+    enum Mode : uint8_t { MODE_SLEEP, MODE_STANDBY, MODE_RX, MODE_TX };
+    enum Irq : uint8_t { IRQ_NONE = 0, IRQ_TX_DONE = 0x01, IRQ_RX_DONE = 0x02, IRQ_CRC_ERR = 0x40 };
+
+    Module* _module;
+    int _dio1;
+
+    std::mutex _mutex;              // Everything below; the air thread shares it
+    Mode _mode;
+    uint8_t _irq;
+    float _freq;
+    float _bw;
+    uint8_t _sf;
+    uint8_t _cr;
+    uint8_t _syncWord;
+    int8_t _power;
+    uint16_t _preamble;
+    uint8_t _fifo[256];
+    size_t _rxLength;
+    uint64_t _rxReadyUs;            // Shared clock time the receiver can lock onto a preamble
+    uint32_t _turnaroundUs;
+
+    double _lossGoodToBad;          // Gilbert-Elliott transition probabilities per packet
+    double _lossBadToGood;
+    bool _lossBad;
+    std::mt19937 _lossRng;
+    SimLoraStats _stats;
+    std::mutex _statsFileMutex;
+
+    int _socket;
+    std::thread _airThread;
+    std::atomic<bool> _airRunning;
+
+    bool openAir();
+    void airLoop();
+    void completeReception(const SimAirPacket& packet, bool corrupt);
+    void raiseDio1(uint8_t irq);
+    void clearIrq();
+    bool channelLoses();
+    void saveStats();
+};
+
+#endif
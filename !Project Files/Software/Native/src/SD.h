@@ -0,0 +1,40 @@
+/*
+  Filename: SD.h
+  SD Card over SPI (native)
+
+  Description: The card is <node>/sd. It reports as a 16 GB SDHC card; used
+               space is the real size of the directory tree in 32 KB
+               clusters (exFAT/FAT32 on a card that size).
+*/
+
+#ifndef SD_H
+#define SD_H
+
+#include "FS.h"
+#include "SPI.h"
+
+#define SIM_SD_CARD_BYTES    (16ULL * 1024 * 1024 * 1024)
+#define SIM_SD_CLUSTER_BYTES (32 * 1024)
+
+typedef enum {
+  CARD_NONE,
+  CARD_MMC,
+  CARD_SD,
+  CARD_SDHC,
+  CARD_UNKNOWN
+} sdcard_type_t;
+
+class SDFS : public fs::FS {
+  public:
+    bool begin(uint8_t ssPin = 5, SPIClass& spi = SPI, uint32_t frequency = 4000000,
+               const char* mountpoint = "/sd", uint8_t maxFiles = 5, bool formatIfEmpty = false);
+    void end() { unmountHost(); }
+    sdcard_type_t cardType() { return _root.empty() ? CARD_NONE : CARD_SDHC; }
+    uint64_t cardSize() { return _root.empty() ? 0 : SIM_SD_CARD_BYTES; }
+    uint64_t totalBytes() { return cardSize(); }
+    uint64_t usedBytes() { return hostUsedBytes(SIM_SD_CLUSTER_BYTES); }
+};
+
+extern SDFS SD;
+
+#endif
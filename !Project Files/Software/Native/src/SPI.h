@@ -0,0 +1,48 @@
+/*
+  Filename: SPI.h
+  Arduino SPI Master (native)
+
+  Description: Only what SD and RadioLib need to construct and begin; the
+               simulated SD card and SX1262 do not go through a SPI model.
+*/
+
+#ifndef SPI_H
+#define SPI_H
+
+#include <stdint.h>
+
+#define FSPI  0
+#define HSPI  1
+
+#define SPI_MODE0   0
+#define MSBFIRST    1
+
+class SPISettings {
+  public:
+    SPISettings(uint32_t clock = 1000000, uint8_t bitOrder = MSBFIRST, uint8_t dataMode = SPI_MODE0)
+        : clock(clock), bitOrder(bitOrder), dataMode(dataMode) {}
+    uint32_t clock;
+    uint8_t bitOrder;
+    uint8_t dataMode;
+};
+
+class SPIClass {
+  public:
+    explicit SPIClass(uint8_t spiBus = HSPI) : _spiBus(spiBus) {}
+
+    void begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1, int8_t ss = -1) {
+      (void)sck; (void)miso; (void)mosi; (void)ss;
+    }
+    void end() {}
+    void beginTransaction(SPISettings) {}
+    void endTransaction() {}
+    uint8_t transfer(uint8_t) { return 0xFF; }
+    uint8_t bus() const { return _spiBus; }
+
+  private:
+    uint8_t _spiBus;
+};
+
+extern SPIClass SPI;
+
+#endif
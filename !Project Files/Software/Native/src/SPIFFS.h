@@ -0,0 +1,18 @@
+/*
+  Filename: SPIFFS.h
+  SPIFFS on Flash (native)
+
+  Description: Shares <node>/littlefs with LittleFS: both name the same
+               flash partition on the board.
+*/
+
+#ifndef SPIFFS_H
+#define SPIFFS_H
+
+#include "LittleFS.h"
+
+class SPIFFSFS : public LittleFSFS {};
+
+extern SPIFFSFS SPIFFS;
+
+#endif
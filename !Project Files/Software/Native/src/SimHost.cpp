@@ -0,0 +1,231 @@
+/*
+  Filename: SimHost.cpp
+  Native Simulator Host Services Implementation
+
+  Description: Node paths, the boot clock (host or virtual), the sleep
+               wake signal and re-exec for deep sleep and restart.
+*/
+
+#include "SimHost.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <errno.h>
+#include <limits.h>
+#include <mutex>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace sim {
+
+static uint64_t monotonicUs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000;
+}
+
+static std::atomic<bool> s_virtualClock(false);
+static std::atomic<uint64_t> s_virtualUs(0);
+
+static std::mutex s_wakeMutex;
+static std::condition_variable s_wakeCv;
+static int s_wakeCause = 0;
+static uint32_t s_wakeSequence = 0;
+
+static char** s_argv = nullptr;
+
+#define SIM_REBOOT_HOOKS 4
+static void (*s_rebootHooks[SIM_REBOOT_HOOKS])() = {};
+
+const char* rootDir() {
+  const char* dir = getenv("WABASH_SIM_DIR");
+  return (dir != nullptr && dir[0] != '\0') ? dir : SIM_DEFAULT_DIR;
+}
+
+const char* nodeName() {
+  const char* node = getenv("WABASH_SIM_NODE");
+  return (node != nullptr && node[0] != '\0') ? node : SIM_NODE_NAME;
+}
+
+bool makeDirs(const std::string& path) {
+  std::string partial;
+  size_t pos = 0;
+  while (pos != std::string::npos) {
+    pos = path.find('/', pos + 1);
+    partial = path.substr(0, pos);
+    if (!partial.empty() && mkdir(partial.c_str(), 0755) != 0 && errno != EEXIST) {
+      log("mkdir %s failed: %s", partial.c_str(), strerror(errno));
+      return false;
+    }
+  }
+  return true;
+}
+
+std::string nodePath(const char* sub) {
+  std::string path = std::string(rootDir()) + "/" + nodeName();
+  if (sub != nullptr && sub[0] != '\0') {
+    path += "/";
+    path += sub;
+  }
+  makeDirs(path);
+  return path;
+}
+
+std::string sharedPath(const char* sub) {
+  std::string path = std::string(rootDir()) + "/" + sub;
+  makeDirs(path);
+  return path;
+}
+
+double speed() {
+  static const double factor = [] {
+    const char* env = getenv("WABASH_SIM_SPEED");
+    double value = (env != nullptr) ? atof(env) : 1.0;
+    return (value > 0.0) ? value : 1.0;
+  }();
+  return factor;
+}
+
+uint64_t hostUs(uint64_t simUs) {
+  return (uint64_t)((double)simUs / speed());
+}
+
+uint64_t bootUs() {
+  if (s_virtualClock.load(std::memory_order_relaxed)) {
+    return s_virtualUs.load(std::memory_order_relaxed);
+  }
+  // First call (from main(), or an earlier static constructor) is the boot
+  static const uint64_t start = monotonicUs();
+  return (uint64_t)((double)(monotonicUs() - start) * speed());
+}
+
+uint64_t sharedClockUs() {
+  if (s_virtualClock.load(std::memory_order_relaxed)) {
+    return s_virtualUs.load(std::memory_order_relaxed);
+  }
+  return (uint64_t)((double)monotonicUs() * speed());
+}
+
+void sleepUs(uint64_t us) {
+  if (s_virtualClock.load(std::memory_order_relaxed)) {
+    s_virtualUs.fetch_add(us, std::memory_order_relaxed);
+    return;
+  }
+  uint64_t host = hostUs(us);
+  struct timespec ts;
+  ts.tv_sec = (time_t)(host / 1000000ULL);
+  ts.tv_nsec = (long)(host % 1000000ULL) * 1000L;
+  while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+  }
+}
+
+void useVirtualClock() {
+  s_virtualClock.store(true);
+}
+
+bool virtualClock() {
+  return s_virtualClock.load(std::memory_order_relaxed);
+}
+
+void advanceUs(uint64_t us) {
+  if (virtualClock()) {
+    s_virtualUs.fetch_add(us, std::memory_order_relaxed);
+  }
+}
+
+uint32_t seed() {
+  static uint32_t value = 0;
+  if (value == 0) {
+    const char* env = getenv("WABASH_SIM_SEED");
+    value = (env != nullptr) ? (uint32_t)strtoul(env, nullptr, 0) : (uint32_t)(time(nullptr) ^ getpid());
+    if (value == 0) {
+      value = 1;
+    }
+  }
+  return value;
+}
+
+void wake(int cause) {
+  std::lock_guard<std::mutex> guard(s_wakeMutex);
+  s_wakeCause = cause;
+  s_wakeSequence++;
+  s_wakeCv.notify_all();
+}
+
+uint32_t wakeSequence() {
+  std::lock_guard<std::mutex> guard(s_wakeMutex);
+  return s_wakeSequence;
+}
+
+int waitForWake(uint32_t seen, uint64_t timeoutUs) {
+  std::unique_lock<std::mutex> lock(s_wakeMutex);
+  if (virtualClock() && timeoutUs > 0) {
+    // Nothing else runs on a virtual clock, so the timeout is the only way out
+    if (s_wakeSequence != seen) {
+      return s_wakeCause;
+    }
+    advanceUs(timeoutUs);
+    return 0;
+  }
+  auto woken = [seen] { return s_wakeSequence != seen; };
+  bool gotWake;
+  if (timeoutUs == 0) {
+    s_wakeCv.wait(lock, woken);
+    gotWake = true;
+  } else {
+    gotWake = s_wakeCv.wait_for(lock, std::chrono::microseconds(hostUs(timeoutUs)), woken);
+  }
+  return gotWake ? s_wakeCause : 0;
+}
+
+void log(const char* fmt, ...) {
+  static int quiet = -1;
+  if (quiet < 0) {
+    const char* env = getenv("WABASH_SIM_QUIET");
+    quiet = (env != nullptr && env[0] == '1') ? 1 : 0;
+  }
+  if (quiet) {
+    return;
+  }
+  char line[256];
+  va_list args;
+  va_start(args, fmt);
+  vsnprintf(line, sizeof(line), fmt, args);
+  va_end(args);
+  fprintf(stderr, "[SIM %s] %s\n", nodeName(), line);
+}
+
+void setArgs(int argc, char** argv) {
+  (void)argc;
+  s_argv = argv;
+}
+
+void atReboot(void (*fn)()) {
+  for (int i = 0; i < SIM_REBOOT_HOOKS; i++) {
+    if (s_rebootHooks[i] == nullptr || s_rebootHooks[i] == fn) {
+      s_rebootHooks[i] = fn;
+      return;
+    }
+  }
+  log("too many reboot hooks");
+}
+
+void reboot() {
+  for (int i = 0; i < SIM_REBOOT_HOOKS && s_rebootHooks[i] != nullptr; i++) {
+    s_rebootHooks[i]();
+  }
+  fflush(stdout);
+  fflush(stderr);
+  if (s_argv != nullptr) {
+    execv("/proc/self/exe", s_argv);
+    log("re-exec failed: %s", strerror(errno));
+  }
+  _exit(0);
+}
+
+}  // namespace sim
@@ -0,0 +1,103 @@
+/*
+  Filename: SimHost.h
+  Native Simulator Host Services
+
+  Description: Process-wide pieces every stand-in shares: where a node keeps
+               its files, the boot clock, the light/deep sleep wake signal
+               and the "[SIM]" diagnostics stream. Firmware output goes to
+               stdout through Serial; the simulator only ever writes to
+               stderr so capture tools see the same text as on hardware.
+
+  Environment:
+    WABASH_SIM_DIR    root for every node's files (default /tmp/wabash-sim)
+    WABASH_SIM_NODE   this node's name (default SIM_NODE_NAME from the build)
+    WABASH_SIM_SEED   seed for random() and the sensor noise (default: time)
+    WABASH_SIM_QUIET  set to 1 to silence "[SIM]" messages
+    WABASH_SIM_SPEED  run simulated time N times faster than the host clock
+                      (default 1). Every node on one air must use the same.
+
+  Layout under WABASH_SIM_DIR:
+    <node>/sd/          SD card contents
+    <node>/littlefs/    LittleFS / SPIFFS contents
+    <node>/nvs/         Preferences namespaces
+    <node>/eeprom.bin   EEPROM emulation
+    <node>/rtc.bin      RTC_DATA_ATTR memory across deep sleep / restart
+    lora/<node>.sock    SX1262 link endpoint
+*/
+
+#ifndef SIM_HOST_H
+#define SIM_HOST_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+#ifndef SIM_NODE_NAME
+  #define SIM_NODE_NAME "node"
+#endif
+
+#define SIM_DEFAULT_DIR "/tmp/wabash-sim"
+
+namespace sim {
+
+const char* rootDir();
+const char* nodeName();
+
+// <root>/<node>/<sub>, created on first use
+std::string nodePath(const char* sub);
+// <root>/<sub>, created on first use
+std::string sharedPath(const char* sub);
+bool makeDirs(const std::string& path);
+
+// Simulated time runs speed() times faster than the host clock
+double speed();
+// Host microseconds for a simulated span, for waits on host primitives
+uint64_t hostUs(uint64_t simUs);
+// Simulated microseconds since the process (re)booted
+uint64_t bootUs();
+// Simulated microseconds on a clock every node on this host shares
+uint64_t sharedClockUs();
+void sleepUs(uint64_t us);
+
+/**
+ * Switch to a virtual clock: bootUs() and sharedClockUs() return a counter
+ * that only sleepUs() and advanceUs() move, so a single-threaded model
+ * (examples/capacity_sim) runs days of millis()/delay() in host seconds.
+ * Call before anything reads the clock; there is no way back.
+ */
+void useVirtualClock();
+bool virtualClock();
+// Move the virtual clock forward; ignored on the host clock
+void advanceUs(uint64_t us);
+
+uint32_t seed();
+
+// Wake anything waiting in light or deep sleep (UART byte, GPIO edge)
+void wake(int cause);
+// Read before checking wake conditions, then pass to waitForWake()
+uint32_t wakeSequence();
+/**
+ * Block until a wake() after sequence seen, or the timeout
+ * @param timeoutUs simulated; 0 waits forever
+ * @return the latest wake cause, or 0 on timeout
+ */
+int waitForWake(uint32_t seen, uint64_t timeoutUs);
+
+// Drive an input pin from a simulated device; runs attached interrupts
+void driveGpio(uint8_t pin, int level);
+
+void log(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+
+// Arguments for re-exec on deep sleep wake / ESP.restart()
+void setArgs(int argc, char** argv);
+// Run fn just before the re-exec, e.g. to keep an external chip's state
+void atReboot(void (*fn)());
+[[noreturn]] void reboot();
+
+// Boot steps run by main() before setup(), in this order (EspSystem.cpp)
+void restoreRtc();
+void markHeapBaseline();
+
+}  // namespace sim
+
+#endif
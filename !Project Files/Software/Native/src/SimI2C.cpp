@@ -0,0 +1,204 @@
+/*
+  Filename: SimI2C.cpp
+  Simulated I2C Devices Implementation
+
+  Description: The device table, the WABASH_SIM_I2C_ABSENT filter, the
+               <node>/i2c.bin image that carries device state across a
+               deep sleep or restart re-exec, and the esp32-hal-i2c calls
+               TwoWire makes into the bus.
+*/
+
+#include "SimI2C.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+
+#include "Arduino.h"
+#include "SimHost.h"
+#include "esp32-hal-i2c.h"
+
+#define SIM_I2C_MAX_DEVICES 16
+
+static SimI2CDevice* s_devices[SIM_I2C_MAX_DEVICES];
+static size_t s_deviceCount = 0;
+
+static uint32_t s_clockHz[SIM_I2C_BUSES] = {SIM_I2C_DEFAULT_HZ, SIM_I2C_DEFAULT_HZ};
+static std::mutex s_busMutex[SIM_I2C_BUSES];
+
+static std::string imagePath() {
+  return sim::nodePath("") + "/i2c.bin";
+}
+
+static void saveDevices() {
+  FILE* file = fopen(imagePath().c_str(), "wb");
+  if (file == nullptr) {
+    return;
+  }
+  for (size_t i = 0; i < s_deviceCount; i++) {
+    std::string state;
+    {
+      std::lock_guard<std::mutex> guard(s_devices[i]->lock());
+      s_devices[i]->saveState(state);
+    }
+    if (state.empty()) {
+      continue;
+    }
+    uint8_t address = s_devices[i]->address();
+    uint32_t length = (uint32_t)state.size();
+    fwrite(&address, 1, 1, file);
+    fwrite(&length, sizeof(length), 1, file);
+    fwrite(state.data(), 1, state.size(), file);
+  }
+  fclose(file);
+}
+
+SimI2CDevice::SimI2CDevice(uint8_t address, const char* name) : _address(address), _name(name) {
+  // Devices are static objects; registration happens before main()
+  if (s_deviceCount < SIM_I2C_MAX_DEVICES) {
+    s_devices[s_deviceCount++] = this;
+  }
+  sim::atReboot(saveDevices);
+}
+
+bool SimI2CDevice::present() const {
+  const char* absent = getenv("WABASH_SIM_I2C_ABSENT");
+  if (absent == nullptr) {
+    return true;
+  }
+  const char* p = absent;
+  while (*p != '\0') {
+    char* end;
+    unsigned long address = strtoul(p, &end, 0);
+    if (end == p) {
+      p++;
+      continue;
+    }
+    if (address == _address) {
+      return false;
+    }
+    p = end;
+  }
+  return true;
+}
+
+namespace sim {
+
+SimI2CDevice* findI2CDevice(uint8_t address) {
+  for (size_t i = 0; i < s_deviceCount; i++) {
+    if (s_devices[i]->address() == address) {
+      return s_devices[i]->present() ? s_devices[i] : nullptr;
+    }
+  }
+  return nullptr;
+}
+
+void restoreI2CDevices(bool keep) {
+  std::string path = imagePath();
+  FILE* file = fopen(path.c_str(), "rb");
+  if (file == nullptr) {
+    return;
+  }
+  uint8_t address;
+  uint32_t length;
+  while (keep && fread(&address, 1, 1, file) == 1 && fread(&length, sizeof(length), 1, file) == 1) {
+    std::string state(length, '\0');
+    if (fread(&state[0], 1, length, file) != length) {
+      break;
+    }
+    for (size_t i = 0; i < s_deviceCount; i++) {
+      if (s_devices[i]->address() == address) {
+        std::lock_guard<std::mutex> guard(s_devices[i]->lock());
+        s_devices[i]->restoreState(state);
+      }
+    }
+  }
+  fclose(file);
+  unlink(path.c_str());
+}
+
+}  // namespace sim
+
+// ===== esp32-hal-i2c =====
+
+// START + address + data bytes, 9 clocks per byte including ACK
+static void busTime(uint8_t bus, size_t bytes) {
+  delayMicroseconds((uint32_t)((bytes + 1) * 9ULL * 1000000ULL / s_clockHz[bus]));
+}
+
+extern "C" {
+
+esp_err_t i2cSetClock(uint8_t i2c_num, uint32_t frequency) {
+  if (i2c_num >= SIM_I2C_BUSES || frequency == 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  s_clockHz[i2c_num] = frequency;
+  return ESP_OK;
+}
+
+esp_err_t i2cWrite(uint8_t i2c_num, uint16_t address, const uint8_t* buff, size_t size, uint32_t) {
+  if (i2c_num >= SIM_I2C_BUSES) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  std::lock_guard<std::mutex> bus(s_busMutex[i2c_num]);
+  SimI2CDevice* device = sim::findI2CDevice((uint8_t)address);
+  if (device == nullptr) {
+    busTime(i2c_num, 0);
+    return ESP_FAIL;
+  }
+  bool acked;
+  {
+    std::lock_guard<std::mutex> guard(device->lock());
+    acked = (size == 0) || device->write(buff, size);
+  }
+  busTime(i2c_num, size);
+  return acked ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t i2cRead(uint8_t i2c_num, uint16_t address, uint8_t* buff, size_t size, uint32_t, size_t* readCount) {
+  *readCount = 0;
+  if (i2c_num >= SIM_I2C_BUSES) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  std::lock_guard<std::mutex> bus(s_busMutex[i2c_num]);
+  SimI2CDevice* device = sim::findI2CDevice((uint8_t)address);
+  if (device == nullptr || size == 0) {
+    busTime(i2c_num, 0);
+    return ESP_FAIL;
+  }
+  {
+    std::lock_guard<std::mutex> guard(device->lock());
+    *readCount = device->read(buff, size);
+  }
+  busTime(i2c_num, *readCount);
+  return (*readCount > 0) ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t i2cWriteReadNonStop(uint8_t i2c_num, uint16_t address, const uint8_t* wbuff, size_t wsize, uint8_t* rbuff,
+                              size_t rsize, uint32_t, size_t* readCount) {
+  *readCount = 0;
+  if (i2c_num >= SIM_I2C_BUSES) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  std::lock_guard<std::mutex> bus(s_busMutex[i2c_num]);
+  SimI2CDevice* device = sim::findI2CDevice((uint8_t)address);
+  if (device == nullptr) {
+    busTime(i2c_num, 0);
+    return ESP_FAIL;
+  }
+  bool acked;
+  {
+    std::lock_guard<std::mutex> guard(device->lock());
+    acked = (wsize == 0) || device->write(wbuff, wsize);
+    if (acked && rsize > 0) {
+      *readCount = device->read(rbuff, rsize);
+    }
+  }
+  // Repeated START: a second address byte before the read
+  busTime(i2c_num, wsize + 1 + *readCount);
+  return (acked && (rsize == 0 || *readCount > 0)) ? ESP_OK : ESP_FAIL;
+}
+
+}  // extern "C"
@@ -0,0 +1,80 @@
+/*
+  Filename: SimI2C.h
+  Simulated I2C Devices
+
+  Description: A device answers the bytes of one I2C transaction at a time,
+               the way the chip's serial interface sees them: write() gets
+               everything after the address byte, read() fills the bytes the
+               master clocks in. Register pointers, auto-increment and
+               read-to-clear flags are up to the device, so drivers are
+               exercised at register level.
+
+               Every device answers on every bus; the bus number only picks
+               the clock and the bus lock. Devices are found by 7-bit
+               address. TwoWire reaches them through esp32-hal-i2c.h.
+
+  Environment:
+    WABASH_SIM_I2C_ABSENT  comma-separated addresses that do not ACK,
+                           e.g. "0x2A,0x44" to boot without NAU7802/SHT45
+*/
+
+#ifndef SIM_I2C_H
+#define SIM_I2C_H
+
+#include <mutex>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+#define SIM_I2C_BUSES       2        // I2C0 and I2C1
+#define SIM_I2C_DEFAULT_HZ  100000
+
+class SimI2CDevice {
+  public:
+    SimI2CDevice(uint8_t address, const char* name);
+    virtual ~SimI2CDevice() {}
+
+    uint8_t address() const { return _address; }
+    const char* name() const { return _name; }
+    bool present() const;
+
+    /**
+     * One write transaction
+     * @return false to NACK the data (Wire reports error 2, as the ESP32 core does)
+     */
+    virtual bool write(const uint8_t* data, size_t len) = 0;
+
+    /**
+     * One read transaction
+     * @return bytes supplied; 0 NACKs the address (Wire reports 0 bytes)
+     */
+    virtual size_t read(uint8_t* out, size_t len) = 0;
+
+    // State an external chip keeps while the MCU deep sleeps or restarts
+    virtual void saveState(std::string& out) { (void)out; }
+    virtual void restoreState(const std::string& in) { (void)in; }
+
+    // Held by the bus around write()/read() and by any background thread
+    std::mutex& lock() { return _mutex; }
+
+  protected:
+    std::mutex _mutex;
+
+  private:
+    uint8_t _address;
+    const char* _name;
+};
+
+namespace sim {
+
+SimI2CDevice* findI2CDevice(uint8_t address);
+
+/**
+ * Bring back device state saved at the last deep sleep / restart
+ * @param keep false on power-on: the saved state is discarded
+ */
+void restoreI2CDevices(bool keep);
+
+}  // namespace sim
+
+#endif
@@ -0,0 +1,590 @@
+/*
+  Filename: SimReplay.cpp
+  Sensor Replay Implementation
+
+  Description: Builds one timeline of held samples from the replay input,
+               serves it to the sensor models, and runs the monitor thread
+               that waits for the end of the data, compares the event files
+               the firmware saved with the golden set and exits with the
+               verdict. Samples are held (not interpolated) until the next
+               one. Recorded events advance one sample per firmware read
+               instead, so a capture sees the recording sample for sample.
+*/
+
+#include "SimReplay.h"
+
+#include <algorithm>
+#include <chrono>
+#include <ctype.h>
+#include <dirent.h>
+#include <math.h>
+#include <mutex>
+#include <random>
+#include <set>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "SimHost.h"
+#include "SimSensors.h"
+
+#define SIM_REPLAY_BASE_UV      180.0   // Unloaded bridge; the boot tare zeroes it
+#define SIM_REPLAY_TEMP_C       21.0
+#define SIM_REPLAY_HUMIDITY     48.0
+#define SIM_REPLAY_LINE_MAX     16384   // Longest event row: 3 + 4 x EVENT_SAMPLE_CAPACITY fields
+#define SIM_REPLAY_SYNTH_SAMPLES 41     // What the receiver captures in 2 s
+#define SIM_REPLAY_SYNTH_MIN_G  1.6     // Trigger peaks stay inside the LIS3DH's +-2 g
+#define SIM_REPLAY_SYNTH_MAX_G  1.95
+#define SIM_REPLAY_POLL_US      100000
+#define SIM_REPLAY_STALL_MS     1000    // No read for this long ends an event
+
+struct ReplayPoint {
+  uint64_t us;
+  float x;
+  float y;
+  float z;
+  double strainUv;
+};
+
+struct ReplayClimate {
+  uint64_t us;
+  float tempC;
+  float humidity;
+};
+
+struct ReplayEvent {
+  std::string name;
+  float tempC;
+  float humidity;
+  std::vector<float> x;
+  std::vector<float> y;
+  std::vector<float> z;
+  std::vector<float> strain;
+};
+
+// -------------------------------------------------------- Parsing
+
+static double envDouble(const char* name, double fallback) {
+  const char* value = getenv(name);
+  return (value != nullptr && value[0] != '\0') ? atof(value) : fallback;
+}
+
+// "event 2.csv" before "event 10.csv": digit runs compare as numbers
+static bool naturalLess(const std::string& a, const std::string& b) {
+  size_t i = 0;
+  size_t j = 0;
+  while (i < a.size() && j < b.size()) {
+    if (isdigit((unsigned char)a[i]) && isdigit((unsigned char)b[j])) {
+      unsigned long long na = strtoull(a.c_str() + i, nullptr, 10);
+      unsigned long long nb = strtoull(b.c_str() + j, nullptr, 10);
+      if (na != nb) {
+        return na < nb;
+      }
+      while (i < a.size() && isdigit((unsigned char)a[i])) i++;
+      while (j < b.size() && isdigit((unsigned char)b[j])) j++;
+    } else {
+      if (a[i] != b[j]) {
+        return a[i] < b[j];
+      }
+      i++;
+      j++;
+    }
+  }
+  return a.size() - i < b.size() - j;
+}
+
+// A file, or a folder's regular files in natural name order
+static std::vector<std::string> listFiles(const std::string& path) {
+  std::vector<std::string> files;
+  struct stat info;
+  if (stat(path.c_str(), &info) != 0) {
+    return files;
+  }
+  if (!S_ISDIR(info.st_mode)) {
+    files.push_back(path);
+    return files;
+  }
+  DIR* dir = opendir(path.c_str());
+  if (dir == nullptr) {
+    return files;
+  }
+  std::vector<std::string> names;
+  while (struct dirent* entry = readdir(dir)) {
+    std::string full = path + "/" + entry->d_name;
+    if (entry->d_name[0] != '.' && stat(full.c_str(), &info) == 0 && S_ISREG(info.st_mode)) {
+      names.push_back(entry->d_name);
+    }
+  }
+  closedir(dir);
+  std::sort(names.begin(), names.end(), naturalLess);
+  for (const std::string& name : names) {
+    files.push_back(path + "/" + name);
+  }
+  return files;
+}
+
+// Every comma-separated field of line as a number; false if any is not
+static bool parseNumbers(const char* line, std::vector<double>& values) {
+  values.clear();
+  const char* p = line;
+  for (;;) {
+    char* end;
+    double value = strtod(p, &end);
+    if (end == p) {
+      return false;
+    }
+    values.push_back(value);
+    while (*end == ' ' || *end == '\t') end++;
+    if (*end == '\0' || *end == '\r' || *end == '\n') {
+      return true;
+    }
+    if (*end != ',') {
+      return false;
+    }
+    p = end + 1;
+  }
+}
+
+// "<time>",temp,hum,x,y,z,strain,... as EventLogger_Module::saveEventCsv writes it
+static bool parseEventRow(const char* line, ReplayEvent& event) {
+  const char* close = (line[0] == '"') ? strchr(line + 1, '"') : nullptr;
+  if (close == nullptr || close[1] != ',') {
+    return false;
+  }
+  std::vector<double> values;
+  if (!parseNumbers(close + 2, values) || values.size() < 6 || (values.size() - 2) % 4 != 0) {
+    return false;
+  }
+  event.tempC = (float)values[0];
+  event.humidity = (float)values[1];
+  event.x.clear();
+  event.y.clear();
+  event.z.clear();
+  event.strain.clear();
+  for (size_t i = 2; i + 3 < values.size(); i += 4) {
+    event.x.push_back((float)values[i]);
+    event.y.push_back((float)values[i + 1]);
+    event.z.push_back((float)values[i + 2]);
+    event.strain.push_back((float)values[i + 3]);
+  }
+  return true;
+}
+
+static const char* baseName(const std::string& path) {
+  size_t slash = path.find_last_of('/');
+  return path.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+}
+
+static std::vector<ReplayEvent> loadEvents(const std::string& path) {
+  std::vector<ReplayEvent> events;
+  static char line[SIM_REPLAY_LINE_MAX];
+  for (const std::string& file : listFiles(path)) {
+    FILE* in = fopen(file.c_str(), "r");
+    if (in == nullptr) {
+      continue;
+    }
+    int row = 0;
+    while (fgets(line, sizeof(line), in) != nullptr) {
+      ReplayEvent event;
+      if (parseEventRow(line, event)) {
+        row++;
+        event.name = baseName(file);
+        if (row > 1) {
+          event.name += " #" + std::to_string(row);
+        }
+        events.push_back(std::move(event));
+      }
+    }
+    fclose(in);
+  }
+  return events;
+}
+
+// -------------------------------------------------------- Replay source
+
+class ReplaySensorSource : public SimSensorSource {
+  public:
+    ReplaySensorSource()
+        : _cursorUs((uint64_t)(envDouble("WABASH_SIM_REPLAY_LEAD_S", SIM_REPLAY_LEAD_S) * 1e6)),
+          _gapUs((uint64_t)(envDouble("WABASH_SIM_REPLAY_GAP_S", SIM_REPLAY_GAP_S) * 1e6)),
+          _gain(envDouble("WABASH_SIM_REPLAY_GAIN", SIM_REPLAY_LAB_GAIN)),
+          _endUs(0), _streamRows(0), _syntheticEvents(0), _playing(false), _shiftUs(0),
+          _nextTrigger(0), _progressUs(0), _baseReads(0), _lastReads(0) {
+      quiet(0);
+      _climate.push_back({0, (float)SIM_REPLAY_TEMP_C, (float)SIM_REPLAY_HUMIDITY});
+    }
+
+    /**
+     * Build the timeline from WABASH_SIM_REPLAY
+     * @return false if nothing replayable was found
+     */
+    bool load(const char* spec) {
+      unsigned count = 0;
+      double gapS = _gapUs / 1e6;
+      if (sscanf(spec, "synthetic:%u:%lf", &count, &gapS) >= 1) {
+        _gapUs = (uint64_t)(gapS * 1e6);
+        for (unsigned i = 0; i < count; i++) {
+          appendSynthetic();
+        }
+      } else {
+        for (const std::string& file : listFiles(spec)) {
+          loadFile(file);
+        }
+      }
+      if (_points.size() <= 1) {
+        return false;
+      }
+      _endUs = _cursorUs - _gapUs +
+               (uint64_t)(envDouble("WABASH_SIM_REPLAY_TAIL_S", SIM_REPLAY_TAIL_S) * 1e6);
+      return true;
+    }
+
+    // Later than load() said by however long the events took to play
+    uint64_t endUs() {
+      std::lock_guard<std::mutex> guard(_mutex);
+      return _endUs + _shiftUs;
+    }
+    size_t streamRows() const { return _streamRows; }
+    size_t syntheticEvents() const { return _syntheticEvents; }
+    const std::vector<ReplayEvent>& events() const { return _events; }
+
+    double strainMicroVolts(uint64_t us) override {
+      return sample(us, false).strainUv;
+    }
+
+    // Called by the LIS3DH at every output sample
+    void accelG(uint64_t us, float& x, float& y, float& z) override {
+      const ReplayPoint& point = sample(us, true);
+      x = point.x;
+      y = point.y;
+      z = point.z;
+    }
+
+    void climate(uint64_t us, float& tempC, float& humidity) override {
+      uint64_t t;
+      {
+        std::lock_guard<std::mutex> guard(_mutex);
+        t = _playing ? _triggers[_nextTrigger].us : us - _shiftUs;
+      }
+      auto next = std::upper_bound(_climate.begin(), _climate.end(), t,
+                                   [](uint64_t v, const ReplayClimate& c) { return v < c.us; });
+      const ReplayClimate& held = *(next - 1);
+      tempC = held.tempC;
+      humidity = held.humidity;
+    }
+
+  private:
+    struct ReplayTrigger {
+      uint64_t us;
+      size_t first;                 // Index of the trigger sample in _points
+      size_t count;
+      uint64_t endUs;               // Quiet point after the event
+    };
+
+    // Written once by load() before the firmware starts, read-only after
+    std::vector<ReplayPoint> _points;
+    std::vector<ReplayClimate> _climate;
+    std::vector<ReplayEvent> _events;
+    std::vector<ReplayTrigger> _triggers;
+    uint64_t _cursorUs;             // Where the next recording starts
+    uint64_t _gapUs;
+    double _gain;
+    uint64_t _endUs;
+    size_t _streamRows;
+    size_t _syntheticEvents;
+
+    // Playback state, shared by the LIS3DH thread and I2C reads
+    std::mutex _mutex;
+    bool _playing;                  // An event has been latched and plays by reads
+    uint64_t _shiftUs;              // Timeline delay from events played by reads
+    size_t _nextTrigger;
+    uint64_t _progressUs;           // Last progress: latching the trigger, or a new read
+    uint64_t _baseReads;            // Accel reads when the trigger was latched
+    uint64_t _lastReads;
+
+    /**
+     * What a sensor sees at us. Between events the timeline runs on the
+     * clock. An event plays the way it was recorded: one sample per
+     * firmware accelerometer read, starting once the trigger has been
+     * latched and read. A time base would drift, since captureEvent()
+     * reads its first sample at once and paces the rest on NAU7802
+     * conversions. Strain follows the accel sample, as the capture pairs
+     * them. An event nobody reads for SIM_REPLAY_STALL_MS is skipped.
+     * @param sampling true from the LIS3DH's output sample
+     */
+    const ReplayPoint& sample(uint64_t us, bool sampling) {
+      std::lock_guard<std::mutex> guard(_mutex);
+      if (!_playing) {
+        uint64_t t = us - _shiftUs;
+        if (_nextTrigger >= _triggers.size() || t < _triggers[_nextTrigger].us) {
+          return at(t);
+        }
+        if (!sampling) {
+          return _points[_triggers[_nextTrigger].first];
+        }
+        uint64_t strainReads = 0;
+        sim::sensorReadCounts(strainReads, _baseReads);
+        _lastReads = _baseReads;
+        _progressUs = us;
+        _playing = true;
+      }
+
+      const ReplayTrigger& trigger = _triggers[_nextTrigger];
+      uint64_t strainReads = 0;
+      uint64_t accelReads = 0;
+      sim::sensorReadCounts(strainReads, accelReads);
+      if (accelReads != _lastReads) {
+        _lastReads = accelReads;
+        _progressUs = std::max(_progressUs, us);
+      }
+      uint64_t played = accelReads - _baseReads;
+      // The NAU7802 asks with its conversion time, which can trail the LIS3DH's
+      bool stalled = us > _progressUs + SIM_REPLAY_STALL_MS * 1000ULL;
+      if (played <= trigger.count && !stalled) {
+        // Sample n latches after the firmware's nth read; strain goes with the accel read before it
+        size_t index = (size_t)(sampling ? played : (played > 0 ? played - 1 : 0));
+        return _points[trigger.first + std::min(index, trigger.count - 1)];
+      }
+      if (stalled && played == 0) {
+        sim::log("replay: trigger at %.1f s never read; lower event.threshold_g?",
+                 trigger.us / 1e6);
+      }
+      _shiftUs = us - trigger.endUs;
+      _nextTrigger++;
+      _playing = false;
+      return at(trigger.endUs);
+    }
+
+    const ReplayPoint& at(uint64_t us) const {
+      auto next = std::upper_bound(_points.begin(), _points.end(), us,
+                                   [](uint64_t t, const ReplayPoint& p) { return t < p.us; });
+      return *(next - 1);
+    }
+
+    void quiet(uint64_t us) {
+      _points.push_back({us, 0.0f, 0.0f, 1.0f, SIM_REPLAY_BASE_UV});
+    }
+
+    void loadFile(const std::string& path) {
+      FILE* in = fopen(path.c_str(), "r");
+      if (in == nullptr) {
+        sim::log("replay: cannot open %s", path.c_str());
+        return;
+      }
+      static char line[SIM_REPLAY_LINE_MAX];
+      std::vector<double> values;
+      bool inStream = false;
+      double firstS = 0.0;
+      uint64_t lastUs = 0;
+      while (fgets(line, sizeof(line), in) != nullptr) {
+        ReplayEvent event;
+        if (parseEventRow(line, event)) {
+          event.name = baseName(path);
+          appendEvent(event);
+          continue;
+        }
+        // Headers, comments and log markers fall out here
+        if (!parseNumbers(line, values) || (values.size() != 4 && values.size() != 5)) {
+          continue;
+        }
+        if (!inStream) {
+          inStream = true;
+          firstS = values[0];
+        }
+        lastUs = _cursorUs + (uint64_t)(std::max(0.0, values[0] - firstS) * 1e6);
+        if (values.size() == 5) {
+          _points.push_back({lastUs, (float)values[1], (float)values[2], (float)values[3],
+                             SIM_REPLAY_BASE_UV + values[4]});
+        } else {
+          // Lab log: the zeroed column is a code at the logged gain
+          double uv = values[2] * 3.3e6 / (8388608.0 * _gain);
+          _points.push_back({lastUs, 0.0f, 0.0f, 1.0f, SIM_REPLAY_BASE_UV + uv});
+        }
+        _streamRows++;
+      }
+      fclose(in);
+      if (inStream) {
+        quiet(lastUs + 1000);
+        _cursorUs = lastUs + 1000 + _gapUs;
+      }
+    }
+
+    // Laid out over a nominal capture window; sample() plays it by reads
+    void appendEvent(const ReplayEvent& event) {
+      uint64_t stepUs = (uint64_t)(SIM_REPLAY_EVENT_MS * 1000.0) / event.x.size();
+      _climate.push_back({_cursorUs, event.tempC, event.humidity});
+      _triggers.push_back({_cursorUs, _points.size(), event.x.size(),
+                           _cursorUs + event.x.size() * stepUs});
+      for (size_t i = 0; i < event.x.size(); i++) {
+        _points.push_back({_cursorUs + i * stepUs, event.x[i], event.y[i], event.z[i],
+                           SIM_REPLAY_BASE_UV + event.strain[i] * SIM_REPLAY_UV_PER_UE});
+      }
+      quiet(_cursorUs + event.x.size() * stepUs);
+      _cursorUs += event.x.size() * stepUs + _gapUs;
+      _events.push_back(event);
+    }
+
+    // A seeded jolt along X and a strain half-sine, sampled like a capture
+    void appendSynthetic() {
+      std::mt19937 random(sim::seed() + (uint32_t)_syntheticEvents * 7919u);
+      std::uniform_real_distribution<double> jolt(SIM_REPLAY_SYNTH_MIN_G, SIM_REPLAY_SYNTH_MAX_G);
+      std::uniform_real_distribution<double> load(300.0, 1200.0);
+      std::normal_distribution<double> noise(0.0, 0.004);
+      double peakG = jolt(random);
+      double peakUe = load(random) / SIM_REPLAY_UV_PER_UE;
+      ReplayEvent event;
+      event.name = "synthetic " + std::to_string(_syntheticEvents + 1);
+      event.tempC = (float)(SIM_REPLAY_TEMP_C + noise(random) * 100.0);
+      event.humidity = (float)(SIM_REPLAY_HUMIDITY + noise(random) * 500.0);
+      double stepS = SIM_REPLAY_EVENT_MS / 1e3 / SIM_REPLAY_SYNTH_SAMPLES;
+      for (int i = 0; i < SIM_REPLAY_SYNTH_SAMPLES; i++) {
+        double t = i * stepS;
+        double amplitude = peakG * exp(-t / 0.15);
+        event.x.push_back((float)(amplitude * cos(2.0 * M_PI * 3.0 * t) + noise(random)));
+        event.y.push_back((float)(0.4 * amplitude * sin(2.0 * M_PI * 2.0 * t) + noise(random)));
+        event.z.push_back((float)(1.0 + noise(random)));
+        event.strain.push_back((float)(peakUe * sin(M_PI * i / SIM_REPLAY_SYNTH_SAMPLES)));
+      }
+      appendEvent(event);
+      _syntheticEvents++;
+    }
+};
+
+// -------------------------------------------------------- Monitor
+
+struct EventDiff {
+  double accelRms;
+  double accelMax;
+  double strainRms;
+};
+
+/**
+ * Pair each produced sample with the golden one at the same point of the
+ * window, allowing one sample of timing jitter either way
+ */
+static EventDiff compareEvent(const ReplayEvent& golden, const ReplayEvent& produced) {
+  EventDiff diff = {0.0, 0.0, 0.0};
+  size_t n = produced.x.size();
+  size_t m = golden.x.size();
+  if (n == 0 || m == 0) {
+    diff.accelRms = diff.accelMax = diff.strainRms = INFINITY;
+    return diff;
+  }
+  double accelSum = 0.0;
+  double strainSum = 0.0;
+  for (size_t i = 0; i < n; i++) {
+    size_t center = (size_t)llround((double)i * m / n);
+    double bestAccel = INFINITY;
+    double bestStrain = INFINITY;
+    for (size_t j = (center > 0 ? center - 1 : 0); j <= center + 1 && j < m; j++) {
+      double dx = produced.x[i] - golden.x[j];
+      double dy = produced.y[i] - golden.y[j];
+      double dz = produced.z[i] - golden.z[j];
+      bestAccel = std::min(bestAccel, sqrt(dx * dx + dy * dy + dz * dz));
+      bestStrain = std::min(bestStrain, (double)fabsf(produced.strain[i] - golden.strain[j]));
+    }
+    accelSum += bestAccel * bestAccel;
+    strainSum += bestStrain * bestStrain;
+    diff.accelMax = std::max(diff.accelMax, bestAccel);
+  }
+  diff.accelRms = sqrt(accelSum / n);
+  diff.strainRms = sqrt(strainSum / n);
+  return diff;
+}
+
+static ReplaySensorSource* s_replay = nullptr;
+
+static void replayMonitor(std::string spec, std::set<std::string> before) {
+  auto hostStart = std::chrono::steady_clock::now();
+  uint64_t simStart = sim::bootUs();
+  uint64_t strainStart = 0;
+  uint64_t accelStart = 0;
+  sim::sensorReadCounts(strainStart, accelStart);
+
+  uint64_t now;
+  while ((now = sim::bootUs()) < s_replay->endUs()) {
+    sim::sleepUs(std::min<uint64_t>(s_replay->endUs() - now, SIM_REPLAY_POLL_US));
+  }
+
+  double hostS = std::chrono::duration<double>(std::chrono::steady_clock::now() - hostStart).count();
+  double simS = (sim::bootUs() - simStart) / 1e6;
+  uint64_t strainReads = 0;
+  uint64_t accelReads = 0;
+  sim::sensorReadCounts(strainReads, accelReads);
+  strainReads -= strainStart;
+  accelReads -= accelStart;
+
+  std::string eventDir = sim::nodePath("sd/events");
+  std::vector<ReplayEvent> produced;
+  for (const ReplayEvent& event : loadEvents(eventDir)) {
+    if (before.count(event.name) == 0) {
+      produced.push_back(event);
+    }
+  }
+
+  std::vector<ReplayEvent> golden = s_replay->events();
+  const char* goldenPath = getenv("WABASH_SIM_REPLAY_GOLDEN");
+  if (goldenPath != nullptr && goldenPath[0] != '\0') {
+    golden = loadEvents(goldenPath);
+  }
+
+  fflush(stdout);
+  fprintf(stderr, "[REPLAY] %s: %zu events (%zu synthetic), %zu stream rows\n", spec.c_str(),
+          s_replay->events().size(), s_replay->syntheticEvents(), s_replay->streamRows());
+  fprintf(stderr, "[REPLAY] %.1f s simulated in %.1f s host (speed %.2fx requested, %.2fx achieved)\n",
+          simS, hostS, sim::speed(), hostS > 0.0 ? simS / hostS : 0.0);
+  fprintf(stderr, "[REPLAY] samples read: %llu strain + %llu accel = %.0f/s simulated, %.0f/s host\n",
+          (unsigned long long)strainReads, (unsigned long long)accelReads,
+          simS > 0.0 ? (strainReads + accelReads) / simS : 0.0,
+          hostS > 0.0 ? (strainReads + accelReads) / hostS : 0.0);
+  fprintf(stderr, "[REPLAY] events produced: %zu (expected %zu)\n", produced.size(), golden.size());
+
+  bool pass = produced.size() == golden.size();
+  double tolG = envDouble("WABASH_SIM_REPLAY_TOL_G", SIM_REPLAY_TOL_G);
+  double tolUe = envDouble("WABASH_SIM_REPLAY_TOL_UE", SIM_REPLAY_TOL_UE);
+  for (size_t i = 0; i < golden.size() && i < produced.size(); i++) {
+    EventDiff diff = compareEvent(golden[i], produced[i]);
+    bool match = diff.accelRms <= tolG && diff.strainRms <= tolUe;
+    pass = pass && match;
+    fprintf(stderr,
+            "[REPLAY]   %s -> %s: %zu/%zu samples, accel rms %.4f g (max %.3f), strain rms %.4f ue%s\n",
+            golden[i].name.c_str(), produced[i].name.c_str(), produced[i].x.size(),
+            golden[i].x.size(), diff.accelRms, diff.accelMax, diff.strainRms, match ? "" : "  MISMATCH");
+  }
+  fprintf(stderr, "[REPLAY] %s\n", pass ? "PASS" : "FAIL");
+  fflush(stderr);
+  _exit(pass ? 0 : 1);
+}
+
+namespace sim {
+
+void startReplay() {
+  const char* spec = getenv("WABASH_SIM_REPLAY");
+  if (spec == nullptr || spec[0] == '\0') {
+    return;
+  }
+  s_replay = new ReplaySensorSource();
+  if (!s_replay->load(spec)) {
+    log("replay: nothing to replay in %s", spec);
+    delete s_replay;
+    s_replay = nullptr;
+    return;
+  }
+  setSensorSource(s_replay);
+  log("replay: %s, %zu events, ends at %.1f s", spec, s_replay->events().size(),
+      s_replay->endUs() / 1e6);
+
+  // Only files saved from here on count as produced
+  std::set<std::string> before;
+  for (const ReplayEvent& event : loadEvents(nodePath("sd/events"))) {
+    before.insert(event.name);
+  }
+  std::thread(replayMonitor, std::string(spec), std::move(before)).detach();
+}
+
+}  // namespace sim
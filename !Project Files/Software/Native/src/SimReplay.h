@@ -0,0 +1,70 @@
+/*
+  Filename: SimReplay.h
+  Sensor Replay
+
+  Description: Drives the simulated NAU7802, LIS3DH and SHT45 from recorded
+               or synthetic data instead of the default quiet trailer, so
+               the firmware's own trigger and captureEvent() run on real
+               loads. Three recordings are understood, one per line, and
+               a folder replays its files in name order:
+
+                 "<time>",T,RH,x,y,z,ue,x,y,z,ue...   offloaded event CSV row
+                 t_s, raw, zeroed, ue                  strain lab log
+                 t_s, ax_g, ay_g, az_g, strain_uV      stream, uV over the unloaded bridge
+
+               Event rows sit WABASH_SIM_REPLAY_GAP_S apart on a quiet
+               trailer. Each one plays a sample per firmware accelerometer
+               read from its trigger on, the way captureEvent() recorded
+               it. Lab logs replay the zeroed codes as bridge voltage at
+               gain WABASH_SIM_REPLAY_GAIN. "synthetic:N[:gap]" generates N
+               seeded load events instead.
+
+               When the data runs out the replay compares the event files
+               the firmware wrote against a golden set, prints a report on
+               stderr and exits: 0 on a match, 1 otherwise. Event-CSV and
+               synthetic input are their own golden. Set WABASH_SIM_SPEED
+               to replay faster than real time; the highest speed that
+               still matches is the useful ceiling. The receiver's default
+               2.0 g threshold cannot fire on the +-2 g LIS3DH, so set
+               event.threshold_g below the recorded peaks (synthetic peaks
+               are 1.6 to 1.95 g), and keep sleep.enable off: a deep sleep
+               restarts the replay.
+
+  Environment:
+    WABASH_SIM_REPLAY           file, folder or synthetic:N[:gap_s]
+    WABASH_SIM_REPLAY_GOLDEN    event CSV file or folder to compare against
+    WABASH_SIM_REPLAY_LEAD_S    quiet time before the first sample (default 30,
+                                past the boot tare)
+    WABASH_SIM_REPLAY_GAP_S     quiet time between events (default 10)
+    WABASH_SIM_REPLAY_TAIL_S    time left to save the last event (default 10)
+    WABASH_SIM_REPLAY_GAIN      NAU7802 gain of a lab log (default 32)
+    WABASH_SIM_REPLAY_TOL_G     accel RMS difference allowed (default 0.05)
+    WABASH_SIM_REPLAY_TOL_UE    strain RMS difference allowed (default 0.02)
+*/
+
+#ifndef SIM_REPLAY_H
+#define SIM_REPLAY_H
+
+#define SIM_REPLAY_LEAD_S      30.0
+#define SIM_REPLAY_GAP_S       10.0
+#define SIM_REPLAY_TAIL_S      10.0
+#define SIM_REPLAY_EVENT_MS    2000.0   // Nominal capture window (EVENT_CAPTURE_DURATION_MS)
+#define SIM_REPLAY_LAB_GAIN    32
+#define SIM_REPLAY_TOL_G       0.05
+#define SIM_REPLAY_TOL_UE      0.02
+
+// Receiver's STRAIN_CALIBRATION_DIVISOR x quarter bridge (Vex 3.3 V, GF 2.0) / 4:
+// bridge microvolts per calibrated microstrain unit in an event CSV
+#define SIM_REPLAY_UV_PER_UE   (11679.7 * 3.3 * 2.0 / 4.0)
+
+namespace sim {
+
+/**
+ * Install the source named by WABASH_SIM_REPLAY, if set, and start the
+ * thread that reports and exits when it ends. main() calls this before setup().
+ */
+void startReplay();
+
+}  // namespace sim
+
+#endif
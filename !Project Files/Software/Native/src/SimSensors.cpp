@@ -0,0 +1,746 @@
+/*
+  Filename: SimSensors.cpp
+  Simulated Receiver Sensors Implementation
+
+  Description: NAU7802, LIS3DH and SHT45 register models and the default
+               sensor source. Timing follows the datasheets closely enough
+               for the drivers' polling and timeouts to behave as on the
+               board: NAU7802 conversions complete at the selected SPS and
+               calibration takes a few conversion periods, the SHT45 NACKs
+               reads until its 8.3 ms measurement is done, and the LIS3DH
+               produces samples at its ODR whether or not anyone reads them.
+*/
+
+#include "SimSensors.h"
+
+#include <algorithm>
+#include <atomic>
+#include <math.h>
+#include <mutex>
+#include <pthread.h>
+#include <random>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#include "SimHost.h"
+#include "SimI2C.h"
+
+#define SIM_STRAIN_BASE_UV      180.0   // Unloaded bridge imbalance
+#define SIM_STRAIN_DRIFT_UV     6.0     // Thermal drift amplitude
+#define SIM_STRAIN_NOISE_UV     0.25
+#define SIM_ACCEL_NOISE_G       0.004
+#define SIM_EVENT_STRAIN_UV     900.0   // Peak of the load pulse
+#define SIM_EVENT_STRAIN_S      2.0
+#define SIM_EVENT_SHAKE_G       3.0     // Peak shake; the LIS3DH range clips it
+#define SIM_EVENT_SHAKE_S       0.6
+
+#define SIM_NAU7802_CHIP_OFFSET 420     // Input offset an internal calibration removes, counts
+#define SIM_NAU7802_PUR_US      600     // Digital + analog power-up
+#define SIM_SHT45_MEASURE_US    8300    // High precision, max
+#define SIM_SHT45_RESET_US      1000
+
+// -------------------------------------------------------- Default source
+
+static std::atomic<uint64_t> s_eventUs(UINT64_MAX);
+static std::atomic<uint64_t> s_strainReads(0);
+static std::atomic<uint64_t> s_accelReads(0);
+
+class DefaultSensorSource : public SimSensorSource {
+  public:
+    DefaultSensorSource() : _random(sim::seed() ^ 0x5EED5EEDu), _periodUs(0) {
+      const char* period = getenv("WABASH_SIM_EVENT_PERIOD_S");
+      if (period != nullptr) {
+        _periodUs = (uint64_t)(atof(period) * 1e6);
+      }
+    }
+
+    double strainMicroVolts(uint64_t us) override {
+      std::lock_guard<std::mutex> guard(_mutex);
+      double t = us / 1e6;
+      double value = SIM_STRAIN_BASE_UV + SIM_STRAIN_DRIFT_UV * sin(2.0 * M_PI * t / 600.0) +
+                     noise(SIM_STRAIN_NOISE_UV);
+      double age = eventAge(us);
+      if (age >= 0.0 && age < SIM_EVENT_STRAIN_S) {
+        value += SIM_EVENT_STRAIN_UV * sin(M_PI * age / SIM_EVENT_STRAIN_S);
+      }
+      return value;
+    }
+
+    void accelG(uint64_t us, float& x, float& y, float& z) override {
+      std::lock_guard<std::mutex> guard(_mutex);
+      x = (float)noise(SIM_ACCEL_NOISE_G);
+      y = (float)noise(SIM_ACCEL_NOISE_G);
+      z = 1.0f + (float)noise(SIM_ACCEL_NOISE_G);
+      double age = eventAge(us);
+      if (age >= 0.0 && age < SIM_EVENT_SHAKE_S) {
+        // A decaying jolt, strongest along the trailer's X axis
+        double amplitude = SIM_EVENT_SHAKE_G * exp(-age / 0.15);
+        x += (float)(amplitude * sin(2.0 * M_PI * 12.0 * age));
+        y += (float)(0.5 * amplitude * sin(2.0 * M_PI * 9.0 * age + 1.0));
+        z += (float)(0.3 * amplitude * sin(2.0 * M_PI * 15.0 * age + 2.0));
+      }
+    }
+
+    void climate(uint64_t us, float& tempC, float& humidity) override {
+      std::lock_guard<std::mutex> guard(_mutex);
+      double phase = 2.0 * M_PI * (us / 1e6) / 900.0;
+      tempC = (float)(21.0 + 1.5 * sin(phase) + noise(0.01));
+      humidity = (float)(48.0 - 4.0 * sin(phase) + noise(0.05));
+    }
+
+  private:
+    std::mutex _mutex;
+    std::mt19937 _random;
+    std::normal_distribution<double> _normal;
+    uint64_t _periodUs;
+
+    double noise(double sigma) { return sigma * _normal(_random); }
+
+    // Seconds since the latest load event, negative when none has started
+    double eventAge(uint64_t us) {
+      uint64_t start = s_eventUs.load(std::memory_order_relaxed);
+      if (_periodUs > 0 && us >= _periodUs) {
+        uint64_t periodic = us / _periodUs * _periodUs;
+        if (start == UINT64_MAX || start > us || periodic > start) {
+          start = periodic;
+        }
+      }
+      if (start == UINT64_MAX || start > us) {
+        return -1.0;
+      }
+      return (us - start) / 1e6;
+    }
+};
+
+static DefaultSensorSource s_defaultSource;
+static std::atomic<SimSensorSource*> s_source(&s_defaultSource);
+
+namespace sim {
+
+void setSensorSource(SimSensorSource* source) {
+  s_source.store(source != nullptr ? source : &s_defaultSource);
+}
+
+SimSensorSource* sensorSource() {
+  return s_source.load();
+}
+
+void triggerLoadEvent() {
+  s_eventUs.store(bootUs(), std::memory_order_relaxed);
+}
+
+void sensorReadCounts(uint64_t& strain, uint64_t& accel) {
+  strain = s_strainReads.load(std::memory_order_relaxed);
+  accel = s_accelReads.load(std::memory_order_relaxed);
+}
+
+}  // namespace sim
+
+// -------------------------------------------------------- NAU7802
+
+#define NAU_PU_CTRL     0x00
+#define NAU_CTRL1       0x01
+#define NAU_CTRL2       0x02
+#define NAU_OCAL1_B2    0x03
+#define NAU_GCAL1_B3    0x06
+#define NAU_ADCO_B2     0x12
+#define NAU_ADCO_B0     0x14
+#define NAU_REVISION    0x1F
+
+#define NAU_PU_RR       0x01
+#define NAU_PU_PUD      0x02
+#define NAU_PU_PUA      0x04
+#define NAU_PU_PUR      0x08
+#define NAU_PU_CS       0x10
+#define NAU_PU_CR       0x20
+#define NAU_PU_AVDDS    0x80
+#define NAU_CTRL2_CALS  0x04
+#define NAU_CTRL2_CALERR 0x08
+
+class SimNAU7802 : public SimI2CDevice {
+  public:
+    SimNAU7802() : SimI2CDevice(SIM_NAU7802_ADDRESS, "NAU7802") { reset(); }
+
+    bool write(const uint8_t* data, size_t len) override {
+      _pointer = data[0] & 0x1F;
+      for (size_t i = 1; i < len; i++) {
+        writeRegister(_pointer, data[i]);
+        _pointer = (_pointer + 1) & 0x1F;
+      }
+      return true;
+    }
+
+    size_t read(uint8_t* out, size_t len) override {
+      for (size_t i = 0; i < len; i++) {
+        out[i] = readRegister(_pointer);
+        _pointer = (_pointer + 1) & 0x1F;
+      }
+      return len;
+    }
+
+  private:
+    uint8_t _regs[0x20];
+    uint8_t _pointer;
+    uint64_t _poweredUs;
+    uint64_t _csUs;
+    uint64_t _calEndUs;
+    uint64_t _consumed;     // Conversions whose result has been read out
+    uint64_t _latched;      // Conversion held in ADCO while it is read byte by byte
+    int32_t _latchedCode;
+
+    void reset() {
+      memset(_regs, 0, sizeof(_regs));
+      _regs[NAU_GCAL1_B3 + 1] = 0x80;   // GCAL1 = 1.0 (0x00800000)
+      _regs[NAU_REVISION] = 0x0F;
+      _pointer = 0;
+      _poweredUs = 0;
+      _csUs = 0;
+      _calEndUs = 0;
+      _consumed = 0;
+      _latched = 0;
+      _latchedCode = 0;
+    }
+
+    bool powered() const { return (_regs[NAU_PU_CTRL] & (NAU_PU_PUD | NAU_PU_PUA)) == (NAU_PU_PUD | NAU_PU_PUA); }
+
+    uint32_t samplesPerSecond() const {
+      static const uint16_t RATES[8] = {10, 20, 40, 80, 10, 10, 10, 320};
+      return RATES[(_regs[NAU_CTRL2] >> 4) & 0x07];
+    }
+
+    uint64_t conversionUs() const { return 1000000ULL / samplesPerSecond(); }
+
+    // Conversions completed since CS went high
+    uint64_t completed(uint64_t now) const {
+      if (!powered() || !(_regs[NAU_PU_CTRL] & NAU_PU_CS) || now < _csUs) {
+        return 0;
+      }
+      return (now - _csUs) / conversionUs();
+    }
+
+    double referenceVolts() const {
+      if (_regs[NAU_PU_CTRL] & NAU_PU_AVDDS) {
+        return 4.5 - 0.3 * ((_regs[NAU_CTRL1] >> 3) & 0x07);   // Internal LDO (VLDO)
+      }
+      return 3.3;   // AVDD from the board
+    }
+
+    int32_t convert(uint64_t atUs) {
+      double volts = sim::sensorSource()->strainMicroVolts(atUs) * 1e-6;
+      double gain = (double)(1 << (_regs[NAU_CTRL1] & 0x07));
+      double code = volts * gain / referenceVolts() * 8388608.0 + SIM_NAU7802_CHIP_OFFSET;
+      int32_t offset = ((int32_t)_regs[NAU_OCAL1_B2] << 16) | ((int32_t)_regs[NAU_OCAL1_B2 + 1] << 8) |
+                       _regs[NAU_OCAL1_B2 + 2];
+      if (offset & 0x800000) {
+        offset |= (int32_t)0xFF000000;
+      }
+      code -= offset;
+      if (code > 8388607.0) code = 8388607.0;
+      if (code < -8388608.0) code = -8388608.0;
+      return (int32_t)lround(code);
+    }
+
+    void finishCalibration(uint64_t now) {
+      if ((_regs[NAU_CTRL2] & NAU_CTRL2_CALS) && now >= _calEndUs) {
+        _regs[NAU_CTRL2] &= (uint8_t)~(NAU_CTRL2_CALS | NAU_CTRL2_CALERR);
+        _regs[NAU_OCAL1_B2] = (uint8_t)(SIM_NAU7802_CHIP_OFFSET >> 16);
+        _regs[NAU_OCAL1_B2 + 1] = (uint8_t)(SIM_NAU7802_CHIP_OFFSET >> 8);
+        _regs[NAU_OCAL1_B2 + 2] = (uint8_t)SIM_NAU7802_CHIP_OFFSET;
+      }
+    }
+
+    void writeRegister(uint8_t reg, uint8_t value) {
+      uint64_t now = sim::bootUs();
+      if (reg == NAU_PU_CTRL) {
+        if (value & NAU_PU_RR) {
+          reset();
+          _regs[NAU_PU_CTRL] = NAU_PU_RR;
+          return;
+        }
+        uint8_t before = _regs[NAU_PU_CTRL];
+        // PUR and CR are status bits
+        _regs[NAU_PU_CTRL] = (uint8_t)((value & ~(NAU_PU_PUR | NAU_PU_CR)) | (before & NAU_PU_CR));
+        if (powered() && (before & (NAU_PU_PUD | NAU_PU_PUA)) != (NAU_PU_PUD | NAU_PU_PUA)) {
+          _poweredUs = now;
+        }
+        if ((value & NAU_PU_CS) && !(before & NAU_PU_CS)) {
+          _csUs = now;
+          _consumed = 0;
+          _latched = 0;
+        }
+        return;
+      }
+      if (reg == NAU_CTRL2) {
+        bool startCal = (value & NAU_CTRL2_CALS) && !(_regs[NAU_CTRL2] & NAU_CTRL2_CALS);
+        _regs[NAU_CTRL2] = (uint8_t)(value & ~NAU_CTRL2_CALERR);
+        if (startCal) {
+          _calEndUs = now + 3 * conversionUs() + 50000;
+        }
+        return;
+      }
+      if (reg >= NAU_ADCO_B2 && reg <= NAU_ADCO_B0) {
+        return;   // Read-only
+      }
+      _regs[reg] = value;
+    }
+
+    uint8_t readRegister(uint8_t reg) {
+      uint64_t now = sim::bootUs();
+      finishCalibration(now);
+      if (reg == NAU_PU_CTRL) {
+        uint8_t value = (uint8_t)(_regs[NAU_PU_CTRL] & ~(NAU_PU_PUR | NAU_PU_CR));
+        if (powered() && now - _poweredUs >= SIM_NAU7802_PUR_US) {
+          value |= NAU_PU_PUR;
+        }
+        if (completed(now) > _consumed) {
+          value |= NAU_PU_CR;
+        }
+        return value;
+      }
+      if (reg == NAU_ADCO_B2) {
+        // Latch so a byte-at-a-time read never mixes two conversions
+        uint64_t done = completed(now);
+        if (done > 0 && done != _latched) {
+          _latched = done;
+          _latchedCode = convert(_csUs + done * conversionUs());
+        }
+      }
+      if (reg >= NAU_ADCO_B2 && reg <= NAU_ADCO_B0) {
+        uint32_t code = (uint32_t)_latchedCode & 0xFFFFFF;
+        if (reg == NAU_ADCO_B0 && _consumed != _latched) {
+          _consumed = _latched;   // Reading the last byte clears CR
+          s_strainReads.fetch_add(1, std::memory_order_relaxed);
+        }
+        return (uint8_t)(code >> (8 * (NAU_ADCO_B0 - reg)));
+      }
+      return _regs[reg];
+    }
+};
+
+// -------------------------------------------------------- LIS3DH
+
+#define LIS_WHO_AM_I    0x0F
+#define LIS_CTRL_REG1   0x20
+#define LIS_CTRL_REG2   0x21
+#define LIS_CTRL_REG3   0x22
+#define LIS_CTRL_REG4   0x23
+#define LIS_CTRL_REG5   0x24
+#define LIS_REFERENCE   0x26
+#define LIS_STATUS_REG  0x27
+#define LIS_OUT_X_L     0x28
+#define LIS_OUT_Z_H     0x2D
+#define LIS_FIFO_CTRL   0x2E
+#define LIS_FIFO_SRC    0x2F
+#define LIS_INT1_CFG    0x30
+#define LIS_INT1_SRC    0x31
+#define LIS_INT1_THS    0x32
+#define LIS_INT1_DUR    0x33
+
+#define LIS_FIFO_DEPTH  32
+#define LIS_TICK_MAX_US 5000    // Sampling thread wake-up, at most
+
+struct SimLis3dhState {
+  uint8_t regs[0x40];
+  int16_t fifo[LIS_FIFO_DEPTH][3];
+  uint8_t fifoHead;
+  uint8_t fifoCount;
+  int16_t lastRaw[3];
+  float reference[3];
+  uint8_t overThreshold;
+  uint8_t int1Src;
+};
+
+class SimLIS3DH : public SimI2CDevice {
+  public:
+    SimLIS3DH() : SimI2CDevice(SIM_LIS3DH_ADDRESS, "LIS3DH"), _pointer(0), _increment(false),
+                  _lastSampleUs(0), _int1Level(0) {
+      memset(&_s, 0, sizeof(_s));
+      _s.regs[LIS_WHO_AM_I] = 0x33;
+      _s.regs[LIS_CTRL_REG1] = 0x07;   // Power-down, all axes enabled
+    }
+
+    bool write(const uint8_t* data, size_t len) override {
+      startThread();
+      _pointer = data[0] & 0x7F;
+      _increment = (data[0] & 0x80) != 0;
+      advance(sim::bootUs());
+      for (size_t i = 1; i < len; i++) {
+        writeRegister(_pointer, data[i]);
+        step();
+      }
+      return true;
+    }
+
+    size_t read(uint8_t* out, size_t len) override {
+      startThread();
+      advance(sim::bootUs());
+      for (size_t i = 0; i < len; i++) {
+        out[i] = readRegister(_pointer);
+        step();
+      }
+      return len;
+    }
+
+    void saveState(std::string& out) override {
+      out.assign(reinterpret_cast<const char*>(&_s), sizeof(_s));
+    }
+
+    void restoreState(const std::string& in) override {
+      if (in.size() == sizeof(_s)) {
+        memcpy(&_s, in.data(), sizeof(_s));
+        _lastSampleUs = sim::bootUs();
+        startThread();
+      }
+    }
+
+    // Sampling thread body: catch up, then report an INT1 edge
+    uint64_t tick() {
+      uint64_t periodUs;
+      int level;
+      {
+        std::lock_guard<std::mutex> guard(_mutex);
+        advance(sim::bootUs());
+        periodUs = samplePeriodUs();
+        level = int1Level();
+      }
+      if (level != _int1Level) {
+        _int1Level = level;
+        sim::driveGpio(SIM_LIS3DH_INT1_PIN, level);
+      }
+      return (periodUs > 0 && periodUs < LIS_TICK_MAX_US) ? periodUs : LIS_TICK_MAX_US;
+    }
+
+  private:
+    SimLis3dhState _s;
+    uint8_t _pointer;
+    bool _increment;
+    uint64_t _lastSampleUs;
+    int _int1Level;           // Only touched by the sampling thread
+    std::once_flag _threadOnce;
+
+    static void* threadMain(void* arg) {
+      SimLIS3DH* self = static_cast<SimLIS3DH*>(arg);
+      pthread_setname_np(pthread_self(), "sim_lis3dh");
+      for (;;) {
+        sim::sleepUs(self->tick());
+      }
+      return nullptr;
+    }
+
+    void startThread() {
+      std::call_once(_threadOnce, [this] {
+        pthread_t thread;
+        if (pthread_create(&thread, nullptr, threadMain, this) == 0) {
+          pthread_detach(thread);
+        }
+      });
+    }
+
+    void step() {
+      if (_increment) {
+        _pointer = (_pointer + 1) & 0x7F;
+      }
+    }
+
+    uint64_t samplePeriodUs() const {
+      static const uint16_t ODR_HZ[16] = {0, 1, 10, 25, 50, 100, 200, 400, 1600, 1344, 0, 0, 0, 0, 0, 0};
+      uint16_t hz = ODR_HZ[_s.regs[LIS_CTRL_REG1] >> 4];
+      return (hz > 0) ? 1000000ULL / hz : 0;
+    }
+
+    bool lowPower() const { return (_s.regs[LIS_CTRL_REG1] & 0x08) != 0; }
+    bool highResolution() const { return !lowPower() && (_s.regs[LIS_CTRL_REG4] & 0x08) != 0; }
+    uint8_t fullScale() const { return (_s.regs[LIS_CTRL_REG4] >> 4) & 0x03; }
+
+    float sensitivityG() const {
+      static const float HR[4] = {0.001f, 0.002f, 0.004f, 0.012f};
+      static const float NORMAL[4] = {0.004f, 0.008f, 0.016f, 0.048f};
+      static const float LP[4] = {0.016f, 0.032f, 0.064f, 0.192f};
+      return lowPower() ? LP[fullScale()] : (highResolution() ? HR[fullScale()] : NORMAL[fullScale()]);
+    }
+
+    uint8_t shift() const { return lowPower() ? 8 : (highResolution() ? 4 : 6); }
+
+    bool fifoActive() const {
+      return (_s.regs[LIS_CTRL_REG5] & 0x40) && (_s.regs[LIS_FIFO_CTRL] >> 6) != 0;
+    }
+
+    // Left-justified output word for one axis, clipped to the range
+    int16_t quantize(float g) const {
+      int32_t limit = 1 << (15 - shift());
+      int32_t counts = (int32_t)lroundf(g / sensitivityG());
+      if (counts >= limit) counts = limit - 1;
+      if (counts < -limit) counts = -limit;
+      return (int16_t)(counts * (1 << shift()));
+    }
+
+    void advance(uint64_t now) {
+      uint64_t periodUs = samplePeriodUs();
+      if (periodUs == 0) {
+        _lastSampleUs = now;
+        return;
+      }
+      // A stalled host thread loses samples rather than replaying a backlog
+      if (now - _lastSampleUs > 64 * periodUs) {
+        _lastSampleUs = now - 64 * periodUs;
+      }
+      while (now - _lastSampleUs >= periodUs) {
+        _lastSampleUs += periodUs;
+        takeSample(_lastSampleUs);
+      }
+    }
+
+    void takeSample(uint64_t atUs) {
+      float g[3];
+      sim::sensorSource()->accelG(atUs, g[0], g[1], g[2]);
+      int16_t raw[3];
+      for (int axis = 0; axis < 3; axis++) {
+        raw[axis] = quantize(g[axis]);
+        if (!(_s.regs[LIS_CTRL_REG1] & (1 << axis))) {
+          raw[axis] = 0;
+        }
+      }
+
+      if (fifoActive()) {
+        uint8_t mode = _s.regs[LIS_FIFO_CTRL] >> 6;
+        // FIFO mode stops when full; stream modes drop the oldest sample
+        if (_s.fifoCount == LIS_FIFO_DEPTH && mode != 1) {
+          _s.fifoHead = (_s.fifoHead + 1) % LIS_FIFO_DEPTH;
+          _s.fifoCount--;
+        }
+        if (_s.fifoCount < LIS_FIFO_DEPTH) {
+          uint8_t slot = (_s.fifoHead + _s.fifoCount) % LIS_FIFO_DEPTH;
+          memcpy(_s.fifo[slot], raw, sizeof(raw));
+          _s.fifoCount++;
+        }
+      } else {
+        setOutput(raw);
+      }
+      memcpy(_s.lastRaw, raw, sizeof(raw));
+      _s.regs[LIS_STATUS_REG] |= 0x08;   // ZYXDA
+      evaluateInterrupt(raw);
+    }
+
+    void setOutput(const int16_t* raw) {
+      for (int axis = 0; axis < 3; axis++) {
+        _s.regs[LIS_OUT_X_L + 2 * axis] = (uint8_t)(raw[axis] & 0xFF);
+        _s.regs[LIS_OUT_X_L + 2 * axis + 1] = (uint8_t)((uint16_t)raw[axis] >> 8);
+      }
+    }
+
+    void evaluateInterrupt(const int16_t* raw) {
+      uint8_t cfg = _s.regs[LIS_INT1_CFG];
+      if ((cfg & 0x3F) == 0) {
+        return;
+      }
+      static const float THS_LSB[4] = {0.016f, 0.032f, 0.062f, 0.186f};
+      float threshold = (_s.regs[LIS_INT1_THS] & 0x7F) * THS_LSB[fullScale()];
+      static const float HP_ALPHA[4] = {0.02f, 0.01f, 0.005f, 0.0025f};
+      float alpha = HP_ALPHA[(_s.regs[LIS_CTRL_REG2] >> 4) & 0x03];
+      bool highPass = (_s.regs[LIS_CTRL_REG2] & 0x01) != 0;
+
+      uint8_t events = 0;
+      bool any = false;
+      bool all = true;
+      for (int axis = 0; axis < 3; axis++) {
+        float g = (raw[axis] >> shift()) * sensitivityG();
+        float value = g;
+        if (highPass) {
+          value = g - _s.reference[axis];
+          _s.reference[axis] += (g - _s.reference[axis]) * alpha;
+        }
+        bool high = fabsf(value) > threshold;
+        uint8_t highBit = (uint8_t)(0x02 << (2 * axis));
+        uint8_t lowBit = (uint8_t)(0x01 << (2 * axis));
+        if (cfg & highBit) {
+          events |= high ? highBit : 0;
+          any |= high;
+          all &= high;
+        }
+        if (cfg & lowBit) {
+          events |= high ? 0 : lowBit;
+          any |= !high;
+          all &= !high;
+        }
+      }
+      bool active = (cfg & 0x80) ? all : any;
+      _s.overThreshold = active ? (uint8_t)std::min(_s.overThreshold + 1, 255) : 0;
+      bool fired = active && _s.overThreshold > (_s.regs[LIS_INT1_DUR] & 0x7F);
+      bool latched = (_s.regs[LIS_CTRL_REG5] & 0x08) != 0;
+      if (fired) {
+        _s.int1Src = (uint8_t)(0x40 | events);
+      } else if (!latched) {
+        _s.int1Src = 0;
+      }
+    }
+
+    int int1Level() const {
+      return ((_s.regs[LIS_CTRL_REG3] & 0x40) && (_s.int1Src & 0x40)) ? 1 : 0;
+    }
+
+    void writeRegister(uint8_t reg, uint8_t value) {
+      switch (reg) {
+        case LIS_WHO_AM_I:
+        case LIS_STATUS_REG:
+        case LIS_FIFO_SRC:
+        case LIS_INT1_SRC:
+          return;   // Read-only
+        case LIS_CTRL_REG1:
+          if ((_s.regs[LIS_CTRL_REG1] >> 4) == 0) {
+            _lastSampleUs = sim::bootUs();   // Leaving power-down
+          }
+          break;
+        case LIS_FIFO_CTRL:
+          if ((value >> 6) == 0) {
+            _s.fifoHead = 0;
+            _s.fifoCount = 0;   // Bypass empties the FIFO
+          }
+          break;
+        case LIS_INT1_CFG:
+          _s.overThreshold = 0;
+          break;
+      }
+      if (reg >= LIS_OUT_X_L && reg <= LIS_OUT_Z_H) {
+        return;
+      }
+      _s.regs[reg] = value;
+    }
+
+    uint8_t readRegister(uint8_t reg) {
+      switch (reg) {
+        case LIS_REFERENCE: {
+          // Reading REFERENCE resets the high-pass filter to the current input
+          for (int axis = 0; axis < 3; axis++) {
+            _s.reference[axis] = (_s.lastRaw[axis] >> shift()) * sensitivityG();
+          }
+          return _s.regs[LIS_REFERENCE];
+        }
+        case LIS_FIFO_SRC: {
+          uint8_t count = fifoActive() ? _s.fifoCount : 0;
+          uint8_t value = (count == LIS_FIFO_DEPTH) ? (0x40 | 31) : count;
+          if (count == 0) {
+            value |= 0x20;   // EMPTY
+          }
+          if (count > (_s.regs[LIS_FIFO_CTRL] & 0x1F)) {
+            value |= 0x80;   // WTM
+          }
+          return value;
+        }
+        case LIS_INT1_SRC: {
+          uint8_t value = _s.int1Src;
+          _s.int1Src = 0;
+          _s.overThreshold = 0;
+          return value;
+        }
+        case LIS_OUT_X_L:
+          s_accelReads.fetch_add(1, std::memory_order_relaxed);
+          if (fifoActive() && _s.fifoCount > 0) {
+            setOutput(_s.fifo[_s.fifoHead]);
+            _s.fifoHead = (_s.fifoHead + 1) % LIS_FIFO_DEPTH;
+            _s.fifoCount--;
+          }
+          _s.regs[LIS_STATUS_REG] &= (uint8_t)~0x08;
+          break;
+      }
+      return _s.regs[reg];
+    }
+};
+
+// -------------------------------------------------------- SHT45
+
+class SimSHT45 : public SimI2CDevice {
+  public:
+    SimSHT45() : SimI2CDevice(SIM_SHT45_ADDRESS, "SHT45"), _pending(NONE), _readyUs(0) {}
+
+    bool write(const uint8_t* data, size_t len) override {
+      uint64_t now = sim::bootUs();
+      if (now < _readyUs && _pending == RESET) {
+        return false;   // Still resetting
+      }
+      if (len != 1) {
+        return false;
+      }
+      switch (data[0]) {
+        case 0xFD:   // High precision
+          start(MEASURE, now + SIM_SHT45_MEASURE_US);
+          return true;
+        case 0xF6:   // Medium precision
+          start(MEASURE, now + 4500);
+          return true;
+        case 0xE0:   // Low precision
+          start(MEASURE, now + 1700);
+          return true;
+        case 0x89:
+          start(SERIAL_NUMBER, now + 200);
+          return true;
+        case 0x94:
+          start(RESET, now + SIM_SHT45_RESET_US);
+          return true;
+        default:
+          return false;
+      }
+    }
+
+    size_t read(uint8_t* out, size_t len) override {
+      uint64_t now = sim::bootUs();
+      if (_pending == NONE || _pending == RESET || now < _readyUs) {
+        return 0;   // NACK while measuring, or with nothing to send
+      }
+      uint8_t frame[6];
+      if (_pending == MEASURE) {
+        float tempC;
+        float humidity;
+        sim::sensorSource()->climate(_readyUs, tempC, humidity);
+        // Datasheet transfer functions: T = -45 + 175 S/65535, RH = -6 + 125 S/65535
+        putWord(frame, ticks((tempC + 45.0) / 175.0));
+        putWord(frame + 3, ticks((humidity + 6.0) / 125.0));
+      } else {
+        uint32_t serial = (uint32_t)(0x0B5E0000u ^ sim::seed());
+        putWord(frame, (uint16_t)(serial >> 16));
+        putWord(frame + 3, (uint16_t)serial);
+      }
+      _pending = NONE;
+      size_t n = (len < sizeof(frame)) ? len : sizeof(frame);
+      memcpy(out, frame, n);
+      return n;
+    }
+
+  private:
+    enum Pending { NONE, MEASURE, SERIAL_NUMBER, RESET };
+    Pending _pending;
+    uint64_t _readyUs;
+
+    void start(Pending pending, uint64_t readyUs) {
+      _pending = pending;
+      _readyUs = readyUs;
+    }
+
+    static uint16_t ticks(double fraction) {
+      double value = fraction * 65535.0;
+      if (value < 0.0) value = 0.0;
+      if (value > 65535.0) value = 65535.0;
+      return (uint16_t)lround(value);
+    }
+
+    static uint8_t crc8(const uint8_t* data, size_t len) {
+      uint8_t crc = 0xFF;
+      for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+          crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+        }
+      }
+      return crc;
+    }
+
+    static void putWord(uint8_t* out, uint16_t word) {
+      out[0] = (uint8_t)(word >> 8);
+      out[1] = (uint8_t)word;
+      out[2] = crc8(out, 2);
+    }
+};
+
+static SimNAU7802 s_nau7802;
+static SimLIS3DH s_lis3dh;
+static SimSHT45 s_sht45;
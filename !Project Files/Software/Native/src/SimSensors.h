@@ -0,0 +1,63 @@
+/*
+  Filename: SimSensors.h
+  Simulated Receiver Sensors
+
+  Description: Register-level models of the receiver's I2C sensors on the
+               simulated bus: NAU7802 strain ADC (0x2A), LIS3DH accelerometer
+               (0x18) and SHT45 temperature/humidity (0x44). The physics come
+               from a SimSensorSource; the default one is a quiet bridge,
+               gravity on Z and a slow climate drift, with a "load event"
+               (a strain pulse plus a shake) on SIGUSR1 or every
+               WABASH_SIM_EVENT_PERIOD_S seconds.
+
+               The LIS3DH samples on its own thread at the configured ODR,
+               fills its FIFO and drives INT1 (SIM_LIS3DH_INT1_PIN), so
+               motion wake works from light and deep sleep. Its registers and
+               FIFO survive the deep sleep re-exec like the real chip's.
+
+  Environment:
+    WABASH_SIM_EVENT_PERIOD_S  fire a load event every N seconds (default off)
+*/
+
+#ifndef SIM_SENSORS_H
+#define SIM_SENSORS_H
+
+#include <stdint.h>
+
+#ifndef SIM_LIS3DH_INT1_PIN
+  #define SIM_LIS3DH_INT1_PIN  7
+#endif
+
+#define SIM_NAU7802_ADDRESS  0x2A
+#define SIM_LIS3DH_ADDRESS   0x18
+#define SIM_SHT45_ADDRESS    0x44
+
+class SimSensorSource {
+  public:
+    virtual ~SimSensorSource() {}
+
+    // Bridge differential input at the NAU7802 pins, microvolts
+    virtual double strainMicroVolts(uint64_t us) = 0;
+    // Acceleration in g before range clipping
+    virtual void accelG(uint64_t us, float& x, float& y, float& z) = 0;
+    virtual void climate(uint64_t us, float& tempC, float& humidity) = 0;
+};
+
+namespace sim {
+
+/**
+ * Replace the physics behind the sensors (e.g. a recorded trace)
+ * @param source must outlive the program; nullptr restores the default
+ */
+void setSensorSource(SimSensorSource* source);
+SimSensorSource* sensorSource();
+
+// Async-signal-safe: start a load event on the default source now
+void triggerLoadEvent();
+
+// Samples the firmware has read out so far: NAU7802 conversions, LIS3DH samples
+void sensorReadCounts(uint64_t& strain, uint64_t& accel);
+
+}  // namespace sim
+
+#endif
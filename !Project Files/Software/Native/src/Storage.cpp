@@ -0,0 +1,60 @@
+/*
+  Filename: Storage.cpp
+  SD, LittleFS and SPIFFS Mounts (native)
+*/
+
+#include <dirent.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <unistd.h>
+
+#include "LittleFS.h"
+#include "SD.h"
+#include "SPI.h"
+#include "SPIFFS.h"
+#include "SimHost.h"
+
+SPIClass SPI(FSPI);
+SDFS SD;
+LittleFSFS LittleFS;
+SPIFFSFS SPIFFS;
+
+bool SDFS::begin(uint8_t, SPIClass&, uint32_t, const char*, uint8_t, bool) {
+  if (getenv("WABASH_SIM_NO_SD") != nullptr) {
+    sim::log("SD card removed (WABASH_SIM_NO_SD)");
+    return false;
+  }
+  return mountHost("sd");
+}
+
+bool LittleFSFS::begin(bool, const char*, uint8_t, const char*) {
+  return mountHost("littlefs");
+}
+
+static void removeTree(const std::string& host) {
+  DIR* dir = opendir(host.c_str());
+  if (dir == nullptr) {
+    return;
+  }
+  struct dirent* entry;
+  while ((entry = readdir(dir)) != nullptr) {
+    if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+      continue;
+    }
+    std::string child = host + "/" + entry->d_name;
+    if (entry->d_type == DT_DIR) {
+      removeTree(child);
+      rmdir(child.c_str());
+    } else {
+      unlink(child.c_str());
+    }
+  }
+  closedir(dir);
+}
+
+bool LittleFSFS::format() {
+  std::string root = sim::nodePath("littlefs");
+  removeTree(root);
+  return true;
+}
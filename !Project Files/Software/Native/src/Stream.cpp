@@ -0,0 +1,64 @@
+/*
+  Filename: Stream.cpp
+  Arduino Stream Implementation (native)
+*/
+
+#include "Stream.h"
+
+#include "Arduino.h"
+
+int Stream::timedRead() {
+  unsigned long start = millis();
+  do {
+    int c = read();
+    if (c >= 0) {
+      return c;
+    }
+    delay(1);
+  } while (millis() - start < _timeout);
+  return -1;
+}
+
+size_t Stream::readBytes(char* buffer, size_t length) {
+  size_t count = 0;
+  while (count < length) {
+    int c = timedRead();
+    if (c < 0) {
+      break;
+    }
+    buffer[count++] = (char)c;
+  }
+  return count;
+}
+
+size_t Stream::readBytesUntil(char terminator, char* buffer, size_t length) {
+  size_t count = 0;
+  while (count < length) {
+    int c = timedRead();
+    if (c < 0 || c == terminator) {
+      break;
+    }
+    buffer[count++] = (char)c;
+  }
+  return count;
+}
+
+String Stream::readString() {
+  String out;
+  int c = timedRead();
+  while (c >= 0) {
+    out += (char)c;
+    c = timedRead();
+  }
+  return out;
+}
+
+String Stream::readStringUntil(char terminator) {
+  String out;
+  int c = timedRead();
+  while (c >= 0 && c != terminator) {
+    out += (char)c;
+    c = timedRead();
+  }
+  return out;
+}
@@ -0,0 +1,38 @@
+/*
+  Filename: Stream.h
+  Arduino Stream (native)
+
+  Description: Byte input on top of Print with the core's timed helpers
+               (readBytes, readStringUntil). The timeout applies only while a
+               source has nothing available, as on the ESP32.
+*/
+
+#ifndef STREAM_H
+#define STREAM_H
+
+#include "Print.h"
+
+class Stream : public Print {
+  public:
+    Stream() : _timeout(1000) {}
+
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long timeoutMs) { _timeout = timeoutMs; }
+    unsigned long getTimeout() const { return _timeout; }
+
+    size_t readBytes(char* buffer, size_t length);
+    size_t readBytes(uint8_t* buffer, size_t length) { return readBytes((char*)buffer, length); }
+    size_t readBytesUntil(char terminator, char* buffer, size_t length);
+    String readString();
+    String readStringUntil(char terminator);
+
+  protected:
+    unsigned long _timeout;
+
+    int timedRead();
+};
+
+#endif
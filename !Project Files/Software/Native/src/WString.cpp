@@ -0,0 +1,446 @@
+/*
+  Filename: WString.cpp
+  Arduino String Implementation (native)
+
+  Description: Growth doubles the buffer like the Arduino-ESP32 String; a
+               failed allocation leaves an invalid (empty) string rather than
+               throwing.
+*/
+
+#include "WString.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void formatInteger(char* out, size_t size, unsigned long long value, bool negative, unsigned char base) {
+  char digits[66];
+  size_t n = 0;
+  if (base < 2 || base > 36) {
+    base = 10;
+  }
+  do {
+    unsigned digit = (unsigned)(value % base);
+    digits[n++] = (char)(digit < 10 ? '0' + digit : 'a' + digit - 10);
+    value /= base;
+  } while (value != 0 && n < sizeof(digits) - 1);
+  size_t pos = 0;
+  if (negative && pos + 1 < size) {
+    out[pos++] = '-';
+  }
+  while (n > 0 && pos + 1 < size) {
+    out[pos++] = digits[--n];
+  }
+  out[pos] = '\0';
+}
+
+static void formatSigned(char* out, size_t size, long long value, unsigned char base) {
+  if (base == 10 && value < 0) {
+    formatInteger(out, size, 0ULL - (unsigned long long)value, true, base);
+  } else {
+    // Arduino prints negative non-decimal values as their unsigned bit pattern
+    formatInteger(out, size, (unsigned long long)value, false, base);
+  }
+}
+
+String::String(const char* text) : _buf(nullptr), _len(0), _cap(0) {
+  if (text != nullptr) {
+    assign(text, (unsigned int)strlen(text));
+  }
+}
+
+String::String(const char* text, unsigned int length) : _buf(nullptr), _len(0), _cap(0) {
+  if (text != nullptr) {
+    assign(text, length);
+  }
+}
+
+String::String(const String& other) : _buf(nullptr), _len(0), _cap(0) {
+  assign(other.c_str(), other._len);
+}
+
+String::String(String&& other) noexcept : _buf(other._buf), _len(other._len), _cap(other._cap) {
+  other._buf = nullptr;
+  other._len = 0;
+  other._cap = 0;
+}
+
+String::String(char c) : _buf(nullptr), _len(0), _cap(0) {
+  assign(&c, 1);
+}
+
+String::String(unsigned char value, unsigned char base) : _buf(nullptr), _len(0), _cap(0) {
+  char text[70];
+  formatInteger(text, sizeof(text), value, false, base);
+  assign(text, (unsigned int)strlen(text));
+}
+
+String::String(int value, unsigned char base) : _buf(nullptr), _len(0), _cap(0) {
+  char text[70];
+  formatSigned(text, sizeof(text), base == 10 ? (long long)value : (long long)(unsigned int)value, base);
+  assign(text, (unsigned int)strlen(text));
+}
+
+String::String(unsigned int value, unsigned char base) : _buf(nullptr), _len(0), _cap(0) {
+  char text[70];
+  formatInteger(text, sizeof(text), value, false, base);
+  assign(text, (unsigned int)strlen(text));
+}
+
+String::String(long value, unsigned char base) : _buf(nullptr), _len(0), _cap(0) {
+  char text[70];
+  formatSigned(text, sizeof(text), base == 10 ? (long long)value : (long long)(unsigned long)value, base);
+  assign(text, (unsigned int)strlen(text));
+}
+
+String::String(unsigned long value, unsigned char base) : _buf(nullptr), _len(0), _cap(0) {
+  char text[70];
+  formatInteger(text, sizeof(text), value, false, base);
+  assign(text, (unsigned int)strlen(text));
+}
+
+String::String(long long value, unsigned char base) : _buf(nullptr), _len(0), _cap(0) {
+  char text[70];
+  formatSigned(text, sizeof(text), value, base);
+  assign(text, (unsigned int)strlen(text));
+}
+
+String::String(unsigned long long value, unsigned char base) : _buf(nullptr), _len(0), _cap(0) {
+  char text[70];
+  formatInteger(text, sizeof(text), value, false, base);
+  assign(text, (unsigned int)strlen(text));
+}
+
+String::String(float value, unsigned int decimals) : String((double)value, decimals) {}
+
+String::String(double value, unsigned int decimals) : _buf(nullptr), _len(0), _cap(0) {
+  char text[64];
+  snprintf(text, sizeof(text), "%.*f", (int)decimals, value);
+  assign(text, (unsigned int)strlen(text));
+}
+
+String::~String() {
+  free(_buf);
+}
+
+String& String::operator=(const String& other) {
+  if (this != &other) {
+    assign(other.c_str(), other._len);
+  }
+  return *this;
+}
+
+String& String::operator=(String&& other) noexcept {
+  if (this != &other) {
+    free(_buf);
+    _buf = other._buf;
+    _len = other._len;
+    _cap = other._cap;
+    other._buf = nullptr;
+    other._len = 0;
+    other._cap = 0;
+  }
+  return *this;
+}
+
+String& String::operator=(const char* text) {
+  if (text == nullptr) {
+    invalidate();
+  } else {
+    assign(text, (unsigned int)strlen(text));
+  }
+  return *this;
+}
+
+bool String::reserve(unsigned int size) {
+  if (_buf != nullptr && _cap >= size) {
+    return true;
+  }
+  unsigned int cap = _cap > 0 ? _cap : 16;
+  while (cap < size) {
+    cap *= 2;
+  }
+  char* grown = (char*)realloc(_buf, cap + 1);
+  if (grown == nullptr) {
+    return false;
+  }
+  if (_buf == nullptr) {
+    grown[0] = '\0';
+  }
+  _buf = grown;
+  _cap = cap;
+  return true;
+}
+
+void String::assign(const char* text, unsigned int length) {
+  if (!reserve(length)) {
+    invalidate();
+    return;
+  }
+  memmove(_buf, text, length);
+  _buf[length] = '\0';
+  _len = length;
+}
+
+void String::invalidate() {
+  free(_buf);
+  _buf = nullptr;
+  _len = 0;
+  _cap = 0;
+}
+
+bool String::concat(const char* text, unsigned int length) {
+  if (text == nullptr) {
+    return false;
+  }
+  if (length == 0) {
+    return true;
+  }
+  // text may point into our own buffer
+  size_t offset = (_buf != nullptr && text >= _buf && text < _buf + _len) ? (size_t)(text - _buf) : (size_t)-1;
+  if (!reserve(_len + length)) {
+    return false;
+  }
+  memmove(_buf + _len, offset != (size_t)-1 ? _buf + offset : text, length);
+  _len += length;
+  _buf[_len] = '\0';
+  return true;
+}
+
+bool String::concat(const String& other) { return concat(other.c_str(), other._len); }
+bool String::concat(const char* text) { return text != nullptr && concat(text, (unsigned int)strlen(text)); }
+bool String::concat(char c) { return concat(&c, 1); }
+bool String::concat(unsigned char value) { return concat(String(value)); }
+bool String::concat(int value) { return concat(String(value)); }
+bool String::concat(unsigned int value) { return concat(String(value)); }
+bool String::concat(long value) { return concat(String(value)); }
+bool String::concat(unsigned long value) { return concat(String(value)); }
+bool String::concat(long long value) { return concat(String(value)); }
+bool String::concat(unsigned long long value) { return concat(String(value)); }
+bool String::concat(float value) { return concat(String(value)); }
+bool String::concat(double value) { return concat(String(value)); }
+
+int String::compareTo(const String& other) const {
+  return strcmp(c_str(), other.c_str());
+}
+
+bool String::equals(const String& other) const {
+  return _len == other._len && memcmp(c_str(), other.c_str(), _len) == 0;
+}
+
+bool String::equals(const char* text) const {
+  return strcmp(c_str(), text != nullptr ? text : "") == 0;
+}
+
+bool String::equalsIgnoreCase(const String& other) const {
+  return _len == other._len && strcasecmp(c_str(), other.c_str()) == 0;
+}
+
+bool String::startsWith(const String& prefix) const {
+  return startsWith(prefix, 0);
+}
+
+bool String::startsWith(const String& prefix, unsigned int offset) const {
+  if (offset > _len || prefix._len > _len - offset) {
+    return false;
+  }
+  return strncmp(c_str() + offset, prefix.c_str(), prefix._len) == 0;
+}
+
+bool String::endsWith(const String& suffix) const {
+  if (suffix._len > _len) {
+    return false;
+  }
+  return strcmp(c_str() + _len - suffix._len, suffix.c_str()) == 0;
+}
+
+char String::charAt(unsigned int index) const {
+  return index < _len ? _buf[index] : '\0';
+}
+
+void String::setCharAt(unsigned int index, char c) {
+  if (index < _len) {
+    _buf[index] = c;
+  }
+}
+
+char String::operator[](unsigned int index) const {
+  return charAt(index);
+}
+
+char& String::operator[](unsigned int index) {
+  static char dummy;
+  if (index >= _len) {
+    dummy = '\0';
+    return dummy;
+  }
+  return _buf[index];
+}
+
+void String::toCharArray(char* out, unsigned int size, unsigned int index) const {
+  getBytes((unsigned char*)out, size, index);
+}
+
+void String::getBytes(unsigned char* out, unsigned int size, unsigned int index) const {
+  if (size == 0 || out == nullptr) {
+    return;
+  }
+  if (index >= _len) {
+    out[0] = '\0';
+    return;
+  }
+  unsigned int n = _len - index;
+  if (n > size - 1) {
+    n = size - 1;
+  }
+  memcpy(out, _buf + index, n);
+  out[n] = '\0';
+}
+
+int String::indexOf(char c, unsigned int from) const {
+  if (from >= _len) {
+    return -1;
+  }
+  const char* hit = (const char*)memchr(_buf + from, c, _len - from);
+  return hit != nullptr ? (int)(hit - _buf) : -1;
+}
+
+int String::indexOf(const String& text, unsigned int from) const {
+  if (from >= _len) {
+    return -1;
+  }
+  const char* hit = strstr(_buf + from, text.c_str());
+  return hit != nullptr ? (int)(hit - _buf) : -1;
+}
+
+int String::lastIndexOf(char c) const {
+  return _len > 0 ? lastIndexOf(c, _len - 1) : -1;
+}
+
+int String::lastIndexOf(char c, unsigned int from) const {
+  if (_len == 0) {
+    return -1;
+  }
+  if (from >= _len) {
+    from = _len - 1;
+  }
+  for (int i = (int)from; i >= 0; i--) {
+    if (_buf[i] == c) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+int String::lastIndexOf(const String& text) const {
+  if (text._len == 0 || text._len > _len) {
+    return -1;
+  }
+  for (int i = (int)(_len - text._len); i >= 0; i--) {
+    if (strncmp(_buf + i, text.c_str(), text._len) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+String String::substring(unsigned int from) const {
+  return substring(from, _len);
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+  if (from > to) {
+    unsigned int swap = from;
+    from = to;
+    to = swap;
+  }
+  if (from >= _len) {
+    return String();
+  }
+  if (to > _len) {
+    to = _len;
+  }
+  return String(_buf + from, to - from);
+}
+
+void String::replace(char find, char with) {
+  for (unsigned int i = 0; i < _len; i++) {
+    if (_buf[i] == find) {
+      _buf[i] = with;
+    }
+  }
+}
+
+void String::replace(const String& find, const String& with) {
+  if (_len == 0 || find._len == 0) {
+    return;
+  }
+  String out;
+  out.reserve(_len);
+  unsigned int pos = 0;
+  int hit;
+  while ((hit = indexOf(find, pos)) >= 0) {
+    out.concat(_buf + pos, (unsigned int)hit - pos);
+    out.concat(with);
+    pos = (unsigned int)hit + find._len;
+  }
+  out.concat(_buf + pos, _len - pos);
+  *this = static_cast<String&&>(out);
+}
+
+void String::remove(unsigned int index) {
+  remove(index, (unsigned int)-1);
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+  if (index >= _len) {
+    return;
+  }
+  if (count > _len - index) {
+    count = _len - index;
+  }
+  memmove(_buf + index, _buf + index + count, _len - index - count + 1);
+  _len -= count;
+}
+
+void String::toLowerCase() {
+  for (unsigned int i = 0; i < _len; i++) {
+    _buf[i] = (char)tolower((unsigned char)_buf[i]);
+  }
+}
+
+void String::toUpperCase() {
+  for (unsigned int i = 0; i < _len; i++) {
+    _buf[i] = (char)toupper((unsigned char)_buf[i]);
+  }
+}
+
+void String::trim() {
+  if (_len == 0) {
+    return;
+  }
+  unsigned int start = 0;
+  while (start < _len && isspace((unsigned char)_buf[start])) {
+    start++;
+  }
+  unsigned int end = _len;
+  while (end > start && isspace((unsigned char)_buf[end - 1])) {
+    end--;
+  }
+  _len = end - start;
+  memmove(_buf, _buf + start, _len);
+  _buf[_len] = '\0';
+}
+
+long String::toInt() const {
+  return _buf != nullptr ? atol(_buf) : 0;
+}
+
+float String::toFloat() const {
+  return (float)toDouble();
+}
+
+double String::toDouble() const {
+  return _buf != nullptr ? atof(_buf) : 0.0;
+}
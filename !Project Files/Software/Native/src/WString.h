@@ -0,0 +1,138 @@
+/*
+  Filename: WString.h
+  Arduino String (native)
+
+  Description: The Arduino String class on a malloc'd buffer, so the
+               firmware's String traffic shows up in AllocCounter exactly as
+               it does on the ESP32. Covers the members the firmware and the
+               Arduino-ESP32 core headers use.
+*/
+
+#ifndef WSTRING_H
+#define WSTRING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+class String {
+  public:
+    String(const char* text = "");
+    String(const char* text, unsigned int length);
+    String(const String& other);
+    String(String&& other) noexcept;
+    explicit String(char c);
+    explicit String(unsigned char value, unsigned char base = 10);
+    explicit String(int value, unsigned char base = 10);
+    explicit String(unsigned int value, unsigned char base = 10);
+    explicit String(long value, unsigned char base = 10);
+    explicit String(unsigned long value, unsigned char base = 10);
+    explicit String(long long value, unsigned char base = 10);
+    explicit String(unsigned long long value, unsigned char base = 10);
+    explicit String(float value, unsigned int decimals = 2);
+    explicit String(double value, unsigned int decimals = 2);
+    ~String();
+
+    String& operator=(const String& other);
+    String& operator=(String&& other) noexcept;
+    String& operator=(const char* text);
+
+    bool reserve(unsigned int size);
+    unsigned int length() const { return _len; }
+    bool isEmpty() const { return _len == 0; }
+    const char* c_str() const { return _buf != nullptr ? _buf : ""; }
+    char* begin() { return _buf; }
+    char* end() { return _buf + _len; }
+
+    bool concat(const String& other);
+    bool concat(const char* text);
+    bool concat(const char* text, unsigned int length);
+    bool concat(char c);
+    bool concat(unsigned char value);
+    bool concat(int value);
+    bool concat(unsigned int value);
+    bool concat(long value);
+    bool concat(unsigned long value);
+    bool concat(long long value);
+    bool concat(unsigned long long value);
+    bool concat(float value);
+    bool concat(double value);
+
+    template <typename T>
+    String& operator+=(const T& value) {
+      concat(value);
+      return *this;
+    }
+
+    int compareTo(const String& other) const;
+    bool equals(const String& other) const;
+    bool equals(const char* text) const;
+    bool equalsIgnoreCase(const String& other) const;
+    bool operator==(const String& other) const { return equals(other); }
+    bool operator==(const char* text) const { return equals(text); }
+    bool operator!=(const String& other) const { return !equals(other); }
+    bool operator!=(const char* text) const { return !equals(text); }
+    bool operator<(const String& other) const { return compareTo(other) < 0; }
+    bool operator>(const String& other) const { return compareTo(other) > 0; }
+    bool startsWith(const String& prefix) const;
+    bool startsWith(const String& prefix, unsigned int offset) const;
+    bool endsWith(const String& suffix) const;
+
+    char charAt(unsigned int index) const;
+    void setCharAt(unsigned int index, char c);
+    char operator[](unsigned int index) const;
+    char& operator[](unsigned int index);
+    void toCharArray(char* out, unsigned int size, unsigned int index = 0) const;
+    void getBytes(unsigned char* out, unsigned int size, unsigned int index = 0) const;
+
+    int indexOf(char c, unsigned int from = 0) const;
+    int indexOf(const String& text, unsigned int from = 0) const;
+    int lastIndexOf(char c) const;
+    int lastIndexOf(char c, unsigned int from) const;
+    int lastIndexOf(const String& text) const;
+    String substring(unsigned int from) const;
+    String substring(unsigned int from, unsigned int to) const;
+
+    void replace(char find, char with);
+    void replace(const String& find, const String& with);
+    void remove(unsigned int index);
+    void remove(unsigned int index, unsigned int count);
+    void toLowerCase();
+    void toUpperCase();
+    void trim();
+
+    long toInt() const;
+    float toFloat() const;
+    double toDouble() const;
+
+  private:
+    char* _buf;
+    unsigned int _len;
+    unsigned int _cap;
+
+    void assign(const char* text, unsigned int length);
+    void invalidate();
+};
+
+template <typename T>
+inline String operator+(const String& lhs, const T& rhs) {
+  String out(lhs);
+  out += rhs;
+  return out;
+}
+
+inline String operator+(const char* lhs, const String& rhs) {
+  String out(lhs);
+  out += rhs;
+  return out;
+}
+
+inline String operator+(char lhs, const String& rhs) {
+  String out(lhs);
+  out += rhs;
+  return out;
+}
+
+inline bool operator==(const char* lhs, const String& rhs) { return rhs.equals(lhs); }
+inline bool operator!=(const char* lhs, const String& rhs) { return !rhs.equals(lhs); }
+
+#endif
@@ -0,0 +1,508 @@
+/*
+  Filename: WiFi.cpp
+  Arduino-ESP32 WiFi Implementation (native)
+
+  Description: A running SoftAP is a file <root>/wifi/<ssid>.ap holding its
+               passphrase, so stations on other nodes can find it. Sockets
+               are plain host TCP; the client shares one descriptor between
+               copies like the core's WiFiClientSocketHandle.
+*/
+
+#include "WiFi.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "Arduino.h"
+#include "SimHost.h"
+
+WiFiClass WiFi;
+
+// ---------------------------------------------------------------- IPAddress
+
+bool IPAddress::fromString(const char* text) {
+  struct in_addr addr;
+  if (text == nullptr || inet_pton(AF_INET, text, &addr) != 1) {
+    return false;
+  }
+  _address = addr.s_addr;
+  return true;
+}
+
+String IPAddress::toString() const {
+  char text[16];
+  snprintf(text, sizeof(text), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+  return String(text);
+}
+
+size_t IPAddress::printTo(Print& out) const {
+  return out.print(toString());
+}
+
+// ---------------------------------------------------------------- WiFiClient
+
+struct SimSocket {
+  int fd;
+  explicit SimSocket(int descriptor) : fd(descriptor) {}
+  ~SimSocket() {
+    if (fd >= 0) {
+      ::close(fd);
+    }
+  }
+};
+
+WiFiClient::WiFiClient(int fd) : _socket(std::make_shared<SimSocket>(fd)) {}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port) {
+  return connect(ip, port, SIM_WIFI_TIMEOUT_MS);
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port, int32_t timeoutMs) {
+  stop();
+  // No route without a station link or our own SoftAP
+  if (WiFi.status() != WL_CONNECTED && (WiFi.getMode() & WIFI_MODE_AP) == 0) {
+    return 0;
+  }
+  int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    return 0;
+  }
+  struct sockaddr_in local;
+  memset(&local, 0, sizeof(local));
+  local.sin_family = AF_INET;
+  local.sin_addr.s_addr = (uint32_t)WiFi.nodeIP();
+  bind(fd, (struct sockaddr*)&local, sizeof(local));   // Source address shows which node connected
+
+  struct sockaddr_in remote;
+  memset(&remote, 0, sizeof(remote));
+  remote.sin_family = AF_INET;
+  remote.sin_port = htons(port);
+  remote.sin_addr.s_addr = (uint32_t)ip;
+  int result = ::connect(fd, (struct sockaddr*)&remote, sizeof(remote));
+  if (result != 0 && errno == EINPROGRESS) {
+    struct pollfd pfd = {fd, POLLOUT, 0};
+    int error = 0;
+    socklen_t errorLen = sizeof(error);
+    if (poll(&pfd, 1, timeoutMs) == 1 && getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &errorLen) == 0 &&
+        error == 0) {
+      result = 0;
+    }
+  }
+  if (result != 0) {
+    ::close(fd);
+    return 0;
+  }
+  // Blocking from here on, with the core's send timeout
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+  struct timeval tv = {SIM_WIFI_TIMEOUT_MS / 1000, 0};
+  setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+  _socket = std::make_shared<SimSocket>(fd);
+  return 1;
+}
+
+int WiFiClient::connect(const char* host, uint16_t port) {
+  return connect(host, port, SIM_WIFI_TIMEOUT_MS);
+}
+
+int WiFiClient::connect(const char* host, uint16_t port, int32_t timeoutMs) {
+  IPAddress ip;
+  if (!ip.fromString(host)) {
+    struct addrinfo hints;
+    struct addrinfo* found = nullptr;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    if (getaddrinfo(host, nullptr, &hints, &found) != 0 || found == nullptr) {
+      return 0;
+    }
+    ip = IPAddress((uint32_t)((struct sockaddr_in*)found->ai_addr)->sin_addr.s_addr);
+    freeaddrinfo(found);
+  }
+  return connect(ip, port, timeoutMs);
+}
+
+uint8_t WiFiClient::connected() {
+  if (!_socket || _socket->fd < 0) {
+    return 0;
+  }
+  uint8_t probe;
+  ssize_t got = recv(_socket->fd, &probe, 1, MSG_PEEK | MSG_DONTWAIT);
+  if (got == 0 || (got < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+    // Peer closed; unread data still counts as connected, as in the core
+    return available() > 0 ? 1 : 0;
+  }
+  return 1;
+}
+
+void WiFiClient::stop() {
+  _socket.reset();
+}
+
+size_t WiFiClient::write(uint8_t data) {
+  return write(&data, 1);
+}
+
+size_t WiFiClient::write(const uint8_t* buffer, size_t size) {
+  if (!_socket || _socket->fd < 0) {
+    return 0;
+  }
+  size_t sent = 0;
+  while (sent < size) {
+    ssize_t n = send(_socket->fd, buffer + sent, size - sent, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      break;
+    }
+    sent += (size_t)n;
+  }
+  return sent;
+}
+
+int WiFiClient::available() {
+  if (!_socket || _socket->fd < 0) {
+    return 0;
+  }
+  int count = 0;
+  return (ioctl(_socket->fd, FIONREAD, &count) == 0) ? count : 0;
+}
+
+int WiFiClient::read() {
+  uint8_t data;
+  return (read(&data, 1) == 1) ? data : -1;
+}
+
+int WiFiClient::read(uint8_t* buffer, size_t size) {
+  if (!_socket || _socket->fd < 0) {
+    return -1;
+  }
+  ssize_t got = recv(_socket->fd, buffer, size, MSG_DONTWAIT);
+  return (got < 0) ? -1 : (int)got;
+}
+
+int WiFiClient::peek() {
+  if (!_socket || _socket->fd < 0) {
+    return -1;
+  }
+  uint8_t data;
+  return (recv(_socket->fd, &data, 1, MSG_PEEK | MSG_DONTWAIT) == 1) ? data : -1;
+}
+
+void WiFiClient::flush() {
+  uint8_t discard[256];
+  int pending;
+  while ((pending = available()) > 0) {
+    if (read(discard, (size_t)pending < sizeof(discard) ? (size_t)pending : sizeof(discard)) <= 0) {
+      break;
+    }
+  }
+}
+
+int WiFiClient::setNoDelay(bool noDelay) {
+  if (!_socket || _socket->fd < 0) {
+    return -1;
+  }
+  int flag = noDelay ? 1 : 0;
+  return setsockopt(_socket->fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+}
+
+int WiFiClient::setTimeout(uint32_t seconds) {
+  Stream::setTimeout(seconds * 1000);
+  if (!_socket || _socket->fd < 0) {
+    return 0;
+  }
+  struct timeval tv = {(time_t)seconds, 0};
+  setsockopt(_socket->fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  return setsockopt(_socket->fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+}
+
+IPAddress WiFiClient::remoteIP() const {
+  struct sockaddr_in addr;
+  socklen_t len = sizeof(addr);
+  if (!_socket || getpeername(_socket->fd, (struct sockaddr*)&addr, &len) != 0) {
+    return IPAddress();
+  }
+  return IPAddress((uint32_t)addr.sin_addr.s_addr);
+}
+
+uint16_t WiFiClient::remotePort() const {
+  struct sockaddr_in addr;
+  socklen_t len = sizeof(addr);
+  if (!_socket || getpeername(_socket->fd, (struct sockaddr*)&addr, &len) != 0) {
+    return 0;
+  }
+  return ntohs(addr.sin_port);
+}
+
+// ---------------------------------------------------------------- WiFiServer
+
+void WiFiServer::begin(uint16_t port) {
+  if (port != 0) {
+    _port = port;
+  }
+  end();
+  int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    return;
+  }
+  int reuse = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(_port);
+  addr.sin_addr.s_addr = (uint32_t)WiFi.nodeIP();
+  if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, _maxClients) != 0) {
+    sim::log("WiFiServer: listen on %s:%u failed: %s", WiFi.nodeIP().toString().c_str(), _port, strerror(errno));
+    ::close(fd);
+    return;
+  }
+  _fd = fd;
+}
+
+WiFiClient WiFiServer::accept() {
+  if (_fd < 0) {
+    return WiFiClient();
+  }
+  int fd = accept4(_fd, nullptr, nullptr, SOCK_CLOEXEC);
+  if (fd < 0) {
+    return WiFiClient();
+  }
+  struct timeval tv = {SIM_WIFI_TIMEOUT_MS / 1000, 0};
+  setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+  return WiFiClient(fd);
+}
+
+void WiFiServer::end() {
+  if (_fd >= 0) {
+    ::close(_fd);
+    _fd = -1;
+  }
+}
+
+// ---------------------------------------------------------------- WiFiClass
+
+static std::string apFilePath(const std::string& ssid) {
+  return sim::sharedPath("wifi") + "/" + ssid + ".ap";
+}
+
+WiFiClass::WiFiClass()
+    : _mode(WIFI_MODE_NULL), _sleep(true), _joining(false), _connected(false), _ssidInRange(false),
+      _connectAtUs(0), _handlers() {
+  // 127.h1.h2.h3 from the node name; never .0 or .255 in the last octet
+  uint32_t hash = 2166136261u;
+  for (const char* c = sim::nodeName(); *c != '\0'; c++) {
+    hash = (hash ^ (uint8_t)*c) * 16777619u;
+  }
+  uint8_t last = (uint8_t)(hash >> 16);
+  if (last == 0 || last == 255) {
+    last = 1;
+  }
+  _nodeIp = IPAddress(127, (uint8_t)hash, (uint8_t)(hash >> 8), last);
+}
+
+bool WiFiClass::inRange(const char* ssid, const char* passphrase) const {
+  FILE* ap = fopen(apFilePath(ssid).c_str(), "r");
+  if (ap != nullptr) {
+    char stored[65] = "";
+    size_t len = fread(stored, 1, sizeof(stored) - 1, ap);
+    stored[len] = '\0';
+    fclose(ap);
+    return strcmp(stored, (passphrase != nullptr) ? passphrase : "") == 0;
+  }
+  const char* networks = getenv("WABASH_SIM_WIFI_NETWORKS");
+  if (networks == nullptr || networks[0] == '\0') {
+    return true;
+  }
+  size_t ssidLen = strlen(ssid);
+  for (const char* entry = networks; *entry != '\0';) {
+    const char* comma = strchr(entry, ',');
+    size_t len = (comma != nullptr) ? (size_t)(comma - entry) : strlen(entry);
+    if (len == ssidLen && strncmp(entry, ssid, len) == 0) {
+      return true;
+    }
+    if (comma == nullptr) {
+      break;
+    }
+    entry = comma + 1;
+  }
+  return false;
+}
+
+wl_status_t WiFiClass::begin(const char* ssid, const char* passphrase) {
+  if (ssid == nullptr || ssid[0] == '\0' || strlen(ssid) > 32) {
+    return WL_CONNECT_FAILED;
+  }
+  if ((_mode & WIFI_MODE_STA) == 0) {
+    mode((wifi_mode_t)(_mode | WIFI_MODE_STA));
+  }
+  _ssid = ssid;
+  _joining = true;
+  _connected = false;
+  _ssidInRange = inRange(ssid, passphrase);
+  _connectAtUs = sim::bootUs() + SIM_WIFI_CONNECT_MS * 1000ULL;
+  return WL_DISCONNECTED;
+}
+
+wl_status_t WiFiClass::status() {
+  if ((_mode & WIFI_MODE_STA) == 0) {
+    return WL_DISCONNECTED;
+  }
+  if (_connected) {
+    return WL_CONNECTED;
+  }
+  if (!_joining) {
+    return WL_IDLE_STATUS;
+  }
+  if (sim::bootUs() < _connectAtUs) {
+    return WL_DISCONNECTED;
+  }
+  if (!_ssidInRange) {
+    return WL_NO_SSID_AVAIL;
+  }
+  _joining = false;
+  _connected = true;
+  sim::log("WiFi: joined \"%s\" as %s", _ssid.c_str(), _nodeIp.toString().c_str());
+  fire(ARDUINO_EVENT_WIFI_STA_CONNECTED);
+  fire(ARDUINO_EVENT_WIFI_STA_GOT_IP);
+  return WL_CONNECTED;
+}
+
+bool WiFiClass::disconnect(bool wifioff, bool) {
+  bool wasConnected = _connected;
+  _joining = false;
+  _connected = false;
+  if (wasConnected) {
+    fire(ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+  }
+  if (wifioff) {
+    mode((wifi_mode_t)(_mode & ~WIFI_MODE_STA));
+  }
+  return true;
+}
+
+bool WiFiClass::mode(wifi_mode_t newMode) {
+  wifi_mode_t oldMode = _mode;
+  if (newMode == oldMode) {
+    return true;
+  }
+  _mode = newMode;
+  if ((oldMode & WIFI_MODE_STA) && !(newMode & WIFI_MODE_STA)) {
+    if (_connected) {
+      fire(ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+    }
+    _joining = false;
+    _connected = false;
+    fire(ARDUINO_EVENT_WIFI_STA_STOP);
+  }
+  if ((oldMode & WIFI_MODE_AP) && !(newMode & WIFI_MODE_AP) && !_apSsid.empty()) {
+    unlink(apFilePath(_apSsid).c_str());
+    _apSsid.clear();
+    fire(ARDUINO_EVENT_WIFI_AP_STOP);
+  }
+  if (!(oldMode & WIFI_MODE_STA) && (newMode & WIFI_MODE_STA)) {
+    fire(ARDUINO_EVENT_WIFI_STA_START);
+  }
+  return true;
+}
+
+IPAddress WiFiClass::localIP() {
+  return (status() == WL_CONNECTED) ? _nodeIp : IPAddress();
+}
+
+String WiFiClass::SSID() {
+  return (status() == WL_CONNECTED) ? String(_ssid.c_str()) : String();
+}
+
+int8_t WiFiClass::RSSI() {
+  return (status() == WL_CONNECTED) ? -55 : 0;
+}
+
+String WiFiClass::macAddress() {
+  uint64_t mac = ESP.getEfuseMac();
+  char text[18];
+  snprintf(text, sizeof(text), "%02X:%02X:%02X:%02X:%02X:%02X", (unsigned)(mac & 0xFF), (unsigned)((mac >> 8) & 0xFF),
+           (unsigned)((mac >> 16) & 0xFF), (unsigned)((mac >> 24) & 0xFF), (unsigned)((mac >> 32) & 0xFF),
+           (unsigned)((mac >> 40) & 0xFF));
+  return String(text);
+}
+
+bool WiFiClass::softAP(const char* ssid, const char* passphrase, int, int, int) {
+  if (ssid == nullptr || ssid[0] == '\0' || strlen(ssid) > 32 || strchr(ssid, '/') != nullptr) {
+    return false;
+  }
+  // WPA2 needs 8..63 characters; none means an open network
+  if (passphrase != nullptr && passphrase[0] != '\0' && (strlen(passphrase) < 8 || strlen(passphrase) > 63)) {
+    return false;
+  }
+  if ((_mode & WIFI_MODE_AP) == 0) {
+    mode((wifi_mode_t)(_mode | WIFI_MODE_AP));
+  }
+  if (!_apSsid.empty() && _apSsid != ssid) {
+    unlink(apFilePath(_apSsid).c_str());
+  }
+  FILE* ap = fopen(apFilePath(ssid).c_str(), "w");
+  if (ap == nullptr) {
+    return false;
+  }
+  fputs((passphrase != nullptr) ? passphrase : "", ap);
+  fclose(ap);
+  _apSsid = ssid;
+  sim::log("WiFi: SoftAP \"%s\" up at %s", ssid, _nodeIp.toString().c_str());
+  fire(ARDUINO_EVENT_WIFI_AP_START);
+  return true;
+}
+
+bool WiFiClass::softAPdisconnect(bool wifioff) {
+  if (!_apSsid.empty()) {
+    unlink(apFilePath(_apSsid).c_str());
+    _apSsid.clear();
+    fire(ARDUINO_EVENT_WIFI_AP_STOP);
+  }
+  if (wifioff) {
+    mode((wifi_mode_t)(_mode & ~WIFI_MODE_AP));
+  }
+  return true;
+}
+
+IPAddress WiFiClass::softAPIP() {
+  return (_mode & WIFI_MODE_AP) ? _nodeIp : IPAddress();
+}
+
+wifi_event_id_t WiFiClass::onEvent(WiFiEventCb callback, arduino_event_id_t event) {
+  for (size_t i = 0; i < SIM_WIFI_MAX_EVENTS; i++) {
+    if (_handlers[i].callback == nullptr) {
+      _handlers[i].callback = callback;
+      _handlers[i].event = event;
+      return i + 1;
+    }
+  }
+  sim::log("WiFi: no room for another event handler");
+  return 0;
+}
+
+void WiFiClass::removeEvent(wifi_event_id_t id) {
+  if (id > 0 && id <= SIM_WIFI_MAX_EVENTS) {
+    _handlers[id - 1].callback = nullptr;
+  }
+}
+
+void WiFiClass::fire(arduino_event_id_t event) {
+  for (size_t i = 0; i < SIM_WIFI_MAX_EVENTS; i++) {
+    if (_handlers[i].callback != nullptr &&
+        (_handlers[i].event == event || _handlers[i].event == ARDUINO_EVENT_MAX)) {
+      _handlers[i].callback(event);
+    }
+  }
+}
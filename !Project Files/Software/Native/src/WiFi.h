@@ -0,0 +1,208 @@
+/*
+  Filename: WiFi.h
+  Arduino-ESP32 WiFi (native)
+
+  Description: Station, SoftAP and TCP over host loopback. Each node gets its
+               own address in 127.0.0.0/8 (derived from its name), so several
+               receivers can listen on the same port and the transmitter
+               connects to whatever address a receiver reports over LoRa,
+               exactly as on site.
+
+               A station joins ~300 ms after begin(). Any SSID is in range
+               unless WABASH_SIM_WIFI_NETWORKS narrows it, and a SoftAP
+               started by another node is in range (with its password
+               checked) while that node has it up. STA start/stop, connect
+               and got-IP events run registered handlers on the calling
+               task rather than the event task.
+
+  Environment:
+    WABASH_SIM_WIFI_NETWORKS  comma-separated SSIDs in range (default: any)
+*/
+
+#ifndef WIFI_H
+#define WIFI_H
+
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+#include "Print.h"
+#include "Stream.h"
+#include "WString.h"
+
+#define SIM_WIFI_CONNECT_MS  300
+#define SIM_WIFI_TIMEOUT_MS  3000   // WiFiClient connect / write timeout
+#define SIM_WIFI_MAX_EVENTS  8
+
+typedef enum {
+  WL_NO_SHIELD = 255,
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_SCAN_COMPLETED = 2,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum {
+  WIFI_MODE_NULL = 0,
+  WIFI_MODE_STA = 1,
+  WIFI_MODE_AP = 2,
+  WIFI_MODE_APSTA = 3
+} wifi_mode_t;
+
+#define WIFI_OFF    WIFI_MODE_NULL
+#define WIFI_STA    WIFI_MODE_STA
+#define WIFI_AP     WIFI_MODE_AP
+#define WIFI_AP_STA WIFI_MODE_APSTA
+
+typedef enum {
+  ARDUINO_EVENT_WIFI_READY = 0,
+  ARDUINO_EVENT_WIFI_SCAN_DONE,
+  ARDUINO_EVENT_WIFI_STA_START,
+  ARDUINO_EVENT_WIFI_STA_STOP,
+  ARDUINO_EVENT_WIFI_STA_CONNECTED,
+  ARDUINO_EVENT_WIFI_STA_DISCONNECTED,
+  ARDUINO_EVENT_WIFI_STA_AUTHMODE_CHANGE,
+  ARDUINO_EVENT_WIFI_STA_GOT_IP,
+  ARDUINO_EVENT_WIFI_STA_GOT_IP6,
+  ARDUINO_EVENT_WIFI_STA_LOST_IP,
+  ARDUINO_EVENT_WIFI_AP_START,
+  ARDUINO_EVENT_WIFI_AP_STOP,
+  ARDUINO_EVENT_WIFI_AP_STACONNECTED,
+  ARDUINO_EVENT_WIFI_AP_STADISCONNECTED,
+  ARDUINO_EVENT_MAX
+} arduino_event_id_t;
+
+typedef void (*WiFiEventCb)(arduino_event_id_t event);
+typedef size_t wifi_event_id_t;
+
+class IPAddress : public Printable {
+  public:
+    IPAddress() : _address(0) {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+        : _address((uint32_t)a | ((uint32_t)b << 8) | ((uint32_t)c << 16) | ((uint32_t)d << 24)) {}
+    // Network byte order, as lwIP keeps it
+    explicit IPAddress(uint32_t address) : _address(address) {}
+
+    operator uint32_t() const { return _address; }
+    uint8_t operator[](int index) const { return (uint8_t)(_address >> (8 * index)); }
+    bool operator==(const IPAddress& other) const { return _address == other._address; }
+    bool fromString(const char* text);
+
+    String toString() const;
+    size_t printTo(Print& out) const override;
+
+  private:
+    uint32_t _address;
+};
+
+struct SimSocket;
+
+class WiFiClient : public Stream {
+  public:
+    WiFiClient() {}
+    explicit WiFiClient(int fd);
+
+    int connect(IPAddress ip, uint16_t port);
+    int connect(IPAddress ip, uint16_t port, int32_t timeoutMs);
+    int connect(const char* host, uint16_t port);
+    int connect(const char* host, uint16_t port, int32_t timeoutMs);
+    uint8_t connected();
+    void stop();
+    operator bool() { return connected() != 0; }
+
+    using Print::write;
+    size_t write(uint8_t data) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    int available() override;
+    int read() override;
+    int read(uint8_t* buffer, size_t size);
+    int peek() override;
+    // Discards unread input, like the ESP32 core
+    void flush() override;
+
+    int setNoDelay(bool noDelay);
+    int setTimeout(uint32_t seconds);
+    IPAddress remoteIP() const;
+    uint16_t remotePort() const;
+
+  private:
+    std::shared_ptr<SimSocket> _socket;
+};
+
+class WiFiServer {
+  public:
+    explicit WiFiServer(uint16_t port = 80, uint8_t maxClients = 4) : _port(port), _maxClients(maxClients), _fd(-1) {}
+    ~WiFiServer() { end(); }
+
+    void begin(uint16_t port = 0);
+    // Next pending connection, or an unconnected client; never blocks
+    WiFiClient available() { return accept(); }
+    WiFiClient accept();
+    void setNoDelay(bool) {}
+    void end();
+    void close() { end(); }
+    void stop() { end(); }
+    operator bool() const { return _fd >= 0; }
+
+  private:
+    uint16_t _port;
+    uint8_t _maxClients;
+    int _fd;
+};
+
+class WiFiClass {
+  public:
+    WiFiClass();
+
+    wl_status_t begin(const char* ssid, const char* passphrase = nullptr);
+    wl_status_t status();
+    bool disconnect(bool wifioff = false, bool eraseap = false);
+    bool mode(wifi_mode_t mode);
+    wifi_mode_t getMode() const { return _mode; }
+    bool setSleep(bool enabled) { _sleep = enabled; return true; }
+    bool getSleep() const { return _sleep; }
+
+    IPAddress localIP();
+    String SSID();
+    int8_t RSSI();
+    String macAddress();
+
+    bool softAP(const char* ssid, const char* passphrase = nullptr, int channel = 1, int ssidHidden = 0,
+                int maxConnection = 4);
+    bool softAPdisconnect(bool wifioff = false);
+    IPAddress softAPIP();
+
+    wifi_event_id_t onEvent(WiFiEventCb callback, arduino_event_id_t event = ARDUINO_EVENT_MAX);
+    void removeEvent(wifi_event_id_t id);
+
+    // The node's own loopback address
+    IPAddress nodeIP() const { return _nodeIp; }
+
+  private:
+    struct Handler {
+      WiFiEventCb callback;
+      arduino_event_id_t event;
+    };
+
+    wifi_mode_t _mode;
+    bool _sleep;
+    std::string _ssid;
+    bool _joining;
+    bool _connected;
+    bool _ssidInRange;
+    uint64_t _connectAtUs;
+    std::string _apSsid;
+    IPAddress _nodeIp;
+    Handler _handlers[SIM_WIFI_MAX_EVENTS];
+
+    void fire(arduino_event_id_t event);
+    bool inRange(const char* ssid, const char* passphrase) const;
+};
+
+extern WiFiClass WiFi;
+
+#endif
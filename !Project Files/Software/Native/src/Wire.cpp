@@ -0,0 +1,117 @@
+/*
+  Filename: Wire.cpp
+  Arduino I2C Master Implementation (native)
+
+  Description: Buffers a transaction like the ESP32 core, then hands it to
+               the esp32-hal-i2c calls in SimI2C.cpp. Return codes follow
+               the core: 0 ok, 1 too long, 2 NACK, 5 timeout.
+*/
+
+#include "Wire.h"
+
+#include "Arduino.h"
+#include "SimI2C.h"
+#include "esp32-hal-i2c.h"
+
+TwoWire Wire(0);
+TwoWire Wire1(1);
+
+TwoWire::TwoWire(uint8_t busNum)
+    : _busNum(busNum), _clockHz(SIM_I2C_DEFAULT_HZ), _txAddress(0), _txLength(0), _txOverflow(false),
+      _nonStop(false), _rxLength(0), _rxIndex(0) {}
+
+bool TwoWire::begin(int, int, uint32_t frequency) {
+  if (frequency > 0) {
+    setClock(frequency);
+  }
+  return true;
+}
+
+bool TwoWire::setClock(uint32_t frequency) {
+  if (frequency == 0 || frequency > 1000000) {
+    return false;
+  }
+  _clockHz = frequency;
+  return i2cSetClock(_busNum, frequency) == ESP_OK;
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+  _txAddress = address;
+  _txLength = 0;
+  _txOverflow = false;
+  _nonStop = false;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop) {
+  if (_txOverflow) {
+    return 1;
+  }
+  if (!sendStop) {
+    _nonStop = true;
+    return 0;
+  }
+  esp_err_t err = i2cWrite(_busNum, _txAddress, _txBuffer, _txLength, (uint32_t)getTimeout());
+  _txLength = 0;
+  switch (err) {
+    case ESP_OK:          return 0;
+    case ESP_FAIL:        return 2;
+    case ESP_ERR_TIMEOUT: return 5;
+    default:              return 4;
+  }
+}
+
+size_t TwoWire::requestFrom(uint16_t address, size_t size, bool) {
+  _rxIndex = 0;
+  _rxLength = 0;
+  if (size > I2C_BUFFER_LENGTH) {
+    size = I2C_BUFFER_LENGTH;
+  }
+  if (_nonStop && address == _txAddress) {
+    i2cWriteReadNonStop(_busNum, address, _txBuffer, _txLength, _rxBuffer, size, (uint32_t)getTimeout(),
+                        &_rxLength);
+  } else {
+    i2cRead(_busNum, address, _rxBuffer, size, (uint32_t)getTimeout(), &_rxLength);
+  }
+  _nonStop = false;
+  _txLength = 0;
+  return _rxLength;
+}
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t size, uint8_t sendStop) {
+  return (uint8_t)requestFrom((uint16_t)address, (size_t)size, sendStop != 0);
+}
+
+size_t TwoWire::write(uint8_t data) {
+  if (_txLength >= I2C_BUFFER_LENGTH) {
+    _txOverflow = true;
+    return 0;
+  }
+  _txBuffer[_txLength++] = data;
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t* data, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    if (write(data[i]) == 0) {
+      return i;
+    }
+  }
+  return size;
+}
+
+int TwoWire::available() {
+  return (int)(_rxLength - _rxIndex);
+}
+
+int TwoWire::read() {
+  return (_rxIndex < _rxLength) ? _rxBuffer[_rxIndex++] : -1;
+}
+
+int TwoWire::peek() {
+  return (_rxIndex < _rxLength) ? _rxBuffer[_rxIndex] : -1;
+}
+
+void TwoWire::flush() {
+  _rxIndex = 0;
+  _rxLength = 0;
+  _txLength = 0;
+}
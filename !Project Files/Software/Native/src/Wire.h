@@ -0,0 +1,67 @@
+/*
+  Filename: Wire.h
+  Arduino I2C Master (native)
+
+  Description: TwoWire on the simulated bus (SimI2C.h). Each transaction
+               takes as long as it would on the wire at the configured clock
+               (9 bits per byte plus the address), so I2C cost shows up in
+               profiles the way it does on the board. As in the ESP32 core,
+               endTransmission(false) holds the register write back until
+               requestFrom() sends both as one i2cWriteReadNonStop().
+*/
+
+#ifndef TWOWIRE_H
+#define TWOWIRE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Stream.h"
+
+#define I2C_BUFFER_LENGTH   128
+
+class TwoWire : public Stream {
+  public:
+    explicit TwoWire(uint8_t busNum);
+
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0);
+    bool end() { return true; }
+    bool setClock(uint32_t frequency);
+    uint32_t getClock() { return _clockHz; }
+    bool setPins(int, int) { return true; }
+
+    void beginTransmission(uint8_t address);
+    void beginTransmission(int address) { beginTransmission((uint8_t)address); }
+    uint8_t endTransmission(bool sendStop = true);
+
+    size_t requestFrom(uint16_t address, size_t size, bool sendStop = true);
+    uint8_t requestFrom(uint8_t address, uint8_t size, uint8_t sendStop = true);
+    uint8_t requestFrom(int address, int size) { return requestFrom((uint8_t)address, (uint8_t)size); }
+
+    using Print::write;
+    size_t write(uint8_t data) override;
+    size_t write(const uint8_t* data, size_t size) override;
+    int available() override;
+    int read() override;
+    int peek() override;
+    void flush() override;
+
+  private:
+    uint8_t _busNum;
+    uint32_t _clockHz;
+
+    uint8_t _txAddress;
+    uint8_t _txBuffer[I2C_BUFFER_LENGTH];
+    size_t _txLength;
+    bool _txOverflow;
+    bool _nonStop;                  // Register write waiting for requestFrom()
+
+    uint8_t _rxBuffer[I2C_BUFFER_LENGTH];
+    size_t _rxLength;
+    size_t _rxIndex;
+};
+
+extern TwoWire Wire;
+extern TwoWire Wire1;
+
+#endif
@@ -0,0 +1,20 @@
+/*
+  Filename: rtc_io.h
+  ESP-IDF RTC GPIO (native)
+
+  Description: Pull configuration is accepted and ignored; GPIO0-21 are the
+               RTC-capable pins, as on the ESP32-S3.
+*/
+
+#ifndef DRIVER_RTC_IO_H
+#define DRIVER_RTC_IO_H
+
+#include "esp_sleep.h"
+
+inline bool rtc_gpio_is_valid_gpio(gpio_num_t pin) { return pin >= 0 && pin <= 21; }
+inline esp_err_t rtc_gpio_pullup_en(gpio_num_t pin) { return rtc_gpio_is_valid_gpio(pin) ? ESP_OK : ESP_ERR_INVALID_ARG; }
+inline esp_err_t rtc_gpio_pullup_dis(gpio_num_t pin) { return rtc_gpio_is_valid_gpio(pin) ? ESP_OK : ESP_ERR_INVALID_ARG; }
+inline esp_err_t rtc_gpio_pulldown_en(gpio_num_t pin) { return rtc_gpio_is_valid_gpio(pin) ? ESP_OK : ESP_ERR_INVALID_ARG; }
+inline esp_err_t rtc_gpio_pulldown_dis(gpio_num_t pin) { return rtc_gpio_is_valid_gpio(pin) ? ESP_OK : ESP_ERR_INVALID_ARG; }
+
+#endif
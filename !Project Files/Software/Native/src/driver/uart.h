@@ -0,0 +1,21 @@
+/*
+  Filename: uart.h
+  ESP-IDF UART Driver (native)
+
+  Description: Only the light sleep wake threshold; any byte on stdin wakes
+               the simulated UART.
+*/
+
+#ifndef DRIVER_UART_H
+#define DRIVER_UART_H
+
+#include "esp_sleep.h"
+
+typedef int uart_port_t;
+
+#define UART_NUM_0 0
+#define UART_NUM_1 1
+
+esp_err_t uart_set_wakeup_threshold(uart_port_t uartNum, int edges);
+
+#endif
@@ -0,0 +1,36 @@
+/*
+  Filename: esp32-hal-i2c.h
+  Arduino-ESP32 I2C HAL (native)
+
+  Description: The bus calls the core's TwoWire makes, with the same names
+               and C linkage, so a linker --wrap on them (I2CProfiler.h)
+               sees the same transactions here as on the board. Each call
+               is one transaction on the simulated bus (SimI2C.h) and takes
+               its wire time at the bus clock. ESP_FAIL is a NACK, of the
+               address or of a data byte.
+*/
+
+#ifndef ESP32_HAL_I2C_H
+#define ESP32_HAL_I2C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_system.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+esp_err_t i2cSetClock(uint8_t i2c_num, uint32_t frequency);
+esp_err_t i2cWrite(uint8_t i2c_num, uint16_t address, const uint8_t* buff, size_t size, uint32_t timeOutMillis);
+esp_err_t i2cRead(uint8_t i2c_num, uint16_t address, uint8_t* buff, size_t size, uint32_t timeOutMillis,
+                  size_t* readCount);
+esp_err_t i2cWriteReadNonStop(uint8_t i2c_num, uint16_t address, const uint8_t* wbuff, size_t wsize, uint8_t* rbuff,
+                              size_t rsize, uint32_t timeOutMillis, size_t* readCount);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,47 @@
+/*
+  Filename: esp_sleep.h
+  ESP-IDF Sleep Modes (native)
+
+  Description: Light sleep blocks the calling task until the timer or an
+               enabled wake source (a GPIO interrupt such as LoRa DIO1, or a
+               byte on stdin for the UART) fires; other tasks keep running,
+               so the simulator over-counts work done "during" sleep.
+               Deep sleep saves RTC memory, waits for the timer or the EXT0
+               pin and re-executes the program, which then reports the wake
+               cause like a real deep sleep wake.
+*/
+
+#ifndef ESP_SLEEP_H
+#define ESP_SLEEP_H
+
+#include <stdint.h>
+
+#include "esp_system.h"
+
+typedef int gpio_num_t;
+
+typedef enum {
+  ESP_SLEEP_WAKEUP_UNDEFINED,
+  ESP_SLEEP_WAKEUP_ALL,
+  ESP_SLEEP_WAKEUP_EXT0,
+  ESP_SLEEP_WAKEUP_EXT1,
+  ESP_SLEEP_WAKEUP_TIMER,
+  ESP_SLEEP_WAKEUP_TOUCHPAD,
+  ESP_SLEEP_WAKEUP_ULP,
+  ESP_SLEEP_WAKEUP_GPIO,
+  ESP_SLEEP_WAKEUP_UART
+} esp_sleep_wakeup_cause_t;
+
+typedef esp_sleep_wakeup_cause_t esp_sleep_source_t;
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t timeUs);
+esp_err_t esp_sleep_enable_ext0_wakeup(gpio_num_t pin, int level);
+esp_err_t esp_sleep_enable_gpio_wakeup();
+esp_err_t esp_sleep_enable_uart_wakeup(int uartNum);
+esp_err_t esp_sleep_disable_wakeup_source(esp_sleep_source_t source);
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause();
+
+esp_err_t esp_light_sleep_start();
+[[noreturn]] void esp_deep_sleep_start();
+
+#endif
@@ -0,0 +1,17 @@
+/*
+  Filename: esp_timer.h
+  ESP-IDF High-Resolution Timer (native)
+
+  Description: Microseconds since boot. Like the ESP32 timer it keeps
+               counting through light sleep, and restarts from 0 after deep
+               sleep (the program re-executes).
+*/
+
+#ifndef ESP_TIMER_H
+#define ESP_TIMER_H
+
+#include <stdint.h>
+
+int64_t esp_timer_get_time();
+
+#endif
@@ -0,0 +1,73 @@
+/*
+  Filename: FreeRTOS.h
+  FreeRTOS Kernel on POSIX Threads (native)
+
+  Description: Types, tick rate and critical sections of the ESP-IDF
+               FreeRTOS port. One tick is one millisecond (the Arduino-ESP32
+               configuration). Tasks are pthreads, so priorities and core
+               pinning are recorded but not enforced: the host scheduler runs
+               every ready task, on as many cores as it likes.
+
+               portENTER_CRITICAL() takes a recursive mutex instead of
+               disabling interrupts; simulated ISRs (DIO1, INT1) run on
+               simulator threads and contend for it like a second core would.
+*/
+
+#ifndef FREERTOS_H
+#define FREERTOS_H
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t StackType_t;
+
+#define pdFALSE               ((BaseType_t)0)
+#define pdTRUE                ((BaseType_t)1)
+#define pdFAIL                pdFALSE
+#define pdPASS                pdTRUE
+#define errQUEUE_EMPTY        ((BaseType_t)0)
+#define errQUEUE_FULL         ((BaseType_t)0)
+
+#define configTICK_RATE_HZ        1000
+#define configMAX_PRIORITIES      25
+#define configMINIMAL_STACK_SIZE  768
+#define portNUM_PROCESSORS        2
+#define portTICK_PERIOD_MS        ((TickType_t)1000 / configTICK_RATE_HZ)
+#define portMAX_DELAY             ((TickType_t)0xffffffffUL)
+#define pdMS_TO_TICKS(ms)         ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000U))
+#define pdTICKS_TO_MS(ticks)      ((uint32_t)(((uint64_t)(ticks) * 1000U) / configTICK_RATE_HZ))
+#define tskIDLE_PRIORITY          ((UBaseType_t)0)
+#define tskNO_AFFINITY            ((BaseType_t)0x7FFFFFFF)
+
+typedef struct {
+  pthread_mutex_t mutex;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED  { PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP }
+#define portMUX_INITIALIZE(mux)       vPortMuxInitialize(mux)
+
+void vPortMuxInitialize(portMUX_TYPE* mux);
+
+#define portENTER_CRITICAL(mux)       pthread_mutex_lock(&(mux)->mutex)
+#define portEXIT_CRITICAL(mux)        pthread_mutex_unlock(&(mux)->mutex)
+#define portENTER_CRITICAL_ISR(mux)   portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_ISR(mux)    portEXIT_CRITICAL(mux)
+#define portENTER_CRITICAL_SAFE(mux)  portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_SAFE(mux)   portEXIT_CRITICAL(mux)
+#define taskENTER_CRITICAL(mux)       portENTER_CRITICAL(mux)
+#define taskEXIT_CRITICAL(mux)        portEXIT_CRITICAL(mux)
+#define taskENTER_CRITICAL_ISR(mux)   portENTER_CRITICAL(mux)
+#define taskEXIT_CRITICAL_ISR(mux)    portEXIT_CRITICAL(mux)
+
+#define portYIELD()                   sched_yield()
+#define taskYIELD()                   sched_yield()
+#define portYIELD_FROM_ISR(woken)     ((void)(woken))
+
+BaseType_t xPortGetCoreID();
+BaseType_t xPortInIsrContext();
+
+#endif
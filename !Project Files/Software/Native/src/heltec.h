@@ -0,0 +1,81 @@
+/*
+  Filename: heltec.h
+  Heltec ESP32 Dev-Boards (native)
+
+  Description: Heltec.begin() and the SSD1306 drawing calls the receiver
+               makes. Text drawn into a frame is kept as lines and written
+               to <node>/oled.txt on display(), so "watch cat oled.txt"
+               shows the panel. display() also costs the time a full
+               1 KB frame takes on the 400 kHz OLED bus.
+*/
+
+#ifndef HELTEC_H
+#define HELTEC_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "Arduino.h"
+
+#define SIM_OLED_WIDTH   128
+#define SIM_OLED_HEIGHT  64
+#define SIM_OLED_I2C_HZ  400000
+
+enum OLEDDISPLAY_TEXT_ALIGNMENT {
+  TEXT_ALIGN_LEFT = 0,
+  TEXT_ALIGN_RIGHT = 1,
+  TEXT_ALIGN_CENTER = 2,
+  TEXT_ALIGN_CENTER_BOTH = 3
+};
+
+// Font tables only select a line height here
+extern const uint8_t ArialMT_Plain_10[];
+extern const uint8_t ArialMT_Plain_16[];
+extern const uint8_t ArialMT_Plain_24[];
+
+class SSD1306Wire {
+  public:
+    SSD1306Wire() : _inverted(false), _brightness(255), _contrast(255) {}
+
+    bool init() { return true; }
+    void display();
+    void clear() { _lines.clear(); }
+    void displayOn() {}
+    void displayOff() {}
+    void normalDisplay() { _inverted = false; }
+    void invertDisplay() { _inverted = true; }
+    void setBrightness(uint8_t brightness) { _brightness = brightness; }
+    void setContrast(uint8_t contrast, uint8_t precharge = 241, uint8_t comdetect = 64);
+    void flipScreenVertically() {}
+    void setTextAlignment(OLEDDISPLAY_TEXT_ALIGNMENT alignment) { (void)alignment; }
+    void setFont(const uint8_t* font) { (void)font; }
+    void drawString(int16_t x, int16_t y, const char* text);
+    void drawString(int16_t x, int16_t y, const String& text) { drawString(x, y, text.c_str()); }
+
+  private:
+    struct Line {
+      int16_t x;
+      int16_t y;
+      std::string text;
+    };
+
+    std::vector<Line> _lines;
+    bool _inverted;
+    uint8_t _brightness;
+    uint8_t _contrast;
+};
+
+class Heltec_ESP32 {
+  public:
+    Heltec_ESP32() : display(nullptr) {}
+
+    void begin(bool displayEnable = true, bool loraEnable = true, bool serialEnable = true,
+               bool paboost = true, long band = 470E6);
+
+    SSD1306Wire* display;
+};
+
+extern Heltec_ESP32 Heltec;
+
+#endif
@@ -0,0 +1,544 @@
+/*
+  Filename: Diagnostics_Module.cpp
+  Cooperative Diagnostic Modes Module Implementation
+
+  Description: Tare, gain test, strain monitor, bridge test and lab log,
+               each run one short step per loop() pass.
+*/
+
+#include "Diagnostics_Module.h"
+#include "BinLogDrain.h"
+
+const Diagnostics_Module::Mode Diagnostics_Module::kTareMode = {
+  "tare", &Diagnostics_Module::tareStart, &Diagnostics_Module::tareStep, &Diagnostics_Module::tareFinish};
+const Diagnostics_Module::Mode Diagnostics_Module::kGainTestMode = {
+  "gain test", &Diagnostics_Module::gainTestStart, &Diagnostics_Module::gainTestStep, &Diagnostics_Module::gainTestFinish};
+const Diagnostics_Module::Mode Diagnostics_Module::kMonitorMode = {
+  "monitor", &Diagnostics_Module::monitorStart, &Diagnostics_Module::monitorStep, &Diagnostics_Module::monitorFinish};
+const Diagnostics_Module::Mode Diagnostics_Module::kBridgeMode = {
+  "bridge test", &Diagnostics_Module::bridgeStart, &Diagnostics_Module::bridgeStep, &Diagnostics_Module::bridgeFinish};
+const Diagnostics_Module::Mode Diagnostics_Module::kLabMode = {
+  "lab log", &Diagnostics_Module::labStart, &Diagnostics_Module::labStep, &Diagnostics_Module::labFinish};
+
+static inline bool diagDue(unsigned long now, unsigned long at) {
+  return (long)(now - at) >= 0;
+}
+
+Diagnostics_Module::Diagnostics_Module(NAU7802_Module* nau, SDCard_Module* sdCard, Power_Module* power,
+                                       StaticPoolBase* samplePool, StaticPoolBase* linePool)
+  : _nau(nau),
+    _sdCard(sdCard),
+    _power(power),
+    _samplePool(samplePool),
+    _linePool(linePool),
+    _restoreGain(nullptr),
+    _microstrain(nullptr),
+    _timestamp(nullptr),
+    _noteActivity(nullptr),
+    _run{nullptr, 0, 0, 0, 0, 0, false},
+    _tare{0},
+    _gainTest{NAU7802_GAIN_1, 1, 0, 0},
+    _monitor{},
+    _bridge{},
+    _lab{} {}
+
+void Diagnostics_Module::begin(DiagRestoreGainFn restoreGain, DiagMicrostrainFn microstrain, DiagTimeFn timestamp,
+                               DiagActivityFn noteActivity) {
+  _restoreGain = restoreGain;
+  _microstrain = microstrain;
+  _timestamp = timestamp;
+  _noteActivity = noteActivity;
+}
+
+/**
+ * Take a waiting NAU7802 conversion for the running mode
+ * @return false if none is ready yet (warns when the ADC looks stalled)
+ */
+bool Diagnostics_Module::readNau(unsigned long now, int32_t& raw) {
+  if (_nau->readIfReady(raw)) {
+    _run.lastConversionMs = now;
+    return true;
+  }
+  if (now - _run.lastConversionMs > NAU_STALL_WARN_MS) {
+    LOG_WARN("NAU7802: No conversion for %lu ms (press 'r' after stopping to restart)",
+             now - _run.lastConversionMs);
+    _run.lastConversionMs = now;
+  }
+  return false;
+}
+
+/**
+ * Modes that read the ADC share it with the background tare; wait for the tare to finish
+ */
+bool Diagnostics_Module::nauFree() {
+  if (!_nau->isReady()) {
+    Serial.println("NAU7802 not ready");
+    return false;
+  }
+  if (_nau->isTaring()) {
+    Serial.println("NAU7802 busy: tare in progress, try again shortly");
+    return false;
+  }
+  return true;
+}
+
+bool Diagnostics_Module::startMode(const Mode& mode) {
+  if (_run.mode != nullptr) {
+    Serial.printf("'%s' is still running; press any key to stop it first\n", _run.mode->name);
+    return false;
+  }
+  if (!(this->*mode.start)()) {
+    return false;
+  }
+  unsigned long now = millis();
+  _run = {&mode, now, now, 0, 0, 0, false};
+  return true;
+}
+
+bool Diagnostics_Module::startTare(int samples) {
+  _tare.samples = samples;
+  return startMode(kTareMode);
+}
+
+bool Diagnostics_Module::startGainTest(NAU7802_Gain gain) {
+  _gainTest.gain = gain;
+  _gainTest.gainValue = 1 << gain;   // PGA gain register holds log2(gain)
+  return startMode(kGainTestMode);
+}
+
+bool Diagnostics_Module::startMonitor() {
+  return startMode(kMonitorMode);
+}
+
+bool Diagnostics_Module::startBridge() {
+  return startMode(kBridgeMode);
+}
+
+bool Diagnostics_Module::startLabLog(unsigned int rateHz, unsigned int gain) {
+  _lab.rateHz = rateHz;
+  _lab.gain = gain;
+  return startMode(kLabMode);
+}
+
+bool Diagnostics_Module::service() {
+  if (_run.mode == nullptr) {
+    return false;
+  }
+
+  // Enter after the mode key is not a stop request
+  while (Serial.available() > 0) {
+    int c = Serial.read();
+    if (c != '\r' && c != '\n') {
+      _run.stopRequested = true;
+    }
+  }
+
+  unsigned long t0 = micros();
+  bool running = (this->*_run.mode->step)(millis(), _run.stopRequested);
+  uint32_t stepUs = micros() - t0;
+  _run.steps++;
+  _run.busyUs += stepUs;
+  if (stepUs > _run.longestStepUs) {
+    _run.longestStepUs = stepUs;
+  }
+
+  if (!running) {
+    const Mode* mode = _run.mode;
+    _run.mode = nullptr;
+    (this->*mode->finish)(_run.stopRequested);
+    _noteActivity();
+    unsigned long elapsedMs = millis() - _run.startMs;
+    Serial.printf("[DIAG] %s: %.2f s, %lu steps, busy %.1f%%, longest step %lu us\n",
+                  mode->name, elapsedMs / 1000.0, (unsigned long)_run.steps,
+                  elapsedMs > 0 ? _run.busyUs / (elapsedMs * 10.0) : 0.0,
+                  (unsigned long)_run.longestStepUs);
+  }
+  return true;
+}
+
+bool Diagnostics_Module::labLogRunning() const {
+  return _run.mode == &kLabMode;
+}
+
+// --- 'z': tare from the background tare in NAU7802_Module ---
+
+bool Diagnostics_Module::tareStart() {
+  Serial.println("\n=== TARING STRAIN GAUGE ===");
+  Serial.printf("Taking %d samples for tare...\n", _tare.samples);
+  if (!_nau->isReady()) {
+    Serial.println("Failed to zero strain gauge!");
+    Serial.println("===========================\n");
+    return false;
+  }
+  _nau->startBackgroundTare(_tare.samples);
+  return true;
+}
+
+bool Diagnostics_Module::tareStep(unsigned long, bool) {
+  // serviceNau() collects the samples and saves the result; nothing to cancel
+  return _nau->isTaring();
+}
+
+void Diagnostics_Module::tareFinish(bool) {
+  binlogFlush();
+  Serial.println("Strain gauge zeroed successfully!");
+  Serial.println("===========================\n");
+}
+
+// --- '1'-'4': temporary gain test ---
+
+bool Diagnostics_Module::gainTestStart() {
+  if (!nauFree()) {
+    return false;
+  }
+  Serial.printf("\n=== TESTING GAIN %dx ===\n", _gainTest.gainValue);
+  _nau->setGain(_gainTest.gain);
+  _gainTest.sample = 0;
+  _gainTest.nextMs = millis() + 100;
+  Serial.println("Taking 5 samples:");
+  return true;
+}
+
+bool Diagnostics_Module::gainTestStep(unsigned long now, bool stopRequested) {
+  if (stopRequested) {
+    return false;
+  }
+  int32_t raw;
+  if (!diagDue(now, _gainTest.nextMs) || !readNau(now, raw)) {
+    return true;
+  }
+  float percent = (raw / 8388608.0) * 100.0;
+  Serial.printf("  Sample %d: %8ld (%.2f%% FS)", _gainTest.sample + 1, (long)raw, percent);
+  if (raw >= 8388600 || raw <= -8388600) {
+    Serial.print(" ❌ SATURATED!");
+  }
+  Serial.println();
+  _gainTest.nextMs = now + 100;
+  return ++_gainTest.sample < 5;
+}
+
+void Diagnostics_Module::gainTestFinish(bool) {
+  // Restore the configured gain (nau.gain)
+  unsigned int gain = _restoreGain();
+  Serial.printf("\nGain restored to %ux\n", gain);
+  Serial.println("===========================\n");
+}
+
+// --- 'm': continuous strain monitor ---
+
+bool Diagnostics_Module::monitorStart() {
+  if (!nauFree()) {
+    return false;
+  }
+  Serial.println("\n=== CONTINUOUS STRAIN MONITORING ===");
+  Serial.println("[M_SESSION_START]");
+  Serial.println("Monitoring strain in real-time...");
+  Serial.println("Apply load to the strain gauge now!");
+  Serial.println("Press any key to stop.\n");
+  Serial.println("Time(s), SampleMs, Raw, Avg(20), Filtered(20), Zeroed, Strain(με)");
+  Serial.println("---------------------------------------------------------------------------------");
+  _monitor.startMs = millis();
+  _monitor.nextRowMs = _monitor.startMs;
+  _monitor.count = 0;
+  _monitor.rows = 0;
+  return true;
+}
+
+bool Diagnostics_Module::monitorStep(unsigned long now, bool stopRequested) {
+  if (stopRequested) {
+    return false;
+  }
+  int32_t raw;
+  if (!diagDue(now, _monitor.nextRowMs) || !readNau(now, raw)) {
+    return true;
+  }
+
+  if (_monitor.count == 0) {
+    _monitor.rowStartMs = now;
+    _monitor.first = raw;
+    _monitor.sum = 0;
+    _monitor.minVal = raw;
+    _monitor.maxVal = raw;
+  }
+  _monitor.sum += raw;
+  if (raw < _monitor.minVal) _monitor.minVal = raw;
+  if (raw > _monitor.maxVal) _monitor.maxVal = raw;
+  if (++_monitor.count < MONITOR_WINDOW) {
+    return true;
+  }
+
+  // Average and outlier-rejected average (min and max dropped) of one window,
+  // where the blocking version read two separate windows
+  int32_t avg = (int32_t)(_monitor.sum / MONITOR_WINDOW);
+  int32_t filtered = (int32_t)((_monitor.sum - _monitor.minVal - _monitor.maxVal) / (MONITOR_WINDOW - 2));
+  int32_t zeroed = filtered - _nau->getZeroOffset(); // Apply tare offset
+  float microstrain = _microstrain(zeroed);
+  float elapsedTime = (now - _monitor.startMs) / 1000.0;
+  unsigned long sampleMs = now - _monitor.rowStartMs;
+
+  Serial.printf("%.2f, %8lu, %8ld, %8ld, %8ld, %8ld, %9.2f",
+               elapsedTime, sampleMs, (long)_monitor.first, (long)avg, (long)filtered, (long)zeroed, microstrain);
+  // Add visual indicator for high strain
+  if (abs(microstrain) > 50) {
+    Serial.print(" ← STRAIN DETECTED!");
+  }
+  Serial.println();
+
+  _monitor.rows++;
+  _monitor.count = 0;
+  _monitor.nextRowMs = now + MONITOR_ROW_GAP_MS;
+  return true;
+}
+
+void Diagnostics_Module::monitorFinish(bool) {
+  Serial.println("---------------------------------------------------------------------------------");
+  Serial.printf("Monitoring stopped. Collected %d samples.\n", _monitor.rows);
+  Serial.println("[M_SESSION_END]");
+  Serial.println("===========================\n");
+}
+
+// --- 'b': bridge balance and sensitivity test ---
+
+bool Diagnostics_Module::bridgeStart() {
+  if (!nauFree()) {
+    return false;
+  }
+  Serial.println("\n=== BRIDGE BALANCE TEST ===");
+  Serial.println("Testing Wheatstone bridge configuration...\n");
+  Serial.println("Taking 10 raw ADC samples:");
+  _bridge.phase = BRIDGE_SAMPLES;
+  _bridge.index = 0;
+  _bridge.nextMs = millis();
+  _bridge.sum = 0;
+  _bridge.minVal = 2147483647;
+  _bridge.maxVal = -2147483648;
+  return true;
+}
+
+void Diagnostics_Module::printBridgeAnalysis() {
+  int32_t avg = _bridge.sum / 10;
+  int32_t range = _bridge.maxVal - _bridge.minVal;
+  float percentFS = (abs(avg) / 8388608.0) * 100.0;
+
+  Serial.println("\n--- Analysis ---");
+  Serial.printf("Average:    %ld\n", (long)avg);
+  Serial.printf("Min:        %ld\n", (long)_bridge.minVal);
+  Serial.printf("Max:        %ld\n", (long)_bridge.maxVal);
+  Serial.printf("Range:      %ld (noise)\n", (long)range);
+  Serial.printf("%% Full Scale: %.2f%%\n", percentFS);
+
+  Serial.println("\n--- Bridge Status ---");
+  if (abs(avg) < 100000) {
+    Serial.println("✓ Bridge is well balanced!");
+  } else if (abs(avg) < 1000000) {
+    Serial.println("⚠ Bridge has moderate offset (normal)");
+  } else if (abs(avg) < 4000000) {
+    Serial.println("⚠ Bridge has large offset (acceptable)");
+  } else {
+    Serial.println("❌ Bridge severely unbalanced or gain too high!");
+  }
+
+  if (range < 1000) {
+    Serial.println("✓ Low noise - good signal quality");
+  } else if (range < 10000) {
+    Serial.println("⚠ Moderate noise");
+  } else {
+    Serial.println("❌ High noise - check connections!");
+  }
+
+  Serial.println("\n--- Sensitivity Test ---");
+  Serial.println("Now apply a small load and watch for changes...");
+  Serial.println("Monitoring for 5 seconds:");
+}
+
+bool Diagnostics_Module::bridgeStep(unsigned long now, bool stopRequested) {
+  if (stopRequested) {
+    return false;
+  }
+  int32_t raw;
+  if (!diagDue(now, _bridge.nextMs) || !readNau(now, raw)) {
+    return true;
+  }
+
+  switch (_bridge.phase) {
+    case BRIDGE_SAMPLES:
+      Serial.printf("  Sample %d: %8ld\n", _bridge.index + 1, (long)raw);
+      _bridge.sum += raw;
+      if (raw < _bridge.minVal) _bridge.minVal = raw;
+      if (raw > _bridge.maxVal) _bridge.maxVal = raw;
+      _bridge.nextMs = now + 50;
+      if (++_bridge.index == 10) {
+        printBridgeAnalysis();
+        _bridge.phase = BRIDGE_BASELINE;
+        _bridge.index = 0;
+        _bridge.sum = 0;
+        _bridge.nextMs = now;
+      }
+      return true;
+
+    case BRIDGE_BASELINE:
+      // Average of the next 10 conversions, back to back
+      _bridge.sum += raw;
+      if (++_bridge.index == 10) {
+        _bridge.baseline = _bridge.sum / 10;
+        Serial.printf("Baseline (no load): %ld\n\n", (long)_bridge.baseline);
+        _bridge.phase = BRIDGE_WATCH;
+        _bridge.index = 0;
+      }
+      return true;
+
+    case BRIDGE_WATCH:
+    default:
+      {
+        int32_t delta = raw - _bridge.baseline;
+        Serial.printf("  t=%.1fs: %8ld (Δ=%+8ld)", _bridge.index * 0.1, (long)raw, (long)delta);
+        if (abs(delta) > 1000) {
+          Serial.print(" ← CHANGE DETECTED!");
+        }
+        Serial.println();
+        _bridge.nextMs = now + 100;
+        return ++_bridge.index < 50;
+      }
+  }
+}
+
+void Diagnostics_Module::bridgeFinish(bool) {
+  Serial.println("\n===========================\n");
+}
+
+// --- 'l': lab strain log, recorded to the sample pool then written to SD ---
+
+bool Diagnostics_Module::labStart() {
+  if (!nauFree()) {
+    return false;
+  }
+  _lab.samples = (LabSample*)_samplePool->acquire();
+  if (_lab.samples == nullptr) {
+    Serial.println("Sample pool busy, lab test not started");
+    return false;
+  }
+  Serial.println("\n=== LAB TEST: CONTINUOUS STRAIN LOGGING ===");
+  Serial.printf("Sample Rate: %d Hz\n", _lab.rateHz);
+  Serial.println("[LOG_START]");
+  Serial.println("Recording raw strain gauge data...");
+  Serial.println("Apply load now. Press any key to stop.\n");
+  Serial.println("Time(s), Raw, Zeroed, Strain(με)");
+  Serial.println("---------------------------------------");
+
+  _lab.phase = LAB_RECORDING;
+  _lab.text = nullptr;
+  _lab.maxSamples = (int)(_samplePool->blockSize() / sizeof(LabSample));
+  _lab.sampleCount = 0;
+  _lab.saved = 0;
+  _lab.zeroOffset = _nau->getZeroOffset();
+  _lab.startMs = millis();
+  _lab.nextSampleMs = _lab.startMs;
+  _lab.ok = true;
+  _power->perfLockAcquire();   // Released by labFinish()
+  return true;
+}
+
+/**
+ * Finish recording: open the log file and write its header
+ */
+void Diagnostics_Module::labBeginSave(unsigned long now) {
+  _lab.durationMs = now - _lab.startMs;
+  _lab.phase = LAB_SAVING;
+  _power->storageActive(true);   // Released by labFinish()
+  Serial.println("---------------------------------------");
+  Serial.printf("Monitoring stopped. Collected %d samples.\n", _lab.sampleCount);
+  Serial.println("\nSaving to SD card...");
+
+  _lab.logNumber = _sdCard->getNextEventNumber("/lab-testing", "strain-log");
+  snprintf(_lab.filename, sizeof(_lab.filename), "/lab-testing/strain-log%d.txt", _lab.logNumber);
+  _lab.file = _sdCard->openForWrite(_lab.filename, false);
+  _lab.text = (char*)_linePool->acquire();
+  if (!_lab.file || _lab.text == nullptr) {
+    _lab.ok = false;
+    return;
+  }
+
+  char timeText[32];   // "YYYY-MM-DD HH:MM:SS EST"
+  _lab.file.printf("=== STRAIN GAUGE LAB TEST LOG %d ===\n", _lab.logNumber);
+  _lab.file.printf("Timestamp: %s\n", _timestamp(timeText, sizeof(timeText)));
+  _lab.file.printf("Sample Rate: %u Hz\n", _lab.rateHz);
+  _lab.file.printf("Gain: %ux\n", _lab.gain);
+  _lab.file.printf("Samples: %d\n", _lab.sampleCount);
+  _lab.file.printf("Duration: %.2f seconds\n", _lab.durationMs / 1000.0);
+  _lab.file.print("\nTime(s), Raw, Zeroed, Strain(με)\n");
+  _lab.file.print("---------------------------------------\n");
+}
+
+/**
+ * Write one line-pool block of rows
+ * @return false once every row and the footer are written
+ */
+bool Diagnostics_Module::labSaveBlock() {
+  const size_t blockBytes = _linePool->blockSize();
+  size_t used = 0;
+  while (_lab.saved < _lab.sampleCount && used + 64 <= blockBytes) {
+    const LabSample& s = _lab.samples[_lab.saved++];
+    int32_t zeroed = s.raw - _lab.zeroOffset;
+    float microstrain = _microstrain(zeroed);
+    used += snprintf(_lab.text + used, blockBytes - used, "%.2f, %ld, %ld, %.2f\n",
+                     s.ms / 1000.0, (long)s.raw, (long)zeroed, microstrain);
+  }
+  _lab.file.write((const uint8_t*)_lab.text, used);
+  if (_lab.saved < _lab.sampleCount) {
+    return true;
+  }
+  _lab.file.print("---------------------------------------\n");
+  _lab.file.print("[LOG_END]\n");
+  return false;
+}
+
+bool Diagnostics_Module::labStep(unsigned long now, bool stopRequested) {
+  if (_lab.phase == LAB_SAVING) {
+    return _lab.ok && labSaveBlock();
+  }
+
+  if (stopRequested || _lab.sampleCount >= _lab.maxSamples) {
+    labBeginSave(now);
+    return _lab.ok;
+  }
+
+  int32_t raw;
+  if (!diagDue(now, _lab.nextSampleMs) || !readNau(now, raw)) {
+    return true;
+  }
+  int32_t zeroed = raw - _lab.zeroOffset;
+  float microstrain = _microstrain(zeroed);
+  uint32_t elapsedMs = now - _lab.startMs;
+  _lab.samples[_lab.sampleCount].ms = elapsedMs;
+  _lab.samples[_lab.sampleCount].raw = raw;
+  _lab.sampleCount++;
+  Serial.printf("%.2f, %8ld, %8ld, %9.2f\n", elapsedMs / 1000.0, (long)raw, (long)zeroed, microstrain);
+
+  // Delay based on lab.rate_hz
+  _lab.nextSampleMs = now + 1000 / _lab.rateHz;
+  return true;
+}
+
+void Diagnostics_Module::labFinish(bool) {
+  if (_lab.phase == LAB_SAVING) {
+    _power->storageActive(false);
+  }
+  if (_lab.file) {
+    _lab.file.close();
+  }
+  if (_lab.text != nullptr) {
+    _linePool->release(_lab.text);
+    _lab.text = nullptr;
+  }
+  _samplePool->release(_lab.samples);
+  _lab.samples = nullptr;
+
+  if (_lab.ok) {
+    Serial.printf("Data saved to: %s\n", _lab.filename);
+  } else {
+    Serial.printf("Failed to save lab log: %s\n", _lab.filename);
+  }
+  Serial.println("[LOG_END]");
+  Serial.println("===========================\n");
+  _power->perfLockRelease();
+}
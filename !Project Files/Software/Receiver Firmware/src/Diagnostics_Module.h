@@ -0,0 +1,211 @@
+/*
+  Filename: Diagnostics_Module.h
+  Cooperative Diagnostic Modes Module Header
+
+  Description: The long-running serial modes: tare ('z'), temporary gain
+               test ('1'-'4'), strain monitor ('m'), bridge balance test
+               ('b') and lab strain log ('l'). Each mode is a step function
+               called once per loop() pass. A step does one short piece of
+               work (read a waiting conversion, print a row, write one SD
+               block) and returns, so LoRa and acquisition keep running
+               while a mode is active. Any key other than Enter asks the
+               mode to stop.
+
+  Reports:
+    [DIAG] <mode>: <s> s, <n> steps, busy <pct>%, longest step <us> us
+*/
+
+#ifndef DIAGNOSTICS_MODULE_H
+#define DIAGNOSTICS_MODULE_H
+
+#include <Arduino.h>
+#include "NAU7802_Module.h"
+#include "SDCard_Module.h"
+#include "Power_Module.h"
+#include "StaticPool.h"
+
+#define MONITOR_WINDOW           20      // Conversions per 'm' row (average and outlier-filtered)
+#define MONITOR_ROW_GAP_MS       100     // Pause between 'm' rows
+#define NAU_STALL_WARN_MS        1000    // Warn when a mode has seen no conversion for this long
+#define LAB_SAMPLE_BYTES         8       // Per lab log sample held in the sample pool block
+
+typedef unsigned int (*DiagRestoreGainFn)();
+typedef float (*DiagMicrostrainFn)(int32_t zeroed);
+typedef const char* (*DiagTimeFn)(char* buffer, size_t bufferSize);
+typedef void (*DiagActivityFn)();
+
+class Diagnostics_Module {
+  public:
+    /**
+     * @param samplePool Lab log samples (one block for the whole run, shared with event capture)
+     * @param linePool Lab log text while saving
+     */
+    Diagnostics_Module(NAU7802_Module* nau, SDCard_Module* sdCard, Power_Module* power,
+                       StaticPoolBase* samplePool, StaticPoolBase* linePool);
+
+    /**
+     * Attach firmware hooks
+     * @param restoreGain Reprogram nau.gain after a gain test; returns the gain
+     * @param microstrain Calibrated microstrain for zeroed ADC counts
+     * @param timestamp Current time text for the lab log header
+     * @param noteActivity Called when a mode ends (holds off deep sleep)
+     */
+    void begin(DiagRestoreGainFn restoreGain, DiagMicrostrainFn microstrain, DiagTimeFn timestamp,
+               DiagActivityFn noteActivity);
+
+    /**
+     * Start a mode; each prints why when it does not start
+     * @return false if not started (another mode running, ADC busy, pool busy)
+     */
+    bool startTare(int samples);
+    bool startGainTest(NAU7802_Gain gain);
+    bool startMonitor();
+    bool startBridge();
+    bool startLabLog(unsigned int rateHz, unsigned int gain);
+
+    /**
+     * Run one step of the active mode
+     * @return true if a mode is active (it owns serial input this pass)
+     */
+    bool service();
+
+    bool isActive() const { return _run.mode != nullptr; }
+
+    /**
+     * Event capture shares the sample pool block with the lab log
+     */
+    bool labLogRunning() const;
+
+  private:
+    struct Mode {
+      const char* name;
+      bool (Diagnostics_Module::*start)();                                 // false: not started (reason printed)
+      bool (Diagnostics_Module::*step)(unsigned long now, bool stopRequested);  // false: finished
+      void (Diagnostics_Module::*finish)(bool stopped);
+    };
+
+    struct Run {
+      const Mode* mode;
+      unsigned long startMs;
+      unsigned long lastConversionMs;
+      uint32_t steps;
+      uint32_t busyUs;          // Time spent inside step()
+      uint32_t longestStepUs;
+      bool stopRequested;
+    };
+
+    struct TareState {
+      int samples;
+    };
+
+    struct GainTestState {
+      NAU7802_Gain gain;
+      int gainValue;
+      int sample;
+      unsigned long nextMs;
+    };
+
+    struct MonitorState {
+      unsigned long startMs;
+      unsigned long rowStartMs;
+      unsigned long nextRowMs;
+      int32_t first;            // First conversion of the row ("Raw" column)
+      int64_t sum;
+      int32_t minVal;
+      int32_t maxVal;
+      uint8_t count;
+      int rows;
+    };
+
+    enum BridgePhase { BRIDGE_SAMPLES, BRIDGE_BASELINE, BRIDGE_WATCH };
+
+    struct BridgeState {
+      BridgePhase phase;
+      int index;
+      unsigned long nextMs;
+      int64_t sum;
+      int32_t minVal;
+      int32_t maxVal;
+      int32_t baseline;
+    };
+
+    // Only time and raw value are kept; the zero offset cannot change during the run
+    struct LabSample {
+      uint32_t ms;
+      int32_t raw;
+    };
+    static_assert(sizeof(LabSample) == LAB_SAMPLE_BYTES, "sample pool sizing assumes LAB_SAMPLE_BYTES");
+
+    enum LabPhase { LAB_RECORDING, LAB_SAVING };
+
+    struct LabState {
+      LabPhase phase;
+      LabSample* samples;       // Sample pool block, held for the whole run
+      char* text;               // Line pool block while saving
+      int maxSamples;
+      int sampleCount;
+      int saved;
+      int32_t zeroOffset;
+      unsigned int rateHz;
+      unsigned int gain;
+      unsigned long startMs;
+      unsigned long durationMs;
+      unsigned long nextSampleMs;
+      int logNumber;
+      char filename[64];
+      File file;
+      bool ok;
+    };
+
+    static const Mode kTareMode;
+    static const Mode kGainTestMode;
+    static const Mode kMonitorMode;
+    static const Mode kBridgeMode;
+    static const Mode kLabMode;
+
+    NAU7802_Module* _nau;
+    SDCard_Module* _sdCard;
+    Power_Module* _power;
+    StaticPoolBase* _samplePool;
+    StaticPoolBase* _linePool;
+    DiagRestoreGainFn _restoreGain;
+    DiagMicrostrainFn _microstrain;
+    DiagTimeFn _timestamp;
+    DiagActivityFn _noteActivity;
+
+    Run _run;
+    TareState _tare;
+    GainTestState _gainTest;
+    MonitorState _monitor;
+    BridgeState _bridge;
+    LabState _lab;
+
+    bool startMode(const Mode& mode);
+    bool readNau(unsigned long now, int32_t& raw);
+    bool nauFree();
+
+    bool tareStart();
+    bool tareStep(unsigned long, bool);
+    void tareFinish(bool);
+
+    bool gainTestStart();
+    bool gainTestStep(unsigned long now, bool stopRequested);
+    void gainTestFinish(bool);
+
+    bool monitorStart();
+    bool monitorStep(unsigned long now, bool stopRequested);
+    void monitorFinish(bool);
+
+    bool bridgeStart();
+    void printBridgeAnalysis();
+    bool bridgeStep(unsigned long now, bool stopRequested);
+    void bridgeFinish(bool);
+
+    bool labStart();
+    void labBeginSave(unsigned long now);
+    bool labSaveBlock();
+    bool labStep(unsigned long now, bool stopRequested);
+    void labFinish(bool);
+};
+
+#endif
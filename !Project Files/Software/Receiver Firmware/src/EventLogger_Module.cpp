@@ -7,45 +7,65 @@
 
 #include "EventLogger_Module.h"
 
+static StaticPool<EVENT_CSV_ROW_CAPACITY, 1> s_csvRowPool("csv_row");
+
 EventLogger_Module::EventLogger_Module(SDCard_Module* sdCard)
   : _sdCard(sdCard) {}
 
-String EventLogger_Module::buildCsvDataRow(const EventSample* samples,
+size_t EventLogger_Module::buildCsvDataRow(char* out,
+                                           size_t outSize,
+                                           const EventSample* samples,
                                            int sampleCount,
                                            float temp,
                                            float humidity,
-                                           const String& timestamp) const {
-  String eventData;
-  eventData.reserve(256 + (sampleCount * 64));
+                                           const char* timestamp) const {
+  if (outSize == 0) {
+    return 0;
+  }
 
-  String safeTimestamp = timestamp;
-  safeTimestamp.replace("\"", "");
+  // Quotes would break the quoted timestamp column
+  size_t len = 0;
+  out[len++] = '"';
+  for (const char* p = timestamp; *p != '\0' && len < outSize - 1; p++) {
+    if (*p != '"') {
+      out[len++] = *p;
+    }
+  }
 
-  eventData += "\"" + safeTimestamp + "\"";
-  eventData += "," + String(temp, 2);
-  eventData += "," + String(humidity, 2);
+  int n = snprintf(out + len, outSize - len, "\",%.2f,%.2f", temp, humidity);
+  if (n < 0 || (size_t)n >= outSize - len) {
+    return 0;
+  }
+  len += n;
 
-  char sampleValue[64];
   for (int i = 0; i < sampleCount; i++) {
-    snprintf(sampleValue, sizeof(sampleValue), ",%.3f,%.3f,%.3f,%.2f",
-             samples[i].x,
-             samples[i].y,
-             samples[i].z,
-             samples[i].strainMicro);
-    eventData += sampleValue;
+    n = snprintf(out + len, outSize - len, ",%.3f,%.3f,%.3f,%.2f",
+                 samples[i].x,
+                 samples[i].y,
+                 samples[i].z,
+                 samples[i].strainMicro);
+    if (n < 0 || (size_t)n >= outSize - len) {
+      return 0;
+    }
+    len += n;
   }
-  eventData += "\n";
 
-  return eventData;
+  if (len + 1 >= outSize) {
+    return 0;
+  }
+  out[len++] = '\n';
+  out[len] = '\0';
+  return len;
 }
 
 bool EventLogger_Module::saveEventCsv(const EventSample* samples,
                                       int sampleCount,
                                       float temp,
                                       float humidity,
-                                      const String& timestamp,
+                                      const char* timestamp,
                                       int* outEventNumber,
-                                      String* outFilename) const {
+                                      char* outFilename,
+                                      size_t outFilenameSize) const {
   if (_sdCard == nullptr) {
     return false;
   }
@@ -55,15 +75,24 @@ bool EventLogger_Module::saveEventCsv(const EventSample* samples,
   char filename[32];
   snprintf(filename, sizeof(filename), "/events/event %d.csv", eventNumber);
 
-  String eventData = buildCsvDataRow(samples, sampleCount, temp, humidity, timestamp);
-  bool writeOk = _sdCard->writeFile(filename, eventData.c_str(), false);
-
   if (outEventNumber != nullptr) {
     *outEventNumber = eventNumber;
   }
-  if (outFilename != nullptr) {
-    *outFilename = String(filename);
+  if (outFilename != nullptr && outFilenameSize > 0) {
+    snprintf(outFilename, outFilenameSize, "%s", filename);
+  }
+
+  // Pool block so a full-capacity row never lands on the loop task stack or the heap
+  PoolBlock row(s_csvRowPool);
+  if (!row) {
+    Serial.println("CSV row pool busy");
+    return false;
+  }
+  size_t rowLen = buildCsvDataRow(row.chars(), row.size(), samples, sampleCount, temp, humidity, timestamp);
+  if (rowLen == 0) {
+    Serial.println("Event row exceeds EVENT_CSV_ROW_CAPACITY");
+    return false;
   }
 
-  return writeOk;
+  return _sdCard->writeFile(filename, row.chars(), false);
 }
@@ -10,6 +10,8 @@
 
 #include <Arduino.h>
 #include "SDCard_Module.h"
+#include "StaticPool.h"
+#include "OffloadLink.h"   // EVENT_SAMPLE_CAPACITY and the CSV row size, shared with the transmitter
 
 class EventLogger_Module {
   public:
@@ -22,19 +24,26 @@ class EventLogger_Module {
 
     explicit EventLogger_Module(SDCard_Module* sdCard);
 
-    String buildCsvDataRow(const EventSample* samples,
+    /**
+     * Format one event as a CSV data row (no header) into out
+     * @return row length, or 0 if it does not fit
+     */
+    size_t buildCsvDataRow(char* out,
+                           size_t outSize,
+                           const EventSample* samples,
                            int sampleCount,
                            float temp,
                            float humidity,
-                           const String& timestamp) const;
+                           const char* timestamp) const;
 
     bool saveEventCsv(const EventSample* samples,
                       int sampleCount,
                       float temp,
                       float humidity,
-                      const String& timestamp,
+                      const char* timestamp,
                       int* outEventNumber = nullptr,
-                      String* outFilename = nullptr) const;
+                      char* outFilename = nullptr,
+                      size_t outFilenameSize = 0) const;
 
   private:
     SDCard_Module* _sdCard;
@@ -12,18 +12,31 @@
 // LIS3DH Register Addresses
 #define LIS3DH_REG_WHO_AM_I 0x0F
 #define LIS3DH_REG_CTRL_REG1 0x20
+#define LIS3DH_REG_CTRL_REG2 0x21
+#define LIS3DH_REG_CTRL_REG3 0x22
 #define LIS3DH_REG_CTRL_REG4 0x23
+#define LIS3DH_REG_CTRL_REG5 0x24
+#define LIS3DH_REG_REFERENCE 0x26
 #define LIS3DH_REG_OUT_X_L 0x28
 #define LIS3DH_REG_OUT_X_H 0x29
 #define LIS3DH_REG_OUT_Y_L 0x2A
 #define LIS3DH_REG_OUT_Y_H 0x2B
 #define LIS3DH_REG_OUT_Z_L 0x2C
 #define LIS3DH_REG_OUT_Z_H 0x2D
+#define LIS3DH_REG_FIFO_CTRL 0x2E
+#define LIS3DH_REG_FIFO_SRC 0x2F
+#define LIS3DH_REG_INT1_CFG 0x30
+#define LIS3DH_REG_INT1_SRC 0x31
+#define LIS3DH_REG_INT1_THS 0x32
+#define LIS3DH_REG_INT1_DURATION 0x33
+
+#define LIS3DH_FIFO_DEPTH 32
+#define LIS3DH_INT1_THS_LSB_G 0.016     // ±2g scale
 
 #define LIS3DH_WHO_AM_I_VALUE 0x33
 
 LIS3DH_Module::LIS3DH_Module(TwoWire* wire, uint8_t address)
-    : _wire(wire), _address(address), _accelX(0.0), _accelY(0.0), _accelZ(0.0), _initialized(false) {
+    : _wire(wire), _address(address), _accelX(0.0), _accelY(0.0), _accelZ(0.0), _initialized(false), _lowPower(false) {
 }
 
 bool LIS3DH_Module::begin() {
@@ -41,6 +54,14 @@ bool LIS3DH_Module::begin() {
     }
     
     // Configure sensor
+    // Undo any motion-wake setup left from before a deep sleep
+    writeRegister(LIS3DH_REG_INT1_CFG, 0x00);
+    writeRegister(LIS3DH_REG_CTRL_REG3, 0x00);
+    writeRegister(LIS3DH_REG_CTRL_REG5, 0x00);
+    writeRegister(LIS3DH_REG_FIFO_CTRL, 0x00);
+    writeRegister(LIS3DH_REG_CTRL_REG2, 0x00);
+    readRegister(LIS3DH_REG_INT1_SRC);
+    
     // CTRL_REG1: ODR=100Hz, normal mode, enable all axes
     writeRegister(LIS3DH_REG_CTRL_REG1, 0x57);
     
@@ -49,6 +70,7 @@ bool LIS3DH_Module::begin() {
     
     delay(10);
     
+    _lowPower = false;
     _initialized = true;
     Serial.println("LIS3DH: Initialized successfully!");
     return true;
@@ -73,9 +95,16 @@ bool LIS3DH_Module::read() {
     // In high-resolution mode: sensitivity is 1mg/digit (from datasheet)
     // But data is 16-bit left-aligned, so we need to shift right by 4
     // Final sensitivity: approximately 0.001 g per LSB after shifting
-    _accelX = (float)(rawX >> 4) * 0.001;
-    _accelY = (float)(rawY >> 4) * 0.001;
-    _accelZ = (float)(rawZ >> 4) * 0.001;
+    // Low-power mode: 8-bit, 16mg/digit, shift right by 8
+    if (_lowPower) {
+        _accelX = (float)(rawX >> 8) * 0.016;
+        _accelY = (float)(rawY >> 8) * 0.016;
+        _accelZ = (float)(rawZ >> 8) * 0.016;
+    } else {
+        _accelX = (float)(rawX >> 4) * 0.001;
+        _accelY = (float)(rawY >> 4) * 0.001;
+        _accelZ = (float)(rawZ >> 4) * 0.001;
+    }
     
     return true;
 }
@@ -126,3 +155,93 @@ void LIS3DH_Module::readRegisters(uint8_t reg, uint8_t* buffer, uint8_t len) {
         buffer[i] = _wire->read();
     }
 }
+
+bool LIS3DH_Module::setLowPower(bool lowPower) {
+    if (!_initialized) {
+        return false;
+    }
+    if (lowPower == _lowPower) {
+        return true;
+    }
+    
+    // Same 100 Hz ODR either way so the event threshold check sees the same sample rate.
+    // HR must be cleared before LPen is set (datasheet: LPen=1 with HR=1 is not allowed)
+    if (lowPower) {
+        writeRegister(LIS3DH_REG_CTRL_REG4, 0x00);   // ±2g, HR off
+        writeRegister(LIS3DH_REG_CTRL_REG1, 0x5F);   // 100Hz, LPen, all axes
+    } else {
+        writeRegister(LIS3DH_REG_CTRL_REG1, 0x57);   // 100Hz, normal, all axes
+        writeRegister(LIS3DH_REG_CTRL_REG4, 0x08);   // ±2g, HR on
+    }
+    _lowPower = lowPower;
+    return true;
+}
+
+bool LIS3DH_Module::enableMotionWake(float thresholdG, uint8_t durationSamples) {
+    if (!isConnected()) {
+        Serial.println("LIS3DH: Sensor not found, motion wake unavailable!");
+        return false;
+    }
+    
+    int threshold = (int)(thresholdG / LIS3DH_INT1_THS_LSB_G + 0.5);
+    threshold = constrain(threshold, 1, 127);
+    
+    // CTRL_REG1: ODR=50Hz, low-power mode (LPen), enable all axes
+    writeRegister(LIS3DH_REG_CTRL_REG1, 0x4F);
+    // CTRL_REG2: high-pass filter on INT1 only, so gravity does not count as motion
+    writeRegister(LIS3DH_REG_CTRL_REG2, 0x01);
+    // CTRL_REG4: ±2g, high resolution off (required for low-power mode)
+    writeRegister(LIS3DH_REG_CTRL_REG4, 0x00);
+    // CTRL_REG5: FIFO enable, latch INT1 until INT1_SRC is read
+    writeRegister(LIS3DH_REG_CTRL_REG5, 0x48);
+    // FIFO_CTRL: bypass to empty the FIFO, then stream mode (oldest sample dropped when full)
+    writeRegister(LIS3DH_REG_FIFO_CTRL, 0x00);
+    writeRegister(LIS3DH_REG_FIFO_CTRL, 0x80);
+    
+    writeRegister(LIS3DH_REG_INT1_THS, (uint8_t)threshold);
+    writeRegister(LIS3DH_REG_INT1_DURATION, durationSamples & 0x7F);
+    readRegister(LIS3DH_REG_REFERENCE);     // Sets the high-pass filter reference to the current reading
+    // INT1_CFG: OR of X/Y/Z high events
+    writeRegister(LIS3DH_REG_INT1_CFG, 0x2A);
+    // CTRL_REG3: route IA1 to the INT1 pin
+    writeRegister(LIS3DH_REG_CTRL_REG3, 0x40);
+    readRegister(LIS3DH_REG_INT1_SRC);
+    
+    _initialized = false;   // read() needs begin() again
+    return true;
+}
+
+bool LIS3DH_Module::clearMotionInterrupt() {
+    return (readRegister(LIS3DH_REG_INT1_SRC) & 0x40) != 0;   // IA bit
+}
+
+uint8_t LIS3DH_Module::readFifo(float* x, float* y, float* z, uint8_t maxSamples) {
+    uint8_t fifoSrc = readRegister(LIS3DH_REG_FIFO_SRC);
+    uint8_t count = (fifoSrc & 0x1F) + ((fifoSrc & 0x40) ? 1 : 0);   // FSS, +1 when full (OVRN)
+    if (count > LIS3DH_FIFO_DEPTH) {
+        count = LIS3DH_FIFO_DEPTH;
+    }
+    
+    // Output width depends on the mode the samples were taken in
+    uint8_t ctrl1 = readRegister(LIS3DH_REG_CTRL_REG1);
+    uint8_t ctrl4 = readRegister(LIS3DH_REG_CTRL_REG4);
+    uint8_t shift = 6;          // Normal mode: 10-bit, 4 mg/digit
+    float scale = 0.004;
+    if (ctrl1 & 0x08) {
+        shift = 8;              // Low-power mode: 8-bit, 16 mg/digit
+        scale = 0.016;
+    } else if (ctrl4 & 0x08) {
+        shift = 4;              // High resolution: 12-bit, 1 mg/digit
+        scale = 0.001;
+    }
+    
+    uint8_t read = 0;
+    for (; read < count && read < maxSamples; read++) {
+        uint8_t data[6];
+        readRegisters(LIS3DH_REG_OUT_X_L | 0x80, data, 6);
+        x[read] = (float)((int16_t)(data[1] << 8 | data[0]) >> shift) * scale;
+        y[read] = (float)((int16_t)(data[3] << 8 | data[2]) >> shift) * scale;
+        z[read] = (float)((int16_t)(data[5] << 8 | data[4]) >> shift) * scale;
+    }
+    return read;
+}
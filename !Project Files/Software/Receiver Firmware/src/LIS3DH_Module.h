@@ -36,6 +36,21 @@ public:
     // Check if sensor is connected
     bool isConnected();
     
+    // Low-power mode (8-bit, 16 mg/digit) or high resolution (12-bit, 1 mg/digit), both 100 Hz
+    bool setLowPower(bool lowPower);
+    bool isLowPower() { return _lowPower; }
+    
+    // Deep-sleep wake: 50 Hz low-power mode, INT1 latched when any high-pass
+    // filtered axis exceeds thresholdG for durationSamples. The FIFO keeps
+    // streaming, so the last 32 samples (640 ms) survive the MCU wake-up.
+    bool enableMotionWake(float thresholdG, uint8_t durationSamples = 1);
+    
+    // Read (and so clear) the latched INT1 source; true if motion fired
+    bool clearMotionInterrupt();
+    
+    // Drain the FIFO oldest first, in g; works before begin() after a wake
+    uint8_t readFifo(float* x, float* y, float* z, uint8_t maxSamples);
+    
 private:
     TwoWire* _wire;
     uint8_t _address;
@@ -43,6 +58,7 @@ private:
     float _accelY;
     float _accelZ;
     bool _initialized;
+    bool _lowPower;
     
     // Write to register
     void writeRegister(uint8_t reg, uint8_t value);
@@ -10,108 +10,191 @@
 #include "NAU7802_Module.h"
 
 NAU7802_Module::NAU7802_Module(TwoWire* wire, uint8_t address) 
-    : _wire(wire), _address(address), _initialized(false), _zeroOffset(0), _currentGain(NAU7802_GAIN_32) {
+    : _wire(wire), _address(address), _initialized(false), _zeroOffset(0), _currentGain(NAU7802_GAIN_32),
+      _currentRate(NAU7802_SPS_20), _bootState(NAU7802_BOOT_IDLE), _bootStepStart(0),
+      _haveCachedCalibration(false), _calibrationMeasured(false), _calibrationFresh(false),
+      _tareTarget(0), _tareCount(0), _tareSum(0), _tareMin(0), _tareMax(0), _tareFinished(false) {
+    memset(&_calibration, 0, sizeof(_calibration));
 }
 
 bool NAU7802_Module::begin() {
+    if (!beginAsync()) {
+        return false;
+    }
+    while (!service()) {
+        if (hasFailed()) {
+            return false;
+        }
+        delay(1);
+    }
+    return true;
+}
+
+bool NAU7802_Module::beginAsync(NAU7802_Gain gain, NAU7802_SampleRate rate,
+                                const NAU7802_Calibration* cached) {
+    _initialized = false;
+    _currentGain = gain;
+    _currentRate = rate;
+    _calibrationMeasured = false;
+    _calibrationFresh = false;
+    _haveCachedCalibration = (cached != nullptr && cached->gain == gain && cached->rate == rate);
+    if (_haveCachedCalibration) {
+        _calibration = *cached;
+    }
+    
     if (!isConnected()) {
-        Serial.println("NAU7802: Sensor not found!");
+        LOG_ERROR("NAU7802: Sensor not found!");
+        enterBootState(NAU7802_BOOT_FAILED);
         return false;
     }
     
-    Serial.println("NAU7802: Device detected, starting initialization...");
+    LOG_INFO("NAU7802: Device detected, starting initialization...");
     
     // Reset all registers to default values
     bool result = setBit(NAU7802_PU_CTRL, 0); // RR bit
     if (!result) {
-        Serial.println("NAU7802: Reset failed!");
+        LOG_ERROR("NAU7802: Reset failed!");
+        enterBootState(NAU7802_BOOT_FAILED);
         return false;
     }
-    delay(10);
+    delay(1);
     
     // Clear reset bit
     result = clearBit(NAU7802_PU_CTRL, 0);
     if (!result) {
-        Serial.println("NAU7802: Clear reset failed!");
-        return false;
-    }
-    delay(10);
-    
-    // Power up digital and analog circuits
-    result = setBit(NAU7802_PU_CTRL, 1); // PUD bit
-    if (!result) {
-        Serial.println("NAU7802: Power up digital failed!");
+        LOG_ERROR("NAU7802: Clear reset failed!");
+        enterBootState(NAU7802_BOOT_FAILED);
         return false;
     }
     
-    result = setBit(NAU7802_PU_CTRL, 2); // PUA bit
-    if (!result) {
-        Serial.println("NAU7802: Power up analog failed!");
+    // Power up digital and analog circuits; PUR reports when they are ready
+    if (!setBit(NAU7802_PU_CTRL, 1) || !setBit(NAU7802_PU_CTRL, 2)) { // PUD, PUA bits
+        LOG_ERROR("NAU7802: Power up failed!");
+        enterBootState(NAU7802_BOOT_FAILED);
         return false;
     }
     
-    // Wait for power up to complete
-    delay(200);
-    
-    // Verify power up
-    uint8_t puCtrl = readRegister(NAU7802_PU_CTRL);
-    Serial.printf("NAU7802: PU_CTRL = 0x%02X\n", puCtrl);
-    if (!(puCtrl & 0x04)) {
-        Serial.println("NAU7802: Analog power not ready!");
-    }
-    if (!(puCtrl & 0x02)) {
-        Serial.println("NAU7802: Digital power not ready!");
-    }
-    
-    // Enable LDO (3.3V output for strain gauge excitation)
-    Serial.println("NAU7802: Enabling LDO...");
-    uint8_t powerReg = readRegister(NAU7802_POWER_REG);
-    powerReg |= 0x80; // Set PGA_LDOMODE bit (use internal LDO)
-    writeRegister(NAU7802_POWER_REG, powerReg);
-    
-    // Set LDO voltage to 3.3V
-    uint8_t ctrlReg = readRegister(NAU7802_CTRL1);
-    ctrlReg |= 0xC0; // Set VLDO bits to 11 for 3.3V
-    writeRegister(NAU7802_CTRL1, ctrlReg);
-    
-    delay(100); // Allow LDO to stabilize
-    
-    // Set default gain (32x for strain gauges with imbalanced bridge)
-    // Note: 128x causes saturation with 365Ω resistors vs 350Ω gauge
-    if (!setGain(NAU7802_GAIN_32)) {
-        Serial.println("NAU7802: Failed to set gain!");
-        return false;
+    enterBootState(NAU7802_BOOT_POWER_UP);
+    return true;
+}
+
+bool NAU7802_Module::service() {
+    if (_bootState != NAU7802_BOOT_READY) {
+        return serviceBoot();
     }
-    
-    // Set sample rate to 20 SPS for better noise rejection (slower but cleaner)
-    if (!setSampleRate(NAU7802_SPS_20)) {
-        Serial.println("NAU7802: Failed to set sample rate!");
-        return false;
+    if (_tareTarget > 0) {
+        serviceTare();
     }
-    
-    // Calibrate AFE (Analog Front End)
-    if (!calibrateAFE()) {
-        Serial.println("NAU7802: Calibration failed!");
-        return false;
+    return true;
+}
+
+void NAU7802_Module::enterBootState(NAU7802_BootState state) {
+    _bootState = state;
+    _bootStepStart = millis();
+}
+
+bool NAU7802_Module::serviceBoot() {
+    unsigned long elapsed = millis() - _bootStepStart;
+    
+    switch (_bootState) {
+        case NAU7802_BOOT_POWER_UP: {
+            uint8_t puCtrl = readRegister(NAU7802_PU_CTRL);
+            if (!(puCtrl & 0x08)) { // PUR bit
+                if (elapsed > NAU7802_POWER_UP_TIMEOUT_MS) {
+                    LOG_ERROR("NAU7802: Power up not ready (PU_CTRL = 0x%02X)", puCtrl);
+                    enterBootState(NAU7802_BOOT_FAILED);
+                }
+                return false;
+            }
+            LOG_DEBUG("NAU7802: Powered up in %lu ms, enabling LDO...", elapsed);
+            
+            // Enable LDO (3.3V output for strain gauge excitation)
+            uint8_t powerReg = readRegister(NAU7802_POWER_REG);
+            powerReg |= 0x80; // Set PGA_LDOMODE bit (use internal LDO)
+            writeRegister(NAU7802_POWER_REG, powerReg);
+            
+            // Set LDO voltage to 3.3V
+            uint8_t ctrlReg = readRegister(NAU7802_CTRL1);
+            ctrlReg |= 0xC0; // Set VLDO bits to 11 for 3.3V
+            writeRegister(NAU7802_CTRL1, ctrlReg);
+            
+            enterBootState(NAU7802_BOOT_LDO);
+            return false;
+        }
+        
+        case NAU7802_BOOT_LDO:
+            if (elapsed < NAU7802_LDO_SETTLE_MS) {
+                return false;
+            }
+            // Gain/rate first: the calibration is only valid for the settings it ran at
+            if (!writeGainAndRate()) {
+                LOG_ERROR("NAU7802: Failed to set gain/sample rate!");
+                enterBootState(NAU7802_BOOT_FAILED);
+                return false;
+            }
+            if (_haveCachedCalibration && writeCalibrationRegisters(_calibration.regs)) {
+                LOG_INFO("NAU7802: Restored AFE calibration, skipping CALS");
+            } else if (!setBit(NAU7802_CTRL2, 2)) { // CALS bit
+                LOG_ERROR("NAU7802: Calibration failed!");
+                enterBootState(NAU7802_BOOT_FAILED);
+                return false;
+            } else {
+                enterBootState(NAU7802_BOOT_CALIBRATING);
+                return false;
+            }
+            break;
+        
+        case NAU7802_BOOT_CALIBRATING:
+            if (getBit(NAU7802_CTRL2, 2)) { // CALS clears when calibration completes
+                if (elapsed > NAU7802_CAL_TIMEOUT_MS) {
+                    LOG_ERROR("NAU7802: Calibration timed out!");
+                    enterBootState(NAU7802_BOOT_FAILED);
+                }
+                return false;
+            }
+            if (getBit(NAU7802_CTRL2, 3)) { // CAL_ERR bit
+                LOG_ERROR("NAU7802: Calibration error!");
+                enterBootState(NAU7802_BOOT_FAILED);
+                return false;
+            }
+            if (readCalibrationRegisters(_calibration.regs)) {
+                _calibration.gain = (uint8_t)_currentGain;
+                _calibration.rate = (uint8_t)_currentRate;
+                _calibrationMeasured = true;
+                _calibrationFresh = true;
+            }
+            LOG_DEBUG("NAU7802: Calibrated in %lu ms", elapsed);
+            break;
+        
+        case NAU7802_BOOT_FIRST_DATA:
+            if (!isDataReady() && elapsed < NAU7802_FIRST_DATA_TIMEOUT_MS) {
+                return false;
+            }
+            if (elapsed >= NAU7802_FIRST_DATA_TIMEOUT_MS) {
+                LOG_WARN("NAU7802: No conversion yet after CS (PU_CTRL = 0x%02X)",
+                         readRegister(NAU7802_PU_CTRL));
+            }
+            _initialized = true;
+            enterBootState(NAU7802_BOOT_READY);
+            LOG_INFO("NAU7802: Initialized successfully!");
+            return true;
+        
+        case NAU7802_BOOT_READY:
+            return true;
+        
+        default:
+            return false;
     }
     
-    Serial.println("NAU7802: Starting conversions...");
+    // Calibration done or restored: start conversions
+    LOG_DEBUG("NAU7802: Starting conversions...");
     if (!setBit(NAU7802_PU_CTRL, 4)) {
-        Serial.println("NAU7802: Failed to start conversions!");
+        LOG_ERROR("NAU7802: Failed to start conversions!");
+        enterBootState(NAU7802_BOOT_FAILED);
         return false;
     }
-    
-    delay(100); // Allow first conversion to complete
-    
-    // Verify CS bit is set and check for CR bit
-    uint8_t puCtrlAfterCS = readRegister(NAU7802_PU_CTRL);
-    Serial.printf("NAU7802: PU_CTRL after CS = 0x%02X\n", puCtrlAfterCS);
-    Serial.printf("NAU7802: CS bit (4) = %d\n", (puCtrlAfterCS >> 4) & 0x01);
-    Serial.printf("NAU7802: CR bit (5) = %d\n", (puCtrlAfterCS >> 5) & 0x01);
-    
-    _initialized = true;
-    Serial.println("NAU7802: Initialized successfully!");
-    return true;
+    enterBootState(NAU7802_BOOT_FIRST_DATA);
+    return false;
 }
 
 bool NAU7802_Module::isConnected() {
@@ -123,9 +206,17 @@ bool NAU7802_Module::isDataReady() {
     return getBit(NAU7802_PU_CTRL, 5); // Check CR (Conversion Ready) bit
 }
 
+bool NAU7802_Module::readIfReady(int32_t& value) {
+    if (!_initialized || !isDataReady()) {
+        return false;
+    }
+    value = readConversion();
+    return true;
+}
+
 int32_t NAU7802_Module::readRaw() {
     if (!_initialized) {
-        Serial.println("NAU7802: Not initialized!");
+        LOG_ERROR("NAU7802: Not initialized!");
         return 0;
     }
     
@@ -137,40 +228,25 @@ int32_t NAU7802_Module::readRaw() {
     }
     
     if (timeout == 0) {
-        Serial.println("NAU7802: Data timeout!");
-        
         // Diagnostic info
         uint8_t puCtrl = readRegister(NAU7802_PU_CTRL);
-        Serial.printf("  PU_CTRL = 0x%02X", puCtrl);
-        Serial.printf(" (CS=%d, CR=%d, PUA=%d, PUD=%d)\n",
-                     (puCtrl >> 4) & 1, (puCtrl >> 5) & 1, 
-                     (puCtrl >> 2) & 1, (puCtrl >> 1) & 1);
+        LOG_WARN("NAU7802: Data timeout! PU_CTRL = 0x%02X (CS=%d, CR=%d, PUA=%d, PUD=%d)",
+                 puCtrl, (puCtrl >> 4) & 1, (puCtrl >> 5) & 1,
+                 (puCtrl >> 2) & 1, (puCtrl >> 1) & 1);
         
         // Try to restart conversions
-        Serial.println("  Attempting to restart conversions...");
         if (setBit(NAU7802_PU_CTRL, 4)) {
             delay(100);
             if (isDataReady()) {
-                Serial.println("  ✓ Conversions restarted!");
+                LOG_INFO("NAU7802: Conversions restarted");
             } else {
-                Serial.println("  ✗ Still no data ready");
+                LOG_WARN("NAU7802: Restart attempted, still no data ready");
             }
         }
         return 0;
     }
     
-    // Read 3 bytes of ADC data
-    uint8_t b2 = readRegister(NAU7802_ADCO_B2);
-    uint8_t b1 = readRegister(NAU7802_ADCO_B1);
-    uint8_t b0 = readRegister(NAU7802_ADCO_B0);
-    
-    // Combine into 24-bit signed value
-    int32_t value = ((int32_t)b2 << 16) | ((int32_t)b1 << 8) | b0;
-    
-    // Sign extend 24-bit to 32-bit
-    if (value & 0x800000) {
-        value |= 0xFF000000;
-    }
+    int32_t value = readConversion();
     
     // CRITICAL: Wait for CR bit to clear after reading data registers
     // This ensures the next call waits for a NEW conversion, not stale data
@@ -215,19 +291,23 @@ int32_t NAU7802_Module::readMedian(uint8_t samples) {
         readings[i] = readRaw();
     }
     
+    return medianOf(readings, samples);
+}
+
+int32_t NAU7802_Module::medianOf(int32_t values[], uint8_t count) {
     // Simple bubble sort
-    for (uint8_t i = 0; i < samples - 1; i++) {
-        for (uint8_t j = 0; j < samples - i - 1; j++) {
-            if (readings[j] > readings[j + 1]) {
-                int32_t temp = readings[j];
-                readings[j] = readings[j + 1];
-                readings[j + 1] = temp;
+    for (uint8_t i = 0; i + 1 < count; i++) {
+        for (uint8_t j = 0; j < count - i - 1; j++) {
+            if (values[j] > values[j + 1]) {
+                int32_t temp = values[j];
+                values[j] = values[j + 1];
+                values[j + 1] = temp;
             }
         }
     }
     
     // Return median value
-    return readings[samples / 2];
+    return values[count / 2];
 }
 
 int32_t NAU7802_Module::readFiltered(uint8_t samples) {
@@ -270,6 +350,8 @@ bool NAU7802_Module::setGain(NAU7802_Gain gain) {
 }
 
 bool NAU7802_Module::setSampleRate(NAU7802_SampleRate sps) {
+    _currentRate = sps;
+    
     // Clear SPS bits (4-6) and set new rate
     uint8_t value = readRegister(NAU7802_CTRL2);
     value &= 0b10001111; // Clear bits 4-6
@@ -290,7 +372,7 @@ bool NAU7802_Module::calibrateAFE() {
     
     // Check if calibration succeeded
     if (getBit(NAU7802_CTRL2, 3)) { // CAL_ERR bit
-        Serial.println("NAU7802: Calibration error!");
+        LOG_ERROR("NAU7802: Calibration error!");
         return false;
     }
     
@@ -309,19 +391,18 @@ float NAU7802_Module::calculateVoltage(int32_t rawValue, float referenceVoltage)
 
 bool NAU7802_Module::tare(uint8_t samples) {
     if (!_initialized) {
-        Serial.println("NAU7802: Not initialized!");
+        LOG_ERROR("NAU7802: Not initialized!");
         return false;
     }
     
-    Serial.print("NAU7802: Taring with ");
-    Serial.print(samples);
-    Serial.println(" samples (outliers removed)...");
+    // A blocking tare supersedes a background one still collecting
+    _tareTarget = 0;
     
     // Use readFiltered instead of readAverage to reject outlier noise spikes
     _zeroOffset = readFiltered(samples);
     
-    Serial.print("NAU7802: Zero offset set to ");
-    Serial.println(_zeroOffset);
+    LOG_INFO("NAU7802: Zero offset set to %ld (%d samples, outliers removed)",
+             (long)_zeroOffset, samples);
     
     return true;
 }
@@ -344,26 +425,21 @@ float NAU7802_Module::calculateStrain(int32_t rawValue, float gaugeExcitation, f
 }
 
 bool NAU7802_Module::restartConversions() {
-    Serial.println("NAU7802: Checking conversion status...");
-    
     uint8_t puCtrl = readRegister(NAU7802_PU_CTRL);
-    Serial.printf("  PU_CTRL = 0x%02X\n", puCtrl);
     
     bool cs = (puCtrl >> 4) & 1;  // Cycle Start bit
     bool cr = (puCtrl >> 5) & 1;  // Conversion Ready bit
     bool pua = (puCtrl >> 2) & 1; // Power Up Analog
     bool pud = (puCtrl >> 1) & 1; // Power Up Digital
     
-    Serial.printf("  CS (Cycle Start): %d\n", cs);
-    Serial.printf("  CR (Conv Ready):  %d\n", cr);
-    Serial.printf("  PUA (Analog Pwr): %d\n", pua);
-    Serial.printf("  PUD (Digital Pwr): %d\n", pud);
+    LOG_INFO("NAU7802: Conversion status PU_CTRL = 0x%02X (CS=%d, CR=%d, PUA=%d, PUD=%d)",
+             puCtrl, cs, cr, pua, pud);
     
     // If conversions aren't running, restart them
     if (!cs) {
-        Serial.println("  CS bit not set - starting conversions...");
+        LOG_INFO("NAU7802: CS bit not set - starting conversions");
         if (!setBit(NAU7802_PU_CTRL, 4)) {
-            Serial.println("  Failed to set CS bit!");
+            LOG_ERROR("NAU7802: Failed to set CS bit!");
             return false;
         }
         delay(100);
@@ -371,15 +447,106 @@ bool NAU7802_Module::restartConversions() {
     
     // Check if data is ready now
     if (isDataReady()) {
-        Serial.println("  ✓ Data ready!");
+        LOG_INFO("NAU7802: Data ready");
         return true;
     } else {
-        Serial.println("  ✗ Still no data ready");
+        LOG_WARN("NAU7802: Still no data ready");
+        return false;
+    }
+}
+
+bool NAU7802_Module::powerDown() {
+    _initialized = false;
+    _tareTarget = 0;
+    _bootState = NAU7802_BOOT_IDLE;
+    
+    // Stop conversions, then analog before digital
+    if (!clearBit(NAU7802_PU_CTRL, 4) || !clearBit(NAU7802_PU_CTRL, 2) || !clearBit(NAU7802_PU_CTRL, 1)) {
+        LOG_ERROR("NAU7802: Failed to power down!");
         return false;
     }
+    return true;
+}
+
+void NAU7802_Module::startBackgroundTare(uint8_t samples) {
+    if (samples < 3) samples = 3;
+    _tareCount = 0;
+    _tareSum = 0;
+    _tareMin = INT32_MAX;
+    _tareMax = INT32_MIN;
+    _tareFinished = false;
+    _tareTarget = samples;
+}
+
+void NAU7802_Module::serviceTare() {
+    // Only take a conversion that is already waiting; never wait for one
+    if (!isDataReady()) {
+        return;
+    }
+    int32_t value = readConversion();
+    _tareSum += value;
+    if (value < _tareMin) _tareMin = value;
+    if (value > _tareMax) _tareMax = value;
+    _tareCount++;
+    
+    if (_tareCount >= _tareTarget) {
+        // Same outlier rejection as readFiltered(): drop min and max, average the rest
+        _zeroOffset = (int32_t)((_tareSum - _tareMin - _tareMax) / (_tareCount - 2));
+        LOG_INFO("NAU7802: Background tare done, zero offset %ld (%d samples)",
+                 (long)_zeroOffset, _tareCount);
+        _tareTarget = 0;
+        _tareFinished = true;
+    }
 }
 
 // Private helper methods
+int32_t NAU7802_Module::readConversion() {
+    // Read 3 bytes of ADC data
+    uint8_t b2 = readRegister(NAU7802_ADCO_B2);
+    uint8_t b1 = readRegister(NAU7802_ADCO_B1);
+    uint8_t b0 = readRegister(NAU7802_ADCO_B0);
+    
+    // Combine into 24-bit signed value
+    int32_t value = ((int32_t)b2 << 16) | ((int32_t)b1 << 8) | b0;
+    
+    // Sign extend 24-bit to 32-bit
+    if (value & 0x800000) {
+        value |= 0xFF000000;
+    }
+    return value;
+}
+
+bool NAU7802_Module::writeGainAndRate() {
+    // Same register updates as setGain()/setSampleRate(), without the settle delay
+    uint8_t ctrl1 = readRegister(NAU7802_CTRL1);
+    ctrl1 = (ctrl1 & 0b11111000) | (_currentGain & 0x07);
+    uint8_t ctrl2 = readRegister(NAU7802_CTRL2);
+    ctrl2 = (ctrl2 & 0b10001111) | (_currentRate << 4);
+    return writeRegister(NAU7802_CTRL1, ctrl1) && writeRegister(NAU7802_CTRL2, ctrl2);
+}
+
+bool NAU7802_Module::readCalibrationRegisters(uint8_t* out) {
+    _wire->beginTransmission(_address);
+    _wire->write(NAU7802_OCAL1_B2);
+    if (_wire->endTransmission(false) != 0) {
+        return false;
+    }
+    if (_wire->requestFrom(_address, (uint8_t)NAU7802_CAL_BYTES) != NAU7802_CAL_BYTES) {
+        return false;
+    }
+    for (uint8_t i = 0; i < NAU7802_CAL_BYTES; i++) {
+        out[i] = _wire->read();
+    }
+    return true;
+}
+
+bool NAU7802_Module::writeCalibrationRegisters(const uint8_t* regs) {
+    _wire->beginTransmission(_address);
+    _wire->write(NAU7802_OCAL1_B2);
+    _wire->write(regs, NAU7802_CAL_BYTES);
+    return (_wire->endTransmission() == 0);
+}
+
 bool NAU7802_Module::writeRegister(uint8_t reg, uint8_t value) {
     _wire->beginTransmission(_address);
     _wire->write(reg);
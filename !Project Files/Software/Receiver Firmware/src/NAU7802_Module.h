@@ -12,11 +12,13 @@
 
 #include <Arduino.h>
 #include <Wire.h>
+#include "BinLog.h"
 
 // NAU7802 Register Addresses
 #define NAU7802_PU_CTRL         0x00
 #define NAU7802_CTRL1           0x01
 #define NAU7802_CTRL2           0x02
+#define NAU7802_OCAL1_B2        0x03    // OCAL1 (3 bytes) then GCAL1 (4 bytes), 0x03-0x09
 #define NAU7802_ADCO_B2         0x12
 #define NAU7802_ADCO_B1         0x13
 #define NAU7802_ADCO_B0         0x14
@@ -24,6 +26,14 @@
 #define NAU7802_PGA_REG         0x1B
 #define NAU7802_POWER_REG       0x1C
 
+#define NAU7802_CAL_BYTES       7       // OCAL1 + GCAL1
+
+// Boot state machine timeouts (ms)
+#define NAU7802_POWER_UP_TIMEOUT_MS   200
+#define NAU7802_LDO_SETTLE_MS         100
+#define NAU7802_CAL_TIMEOUT_MS        1000
+#define NAU7802_FIRST_DATA_TIMEOUT_MS 500
+
 // NAU7802 Gain Settings
 enum NAU7802_Gain {
     NAU7802_GAIN_1   = 0,
@@ -45,14 +55,57 @@ enum NAU7802_SampleRate {
     NAU7802_SPS_320 = 7
 };
 
+// AFE calibration registers captured after an internal calibration.
+// Restoring them at boot skips the ~500 ms calibration; they are only
+// reused when the gain and rate match what they were measured at.
+struct NAU7802_Calibration {
+    uint8_t regs[NAU7802_CAL_BYTES];
+    uint8_t gain;   // NAU7802_Gain
+    uint8_t rate;   // NAU7802_SampleRate
+};
+
+enum NAU7802_BootState {
+    NAU7802_BOOT_IDLE,
+    NAU7802_BOOT_POWER_UP,      // Waiting for PUR
+    NAU7802_BOOT_LDO,           // Waiting for the excitation LDO to settle
+    NAU7802_BOOT_CALIBRATING,   // Waiting for CALS to clear
+    NAU7802_BOOT_FIRST_DATA,    // Conversions started, waiting for CR
+    NAU7802_BOOT_READY,
+    NAU7802_BOOT_FAILED
+};
+
 class NAU7802_Module {
 public:
     // Constructor
     NAU7802_Module(TwoWire* wire = &Wire, uint8_t address = 0x2A);
     
-    // Initialize the sensor
+    // Initialize the sensor (blocking; same steps as beginAsync() + service())
     bool begin();
     
+    // Start a non-blocking bring-up; call service() until isReady() or hasFailed().
+    // cached skips the internal calibration when it matches gain and rate.
+    bool beginAsync(NAU7802_Gain gain = NAU7802_GAIN_32,
+                    NAU7802_SampleRate rate = NAU7802_SPS_20,
+                    const NAU7802_Calibration* cached = nullptr);
+    
+    // Advance bring-up and background tare; never blocks. Returns true once ready.
+    bool service();
+    
+    bool isReady() { return _initialized; }
+    bool hasFailed() { return _bootState == NAU7802_BOOT_FAILED; }
+    bool isPoweredDown() { return _bootState == NAU7802_BOOT_IDLE; }
+    
+    // Calibration in use, and whether it came from a fresh calibration this boot
+    const NAU7802_Calibration& getCalibration() { return _calibration; }
+    bool calibrationMeasured() { return _calibrationMeasured; }
+    
+    // True once after each power-up that ran CALS (no matching cached calibration)
+    bool takeNewCalibration() {
+        bool fresh = _calibrationFresh;
+        _calibrationFresh = false;
+        return fresh;
+    }
+    
     // Check if sensor is connected
     bool isConnected();
     
@@ -62,12 +115,18 @@ public:
     // Read raw 24-bit ADC value (signed)
     int32_t readRaw();
     
+    // Read a conversion only if one is waiting; never blocks
+    bool readIfReady(int32_t& value);
+    
     // Read average of multiple samples
     int32_t readAverage(uint8_t samples = 10);
     
     // Read with median filter (removes outliers)
     int32_t readMedian(uint8_t samples = 5);
     
+    // Sort values in place and return the middle one (readMedian()'s sort)
+    static int32_t medianOf(int32_t values[], uint8_t count);
+    
     // Read with moving average filter
     int32_t readFiltered(uint8_t samples = 10);
     
@@ -92,18 +151,60 @@ public:
     // Get the current zero offset value
     int32_t getZeroOffset() { return _zeroOffset; }
     
+    // Use a stored zero offset (e.g. from NVS) until a tare replaces it
+    void setZeroOffset(int32_t offset) { _zeroOffset = offset; }
+    
+    // Tare from samples collected in service() as conversions complete
+    void startBackgroundTare(uint8_t samples);
+    bool isTaring() { return _tareTarget > 0; }
+    
+    // True once after a background tare finishes
+    bool takeTareResult() {
+        bool done = _tareFinished;
+        _tareFinished = false;
+        return done;
+    }
+    
     // Convert raw value to strain (requires calibration)
     float calculateStrain(int32_t rawValue, float gaugeExcitation, float gaugeFactor = 2.0);
     
     // Check and restart conversions if needed
     bool restartConversions();
     
+    // Power down the analog and digital sections (about 1 uA); beginAsync() powers up again
+    bool powerDown();
+    
 private:
     TwoWire* _wire;
     uint8_t _address;
     bool _initialized;
     int32_t _zeroOffset;
     NAU7802_Gain _currentGain;
+    NAU7802_SampleRate _currentRate;
+    
+    // Bring-up state
+    NAU7802_BootState _bootState;
+    unsigned long _bootStepStart;
+    NAU7802_Calibration _calibration;
+    bool _haveCachedCalibration;
+    bool _calibrationMeasured;
+    bool _calibrationFresh;
+    
+    // Background tare accumulators
+    uint8_t _tareTarget;
+    uint8_t _tareCount;
+    int64_t _tareSum;
+    int32_t _tareMin;
+    int32_t _tareMax;
+    bool _tareFinished;
+    
+    void enterBootState(NAU7802_BootState state);
+    bool serviceBoot();
+    void serviceTare();
+    int32_t readConversion();
+    bool writeGainAndRate();
+    bool readCalibrationRegisters(uint8_t* out);
+    bool writeCalibrationRegisters(const uint8_t* regs);
     
     // Register read/write helpers
     bool writeRegister(uint8_t reg, uint8_t value);
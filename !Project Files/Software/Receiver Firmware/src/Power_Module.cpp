@@ -0,0 +1,561 @@
+/*
+  Filename: Power_Module.cpp
+  Power Module Implementation
+
+  Description: Sensor power policy, CPU clock scaling with light sleep, and
+               the energy ledger.
+*/
+
+#include "Power_Module.h"
+#include <sys/time.h>
+#include <esp_sleep.h>
+#include <esp_timer.h>
+#include <driver/gpio.h>
+#include <driver/uart.h>
+#include "BinLogDrain.h"
+
+static const char* const kEnergyRailNames[ENERGY_RAIL_COUNT] = {"cpu", "lora", "wifi", "sd", "strain", "accel", "board", "deep sleep"};
+
+static const uint32_t kCpuStateMhz[] = {240, 160, 80, 40};
+static const float kCpuCurrentMa[CPU_STATE_COUNT] = {ENERGY_CPU_240_MA, ENERGY_CPU_160_MA, ENERGY_CPU_80_MA,
+                                                     ENERGY_CPU_40_MA, ENERGY_CPU_SLEEP_MA};
+static const float kLoRaCurrentMa[] = {ENERGY_LORA_RX_MA, 0.0f};   // TX follows lora.power_dbm
+static const float kWifiCurrentMa[] = {0.0f, ENERGY_WIFI_ON_MA};
+static const float kSdCurrentMa[] = {ENERGY_SD_IDLE_MA, ENERGY_SD_ACTIVE_MA};
+static const float kStrainCurrentMa[] = {ENERGY_STRAIN_OFF_MA, ENERGY_STRAIN_ON_MA};
+static const float kAccelCurrentMa[] = {ENERGY_ACCEL_LP_MA, ENERGY_ACCEL_HR_MA};
+static const float kBoardCurrentMa[] = {ENERGY_BOARD_MA};
+
+// SX1262 supply current while transmitting (datasheet, 22 dBm PA configuration as set by RadioLib)
+static const struct {
+  int dbm;
+  float ma;
+} kLoRaTxCurrent[] = {{-9, 18.0f}, {0, 24.0f}, {10, 34.0f}, {14, 45.0f}, {17, 58.0f}, {20, 84.0f}, {22, 118.0f}};
+
+static float loraTxCurrentMa(int dbm) {
+  const size_t last = sizeof(kLoRaTxCurrent) / sizeof(kLoRaTxCurrent[0]) - 1;
+  if (dbm <= kLoRaTxCurrent[0].dbm) {
+    return kLoRaTxCurrent[0].ma;
+  }
+  for (size_t i = 1; i <= last; i++) {
+    if (dbm <= kLoRaTxCurrent[i].dbm) {
+      float span = (float)(dbm - kLoRaTxCurrent[i - 1].dbm) / (kLoRaTxCurrent[i].dbm - kLoRaTxCurrent[i - 1].dbm);
+      return kLoRaTxCurrent[i - 1].ma + span * (kLoRaTxCurrent[i].ma - kLoRaTxCurrent[i - 1].ma);
+    }
+  }
+  return kLoRaTxCurrent[last].ma;
+}
+
+static int64_t wallClockUs() {
+  struct timeval now;
+  gettimeofday(&now, nullptr);
+  return (int64_t)now.tv_sec * 1000000LL + now.tv_usec;
+}
+
+Power_Module::Power_Module(NAU7802_Module* nau, LIS3DH_Module* lis3dh)
+  : settings{true, POWER_IDLE_SEC_DEFAULT, POWER_STRAIN_PERIOD_SEC_DEFAULT, POWER_STRAIN_BURST_DEFAULT,
+             POWER_SHT_ACTIVE_SEC_DEFAULT, POWER_SHT_IDLE_SEC_DEFAULT, CPU_IDLE_MHZ_DEFAULT, false, false,
+             ENERGY_BATTERY_MAH_DEFAULT},
+    report{POWER_ACTIVE, 0, 0, 0, 0, CPU_MAX_MHZ, {0}, 0, 0, 0, 0},
+    _nau(nau),
+    _lis3dh(lis3dh),
+    _hooks{},
+    _retained(nullptr),
+    _wakePin(-1),
+    _policy(PowerPolicyConfig{}),
+    _seenActivityMs(0),
+    _lastReportMs(0),
+    _nauSettleLeft(0),
+    _burstTaken(0),
+    _burstSum(0),
+    _clockMutex(nullptr),
+    _perfLocks(0),
+    _cpuMeter(kCpuCurrentMa),
+    _loraMeter(kLoRaCurrentMa),
+    _wifiMeter(kWifiCurrentMa),
+    _sdMeter(kSdCurrentMa),
+    _strainMeter(kStrainCurrentMa),
+    _accelMeter(kAccelCurrentMa),
+    _boardMeter(kBoardCurrentMa),
+    _energyStartUs(0),
+    _sdUsers(0) {}
+
+void Power_Module::begin(const PowerHooks& hooks, EnergyRetained* retained, bool wokeFromSleep, int wakePin) {
+  _hooks = hooks;
+  _retained = retained;
+  _wakePin = wakePin;
+
+  // Boot runs at the full clock; loop() drops to cpu.idle_mhz between samples
+  _clockMutex = xSemaphoreCreateMutex();
+  _cpuMeter.reset(cpuStateForMhz(getCpuFrequencyMhz()), esp_timer_get_time());
+  energyResetMeters();
+  if (wokeFromSleep) {
+    accrueDeepSleepEnergy();
+  }
+}
+
+PowerPolicyConfig Power_Module::policyConfig() const {
+  // Parameter ranges keep each period under 2^32 ms
+  return {(uint32_t)settings.idleSec * 1000u, (uint32_t)settings.strainPeriodSec * 1000u,
+          (uint32_t)settings.shtActiveSec * 1000u, (uint32_t)settings.shtIdleSec * 1000u};
+}
+
+void Power_Module::applySettings() {
+  _policy.config() = policyConfig();
+}
+
+// ===== SENSOR POWER POLICY =====
+// PowerPolicy turns activity (events, commands, diagnostic modes, tares)
+// into a per-sensor schedule; this section applies it to the hardware.
+
+void Power_Module::nauPowerUp() {
+  // Cached calibration: no CALS, so power-up is PUR + LDO settle + first conversion
+  _hooks.startStrain();
+  _nauSettleLeft = NAU_SETTLE_CONVERSIONS;
+  strainPoweredUp();
+}
+
+void Power_Module::nauPowerDown() {
+  _nau->powerDown();
+  _nauDuty.set(false, millis());
+  energyEnter(ENERGY_STRAIN, ENERGY_LOW);
+}
+
+void Power_Module::strainPoweredUp() {
+  _nauDuty.set(true, millis());
+  energyEnter(ENERGY_STRAIN, ENERGY_HIGH);
+}
+
+void Power_Module::accelPoweredUp() {
+  _accelHrDuty.set(true, millis());
+  energyEnter(ENERGY_ACCEL, ENERGY_HIGH);
+}
+
+void Power_Module::setAccelLowPower(bool lowPower) {
+  if (_lis3dh->isLowPower() != lowPower && _lis3dh->setLowPower(lowPower)) {
+    _accelHrDuty.set(!lowPower, millis());
+    energyEnter(ENERGY_ACCEL, lowPower ? ENERGY_LOW : ENERGY_HIGH);
+  }
+}
+
+bool Power_Module::wakeSensors(unsigned long maxWaitMs) {
+  setAccelLowPower(false);
+  if (_nau->isPoweredDown()) {
+    nauPowerUp();
+  }
+
+  unsigned long start = millis();
+  while (!_nau->isReady() && !_nau->hasFailed() && millis() - start < maxWaitMs) {
+    _hooks.serviceStrain();
+    delay(1);
+  }
+  while (_nauSettleLeft > 0 && _nau->isReady() && millis() - start < maxWaitMs) {
+    int32_t raw;
+    if (_nau->readIfReady(raw)) {
+      _nauSettleLeft--;
+    } else {
+      delay(1);
+    }
+  }
+  return _nau->isReady();
+}
+
+bool Power_Module::shtDue(unsigned long now) {
+  return !settings.enabled || _policy.shtDue(now);
+}
+
+void Power_Module::addShtBusy(uint32_t busyMs) {
+  _shtDuty.addBusy(busyMs);
+}
+
+/**
+ * Idle strain burst: skip the settling conversions, average the rest, power down
+ */
+void Power_Module::serviceStrainBurst(unsigned long now) {
+  int32_t raw;
+  if (!_nau->readIfReady(raw)) {
+    return;
+  }
+  if (_nauSettleLeft > 0) {
+    _nauSettleLeft--;
+    return;
+  }
+  _burstSum += raw;
+  _burstTaken++;
+  if (_burstTaken < settings.strainBurst) {
+    return;
+  }
+
+  int32_t average = (int32_t)(_burstSum / (int64_t)_burstTaken);
+  report.strainIdleUe = _hooks.microstrain(average - _nau->getZeroOffset());
+  LOG_DEBUG("Power: idle strain burst %.1f ue (%lu conversions)", report.strainIdleUe, (unsigned long)_burstTaken);
+  _burstSum = 0;
+  _burstTaken = 0;
+  _policy.strainBurstDone(now);
+}
+
+void Power_Module::service(unsigned long lastActivityMs) {
+  unsigned long now = millis();
+  if (lastActivityMs != _seenActivityMs) {
+    _seenActivityMs = lastActivityMs;
+    _policy.noteActivity(lastActivityMs);
+  }
+
+  PowerState previous = _policy.state();
+  PowerState state = settings.enabled ? _policy.update(now) : POWER_ACTIVE;
+  if (state != previous) {
+    LOG_INFO("Power: %s (strain %.1f%%, accel HR %.1f%%, SHT45 %.2f%%)",
+             state == POWER_IDLE ? "idle" : "active", _nauDuty.dutyPercent(now),
+             _accelHrDuty.dutyPercent(now), _shtDuty.dutyPercent(now));
+  }
+
+  if (!settings.enabled) {
+    setAccelLowPower(false);
+    if (_nau->isPoweredDown()) {
+      nauPowerUp();
+    }
+  } else {
+    setAccelLowPower(_policy.accelLowPower());
+    bool wantStrain = _policy.strainWanted(now);
+    if (wantStrain && _nau->isPoweredDown()) {
+      nauPowerUp();
+    } else if (!wantStrain && _nau->isReady() && !_nau->isTaring()) {
+      nauPowerDown();
+    }
+    if (_policy.burstActive()) {
+      if (_nau->isReady()) {
+        serviceStrainBurst(now);
+      } else if (_nau->hasFailed()) {
+        _policy.strainBurstDone(now);
+      }
+    }
+  }
+
+  if (now - _lastReportMs >= POWER_REPORT_MS) {
+    _lastReportMs = now;
+    report.state = state;
+    report.strainPct = _nauDuty.dutyPercent(now);
+    report.accelHrPct = _accelHrDuty.dutyPercent(now);
+    report.shtPct = _shtDuty.dutyPercent(now);
+    if (_clockMutex != nullptr) {
+      updateCpuReport();
+    }
+    updateEnergyReport();
+  }
+}
+
+// ===== CPU CLOCK AND LIGHT SLEEP =====
+// Capture, offload and the lab log hold a PerfLock and run at CPU_MAX_MHZ.
+// With no lock held loop() drops to cpu.idle_mhz and, if cpu.light_sleep is
+// set, light-sleeps until the next acquisition deadline. The Arduino core is
+// built without CONFIG_PM_ENABLE, so this does by hand what esp_pm locks and
+// tickless idle would: only loop() changes the clock down or sleeps.
+
+/**
+ * Ledger index for a clock frequency
+ * @return CPU_STATE_COUNT if the frequency is not one of the supported steps
+ */
+size_t Power_Module::cpuStateForMhz(uint32_t mhz) {
+  for (size_t i = 0; i < sizeof(kCpuStateMhz) / sizeof(kCpuStateMhz[0]); i++) {
+    if (kCpuStateMhz[i] == mhz) {
+      return i;
+    }
+  }
+  return CPU_STATE_COUNT;
+}
+
+// Caller holds _clockMutex
+void Power_Module::setCpuClockLocked(uint32_t mhz) {
+  size_t state = cpuStateForMhz(mhz);
+  if (state == CPU_STATE_COUNT || getCpuFrequencyMhz() == mhz) {
+    return;
+  }
+  if (setCpuFrequencyMhz(mhz)) {
+    meterEnter(_cpuMeter, state);
+  }
+}
+
+void Power_Module::perfLockAcquire() {
+  if (_clockMutex == nullptr) {
+    return;   // Before setup(): still at the boot clock
+  }
+  xSemaphoreTake(_clockMutex, portMAX_DELAY);
+  if (_perfLocks++ == 0) {
+    setCpuClockLocked(CPU_MAX_MHZ);
+  }
+  xSemaphoreGive(_clockMutex);
+}
+
+void Power_Module::perfLockRelease() {
+  if (_clockMutex == nullptr) {
+    return;
+  }
+  xSemaphoreTake(_clockMutex, portMAX_DELAY);
+  if (_perfLocks > 0) {
+    _perfLocks--;
+  }
+  xSemaphoreGive(_clockMutex);
+}
+
+/**
+ * Can loop() light-sleep? Anything in flight (a command, a tare, a mode,
+ * serial input, a radio transmission) keeps the unit awake.
+ */
+bool Power_Module::lightSleepAllowed() {
+  if (!settings.lightSleep || _perfLocks > 0 || _hooks.keepAwake()) {
+    return false;
+  }
+  return !_nau->isTaring() && (_nau->isReady() || _nau->isPoweredDown() || _nau->hasFailed());
+}
+
+/**
+ * Light sleep for up to sleepMs. The wake pin (a LoRa command packet) and,
+ * with cpu.uart_wake, serial input end it early.
+ */
+void Power_Module::lightSleep(unsigned long sleepMs) {
+  binlogFlush();
+  Serial.flush();
+
+  esp_sleep_enable_timer_wakeup((uint64_t)sleepMs * 1000ULL);
+  gpio_wakeup_enable((gpio_num_t)_wakePin, GPIO_INTR_HIGH_LEVEL);
+  esp_sleep_enable_gpio_wakeup();
+  if (settings.uartWake) {
+    // The bytes that wake the UART are lost; senders repeat or lead with a newline
+    uart_set_wakeup_threshold(UART_NUM_0, 3);
+    esp_sleep_enable_uart_wakeup(UART_NUM_0);
+  }
+
+  _hooks.lightSleepEnter();
+  xSemaphoreTake(_clockMutex, portMAX_DELAY);
+  meterEnter(_cpuMeter, CPU_STATE_SLEEP);
+  esp_light_sleep_start();
+  meterEnter(_cpuMeter, cpuStateForMhz(getCpuFrequencyMhz()));
+  xSemaphoreGive(_clockMutex);
+  report.lightSleepCount++;
+
+  gpio_wakeup_disable((gpio_num_t)_wakePin);
+  esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
+  _hooks.lightSleepExit(esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO);
+}
+
+void Power_Module::idleUntil(unsigned long deadlineMs) {
+  if (_clockMutex != nullptr) {
+    xSemaphoreTake(_clockMutex, portMAX_DELAY);
+    if (_perfLocks == 0) {
+      setCpuClockLocked(cpuMhzSupported(settings.cpuIdleMhz) ? settings.cpuIdleMhz : CPU_IDLE_MHZ_DEFAULT);
+    }
+    xSemaphoreGive(_clockMutex);
+  }
+
+  unsigned long now = millis();
+  long gapMs = (long)(deadlineMs - now) - LIGHT_SLEEP_GUARD_MS;
+  if (_clockMutex != nullptr && gapMs >= LIGHT_SLEEP_MIN_MS && lightSleepAllowed()) {
+    lightSleep((unsigned long)gapMs);
+  } else {
+    delay(1);
+  }
+}
+
+/**
+ * Refresh cpu.mhz and the cpu.*_pct time-in-state parameters
+ */
+void Power_Module::updateCpuReport() {
+  xSemaphoreTake(_clockMutex, portMAX_DELAY);
+  uint64_t nowUs = esp_timer_get_time();
+  for (size_t i = 0; i < CPU_STATE_COUNT; i++) {
+    report.cpuPct[i] = _cpuMeter.time().percent(i, nowUs);
+  }
+  xSemaphoreGive(_clockMutex);
+  report.cpuMhz = getCpuFrequencyMhz();
+}
+
+void Power_Module::printCpuStatus() {
+  updateCpuReport();
+  xSemaphoreTake(_clockMutex, portMAX_DELAY);
+  uint64_t nowUs = esp_timer_get_time();
+  Serial.printf("CPU: %u MHz now, %lu perf lock(s), idle %u MHz, light sleep %s\n", report.cpuMhz,
+                (unsigned long)_perfLocks, settings.cpuIdleMhz, settings.lightSleep ? "on" : "off");
+  for (size_t i = 0; i < CPU_STATE_COUNT; i++) {
+    char label[16];
+    if (i == CPU_STATE_SLEEP) {
+      snprintf(label, sizeof(label), "light sleep");
+    } else {
+      snprintf(label, sizeof(label), "%lu MHz", (unsigned long)kCpuStateMhz[i]);
+    }
+    Serial.printf("  %-11s %10.1f s %5.1f%%  entered %lu times\n", label, _cpuMeter.time().totalUs(i, nowUs) / 1e6,
+                  _cpuMeter.time().percent(i, nowUs), (unsigned long)_cpuMeter.time().entries(i));
+  }
+  xSemaphoreGive(_clockMutex);
+}
+
+// ===== ENERGY LEDGER =====
+// Each rail's charge is its time in each state times the current table in
+// Power_Module.h. Totals from earlier wakes and the deep sleeps between them
+// ride in RTC memory, so the projection covers a unit that spends most of its
+// life asleep.
+
+template <size_t States>
+void Power_Module::meterEnter(EnergyMeter<States>& meter, size_t state) {
+  portENTER_CRITICAL(&_energyMux);
+  meter.enter(state, esp_timer_get_time());
+  portEXIT_CRITICAL(&_energyMux);
+}
+
+EnergyMeter<2>* Power_Module::twoStateMeter(EnergyRail rail) {
+  switch (rail) {
+    case ENERGY_LORA:   return &_loraMeter;
+    case ENERGY_WIFI:   return &_wifiMeter;
+    case ENERGY_SD:     return &_sdMeter;
+    case ENERGY_STRAIN: return &_strainMeter;
+    case ENERGY_ACCEL:  return &_accelMeter;
+    default:            return nullptr;
+  }
+}
+
+void Power_Module::energyEnter(EnergyRail rail, size_t state) {
+  EnergyMeter<2>* meter = twoStateMeter(rail);
+  if (meter != nullptr) {
+    meterEnter(*meter, state);
+  }
+}
+
+void Power_Module::energySetCurrent(EnergyRail rail, size_t state, float currentMa) {
+  EnergyMeter<2>* meter = twoStateMeter(rail);
+  if (meter == nullptr) {
+    return;
+  }
+  portENTER_CRITICAL(&_energyMux);
+  meter->setCurrent(state, currentMa, esp_timer_get_time());
+  portEXIT_CRITICAL(&_energyMux);
+}
+
+void Power_Module::setLoRaTxPower(int dbm) {
+  energySetCurrent(ENERGY_LORA, ENERGY_HIGH, loraTxCurrentMa(dbm));
+}
+
+void Power_Module::energyResetMeters() {
+  uint64_t nowUs = esp_timer_get_time();
+  portENTER_CRITICAL(&_energyMux);
+  _loraMeter.reset(ENERGY_LOW, nowUs);
+  _wifiMeter.reset(ENERGY_LOW, nowUs);
+  _sdMeter.reset(ENERGY_LOW, nowUs);
+  _strainMeter.reset(ENERGY_LOW, nowUs);
+  _accelMeter.reset(ENERGY_LOW, nowUs);
+  _boardMeter.reset(0, nowUs);
+  _energyStartUs = nowUs;
+  portEXIT_CRITICAL(&_energyMux);
+}
+
+void Power_Module::storageActive(bool active) {
+  portENTER_CRITICAL(&_energyMux);
+  if (active && _sdUsers++ == 0) {
+    _sdMeter.enter(ENERGY_HIGH, esp_timer_get_time());
+  } else if (!active && _sdUsers > 0 && --_sdUsers == 0) {
+    _sdMeter.enter(ENERGY_LOW, esp_timer_get_time());
+  }
+  portEXIT_CRITICAL(&_energyMux);
+}
+
+/**
+ * Charge per rail and the window it covers, this wake plus earlier ones
+ * @return present draw in mA (every rail in its current state)
+ */
+float Power_Module::energySnapshot(double mAh[ENERGY_RAIL_COUNT], uint64_t& windowUs) {
+  portENTER_CRITICAL(&_energyMux);
+  uint64_t nowUs = esp_timer_get_time();
+  double live[ENERGY_RAIL_COUNT] = {_cpuMeter.mAh(nowUs), _loraMeter.mAh(nowUs), _wifiMeter.mAh(nowUs),
+                                    _sdMeter.mAh(nowUs), _strainMeter.mAh(nowUs), _accelMeter.mAh(nowUs),
+                                    _boardMeter.mAh(nowUs), 0.0};
+  float presentMa = _cpuMeter.presentMa() + _loraMeter.presentMa() + _wifiMeter.presentMa() +
+                    _sdMeter.presentMa() + _strainMeter.presentMa() + _accelMeter.presentMa() +
+                    _boardMeter.presentMa();
+  windowUs = _retained->us + (nowUs - _energyStartUs);
+  portEXIT_CRITICAL(&_energyMux);
+
+  for (size_t i = 0; i < ENERGY_RAIL_COUNT; i++) {
+    mAh[i] = _retained->mAh[i] + live[i];
+  }
+  return presentMa;
+}
+
+void Power_Module::retainEnergy() {
+  double mAh[ENERGY_RAIL_COUNT];
+  uint64_t windowUs;
+  energySnapshot(mAh, windowUs);
+  for (size_t i = 0; i < ENERGY_RAIL_COUNT; i++) {
+    _retained->mAh[i] = mAh[i];
+  }
+  _retained->us = windowUs;
+  _retained->sleepStartUs = wallClockUs();
+}
+
+/**
+ * Charge the deep sleep that just ended (the RTC keeps the wall clock running through it)
+ */
+void Power_Module::accrueDeepSleepEnergy() {
+  int64_t sleptUs = wallClockUs() - _retained->sleepStartUs;
+  if (_retained->sleepStartUs == 0 || sleptUs <= 0) {
+    return;
+  }
+  _retained->mAh[ENERGY_DEEP_SLEEP] += ENERGY_DEEP_SLEEP_MA * (double)sleptUs / ENERGY_US_PER_HOUR;
+  _retained->us += (uint64_t)sleptUs;
+  _retained->sleepStartUs = 0;
+}
+
+/**
+ * Refresh energy.total_mah, energy.avg_ma and energy.life_h
+ */
+void Power_Module::updateEnergyReport() {
+  double mAh[ENERGY_RAIL_COUNT];
+  uint64_t windowUs;
+  energySnapshot(mAh, windowUs);
+  double totalMah = 0;
+  for (size_t i = 0; i < ENERGY_RAIL_COUNT; i++) {
+    totalMah += mAh[i];
+  }
+  report.energyTotalMah = (float)totalMah;
+  report.energyAvgMa = windowUs > 0 ? (float)(totalMah * ENERGY_US_PER_HOUR / windowUs) : 0.0f;
+  report.energyLifeH = batteryLifeHours(settings.batteryMah, totalMah, windowUs);
+}
+
+void Power_Module::printEnergyStatus(unsigned long sleepCount) {
+  double mAh[ENERGY_RAIL_COUNT];
+  uint64_t windowUs;
+  float presentMa = energySnapshot(mAh, windowUs);
+  double totalMah = 0;
+  for (size_t i = 0; i < ENERGY_RAIL_COUNT; i++) {
+    totalMah += mAh[i];
+  }
+  double hours = windowUs / ENERGY_US_PER_HOUR;
+
+  Serial.println("\n=== ENERGY LEDGER ===");
+  Serial.printf("Window: %.2f h since power-up (%lu deep sleeps), battery %u mAh\n", hours,
+                sleepCount, settings.batteryMah);
+  Serial.println("Rail          mAh   avg mA   share");
+  for (size_t i = 0; i < ENERGY_RAIL_COUNT; i++) {
+    Serial.printf("%-10s %9.3f %8.3f %6.1f%%\n", kEnergyRailNames[i], mAh[i], hours > 0 ? mAh[i] / hours : 0.0,
+                  totalMah > 0 ? mAh[i] * 100.0 / totalMah : 0.0);
+  }
+  Serial.printf("%-10s %9.3f %8.3f\n", "total", totalMah, hours > 0 ? totalMah / hours : 0.0);
+
+  // This wake's time in the states that cost the most
+  uint64_t nowUs = esp_timer_get_time();
+  portENTER_CRITICAL(&_energyMux);
+  uint64_t txUs = _loraMeter.time().totalUs(ENERGY_HIGH, nowUs);
+  uint32_t txCount = _loraMeter.time().entries(ENERGY_HIGH);
+  float txMa = _loraMeter.currentMa(ENERGY_HIGH);
+  uint64_t wifiUs = _wifiMeter.time().totalUs(ENERGY_HIGH, nowUs);
+  uint32_t wifiCount = _wifiMeter.time().entries(ENERGY_HIGH);
+  uint64_t sdUs = _sdMeter.time().totalUs(ENERGY_HIGH, nowUs);
+  uint64_t strainUs = _strainMeter.time().totalUs(ENERGY_HIGH, nowUs);
+  portEXIT_CRITICAL(&_energyMux);
+  Serial.printf("This wake: LoRa TX %.1f s (%lu packets at %.0f mA), Wi-Fi %.1f s (%lu sessions), "
+                "SD %.1f s, bridge %.1f s\n", txUs / 1e6, (unsigned long)txCount, txMa, wifiUs / 1e6,
+                (unsigned long)wifiCount, sdUs / 1e6, strainUs / 1e6);
+
+  float lifeAverage = batteryLifeHours(settings.batteryMah, totalMah, windowUs);
+  float lifePresent = presentMa > 0 ? settings.batteryMah / presentMa : 0.0f;
+  Serial.printf("Projected battery life: %.0f h (%.1f days) at the average, %.0f h at the present %.1f mA\n",
+                lifeAverage, lifeAverage / 24.0f, lifePresent, presentMa);
+  Serial.println("=====================\n");
+}
@@ -0,0 +1,296 @@
+/*
+  Filename: Power_Module.h
+  Power Module Header
+
+  Description: Sensor power policy, CPU clock scaling with light sleep, and
+               the energy ledger. PowerPolicy turns activity into a schedule
+               for the NAU7802, LIS3DH and SHT45; with no PerfLock held the
+               CPU drops to cpu.idle_mhz and may light-sleep until the next
+               acquisition deadline; every rail's time in each state is
+               charged against the current table below.
+*/
+
+#ifndef POWER_MODULE_H
+#define POWER_MODULE_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "NAU7802_Module.h"
+#include "LIS3DH_Module.h"
+#include "PowerPolicy.h"
+#include "EnergyMeter.h"
+
+// Sensor power policy (see Shared/PowerPolicy): full power while active, duty-cycled when idle
+#define POWER_IDLE_SEC_DEFAULT          120   // No event/command for this long: IDLE
+#define POWER_STRAIN_PERIOD_SEC_DEFAULT 60    // IDLE: one strain burst this often
+#define POWER_STRAIN_BURST_DEFAULT      10    // Conversions averaged per idle burst
+#define POWER_SHT_ACTIVE_SEC_DEFAULT    10    // SHT45 period while ACTIVE
+#define POWER_SHT_IDLE_SEC_DEFAULT      300   // ... and while IDLE
+#define NAU_SETTLE_CONVERSIONS          2     // Discarded after each power-up (digital filter settling)
+#define POWER_REPORT_MS                 1000  // power.*_pct refresh
+// CPU clock scaling and light sleep between acquisition deadlines (cpu.* parameters)
+#define CPU_MAX_MHZ                     240   // Held while a PerfLock is taken (capture, offload, lab log)
+#define CPU_IDLE_MHZ_DEFAULT            80    // Lowest step that keeps the PLL (Wi-Fi, UART baud unchanged)
+#define LIGHT_SLEEP_MIN_MS              5     // Shorter gaps are spent in delay(1)
+#define LIGHT_SLEEP_GUARD_MS            1     // Wake this much early (light sleep exit and clock relock)
+// Energy ledger current table, mA from the battery. Datasheet and Heltec V3
+// bench figures; re-measure on a unit and update here. LoRa TX by power level
+// is the kLoRaTxCurrent table in Power_Module.cpp.
+#define ENERGY_CPU_240_MA        44.0f   // ESP32-S3, both cores, radios off
+#define ENERGY_CPU_160_MA        34.0f
+#define ENERGY_CPU_80_MA         24.0f
+#define ENERGY_CPU_40_MA         15.0f
+#define ENERGY_CPU_SLEEP_MA      0.24f   // Light sleep
+#define ENERGY_LORA_RX_MA        4.6f    // SX1262 RX, LDO mode, not boosted
+#define ENERGY_WIFI_ON_MA        95.0f   // STA started: scan, connect, TCP (average, TX bursts included)
+#define ENERGY_SD_IDLE_MA        0.6f    // Card standby
+#define ENERGY_SD_ACTIVE_MA      45.0f   // Card read/write
+#define ENERGY_STRAIN_ON_MA      11.5f   // NAU7802 + LDO + 350 ohm bridge excitation at 3.3 V
+#define ENERGY_STRAIN_OFF_MA     0.001f
+#define ENERGY_ACCEL_HR_MA       0.011f  // LIS3DH 100 Hz high resolution
+#define ENERGY_ACCEL_LP_MA       0.006f  // ... low power
+#define ENERGY_BOARD_MA          3.0f    // Regulator quiescent, battery divider, SHT45 idle, leakage
+#define ENERGY_DEEP_SLEEP_MA     0.05f   // Whole board in deep sleep, LIS3DH wake-on-motion armed
+#define ENERGY_BATTERY_MAH_DEFAULT 3000  // energy.battery_mah
+
+// Energy ledger rails (serial 'e'); DEEP_SLEEP only accrues between wakes
+enum EnergyRail : uint8_t {
+  ENERGY_CPU,
+  ENERGY_LORA,
+  ENERGY_WIFI,
+  ENERGY_SD,
+  ENERGY_STRAIN,
+  ENERGY_ACCEL,
+  ENERGY_BOARD,
+  ENERGY_DEEP_SLEEP,
+  ENERGY_RAIL_COUNT
+};
+
+enum { ENERGY_LOW, ENERGY_HIGH };   // Two-state rails: RX/TX, off/on, idle/active, low power/HR
+
+// CPU clock steps and light sleep, as indexes into the CPU rail's ledger
+enum CpuState : uint8_t {
+  CPU_STATE_240,
+  CPU_STATE_160,
+  CPU_STATE_80,
+  CPU_STATE_40,
+  CPU_STATE_SLEEP,
+  CPU_STATE_COUNT
+};
+
+// Ledger totals carried across deep sleep; lives in the caller's RTC memory
+struct EnergyRetained {
+  double mAh[ENERGY_RAIL_COUNT];  // Totals from earlier wakes
+  uint64_t us;                    // Time those totals cover
+  int64_t sleepStartUs;           // Wall clock when the last deep sleep began
+};
+
+// power.*, cpu.* and energy.battery_mah parameters
+struct PowerSettings {
+  bool enabled;
+  unsigned int idleSec;
+  unsigned int strainPeriodSec;
+  unsigned int strainBurst;
+  unsigned int shtActiveSec;
+  unsigned int shtIdleSec;
+  unsigned int cpuIdleMhz;
+  bool lightSleep;      // Off by default: the capture script sends bare keys a UART wake would drop
+  bool uartWake;
+  unsigned int batteryMah;
+};
+
+// Read-only power.*, cpu.* and energy.* parameters, refreshed every POWER_REPORT_MS
+struct PowerReport {
+  unsigned int state;
+  float strainPct;
+  float accelHrPct;
+  float shtPct;
+  float strainIdleUe;   // Result of the last idle strain burst
+  unsigned int cpuMhz;
+  float cpuPct[CPU_STATE_COUNT];
+  unsigned long lightSleepCount;
+  float energyTotalMah;
+  float energyAvgMa;
+  float energyLifeH;
+};
+
+// Glue to the rest of the firmware
+struct PowerHooks {
+  bool (*keepAwake)();                  // Work a light sleep would stall (commands, modes, radio, serial, Wi-Fi)
+  void (*startStrain)();                // Power the NAU7802 up with the configured gain, rate and calibration
+  void (*serviceStrain)();              // Advance NAU7802 bring-up and tare; never blocks
+  float (*microstrain)(int32_t zeroed); // Calibrated microstrain for zeroed ADC counts
+  void (*lightSleepEnter)();
+  void (*lightSleepExit)(bool gpioWake);  // gpioWake: LoRa DIO1 ended the sleep
+};
+
+class Power_Module {
+  public:
+    Power_Module(NAU7802_Module* nau, LIS3DH_Module* lis3dh);
+
+    PowerSettings settings;
+    PowerReport report;
+
+    /**
+     * Create the clock lock and start the ledger; call first thing in setup()
+     * @param retained Ledger totals in RTC memory (zeroed on power-up)
+     * @param wokeFromSleep Charge the deep sleep that just ended
+     * @param wakePin GPIO that ends a light sleep (LoRa DIO1)
+     */
+    void begin(const PowerHooks& hooks, EnergyRetained* retained, bool wokeFromSleep, int wakePin);
+
+    /**
+     * Push power.* periods into the policy (after loading or changing them)
+     */
+    void applySettings();
+
+    // --- Sensor power policy ---
+
+    /**
+     * Apply the policy to the NAU7802 and LIS3DH; call every loop() pass
+     * @param lastActivityMs Last event, command or serial input
+     */
+    void service(unsigned long lastActivityMs);
+
+    /**
+     * Bring the sensors to full power before a measurement that cannot wait
+     * for loop(). Blocks for at most maxWaitMs while the NAU7802 powers up
+     * and settles.
+     * @return true if the strain gauge is ready
+     */
+    bool wakeSensors(unsigned long maxWaitMs);
+
+    /**
+     * Sensors powered up outside the policy (boot)
+     */
+    void strainPoweredUp();
+    void accelPoweredUp();
+
+    /**
+     * SHT45 reads follow the policy's schedule; busyMs is charged to power.sht_pct
+     */
+    bool shtDue(unsigned long now);
+    void addShtBusy(uint32_t busyMs);
+
+    // --- CPU clock and light sleep ---
+
+    /**
+     * Hold the CPU at CPU_MAX_MHZ until the matching perfLockRelease()
+     * Locks nest and may be taken from any task.
+     */
+    void perfLockAcquire();
+    void perfLockRelease();
+
+    /**
+     * Spend the gap before the next acquisition pass: drop the clock when no
+     * PerfLock is held, then light-sleep if allowed and the gap is long enough,
+     * otherwise yield for 1 ms.
+     */
+    void idleUntil(unsigned long deadlineMs);
+
+    /**
+     * Time at each clock step and in light sleep since boot ('h' status)
+     */
+    void printCpuStatus();
+
+    static bool cpuMhzSupported(uint32_t mhz) { return cpuStateForMhz(mhz) != CPU_STATE_COUNT; }
+
+    // --- Energy ledger ---
+
+    /**
+     * Move a two-state rail (LoRa, Wi-Fi, SD, strain, accel); any task
+     */
+    void energyEnter(EnergyRail rail, size_t state);
+    void energySetCurrent(EnergyRail rail, size_t state, float currentMa);
+
+    /**
+     * LoRa TX current for lora.power_dbm
+     */
+    void setLoRaTxPower(int dbm);
+
+    /**
+     * SD card in use: event save, playback, offload streaming, lab log save (nests)
+     */
+    void storageActive(bool active);
+
+    /**
+     * Bank this wake's charge in RTC memory before deep sleep
+     */
+    void retainEnergy();
+
+    /**
+     * Energy per rail since power-up, and battery life at the average and at the present draw ('e')
+     */
+    void printEnergyStatus(unsigned long sleepCount);
+
+  private:
+    NAU7802_Module* _nau;
+    LIS3DH_Module* _lis3dh;
+    PowerHooks _hooks;
+    EnergyRetained* _retained;
+    int _wakePin;
+
+    // Sensor power policy
+    PowerPolicy _policy;
+    DutyMeter _nauDuty;         // NAU7802 powered (analog front end + bridge excitation)
+    DutyMeter _accelHrDuty;     // LIS3DH in high-resolution mode
+    DutyMeter _shtDuty;         // SHT45 measuring
+    unsigned long _seenActivityMs;
+    unsigned long _lastReportMs;
+    uint8_t _nauSettleLeft;     // Conversions to discard after the last power-up
+    uint32_t _burstTaken;
+    int64_t _burstSum;
+
+    // CPU clock
+    SemaphoreHandle_t _clockMutex;   // Guards the lock count, the clock and the CPU meter
+    uint32_t _perfLocks;             // PerfLocks held (capture, offload, lab log)
+    EnergyMeter<CPU_STATE_COUNT> _cpuMeter;   // Since boot; also the CPU energy rail
+
+    // Energy ledger: one meter per rail, updated from any task under _energyMux
+    EnergyMeter<2> _loraMeter;
+    EnergyMeter<2> _wifiMeter;
+    EnergyMeter<2> _sdMeter;
+    EnergyMeter<2> _strainMeter;
+    EnergyMeter<2> _accelMeter;
+    EnergyMeter<1> _boardMeter;
+    portMUX_TYPE _energyMux = portMUX_INITIALIZER_UNLOCKED;
+    uint64_t _energyStartUs;    // When the meters above were reset (this wake)
+    uint32_t _sdUsers;          // storageActive() nesting
+
+    PowerPolicyConfig policyConfig() const;
+    void nauPowerUp();
+    void nauPowerDown();
+    void setAccelLowPower(bool lowPower);
+    void serviceStrainBurst(unsigned long now);
+
+    static size_t cpuStateForMhz(uint32_t mhz);
+    void setCpuClockLocked(uint32_t mhz);
+    bool lightSleepAllowed();
+    void lightSleep(unsigned long sleepMs);
+    void updateCpuReport();
+
+    EnergyMeter<2>* twoStateMeter(EnergyRail rail);
+    template <size_t States>
+    void meterEnter(EnergyMeter<States>& meter, size_t state);
+    void energyResetMeters();
+    float energySnapshot(double mAh[ENERGY_RAIL_COUNT], uint64_t& windowUs);
+    void accrueDeepSleepEnergy();
+    void updateEnergyReport();
+};
+
+/**
+ * Scoped perfLockAcquire()/perfLockRelease()
+ */
+class PerfLock {
+  public:
+    explicit PerfLock(Power_Module& power) : _power(power) { _power.perfLockAcquire(); }
+    ~PerfLock() { _power.perfLockRelease(); }
+    PerfLock(const PerfLock&) = delete;
+    PerfLock& operator=(const PerfLock&) = delete;
+
+  private:
+    Power_Module& _power;
+};
+
+#endif
@@ -49,36 +49,37 @@ bool SDCard_Module::begin() {
   return true;
 }
 
-bool SDCard_Module::writeFile(const char* filename, const char* message, bool append) {
+File SDCard_Module::openForWrite(const char* filename, bool append) {
   if (!initialized) {
     Serial.println("SD Card not initialized");
-    return false;
+    return File();
   }
   
   // Extract directory path and create if it doesn't exist
-  String path = String(filename);
-  int lastSlash = path.lastIndexOf('/');
-  if (lastSlash > 0) {
-    String dirPath = path.substring(0, lastSlash);
-    if (!SD.exists(dirPath.c_str())) {
-      Serial.printf("Creating directory: %s\n", dirPath.c_str());
-      if (!SD.mkdir(dirPath.c_str())) {
+  const char* lastSlash = strrchr(filename, '/');
+  if (lastSlash != nullptr && lastSlash > filename) {
+    char dirPath[64];
+    snprintf(dirPath, sizeof(dirPath), "%.*s", (int)(lastSlash - filename), filename);
+    if (!SD.exists(dirPath)) {
+      Serial.printf("Creating directory: %s\n", dirPath);
+      if (!SD.mkdir(dirPath)) {
         Serial.println("Failed to create directory");
-        return false;
+        return File();
       }
     }
   }
   
   // Open file in append or write mode
-  File file;
-  if (append) {
-    file = SD.open(filename, FILE_APPEND);
-  } else {
-    file = SD.open(filename, FILE_WRITE);
-  }
-  
+  File file = SD.open(filename, append ? FILE_APPEND : FILE_WRITE);
   if (!file) {
     Serial.printf("Failed to open file: %s\n", filename);
+  }
+  return file;
+}
+
+bool SDCard_Module::writeFile(const char* filename, const char* message, bool append) {
+  File file = openForWrite(filename, append);
+  if (!file) {
     return false;
   }
   
@@ -257,6 +258,47 @@ bool SDCard_Module::printCsvDataRows(const char* directory, const char* prefix)
   return foundDataRows;
 }
 
+bool SDCard_Module::getDirectoryStats(const char* directory, const char* prefix,
+                                      uint32_t& outCount, uint32_t& outBytes, time_t& outOldest) {
+  outCount = 0;
+  outBytes = 0;
+  outOldest = 0;
+
+  if (!initialized) {
+    return false;
+  }
+
+  File root = SD.open(directory);
+  if (!root || !root.isDirectory()) {
+    return false;
+  }
+
+  size_t prefixLen = strlen(prefix);
+  File file = root.openNextFile();
+  while (file) {
+    if (!file.isDirectory()) {
+      const char* name = file.name();
+      const char* slash = strrchr(name, '/');
+      if (slash != nullptr) {
+        name = slash + 1;
+      }
+      if (strncmp(name, prefix, prefixLen) == 0) {
+        outCount++;
+        outBytes += file.size();
+        time_t written = file.getLastWrite();
+        if (written > 0 && (outOldest == 0 || written < outOldest)) {
+          outOldest = written;
+        }
+      }
+    }
+    file.close();
+    file = root.openNextFile();
+  }
+
+  root.close();
+  return true;
+}
+
 int SDCard_Module::getNextEventNumber(const char* directory, const char* prefix) {
   if (!initialized) {
     return 1;
@@ -41,6 +41,14 @@ class SDCard_Module {
      * @return true if successful, false otherwise
      */
     bool writeFile(const char* filename, const char* message, bool append = true);
+
+    /**
+     * Open a file for streaming writes (creates directory if needed)
+     * @param filename Path to file
+     * @param append If true, append to file; if false, overwrite
+     * @return open File, or a closed File on failure
+     */
+    File openForWrite(const char* filename, bool append = true);
     
     /**
      * Read entire file from SD card
@@ -85,6 +93,18 @@ class SDCard_Module {
      */
     bool printCsvDataRows(const char* directory, const char* prefix);
     
+    /**
+     * Summarize files matching prefix in a directory (non-recursive)
+     * @param directory Directory path (e.g., "/events")
+     * @param prefix Filename prefix (e.g., "event ")
+     * @param outCount Number of matching files
+     * @param outBytes Total size of matching files
+     * @param outOldest Oldest last-write time (0 if unknown)
+     * @return true if the directory could be read, false otherwise
+     */
+    bool getDirectoryStats(const char* directory, const char* prefix,
+                           uint32_t& outCount, uint32_t& outBytes, time_t& outOldest);
+
     /**
      * Get next available event number (for sequential naming)
      * @param directory Directory to search (e.g., "/events")
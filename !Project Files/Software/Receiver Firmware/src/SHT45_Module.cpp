@@ -109,7 +109,7 @@ bool SHT45_Module::isConnected() {
     return (_wire->endTransmission() == 0);
 }
 
-uint8_t SHT45_Module::calculateCRC(uint8_t data[], uint8_t len) {
+uint8_t SHT45_Module::calculateCRC(const uint8_t data[], uint8_t len) {
     // CRC-8 polynomial: x^8 + x^5 + x^4 + 1 (0x31)
     uint8_t crc = 0xFF;
     
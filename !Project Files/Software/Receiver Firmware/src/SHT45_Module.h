@@ -33,15 +33,15 @@ public:
     // Check if sensor is connected
     bool isConnected();
     
+    // CRC calculation for data validation (CRC-8, polynomial 0x31, init 0xFF)
+    static uint8_t calculateCRC(const uint8_t data[], uint8_t len);
+    
 private:
     TwoWire* _wire;
     uint8_t _address;
     float _temperature;
     float _humidity;
     bool _initialized;
-    
-    // CRC calculation for data validation
-    uint8_t calculateCRC(uint8_t data[], uint8_t len);
 };
 
 #endif
@@ -18,6 +18,7 @@ OLEDDisplay_Module oledDisplay;                             // OLED display inst
 SHT45_Module sht45(&I2C_Sensors, SHT45_I2C_ADDRESS);        // SHT45 sensor instance
 LIS3DH_Module lis3dh(&I2C_Sensors, LIS3DH_I2C_ADDRESS);     // LIS3DH accelerometer instance
 NAU7802_Module nau7802(&I2C_Sensors, NAU7802_I2C_ADDRESS);  // NAU7802 ADC for strain gauges
+Power_Module power(&nau7802, &lis3dh);                      // Sensor power policy, CPU clock, energy ledger
 
 // SD Card - Initialize SPI on HSPI bus
 SPIClass spiSD(HSPI);
@@ -25,15 +26,60 @@ SDCard_Module sdCard(&spiSD, SDCARD_CS);
 EventLogger_Module eventLogger(&sdCard);
 SX1262 loraRadio = new Module(LORA_NSS, LORA_DIO1, LORA_RST, LORA_BUSY);
 
-volatile bool loraPacketReceived = false;
-
-// ===== CONFIGURABLE RUNTIME PARAMETERS =====
+// ===== CONFIGURABLE RUNTIME PARAMETERS (persisted in NVS) =====
 unsigned long SENSOR_READ_INTERVAL = 100;       // Default: 100ms
 float ACCEL_THRESHOLD = 2.0;                    // Default: 2.0g
 unsigned long EVENT_CAPTURE_DURATION_MS = 2000; // Default: 2000ms
 unsigned int LAB_TEST_SAMPLE_RATE_HZ = 20;      // Default: 20Hz
+unsigned int g_eventMaxSamples = EVENT_MAX_SAMPLES;
+unsigned int g_accelBufferSize = 20;
+unsigned int g_nauGain = 32;                    // Matches NAU7802_Module::begin()
+unsigned int g_nauRateSps = 20;
+uint8_t g_loraSpreadingFactor = LORA_SPREADING_FACTOR;
+float g_loraBandwidthKhz = LORA_BANDWIDTH_KHZ;
+uint8_t g_loraCodingRate = LORA_CODING_RATE;
+int g_loraTxPowerDbm = LORA_TX_POWER_DBM;
+bool loraReconfigurePending = false;
+bool g_sleepEnabled = false;                    // Off until enabled with SET:sleep.enable=1
+unsigned int g_sleepIdleSec = SLEEP_IDLE_SEC_DEFAULT;
+unsigned int g_sleepTimerSec = SLEEP_TIMER_SEC_DEFAULT;
+float g_sleepWakeG = SLEEP_WAKE_G_DEFAULT;
 // ===========================================
 
+// AFE calibration and zero offset cached in NVS so boot can skip CALS and start from the last zero
+NAU7802_Calibration g_nauCalibration;
+bool g_haveNauCalibration = false;
+int32_t g_nauZeroOffset = 0;
+bool g_haveNauZero = false;
+
+// Boot milestones in ms since start (0 = not reached yet)
+unsigned long g_bootNauReadyMs = 0;
+unsigned long g_bootFirstSampleMs = 0;
+
+// Kept in RTC slow memory across deep sleep; cleared by power-up or reset
+struct RtcState {
+  uint32_t magic;                     // RTC_STATE_MAGIC once written before a sleep
+  unsigned long sleepCount;
+  unsigned long motionWakes;
+  unsigned long timerWakes;
+  unsigned long eventsCaptured;
+  EnergyRetained energy;              // Energy ledger totals from earlier wakes
+  int32_t configSlot;                 // ConfigStore slot the image came from
+  uint32_t configLen;
+  uint8_t configImage[ConfigTLV<CFG_CAPACITY>::IMAGE_SIZE];
+};
+RTC_DATA_ATTR RtcState g_rtc;
+
+unsigned int g_wakeReason = 0;        // sleep.wake_cause: 0 power-up/reset, 1 motion, 2 timer
+volatile unsigned long g_lastActivityMs = 0;
+
+// LoRa command latency from the DIO1 interrupt (read-only lora.* parameters)
+unsigned long g_loraCmdCount = 0;
+float g_loraAckAvgMs = 0;
+float g_loraAckMaxMs = 0;
+float g_loraDoneAvgMs = 0;
+float g_loraDoneMaxMs = 0;
+
 // Strain calibration: convert computed microstrain to calibrated extensometer-equivalent microstrain.
 constexpr float STRAIN_CALIBRATION_DIVISOR = 11679.7f;
 
@@ -41,16 +87,18 @@ static inline float toCalibratedMicrostrain(float strainDecimal) {
   return (strainDecimal * 1000000.0f) / STRAIN_CALIBRATION_DIVISOR;
 }
 
-// ===== TRUCK IDENTITY (set via SETUP packet or loaded from SD) =====
+// ===== TRUCK IDENTITY (set via SETUP packet, persisted in NVS) =====
 String g_truckId = "";
 bool g_includeTruckId = false;
 String g_description = "";
 bool g_includeDescription = false;
 // ===================================================================
 
-// ===== WiFi Offload Profiles (set via SETUP packet or loaded from SD) =====
+// ===== WiFi Offload Profiles (set via SETUP packet, persisted in NVS) =====
 String g_wifiSsids[MAX_WIFI_PROFILES];
 String g_wifiPasswords[MAX_WIFI_PROFILES];
+String g_softApSsid;       // Transmitter's sweep SoftAP; empty until set by SETUP aps=/app=
+String g_softApPassword;
 // ===========================================================================
 
 constexpr uint8_t SETUP_MASK_SENSOR_INTERVAL = 1 << 0;
@@ -70,54 +118,361 @@ void processSerialCommand(char command);
 bool setTimeManually(const char* dateTimeStr);
 void deleteAllEventFiles();
 
+// Performance metrics since boot (serial 'p', LoRa CMD:p); see Shared/Metrics
+MetricCounter g_metEvents("events");
+MetricHistogram g_metCaptureMs("capture_ms");       // Paired sampling of one event
+MetricHistogram g_metSaveMs("save_ms");             // SHT45 read + CSV format + SD write
+MetricHistogram g_metSdWriteMs("sd_write_ms");
+MetricCounter g_metSdWriteFail("sd_write_fail");
+MetricHistogram g_metNauWaitUs("nau_wait_us");      // Blocking readRaw(): conversion wait + I2C read
+MetricHistogram g_metAccelI2cUs("accel_i2c_us");
+MetricHistogram g_metShtI2cUs("sht_i2c_us");        // Includes the SHT45 measurement wait
+MetricCounter g_metI2cFail("i2c_fail");
+MetricHistogram g_metLoraTxMs("lora_tx_ms");        // Airtime plus SPI, per packet
+MetricCounter g_metLoraTxBytes("lora_tx_bytes");
+MetricCounter g_metLoraTxFail("lora_tx_fail");
+MetricHistogram g_metOffloadBps("offload_bps");     // Per 'd' offload, Wi-Fi or LoRa
+MetricCounter g_metOffloadBytes("offload_bytes");
+
+// Execution trace (serial 'x'); see Shared/TraceRing. The end argument is noted per point.
+enum TracePoint : uint16_t {
+  TRACE_TRIGGER,        // Instant: threshold crossed, peak |g| x1000
+  TRACE_CAPTURE,        // Paired sampling in captureEvent(); samples
+  TRACE_SAVE,           // SHT45 read + CSV format + SD write; 1 if saved
+  TRACE_SD_WRITE,       // Storage lock wait + saveEventCsv(); 1 if written
+  TRACE_NAU_WAIT,       // Blocking readRaw(): conversion wait + I2C read
+  TRACE_ACCEL_READ,     // 1 if read
+  TRACE_SHT_READ,       // 1 if read
+  TRACE_LORA_TX,        // Radio lock wait + transmit(); bytes, 0 if it failed
+  TRACE_LORA_RX,        // Packet read after DIO1; bytes, 0 if it failed
+  TRACE_LORA_CMD,       // executeLoRaPacket(); packet bytes
+  TRACE_WIFI_SESSION,   // startWifiLocalOffload(); 1 if delivered
+  TRACE_WIFI_CONNECT,   // One network: association + DHCP; 1 if connected
+  TRACE_WIFI_CLIENT,    // Waiting for the transmitter's TCP connection; 1 if connected
+  TRACE_WIFI_STREAM,    // Event files over TCP; bytes
+  TRACE_LIGHT_SLEEP,
+  TRACE_POINT_COUNT
+};
+const char* const kTracePointNames[TRACE_POINT_COUNT] = {
+  "trigger", "capture", "save", "sd_write", "nau_wait", "accel_read", "sht_read", "lora_tx", "lora_rx",
+  "lora_cmd", "wifi_session", "wifi_connect", "wifi_client", "wifi_stream", "light_sleep"
+};
+TraceRing<TRACE_RING_EVENTS> g_trace;
+TaskHandle_t g_traceTasks[TRACE_MAX_TASKS];
+uint8_t g_traceTaskCount = 0;
+portMUX_TYPE g_traceMux = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * Small ID for the calling task; handles are only ever appended, so the lookup takes no lock
+ */
+uint8_t traceTaskId() {
+  TaskHandle_t self = xTaskGetCurrentTaskHandle();
+  uint8_t count = __atomic_load_n(&g_traceTaskCount, __ATOMIC_ACQUIRE);
+  for (uint8_t i = 0; i < count; i++) {
+    if (g_traceTasks[i] == self) {
+      return i;
+    }
+  }
+  uint8_t id = TRACE_MAX_TASKS;
+  portENTER_CRITICAL(&g_traceMux);
+  count = g_traceTaskCount;
+  for (uint8_t i = 0; i < count; i++) {
+    if (g_traceTasks[i] == self) {
+      id = i;
+    }
+  }
+  if (id == TRACE_MAX_TASKS && count < TRACE_MAX_TASKS) {
+    g_traceTasks[count] = self;
+    __atomic_store_n(&g_traceTaskCount, (uint8_t)(count + 1), __ATOMIC_RELEASE);
+    id = count;
+  }
+  portEXIT_CRITICAL(&g_traceMux);
+  return id;
+}
+
+void traceBegin(TracePoint point) {
+  g_trace.record(micros(), point, TRACE_PHASE_BEGIN, traceTaskId(), 0);
+}
+
+void traceEnd(TracePoint point, uint32_t arg = 0) {
+  g_trace.record(micros(), point, TRACE_PHASE_END, traceTaskId(), arg);
+}
+
+void traceInstant(TracePoint point, uint32_t arg = 0) {
+  g_trace.record(micros(), point, TRACE_PHASE_INSTANT, traceTaskId(), arg);
+}
+
+// Begin/end pair for a scope with several exits; the end argument is whatever setArg() left
+class TraceSpan {
+  public:
+    explicit TraceSpan(TracePoint point) : _point(point), _arg(0) { traceBegin(point); }
+    ~TraceSpan() { traceEnd(_point, _arg); }
+    void setArg(uint32_t arg) { _arg = arg; }
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+  private:
+    TracePoint _point;
+    uint32_t _arg;
+};
+
+bool readAccelTimed() {
+  traceBegin(TRACE_ACCEL_READ);
+  uint32_t start = micros();
+  bool ok = lis3dh.read();
+  g_metAccelI2cUs.record(micros() - start);
+  traceEnd(TRACE_ACCEL_READ, ok);
+  if (!ok) {
+    g_metI2cFail.add();
+  }
+  return ok;
+}
+
+bool readShtTimed() {
+  traceBegin(TRACE_SHT_READ);
+  uint32_t start = micros();
+  bool ok = sht45.read();
+  g_metShtI2cUs.record(micros() - start);
+  traceEnd(TRACE_SHT_READ, ok);
+  if (!ok) {
+    g_metI2cFail.add();
+  }
+  return ok;
+}
+
+int32_t readStrainTimed() {
+  traceBegin(TRACE_NAU_WAIT);
+  uint32_t start = micros();
+  int32_t raw = nau7802.readRaw();
+  g_metNauWaitUs.record(micros() - start);
+  traceEnd(TRACE_NAU_WAIT);
+  return raw;
+}
+
+/**
+ * Every metric, one per line ('p'); histograms in their own units (suffix)
+ */
+void printMetrics() {
+  char line[128];
+  Serial.println("\n=== METRICS ===");
+  for (const Metric* m = Metric::first(); m != nullptr; m = m->next()) {
+    metricsFormat(*m, line, sizeof(line));
+    Serial.println(line);
+  }
+  Serial.println("===============\n");
+}
+
+/**
+ * Bus traffic since the last 'i' (or boot), busiest rows first; starts a new window
+ */
+void printI2cProfile() {
+  if (!i2cProfilerActive()) {
+    Serial.println("I2C profiler not linked (build with I2C_PROFILER_HOOKS)");
+    return;
+  }
+  static I2CProfileEntry rows[I2C_PROFILER_MAX_ENTRIES];   // Too big for the loop task's stack
+  I2CProfileWindow window;
+  size_t count = i2cProfilerTake(rows, I2C_PROFILER_MAX_ENTRIES, window);
+  float windowSec = window.elapsedUs / 1e6f;
+  uint64_t busyUs[2] = {0, 0};
+
+  Serial.printf("\n=== I2C BUS PROFILE (%.1f s) ===\n", windowSec);
+  Serial.println("bus device        reg   op       count      /s   tx_B    rx_B   bus_ms  avg_us  max_us  nak  tmo");
+  for (size_t i = 0; i < count; i++) {
+    const I2CProfileEntry& row = rows[i];
+    const char* name = i2cProfilerNameOf(row.address);
+    char device[16];
+    snprintf(device, sizeof(device), "%s%s0x%02X", name ? name : "", name ? " " : "", row.address);
+    char reg[8];
+    if (row.reg == I2C_PROFILER_NO_REG) {
+      snprintf(reg, sizeof(reg), "-");
+    } else {
+      snprintf(reg, sizeof(reg), "0x%02X", row.reg);
+    }
+    Serial.printf("%3u %-13s %-5s %-6s %7lu %7.1f %6lu %7lu %8.1f %7lu %7lu %4lu %4lu\n",
+                  row.bus, device, reg, i2cProfilerOpName(row.op), (unsigned long)row.count,
+                  windowSec > 0.0f ? row.count / windowSec : 0.0f,
+                  (unsigned long)row.txBytes, (unsigned long)row.rxBytes, row.busUs / 1000.0f,
+                  (unsigned long)(row.busUs / row.count), (unsigned long)row.maxUs,
+                  (unsigned long)row.naks, (unsigned long)row.timeouts);
+    if (row.bus < 2) {
+      busyUs[row.bus] += row.busUs;
+    }
+  }
+  for (uint8_t bus = 0; bus < 2; bus++) {
+    if (busyUs[bus] > 0) {
+      Serial.printf("bus %u busy %.1f ms (%.2f%% of the window)\n", bus, busyUs[bus] / 1000.0f,
+                    window.elapsedUs > 0 ? 100.0f * busyUs[bus] / window.elapsedUs : 0.0f);
+    }
+  }
+  Serial.printf("%lu transactions", (unsigned long)window.transactions);
+  if (window.unrecorded > 0) {
+    Serial.printf(", %lu not itemized (table full)", (unsigned long)window.unrecorded);
+  }
+  Serial.println("\n================================\n");
+}
+
+/**
+ * Dump the trace ring as "#TR:" lines for examples/trace_convert, then start
+ * it over; recording pauses while the lines go out
+ */
+void printTrace() {
+  g_trace.setEnabled(false);
+  delay(1);   // A task that claimed a slot before the pause finishes its store
+
+  char line[TRACE_FRAME_CHARS];
+  size_t count = g_trace.count();
+  Serial.printf("#TR:BEGIN events=%u dropped=%lu\n", (unsigned)count, (unsigned long)g_trace.dropped());
+  for (uint16_t id = 0; id < TRACE_POINT_COUNT; id++) {
+    Serial.printf("#TR:NAME %u %s\n", id, kTracePointNames[id]);
+  }
+  uint8_t tasks = __atomic_load_n(&g_traceTaskCount, __ATOMIC_ACQUIRE);
+  for (uint8_t i = 0; i < tasks; i++) {
+    Serial.printf("#TR:TASK %u %s\n", i, pcTaskGetName(g_traceTasks[i]));
+  }
+  Serial.printf("#TR:TASK %u other\n", TRACE_MAX_TASKS);
+  for (size_t i = 0; i < count; i++) {
+    traceFrameEvent(g_trace.at(i), line, sizeof(line));
+    Serial.println(line);
+  }
+  Serial.println("#TR:END");
+
+  g_trace.clear();
+  g_trace.setEnabled(true);
+}
+
+/**
+ * Offload throughput for one 'd' (bytes of event data over the whole session)
+ */
+void recordOffload(size_t bytes, unsigned long elapsedMs) {
+  g_metOffloadBytes.add(bytes);
+  if (elapsedMs > 0) {
+    g_metOffloadBps.record((uint32_t)((uint64_t)bytes * 1000 / elapsedMs));
+  }
+}
+
+// The radio is shared by lora_rx, lora_cmd and loop(); every SPI transaction holds this
+SemaphoreHandle_t g_radioMutex = nullptr;
+TaskHandle_t g_loraRxTask = nullptr;
+volatile bool g_loraTransmitting = false;   // DIO1 also signals TX done; ignore it then
+volatile uint32_t g_loraIrqUs = 0;
+
 #if defined(ESP8266) || defined(ESP32)
   ICACHE_RAM_ATTR
 #endif
 void setLoRaFlag(void) {
-  loraPacketReceived = true;
+  if (g_loraTransmitting || g_loraRxTask == nullptr) {
+    return;
+  }
+  g_loraIrqUs = micros();
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(g_loraRxTask, &woken);
+  portYIELD_FROM_ISR(woken);
 }
 
-bool sendLoRaMessage(const String& payload) {
-  int txState = loraRadio.transmit(payload.c_str());
+/**
+ * Transmit, then put the radio straight back into receive
+ */
+bool sendLoRaMessage(const uint8_t* data, size_t len) {
+  traceBegin(TRACE_LORA_TX);
+  xSemaphoreTake(g_radioMutex, portMAX_DELAY);
+  g_loraTransmitting = true;
+  power.energyEnter(ENERGY_LORA, ENERGY_HIGH);
+  uint32_t txStartUs = micros();
+  int txState = loraRadio.transmit(data, len);
+  uint32_t txUs = micros() - txStartUs;
+  power.energyEnter(ENERGY_LORA, ENERGY_LOW);
+  g_loraTransmitting = false;
+  int rxState = loraRadio.startReceive();
+  xSemaphoreGive(g_radioMutex);
+  traceEnd(TRACE_LORA_TX, (txState == RADIOLIB_ERR_NONE) ? len : 0);
+
+  if (rxState != RADIOLIB_ERR_NONE) {
+    Serial.printf("LoRa RX start failed (%d)\n", rxState);
+  }
   if (txState != RADIOLIB_ERR_NONE) {
+    g_metLoraTxFail.add();
     Serial.printf("LoRa TX failed (%d)\n", txState);
     return false;
   }
+  g_metLoraTxMs.record((txUs + 500) / 1000);
+  g_metLoraTxBytes.add(len);
   return true;
 }
 
+bool sendLoRaMessage(const char* payload) {
+  return sendLoRaMessage((const uint8_t*)payload, strlen(payload));
+}
+
+bool sendLoRaMessage(const String& payload) {
+  return sendLoRaMessage((const uint8_t*)payload.c_str(), payload.length());
+}
+
 void restartLoRaReceive() {
+  xSemaphoreTake(g_radioMutex, portMAX_DELAY);
   int rxState = loraRadio.startReceive();
+  xSemaphoreGive(g_radioMutex);
   if (rxState != RADIOLIB_ERR_NONE) {
     Serial.printf("LoRa RX start failed (%d)\n", rxState);
   }
 }
 
-void sendCsvLineOverLoRa(const String& line) {
-  if (line.length() <= LORA_DATA_CHUNK_SIZE) {
-    sendLoRaMessage("DATA:" + line);
-    return;
-  }
+// Heap allocations per received packet and per sensor sample (serial 'h')
+AllocProbe loraPacketProbe("lora_rx");
+AllocProbe sampleProbe("sample");
+AllocProbe loraChunkProbe("lora_tx_chunk");
 
-  int index = 0;
-  while (index < line.length()) {
-    int remaining = line.length() - index;
-    int take = remaining > LORA_DATA_CHUNK_SIZE ? LORA_DATA_CHUNK_SIZE : remaining;
-    String chunk = line.substring(index, index + take);
-    bool isFinalChunk = (index + take) >= line.length();
+// Fixed buffers instead of heap/stack; serial 'h' reports their use
+StaticPool<SAMPLE_POOL_BLOCK_BYTES, 1> g_samplePool("sample");
+StaticPool<LORA_MAX_PACKET_SIZE + 1, PACKET_POOL_BLOCKS> g_packetPool("packet");
+StaticPool<LINE_POOL_BLOCK_BYTES, LINE_POOL_BLOCKS> g_linePool("line");
+static_assert(SAMPLE_POOL_BLOCK_BYTES >= EVENT_SAMPLE_CAPACITY * sizeof(EventLogger_Module::EventSample),
+              "sample pool block must hold a full event");
 
-    if (isFinalChunk) {
-      sendLoRaMessage("DATA:" + chunk);
-    } else {
-      sendLoRaMessage("DATC:" + chunk);
+Diagnostics_Module diagnostics(&nau7802, &sdCard, &power, &g_samplePool, &g_linePool);
+
+// Event files are read by lora_cmd (offload, queue summary) while loop() saves and clears them
+SemaphoreHandle_t g_storageMutex = nullptr;
+
+/**
+ * Scoped hold on the event files (recursive: 'd' streams, then clears)
+ */
+class StorageLock {
+  public:
+    StorageLock() {
+      xSemaphoreTakeRecursive(g_storageMutex, portMAX_DELAY);
+      power.storageActive(true);
+    }
+    ~StorageLock() {
+      power.storageActive(false);
+      xSemaphoreGiveRecursive(g_storageMutex);
     }
+    StorageLock(const StorageLock&) = delete;
+    StorageLock& operator=(const StorageLock&) = delete;
+};
 
-    index += take;
-    delay(10);
+/**
+ * Send one CSV slice as DATC:<chunk> (more follows) or DATA:<chunk> (end of line)
+ */
+void sendCsvChunkOverLoRa(const char* data, size_t len, bool finalChunk) {
+  PoolBlock packet(g_packetPool);
+  if (!packet) {
+    LOG_ERROR("Packet pool exhausted, CSV chunk dropped");
+    return;
   }
+  if (len > LORA_DATA_CHUNK_SIZE) {
+    len = LORA_DATA_CHUNK_SIZE;
+  }
+  loraChunkProbe.begin();
+  memcpy(packet.bytes(), finalChunk ? "DATA:" : "DATC:", 5);
+  memcpy(packet.bytes() + 5, data, len);
+  sendLoRaMessage(packet.bytes(), 5 + len);
+  loraChunkProbe.end();
+  delay(finalChunk ? 15 : 10);
 }
 
 bool streamStoredEventsOverLoRa() {
+  StorageLock storage;
   if (!sdCard.isInitialized() || !sdCard.fileExists("/events")) {
     return false;
   }
@@ -127,239 +482,635 @@ bool streamStoredEventsOverLoRa() {
     return false;
   }
 
-  bool sentAnyLine = false;
+  // Files are read in blocks and cut into LoRa payloads as they stream past,
+  // so even a full-capacity event row never exists as one String.
+  static CsvChunker<LORA_DATA_CHUNK_SIZE> chunker("timestamp,");
+  PoolBlock block(g_linePool);
+  if (!block) {
+    root.close();
+    return false;
+  }
+  uint32_t sentLines = 0;
+
   File file = root.openNextFile();
   while (file) {
     if (!file.isDirectory()) {
-      String filename = String(file.name());
-      String baseName = filename;
-      int slashIdx = baseName.lastIndexOf('/');
-      if (slashIdx >= 0 && slashIdx < (baseName.length() - 1)) {
-        baseName = baseName.substring(slashIdx + 1);
+      const char* baseName = file.name();
+      const char* slash = strrchr(baseName, '/');
+      if (slash != nullptr && slash[1] != '\0') {
+        baseName = slash + 1;
       }
+      size_t nameLen = strlen(baseName);
 
-      if (baseName.startsWith("event ") && baseName.endsWith(".csv")) {
+      if (strncmp(baseName, "event ", 6) == 0 && nameLen >= 4 &&
+          strcmp(baseName + nameLen - 4, ".csv") == 0) {
         // Emit file boundary marker so the UI can save each event as its own file
-        sendLoRaMessage("DATA:EVENT_FILE:" + baseName);
+        snprintf(block.chars(), block.size(), "DATA:EVENT_FILE:%s", baseName);
+        sendLoRaMessage(block.chars());
         delay(10);
-        while (file.available()) {
-          String line = file.readStringUntil('\n');
-          line.replace("\r", "");
-          line.trim();
-          if (line.length() == 0 || line.startsWith("timestamp,")) {
-            continue;
-          }
 
-          sendCsvLineOverLoRa(line);
-          sentAnyLine = true;
-          delay(15);
+        chunker.reset();
+        size_t got;
+        while ((got = file.read(block.bytes(), block.size())) > 0) {
+          chunker.push(block.chars(), got, sendCsvChunkOverLoRa);
         }
+        chunker.finish(sendCsvChunkOverLoRa);
+        sentLines += chunker.lines();
       }
-      file.close();
-    } else {
-      file.close();
     }
+    file.close();
     file = root.openNextFile();
   }
 
   root.close();
-  return sentAnyLine;
+  return sentLines > 0;
 }
 
-bool saveTruckInfoToSd(const String& truckId, const String& description, bool includeTruckId, bool includeDescription) {
-  if (!sdCard.isInitialized()) {
-    Serial.println("Truck info not saved: SD card not initialized.");
-    return false;
+// ===== RUNTIME PARAMETER REGISTRY =====
+
+/**
+ * Map nau.gain to the PGA setting
+ * @return false if g_nauGain is not a supported gain
+ */
+bool nauGainSetting(NAU7802_Gain& gain) {
+  // PGA gain register holds log2(gain)
+  for (uint8_t bits = 0; bits <= 7; bits++) {
+    if ((1u << bits) == g_nauGain) {
+      gain = (NAU7802_Gain)bits;
+      return true;
+    }
   }
+  return false;
+}
 
-  String content = "# Truck Info\n";
-  content += "updated=" + getFormattedTime() + "\n";
-  content += "include_truck_id=" + String(includeTruckId ? "1" : "0") + "\n";
-  content += "include_description=" + String(includeDescription ? "1" : "0") + "\n";
-  content += "truck_id=" + String(includeTruckId ? truckId : "") + "\n";
-  content += "description=" + String(includeDescription ? description : "") + "\n";
+/**
+ * Map nau.rate_sps to the output rate setting
+ * @return false if g_nauRateSps is not a supported rate
+ */
+bool nauRateSetting(NAU7802_SampleRate& rate) {
+  switch (g_nauRateSps) {
+    case 10:  rate = NAU7802_SPS_10;  return true;
+    case 20:  rate = NAU7802_SPS_20;  return true;
+    case 40:  rate = NAU7802_SPS_40;  return true;
+    case 80:  rate = NAU7802_SPS_80;  return true;
+    case 320: rate = NAU7802_SPS_320; return true;
+    default:  return false;
+  }
+}
 
-  bool ok = sdCard.writeFile("/truck info/truck_id.txt", content.c_str(), false);
-  if (ok) {
-    Serial.println("Truck info saved: /truck info/truck_id.txt");
-  } else {
-    Serial.println("Truck info save failed.");
+bool programNauGain() {
+  NAU7802_Gain gain;
+  return nauGainSetting(gain) && nau7802.setGain(gain);
+}
+
+bool programNauRate() {
+  NAU7802_SampleRate rate;
+  return nauRateSetting(rate) && nau7802.setSampleRate(rate);
+}
+
+bool applyNauGain(const ParamDef&) {
+  return programNauGain();
+}
+
+bool applyNauRate(const ParamDef&) {
+  return programNauRate();
+}
+
+bool applyLoRaParam(const ParamDef& def) {
+  if (def.value == &g_loraBandwidthKhz) {
+    // SX1262 only supports these bandwidths
+    static const float validBw[] = {7.8f, 10.4f, 15.6f, 20.8f, 31.25f, 41.7f, 62.5f, 125.0f, 250.0f, 500.0f};
+    bool valid = false;
+    for (size_t i = 0; i < sizeof(validBw) / sizeof(validBw[0]); i++) {
+      if (fabsf(validBw[i] - g_loraBandwidthKhz) < 0.01f) valid = true;
+    }
+    if (!valid) return false;
   }
-  return ok;
+  // Applied from loop() so a SET received over LoRa is answered on the old settings first
+  loraReconfigurePending = true;
+  return true;
 }
 
-bool saveWiFiProfilesToSd() {
-  if (!sdCard.isInitialized()) {
-    Serial.println("WiFi profiles not saved: SD card not initialized.");
-    return false;
+bool applyAccelBufferSize(const ParamDef&) {
+  resetAccelBuffer();
+  return true;
+}
+
+bool applyPowerParam(const ParamDef&) {
+  power.applySettings();
+  return true;
+}
+
+bool applyCpuIdleMhz(const ParamDef&) {
+  return Power_Module::cpuMhzSupported(power.settings.cpuIdleMhz);
+}
+
+unsigned long g_lastSerialMs = 0;   // Recent serial input holds off light sleep
+
+unsigned int eventSampleCapacity = EVENT_SAMPLE_CAPACITY;
+
+const ParamDef PARAM_TABLE[] = {
+  {"sensor.interval_ms", PARAM_ULONG, &SENSOR_READ_INTERVAL,      1,    10000, PARAM_PERSIST, CFG_TAG_SENSOR_INTERVAL,   nullptr},
+  {"event.threshold_g",  PARAM_FLOAT, &ACCEL_THRESHOLD,           0.01f, 10,   PARAM_PERSIST, CFG_TAG_THRESHOLD,         nullptr},
+  {"event.duration_ms",  PARAM_ULONG, &EVENT_CAPTURE_DURATION_MS, 1,    10000, PARAM_PERSIST, CFG_TAG_CAPTURE_DURATION,  nullptr},
+  {"event.max_samples",  PARAM_UINT,  &g_eventMaxSamples,         2,    EVENT_SAMPLE_CAPACITY, PARAM_PERSIST, CFG_TAG_EVENT_MAX_SAMPLES, nullptr},
+  {"event.capacity",     PARAM_UINT,  &eventSampleCapacity,       0,    EVENT_SAMPLE_CAPACITY, PARAM_READ_ONLY, 0, nullptr},
+  {"boot.nau_ready_ms",  PARAM_ULONG, &g_bootNauReadyMs,          0,    4.0e9f, PARAM_READ_ONLY, 0, nullptr},
+  {"boot.first_sample_ms", PARAM_ULONG, &g_bootFirstSampleMs,     0,    4.0e9f, PARAM_READ_ONLY, 0, nullptr},
+  {"lora.cmd_count",     PARAM_ULONG, &g_loraCmdCount,            0,    4.0e9f, PARAM_READ_ONLY, 0, nullptr},
+  {"lora.ack_avg_ms",    PARAM_FLOAT, &g_loraAckAvgMs,            0,    1.0e9f, PARAM_READ_ONLY, 0, nullptr},
+  {"lora.ack_max_ms",    PARAM_FLOAT, &g_loraAckMaxMs,            0,    1.0e9f, PARAM_READ_ONLY, 0, nullptr},
+  {"lora.done_avg_ms",   PARAM_FLOAT, &g_loraDoneAvgMs,           0,    1.0e9f, PARAM_READ_ONLY, 0, nullptr},
+  {"lora.done_max_ms",   PARAM_FLOAT, &g_loraDoneMaxMs,           0,    1.0e9f, PARAM_READ_ONLY, 0, nullptr},
+  {"event.count",        PARAM_ULONG, &g_rtc.eventsCaptured,      0,    4.0e9f, PARAM_READ_ONLY, 0, nullptr},
+  {"sleep.enable",       PARAM_BOOL,  &g_sleepEnabled,            0,    1,     PARAM_PERSIST, CFG_TAG_SLEEP_ENABLE,      nullptr},
+  {"sleep.idle_s",       PARAM_UINT,  &g_sleepIdleSec,            10,   86400, PARAM_PERSIST, CFG_TAG_SLEEP_IDLE,        nullptr},
+  {"sleep.timer_s",      PARAM_UINT,  &g_sleepTimerSec,           60,   86400, PARAM_PERSIST, CFG_TAG_SLEEP_TIMER,       nullptr},
+  {"sleep.wake_g",       PARAM_FLOAT, &g_sleepWakeG,              0.016f, 2.0f, PARAM_PERSIST, CFG_TAG_SLEEP_WAKE_G,     nullptr},
+  {"sleep.count",        PARAM_ULONG, &g_rtc.sleepCount,          0,    4.0e9f, PARAM_READ_ONLY, 0, nullptr},
+  {"sleep.motion_wakes", PARAM_ULONG, &g_rtc.motionWakes,         0,    4.0e9f, PARAM_READ_ONLY, 0, nullptr},
+  {"sleep.timer_wakes",  PARAM_ULONG, &g_rtc.timerWakes,          0,    4.0e9f, PARAM_READ_ONLY, 0, nullptr},
+  {"sleep.wake_cause",   PARAM_UINT,  &g_wakeReason,              0,    2,     PARAM_READ_ONLY, 0, nullptr},
+  {"power.enable",       PARAM_BOOL,  &power.settings.enabled,   0,    1,     PARAM_PERSIST, CFG_TAG_POWER_ENABLE,      nullptr},
+  {"power.idle_s",       PARAM_UINT,  &power.settings.idleSec,   5,    86400, PARAM_PERSIST, CFG_TAG_POWER_IDLE,        applyPowerParam},
+  {"power.strain_period_s", PARAM_UINT, &power.settings.strainPeriodSec, 0,    86400, PARAM_PERSIST, CFG_TAG_POWER_STRAIN_PERIOD, applyPowerParam},
+  {"power.strain_burst", PARAM_UINT,  &power.settings.strainBurst, 1,    100,   PARAM_PERSIST, CFG_TAG_POWER_STRAIN_BURST, nullptr},
+  {"power.sht_active_s", PARAM_UINT,  &power.settings.shtActiveSec, 1,    86400, PARAM_PERSIST, CFG_TAG_POWER_SHT_ACTIVE,  applyPowerParam},
+  {"power.sht_idle_s",   PARAM_UINT,  &power.settings.shtIdleSec, 1,    86400, PARAM_PERSIST, CFG_TAG_POWER_SHT_IDLE,    applyPowerParam},
+  {"power.state",        PARAM_UINT,  &power.report.state,       0,    1,     PARAM_READ_ONLY, 0, nullptr},
+  {"power.strain_pct",   PARAM_FLOAT, &power.report.strainPct,   0,    100,   PARAM_READ_ONLY, 0, nullptr},
+  {"power.accel_hr_pct", PARAM_FLOAT, &power.report.accelHrPct,  0,    100,   PARAM_READ_ONLY, 0, nullptr},
+  {"power.sht_pct",      PARAM_FLOAT, &power.report.shtPct,      0,    100,   PARAM_READ_ONLY, 0, nullptr},
+  {"power.strain_idle_ue", PARAM_FLOAT, &power.report.strainIdleUe, -1.0e9f, 1.0e9f, PARAM_READ_ONLY, 0, nullptr},
+  {"cpu.idle_mhz",       PARAM_UINT,  &power.settings.cpuIdleMhz, 40,   240,   PARAM_PERSIST, CFG_TAG_CPU_IDLE_MHZ,      applyCpuIdleMhz},
+  {"cpu.light_sleep",    PARAM_BOOL,  &power.settings.lightSleep, 0,    1,     PARAM_PERSIST, CFG_TAG_CPU_LIGHT_SLEEP,   nullptr},
+  {"cpu.uart_wake",      PARAM_BOOL,  &power.settings.uartWake,  0,    1,     PARAM_PERSIST, CFG_TAG_CPU_UART_WAKE,     nullptr},
+  {"cpu.mhz",            PARAM_UINT,  &power.report.cpuMhz,      0,    240,   PARAM_READ_ONLY, 0, nullptr},
+  {"cpu.pct_240",        PARAM_FLOAT, &power.report.cpuPct[CPU_STATE_240], 0,    100,   PARAM_READ_ONLY, 0, nullptr},
+  {"cpu.pct_160",        PARAM_FLOAT, &power.report.cpuPct[CPU_STATE_160], 0,    100,   PARAM_READ_ONLY, 0, nullptr},
+  {"cpu.pct_80",         PARAM_FLOAT, &power.report.cpuPct[CPU_STATE_80], 0,    100,   PARAM_READ_ONLY, 0, nullptr},
+  {"cpu.pct_40",         PARAM_FLOAT, &power.report.cpuPct[CPU_STATE_40], 0,    100,   PARAM_READ_ONLY, 0, nullptr},
+  {"cpu.sleep_pct",      PARAM_FLOAT, &power.report.cpuPct[CPU_STATE_SLEEP], 0,    100,   PARAM_READ_ONLY, 0, nullptr},
+  {"cpu.sleep_count",    PARAM_ULONG, &power.report.lightSleepCount, 0,    4.0e9f, PARAM_READ_ONLY, 0, nullptr},
+  {"energy.battery_mah", PARAM_UINT,  &power.settings.batteryMah, 100,  100000, PARAM_PERSIST, CFG_TAG_ENERGY_BATTERY, nullptr},
+  {"energy.total_mah",   PARAM_FLOAT, &power.report.energyTotalMah, 0,    1.0e9f, PARAM_READ_ONLY, 0, nullptr},
+  {"energy.avg_ma",      PARAM_FLOAT, &power.report.energyAvgMa, 0,    1.0e9f, PARAM_READ_ONLY, 0, nullptr},
+  {"energy.life_h",      PARAM_FLOAT, &power.report.energyLifeH, 0,    1.0e9f, PARAM_READ_ONLY, 0, nullptr},
+  {"accel.buffer_size",  PARAM_UINT,  &g_accelBufferSize,         1,    ACCEL_BUFFER_CAPACITY, PARAM_PERSIST, CFG_TAG_ACCEL_BUFFER, applyAccelBufferSize},
+  {"lab.rate_hz",        PARAM_UINT,  &LAB_TEST_SAMPLE_RATE_HZ,   1,    80,    PARAM_PERSIST, CFG_TAG_LAB_SAMPLE_RATE,   nullptr},
+  {"nau.gain",           PARAM_UINT,  &g_nauGain,                 1,    128,   PARAM_PERSIST, CFG_TAG_NAU_GAIN,          applyNauGain},
+  {"nau.rate_sps",       PARAM_UINT,  &g_nauRateSps,              10,   320,   PARAM_PERSIST, CFG_TAG_NAU_RATE,          applyNauRate},
+  {"lora.sf",            PARAM_UINT8, &g_loraSpreadingFactor,     7,    12,    PARAM_PERSIST, CFG_TAG_LORA_SF,           applyLoRaParam},
+  {"lora.bw_khz",        PARAM_FLOAT, &g_loraBandwidthKhz,        7.8f, 500,   PARAM_PERSIST, CFG_TAG_LORA_BW,           applyLoRaParam},
+  {"lora.cr",            PARAM_UINT8, &g_loraCodingRate,          5,    8,     PARAM_PERSIST, CFG_TAG_LORA_CR,           applyLoRaParam},
+  {"lora.power_dbm",     PARAM_INT,   &g_loraTxPowerDbm,          -9,   22,    PARAM_PERSIST, CFG_TAG_LORA_POWER,        applyLoRaParam},
+};
+ParamRegistry params(PARAM_TABLE, sizeof(PARAM_TABLE) / sizeof(PARAM_TABLE[0]));
+
+/**
+ * Push changed lora.* parameters into the radio (deferred from the SET handler)
+ */
+void applyPendingLoRaConfig() {
+  if (!loraReconfigurePending) {
+    return;
   }
+  loraReconfigurePending = false;
 
-  String content = "# WiFi Profiles\n";
-  content += "updated=" + getFormattedTime() + "\n";
-  for (int i = 0; i < MAX_WIFI_PROFILES; i++) {
-    content += "w" + String(i) + "_ssid=" + g_wifiSsids[i] + "\n";
-    content += "w" + String(i) + "_pass=" + g_wifiPasswords[i] + "\n";
+  xSemaphoreTake(g_radioMutex, portMAX_DELAY);
+  int state = loraRadio.setSpreadingFactor(g_loraSpreadingFactor);
+  if (state == RADIOLIB_ERR_NONE) state = loraRadio.setBandwidth(g_loraBandwidthKhz);
+  if (state == RADIOLIB_ERR_NONE) state = loraRadio.setCodingRate(g_loraCodingRate);
+  if (state == RADIOLIB_ERR_NONE) state = loraRadio.setOutputPower(g_loraTxPowerDbm);
+  xSemaphoreGive(g_radioMutex);
+  if (state != RADIOLIB_ERR_NONE) {
+    Serial.printf("LoRa reconfigure failed (%d)\n", state);
+  } else {
+    Serial.printf("LoRa reconfigured: SF%u BW%.1f CR4/%u %d dBm\n",
+                  g_loraSpreadingFactor, g_loraBandwidthKhz, g_loraCodingRate, g_loraTxPowerDbm);
+    power.setLoRaTxPower(g_loraTxPowerDbm);
   }
+  restartLoRaReceive();
+}
 
-  bool ok = sdCard.writeFile(WIFI_PROFILE_FILE, content.c_str(), false);
-  if (ok) {
-    Serial.printf("WiFi profiles saved: %s\n", WIFI_PROFILE_FILE);
+void sendParamReply(const char* text, bool viaLoRa) {
+  if (viaLoRa) {
+    sendLoRaMessage(text);
   } else {
-    Serial.println("WiFi profile save failed.");
+    Serial.println(text);
   }
-  return ok;
 }
 
-bool parseSetupPacket(const String& packet) {
-  if (!packet.startsWith("SETUP:")) {
+/**
+ * GET:<name> | SET:<name>=<value> | LIST[:<prefix>]
+ * Replies: RSP:P:<name>=<value> or RSP:P_ERR:<name>:<reason> (LIST over serial adds type/range)
+ * @return true if the line was a parameter command
+ */
+bool handleParamCommand(const char* text, bool viaLoRa) {
+  char reply[160];
+
+  if (strncmp(text, "GET:", 4) == 0) {
+    const char* name = text + 4;
+    const ParamDef* def = params.find(name, strlen(name));
+    if (def == nullptr) {
+      snprintf(reply, sizeof(reply), "RSP:P_ERR:%s:%s", name, ParamRegistry::resultText(PARAM_UNKNOWN));
+    } else {
+      memcpy(reply, "RSP:P:", 6);
+      ParamRegistry::format(*def, reply + 6, sizeof(reply) - 6);
+    }
+    sendParamReply(reply, viaLoRa);
+    return true;
+  }
+
+  if (strncmp(text, "SET:", 4) == 0) {
+    const char* name = text + 4;
+    const char* eq = strchr(name, '=');
+    if (eq == nullptr) {
+      snprintf(reply, sizeof(reply), "RSP:P_ERR:%s:%s", name, ParamRegistry::resultText(PARAM_BAD_VALUE));
+      sendParamReply(reply, viaLoRa);
+      return true;
+    }
+    const ParamDef* def = nullptr;
+    ParamResult result = params.set(name, (size_t)(eq - name), eq + 1, strlen(eq + 1), &def);
+    if (result != PARAM_OK) {
+      snprintf(reply, sizeof(reply), "RSP:P_ERR:%.*s:%s", (int)(eq - name), name, ParamRegistry::resultText(result));
+      sendParamReply(reply, viaLoRa);
+      return true;
+    }
+    if (def->flags & PARAM_PERSIST) {
+      saveConfigToNvs();
+    }
+    memcpy(reply, "RSP:P:", 6);
+    ParamRegistry::format(*def, reply + 6, sizeof(reply) - 6);
+    sendParamReply(reply, viaLoRa);
+    return true;
+  }
+
+  if (strcmp(text, "LIST") == 0 || strncmp(text, "LIST:", 5) == 0) {
+    const char* prefix = (text[4] == ':') ? text + 5 : "";
+    size_t prefixLen = strlen(prefix);
+    for (size_t i = 0; i < params.count(); i++) {
+      const ParamDef& def = params.at(i);
+      if (strncmp(def.name, prefix, prefixLen) != 0) {
+        continue;
+      }
+      memcpy(reply, "RSP:P:", 6);
+      if (viaLoRa) {
+        ParamRegistry::format(def, reply + 6, sizeof(reply) - 6);
+      } else {
+        ParamRegistry::describe(def, reply + 6, sizeof(reply) - 6);
+      }
+      sendParamReply(reply, viaLoRa);
+    }
+    return true;
+  }
+
+  return false;
+}
+
+ConfigStore<CFG_CAPACITY> configStore(CFG_NVS_NAMESPACE);
+
+/**
+ * Copy the image held by configStore (runtime parameters, truck identity,
+ * WiFi profiles, NAU7802 calibration) into the runtime globals
+ * @return number of parameters restored
+ */
+size_t applyStoredConfig() {
+  const ConfigTLV<CFG_CAPACITY>& cfg = configStore.blob();
+  bool flag;
+  const uint8_t* text;
+  size_t textLen;
+  uint32_t word;
+
+  size_t restored = loadParams(params, cfg);
+  if (cfg.getBool(CFG_TAG_INCLUDE_TRUCK_ID, flag)) g_includeTruckId = flag;
+  if (cfg.getBool(CFG_TAG_INCLUDE_DESC, flag)) g_includeDescription = flag;
+  if (cfg.getBytes(CFG_TAG_TRUCK_ID, text, textLen)) {
+    g_truckId = "";
+    g_truckId.concat((const char*)text, textLen);
+  }
+  if (cfg.getBytes(CFG_TAG_DESCRIPTION, text, textLen)) {
+    g_description = "";
+    g_description.concat((const char*)text, textLen);
+  }
+  for (int i = 0; i < MAX_WIFI_PROFILES; i++) {
+    g_wifiSsids[i] = "";
+    g_wifiPasswords[i] = "";
+    if (cfg.getBytes(CFG_TAG_WIFI_SSID_BASE + i, text, textLen)) {
+      g_wifiSsids[i].concat((const char*)text, textLen);
+    }
+    if (cfg.getBytes(CFG_TAG_WIFI_PASS_BASE + i, text, textLen)) {
+      g_wifiPasswords[i].concat((const char*)text, textLen);
+    }
+  }
+  g_softApSsid = "";
+  g_softApPassword = "";
+  if (cfg.getBytes(CFG_TAG_SOFTAP_SSID, text, textLen)) {
+    g_softApSsid.concat((const char*)text, textLen);
+  }
+  if (cfg.getBytes(CFG_TAG_SOFTAP_PASS, text, textLen)) {
+    g_softApPassword.concat((const char*)text, textLen);
+  }
+  if (cfg.getBytes(CFG_TAG_NAU_CAL, text, textLen) && textLen == sizeof(g_nauCalibration)) {
+    memcpy(&g_nauCalibration, text, textLen);
+    g_haveNauCalibration = true;
+  }
+  if (cfg.getU32(CFG_TAG_NAU_ZERO, word)) {
+    g_nauZeroOffset = (int32_t)word;
+    g_haveNauZero = true;
+  }
+  return restored;
+}
+
+/**
+ * Load persisted runtime parameters, truck identity and WiFi profiles from NVS
+ * @return true if a stored configuration was found
+ */
+bool loadConfigFromNvs() {
+  if (!configStore.load()) {
+    Serial.printf("[CFG] No configuration in NVS (%lu us)\n", configStore.lastLoadMicros());
     return false;
   }
 
-  String data = packet.substring(6);
-  data.trim();
-
-  unsigned long nextInterval = SENSOR_READ_INTERVAL;
-  float nextThreshold = ACCEL_THRESHOLD;
-  unsigned int nextSampleRate = LAB_TEST_SAMPLE_RATE_HZ;
-  unsigned long nextDuration = EVENT_CAPTURE_DURATION_MS;
-  bool sawInterval = false;
-  bool sawThreshold = false;
-  bool sawSampleRate = false;
-  bool sawDuration = false;
-  bool includeTruckId = g_includeTruckId;
-  bool includeDescription = g_includeDescription;
-  String truckId = g_truckId;
-  String description = g_description;
-  String nextSsids[MAX_WIFI_PROFILES];
-  String nextPasswords[MAX_WIFI_PROFILES];
-  uint8_t setupMask = SETUP_MASK_LEGACY_DEFAULT;
-  bool maskProvided = false;
+  size_t restored = applyStoredConfig();
+  const ConfigTLV<CFG_CAPACITY>& cfg = configStore.blob();
+  Serial.printf("[CFG] Loaded from NVS: gen=%lu bytes=%u params=%u in %lu us\n",
+                (unsigned long)cfg.generation(), (unsigned int)cfg.bodySize(),
+                (unsigned int)restored, configStore.lastLoadMicros());
+  if (g_truckId.length() > 0) {
+    Serial.printf("Truck ID loaded: %s\n", g_truckId.c_str());
+  }
+  return true;
+}
+
+/**
+ * After a deep-sleep wake: use the image kept in RTC memory instead of NVS
+ * @return false if there is none (power-up, reset) or it is damaged
+ */
+bool loadConfigFromRtc() {
+  if (g_rtc.magic != RTC_STATE_MAGIC ||
+      !configStore.restore(g_rtc.configImage, g_rtc.configLen, g_rtc.configSlot)) {
+    return false;
+  }
+  size_t restored = applyStoredConfig();
+  Serial.printf("[CFG] Restored from RTC memory: gen=%lu params=%u\n",
+                (unsigned long)configStore.blob().generation(), (unsigned int)restored);
+  return true;
+}
 
+/**
+ * Stage current settings into the TLV image and commit it if anything changed
+ */
+bool saveConfigToNvs() {
+  ConfigTLV<CFG_CAPACITY>& cfg = configStore.blob();
+  bool fits = true;
+
+  fits &= storeParams(params, cfg);
+  fits &= cfg.setBool(CFG_TAG_INCLUDE_TRUCK_ID, g_includeTruckId);
+  fits &= cfg.setString(CFG_TAG_TRUCK_ID, g_truckId.c_str(), g_truckId.length());
+  fits &= cfg.setBool(CFG_TAG_INCLUDE_DESC, g_includeDescription);
+  fits &= cfg.setString(CFG_TAG_DESCRIPTION, g_description.c_str(), g_description.length());
   for (int i = 0; i < MAX_WIFI_PROFILES; i++) {
-    nextSsids[i] = g_wifiSsids[i];
-    nextPasswords[i] = g_wifiPasswords[i];
-  }
-
-  int start = 0;
-  while (start < data.length()) {
-    int sep = data.indexOf(';', start);
-    if (sep < 0) {
-      sep = data.length();
-    }
-
-    String token = data.substring(start, sep);
-    int eq = token.indexOf('=');
-    if (eq > 0) {
-      String key = token.substring(0, eq);
-      String value = token.substring(eq + 1);
-      key.trim();
-      value.trim();
-
-      if (key == "si") {
-        nextInterval = value.toInt();
-        sawInterval = true;
-      } else if (key == "m") {
-        unsigned long v = value.toInt();
+    fits &= cfg.setString(CFG_TAG_WIFI_SSID_BASE + i, g_wifiSsids[i].c_str(), g_wifiSsids[i].length());
+    fits &= cfg.setString(CFG_TAG_WIFI_PASS_BASE + i, g_wifiPasswords[i].c_str(), g_wifiPasswords[i].length());
+  }
+  fits &= cfg.setString(CFG_TAG_SOFTAP_SSID, g_softApSsid.c_str(), g_softApSsid.length());
+  fits &= cfg.setString(CFG_TAG_SOFTAP_PASS, g_softApPassword.c_str(), g_softApPassword.length());
+  if (g_haveNauCalibration) {
+    fits &= cfg.setBytes(CFG_TAG_NAU_CAL, &g_nauCalibration, sizeof(g_nauCalibration));
+  }
+  if (g_haveNauZero) {
+    fits &= cfg.setU32(CFG_TAG_NAU_ZERO, (uint32_t)g_nauZeroOffset);
+  }
+
+  if (!fits) {
+    Serial.println("[CFG] Configuration too large for NVS image (value over 255 bytes or image full)");
+  }
+  if (!cfg.dirty() && configStore.hasStoredImage()) {
+    return fits;
+  }
+  if (!configStore.commit()) {
+    Serial.println("[CFG] NVS commit failed");
+    return false;
+  }
+  Serial.printf("[CFG] Saved to NVS: gen=%lu bytes=%u\n",
+                (unsigned long)cfg.generation(), (unsigned int)cfg.bodySize());
+  return fits;
+}
+
+// Copy a packet view into one of the String-backed settings
+void assignSpan(String& target, const SetupSpan& span) {
+  target = "";
+  target.concat(span.ptr, span.len);
+}
+
+// A SETUP: packet checked and converted, not yet applied; text fields are views into the packet
+struct SetupRequest {
+  unsigned long interval;
+  float threshold;
+  unsigned int sampleRate;
+  unsigned long duration;
+  bool sawInterval;
+  bool sawThreshold;
+  bool sawSampleRate;
+  bool sawDuration;
+  bool includeTruckId;
+  bool includeDescription;
+  SetupSpan truckId;
+  SetupSpan description;
+  bool sawTruckId;
+  bool sawDescription;
+  SetupSpan ssids[MAX_WIFI_PROFILES];
+  SetupSpan passwords[MAX_WIFI_PROFILES];
+  bool sawSsid[MAX_WIFI_PROFILES];
+  bool sawPassword[MAX_WIFI_PROFILES];
+  SetupSpan apSsid;
+  SetupSpan apPassword;
+  bool sawApSsid;
+  bool sawApPassword;
+  uint8_t mask;
+  bool maskProvided;
+};
+
+/**
+ * Tokenize and range-check a SETUP: packet against the current settings;
+ * changes nothing, so the kernel benchmarks can run it
+ * @return false (with the reason on serial) if the packet is rejected
+ */
+bool decodeSetupPacket(const char* packet, size_t len, SetupRequest& request) {
+  if (len < 6 || strncmp(packet, "SETUP:", 6) != 0) {
+    return false;
+  }
+
+  request = SetupRequest();
+  request.interval = SENSOR_READ_INTERVAL;
+  request.threshold = ACCEL_THRESHOLD;
+  request.sampleRate = LAB_TEST_SAMPLE_RATE_HZ;
+  request.duration = EVENT_CAPTURE_DURATION_MS;
+  request.includeTruckId = g_includeTruckId;
+  request.includeDescription = g_includeDescription;
+  request.mask = SETUP_MASK_LEGACY_DEFAULT;
+
+  SetupTokenizer tokenizer(packet, len);
+  SetupField field;
+  while (tokenizer.next(field)) {
+    switch (field.key) {
+      case SETUP_KEY_SI:
+        request.interval = field.value.toLong();
+        request.sawInterval = true;
+        break;
+      case SETUP_KEY_M: {
+        unsigned long v = field.value.toLong();
         if (v > 127) {
           Serial.println("ERROR: Setup mask out of range (0-127)");
           return false;
         }
-        setupMask = (uint8_t)v;
-        maskProvided = true;
-      } else if (key == "thr") {
-        nextThreshold = value.toFloat();
-        sawThreshold = true;
-      } else if (key == "sr") {
-        nextSampleRate = (unsigned int)value.toInt();
-        sawSampleRate = true;
-      } else if (key == "dur") {
-        nextDuration = value.toInt();
-        sawDuration = true;
-      } else if (key == "ti") {
-        includeTruckId = (value == "1");
-      } else if (key == "tid") {
-        truckId = value;
-      } else if (key == "di") {
-        includeDescription = (value == "1");
-      } else if (key == "desc") {
-        description = value;
-      } else if (key.length() == 3 && key.charAt(0) == 'w' && isDigit(key.charAt(1))) {
-        int idx = key.charAt(1) - '0';
-        if (idx >= 0 && idx < MAX_WIFI_PROFILES) {
-          if (key.charAt(2) == 's') {
-            nextSsids[idx] = value;
-          } else if (key.charAt(2) == 'p') {
-            nextPasswords[idx] = value;
-          }
-        }
+        request.mask = (uint8_t)v;
+        request.maskProvided = true;
+        break;
       }
+      case SETUP_KEY_THR:
+        request.threshold = field.value.toFloat();
+        request.sawThreshold = true;
+        break;
+      case SETUP_KEY_SR:
+        request.sampleRate = (unsigned int)field.value.toLong();
+        request.sawSampleRate = true;
+        break;
+      case SETUP_KEY_DUR:
+        request.duration = field.value.toLong();
+        request.sawDuration = true;
+        break;
+      case SETUP_KEY_TI:
+        request.includeTruckId = field.value.equals("1");
+        break;
+      case SETUP_KEY_TID:
+        request.truckId = field.value;
+        request.sawTruckId = true;
+        break;
+      case SETUP_KEY_DI:
+        request.includeDescription = field.value.equals("1");
+        break;
+      case SETUP_KEY_DESC:
+        request.description = field.value;
+        request.sawDescription = true;
+        break;
+      case SETUP_KEY_WIFI_SSID:
+        if (field.index < MAX_WIFI_PROFILES) {
+          request.ssids[field.index] = field.value;
+          request.sawSsid[field.index] = true;
+        }
+        break;
+      case SETUP_KEY_WIFI_PASS:
+        if (field.index < MAX_WIFI_PROFILES) {
+          request.passwords[field.index] = field.value;
+          request.sawPassword[field.index] = true;
+        }
+        break;
+      case SETUP_KEY_AP_SSID:
+        request.apSsid = field.value;
+        request.sawApSsid = true;
+        break;
+      case SETUP_KEY_AP_PASS:
+        request.apPassword = field.value;
+        request.sawApPassword = true;
+        break;
+      default:
+        break;
     }
-
-    start = sep + 1;
   }
 
   // Validate only fields that are explicitly selected by setup mask.
-  if ((setupMask & SETUP_MASK_SENSOR_INTERVAL) && sawInterval) {
-    if (nextInterval < 1 || nextInterval > 10000) {
+  if ((request.mask & SETUP_MASK_SENSOR_INTERVAL) && request.sawInterval) {
+    if (request.interval < 1 || request.interval > 10000) {
       Serial.println("ERROR: Sensor interval out of range (1-10000 ms)");
       return false;
     }
   }
-  if ((setupMask & SETUP_MASK_THRESHOLD) && sawThreshold) {
-    if (nextThreshold <= 0.0f || nextThreshold > 10.0f) {
+  if ((request.mask & SETUP_MASK_THRESHOLD) && request.sawThreshold) {
+    if (request.threshold <= 0.0f || request.threshold > 10.0f) {
       Serial.println("ERROR: Event trigger threshold out of range (0-10 g]");
       return false;
     }
   }
-  if ((setupMask & SETUP_MASK_SAMPLE_RATE) && sawSampleRate) {
-    if (nextSampleRate != 10 && nextSampleRate != 20) {
+  if ((request.mask & SETUP_MASK_SAMPLE_RATE) && request.sawSampleRate) {
+    if (request.sampleRate != 10 && request.sampleRate != 20) {
       Serial.println("ERROR: Sample rate must be 10 or 20 Hz");
       return false;
     }
   }
-  if ((setupMask & SETUP_MASK_DURATION) && sawDuration) {
-    if (nextDuration < 1 || nextDuration > 10000) {
+  if ((request.mask & SETUP_MASK_DURATION) && request.sawDuration) {
+    if (request.duration < 1 || request.duration > 10000) {
       Serial.println("ERROR: Event capture duration out of range (1-10000 ms)");
       return false;
     }
   }
+  if ((request.mask & SETUP_MASK_WIFI) && (request.sawApSsid || request.sawApPassword)) {
+    size_t ssidLen = request.sawApSsid ? request.apSsid.len : g_softApSsid.length();
+    size_t passwordLen = request.sawApPassword ? request.apPassword.len : g_softApPassword.length();
+    if (!softApCredentialsValid(ssidLen, passwordLen)) {
+      Serial.println("ERROR: SoftAP needs an SSID of 1-32 chars and a password of 8-63 (or both empty)");
+      return false;
+    }
+  }
 
-  if (setupMask & SETUP_MASK_SENSOR_INTERVAL) {
-    SENSOR_READ_INTERVAL = nextInterval;
+  if (!request.maskProvided) {
+    if (request.includeTruckId) {
+      request.mask |= SETUP_MASK_TRUCK_ID;
+    }
+    if (request.includeDescription) {
+      request.mask |= SETUP_MASK_DESCRIPTION;
+    }
   }
-  if (setupMask & SETUP_MASK_THRESHOLD) {
-    ACCEL_THRESHOLD = nextThreshold;
+  return true;
+}
+
+bool parseSetupPacket(const char* packet, size_t len) {
+  SetupRequest request;
+  if (!decodeSetupPacket(packet, len, request)) {
+    return false;
   }
-  if (setupMask & SETUP_MASK_SAMPLE_RATE) {
-    LAB_TEST_SAMPLE_RATE_HZ = nextSampleRate;
+
+  if (request.mask & SETUP_MASK_SENSOR_INTERVAL) {
+    SENSOR_READ_INTERVAL = request.interval;
   }
-  if (setupMask & SETUP_MASK_DURATION) {
-    EVENT_CAPTURE_DURATION_MS = nextDuration;
+  if (request.mask & SETUP_MASK_THRESHOLD) {
+    ACCEL_THRESHOLD = request.threshold;
   }
-
-  if (!maskProvided) {
-    if (includeTruckId) {
-      setupMask |= SETUP_MASK_TRUCK_ID;
-    }
-    if (includeDescription) {
-      setupMask |= SETUP_MASK_DESCRIPTION;
-    }
+  if (request.mask & SETUP_MASK_SAMPLE_RATE) {
+    LAB_TEST_SAMPLE_RATE_HZ = request.sampleRate;
+  }
+  if (request.mask & SETUP_MASK_DURATION) {
+    EVENT_CAPTURE_DURATION_MS = request.duration;
   }
 
-  if (setupMask & SETUP_MASK_TRUCK_ID) {
-    g_truckId = truckId;
-    g_includeTruckId = (truckId.length() > 0);
+  if (request.mask & SETUP_MASK_TRUCK_ID) {
+    if (request.sawTruckId) {
+      assignSpan(g_truckId, request.truckId);
+    }
+    g_includeTruckId = (g_truckId.length() > 0);
   }
 
-  if (setupMask & SETUP_MASK_DESCRIPTION) {
-    g_description = description;
-    g_includeDescription = (description.length() > 0);
+  if (request.mask & SETUP_MASK_DESCRIPTION) {
+    if (request.sawDescription) {
+      assignSpan(g_description, request.description);
+    }
+    g_includeDescription = (g_description.length() > 0);
   }
 
-  if (setupMask & SETUP_MASK_WIFI) {
+  if (request.mask & SETUP_MASK_WIFI) {
     for (int i = 0; i < MAX_WIFI_PROFILES; i++) {
-      g_wifiSsids[i] = nextSsids[i];
-      g_wifiPasswords[i] = nextPasswords[i];
+      if (request.sawSsid[i]) {
+        assignSpan(g_wifiSsids[i], request.ssids[i]);
+      }
+      if (request.sawPassword[i]) {
+        assignSpan(g_wifiPasswords[i], request.passwords[i]);
+      }
+    }
+    if (request.sawApSsid) {
+      assignSpan(g_softApSsid, request.apSsid);
+    }
+    if (request.sawApPassword) {
+      assignSpan(g_softApPassword, request.apPassword);
     }
   }
 
@@ -369,16 +1120,9 @@ bool parseSetupPacket(const String& packet) {
   Serial.printf("  LAB_TEST_SAMPLE_RATE_HZ: %u Hz\n", LAB_TEST_SAMPLE_RATE_HZ);
   Serial.printf("  EVENT_CAPTURE_DURATION_MS: %lu ms\n", EVENT_CAPTURE_DURATION_MS);
 
-  if ((setupMask & (SETUP_MASK_TRUCK_ID | SETUP_MASK_DESCRIPTION)) != 0) {
-    if (!saveTruckInfoToSd(g_truckId, g_description, g_includeTruckId, g_includeDescription)) {
-      Serial.println("SETUP warning: truck info requested but not saved.");
-    }
-  }
-
-  if ((setupMask & SETUP_MASK_WIFI) != 0) {
-    if (!saveWiFiProfilesToSd()) {
-      Serial.println("SETUP warning: WiFi profiles were not saved.");
-    }
+  // Only the fields that changed mark the image dirty; an identical SETUP writes nothing
+  if (!saveConfigToNvs()) {
+    Serial.println("SETUP warning: configuration was not saved.");
   }
 
   int wifiConfigured = 0;
@@ -389,10 +1133,14 @@ bool parseSetupPacket(const String& packet) {
     }
   }
   Serial.printf("  WiFi profiles configured: %d\n", wifiConfigured);
+  Serial.printf("  Sweep SoftAP: %s\n", g_softApSsid.length() > 0 ? g_softApSsid.c_str() : "(not set)");
 
   return true;
 }
 
+/**
+ * Load WiFi profiles from the legacy SD text file (first-boot migration only)
+ */
 void loadWiFiProfilesFromSd() {
   for (int i = 0; i < MAX_WIFI_PROFILES; i++) {
     g_wifiSsids[i] = "";
@@ -450,33 +1198,38 @@ void loadWiFiProfilesFromSd() {
   Serial.printf("WiFi profiles loaded: %d\n", loaded);
 }
 
-bool startWifiLocalOffload() {
+bool startWifiLocalOffload(bool useTransmitterSoftAp) {
+  TraceSpan session(TRACE_WIFI_SESSION);
   int configuredProfiles = 0;
   for (int i = 0; i < MAX_WIFI_PROFILES; i++) {
     if (g_wifiSsids[i].length() > 0) configuredProfiles++;
   }
-  if (configuredProfiles == 0) {
+  if (useTransmitterSoftAp ? g_softApSsid.length() == 0 : configuredProfiles == 0) {
     sendLoRaMessage("RSP:WIFI_NONE_CONFIGURED");
     return false;
   }
 
   sendLoRaMessage("RSP:WIFI_START");
 
-  // Try each stored network in order
+  // Try each stored network in order (or only the transmitter's SoftAP during a sweep)
   bool wifiConnected = false;
-  for (int i = 0; i < MAX_WIFI_PROFILES; i++) {
-    String ssid = g_wifiSsids[i];
+  int attempts = useTransmitterSoftAp ? 1 : MAX_WIFI_PROFILES;
+  for (int i = 0; i < attempts; i++) {
+    String ssid = useTransmitterSoftAp ? g_softApSsid : g_wifiSsids[i];
+    String password = useTransmitterSoftAp ? g_softApPassword : g_wifiPasswords[i];
     if (ssid.length() == 0) continue;
 
     sendLoRaMessage("RSP:WIFI_TRY:" + ssid);
+    traceBegin(TRACE_WIFI_CONNECT);
     WiFi.mode(WIFI_STA);
-    WiFi.begin(ssid.c_str(), g_wifiPasswords[i].c_str());
+    WiFi.begin(ssid.c_str(), password.c_str());
 
     int timeout = WIFI_CONNECT_TIMEOUT_SEC;
     while (WiFi.status() != WL_CONNECTED && timeout > 0) {
       delay(1000);
       timeout--;
     }
+    traceEnd(TRACE_WIFI_CONNECT, WiFi.status() == WL_CONNECTED);
 
     if (WiFi.status() == WL_CONNECTED) {
       sendLoRaMessage("RSP:WIFI_CONNECTED:" + ssid);
@@ -498,12 +1251,13 @@ bool startWifiLocalOffload() {
   server.begin();
   String myIp = WiFi.localIP().toString();
   sendLoRaMessage("RSP:WIFI_SERVER:" + myIp + ":" + String(WIFI_SERVER_PORT));
-  Serial.printf("WiFi TCP server started at %s:%d\n", myIp.c_str(), WIFI_SERVER_PORT);
+  LOG_INFO("WiFi TCP server started at %s:%d", myIp.c_str(), WIFI_SERVER_PORT);
 
   // Wait for the transmitter to connect (generous timeout for its WiFi connect + TCP connect)
   WiFiClient client;
   unsigned long serverStart = millis();
   int lastRemaining = -1;
+  traceBegin(TRACE_WIFI_CLIENT);
   while (!client) {
     client = server.available();
     int elapsedSec = (int)((millis() - serverStart) / 1000UL);
@@ -513,6 +1267,7 @@ bool startWifiLocalOffload() {
       lastRemaining = remainingSec;
     }
     if (millis() - serverStart > (WIFI_CLIENT_TIMEOUT_SEC * 1000UL)) {
+      traceEnd(TRACE_WIFI_CLIENT, 0);
       sendLoRaMessage("RSP:WIFI_TX_TIMEOUT");
       server.close();
       WiFi.disconnect(true);
@@ -522,12 +1277,19 @@ bool startWifiLocalOffload() {
     }
     delay(100);
   }
+  traceEnd(TRACE_WIFI_CLIENT, 1);
 
   sendLoRaMessage("RSP:WIFI_TX_CONNECTED");
-  Serial.println("Transmitter TCP connected, streaming events...");
+  LOG_INFO("Transmitter TCP connected, streaming events...");
+
+  // Held through the auto-clear so an event saved mid-stream is not deleted unsent
+  StorageLock storage;
 
   // Stream all stored events over TCP using DATA: lines
   // TCP has no 180-byte packet limit so full lines can be sent without chunking
+  unsigned long streamStart = millis();
+  size_t streamBytes = 0;
+  traceBegin(TRACE_WIFI_STREAM);
   if (sdCard.isInitialized() && sdCard.fileExists("/events")) {
     File root = SD.open("/events");
     if (root && root.isDirectory()) {
@@ -542,13 +1304,13 @@ bool startWifiLocalOffload() {
           }
           if (baseName.startsWith("event ") && baseName.endsWith(".csv")) {
             // Emit file boundary marker so the UI can save each event as its own file
-            client.println("DATA:EVENT_FILE:" + baseName);
+            streamBytes += client.println("DATA:EVENT_FILE:" + baseName);
             while (file.available()) {
               String line = file.readStringUntil('\n');
               line.replace("\r", "");
               line.trim();
               if (line.length() == 0 || line.startsWith("timestamp,")) continue;
-              client.println("DATA:" + line);
+              streamBytes += client.println("DATA:" + line);
               delay(5);
             }
           }
@@ -565,6 +1327,8 @@ bool startWifiLocalOffload() {
   // End-of-transfer marker read by transmitter to trigger END:D on serial
   client.println("END:D");
   client.flush();
+  traceEnd(TRACE_WIFI_STREAM, streamBytes);
+  recordOffload(streamBytes, millis() - streamStart);
   delay(500);
   client.stop();
   server.close();
@@ -573,7 +1337,8 @@ bool startWifiLocalOffload() {
   // Auto-clear events after successful Wi-Fi offload.
   deleteAllEventFiles();
   sendLoRaMessage("RSP:CLEAR_OK");
-  Serial.println("WiFi TCP offload complete.");
+  LOG_INFO("WiFi TCP offload complete.");
+  session.setArg(1);
   return true;
 }
 
@@ -586,22 +1351,25 @@ void applyConfiguration() {
   Serial.println("Unit is now using new parameters.");
 }
 
-bool handleLoRaTimeSyncPacket(const String& packet) {
-  if (!packet.startsWith("TIME:")) {
+bool handleLoRaTimeSyncPacket(const char* packet) {
+  if (strncmp(packet, "TIME:", 5) != 0) {
     return false;
   }
 
-  String dateTime = packet.substring(5);
-  dateTime.trim();
+  // Packet is already trimmed; only leading spaces after the prefix remain
+  const char* dateTime = packet + 5;
+  while (*dateTime == ' ') {
+    dateTime++;
+  }
 
-  Serial.printf("LoRa TIME received: %s\n", dateTime.c_str());
+  Serial.printf("LoRa TIME received: %s\n", dateTime);
 
-  if (dateTime.length() != 19) {
+  if (strlen(dateTime) != 19) {
     sendLoRaMessage("RSP:TIME_SYNC_ERR:FORMAT");
     return true;
   }
 
-  if (setTimeManually(dateTime.c_str())) {
+  if (setTimeManually(dateTime)) {
     sendLoRaMessage("RSP:TIME_SYNC_OK");
   } else {
     sendLoRaMessage("RSP:TIME_SYNC_ERR:VALUE");
@@ -610,21 +1378,232 @@ bool handleLoRaTimeSyncPacket(const String& packet) {
   return true;
 }
 
-void handleLoRaCommandPacket(const String& packet) {
-  if (!packet.startsWith("CMD:") || packet.length() != 5) {
-    // Ignore malformed or unrelated packets to avoid serial spam.
-    return;
-  }
+/**
+ * Name this unit answers to in discovery replies and addressed commands
+ */
+const char* unitId() {
+  return (g_includeTruckId && g_truckId.length() > 0) ? g_truckId.c_str() : "UNNAMED";
+}
+
+/**
+ * Send queue summary for fleet sweeps: RSP:Q:<id>,<events>,<bytes>,<oldest age s>
+ */
+void sendQueueSummary() {
+  StorageLock storage;
+  uint32_t eventCount = 0;
+  uint32_t eventBytes = 0;
+  time_t oldest = 0;
+  sdCard.getDirectoryStats("/events", "event ", eventCount, eventBytes, oldest);
+
+  // Age is only meaningful once the clock has been set (TIME: sync or NTP)
+  time_t now = time(nullptr);
+  unsigned long ageSec = (oldest > 0 && now > 1600000000 && now > oldest) ? (unsigned long)(now - oldest) : 0;
+
+  char reply[LORA_MAX_PACKET_SIZE];
+  snprintf(reply, sizeof(reply), "RSP:Q:%s,%lu,%lu,%lu", unitId(),
+           (unsigned long)eventCount, (unsigned long)eventBytes, ageSec);
+  sendLoRaMessage(reply);
+}
+
+// ===== LoRa command dispatch =====
+// lora_rx (woken by DIO1) reads every packet and answers quick commands itself.
+// Anything long-running is acknowledged with RSP:ACK:<command> and queued:
+// SD/Wi-Fi work to lora_cmd, anything that touches the sensors or runtime
+// parameters to loop(). Latency is measured from the DIO1 interrupt.
+
+struct LoRaCommand {
+  uint32_t rxUs;                          // micros() at the DIO1 interrupt
+  uint16_t len;
+  char text[LORA_MAX_PACKET_SIZE + 1];    // Trimmed, NUL-terminated
+};
+
+enum LoRaRoute {
+  LORA_ROUTE_IGNORE,   // Not for this unit
+  LORA_ROUTE_INLINE,   // Answered by lora_rx; the reply is the ack
+  LORA_ROUTE_WORKER,   // SD card / Wi-Fi: lora_cmd task
+  LORA_ROUTE_LOOP      // Sensors and parameters: loop()
+};
+
+struct LatencyStat {
+  uint32_t count;
+  uint64_t sumUs;
+  uint32_t maxUs;
+};
+
+QueueHandle_t g_loraWorkQueue = nullptr;
+QueueHandle_t g_loraLoopQueue = nullptr;
+volatile bool g_loraWorkerBusy = false;   // Keeps the unit awake through an offload
+LatencyStat g_loraAckLatency = {};
+LatencyStat g_loraDoneLatency = {};
+portMUX_TYPE g_loraLatencyMux = portMUX_INITIALIZER_UNLOCKED;
+
+// CMD:z runs as a background tare; serviceNau() sends the reply when it completes
+bool g_loraTarePending = false;
+uint32_t g_loraTareRxUs = 0;
+
+/**
+ * Add one sample and republish the lora.* parameters
+ */
+void recordLatency(LatencyStat& stat, uint32_t rxUs, float& avgMs, float& maxMs) {
+  uint32_t elapsedUs = micros() - rxUs;
+  portENTER_CRITICAL(&g_loraLatencyMux);
+  stat.count++;
+  stat.sumUs += elapsedUs;
+  if (elapsedUs > stat.maxUs) {
+    stat.maxUs = elapsedUs;
+  }
+  avgMs = (float)stat.sumUs / stat.count / 1000.0f;
+  maxMs = stat.maxUs / 1000.0f;
+  portEXIT_CRITICAL(&g_loraLatencyMux);
+}
+
+void recordLoRaAck(uint32_t rxUs) {
+  recordLatency(g_loraAckLatency, rxUs, g_loraAckAvgMs, g_loraAckMaxMs);
+}
+
+void recordLoRaDone(uint32_t rxUs, const char* text) {
+  uint32_t elapsedUs = micros() - rxUs;
+  recordLatency(g_loraDoneLatency, rxUs, g_loraDoneAvgMs, g_loraDoneMaxMs);
+  g_loraCmdCount = g_loraDoneLatency.count;
+  LOG_INFO("LoRa %.16s done in %lu ms", text, (unsigned long)(elapsedUs / 1000));
+}
+
+/**
+ * Split CMD:<c>[@<truck id>][#<path>]
+ * @return false if the packet is malformed or addressed to another unit
+ */
+bool parseLoRaCommand(const char* packet, size_t len, char& command, char& offloadPath, bool& addressed) {
+  if (len < 5 || strncmp(packet, "CMD:", 4) != 0) {
+    // Ignore malformed or unrelated packets to avoid serial spam.
+    return false;
+  }
+
+  command = packet[4];
+  offloadPath = OFFLOAD_PATH_AUTO;
+  addressed = false;
+
+  if (len > 5) {
+    const char* path = (const char*)memchr(packet + 5, '#', len - 5);
+    if (path != nullptr && path + 1 < packet + len) {
+      offloadPath = path[1];
+    }
+    if (packet[5] == '@') {
+      const char* target = packet + 6;
+      size_t targetLen = (path != nullptr ? path : packet + len) - target;
+      const char* ownId = unitId();
+      if (strlen(ownId) != targetLen || memcmp(target, ownId, targetLen) != 0) {
+        return false;  // Addressed to another unit
+      }
+      addressed = true;
+    } else if (packet[5] != '#') {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Broadcast commands every unit answers (q, p, n without @<id>): the reply
+ * waits up to BROADCAST_REPLY_JITTER_MS and is sent without an RSP:ACK
+ * first, so a yard of receivers does not answer all at once
+ */
+bool isJitteredBroadcast(char command, bool addressed) {
+  if (addressed) {
+    return false;
+  }
+  switch (command) {
+    case 'q': case 'Q':
+    case 'p': case 'P':
+    case 'n': case 'N':
+      return true;
+    default:
+      return false;
+  }
+}
+
+/**
+ * Decide where a received packet runs
+ */
+LoRaRoute routeLoRaPacket(const char* text, size_t len) {
+  if (strncmp(text, "CMD:", 4) == 0) {
+    char command;
+    char offloadPath;
+    bool addressed;
+    if (!parseLoRaCommand(text, len, command, offloadPath, addressed)) {
+      return LORA_ROUTE_IGNORE;
+    }
+    if (isJitteredBroadcast(command, addressed)) {
+      return LORA_ROUTE_WORKER;     // The reply delay must not hold up lora_rx
+    }
+    switch (command) {
+      case 'd': case 'D':
+      case 'c': case 'C':
+      case 'q': case 'Q':
+      case 'p': case 'P':
+        return LORA_ROUTE_WORKER;
+      case 'z': case 'Z':
+      case 'a': case 'A':
+        return LORA_ROUTE_LOOP;   // Sensors belong to loop()
+      default:
+        return LORA_ROUTE_INLINE;   // Addressed n, m and unsupported commands
+    }
+  }
+  if (strncmp(text, "TIME:", 5) == 0 || strncmp(text, "GET:", 4) == 0) {
+    return LORA_ROUTE_INLINE;
+  }
+  if (strcmp(text, "LIST") == 0 || strncmp(text, "LIST:", 5) == 0) {
+    return LORA_ROUTE_WORKER;       // One reply per parameter; read-only
+  }
+  return LORA_ROUTE_LOOP;           // SETUP:, SET: and anything else
+}
+
+/**
+ * Ack label for a queued packet: the command letter, or the packet keyword
+ */
+void loraAckLabel(const char* text, char* label, size_t labelSize) {
+  if (strncmp(text, "CMD:", 4) == 0) {
+    snprintf(label, labelSize, "%c", text[4]);
+    return;
+  }
+  size_t n = strcspn(text, ":");
+  snprintf(label, labelSize, "%.*s", (int)n, text);
+}
+
+void handleLoRaCommandPacket(const LoRaCommand& packet) {
+  char command;
+  char offloadPath;
+  bool addressed;
+  if (!parseLoRaCommand(packet.text, packet.len, command, offloadPath, addressed)) {
+    return;
+  }
 
-  char command = packet.charAt(4);
   Serial.printf("LoRa CMD received: %c\n", command);
 
+  if (isJitteredBroadcast(command, addressed)) {
+    delay(random(BROADCAST_REPLY_JITTER_MS));
+  }
+
+  if (command == 'q' || command == 'Q') {
+    sendQueueSummary();
+    return;
+  }
+
   if (command == 'd' || command == 'D') {
+    PerfLock perf(power);   // Wi-Fi session or LoRa stream at full clock
     sendLoRaMessage("RSP:BEGIN_D");
-    bool wifiOffloaded = startWifiLocalOffload();
+    bool wifiOffloaded = false;
+    if (offloadPath != OFFLOAD_PATH_LORA) {
+      wifiOffloaded = startWifiLocalOffload(offloadPath == OFFLOAD_PATH_SOFTAP);
+    }
     if (!wifiOffloaded) {
       // Wi-Fi unavailable — fall back to LoRa streaming
+      StorageLock storage;
+      unsigned long streamStart = millis();
+      uint32_t txBytesBefore = g_metLoraTxBytes.value();
       bool sentData = streamStoredEventsOverLoRa();
+      if (sentData) {
+        recordOffload(g_metLoraTxBytes.value() - txBytesBefore, millis() - streamStart);
+      }
       if (!sentData) {
         sendLoRaMessage("RSP:NO_DATA");
       }
@@ -639,20 +1618,37 @@ void handleLoRaCommandPacket(const String& packet) {
 
   if (command == 'n' || command == 'N') {
     // Unit discovery scan response
-    if (g_includeTruckId && g_truckId.length() > 0) {
-      sendLoRaMessage("RSP:ID:" + g_truckId);
-    } else {
-      sendLoRaMessage("RSP:ID:UNNAMED");
-    }
+    char reply[LORA_MAX_PACKET_SIZE];
+    snprintf(reply, sizeof(reply), "RSP:ID:%s", unitId());
+    sendLoRaMessage(reply);
     return;
   }
 
   if (command == 'z' || command == 'Z') {
-    bool tareSuccess = nau7802.tare(100);
-    if (tareSuccess) {
-      sendLoRaMessage("RSP:TARE_OK");
-    } else {
+    // Averaging 100 conversions takes ~5 s at 20 SPS; reply from serviceNau() when done
+    if (g_loraTarePending) {
+      return;   // Already running; its reply answers this request too
+    }
+    wakeSensors();
+    if (!nau7802.isReady() || diagnostics.labLogRunning()) {
       sendLoRaMessage("RSP:TARE_FAIL");
+      return;
+    }
+    if (!nau7802.isTaring()) {
+      nau7802.startBackgroundTare(LORA_TARE_SAMPLES);
+    }
+    g_loraTarePending = true;
+    g_loraTareRxUs = packet.rxUs;
+    return;
+  }
+
+  if (command == 'a' || command == 'A') {
+    // Acquisition self-benchmark: RSP:ACQ:<id>,lis=..,nau=..,pair=..,sd<n>=..,tx<n>=..,ok=..
+    char reply[LORA_MAX_PACKET_SIZE];
+    if (runAcquisitionBenchmark(reply, sizeof(reply))) {
+      sendLoRaMessage(reply);
+    } else {
+      sendLoRaMessage("RSP:ACQ_FAIL");
     }
     return;
   }
@@ -664,37 +1660,203 @@ void handleLoRaCommandPacket(const String& packet) {
     return;
   }
 
-  // Unsupported command for remote LoRa control.
-  sendLoRaMessage("RSP:ERR_UNSUPPORTED");
-}
+  if (command == 'm' || command == 'M') {
+    // Memory headroom: RSP:MEM:<id>,free=..,min=..,largest=..,frag=..,stack=..,pool_fail=..
+    char reply[LORA_MAX_PACKET_SIZE];
+    int n = snprintf(reply, sizeof(reply), "RSP:MEM:%s,", unitId());
+    memStatusSummary(reply + n, sizeof(reply) - n, "loopTask");
+    sendLoRaMessage(reply);
+    return;
+  }
 
-void processLoRaPackets() {
-  if (!loraPacketReceived) {
+  if (command == 'p' || command == 'P') {
+    // Metrics snapshot: RSP:MET:<id>,name=value,hist=count/p50/p90/max,... over as many packets as needed
+    char reply[LORA_MAX_PACKET_SIZE];
+    const Metric* next = Metric::first();
+    while (next != nullptr) {
+      snprintf(reply, sizeof(reply), "RSP:MET:%s,", unitId());
+      next = metricsPack(next, reply, sizeof(reply));
+      sendLoRaMessage(reply);
+    }
     return;
   }
 
-  loraPacketReceived = false;
-  String packet;
-  int rxState = loraRadio.readData(packet);
-  if (rxState == RADIOLIB_ERR_NONE) {
-    packet.trim();
-    if (packet.startsWith("CMD:") && packet.length() == 5) {
-      handleLoRaCommandPacket(packet);
-    } else if (packet.startsWith("TIME:")) {
-      handleLoRaTimeSyncPacket(packet);
-    } else if (packet.startsWith("SETUP:")) {
-      if (parseSetupPacket(packet)) {
-        applyConfiguration();
-        sendLoRaMessage("RSP:SETUP_OK");
-      } else {
-        sendLoRaMessage("RSP:SETUP_ERR");
-      }
+  // Unsupported command for remote LoRa control.
+  sendLoRaMessage("RSP:ERR_UNSUPPORTED");
+}
+
+/**
+ * Run one received packet to completion (or hand it to a background job)
+ */
+void executeLoRaPacket(const LoRaCommand& packet) {
+  TraceSpan span(TRACE_LORA_CMD);
+  span.setArg(packet.len);
+  const char* text = packet.text;
+  if (strncmp(text, "CMD:", 4) == 0) {
+    handleLoRaCommandPacket(packet);
+    if ((text[4] == 'z' || text[4] == 'Z') && g_loraTarePending) {
+      return;   // Completion is recorded when the tare finishes
+    }
+  } else if (strncmp(text, "TIME:", 5) == 0) {
+    handleLoRaTimeSyncPacket(text);
+  } else if (strncmp(text, "SETUP:", 6) == 0) {
+    if (parseSetupPacket(text, packet.len)) {
+      applyConfiguration();
+      sendLoRaMessage("RSP:SETUP_OK");
+    } else {
+      sendLoRaMessage("RSP:SETUP_ERR");
     }
   } else {
+    handleParamCommand(text, true);
+  }
+  recordLoRaDone(packet.rxUs, text);
+}
+
+/**
+ * NUL-terminate and trim whitespace from a received buffer in place
+ * @return start of the trimmed text; len is updated to its length
+ */
+const char* trimInPlace(char* buffer, size_t& len) {
+  size_t start = 0;
+  while (start < len && isspace((unsigned char)buffer[start])) {
+    start++;
+  }
+  while (len > start && isspace((unsigned char)buffer[len - 1])) {
+    len--;
+  }
+  buffer[len] = '\0';
+  len -= start;
+  return buffer + start;
+}
+
+/**
+ * Read the packet behind a DIO1 interrupt into command (radio back in RX on return)
+ * @return true if a non-empty packet was read
+ */
+bool readLoRaPacket(LoRaCommand& command) {
+  traceBegin(TRACE_LORA_RX);
+  xSemaphoreTake(g_radioMutex, portMAX_DELAY);
+  size_t len = loraRadio.getPacketLength();
+  if (len > LORA_MAX_PACKET_SIZE) {
+    len = LORA_MAX_PACKET_SIZE;
+  }
+  int rxState = loraRadio.readData((uint8_t*)command.text, len);
+  int restartState = loraRadio.startReceive();
+  xSemaphoreGive(g_radioMutex);
+  traceEnd(TRACE_LORA_RX, (rxState == RADIOLIB_ERR_NONE) ? len : 0);
+
+  if (restartState != RADIOLIB_ERR_NONE) {
+    Serial.printf("LoRa RX start failed (%d)\n", restartState);
+  }
+  if (rxState != RADIOLIB_ERR_NONE) {
     Serial.printf("LoRa RX read failed (%d)\n", rxState);
+    return false;
   }
+  const char* text = trimInPlace(command.text, len);
+  if (text != command.text) {
+    memmove(command.text, text, len + 1);
+  }
+  command.len = (uint16_t)len;
+  return len > 0;
+}
 
-  restartLoRaReceive();
+/**
+ * DIO1 task: read, then answer, or ack and queue
+ */
+void loraRxTask(void* arg) {
+  (void)arg;
+  static LoRaCommand command;   // 260 bytes kept off this task's stack
+
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    command.rxUs = g_loraIrqUs;
+    if (!readLoRaPacket(command)) {
+      continue;
+    }
+    noteActivity();
+
+    LoRaRoute route = routeLoRaPacket(command.text, command.len);
+    if (route == LORA_ROUTE_IGNORE) {
+      continue;
+    }
+    if (route == LORA_ROUTE_INLINE) {
+      executeLoRaPacket(command);
+      recordLoRaAck(command.rxUs);
+      continue;
+    }
+
+    char label[8];
+    char reply[24];
+    loraAckLabel(command.text, label, sizeof(label));
+    QueueHandle_t queue = (route == LORA_ROUTE_WORKER) ? g_loraWorkQueue : g_loraLoopQueue;
+    if (xQueueSend(queue, &command, 0) != pdTRUE) {
+      snprintf(reply, sizeof(reply), "RSP:BUSY:%s", label);
+      sendLoRaMessage(reply);
+      LOG_WARN("LoRa %s dropped: queue full", label);
+      continue;
+    }
+    // Broadcasts answer after a random delay; an ack from every unit would collide
+    char letter;
+    char offloadPath;
+    bool addressed;
+    if (parseLoRaCommand(command.text, command.len, letter, offloadPath, addressed) &&
+        isJitteredBroadcast(letter, addressed)) {
+      continue;
+    }
+    snprintf(reply, sizeof(reply), "RSP:ACK:%s", label);
+    sendLoRaMessage(reply);
+    recordLoRaAck(command.rxUs);
+  }
+}
+
+/**
+ * Worker for commands that walk the SD card or bring up Wi-Fi
+ */
+void loraCmdTask(void* arg) {
+  (void)arg;
+  static LoRaCommand command;
+
+  for (;;) {
+    if (xQueueReceive(g_loraWorkQueue, &command, portMAX_DELAY) == pdTRUE) {
+      g_loraWorkerBusy = true;
+      executeLoRaPacket(command);
+      g_loraWorkerBusy = false;
+      noteActivity();
+    }
+  }
+}
+
+/**
+ * Create the radio lock, queues and LoRa tasks (before DIO1 is attached)
+ */
+bool startLoRaTasks() {
+  g_loraWorkQueue = xQueueCreate(LORA_CMD_QUEUE_DEPTH, sizeof(LoRaCommand));
+  g_loraLoopQueue = xQueueCreate(LORA_CMD_QUEUE_DEPTH, sizeof(LoRaCommand));
+  if (g_loraWorkQueue == nullptr || g_loraLoopQueue == nullptr) {
+    Serial.println("LoRa: command queues could not be created");
+    return false;
+  }
+  if (xTaskCreatePinnedToCore(loraCmdTask, "lora_cmd", LORA_CMD_TASK_STACK, nullptr,
+                              LORA_CMD_TASK_PRIORITY, nullptr, LORA_TASK_CORE) != pdPASS ||
+      xTaskCreatePinnedToCore(loraRxTask, "lora_rx", LORA_RX_TASK_STACK, nullptr,
+                              LORA_RX_TASK_PRIORITY, &g_loraRxTask, LORA_TASK_CORE) != pdPASS) {
+    Serial.println("LoRa: command tasks could not be started");
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Run LoRa commands queued for loop() (tare, SETUP:, SET:)
+ */
+void processLoRaLoopCommands() {
+  static LoRaCommand command;
+  if (g_loraLoopQueue == nullptr || xQueueReceive(g_loraLoopQueue, &command, 0) != pdTRUE) {
+    return;
+  }
+  loraPacketProbe.begin();
+  executeLoRaPacket(command);
+  loraPacketProbe.end();
 }
 
 /**
@@ -708,24 +1870,30 @@ struct AccelSample {
   unsigned long timestamp;
 };
 
-#define BUFFER_SIZE 20
-AccelSample accelBuffer[BUFFER_SIZE];
-int bufferIndex = 0;
-bool bufferFilled = false;
+// Sized for the largest accel.buffer_size; g_accelBufferSize is the live depth.
+// In RTC memory so the pre-trigger history survives deep sleep.
+RTC_DATA_ATTR AccelSample accelBuffer[ACCEL_BUFFER_CAPACITY];
+RTC_DATA_ATTR int bufferIndex = 0;
+RTC_DATA_ATTR bool bufferFilled = false;
+
+void resetAccelBuffer() {
+  bufferIndex = 0;
+  bufferFilled = false;
+}
 
 // WiFi connection timeouts
 #define WIFI_CONNECT_TIMEOUT 10  // seconds
 #define NTP_SYNC_TIMEOUT 10      // seconds
 
 // Add sample to circular buffer
-void addToBuffer(float x, float y, float z) {
+void addToBuffer(float x, float y, float z, unsigned long timestamp) {
   accelBuffer[bufferIndex].x = x;
   accelBuffer[bufferIndex].y = y;
   accelBuffer[bufferIndex].z = z;
-  accelBuffer[bufferIndex].timestamp = millis();
+  accelBuffer[bufferIndex].timestamp = timestamp;
   
   bufferIndex++;
-  if (bufferIndex >= BUFFER_SIZE) {
+  if (bufferIndex >= (int)g_accelBufferSize) {
     bufferIndex = 0;
     bufferFilled = true;
   }
@@ -813,7 +1981,8 @@ bool syncTime() {
   
   Serial.println("Time synced successfully!");
   Serial.print("Current time: ");
-  Serial.println(getFormattedTime());
+  char timeText[TIME_TEXT_SIZE];
+  Serial.println(getFormattedTime(timeText, sizeof(timeText)));
   
   // Disconnect WiFi to save power
   WiFi.disconnect(true);
@@ -865,27 +2034,29 @@ bool setTimeManually(const char* dateTimeStr) {
   
   Serial.println("Time set successfully!");
   Serial.print("Current time: ");
-  Serial.println(getFormattedTime());
+  char timeText[TIME_TEXT_SIZE];
+  Serial.println(getFormattedTime(timeText, sizeof(timeText)));
   
   return true;
 }
 
 /**
- * Get formatted timestamp string
+ * Format the current time into buffer (TIME_TEXT_SIZE bytes is enough)
+ * @return buffer, for use directly in print calls
  */
-String getFormattedTime() {
+const char* getFormattedTime(char* buffer, size_t bufferSize) {
   struct tm timeinfo;
-  if (!getLocalTime(&timeinfo)) {
-    return "Time not set";
+  if (!getLocalTime(&timeinfo, 0)) {
+    snprintf(buffer, bufferSize, "Time not set");
+    return buffer;
   }
-  
-  char buffer[64];
-  strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S EST", &timeinfo);
-  return String(buffer);
+
+  strftime(buffer, bufferSize, "%Y-%m-%d %H:%M:%S EST", &timeinfo);
+  return buffer;
 }
 
 /**
- * Load truck identity from SD card at startup
+ * Load truck identity from the legacy SD text file (first-boot migration only)
  */
 void loadTruckInfoFromSd() {
   if (!sdCard.isInitialized() || !sdCard.fileExists("/truck info/truck_id.txt")) {
@@ -925,31 +2096,32 @@ void loadTruckInfoFromSd() {
  * Delete all event files from SD card
  */
 void deleteAllEventFiles() {
+  StorageLock storage;
   if (!sdCard.isInitialized()) {
-    Serial.println("SD card is not initialized. Cannot clear files.");
+    LOG_ERROR("SD card is not initialized. Cannot clear files.");
     return;
   }
 
   // Delete event files
   if (sdCard.fileExists("/events")) {
     if (sdCard.deleteAllFilesInDirectory("/events")) {
-      Serial.println("All event files deleted.");
+      LOG_INFO("All event files deleted.");
     } else {
-      Serial.println("Some event files could not be deleted.");
+      LOG_WARN("Some event files could not be deleted.");
     }
   } else {
-    Serial.println("No events directory found.");
+    LOG_INFO("No events directory found.");
   }
   
   // Delete lab-testing files
   if (sdCard.fileExists("/lab-testing")) {
     if (sdCard.deleteAllFilesInDirectory("/lab-testing")) {
-      Serial.println("All lab-testing files deleted.");
+      LOG_INFO("All lab-testing files deleted.");
     } else {
-      Serial.println("Some lab-testing files could not be deleted.");
+      LOG_WARN("Some lab-testing files could not be deleted.");
     }
   } else {
-    Serial.println("No lab-testing directory found.");
+    LOG_INFO("No lab-testing directory found.");
   }
 }
 
@@ -957,6 +2129,7 @@ void deleteAllEventFiles() {
  * Offload data: Playback events, resync time, and clear SD card
  */
 void offloadData() {
+  PerfLock perf(power);
   Serial.println("\n");
   Serial.println("========================================");
   Serial.println("        DATA OFFLOAD INITIATED");
@@ -972,96 +2145,135 @@ void offloadData() {
   // Step 3: Clear SD card
   Serial.println("\n--- Clearing SD Card ---");
   deleteAllEventFiles();
+  binlogFlush();
   
   Serial.println("\n========================================");
   Serial.println("        DATA OFFLOAD COMPLETE");
   Serial.println("========================================\n");
 }
 
+/**
+ * Paired accel + strain samples from samples[sampleCount] on, until
+ * event.duration_ms after captureStart or event.max_samples
+ * (captureEvent(), and the acquisition benchmark times it as is)
+ * @return the new sample count
+ */
+int capturePairs(EventLogger_Module::EventSample* samples, int sampleCount, unsigned long captureStart) {
+  while ((millis() - captureStart) < EVENT_CAPTURE_DURATION_MS && sampleCount < (int)g_eventMaxSamples) {
+    bool accelOk = readAccelTimed();
+    int i = sampleCount;
+
+    if (accelOk) {
+      samples[i].x = lis3dh.getX();
+      samples[i].y = lis3dh.getY();
+      samples[i].z = lis3dh.getZ();
+    } else {
+      samples[i].x = 0.0;
+      samples[i].y = 0.0;
+      samples[i].z = 0.0;
+    }
+
+    int32_t strainRaw = readStrainTimed();
+    int32_t strainZeroed = strainRaw - nau7802.getZeroOffset();
+    samples[i].strainMicro = toCalibratedMicrostrain(
+      nau7802.calculateStrain(strainZeroed, 3.3, 2.0));
+
+    sampleCount++;
+  }
+  return sampleCount;
+}
+
 /**
  * Event capture function
  * Called when accelerometer threshold is exceeded
  * FAST: Captures paired samples immediately, THEN formats and saves
  */
 void captureEvent(float triggerX, float triggerY, float triggerZ) {
+  PerfLock perf(power);   // Paired sampling and the SD write at full clock
   unsigned long captureStart = millis();
   
-  // Create temporary array to store samples during fast capture
-  EventLogger_Module::EventSample eventSamples[EVENT_MAX_SAMPLES];
+  // Pool block sized for the largest event.max_samples; keeps the loop task stack small
+  PoolBlock sampleBlock(g_samplePool);
+  if (!sampleBlock) {
+    LOG_ERROR("Sample pool busy, event not captured");
+    return;
+  }
+  EventLogger_Module::EventSample* eventSamples = sampleBlock.as<EventLogger_Module::EventSample>();
   int sampleCount = 1;
+  float peakG = max(fabsf(triggerX), max(fabsf(triggerY), fabsf(triggerZ)));
+  traceInstant(TRACE_TRIGGER, (uint32_t)(peakG * 1000.0f));
+  traceBegin(TRACE_CAPTURE);
+
+  // An idle unit has the strain gauge off and the accelerometer in low-power mode
+  wakeSensors();
   
   // Store trigger sample as first sample
   eventSamples[0].x = triggerX;
   eventSamples[0].y = triggerY;
   eventSamples[0].z = triggerZ;
-  int32_t triggerStrainRaw = nau7802.readRaw();
+  int32_t triggerStrainRaw = readStrainTimed();
   int32_t triggerStrainZeroed = triggerStrainRaw - nau7802.getZeroOffset();
   eventSamples[0].strainMicro = toCalibratedMicrostrain(
       nau7802.calculateStrain(triggerStrainZeroed, 3.3, 2.0));
   
-  Serial.printf("\n!!! EVENT TRIGGERED !!! Capturing for %d ms...", EVENT_CAPTURE_DURATION_MS);
+  LOG_INFO("!!! EVENT TRIGGERED !!! Capturing for %lu ms", EVENT_CAPTURE_DURATION_MS);
   
   // PAIRED CAPTURE: Collect accel + strain pairs for a fixed duration (1:1 pairing)
-  while ((millis() - captureStart) < EVENT_CAPTURE_DURATION_MS && sampleCount < EVENT_MAX_SAMPLES) {
-    bool accelOk = lis3dh.read();
-    int i = sampleCount;
+  sampleCount = capturePairs(eventSamples, sampleCount, captureStart);
 
-    if (accelOk) {
-      eventSamples[i].x = lis3dh.getX();
-      eventSamples[i].y = lis3dh.getY();
-      eventSamples[i].z = lis3dh.getZ();
-    } else {
-      eventSamples[i].x = 0.0;
-      eventSamples[i].y = 0.0;
-      eventSamples[i].z = 0.0;
-    }
-
-    int32_t strainRaw = nau7802.readRaw();
-    int32_t strainZeroed = strainRaw - nau7802.getZeroOffset();
-    eventSamples[i].strainMicro = toCalibratedMicrostrain(
-      nau7802.calculateStrain(strainZeroed, 3.3, 2.0));
-
-    sampleCount++;
-    Serial.print(".");
-  }
-
-  if (sampleCount >= EVENT_MAX_SAMPLES) {
-    Serial.print(" [MAX BUFFER REACHED]");
-  }
-  
   unsigned long captureTime = millis() - captureStart;
-  Serial.printf(" Done! (%lums)\n", captureTime);
+  traceEnd(TRACE_CAPTURE, sampleCount);
+  if (sampleCount >= (int)g_eventMaxSamples) {
+    LOG_WARN("Event capture hit max buffer (%d samples)", sampleCount);
+  }
+  LOG_INFO("Event captured: %d samples in %lums", sampleCount, captureTime);
   
   // NOW do the slow operations (SD card, formatting, etc.)
-  Serial.println("Saving to SD card...");
   unsigned long saveStart = millis();
+  traceBegin(TRACE_SAVE);
   
   // Read temperature and humidity
   float temp = 0.0, humidity = 0.0;
-  if (sht45.read()) {
+  if (readShtTimed()) {
     temp = sht45.getTemperature();
     humidity = sht45.getHumidity();
   }
   
   // Save CSV data row only (no header row)
-  String savedFilename;
+  char timeText[TIME_TEXT_SIZE];
+  char savedFilename[32] = "";
+  traceBegin(TRACE_SD_WRITE);
+  StorageLock storage;
+  unsigned long writeStart = millis();
   bool writeOk = eventLogger.saveEventCsv(eventSamples,
                                           sampleCount,
                                           temp,
                                           humidity,
-                                          getFormattedTime(),
+                                          getFormattedTime(timeText, sizeof(timeText)),
                                           nullptr,
-                                          &savedFilename);
+                                          savedFilename,
+                                          sizeof(savedFilename));
+  traceEnd(TRACE_SD_WRITE, writeOk);
+  traceEnd(TRACE_SAVE, writeOk);
   
   unsigned long saveTime = millis() - saveStart;
   unsigned long totalTime = millis() - captureStart;
+  g_metSdWriteMs.record(millis() - writeStart);
+  if (!writeOk) {
+    g_metSdWriteFail.add();
+  }
+  g_metCaptureMs.record(captureTime);
+  g_metSaveMs.record(saveTime);
+  g_metEvents.add();
   
+  g_rtc.eventsCaptured++;
+  noteActivity();
   if (writeOk) {
-    Serial.printf("Saved to: %s\n", savedFilename.c_str());
+    LOG_INFO("Saved to: %s", savedFilename);
   } else {
-    Serial.printf("Failed to save event file: %s\n", savedFilename.c_str());
+    LOG_ERROR("Failed to save event file: %s", savedFilename);
   }
-  Serial.printf("Capture: %lums, Save: %lums, Total: %lums\n\n", captureTime, saveTime, totalTime);
+  LOG_INFO("Capture: %lums, Save: %lums, Total: %lums", captureTime, saveTime, totalTime);
 }
 
 /**
@@ -1069,6 +2281,8 @@ void captureEvent(float triggerX, float triggerY, float triggerZ) {
  * Called during setup to show previous events
  */
 void playbackEvents() {
+  PerfLock perf(power);
+  StorageLock storage;
   if (!sdCard.isInitialized()) {
     Serial.println("SD card is not initialized. Cannot playback events.\n");
     return;
@@ -1087,27 +2301,151 @@ void playbackEvents() {
   }
 }
 
+/**
+ * Store the strain zero offset if it moved by more than NAU_ZERO_SAVE_DELTA
+ * Small drift between tares is not worth a flash write.
+ */
+void saveNauZeroOffset() {
+  int32_t zero = nau7802.getZeroOffset();
+  // 64-bit difference: two offsets at opposite ends of the int32 range would overflow
+  int64_t drift = (int64_t)zero - (int64_t)g_nauZeroOffset;
+  if (g_haveNauZero && drift >= -NAU_ZERO_SAVE_DELTA && drift <= NAU_ZERO_SAVE_DELTA) {
+    return;
+  }
+  g_nauZeroOffset = zero;
+  g_haveNauZero = true;
+  saveConfigToNvs();
+}
+
+/**
+ * Advance NAU7802 bring-up and background tare; call often, never blocks
+ * Caches every freshly measured calibration. On the first ready pass it
+ * also restores the last zero offset and starts the background tare.
+ */
+void serviceNau() {
+  bool ready = nau7802.service();
+  // A power-up after nau.gain or nau.rate_sps changed runs CALS once; later wakes restore the result
+  if (nau7802.takeNewCalibration()) {
+    g_nauCalibration = nau7802.getCalibration();
+    g_haveNauCalibration = true;
+    saveConfigToNvs();
+  }
+  if (ready && g_bootNauReadyMs == 0) {
+    g_bootNauReadyMs = millis();
+    LOG_INFO("NAU7802: Ready at %lu ms (%s calibration)", g_bootNauReadyMs,
+             nau7802.calibrationMeasured() ? "new" : "cached");
+    // Readings use the last stored zero until the background tare replaces it
+    if (g_haveNauZero) {
+      nau7802.setZeroOffset(g_nauZeroOffset);
+    }
+    // After a deep-sleep wake the gauge may be loaded (the trailer is moving); keep the stored zero
+    if (g_wakeReason == 0 || !g_haveNauZero) {
+      nau7802.startBackgroundTare(NAU_BOOT_TARE_SAMPLES);
+    }
+  }
+  if (nau7802.takeTareResult()) {
+    saveNauZeroOffset();
+    if (g_loraTarePending) {
+      g_loraTarePending = false;
+      sendLoRaMessage("RSP:TARE_OK");
+      recordLoRaDone(g_loraTareRxUs, "CMD:z");
+    }
+  } else if (g_loraTarePending && !nau7802.isTaring()) {
+    // Cancelled by a blocking tare or a lab log
+    g_loraTarePending = false;
+    sendLoRaMessage("RSP:TARE_FAIL");
+    recordLoRaDone(g_loraTareRxUs, "CMD:z");
+  }
+}
+
 void setup() {
   // Initialize Serial
   Serial.begin(SERIAL_BAUD_RATE);
-  delay(1000);
   Serial.println("\n\n=== Heltec Capstone Receiver Starting ===\n");
 
+  // A deep-sleep wake keeps counters, config and the accel history in RTC memory
+  esp_sleep_wakeup_cause_t wakeCause = esp_sleep_get_wakeup_cause();
+  if (wakeCause == ESP_SLEEP_WAKEUP_EXT0) {
+    g_wakeReason = 1;
+    g_rtc.motionWakes++;
+  } else if (wakeCause == ESP_SLEEP_WAKEUP_TIMER) {
+    g_wakeReason = 2;
+    g_rtc.timerWakes++;
+  } else {
+    memset(&g_rtc, 0, sizeof(g_rtc));
+  }
+  if (g_wakeReason != 0) {
+    Serial.printf("Wake from deep sleep (%s), sleep #%lu\n", g_wakeReason == 1 ? "motion" : "timer",
+                  g_rtc.sleepCount);
+  }
+
+  // Module log lines (LOG_*) are queued and printed from a core-0 task
+  binlogStartDrain(Serial, BINLOG_OUTPUT_MODE);
+
+  // Boot runs at the full clock; loop() drops to cpu.idle_mhz between samples
+  power.begin(PowerHooks{keepAwake, startNau, serviceNau, microstrainFromCounts, onLightSleepEnter, onLightSleepExit},
+              &g_rtc.energy, g_wakeReason != 0, LORA_DIO1);
+  diagnostics.begin(restoreNauGain, microstrainFromCounts, getFormattedTime, noteActivity);
+  WiFi.onEvent(onWifiEnergyEvent, ARDUINO_EVENT_WIFI_STA_START);
+  WiFi.onEvent(onWifiEnergyEvent, ARDUINO_EVENT_WIFI_STA_STOP);
+
+  // Allocation probes count the loop task only (Wi-Fi/LwIP tasks allocate on their own)
+  allocCounterWatchCurrentTask();
+
+  // Configuration comes from NVS so startup no longer waits on the SD card
+  // (from RTC memory after a deep-sleep wake)
+  bool configLoaded = (g_wakeReason != 0 && loadConfigFromRtc()) || loadConfigFromNvs();
+  power.applySettings();
+
+  // Initialize secondary I2C bus for external sensors
+  Serial.printf("\nInitializing I2C Sensor Bus (GPIO %d/%d @ %dkHz)...\n", 
+                I2C_SENSOR_SDA_PIN, I2C_SENSOR_SCL_PIN, I2C_SENSOR_FREQ/1000);
+  I2C_Sensors.begin(I2C_SENSOR_SDA_PIN, I2C_SENSOR_SCL_PIN, I2C_SENSOR_FREQ);
+  I2C_Sensors.setTimeout(I2C_TIMEOUT);
+  i2cProfilerName(NAU7802_I2C_ADDRESS, "NAU7802");
+  i2cProfilerName(LIS3DH_I2C_ADDRESS, "LIS3DH");
+  i2cProfilerName(SHT45_I2C_ADDRESS, "SHT45");
+  i2cProfilerName(OLED_I2C_ADDRESS, "OLED");
+
+  // Motion wake: the impact is in the LIS3DH FIFO; read it before anything else
+  if (g_wakeReason == 1) {
+    handleWakeSamples();
+  }
+
+  // The NAU7802 needs the longest to come up (power-up, LDO settle, calibration),
+  // so start it first and advance it between the other initializations
+  Serial.println("\nStarting NAU7802 ADC...");
+  NAU7802_Gain nauGain = NAU7802_GAIN_32;
+  NAU7802_SampleRate nauRate = NAU7802_SPS_20;
+  if (!nauGainSetting(nauGain)) {
+    LOG_WARN("NAU7802: gain %u not supported, using 32", g_nauGain);
+  }
+  if (!nauRateSetting(nauRate)) {
+    LOG_WARN("NAU7802: rate %u SPS not supported, using 20", g_nauRateSps);
+  }
+  startNau();
+  power.strainPoweredUp();
+
   Serial.println("Initializing LoRa radio...");
   int loraState = loraRadio.begin(LORA_FREQUENCY_MHZ,
-                                  LORA_BANDWIDTH_KHZ,
-                                  LORA_SPREADING_FACTOR,
-                                  LORA_CODING_RATE,
+                                  g_loraBandwidthKhz,
+                                  g_loraSpreadingFactor,
+                                  g_loraCodingRate,
                                   LORA_SYNC_WORD,
-                                  LORA_TX_POWER_DBM,
+                                  g_loraTxPowerDbm,
                                   LORA_PREAMBLE_LEN);
-  if (loraState == RADIOLIB_ERR_NONE) {
+  g_radioMutex = xSemaphoreCreateMutex();
+  g_storageMutex = xSemaphoreCreateRecursiveMutex();
+  if (loraState == RADIOLIB_ERR_NONE && startLoRaTasks()) {
     loraRadio.setDio1Action(setLoRaFlag);
     restartLoRaReceive();
     Serial.println("LoRa: OK");
+    power.setLoRaTxPower(g_loraTxPowerDbm);
   } else {
     Serial.printf("LoRa: FAILED (%d)\n", loraState);
+    power.energySetCurrent(ENERGY_LORA, ENERGY_LOW, 0.0f);
   }
+  serviceNau();
 
   // Initialize OLED Display - DISABLED for performance
   /*
@@ -1119,12 +2457,6 @@ void setup() {
   }
   */
   
-  // Initialize secondary I2C bus for external sensors
-  Serial.printf("\nInitializing I2C Sensor Bus (GPIO %d/%d @ %dkHz)...\n", 
-                I2C_SENSOR_SDA_PIN, I2C_SENSOR_SCL_PIN, I2C_SENSOR_FREQ/1000);
-  I2C_Sensors.begin(I2C_SENSOR_SDA_PIN, I2C_SENSOR_SCL_PIN, I2C_SENSOR_FREQ);
-  I2C_Sensors.setTimeout(I2C_TIMEOUT);
-  
   // Initialize SHT45 Temperature/Humidity Sensor
   Serial.println("\nInitializing SHT45 Sensor...");
   if (sht45.begin()) {
@@ -1132,41 +2464,49 @@ void setup() {
   } else {
     Serial.println("SHT45: FAILED");
   }
+  serviceNau();
   
   // Initialize LIS3DH Accelerometer
   Serial.println("\nInitializing LIS3DH Sensor...");
   if (lis3dh.begin()) {
     Serial.println("LIS3DH: OK");
+    power.accelPoweredUp();
   } else {
     Serial.println("LIS3DH: FAILED");
   }
 
-  // Initialize NAU7802 ADC for Strain Gauges
-  Serial.println("\nInitializing NAU7802 ADC...");
-  if (nau7802.begin()) {
-    Serial.println("NAU7802: OK");
-    
-    // Tare the ADC (zero it)
-    Serial.println("Taring strain gauge ADC");
-    nau7802.tare(200);
-    Serial.println("NAU7802: Ready for measurements");
-  } else {
-    Serial.println("NAU7802: FAILED");
-  }
+  serviceNau();
 
   // Initialize SD Card
   Serial.println();
   spiSD.begin(SDCARD_SCK, SDCARD_MISO, SDCARD_MOSI, SDCARD_CS);
   if (sdCard.begin()) {
-    // Load truck identity for LoRa discovery responses
-    loadTruckInfoFromSd();
-    // Load stored WiFi profiles for offload retries
-    loadWiFiProfilesFromSd();
-    // Playback previous events
-    playbackEvents();
+    if (!configLoaded) {
+      // One-time migration from the old SD text files
+      loadTruckInfoFromSd();
+      loadWiFiProfilesFromSd();
+      if (saveConfigToNvs()) {
+        Serial.println("[CFG] Migrated SD configuration to NVS");
+      }
+    }
+    // Stored events are no longer replayed at boot; 'd' prints them on demand
   } else {
     Serial.println("SD Card initialization failed. Events will not be saved.");
+    power.energySetCurrent(ENERGY_SD, ENERGY_LOW, 0.0f);   // No card drawing standby current
   }
+
+  // Usually only the first conversion is left by now; the tare finishes in loop()
+  unsigned long nauWaitStart = millis();
+  while (!nau7802.isReady() && !nau7802.hasFailed() && millis() - nauWaitStart < NAU_BOOT_WAIT_MS) {
+    serviceNau();
+    delay(1);
+  }
+  if (nau7802.hasFailed()) {
+    LOG_ERROR("NAU7802: FAILED");
+  } else if (!nau7802.isReady()) {
+    LOG_WARN("NAU7802: Not ready after %u ms, continuing in loop()", NAU_BOOT_WAIT_MS);
+  }
+  binlogFlush();
   
   Serial.println("\n=== Setup Complete ===");
   Serial.println("Monitoring accelerometer for threshold events...");
@@ -1184,8 +2524,420 @@ void setup() {
   Serial.println("  l - Lab test: Log strain readings to SD card (press any key to stop)");
   Serial.println("  b - Bridge balance and sensitivity test");
   Serial.println("  1-4 - Test with gain 1x, 2x, 4x, 8x (temporary)");
+  Serial.println("  h - Memory status: heap, stacks, pools, allocation counters, CPU clock");
+  Serial.println("  e - Energy ledger and projected battery life");
+  Serial.println("  p - Performance metrics: capture, SD, NAU7802, I2C, LoRa TX, offload");
+  Serial.println("  i - I2C bus profile per device and register since the last 'i'");
+  Serial.println("  x - Execution trace dump (#TR: lines for trace_convert), then start it over");
+  Serial.println("  k - Kernel microbenchmarks: CSV row, chunking, SETUP decode, median, strain, CRC");
+  Serial.println("  a - Acquisition self-benchmark: LIS3DH, NAU7802, paired capture, SD save, LoRa TX");
+  Serial.println("  GET:<name> / SET:<name>=<value> / LIST[:<prefix>] - Runtime parameters");
   Serial.println("-----------------------\n");
-  delay(2000);
+}
+
+// Tasks whose stack high-water 'h' reports (absent ones print "not running")
+const char* const kStatusTasks[] = {"loopTask", "lora_rx", "lora_cmd", "binlog", "tiT", "wifi", "esp_timer", "sys_evt"};
+
+/**
+ * Print heap, stack and pool headroom, then the heap allocation counters
+ * lora_rx covers command handling too, so a 'd' that opens a Wi-Fi session shows up as dirty.
+ */
+void printMemoryStatus() {
+  Serial.println("\n=== MEMORY STATUS ===");
+  memStatusPrint(Serial, kStatusTasks, sizeof(kStatusTasks) / sizeof(kStatusTasks[0]));
+  Serial.printf("Log ring: records=%lu dropped=%lu high water=%u/%u bytes\n",
+                (unsigned long)binlog().written(), (unsigned long)binlog().dropped(),
+                (unsigned)binlog().highWater(), (unsigned)BINLOG_RING_SIZE);
+  power.printCpuStatus();
+
+  if (!allocCounterActive()) {
+    Serial.println("Allocation counters disabled (build without ALLOC_COUNTER_HOOKS)");
+  } else {
+    AllocCounts total = allocCounterTotal();
+    AllocCounts watched = allocCounterWatched();
+    Serial.printf("Allocations, all tasks: allocs=%lu frees=%lu\n", (unsigned long)total.allocs, (unsigned long)total.frees);
+    Serial.printf("Allocations, loop task: allocs=%lu frees=%lu\n", (unsigned long)watched.allocs, (unsigned long)watched.frees);
+
+    char line[96];
+    const AllocProbe* probes[] = {&sampleProbe, &loraPacketProbe, &loraChunkProbe};
+    for (size_t i = 0; i < sizeof(probes) / sizeof(probes[0]); i++) {
+      probes[i]->format(line, sizeof(line));
+      Serial.println(line);
+    }
+  }
+  Serial.println("=====================\n");
+}
+
+// ===== KERNEL MICROBENCHMARKS =====
+// The per-sample and per-line code, timed with Shared/MicroBench. The same
+// command runs in the native build, so a board report and a Linux report
+// line up row for row (MicroBench/examples/bench_compare). Inputs vary per
+// iteration and come from a fixed generator, so runs are repeatable.
+
+const char kBenchSetupPacket[] =
+    "SETUP:si=100;m=127;thr=1.5;sr=20;dur=4000;ti=1;tid=TRAILER-0042;di=1;desc=Axle 2 left;"
+    "w0s=SiteNet;w0p=site-pass-1;w1s=Backup;w1p=backup-pass-2";
+const char kBenchTimestamp[] = "2026-01-01 12:00:00 EST";
+
+/**
+ * Run every kernel and print one report ('k'); takes a second or two with the loop held
+ */
+void runKernelBenchmarks() {
+  // Samples, a CSV row and the chunker's input share the sample pool block
+  PoolBlock block(g_samplePool);
+  if (!block) {
+    Serial.println("Sample pool busy (lab log running?), benchmarks not run");
+    return;
+  }
+  PerfLock perf(power);
+
+  EventLogger_Module::EventSample* samples = block.as<EventLogger_Module::EventSample>();
+  char* row = (char*)(samples + EVENT_SAMPLE_CAPACITY);
+  const size_t rowSize = EVENT_CSV_ROW_CAPACITY;
+  static_assert(EVENT_SAMPLE_CAPACITY * sizeof(EventLogger_Module::EventSample) + EVENT_CSV_ROW_CAPACITY <=
+                SAMPLE_POOL_BLOCK_BYTES, "benchmark buffers must fit one sample pool block");
+
+  uint32_t seed = 12345;
+  auto nextRandom = [&seed]() {
+    seed = seed * 1664525u + 1013904223u;
+    return seed;
+  };
+  for (int i = 0; i < EVENT_SAMPLE_CAPACITY; i++) {
+    samples[i].x = (int32_t)(nextRandom() % 4000) / 1000.0f - 2.0f;
+    samples[i].y = (int32_t)(nextRandom() % 4000) / 1000.0f - 2.0f;
+    samples[i].z = (int32_t)(nextRandom() % 4000) / 1000.0f - 1.0f;
+    samples[i].strainMicro = (int32_t)(nextRandom() % 200000) / 100.0f - 1000.0f;
+  }
+  int32_t rawValues[64];
+  for (int i = 0; i < 64; i++) {
+    rawValues[i] = (int32_t)(nextRandom() % 0x1000000) - 0x800000;
+  }
+
+  char title[MICROBENCH_LINE_MAX];
+  char line[MICROBENCH_LINE_MAX];
+  microBenchFormatHeader(getCpuFrequencyMhz(), title, sizeof(title), line, sizeof(line));
+  Serial.printf("\n%s\n%s\n", title, line);
+  auto report = [&line](const MicroBenchResult& result) {
+    microBenchFormat(result, line, sizeof(line));
+    Serial.println(line);
+    delay(1);   // Let lora_rx and the idle task run between kernels
+  };
+
+  uint32_t n = 0;
+  report(microBenchRun("csv_row_80", [&]() {
+    samples[0].x = (float)(n++ & 0xFF);
+    microBenchKeep(eventLogger.buildCsvDataRow(row, rowSize, samples, 80, 21.5f, 45.25f, kBenchTimestamp));
+  }));
+  report(microBenchRun("csv_row_200", [&]() {
+    samples[0].x = (float)(n++ & 0xFF);
+    microBenchKeep(eventLogger.buildCsvDataRow(row, rowSize, samples, EVENT_SAMPLE_CAPACITY, 21.5f, 45.25f,
+                                               kBenchTimestamp));
+  }));
+
+  // Header plus one 80-sample row, split into LoRa payloads as the LoRa offload does
+  static const char kHeader[] = "timestamp,temp_c,humidity,x,y,z,strain\n";
+  memcpy(row, kHeader, sizeof(kHeader) - 1);
+  size_t csvLen = sizeof(kHeader) - 1;
+  csvLen += eventLogger.buildCsvDataRow(row + csvLen, rowSize - csvLen, samples, 80, 21.5f, 45.25f, kBenchTimestamp);
+  CsvChunker<LORA_DATA_CHUNK_SIZE> chunker("timestamp,");
+  size_t chunkBytes = 0;
+  auto countChunk = [&chunkBytes](const char* data, size_t len, bool finalChunk) {
+    (void)data;
+    (void)finalChunk;
+    chunkBytes += len;
+  };
+  report(microBenchRun("csv_chunk_row_80", [&]() {
+    chunker.reset();
+    chunker.push(row, csvLen, countChunk);
+    chunker.finish(countChunk);
+    microBenchKeep(chunkBytes);
+  }));
+
+  size_t setupLen = strlen(kBenchSetupPacket);
+  SetupRequest request;
+  report(microBenchRun("setup_decode", [&]() {
+    microBenchKeep(decodeSetupPacket(kBenchSetupPacket, setupLen, request));
+    microBenchKeep(request);
+  }));
+
+  int32_t readings[25];
+  report(microBenchRun("median_sort_9", [&]() {
+    memcpy(readings, rawValues + (n++ & 31), 9 * sizeof(int32_t));
+    microBenchKeep(NAU7802_Module::medianOf(readings, 9));
+  }));
+  report(microBenchRun("median_sort_25", [&]() {
+    memcpy(readings, rawValues + (n++ & 31), 25 * sizeof(int32_t));
+    microBenchKeep(NAU7802_Module::medianOf(readings, 25));
+  }));
+
+  report(microBenchRun("strain_convert", [&]() {
+    int32_t zeroed = rawValues[n++ & 63] - nau7802.getZeroOffset();
+    microBenchKeep(toCalibratedMicrostrain(nau7802.calculateStrain(zeroed, 3.3, 2.0)));
+  }));
+
+  report(microBenchRun("sht45_crc", [&]() {
+    uint8_t data[2] = {(uint8_t)n, (uint8_t)(n >> 8)};
+    n++;
+    microBenchKeep(SHT45_Module::calculateCRC(data, 2));
+  }));
+
+  Serial.println("===============\n");
+}
+
+// ===== ACQUISITION SELF-BENCHMARK =====
+// What this board's hardware actually delivers against the rates the
+// capture depends on: LIS3DH reads back to back, NAU7802 conversions as
+// readRaw() returns them, captureEvent()'s own paired loop, an event save
+// at three sizes (file-number scan, CSV formatting, write) and LoRa packet
+// time against time on air. Run it on each hardware revision; serial gets
+// the table, CMD:a gets one RSP:ACQ: line back.
+
+const int kAcqSaveSizes[] = {20, EVENT_MAX_SAMPLES, EVENT_SAMPLE_CAPACITY};
+const size_t kAcqLoraSizes[] = {ACQ_BENCH_LORA_SHORT, 5 + LORA_DATA_CHUNK_SIZE};
+#define ACQ_SAVE_SIZE_COUNT  (sizeof(kAcqSaveSizes) / sizeof(kAcqSaveSizes[0]))
+#define ACQ_LORA_SIZE_COUNT  (sizeof(kAcqLoraSizes) / sizeof(kAcqLoraSizes[0]))
+
+struct AcqSaveResult {
+  size_t bytes;
+  float scanMs;       // getNextEventNumber() over /events as it is now
+  float formatMs;
+  float writeMs;
+  float maxMs;        // Slowest whole save
+};
+
+struct AcqLoraResult {
+  float avgMs;        // sendLoRaMessage(): radio lock, transmit, back to receive
+  float maxMs;
+  float airMs;
+};
+
+void printAcqRow(const char* name, const char* result, const char* target, bool ok, const char* detail) {
+  Serial.printf("%-18s %14s %14s  %-4s %s\n", name, result, target, ok ? "ok" : "FAIL", detail);
+}
+
+/**
+ * Measure, print the table and pack the LoRa line (RSP:ACQ:<id>,...)
+ * @return false if the sample pool is busy (lab log running)
+ */
+bool runAcquisitionBenchmark(char* summary, size_t summarySize) {
+  // Captured pairs, then the CSV row, share the sample pool block (same layout as 'k')
+  PoolBlock block(g_samplePool);
+  if (!block) {
+    Serial.println("Sample pool busy (lab log running?), acquisition benchmark not run");
+    return false;
+  }
+  PerfLock perf(power);
+  wakeSensors();
+
+  EventLogger_Module::EventSample* samples = block.as<EventLogger_Module::EventSample>();
+  char* row = (char*)(samples + EVENT_SAMPLE_CAPACITY);
+  const size_t rowSize = EVENT_CSV_ROW_CAPACITY;
+  const float targetRate = g_nauRateSps * ACQ_TARGET_RATE_PCT / 100.0f;
+  bool allOk = true;
+
+  // LIS3DH: as many reads as the bus allows
+  uint32_t accelReads = 0;
+  uint32_t accelFails = 0;
+  uint32_t startUs = micros();
+  while (micros() - startUs < ACQ_BENCH_WINDOW_MS * 1000UL) {
+    if (!readAccelTimed()) {
+      accelFails++;
+    }
+    accelReads++;
+  }
+  float accelHz = accelReads * 1e6f / (micros() - startUs);
+  delay(1);
+
+  // NAU7802: readRaw() waits for each conversion
+  uint32_t conversions = 0;
+  startUs = micros();
+  while (micros() - startUs < ACQ_BENCH_WINDOW_MS * 1000UL) {
+    readStrainTimed();
+    conversions++;
+  }
+  float nauHz = conversions * 1e6f / (micros() - startUs);
+
+  // captureEvent()'s paired loop, from a trigger sample like its own
+  unsigned long captureStart = millis();
+  readAccelTimed();
+  samples[0].x = lis3dh.getX();
+  samples[0].y = lis3dh.getY();
+  samples[0].z = lis3dh.getZ();
+  samples[0].strainMicro = toCalibratedMicrostrain(
+      nau7802.calculateStrain(readStrainTimed() - nau7802.getZeroOffset(), 3.3, 2.0));
+  startUs = micros();
+  int pairs = capturePairs(samples, 1, captureStart);
+  uint32_t pairUs = micros() - startUs;
+  unsigned long captureMs = millis() - captureStart;
+  float pairHz = (pairUs > 0) ? (pairs - 1) * 1e6f / pairUs : 0.0f;
+  for (int i = pairs; i < EVENT_SAMPLE_CAPACITY; i++) {
+    samples[i] = samples[i % pairs];
+  }
+
+  // Event saves: the steps of saveEventCsv(), timed one by one, to a scratch file
+  AcqSaveResult saves[ACQ_SAVE_SIZE_COUNT];
+  {
+    StorageLock storage;
+    char timeText[TIME_TEXT_SIZE];
+    getFormattedTime(timeText, sizeof(timeText));
+    for (size_t s = 0; s < ACQ_SAVE_SIZE_COUNT; s++) {
+      AcqSaveResult& result = saves[s];
+      memset(&result, 0, sizeof(result));
+      for (int repeat = 0; repeat < ACQ_BENCH_SAVE_REPEATS; repeat++) {
+        uint32_t t0 = micros();
+        microBenchKeep(sdCard.getNextEventNumber("/events", "event "));
+        uint32_t t1 = micros();
+        result.bytes = eventLogger.buildCsvDataRow(row, rowSize, samples, kAcqSaveSizes[s], 21.5f, 45.25f, timeText);
+        uint32_t t2 = micros();
+        if (result.bytes == 0 || !sdCard.writeFile(ACQ_BENCH_FILE, row, false)) {
+          g_metSdWriteFail.add();
+          allOk = false;
+        }
+        uint32_t t3 = micros();
+        sdCard.deleteFile(ACQ_BENCH_FILE);
+        result.scanMs += (t1 - t0) / 1000.0f / ACQ_BENCH_SAVE_REPEATS;
+        result.formatMs += (t2 - t1) / 1000.0f / ACQ_BENCH_SAVE_REPEATS;
+        result.writeMs += (t3 - t2) / 1000.0f / ACQ_BENCH_SAVE_REPEATS;
+        result.maxMs = max(result.maxMs, (t3 - t0) / 1000.0f);
+      }
+    }
+  }
+
+  // LoRa: probe packets the transmitter shows and ignores
+  AcqLoraResult lora[ACQ_LORA_SIZE_COUNT];
+  for (size_t s = 0; s < ACQ_LORA_SIZE_COUNT; s++) {
+    size_t len = kAcqLoraSizes[s];
+    memset(row, '.', len);
+    memcpy(row, "RSP:ACQ_PROBE:", 14);
+    AcqLoraResult& result = lora[s];
+    memset(&result, 0, sizeof(result));
+    result.airMs = loraRadio.getTimeOnAir(len) / 1000.0f;
+    for (int i = 0; i < ACQ_BENCH_LORA_PACKETS; i++) {
+      uint32_t t0 = micros();
+      if (!sendLoRaMessage((const uint8_t*)row, len)) {
+        allOk = false;
+      }
+      float ms = (micros() - t0) / 1000.0f;
+      result.avgMs += ms / ACQ_BENCH_LORA_PACKETS;
+      result.maxMs = max(result.maxMs, ms);
+    }
+  }
+
+  char name[24];
+  char result[24];
+  char target[24];
+  char detail[64];
+  Serial.printf("\n=== ACQUISITION BENCHMARK unit=%s cpu_mhz=%u nau_sps=%u ===\n", unitId(),
+                (unsigned)getCpuFrequencyMhz(), g_nauRateSps);
+  Serial.printf("%-18s %14s %14s  %-4s %s\n", "measure", "result", "target", "", "detail");
+
+  bool ok = accelHz >= (float)g_nauRateSps * ACQ_TARGET_ACCEL_FACTOR && accelFails == 0;
+  allOk &= ok;
+  snprintf(result, sizeof(result), "%.1f /s", accelHz);
+  snprintf(target, sizeof(target), ">= %u /s", g_nauRateSps * ACQ_TARGET_ACCEL_FACTOR);
+  snprintf(detail, sizeof(detail), "%.0f us/read, %lu failed", 1e6f / accelHz, (unsigned long)accelFails);
+  printAcqRow("lis3dh_read", result, target, ok, detail);
+
+  ok = nauHz >= targetRate;
+  allOk &= ok;
+  snprintf(result, sizeof(result), "%.1f /s", nauHz);
+  snprintf(target, sizeof(target), ">= %.1f /s", targetRate);
+  snprintf(detail, sizeof(detail), "%lu conversions", (unsigned long)conversions);
+  printAcqRow("nau7802_readRaw", result, target, ok, detail);
+
+  // A capture cut short by event.max_samples still shows its pair rate
+  ok = pairHz >= targetRate;
+  allOk &= ok;
+  snprintf(result, sizeof(result), "%.1f /s", pairHz);
+  snprintf(detail, sizeof(detail), "%d samples in %lu ms", pairs, captureMs);
+  printAcqRow("capture_pairs", result, target, ok, detail);
+
+  for (size_t s = 0; s < ACQ_SAVE_SIZE_COUNT; s++) {
+    const AcqSaveResult& save = saves[s];
+    float totalMs = save.scanMs + save.formatMs + save.writeMs;
+    // Only the largest event has a target; smaller ones show how the time scales
+    bool largest = (kAcqSaveSizes[s] == EVENT_SAMPLE_CAPACITY);
+    ok = !largest || save.maxMs <= ACQ_TARGET_SAVE_MS;
+    allOk &= ok;
+    snprintf(name, sizeof(name), "sd_save_%d", kAcqSaveSizes[s]);
+    snprintf(result, sizeof(result), "%.1f ms", totalMs);
+    snprintf(target, sizeof(target), largest ? "<= %u ms" : "-", ACQ_TARGET_SAVE_MS);
+    snprintf(detail, sizeof(detail), "%u B: scan %.1f, format %.1f, write %.1f, max %.1f", (unsigned)save.bytes,
+             save.scanMs, save.formatMs, save.writeMs, save.maxMs);
+    printAcqRow(name, result, target, ok, detail);
+  }
+
+  for (size_t s = 0; s < ACQ_LORA_SIZE_COUNT; s++) {
+    const AcqLoraResult& tx = lora[s];
+    float limitMs = tx.airMs * ACQ_TARGET_LORA_PCT / 100.0f;
+    ok = tx.avgMs <= limitMs;
+    allOk &= ok;
+    snprintf(name, sizeof(name), "lora_tx_%u", (unsigned)kAcqLoraSizes[s]);
+    snprintf(result, sizeof(result), "%.1f ms", tx.avgMs);
+    snprintf(target, sizeof(target), "<= %.1f ms", limitMs);
+    snprintf(detail, sizeof(detail), "air %.1f ms, max %.1f", tx.airMs, tx.maxMs);
+    printAcqRow(name, result, target, ok, detail);
+  }
+  Serial.printf("%s\n===============\n\n", allOk ? "PASS" : "FAIL");
+
+  int n = snprintf(summary, summarySize, "RSP:ACQ:%s,lis=%.0f,nau=%.1f,pair=%.1f", unitId(), accelHz, nauHz, pairHz);
+  for (size_t s = 0; s < ACQ_SAVE_SIZE_COUNT && n > 0 && (size_t)n < summarySize; s++) {
+    const AcqSaveResult& save = saves[s];
+    n += snprintf(summary + n, summarySize - n, ",sd%d=%.0f", kAcqSaveSizes[s],
+                  save.scanMs + save.formatMs + save.writeMs);
+  }
+  for (size_t s = 0; s < ACQ_LORA_SIZE_COUNT && n > 0 && (size_t)n < summarySize; s++) {
+    n += snprintf(summary + n, summarySize - n, ",tx%u=%.0f", (unsigned)kAcqLoraSizes[s], lora[s].avgMs);
+  }
+  if (n > 0 && (size_t)n < summarySize) {
+    snprintf(summary + n, summarySize - n, ",ok=%d", allOk ? 1 : 0);
+  }
+  return true;
+}
+
+// ===== SERIAL INPUT =====
+
+LineAssembler<SERIAL_LINE_MAX> serialLine(SERIAL_LINE_STARTS, SERIAL_LINE_IDLE_MS);
+
+/**
+ * Route one assembled serial line: SETUP packets, parameter commands, single-key commands
+ */
+void dispatchSerialLine(const char* line, size_t len) {
+  if (strncmp(line, "SETUP:", 6) == 0) {
+    if (parseSetupPacket(line, len)) {
+      applyConfiguration();
+      sendLoRaMessage("RSP:SETUP_OK");
+    } else {
+      Serial.println("SETUP parse error");
+    }
+    return;
+  }
+
+  if (handleParamCommand(line, false)) {
+    return;
+  }
+
+  if (len == 1) {
+    // Most single-key commands read the strain gauge
+    wakeSensors();
+    processSerialCommand(line[0]);
+    return;
+  }
+
+  Serial.printf("Unknown command: %s\n", line);
+}
+
+/**
+ * Take whatever serial bytes have arrived; dispatch at most one complete line
+ */
+void processSerialInput() {
+  if (Serial.available() > 0) {
+    g_lastSerialMs = millis();   // Holds off light sleep (see keepAwake())
+  }
+  if (serialLine.poll(Serial, millis(), SERIAL_POLL_MAX_BYTES)) {
+    noteActivity();
+    dispatchSerialLine(serialLine.line(), serialLine.length());
+  }
 }
 
 /**
@@ -1197,6 +2949,7 @@ void processSerialCommand(char command) {
     case 'C':
       Serial.println("\n=== CLEARING SD CARD ===");
       deleteAllEventFiles();
+      binlogFlush();
       Serial.println("=== SD CARD CLEARED ===\n");
       break;
       
@@ -1213,13 +2966,54 @@ void processSerialCommand(char command) {
     case 't':
     case 'T':
       Serial.print("Current time: ");
-      Serial.println(getFormattedTime());
+      {
+        char timeText[TIME_TEXT_SIZE];
+        Serial.println(getFormattedTime(timeText, sizeof(timeText)));
+      }
       break;
       
     case 'd':
     case 'D':
       playbackEvents();
       break;
+
+    case 'h':
+    case 'H':
+      printMemoryStatus();
+      break;
+
+    case 'e':
+    case 'E':
+      power.printEnergyStatus(g_rtc.sleepCount);
+      break;
+
+    case 'p':
+    case 'P':
+      printMetrics();
+      break;
+
+    case 'i':
+    case 'I':
+      printI2cProfile();
+      break;
+
+    case 'x':
+    case 'X':
+      printTrace();
+      break;
+
+    case 'k':
+    case 'K':
+      runKernelBenchmarks();
+      break;
+
+    case 'a':
+    case 'A':
+      {
+        char summary[LORA_MAX_PACKET_SIZE];
+        runAcquisitionBenchmark(summary, sizeof(summary));
+      }
+      break;
       
     case 'g':
     case 'G':
@@ -1276,16 +3070,7 @@ void processSerialCommand(char command) {
       
     case 'z':
     case 'Z':
-      {
-        Serial.println("\n=== TARING STRAIN GAUGE ===");
-        Serial.println("Taking 200 samples for tare...");
-        if (nau7802.tare(200)) {
-          Serial.println("Strain gauge zeroed successfully!");
-        } else {
-          Serial.println("Failed to zero strain gauge!");
-        }
-        Serial.println("===========================\n");
-      }
+      diagnostics.startTare(NAU_BOOT_TARE_SAMPLES);
       break;
       
     case 'r':
@@ -1293,6 +3078,7 @@ void processSerialCommand(char command) {
       {
         Serial.println("\n=== RESTARTING NAU7802 ===");
         nau7802.restartConversions();
+        binlogFlush();
         Serial.println("===========================\n");
       }
       break;
@@ -1301,272 +3087,26 @@ void processSerialCommand(char command) {
     case '2':
     case '3':
     case '4':
+      // Test different gain settings
       {
-        // Test different gain settings
-        NAU7802_Gain testGain;
-        int gainValue = 1;
-        
-        switch(command) {
-          case '1': testGain = NAU7802_GAIN_1; gainValue = 1; break;
-          case '2': testGain = NAU7802_GAIN_2; gainValue = 2; break;
-          case '3': testGain = NAU7802_GAIN_4; gainValue = 4; break;
-          case '4': testGain = NAU7802_GAIN_8; gainValue = 8; break;
-        }
-        
-        Serial.printf("\n=== TESTING GAIN %dx ===\n", gainValue);
-        nau7802.setGain(testGain);
-        delay(100);
-        
-        Serial.println("Taking 5 samples:");
-        for (int i = 0; i < 5; i++) {
-          int32_t raw = nau7802.readRaw();
-          float percent = (raw / 8388608.0) * 100.0;
-          Serial.printf("  Sample %d: %8ld (%.2f%% FS)", i+1, raw, percent);
-          if (raw >= 8388600 || raw <= -8388600) {
-            Serial.print(" ❌ SATURATED!");
-          }
-          Serial.println();
-          delay(100);
-        }
-        
-        // Restore gain to 128x
-        nau7802.setGain(NAU7802_GAIN_128);
-        Serial.println("\nGain restored to 128x");
-        Serial.println("===========================\n");
+        static const NAU7802_Gain kTestGains[] = {NAU7802_GAIN_1, NAU7802_GAIN_2, NAU7802_GAIN_4, NAU7802_GAIN_8};
+        diagnostics.startGainTest(kTestGains[command - '1']);
       }
       break;
       
     case 'm':
     case 'M':
-      {
-        Serial.println("\n=== CONTINUOUS STRAIN MONITORING ===");
-        Serial.println("[M_SESSION_START]");
-        Serial.println("Monitoring strain in real-time...");
-        Serial.println("Apply load to the strain gauge now!");
-        Serial.println("Press any key to stop.\n");
-        Serial.println("Time(s), SampleMs, Raw, Avg(20), Filtered(20), Zeroed, Strain(με)");
-        Serial.println("---------------------------------------------------------------------------------");
-
-        // Clear any pending serial bytes (e.g., newline after command input)
-        while (Serial.available()) {
-          Serial.read();
-        }
-        
-        unsigned long startTime = millis();
-        int sampleCount = 0;
-        
-        while (!Serial.available()) {
-          unsigned long sampleStart = millis();
-
-          // Use heavy averaging to reduce noise: 20 samples with outlier rejection
-          int32_t raw = nau7802.readRaw();
-          int32_t avg = nau7802.readAverage(20);      // Simple average
-          int32_t filtered = nau7802.readFiltered(20); // Outlier rejection
-          int32_t zeroed = filtered - nau7802.getZeroOffset(); // Apply tare offset
-          float strain = nau7802.calculateStrain(zeroed, 3.3, 2.0);
-          float microstrain = toCalibratedMicrostrain(strain);
-          
-          float elapsedTime = (millis() - startTime) / 1000.0;
-          unsigned long sampleMs = millis() - sampleStart;
-          
-          Serial.printf("%.2f, %8lu, %8ld, %8ld, %8ld, %8ld, %9.2f", 
-                       elapsedTime, sampleMs, raw, avg, filtered, zeroed, microstrain);
-          
-          // Add visual indicator for high strain
-          if (abs(microstrain) > 50) {
-            Serial.print(" ← STRAIN DETECTED!");
-          }
-          Serial.println();
-          
-          sampleCount++;
-          delay(100); // Small delay between readings
-        }
-        
-        // Clear the serial buffer
-        while (Serial.available()) Serial.read();
-        
-        Serial.println("---------------------------------------------------------------------------------");
-        Serial.printf("Monitoring stopped. Collected %d samples.\n", sampleCount);
-        Serial.println("[M_SESSION_END]");
-        Serial.println("===========================\n");
-      }
+      diagnostics.startMonitor();
       break;
       
     case 'b':
     case 'B':
-      {
-        Serial.println("\n=== BRIDGE BALANCE TEST ===");
-        Serial.println("Testing Wheatstone bridge configuration...\n");
-        
-        // Take multiple readings
-        Serial.println("Taking 10 raw ADC samples:");
-        int64_t sum = 0;
-        int32_t minVal = 2147483647;
-        int32_t maxVal = -2147483648;
-        
-        for (int i = 0; i < 10; i++) {
-          int32_t raw = nau7802.readRaw();
-          Serial.printf("  Sample %d: %8ld\n", i+1, raw);
-          sum += raw;
-          if (raw < minVal) minVal = raw;
-          if (raw > maxVal) maxVal = raw;
-          delay(50);
-        }
-        
-        int32_t avg = sum / 10;
-        int32_t range = maxVal - minVal;
-        float percentFS = (abs(avg) / 8388608.0) * 100.0;
-        
-        Serial.println("\n--- Analysis ---");
-        Serial.printf("Average:    %ld\n", avg);
-        Serial.printf("Min:        %ld\n", minVal);
-        Serial.printf("Max:        %ld\n", maxVal);
-        Serial.printf("Range:      %ld (noise)\n", range);
-        Serial.printf("% Full Scale: %.2f%%\n", percentFS);
-        
-        Serial.println("\n--- Bridge Status ---");
-        if (abs(avg) < 100000) {
-          Serial.println("✓ Bridge is well balanced!");
-        } else if (abs(avg) < 1000000) {
-          Serial.println("⚠ Bridge has moderate offset (normal)");
-        } else if (abs(avg) < 4000000) {
-          Serial.println("⚠ Bridge has large offset (acceptable)");
-        } else {
-          Serial.println("❌ Bridge severely unbalanced or gain too high!");
-        }
-        
-        if (range < 1000) {
-          Serial.println("✓ Low noise - good signal quality");
-        } else if (range < 10000) {
-          Serial.println("⚠ Moderate noise");
-        } else {
-          Serial.println("❌ High noise - check connections!");
-        }
-        
-        Serial.println("\n--- Sensitivity Test ---");
-        Serial.println("Now apply a small load and watch for changes...");
-        Serial.println("Monitoring for 5 seconds:");
-        
-        int32_t baseline = nau7802.readAverage(10);
-        Serial.printf("Baseline (no load): %ld\n\n", baseline);
-        
-        for (int i = 0; i < 50; i++) {
-          int32_t current = nau7802.readRaw();
-          int32_t delta = current - baseline;
-          Serial.printf("  t=%.1fs: %8ld (Δ=%+8ld)", i * 0.1, current, delta);
-          
-          if (abs(delta) > 1000) {
-            Serial.print(" ← CHANGE DETECTED!");
-          }
-          Serial.println();
-          delay(100);
-        }
-        
-        Serial.println("\n===========================\n");
-      }
+      diagnostics.startBridge();
       break;
       
     case 'l':
     case 'L':
-      {
-        Serial.println("\n=== LAB TEST: CONTINUOUS STRAIN LOGGING ===");
-        Serial.printf("Sample Rate: %d Hz\n", LAB_TEST_SAMPLE_RATE_HZ);
-        Serial.println("[LOG_START]");
-        Serial.println("Recording raw strain gauge data...");
-        Serial.println("Apply load now. Press any key to stop.\n");
-        Serial.println("Time(s), Raw, Zeroed, Strain(με)");
-        Serial.println("---------------------------------------");
-        
-        // Clear any pending serial bytes
-        while (Serial.available()) {
-          Serial.read();
-        }
-        
-        // Allocate dynamic array for storing samples (max 10000 samples = ~16 minutes at 10Hz)
-        const int MAX_SAMPLES = 10000;
-        struct StrainSample {
-          float time;
-          int32_t raw;
-          int32_t zeroed;
-          float microstrain;
-        };
-        
-        StrainSample* samples = new StrainSample[MAX_SAMPLES];
-        
-        unsigned long startTime = millis();
-        int sampleCount = 0;
-        int sampleDelay = 1000 / LAB_TEST_SAMPLE_RATE_HZ; // Calculate delay from sample rate
-        
-        // Fast data acquisition loop - NO SD card writes!
-        while (!Serial.available() && sampleCount < MAX_SAMPLES) {
-          // Read RAW value only - fastest method
-          int32_t raw = nau7802.readRaw();
-          int32_t zeroed = raw - nau7802.getZeroOffset();
-          float strain = nau7802.calculateStrain(zeroed, 3.3, 2.0);
-          float microstrain = toCalibratedMicrostrain(strain);
-          float elapsedTime = (millis() - startTime) / 1000.0;
-          
-          // Store in memory
-          samples[sampleCount].time = elapsedTime;
-          samples[sampleCount].raw = raw;
-          samples[sampleCount].zeroed = zeroed;
-          samples[sampleCount].microstrain = microstrain;
-          
-          // Display to serial
-          Serial.printf("%.2f, %8ld, %8ld, %9.2f\n", elapsedTime, raw, zeroed, microstrain);
-          
-          sampleCount++;
-          delay(sampleDelay); // Delay based on LAB_TEST_SAMPLE_RATE_HZ
-        }
-        
-        // Clear the serial buffer
-        while (Serial.available()) Serial.read();
-        
-        Serial.println("---------------------------------------");
-        Serial.printf("Monitoring stopped. Collected %d samples.\n", sampleCount);
-        Serial.println("\nSaving to SD card...");
-        
-        // NOW save everything to SD card
-        int logNumber = sdCard.getNextEventNumber("/lab-testing", "strain-log");
-        char filename[64];
-        snprintf(filename, sizeof(filename), "/lab-testing/strain-log%d.txt", logNumber);
-        
-        // Build complete file content
-        String fileContent;
-        fileContent.reserve(sampleCount * 50 + 512); // Pre-allocate memory
-        
-        // Header
-        fileContent = "=== STRAIN GAUGE LAB TEST LOG " + String(logNumber) + " ===\n";
-        fileContent += "Timestamp: " + getFormattedTime() + "\n";
-        fileContent += "Sample Rate: " + String(LAB_TEST_SAMPLE_RATE_HZ) + " Hz\n";
-        fileContent += "Gain: 32x\n";
-        fileContent += "Samples: " + String(sampleCount) + "\n";
-        fileContent += "Duration: " + String((millis() - startTime) / 1000.0) + " seconds\n";
-        fileContent += "\nTime(s), Raw, Zeroed, Strain(με)\n";
-        fileContent += "---------------------------------------\n";
-        
-        // All data samples
-        for (int i = 0; i < sampleCount; i++) {
-          char line[64];
-          snprintf(line, sizeof(line), "%.2f, %ld, %ld, %.2f\n",
-                   samples[i].time, samples[i].raw, samples[i].zeroed, samples[i].microstrain);
-          fileContent += line;
-        }
-        
-        // Footer
-        fileContent += "---------------------------------------\n";
-        fileContent += "[LOG_END]\n";
-        
-        // Write entire file at once
-        sdCard.writeFile(filename, fileContent.c_str(), false);
-        
-        Serial.printf("Data saved to: %s\n", filename);
-        Serial.println("[LOG_END]");
-        Serial.println("===========================\n");
-        
-        // Free memory
-        delete[] samples;
-      }
+      diagnostics.startLabLog(LAB_TEST_SAMPLE_RATE_HZ, g_nauGain);
       break;
       
     default:
@@ -1575,50 +3115,252 @@ void processSerialCommand(char command) {
   }
 }
 
-void loop() {
-  // Handle incoming command packets from transmitter
-  processLoRaPackets();
+// ===== DEEP SLEEP =====
+// Parked trailers spend most of their life idle. With sleep.enable set the
+// unit deep-sleeps after sleep.idle_s with nothing to do. The LIS3DH keeps
+// sampling at 50 Hz in low-power mode: its INT1 wakes the ESP32 on motion and
+// its FIFO still holds the impact when setup() reads it. The RTC timer wakes
+// the unit every sleep.timer_s to listen for LoRa commands.
 
-  // Check for serial commands and setup packets
-  if (Serial.available() > 0) {
-    if (Serial.peek() == 'S') {
-      String setupLine = Serial.readStringUntil('\n');
-      setupLine.trim();
-
-      if (setupLine.startsWith("SETUP:")) {
-        if (parseSetupPacket(setupLine)) {
-          applyConfiguration();
-          sendLoRaMessage("RSP:SETUP_OK");
-        } else {
-          Serial.println("SETUP parse error");
-        }
-        return;
-      }
+// Strongest FIFO sample of a motion wake; captured once the NAU7802 is up
+bool g_wakeTriggerPending = false;
+float g_wakeTrigger[3] = {0, 0, 0};
 
-      if (setupLine.length() == 1) {
-        processSerialCommand(setupLine.charAt(0));
-        return;
-      }
+void noteActivity() {
+  g_lastActivityMs = millis();
+}
+
+/**
+ * Motion wake: move the LIS3DH FIFO (the samples around the wake) into the
+ * pre-trigger buffer before lis3dh.begin() resets it
+ */
+void handleWakeSamples() {
+  static float x[WAKE_FIFO_SAMPLES];
+  static float y[WAKE_FIFO_SAMPLES];
+  static float z[WAKE_FIFO_SAMPLES];
+
+  uint8_t count = lis3dh.readFifo(x, y, z, WAKE_FIFO_SAMPLES);
+  lis3dh.clearMotionInterrupt();
+  unsigned long now = millis();
+  if (count == 0) {
+    LOG_WARN("Wake: motion, but the LIS3DH FIFO is empty");
+    return;
+  }
+
+  float peak = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    addToBuffer(x[i], y[i], z[i], now - (unsigned long)(count - 1 - i) * WAKE_FIFO_PERIOD_MS);
+    float axisPeak = max(fabsf(x[i]), max(fabsf(y[i]), fabsf(z[i])));
+    if (axisPeak > peak) {
+      peak = axisPeak;
+      g_wakeTrigger[0] = x[i];
+      g_wakeTrigger[1] = y[i];
+      g_wakeTrigger[2] = z[i];
     }
+  }
+  g_wakeTriggerPending = peak > ACCEL_THRESHOLD;
+  g_bootFirstSampleMs = now;
+  LOG_INFO("Wake: motion, %u FIFO samples at %lu ms, peak %.2f g%s", count, now, peak,
+           g_wakeTriggerPending ? " (event)" : "");
+}
 
-    char command = Serial.read();
-    processSerialCommand(command);
+/**
+ * Sleep once nothing has happened for sleep.idle_s and no work is in flight
+ */
+void serviceSleep() {
+  if (!g_sleepEnabled || workInFlight() || nau7802.isTaring() || serialLine.pending()) {
+    return;
   }
+  if ((g_loraWorkQueue != nullptr && uxQueueMessagesWaiting(g_loraWorkQueue) > 0) ||
+      (g_loraLoopQueue != nullptr && uxQueueMessagesWaiting(g_loraLoopQueue) > 0)) {
+    return;
+  }
+  if (millis() - g_lastActivityMs < g_sleepIdleSec * 1000UL) {
+    return;
+  }
+  enterDeepSleep();
+}
+
+/**
+ * Save state to RTC memory, power down the sensors and radio, arm the wake
+ * sources and deep sleep. Does not return: a wake boots through setup().
+ */
+void enterDeepSleep() {
+  LOG_INFO("Sleep: idle %u s; wake on %.2f g or in %u s", g_sleepIdleSec, g_sleepWakeG, g_sleepTimerSec);
+
+  // Config rides along in RTC memory so the wake skips NVS (written only if it changed)
+  saveConfigToNvs();
+  g_rtc.configLen = configStore.snapshot(g_rtc.configImage, sizeof(g_rtc.configImage));
+  g_rtc.configSlot = configStore.activeSlot();
+  g_rtc.sleepCount++;
+  power.retainEnergy();
+  g_rtc.magic = RTC_STATE_MAGIC;
+
+  // Held through the sleep: nothing may touch the radio once it is down
+  xSemaphoreTake(g_radioMutex, portMAX_DELAY);
+  loraRadio.clearDio1Action();
+  loraRadio.sleep();
+
+  nau7802.powerDown();
+  if (lis3dh.enableMotionWake(g_sleepWakeG, SLEEP_WAKE_DURATION)) {
+    rtc_gpio_pullup_dis((gpio_num_t)LIS3DH_INT1_PIN);
+    rtc_gpio_pulldown_en((gpio_num_t)LIS3DH_INT1_PIN);
+    esp_sleep_enable_ext0_wakeup((gpio_num_t)LIS3DH_INT1_PIN, 1);
+  } else {
+    LOG_WARN("Sleep: no LIS3DH, timer wake only");
+  }
+  esp_sleep_enable_timer_wakeup((uint64_t)g_sleepTimerSec * 1000000ULL);
+
+  binlogFlush();
+  Serial.flush();
+  esp_deep_sleep_start();
+}
+
+// ===== POWER AND DIAGNOSTICS GLUE =====
+// Power_Module and Diagnostics_Module reach the rest of the firmware through these.
+
+/**
+ * Bring the sensors to full power before a measurement that cannot wait for
+ * loop(): events, serial commands, LoRa tare
+ * @return true if the strain gauge is ready
+ */
+bool wakeSensors() {
+  noteActivity();
+  return power.wakeSensors(NAU_BOOT_WAIT_MS);
+}
+
+/**
+ * Start the NAU7802 with nau.gain and nau.rate_sps (32x and 20 SPS if unsupported)
+ * Cached calibration: no CALS, so power-up is PUR + LDO settle + first conversion
+ */
+void startNau() {
+  NAU7802_Gain gain = NAU7802_GAIN_32;
+  NAU7802_SampleRate rate = NAU7802_SPS_20;
+  nauGainSetting(gain);
+  nauRateSetting(rate);
+  nau7802.beginAsync(gain, rate, g_haveNauCalibration ? &g_nauCalibration : nullptr);
+}
+
+/**
+ * Put nau.gain back after a gain test
+ */
+unsigned int restoreNauGain() {
+  programNauGain();
+  return g_nauGain;
+}
+
+float microstrainFromCounts(int32_t zeroed) {
+  return toCalibratedMicrostrain(nau7802.calculateStrain(zeroed, 3.3, 2.0));
+}
+
+/**
+ * A command, tare, event or diagnostic mode is under way (holds off both sleeps)
+ */
+bool workInFlight() {
+  return diagnostics.isActive() || g_wakeTriggerPending || g_loraTarePending || g_loraWorkerBusy;
+}
+
+/**
+ * Anything a light sleep would stall: work in flight, serial input, a radio
+ * transmission, queued LoRa work, Wi-Fi
+ */
+bool keepAwake() {
+  if (workInFlight() || g_loraTransmitting || serialLine.pending()) {
+    return true;
+  }
+  if ((g_loraWorkQueue != nullptr && uxQueueMessagesWaiting(g_loraWorkQueue) > 0) ||
+      (g_loraLoopQueue != nullptr && uxQueueMessagesWaiting(g_loraLoopQueue) > 0)) {
+    return true;
+  }
+  if (Serial.available() > 0 || millis() - g_lastSerialMs < LIGHT_SLEEP_SERIAL_HOLD_MS) {
+    return true;
+  }
+  return WiFi.getMode() != WIFI_OFF;
+}
+
+uint32_t g_sleepIrqUs = 0;   // g_loraIrqUs when the light sleep began
+
+void onLightSleepEnter() {
+  g_sleepIrqUs = g_loraIrqUs;
+  traceBegin(TRACE_LIGHT_SLEEP);
+}
+
+void onLightSleepExit(bool gpioWake) {
+  traceEnd(TRACE_LIGHT_SLEEP);
+  // DIO1 is level-triggered while asleep; hand the packet to lora_rx unless its ISR already did
+  if (gpioWake && g_loraIrqUs == g_sleepIrqUs && digitalRead(LORA_DIO1) == HIGH && !g_loraTransmitting &&
+      g_loraRxTask != nullptr) {
+    g_loraIrqUs = micros();
+    xTaskNotifyGive(g_loraRxTask);
+  }
+}
+
+// Wi-Fi driver start/stop (sys_evt task): covers offload sessions and NTP sync
+void onWifiEnergyEvent(arduino_event_id_t event) {
+  power.energyEnter(ENERGY_WIFI, event == ARDUINO_EVENT_WIFI_STA_START ? ENERGY_HIGH : ENERGY_LOW);
+}
+
+// Start of the last acquisition pass (SENSOR_READ_INTERVAL apart)
+unsigned long lastSampleMs = 0;
+
+void loop() {
+  // Handle incoming command packets from transmitter
+  processLoRaLoopCommands();
+  applyPendingLoRaConfig();
+  serviceNau();
+
+  // Event from the FIFO samples of a motion wake, once the strain gauge can be read
+  if (g_wakeTriggerPending && (nau7802.isReady() || nau7802.hasFailed())) {
+    g_wakeTriggerPending = false;
+    if (!diagnostics.labLogRunning()) {
+      captureEvent(g_wakeTrigger[0], g_wakeTrigger[1], g_wakeTrigger[2]);
+    }
+  }
+
+  // A running diagnostic mode takes serial input as its stop key
+  if (!diagnostics.service()) {
+    processSerialInput();
+  }
+  // Work in progress counts as activity for the power policy
+  if (workInFlight() || nau7802.isTaring()) {
+    noteActivity();
+  }
+  power.service(g_lastActivityMs);
+  serviceSleep();
+
+  // Acquisition runs on its own schedule; between samples loop() only services the above
+  unsigned long now = millis();
+  if (now - lastSampleMs < SENSOR_READ_INTERVAL) {
+    power.idleUntil(lastSampleMs + SENSOR_READ_INTERVAL);
+    return;
+  }
+  lastSampleMs = now;
   
-  // Read temperature and humidity
+  sampleProbe.begin();
+
+  // Read temperature and humidity on the power policy's schedule (captureEvent() reads its own)
   float temp = 0.0, humidity = 0.0;
-  sht45.read(); // Read even if it fails, will use default values
+  if (power.shtDue(now)) {
+    unsigned long shtStartUs = micros();
+    readShtTimed(); // Read even if it fails, will use default values
+    power.addShtBusy((micros() - shtStartUs + 500) / 1000);
+  }
   temp = sht45.getTemperature();
   humidity = sht45.getHumidity();
   
   // Read accelerometer
-  if (lis3dh.read()) {
+  if (readAccelTimed()) {
     float accelX = lis3dh.getX();
     float accelY = lis3dh.getY();
     float accelZ = lis3dh.getZ();
+    if (g_bootFirstSampleMs == 0) {
+      g_bootFirstSampleMs = millis();
+      LOG_INFO("Boot: first sample at %lu ms (NAU7802 ready at %lu ms)", g_bootFirstSampleMs, g_bootNauReadyMs);
+    }
     
     // Add current reading to circular buffer
-    addToBuffer(accelX, accelY, accelZ);
+    addToBuffer(accelX, accelY, accelZ, millis());
+    sampleProbe.end();
     
     // OLED update - DISABLED for performance
     /*
@@ -1635,13 +3377,13 @@ void loop() {
         abs(accelZ) > ACCEL_THRESHOLD) {
       
       // Trigger event capture - will read from the buffer (contains recent history)
-      captureEvent(accelX, accelY, accelZ);
+      // (skipped while a lab log holds the sample pool block)
+      if (!diagnostics.labLogRunning()) {
+        captureEvent(accelX, accelY, accelZ);
+      }
     }
-    
-    // Delay for loop timing - gives display time to refresh
-    delay(SENSOR_READ_INTERVAL);
   } else {
+    sampleProbe.end();
     Serial.println("Failed to read LIS3DH!");
-    delay(SENSOR_READ_INTERVAL);
   }
 }
\ No newline at end of file
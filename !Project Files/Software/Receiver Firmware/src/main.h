@@ -21,6 +21,15 @@
 #include <WiFi.h>       // WiFi Library
 #include <Wire.h>       // I2C Library
 #include <time.h>       // Time library for NTP
+#include <freertos/FreeRTOS.h>  // LoRa RX/command tasks
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <esp_sleep.h>    // Deep sleep and wake sources
+#include <driver/rtc_io.h>
+#include <driver/gpio.h>     // Light sleep wake sources (LoRa DIO1, UART)
+#include <driver/uart.h>
+#include <esp_timer.h>
 //#include <chrono>       // Advanced Time Library - Commented out due to conflicts
 //#include <Packet.h>     // Custom Packet Library
 
@@ -31,6 +40,25 @@
 #include "SDCard_Module.h"
 #include "NAU7802_Module.h"
 #include "EventLogger_Module.h"
+#include "Power_Module.h"
+#include "Diagnostics_Module.h"
+#include "SetupTokenizer.h"
+#include "ConfigStore.h"
+#include "ParamRegistry.h"
+#include "CsvChunker.h"
+#include "AllocCounter.h"
+#include "BinLogDrain.h"
+#include "StaticPool.h"
+#include "MemStatus.h"
+#include "LineAssembler.h"
+#include "PowerPolicy.h"
+#include "TimeInState.h"
+#include "EnergyMeter.h"
+#include "Metrics.h"
+#include "I2CProfiler.h"
+#include "TraceRing.h"
+#include "MicroBench.h"
+#include "OffloadLink.h"     // Event row limits and SoftAP credential rules, shared with the transmitter
 
 
 /**
@@ -46,6 +74,8 @@
 #define SHT45_I2C_ADDRESS   0x44    // SHT45 temperature/humidity sensor address
 #define LIS3DH_I2C_ADDRESS  0x18    // LIS3DH accelerometer address
 #define NAU7802_I2C_ADDRESS 0x2A    // NAU7802 ADC address (default)
+#define OLED_I2C_ADDRESS    0x3C    // SSD1306 on the board's own I2C bus (Wire)
+#define LIS3DH_INT1_PIN     7       // LIS3DH INT1 (motion wake); must be an RTC GPIO (0-21)
 
 // SD Card SPI Pin Definitions
 #define SDCARD_MOSI         34      // SD card MOSI pin (Brown wire)
@@ -59,7 +89,7 @@
 #define LORA_RST            12
 #define LORA_BUSY           13
 
-// LoRa Radio Link Configuration
+// LoRa Radio Link Configuration (SF/BW/CR/power are defaults; tunable via lora.* parameters)
 #define LORA_FREQUENCY_MHZ  915.0
 #define LORA_BANDWIDTH_KHZ  125.0
 #define LORA_SPREADING_FACTOR 9
@@ -68,20 +98,76 @@
 #define LORA_TX_POWER_DBM   14
 #define LORA_PREAMBLE_LEN   8
 #define LORA_DATA_CHUNK_SIZE 180
+#define LORA_MAX_PACKET_SIZE 256    // SX1262 FIFO; RX/TX packets are assembled in buffers this size
 
 // Serial Configuration
 #define SERIAL_BAUD_RATE    115200  // Serial monitor baud rate
+#define BINLOG_OUTPUT_MODE  BINLOG_OUTPUT_TEXT  // BINLOG_OUTPUT_FRAMES: decode on the PC with Shared/BinLog/examples/binlog_decode
 
-// ===== CONFIGURABLE RUNTIME PARAMETERS (can be updated via CFG packets) =====
+// ===== CONFIGURABLE RUNTIME PARAMETERS (SETUP packets and GET:/SET:/LIST:) =====
 // These are declared as extern globals and defined in main.cpp
 extern unsigned long SENSOR_READ_INTERVAL;      // Sensor reading interval in milliseconds
 extern float ACCEL_THRESHOLD;                   // Accelerometer threshold in g's
 extern unsigned long EVENT_CAPTURE_DURATION_MS; // Event capture window in milliseconds
 extern unsigned int LAB_TEST_SAMPLE_RATE_HZ;    // Lab test sampling rate (10 or 20 Hz)
+extern unsigned int g_eventMaxSamples;          // Paired samples kept per event (<= EVENT_SAMPLE_CAPACITY)
+extern unsigned int g_accelBufferSize;          // Accel history depth (<= ACCEL_BUFFER_CAPACITY)
+extern unsigned int g_nauGain;                  // NAU7802 PGA gain (1-128, power of two)
+extern unsigned int g_nauRateSps;               // NAU7802 output rate (10/20/40/80/320 SPS)
+extern uint8_t g_loraSpreadingFactor;
+extern float g_loraBandwidthKhz;
+extern uint8_t g_loraCodingRate;
+extern int g_loraTxPowerDbm;
+extern bool g_sleepEnabled;                     // Deep sleep when idle (sleep.* parameters)
+extern unsigned int g_sleepIdleSec;
+extern unsigned int g_sleepTimerSec;
+extern float g_sleepWakeG;
 // ======================================================================
 
-// Timing Configuration (non-configurable)
-#define EVENT_MAX_SAMPLES      80      // Safety cap for paired accel+strain samples in one event
+// Event sample storage
+// (EVENT_SAMPLE_CAPACITY, the compile-time ceiling, lives in EventLogger_Module.h)
+#define EVENT_MAX_SAMPLES      80      // Default cap for paired accel+strain samples in one event
+#define ACCEL_BUFFER_CAPACITY  100
+
+// Static buffer pools (serial 'h' and CMD:m report use, peak and failures)
+#define LAB_LOG_MAX_SAMPLES      4096    // Lab test ('l') samples held before saving
+#define SAMPLE_POOL_BLOCK_BYTES  (LAB_LOG_MAX_SAMPLES * LAB_SAMPLE_BYTES)   // One event capture or one lab run
+#define PACKET_POOL_BLOCKS       2       // LoRa RX packet + CSV chunk sent while handling it
+#define LINE_POOL_BLOCK_BYTES    512     // SD read/write batches
+#define LINE_POOL_BLOCKS         2
+
+// Serial command input (assembled without blocking; see LineAssembler.h)
+#define SERIAL_LINE_MAX          512     // Longest SETUP:/SET:/GET:/LIST line
+#define SERIAL_LINE_STARTS       "SGL"   // First characters of multi-character lines; other keys act at once
+#define SERIAL_LINE_IDLE_MS      1000    // Partial line with no new byte completes after this (old Stream timeout)
+#define SERIAL_POLL_MAX_BYTES    64      // Bytes taken from the UART per loop() pass
+
+// Execution trace (serial 'x'; see Shared/TraceRing)
+#define TRACE_RING_EVENTS        1024    // 12 bytes each; about 25 s of idle sampling at 100 ms
+#define TRACE_MAX_TASKS          8       // Tasks given their own ID; later ones share TRACE_MAX_TASKS
+
+// Acquisition self-benchmark (serial 'a', LoRa CMD:a): rates and times on this board
+#define ACQ_BENCH_WINDOW_MS      1000    // Back-to-back LIS3DH reads, then NAU7802 readRaw() calls
+#define ACQ_BENCH_SAVE_REPEATS   3       // Saves per event size
+#define ACQ_BENCH_FILE           "/acq_bench.csv"   // Scratch file in the card root, deleted after each save
+#define ACQ_BENCH_LORA_PACKETS   3       // Probe packets per size
+#define ACQ_BENCH_LORA_SHORT     16      // Probe sizes: a short reply, and a full DATA: chunk
+#define ACQ_TARGET_ACCEL_FACTOR  10      // LIS3DH reads/s at least this many times nau.rate_sps
+#define ACQ_TARGET_RATE_PCT      95      // NAU7802 and paired rates against nau.rate_sps
+#define ACQ_TARGET_SAVE_MS       250     // Largest event (EVENT_SAMPLE_CAPACITY samples) saved within this
+#define ACQ_TARGET_LORA_PCT      110     // Packet time against its time on air
+
+// Deep sleep (parked trailers): LIS3DH INT1 or the RTC timer wakes the unit
+#define SLEEP_IDLE_SEC_DEFAULT   60      // Awake this long with no event, command or serial input
+#define SLEEP_TIMER_SEC_DEFAULT  900     // Periodic wake to listen for LoRa commands
+#define SLEEP_WAKE_G_DEFAULT     0.25f   // INT1 threshold above the high-passed baseline (16 mg steps)
+#define SLEEP_WAKE_DURATION      1       // INT1 needs this many 50 Hz samples over the threshold
+#define WAKE_FIFO_SAMPLES        32      // LIS3DH FIFO depth: 640 ms of history at 50 Hz
+#define WAKE_FIFO_PERIOD_MS      20      // 50 Hz low-power ODR used while asleep
+// Sensor power policy, CPU clock and energy ledger settings live in Power_Module.h
+#define LIGHT_SLEEP_SERIAL_HOLD_MS      5000  // Stay awake this long after serial input
+
+#define RTC_STATE_MAGIC          0x534C5031UL   // "SLP1": RTC state valid (cleared by power loss)
 
 // WiFi Configuration (for time sync)
 // NOTE: Update these with your WiFi credentials before deploying
@@ -90,16 +176,78 @@ extern unsigned int LAB_TEST_SAMPLE_RATE_HZ;    // Lab test sampling rate (10 or
 #define WIFI_SSID_BACKUP        "PAL3.0"        // Backup WiFi network (replace with your backup)
 #define WIFI_PASSWORD_BACKUP    "Pu&$rl)u3ePu&"    // Backup WiFi password
 #define NTP_SERVER              "pool.ntp.org"          // NTP server for time sync
+#define TIME_TEXT_SIZE          32                      // getFormattedTime() buffer ("YYYY-MM-DD HH:MM:SS EST")
 #define GMT_OFFSET_SEC          -18000                  // EST = GMT-5 (5 hours * 3600 seconds)
 #define DAYLIGHT_OFFSET_SEC     3600                    // Daylight saving time offset (1 hour)
 
 // WiFi peer-to-peer offload profile storage
 #define MAX_WIFI_PROFILES        3
-#define WIFI_PROFILE_FILE        "/wifi/profiles.txt"
+#define WIFI_PROFILE_FILE        "/wifi/profiles.txt"   // Legacy; migrated to NVS on first boot
 #define WIFI_CONNECT_TIMEOUT_SEC 8
 #define WIFI_SERVER_PORT         8080
 #define WIFI_CLIENT_TIMEOUT_SEC  35   // Seconds receiver waits for transmitter TCP connection
 
+// Addressed LoRa commands: CMD:<c>[@<truck id>][#<path>]
+#define OFFLOAD_PATH_AUTO        'D'  // Site WiFi, then LoRa fallback (legacy behaviour)
+#define OFFLOAD_PATH_WIFI        'W'  // Site WiFi, then LoRa fallback
+#define OFFLOAD_PATH_SOFTAP      'A'  // Join the transmitter's SoftAP, then LoRa fallback
+#define OFFLOAD_PATH_LORA        'L'  // LoRa only
+#define BROADCAST_REPLY_JITTER_MS 1500  // Spread replies to broadcast queries so units don't collide
+
+// LoRa command handling: DIO1 wakes lora_rx, which acks and queues anything long-running
+#define LORA_TASK_CORE           1     // Same core as loop(); core 0 belongs to Wi-Fi
+#define LORA_RX_TASK_PRIORITY    3     // Above loop() (1) so a packet is read as soon as it lands
+#define LORA_RX_TASK_STACK       4096
+#define LORA_CMD_TASK_PRIORITY   2     // Offload/clear/queue summary run here, off loop()
+#define LORA_CMD_TASK_STACK      8192  // Wi-Fi offload and SD directory walks
+#define LORA_CMD_QUEUE_DEPTH     4     // Per queue; a full queue answers RSP:BUSY
+#define LORA_TARE_SAMPLES        100   // Background tare length for CMD:z
+
+// Persistent configuration (binary TLV image in NVS, see Shared/ConfigTLV)
+#define CFG_NVS_NAMESPACE        "wabash_rx"
+#define CFG_CAPACITY             768
+#define CFG_TAG_SENSOR_INTERVAL  0x01
+#define CFG_TAG_THRESHOLD        0x02
+#define CFG_TAG_CAPTURE_DURATION 0x03
+#define CFG_TAG_LAB_SAMPLE_RATE  0x04
+#define CFG_TAG_INCLUDE_TRUCK_ID 0x05
+#define CFG_TAG_TRUCK_ID         0x06
+#define CFG_TAG_INCLUDE_DESC     0x07
+#define CFG_TAG_DESCRIPTION      0x08
+#define CFG_TAG_WIFI_SSID_BASE   0x10   // + profile index
+#define CFG_TAG_WIFI_PASS_BASE   0x18   // + profile index
+#define CFG_TAG_EVENT_MAX_SAMPLES 0x20
+#define CFG_TAG_ACCEL_BUFFER     0x21
+#define CFG_TAG_NAU_GAIN         0x22
+#define CFG_TAG_NAU_RATE         0x23
+#define CFG_TAG_LORA_SF          0x24
+#define CFG_TAG_LORA_BW          0x25
+#define CFG_TAG_LORA_CR          0x26
+#define CFG_TAG_LORA_POWER       0x27
+#define CFG_TAG_NAU_CAL          0x28   // NAU7802_Calibration (offset/gain registers + gain/rate they belong to)
+#define CFG_TAG_NAU_ZERO         0x29   // Last strain zero offset (raw counts)
+#define CFG_TAG_SLEEP_ENABLE     0x2A
+#define CFG_TAG_SLEEP_IDLE       0x2B
+#define CFG_TAG_SLEEP_TIMER      0x2C
+#define CFG_TAG_SLEEP_WAKE_G     0x2D
+#define CFG_TAG_POWER_ENABLE     0x2E
+#define CFG_TAG_POWER_IDLE       0x2F
+#define CFG_TAG_POWER_STRAIN_PERIOD 0x30
+#define CFG_TAG_POWER_STRAIN_BURST  0x31
+#define CFG_TAG_POWER_SHT_ACTIVE 0x32
+#define CFG_TAG_POWER_SHT_IDLE   0x33
+#define CFG_TAG_CPU_IDLE_MHZ     0x34
+#define CFG_TAG_CPU_LIGHT_SLEEP  0x35
+#define CFG_TAG_CPU_UART_WAKE    0x36
+#define CFG_TAG_ENERGY_BATTERY   0x37
+#define CFG_TAG_SOFTAP_SSID      0x38   // Sweep SoftAP (SETUP aps=/app=); same tags as the transmitter
+#define CFG_TAG_SOFTAP_PASS      0x39
+
+// ===== FAST BOOT =====
+#define NAU_BOOT_WAIT_MS         1500   // Longest setup() waits for the NAU7802 after the other sensors
+#define NAU_BOOT_TARE_SAMPLES    200    // Samples for the background tare after boot
+#define NAU_ZERO_SAVE_DELTA      64     // Persist a new zero offset only if it moved more than this (limits flash writes)
+
 
 /**
  * Global Objects (External Declarations)
@@ -110,6 +258,8 @@ extern SHT45_Module sht45;               // SHT45 temperature/humidity sensor
 extern LIS3DH_Module lis3dh;             // LIS3DH accelerometer
 extern SDCard_Module sdCard;             // SD card module
 extern NAU7802_Module nau7802;           // NAU7802 ADC for strain gauges
+extern Power_Module power;               // Sensor power policy, CPU clock, energy ledger
+extern Diagnostics_Module diagnostics;   // Cooperative serial diagnostic modes
 
 
 /**
@@ -120,23 +270,59 @@ void setup();
 void loop();
 
 // Event capture functions
+int capturePairs(EventLogger_Module::EventSample* samples, int sampleCount, unsigned long captureStart);
 void captureEvent(float triggerX, float triggerY, float triggerZ);
 void playbackEvents();
 void deleteAllEventFiles();
 
 // Time sync functions
 bool syncTime();
-String getFormattedTime();
+const char* getFormattedTime(char* buffer, size_t bufferSize);
 void offloadData();
-bool startWifiLocalOffload();
+bool startWifiLocalOffload(bool useTransmitterSoftAp = false);
 void loadWiFiProfilesFromSd();
-bool saveWiFiProfilesToSd();
 
 // Configuration functions
-bool parseSetupPacket(const String& packet);
-bool saveTruckInfoToSd(const String& truckId, const String& description, bool includeTruckId, bool includeDescription);
+bool parseSetupPacket(const char* packet, size_t len);
+void loadTruckInfoFromSd();
+bool loadConfigFromNvs();
+bool loadConfigFromRtc();
+bool saveConfigToNvs();
+bool handleParamCommand(const char* line, bool viaLoRa);
+void applyPendingLoRaConfig();
+void resetAccelBuffer();
 void applyConfiguration();
 
+// Strain gauge bring-up and zero offset
+void serviceNau();
+void saveNauZeroOffset();
+
+// Deep sleep with LIS3DH wake-on-motion and RTC-retained state
+void handleWakeSamples();
+void serviceSleep();
+void noteActivity();
+void enterDeepSleep();
+
+// Glue for Power_Module and Diagnostics_Module
+bool wakeSensors();
+void startNau();
+unsigned int restoreNauGain();
+float microstrainFromCounts(int32_t zeroed);
+bool workInFlight();
+bool keepAwake();
+void onLightSleepEnter();
+void onLightSleepExit(bool gpioWake);
+void onWifiEnergyEvent(arduino_event_id_t event);
+
+void printI2cProfile();
+void printTrace();
+void runKernelBenchmarks();
+bool runAcquisitionBenchmark(char* summary, size_t summarySize);
+
+// LoRa command tasks (lora_rx, lora_cmd) and the queue drained by loop()
+bool startLoRaTasks();
+void processLoRaLoopCommands();
+
 // Legacy function prototypes (to be implemented)
 void decToHex(int decimal, char * hex);   // Conversion from Decimal to Hex
 int hexToDec(const char * hex);           // Conversion from Hex to Decimal
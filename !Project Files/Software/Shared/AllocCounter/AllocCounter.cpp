@@ -0,0 +1,117 @@
+/*
+  Filename: AllocCounter.cpp
+  Heap Allocation Counters Implementation
+
+  Description: __wrap_* entry points for the linker's --wrap option. Each
+               wrapper bumps the counters and forwards to the real allocator.
+*/
+
+#include "AllocCounter.h"
+
+#include <stdio.h>
+
+#if defined(ESP_PLATFORM)
+  #include <freertos/FreeRTOS.h>
+  #include <freertos/task.h>
+  static inline void* currentTask() { return (void*)xTaskGetCurrentTaskHandle(); }
+#else
+  #include <pthread.h>
+  static inline void* currentTask() { return (void*)pthread_self(); }
+#endif
+
+static AllocCounts s_total = {0, 0, 0};
+static AllocCounts s_watched = {0, 0, 0};
+static void* volatile s_watchedTask = nullptr;
+
+static AllocCounts snapshot(const AllocCounts& counts) {
+  AllocCounts out;
+  out.allocs = __atomic_load_n(&counts.allocs, __ATOMIC_RELAXED);
+  out.frees = __atomic_load_n(&counts.frees, __ATOMIC_RELAXED);
+  out.bytes = __atomic_load_n(&counts.bytes, __ATOMIC_RELAXED);
+  return out;
+}
+
+#ifdef ALLOC_COUNTER_HOOKS
+
+static inline void countAlloc(size_t size) {
+  __atomic_fetch_add(&s_total.allocs, 1, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&s_total.bytes, (uint32_t)size, __ATOMIC_RELAXED);
+  if (s_watchedTask != nullptr && currentTask() == s_watchedTask) {
+    // Only the watched task writes these
+    s_watched.allocs++;
+    s_watched.bytes += (uint32_t)size;
+  }
+}
+
+static inline void countFree() {
+  __atomic_fetch_add(&s_total.frees, 1, __ATOMIC_RELAXED);
+  if (s_watchedTask != nullptr && currentTask() == s_watchedTask) {
+    s_watched.frees++;
+  }
+}
+
+extern "C" {
+  void* __real_malloc(size_t size);
+  void* __real_calloc(size_t count, size_t size);
+  void* __real_realloc(void* ptr, size_t size);
+  void __real_free(void* ptr);
+
+  void* __wrap_malloc(size_t size) {
+    countAlloc(size);
+    return __real_malloc(size);
+  }
+
+  void* __wrap_calloc(size_t count, size_t size) {
+    countAlloc(count * size);
+    return __real_calloc(count, size);
+  }
+
+  void* __wrap_realloc(void* ptr, size_t size) {
+    if (size == 0) {
+      if (ptr != nullptr) {
+        countFree();
+      }
+    } else {
+      countAlloc(size);
+    }
+    return __real_realloc(ptr, size);
+  }
+
+  void __wrap_free(void* ptr) {
+    if (ptr != nullptr) {
+      countFree();
+    }
+    __real_free(ptr);
+  }
+}
+
+bool allocCounterActive() {
+  return true;
+}
+
+#else
+
+bool allocCounterActive() {
+  return false;
+}
+
+#endif
+
+void allocCounterWatchCurrentTask() {
+  s_watchedTask = currentTask();
+}
+
+AllocCounts allocCounterTotal() {
+  return snapshot(s_total);
+}
+
+AllocCounts allocCounterWatched() {
+  return snapshot(s_watched);
+}
+
+size_t AllocProbe::format(char* out, size_t outSize) const {
+  int n = snprintf(out, outSize, "%s runs=%lu allocs=%lu peak=%lu dirty=%lu",
+                   _name, (unsigned long)_runs, (unsigned long)_total,
+                   (unsigned long)_peak, (unsigned long)_dirtyRuns);
+  return (n < 0) ? 0 : (size_t)n;
+}
@@ -0,0 +1,115 @@
+/*
+  Filename: AllocCounter.h
+  Heap Allocation Counters
+
+  Description: Counts malloc/calloc/realloc/free calls through linker
+               wrappers so firmware can show that a code path never touches
+               the heap. Enable by adding to platformio.ini:
+
+                 build_flags =
+                   -D ALLOC_COUNTER_HOOKS
+                   -Wl,--wrap=malloc -Wl,--wrap=calloc
+                   -Wl,--wrap=realloc -Wl,--wrap=free
+
+               Totals cover every task. The watched task (usually the Arduino
+               loop task, see allocCounterWatchCurrentTask()) is also counted
+               on its own, so Wi-Fi/LwIP allocations in other tasks do not
+               show up in an AllocProbe.
+
+               Without ALLOC_COUNTER_HOOKS everything reads zero and
+               allocCounterActive() returns false.
+
+  Usage:
+    AllocProbe packetProbe("lora_rx");
+    packetProbe.begin();
+    ... handle one packet ...
+    packetProbe.end();       // last(), peak(), dirtyRuns() ...
+*/
+
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct AllocCounts {
+  uint32_t allocs;      // malloc + calloc + realloc calls
+  uint32_t frees;       // free calls with a non-null pointer
+  uint32_t bytes;       // bytes requested (wraps)
+};
+
+/**
+ * True when the firmware was linked with the malloc wrappers
+ */
+bool allocCounterActive();
+
+/**
+ * Count the calling task separately from now on
+ */
+void allocCounterWatchCurrentTask();
+
+/**
+ * Counts for all tasks since boot
+ */
+AllocCounts allocCounterTotal();
+
+/**
+ * Counts for the watched task only
+ */
+AllocCounts allocCounterWatched();
+
+/**
+ * Allocation accounting for one repeated unit of work (a packet, a sample)
+ * Brackets must be opened and closed on the watched task.
+ */
+class AllocProbe {
+  public:
+    explicit AllocProbe(const char* name) : _name(name) { reset(); }
+
+    void begin() { _start = allocCounterWatched().allocs; }
+
+    void end() {
+      uint32_t n = allocCounterWatched().allocs - _start;
+      _last = n;
+      if (n > _peak) {
+        _peak = n;
+      }
+      _total += n;
+      _runs++;
+      if (n > 0) {
+        _dirtyRuns++;
+      }
+    }
+
+    void reset() {
+      _start = 0;
+      _last = 0;
+      _peak = 0;
+      _total = 0;
+      _runs = 0;
+      _dirtyRuns = 0;
+    }
+
+    const char* name() const { return _name; }
+    uint32_t last() const { return _last; }
+    uint32_t peak() const { return _peak; }
+    uint32_t total() const { return _total; }
+    uint32_t runs() const { return _runs; }
+    uint32_t dirtyRuns() const { return _dirtyRuns; }   // Runs that allocated at least once
+
+    /**
+     * "<name> runs=N allocs=T peak=P dirty=D"
+     */
+    size_t format(char* out, size_t outSize) const;
+
+  private:
+    const char* _name;
+    uint32_t _start;
+    uint32_t _last;
+    uint32_t _peak;
+    uint32_t _total;
+    uint32_t _runs;
+    uint32_t _dirtyRuns;
+};
+
+#endif
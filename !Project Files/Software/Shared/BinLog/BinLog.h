@@ -0,0 +1,489 @@
+/*
+  Filename: BinLog.h
+  Deferred Binary Logging (header-only, no Arduino dependency)
+
+  Description: printf-style logging that does not format or touch the UART
+               on the calling task. A log call copies the format-string
+               pointer, a timestamp and its raw arguments into a ring buffer;
+               formatting happens later, either on a low-priority drain task
+               (BinLogDrain.h) or on a PC from "#BL:" frames and the
+               firmware ELF (examples/binlog_decode).
+
+               Levels are filtered at compile time: calls above LOG_LEVEL
+               expand to nothing and their arguments are not evaluated.
+
+  Usage:
+    #define LOG_LEVEL LOG_LEVEL_INFO   // or -D LOG_LEVEL=2 in build_flags
+    #include "BinLog.h"
+    LOG_WARN("NAU7802: Data timeout (PU_CTRL=0x%02X)", puCtrl);
+
+  Each record is one output line (no trailing '\n' in the format).
+  Supported arguments: integers, bool, char, float, double and C strings
+  (copied, truncated to BINLOG_MAX_STRING). Pass String via c_str().
+*/
+
+#ifndef BIN_LOG_H
+#define BIN_LOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <type_traits>
+
+#if defined(ESP_PLATFORM)
+  #include <freertos/FreeRTOS.h>
+  #include <esp_timer.h>
+#else
+  #include <chrono>
+  #include <mutex>
+#endif
+
+#define LOG_LEVEL_NONE   0
+#define LOG_LEVEL_ERROR  1
+#define LOG_LEVEL_WARN   2
+#define LOG_LEVEL_INFO   3
+#define LOG_LEVEL_DEBUG  4
+#define LOG_LEVEL_TRACE  5
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+#ifndef BINLOG_RING_SIZE
+#define BINLOG_RING_SIZE   4096    // Bytes of queued records
+#endif
+#define BINLOG_MAX_RECORD  160     // Header + encoded arguments
+#define BINLOG_MAX_STRING  48      // Longest string argument kept
+#define BINLOG_MAX_LINE    192     // Formatted text per record
+
+enum BinLogArgTag : uint8_t {
+  BINLOG_ARG_I32 = 1,
+  BINLOG_ARG_U32,
+  BINLOG_ARG_I64,
+  BINLOG_ARG_U64,
+  BINLOG_ARG_F32,
+  BINLOG_ARG_F64,
+  BINLOG_ARG_STR     // u8 length, then bytes (no terminator)
+};
+
+struct BinLogHeader {
+  uint16_t size;          // Whole record including this header
+  uint8_t level;
+  uint8_t reserved;
+  uint32_t timestampUs;
+  const char* fmt;        // Format string in flash; doubles as its ID
+};
+
+// ---- argument encoding ----
+
+struct BinLogWriter {
+  uint8_t* pos;
+  uint8_t* end;
+  bool ok;
+
+  void put(uint8_t tag, const void* value, size_t len) {
+    if (!ok || pos + 1 + len > end) {
+      ok = false;
+      return;
+    }
+    *pos++ = tag;
+    memcpy(pos, value, len);
+    pos += len;
+  }
+
+  void putString(const char* text) {
+    size_t len = (text != nullptr) ? strlen(text) : 0;
+    if (len > BINLOG_MAX_STRING) {
+      len = BINLOG_MAX_STRING;
+    }
+    if (!ok || pos + 2 + len > end) {
+      ok = false;
+      return;
+    }
+    *pos++ = BINLOG_ARG_STR;
+    *pos++ = (uint8_t)len;
+    memcpy(pos, text, len);
+    pos += len;
+  }
+};
+
+template <typename T>
+inline typename std::enable_if<std::is_integral<T>::value>::type
+binlogEncodeArg(BinLogWriter& w, T value) {
+  if (std::is_signed<T>::value) {
+    if (sizeof(T) <= 4) {
+      int32_t v = (int32_t)value;
+      w.put(BINLOG_ARG_I32, &v, sizeof(v));
+    } else {
+      int64_t v = (int64_t)value;
+      w.put(BINLOG_ARG_I64, &v, sizeof(v));
+    }
+  } else {
+    if (sizeof(T) <= 4) {
+      uint32_t v = (uint32_t)value;
+      w.put(BINLOG_ARG_U32, &v, sizeof(v));
+    } else {
+      uint64_t v = (uint64_t)value;
+      w.put(BINLOG_ARG_U64, &v, sizeof(v));
+    }
+  }
+}
+
+template <typename T>
+inline typename std::enable_if<std::is_enum<T>::value>::type
+binlogEncodeArg(BinLogWriter& w, T value) {
+  int32_t v = (int32_t)value;
+  w.put(BINLOG_ARG_I32, &v, sizeof(v));
+}
+
+inline void binlogEncodeArg(BinLogWriter& w, float value) { w.put(BINLOG_ARG_F32, &value, sizeof(value)); }
+inline void binlogEncodeArg(BinLogWriter& w, double value) { w.put(BINLOG_ARG_F64, &value, sizeof(value)); }
+inline void binlogEncodeArg(BinLogWriter& w, const char* text) { w.putString(text); }
+inline void binlogEncodeArg(BinLogWriter& w, const void* ptr) {
+  uint32_t v = (uint32_t)(uintptr_t)ptr;
+  w.put(BINLOG_ARG_U32, &v, sizeof(v));
+}
+
+inline void binlogEncodeArgs(BinLogWriter&) {}
+
+template <typename T, typename... Rest>
+inline void binlogEncodeArgs(BinLogWriter& w, T value, Rest... rest) {
+  binlogEncodeArg(w, value);
+  binlogEncodeArgs(w, rest...);
+}
+
+// Never called; lets the compiler check format strings against arguments
+inline void binlogCheckFormat(const char*, ...) __attribute__((format(printf, 1, 2)));
+inline void binlogCheckFormat(const char*, ...) {}
+
+// ---- argument decoding and formatting ----
+
+struct BinLogArg {
+  uint8_t tag;
+  int64_t i;
+  uint64_t u;
+  double f;
+  char text[BINLOG_MAX_STRING + 1];
+};
+
+struct BinLogReader {
+  const uint8_t* pos;
+  const uint8_t* end;
+
+  bool next(BinLogArg& arg) {
+    if (pos >= end) {
+      return false;
+    }
+    arg.tag = *pos++;
+    arg.i = 0;
+    arg.u = 0;
+    arg.f = 0.0;
+    arg.text[0] = '\0';
+    switch (arg.tag) {
+      case BINLOG_ARG_I32: { int32_t v; if (!take(&v, 4)) return false; arg.i = v; arg.u = (uint64_t)(int64_t)v; arg.f = v; break; }
+      case BINLOG_ARG_U32: { uint32_t v; if (!take(&v, 4)) return false; arg.u = v; arg.i = v; arg.f = v; break; }
+      case BINLOG_ARG_I64: { int64_t v; if (!take(&v, 8)) return false; arg.i = v; arg.u = (uint64_t)v; arg.f = (double)v; break; }
+      case BINLOG_ARG_U64: { uint64_t v; if (!take(&v, 8)) return false; arg.u = v; arg.i = (int64_t)v; arg.f = (double)v; break; }
+      case BINLOG_ARG_F32: { float v; if (!take(&v, 4)) return false; arg.f = v; arg.i = (int64_t)v; arg.u = (uint64_t)arg.i; break; }
+      case BINLOG_ARG_F64: { double v; if (!take(&v, 8)) return false; arg.f = v; arg.i = (int64_t)v; arg.u = (uint64_t)arg.i; break; }
+      case BINLOG_ARG_STR: {
+        if (pos >= end) return false;
+        uint8_t len = *pos++;
+        if (len > BINLOG_MAX_STRING || !take(arg.text, len)) return false;
+        arg.text[len] = '\0';
+        break;
+      }
+      default:
+        return false;
+    }
+    return true;
+  }
+
+  bool take(void* out, size_t len) {
+    if (pos + len > end) {
+      return false;
+    }
+    memcpy(out, pos, len);
+    pos += len;
+    return true;
+  }
+};
+
+/**
+ * printf the encoded arguments into out using fmt
+ * Length modifiers in fmt are ignored; each conversion takes the next argument
+ * and converts it to the type the conversion expects.
+ * @return characters written (excluding the terminator)
+ */
+inline size_t binlogFormat(const char* fmt, const uint8_t* args, size_t argsLen, char* out, size_t outSize) {
+  if (outSize == 0) {
+    return 0;
+  }
+  BinLogReader reader = {args, args + argsLen};
+  size_t len = 0;
+  const char* p = fmt;
+
+  while (*p != '\0' && len < outSize - 1) {
+    if (*p != '%') {
+      out[len++] = *p++;
+      continue;
+    }
+    if (p[1] == '%') {
+      out[len++] = '%';
+      p += 2;
+      continue;
+    }
+
+    // Copy flags, width and precision; drop length modifiers
+    char spec[24];
+    size_t specLen = 0;
+    spec[specLen++] = *p++;
+    while (*p != '\0' && strchr("-+ #0123456789.", *p) != nullptr && specLen < sizeof(spec) - 4) {
+      spec[specLen++] = *p++;
+    }
+    while (*p != '\0' && strchr("hlLzjt", *p) != nullptr) {
+      p++;
+    }
+    char conv = *p;
+    if (conv == '\0') {
+      break;
+    }
+    p++;
+
+    BinLogArg arg;
+    bool have = reader.next(arg);
+    int n = 0;
+    size_t room = outSize - len;
+    if (!have) {
+      n = snprintf(out + len, room, "<?>");
+    } else if (conv == 'd' || conv == 'i') {
+      spec[specLen++] = 'l'; spec[specLen++] = 'l'; spec[specLen++] = conv; spec[specLen] = '\0';
+      n = snprintf(out + len, room, spec, (long long)arg.i);
+    } else if (conv == 'u' || conv == 'x' || conv == 'X' || conv == 'o') {
+      spec[specLen++] = 'l'; spec[specLen++] = 'l'; spec[specLen++] = conv; spec[specLen] = '\0';
+      n = snprintf(out + len, room, spec, (unsigned long long)arg.u);
+    } else if (conv == 'c') {
+      spec[specLen++] = conv; spec[specLen] = '\0';
+      n = snprintf(out + len, room, spec, (int)arg.i);
+    } else if (strchr("fFeEgGaA", conv) != nullptr) {
+      spec[specLen++] = conv; spec[specLen] = '\0';
+      n = snprintf(out + len, room, spec, arg.f);
+    } else if (conv == 's') {
+      spec[specLen++] = conv; spec[specLen] = '\0';
+      n = snprintf(out + len, room, spec, arg.tag == BINLOG_ARG_STR ? arg.text : "<?>");
+    } else if (conv == 'p') {
+      n = snprintf(out + len, room, "0x%08llx", (unsigned long long)arg.u);
+    } else {
+      n = snprintf(out + len, room, "<%%%c?>", conv);
+    }
+    if (n > 0) {
+      len += ((size_t)n < room) ? (size_t)n : room - 1;
+    }
+  }
+
+  out[len] = '\0';
+  return len;
+}
+
+inline char binlogLevelChar(uint8_t level) {
+  static const char chars[] = "-EWIDT";
+  return (level <= LOG_LEVEL_TRACE) ? chars[level] : '?';
+}
+
+// ---- ring buffer ----
+
+/**
+ * Byte ring of variable-length records; a record that does not fit is dropped whole
+ */
+class BinLog {
+  public:
+    BinLog() : _head(0), _tail(0), _used(0), _dropped(0), _written(0), _highWater(0) {}
+
+    bool push(const uint8_t* record, size_t len) {
+      lock();
+      bool fits = (_used + len <= BINLOG_RING_SIZE);
+      if (fits) {
+        copyIn(record, len);
+        _written++;
+        if (_used > _highWater) {
+          _highWater = _used;
+        }
+      } else {
+        _dropped++;
+      }
+      unlock();
+      return fits;
+    }
+
+    /**
+     * Copy the oldest record into out (BINLOG_MAX_RECORD bytes)
+     * @return record length, 0 if empty
+     */
+    size_t pop(uint8_t* out) {
+      lock();
+      size_t len = 0;
+      if (_used >= sizeof(BinLogHeader)) {
+        uint16_t size;
+        peek((uint8_t*)&size, sizeof(size));
+        len = size;
+        copyOut(out, len);
+      }
+      unlock();
+      return len;
+    }
+
+    uint32_t dropped() const { return _dropped; }
+    uint32_t written() const { return _written; }
+    size_t used() const { return _used; }
+    size_t highWater() const { return _highWater; }
+
+  private:
+    uint8_t _ring[BINLOG_RING_SIZE];
+    size_t _head;
+    size_t _tail;
+    size_t _used;
+    uint32_t _dropped;
+    uint32_t _written;
+    size_t _highWater;
+#if defined(ESP_PLATFORM)
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+    void lock() { portENTER_CRITICAL(&_mux); }
+    void unlock() { portEXIT_CRITICAL(&_mux); }
+#else
+    std::mutex _mutex;
+    void lock() { _mutex.lock(); }
+    void unlock() { _mutex.unlock(); }
+#endif
+
+    void copyIn(const uint8_t* data, size_t len) {
+      size_t first = BINLOG_RING_SIZE - _head;
+      if (first > len) first = len;
+      memcpy(_ring + _head, data, first);
+      memcpy(_ring, data + first, len - first);
+      _head = (_head + len) % BINLOG_RING_SIZE;
+      _used += len;
+    }
+
+    void peek(uint8_t* out, size_t len) const {
+      size_t first = BINLOG_RING_SIZE - _tail;
+      if (first > len) first = len;
+      memcpy(out, _ring + _tail, first);
+      memcpy(out + first, _ring, len - first);
+    }
+
+    void copyOut(uint8_t* out, size_t len) {
+      peek(out, len);
+      _tail = (_tail + len) % BINLOG_RING_SIZE;
+      _used -= len;
+    }
+};
+
+inline BinLog& binlog() {
+  static BinLog instance;
+  return instance;
+}
+
+inline uint32_t binlogTimestampUs() {
+#if defined(ESP_PLATFORM)
+  return (uint32_t)esp_timer_get_time();
+#else
+  static const auto start = std::chrono::steady_clock::now();
+  return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start).count();
+#endif
+}
+
+template <typename... Args>
+inline void binlogWrite(uint8_t level, const char* fmt, Args... args) {
+  uint8_t record[BINLOG_MAX_RECORD];
+  BinLogWriter w = {record + sizeof(BinLogHeader), record + sizeof(record), true};
+  binlogEncodeArgs(w, args...);
+  if (!w.ok) {
+    // Too many/long arguments: keep the message, mark the arguments missing
+    w.pos = record + sizeof(BinLogHeader);
+  }
+  BinLogHeader header;
+  header.size = (uint16_t)(w.pos - record);
+  header.level = level;
+  header.reserved = 0;
+  header.timestampUs = binlogTimestampUs();
+  header.fmt = fmt;
+  memcpy(record, &header, sizeof(header));
+  binlog().push(record, header.size);
+}
+
+/**
+ * Format a popped record (message text only)
+ */
+inline size_t binlogFormatRecord(const uint8_t* record, size_t len, char* out, size_t outSize) {
+  BinLogHeader header;
+  memcpy(&header, record, sizeof(header));
+  return binlogFormat(header.fmt, record + sizeof(header), len - sizeof(header), out, outSize);
+}
+
+// ---- host frames: "#BL:" + hex(u8 level, u32 timestamp us, u32 format address, arguments) ----
+
+inline size_t binlogFrameRecord(const uint8_t* record, size_t len, char* out, size_t outSize) {
+  BinLogHeader header;
+  memcpy(&header, record, sizeof(header));
+  uint8_t head[9];
+  uint32_t address = (uint32_t)(uintptr_t)header.fmt;
+  head[0] = header.level;
+  memcpy(head + 1, &header.timestampUs, 4);
+  memcpy(head + 5, &address, 4);
+
+  static const char hex[] = "0123456789ABCDEF";
+  size_t argsLen = len - sizeof(header);
+  size_t need = 4 + 2 * (sizeof(head) + argsLen) + 1;
+  if (outSize < need) {
+    return 0;
+  }
+  size_t n = 0;
+  memcpy(out, "#BL:", 4);
+  n = 4;
+  for (size_t i = 0; i < sizeof(head) + argsLen; i++) {
+    uint8_t b = (i < sizeof(head)) ? head[i] : record[sizeof(header) + i - sizeof(head)];
+    out[n++] = hex[b >> 4];
+    out[n++] = hex[b & 0x0F];
+  }
+  out[n] = '\0';
+  return n;
+}
+
+#define BINLOG_CALL(level, ...) do { \
+    if (false) binlogCheckFormat(__VA_ARGS__); \
+    binlogWrite(level, __VA_ARGS__); \
+  } while (0)
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+  #define LOG_ERROR(...) BINLOG_CALL(LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+  #define LOG_ERROR(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+  #define LOG_WARN(...) BINLOG_CALL(LOG_LEVEL_WARN, __VA_ARGS__)
+#else
+  #define LOG_WARN(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+  #define LOG_INFO(...) BINLOG_CALL(LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+  #define LOG_INFO(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+  #define LOG_DEBUG(...) BINLOG_CALL(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+  #define LOG_DEBUG(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_TRACE
+  #define LOG_TRACE(...) BINLOG_CALL(LOG_LEVEL_TRACE, __VA_ARGS__)
+#else
+  #define LOG_TRACE(...) do {} while (0)
+#endif
+
+#endif
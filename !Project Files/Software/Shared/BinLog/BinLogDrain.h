@@ -0,0 +1,108 @@
+/*
+  Filename: BinLogDrain.h
+  BinLog Drain Task (header-only, ESP32 Arduino)
+
+  Description: Low-priority FreeRTOS task that empties the BinLog ring to a
+               Print (usually Serial), either as formatted text or as "#BL:"
+               hex frames for examples/binlog_decode. The task runs on core 0,
+               away from the Arduino loop task on core 1, so formatting and
+               UART waits never land inside acquisition.
+
+               binlogFlush() drains on the calling task; interactive serial
+               commands use it so their own Serial output stays in order.
+*/
+
+#ifndef BIN_LOG_DRAIN_H
+#define BIN_LOG_DRAIN_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include "BinLog.h"
+
+#define BINLOG_DRAIN_STACK     3072
+#define BINLOG_DRAIN_PRIORITY  1      // Same as loopTask, but on the other core
+#define BINLOG_DRAIN_CORE      0
+#define BINLOG_DRAIN_IDLE_MS   20
+
+enum BinLogOutput : uint8_t {
+  BINLOG_OUTPUT_TEXT,     // Formatted on the device
+  BINLOG_OUTPUT_FRAMES    // "#BL:<hex>" lines, formatted on the PC
+};
+
+struct BinLogDrainState {
+  Print* out;
+  BinLogOutput mode;
+  SemaphoreHandle_t mutex;
+  TaskHandle_t task;
+  uint32_t reportedDrops;
+};
+
+inline BinLogDrainState& binlogDrainState() {
+  static BinLogDrainState state = {nullptr, BINLOG_OUTPUT_TEXT, nullptr, nullptr, 0};
+  return state;
+}
+
+/**
+ * Write up to maxRecords queued records to the drain output
+ * @return number of records written
+ */
+inline size_t binlogFlush(size_t maxRecords = (size_t)-1) {
+  BinLogDrainState& state = binlogDrainState();
+  if (state.out == nullptr) {
+    return 0;
+  }
+  xSemaphoreTake(state.mutex, portMAX_DELAY);
+
+  uint8_t record[BINLOG_MAX_RECORD];
+  char line[4 + 2 * BINLOG_MAX_RECORD + 1];
+  size_t count = 0;
+  size_t len;
+  while (count < maxRecords && (len = binlog().pop(record)) > 0) {
+    size_t n = (state.mode == BINLOG_OUTPUT_FRAMES)
+                 ? binlogFrameRecord(record, len, line, sizeof(line))
+                 : binlogFormatRecord(record, len, line, BINLOG_MAX_LINE);
+    state.out->write((const uint8_t*)line, n);
+    state.out->write('\n');
+    count++;
+  }
+
+  uint32_t dropped = binlog().dropped();
+  if (dropped != state.reportedDrops) {
+    state.out->printf("[BINLOG] %lu record(s) dropped, ring full\n",
+                      (unsigned long)(dropped - state.reportedDrops));
+    state.reportedDrops = dropped;
+  }
+
+  xSemaphoreGive(state.mutex);
+  return count;
+}
+
+inline void binlogDrainTask(void*) {
+  for (;;) {
+    if (binlogFlush(16) == 0) {
+      vTaskDelay(pdMS_TO_TICKS(BINLOG_DRAIN_IDLE_MS));
+    }
+  }
+}
+
+/**
+ * Start draining to out; records logged before this call are kept
+ */
+inline bool binlogStartDrain(Print& out, BinLogOutput mode = BINLOG_OUTPUT_TEXT) {
+  BinLogDrainState& state = binlogDrainState();
+  if (state.task != nullptr) {
+    return true;
+  }
+  state.mutex = xSemaphoreCreateMutex();
+  if (state.mutex == nullptr) {
+    return false;
+  }
+  state.mode = mode;
+  state.out = &out;
+  return xTaskCreatePinnedToCore(binlogDrainTask, "binlog", BINLOG_DRAIN_STACK, nullptr,
+                                 BINLOG_DRAIN_PRIORITY, &state.task, BINLOG_DRAIN_CORE) == pdPASS;
+}
+
+#endif
@@ -0,0 +1,223 @@
+/*
+  Filename: binlog_check.cpp
+  BinLog checks and call-site cost (Linux host)
+
+  Description: 1) Checks deferred formatting against snprintf() for the
+                  conversions the firmware uses.
+               2) Checks that levels above LOG_LEVEL compile away without
+                  evaluating their arguments.
+               3) Checks ring wrap-around, drop counting and "#BL:" frames.
+               4) Times a LOG_INFO call against formatting the same line
+                  with snprintf().
+               Exits non-zero if any check fails.
+
+  Build/run (from this folder):
+    g++ -O2 -std=c++17 -I../.. binlog_check.cpp -o binlog_check -pthread
+    ./binlog_check [calls=200000]
+*/
+
+#define LOG_LEVEL LOG_LEVEL_INFO
+#define BINLOG_RING_SIZE 1024
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "BinLog.h"
+
+static int g_failures = 0;
+
+static void fail(const char* what, const std::string& got, const std::string& want) {
+  g_failures++;
+  printf("FAIL %s\n  got:  \"%s\"\n  want: \"%s\"\n", what, got.c_str(), want.c_str());
+}
+
+static std::string popText() {
+  uint8_t record[BINLOG_MAX_RECORD];
+  size_t len = binlog().pop(record);
+  if (len == 0) return "<empty>";
+  char line[BINLOG_MAX_LINE];
+  binlogFormatRecord(record, len, line, sizeof(line));
+  return line;
+}
+
+// Log through the ring and compare with snprintf of the same call
+#define CHECK_FORMAT(...) do { \
+    char want[BINLOG_MAX_LINE]; \
+    snprintf(want, sizeof(want), __VA_ARGS__); \
+    LOG_ERROR(__VA_ARGS__); \
+    std::string got = popText(); \
+    if (got != want) fail(#__VA_ARGS__, got, want); \
+  } while (0)
+
+enum TestMode { MODE_A, MODE_B, MODE_C };
+
+static int g_evaluated = 0;
+static int sideEffect() { return ++g_evaluated; }
+
+static void checkFormats() {
+  int32_t raw = -123456;
+  uint8_t reg = 0x2F;
+  unsigned long ms = 4294967000UL;
+  long long big = -9000000000LL;
+  uint64_t ubig = 18000000000000000000ULL;
+  float f = 3.14159f;
+  double d = -0.000123;
+  size_t n = 42;
+  bool flag = true;
+  const char* name = "event_0001.csv";
+  char buffer[] = "mutable";
+
+  CHECK_FORMAT("plain text, no arguments");
+  CHECK_FORMAT("100%% done");
+  CHECK_FORMAT("NAU7802: Data timeout (raw=%ld)", (long)raw);
+  CHECK_FORMAT("PU_CTRL=0x%02X CTRL2=0x%02x", reg, 0x30);
+  CHECK_FORMAT("%d %i %u", -5, 7, 9u);
+  CHECK_FORMAT("%lu ms", ms);
+  CHECK_FORMAT("%lld / %llu", big, (unsigned long long)ubig);
+  CHECK_FORMAT("%.3f %8.2f %-8.1f| %e %g", f, d, 1.5, 12345.678, 0.0001);
+  CHECK_FORMAT("%zu bytes", n);
+  CHECK_FORMAT("flag=%d mode=%d", flag, MODE_C);
+  CHECK_FORMAT("file %s (%s)", name, buffer);
+  CHECK_FORMAT("[%10s] [%-10s]", "right", "left");
+  CHECK_FORMAT("char '%c'", 'Q');
+  CHECK_FORMAT("%+05d %o %#x", 42, 8, 255);
+  CHECK_FORMAT("%.0f%% of %d", 99.6, 100);
+
+  // Strings longer than BINLOG_MAX_STRING are truncated, not dropped
+  std::string longName(100, 'z');
+  LOG_ERROR("%s", longName.c_str());
+  std::string got = popText();
+  if (got != std::string(BINLOG_MAX_STRING, 'z')) fail("long string", got, "48 x z");
+
+  // Arguments that overflow a record keep the message
+  LOG_ERROR("%s %s %s %s", longName.c_str(), longName.c_str(), longName.c_str(), longName.c_str());
+  got = popText();
+  if (got != "<?> <?> <?> <?>") fail("oversized arguments", got, "<?> <?> <?> <?>");
+}
+
+static void checkLevels() {
+  g_evaluated = 0;
+  LOG_DEBUG("not compiled %d", sideEffect());
+  LOG_TRACE("not compiled %d", sideEffect());
+  if (g_evaluated != 0) fail("disabled level evaluated its arguments", std::to_string(g_evaluated), "0");
+  if (binlog().used() != 0) fail("disabled level queued a record", std::to_string(binlog().used()), "0");
+
+  LOG_WARN("compiled %d", sideEffect());
+  LOG_INFO("compiled %d", sideEffect());
+  uint8_t record[BINLOG_MAX_RECORD];
+  size_t len = binlog().pop(record);
+  BinLogHeader header;
+  memcpy(&header, record, sizeof(header));
+  if (len == 0 || header.level != LOG_LEVEL_WARN) fail("warn level", std::to_string(header.level), "2");
+  if (popText() != "compiled 2") fail("info record", "", "compiled 2");
+}
+
+static void checkRing() {
+  // Fill past capacity without draining; later records must be dropped whole
+  uint32_t droppedBefore = binlog().dropped();
+  int pushed = 0;
+  for (int i = 0; i < 200; i++) {
+    LOG_ERROR("ring record %d of %s", i, "fill");
+  }
+  while (popText() != "<empty>") pushed++;
+  uint32_t dropped = binlog().dropped() - droppedBefore;
+  if (pushed + (int)dropped != 200 || dropped == 0) {
+    fail("ring fill", std::to_string(pushed) + " kept + " + std::to_string(dropped) + " dropped", "200 total, some dropped");
+  }
+
+  // Interleave pushes and pops so records straddle the end of the ring
+  for (int i = 0; i < 5000; i++) {
+    LOG_ERROR("wrap %d %.2f %s", i, i * 0.5, (i % 3) ? "abc" : "a much longer string argument");
+    if (i % 7 != 0) {
+      continue;
+    }
+    // Drain down to ~200 bytes so the ring stays partly full
+    while (binlog().used() > 200) {
+      popText();
+    }
+  }
+  std::string last;
+  for (std::string s = popText(); s != "<empty>"; s = popText()) last = s;
+  char want[64];
+  snprintf(want, sizeof(want), "wrap %d %.2f %s", 4999, 4999 * 0.5, "abc");
+  if (last != want) fail("wrap-around", last, want);
+  if (binlog().used() != 0) fail("ring not empty", std::to_string(binlog().used()), "0");
+}
+
+static void checkFrames() {
+  LOG_WARN("frame %u %s %.1f", 7u, "ok", 2.5);
+  uint8_t record[BINLOG_MAX_RECORD];
+  size_t len = binlog().pop(record);
+  BinLogHeader header;
+  memcpy(&header, record, sizeof(header));
+
+  char frame[4 + 2 * BINLOG_MAX_RECORD + 1];
+  size_t n = binlogFrameRecord(record, len, frame, sizeof(frame));
+  if (n < 4 + 18 || strncmp(frame, "#BL:", 4) != 0 || n != strlen(frame)) {
+    fail("frame prefix", frame, "#BL:...");
+    return;
+  }
+
+  // Decode the hex back as binlog_decode does and re-format
+  uint8_t bytes[BINLOG_MAX_RECORD];
+  size_t count = (n - 4) / 2;
+  for (size_t i = 0; i < count; i++) {
+    unsigned v;
+    sscanf(frame + 4 + 2 * i, "%2x", &v);
+    bytes[i] = (uint8_t)v;
+  }
+  uint32_t ts, address;
+  memcpy(&ts, bytes + 1, 4);
+  memcpy(&address, bytes + 5, 4);
+  if (bytes[0] != LOG_LEVEL_WARN || ts != header.timestampUs ||
+      address != (uint32_t)(uintptr_t)header.fmt) {
+    fail("frame header", frame, "level 2, same timestamp and address");
+  }
+  char text[BINLOG_MAX_LINE];
+  binlogFormat(header.fmt, bytes + 9, count - 9, text, sizeof(text));
+  if (std::string(text) != "frame 7 ok 2.5") fail("frame arguments", text, "frame 7 ok 2.5");
+}
+
+static void benchmark(int calls) {
+  using Clock = std::chrono::steady_clock;
+  float strain = 1234.5f;
+  int32_t raw = 812345;
+  uint8_t record[BINLOG_MAX_RECORD];
+
+  auto t0 = Clock::now();
+  for (int i = 0; i < calls; i++) {
+    LOG_INFO("NAU7802: raw=%ld strain=%.2f sample=%d", (long)raw, strain, i);
+    if ((i & 15) == 15) {
+      while (binlog().pop(record) > 0) {}
+    }
+  }
+  auto t1 = Clock::now();
+
+  char line[BINLOG_MAX_LINE];
+  volatile size_t sink = 0;
+  for (int i = 0; i < calls; i++) {
+    sink = sink + snprintf(line, sizeof(line), "NAU7802: raw=%ld strain=%.2f sample=%d", (long)raw, strain, i);
+  }
+  auto t2 = Clock::now();
+
+  double logNs = std::chrono::duration<double, std::nano>(t1 - t0).count() / calls;
+  double fmtNs = std::chrono::duration<double, std::nano>(t2 - t1).count() / calls;
+  printf("call site: LOG_INFO %.0f ns (incl. drain every 16), snprintf %.0f ns\n", logNs, fmtNs);
+  printf("record: %zu-byte header + arguments, ring %d bytes\n", sizeof(BinLogHeader), BINLOG_RING_SIZE);
+}
+
+int main(int argc, char** argv) {
+  int calls = (argc > 1) ? atoi(argv[1]) : 200000;
+
+  checkFormats();
+  checkLevels();
+  checkRing();
+  checkFrames();
+  printf("checks: %s (%d failure%s)\n", g_failures ? "FAIL" : "ok", g_failures, g_failures == 1 ? "" : "s");
+
+  benchmark(calls);
+  return g_failures ? 1 : 0;
+}
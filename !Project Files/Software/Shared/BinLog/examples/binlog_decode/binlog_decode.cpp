@@ -0,0 +1,175 @@
+/*
+  Filename: binlog_decode.cpp
+  BinLog "#BL:" frame decoder (Linux host)
+
+  Description: Turns a serial capture from firmware built with
+               BINLOG_OUTPUT_FRAMES into readable text. Each frame carries
+               the address of its format string; the string itself is read
+               from the firmware ELF (the one PlatformIO left in
+               .pio/build/<env>/firmware.elf), so the device never formats
+               or sends it. Lines that are not frames are passed through.
+
+               Output: "[   12.345678] W NAU7802: Data timeout ..."
+
+  Build/run (from this folder):
+    g++ -O2 -std=c++17 -I../.. binlog_decode.cpp -o binlog_decode
+    ./binlog_decode firmware.elf < capture.txt
+    pio device monitor | ./binlog_decode firmware.elf
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "BinLog.h"
+
+struct Elf32Header {
+  uint8_t ident[16];
+  uint16_t type, machine;
+  uint32_t version, entry, phoff, shoff, flags;
+  uint16_t ehsize, phentsize, phnum, shentsize, shnum, shstrndx;
+};
+
+struct Elf32Section {
+  uint32_t name, type, flags, addr, offset, size, link, info, addralign, entsize;
+};
+
+#define SHT_PROGBITS 1
+#define SHF_ALLOC    2
+
+struct LoadedSection {
+  uint32_t addr;
+  std::vector<char> data;
+};
+
+static std::vector<LoadedSection> g_sections;
+
+static bool loadElf(const char* path) {
+  FILE* f = fopen(path, "rb");
+  if (f == nullptr) {
+    fprintf(stderr, "cannot open %s\n", path);
+    return false;
+  }
+  std::vector<uint8_t> image;
+  uint8_t block[65536];
+  size_t n;
+  while ((n = fread(block, 1, sizeof(block), f)) > 0) {
+    image.insert(image.end(), block, block + n);
+  }
+  fclose(f);
+
+  Elf32Header eh;
+  if (image.size() < sizeof(eh) || memcmp(image.data(), "\x7f" "ELF", 4) != 0 || image[4] != 1) {
+    fprintf(stderr, "%s is not a 32-bit ELF\n", path);
+    return false;
+  }
+  memcpy(&eh, image.data(), sizeof(eh));
+  for (uint16_t i = 0; i < eh.shnum; i++) {
+    size_t at = eh.shoff + (size_t)i * eh.shentsize;
+    if (at + sizeof(Elf32Section) > image.size()) {
+      break;
+    }
+    Elf32Section sh;
+    memcpy(&sh, image.data() + at, sizeof(sh));
+    // Format strings live in allocated, initialised sections (.rodata / .flash.rodata)
+    if (sh.type != SHT_PROGBITS || !(sh.flags & SHF_ALLOC) || sh.addr == 0 ||
+        (size_t)sh.offset + sh.size > image.size()) {
+      continue;
+    }
+    LoadedSection s;
+    s.addr = sh.addr;
+    s.data.assign(image.begin() + sh.offset, image.begin() + sh.offset + sh.size);
+    g_sections.push_back(std::move(s));
+  }
+  return !g_sections.empty();
+}
+
+static const char* formatAt(uint32_t address) {
+  for (const LoadedSection& s : g_sections) {
+    if (address >= s.addr && address < s.addr + s.data.size()) {
+      const char* text = s.data.data() + (address - s.addr);
+      size_t room = s.data.size() - (address - s.addr);
+      return (memchr(text, '\0', room) != nullptr) ? text : nullptr;
+    }
+  }
+  return nullptr;
+}
+
+static int hexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  return -1;
+}
+
+/**
+ * Decode one "#BL:" line into out
+ * @return false if the frame is malformed
+ */
+static bool decodeFrame(const char* hex, std::string& out) {
+  uint8_t bytes[BINLOG_MAX_RECORD];
+  size_t count = 0;
+  while (hex[0] != '\0' && hex[0] != '\r' && hex[0] != '\n') {
+    int hi = hexValue(hex[0]);
+    int lo = (hi >= 0) ? hexValue(hex[1]) : -1;
+    if (lo < 0 || count == sizeof(bytes)) {
+      return false;
+    }
+    bytes[count++] = (uint8_t)(hi << 4 | lo);
+    hex += 2;
+  }
+  if (count < 9) {
+    return false;
+  }
+
+  uint32_t ts, address;
+  memcpy(&ts, bytes + 1, 4);
+  memcpy(&address, bytes + 5, 4);
+
+  char text[BINLOG_MAX_LINE];
+  const char* fmt = formatAt(address);
+  if (fmt != nullptr) {
+    binlogFormat(fmt, bytes + 9, count - 9, text, sizeof(text));
+  } else {
+    snprintf(text, sizeof(text), "<unknown format 0x%08X - wrong ELF?>", address);
+  }
+
+  char prefix[32];
+  snprintf(prefix, sizeof(prefix), "[%5lu.%06lu] %c ", (unsigned long)(ts / 1000000),
+           (unsigned long)(ts % 1000000), binlogLevelChar(bytes[0]));
+  out = prefix;
+  out += text;
+  return true;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s firmware.elf < capture.txt\n", argv[0]);
+    return 2;
+  }
+  if (!loadElf(argv[1])) {
+    return 1;
+  }
+
+  char line[4096];
+  std::string decoded;
+  unsigned long frames = 0;
+  unsigned long bad = 0;
+  while (fgets(line, sizeof(line), stdin) != nullptr) {
+    const char* frame = strstr(line, "#BL:");
+    if (frame == nullptr) {
+      fputs(line, stdout);
+    } else if (decodeFrame(frame + 4, decoded)) {
+      puts(decoded.c_str());
+      frames++;
+    } else {
+      fputs(line, stdout);
+      bad++;
+    }
+    fflush(stdout);
+  }
+  fprintf(stderr, "%lu frame(s) decoded, %lu malformed\n", frames, bad);
+  return 0;
+}
@@ -0,0 +1,161 @@
+/*
+  Filename: ConfigStore.h
+  NVS-backed Configuration Store (header-only, ESP32 Arduino)
+
+  Description: Persists a ConfigTLV image in NVS through Preferences using
+               two slots. Each commit writes the complete image, stamped with
+               the next generation number, into the slot that does not hold
+               the current image. Loading picks the valid slot (magic,
+               version, CRC) with the highest generation. A power cut during
+               a commit therefore leaves the previous configuration intact.
+               Commits are skipped when no field changed.
+
+  Unlike the rest of Shared/ this header needs the Arduino Preferences
+  library; ConfigTLV.h itself stays host-buildable.
+*/
+
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "ConfigTLV.h"
+
+template <size_t Capacity>
+class ConfigStore {
+  public:
+    ConfigStore(const char* nvsNamespace)
+      : _namespace(nvsNamespace), _activeSlot(-1), _lastLoadUs(0) {}
+
+    ConfigTLV<Capacity>& blob() { return _blob; }
+    const ConfigTLV<Capacity>& blob() const { return _blob; }
+
+    /**
+     * Load the newest valid image from NVS
+     * @return true if a stored configuration was found
+     */
+    bool load() {
+      unsigned long startUs = micros();
+      uint8_t image[ConfigTLV<Capacity>::IMAGE_SIZE];
+      bool found = false;
+      uint32_t bestGeneration = 0;
+
+      _blob.clear();
+      _activeSlot = -1;
+      if (!_prefs.begin(_namespace, true)) {
+        _lastLoadUs = micros() - startUs;
+        return false;
+      }
+
+      for (int slot = 0; slot < 2; slot++) {
+        size_t len = _prefs.getBytesLength(slotKey(slot));
+        if (len == 0 || len > sizeof(image)) {
+          continue;
+        }
+        len = _prefs.getBytes(slotKey(slot), image, len);
+        if (len < CONFIG_TLV_HEADER_SIZE) {
+          continue;
+        }
+        uint32_t generation = ConfigTLV<Capacity>::imageGeneration(image);
+        if (found && generation <= bestGeneration) {
+          continue;
+        }
+        ConfigTLV<Capacity> candidate;
+        if (candidate.decode(image, len)) {
+          _blob = candidate;
+          _activeSlot = slot;
+          bestGeneration = generation;
+          found = true;
+        }
+      }
+
+      _prefs.end();
+      _lastLoadUs = micros() - startUs;
+      return found;
+    }
+
+    /**
+     * Write the image to the inactive slot if anything changed
+     * @return true if the configuration is on flash (written now or already current)
+     */
+    bool commit() {
+      if (!_blob.dirty() && _activeSlot >= 0) {
+        return true;
+      }
+
+      uint8_t image[ConfigTLV<Capacity>::IMAGE_SIZE];
+      uint32_t generation = _blob.generation() + 1;
+      size_t len = _blob.encode(image, sizeof(image), generation);
+      if (len == 0) {
+        return false;
+      }
+
+      int slot = (_activeSlot == 0) ? 1 : 0;
+      if (!_prefs.begin(_namespace, false)) {
+        return false;
+      }
+      // putBytes() ends in nvs_commit(); the other slot is untouched until the next commit
+      size_t written = _prefs.putBytes(slotKey(slot), image, len);
+      _prefs.end();
+      if (written != len) {
+        return false;
+      }
+
+      // Re-decode so the in-RAM generation matches what was stored
+      _blob.decode(image, len);
+      _activeSlot = slot;
+      return true;
+    }
+
+    /**
+     * Erase both slots (factory reset)
+     */
+    void erase() {
+      if (_prefs.begin(_namespace, false)) {
+        _prefs.clear();
+        _prefs.end();
+      }
+      _blob.clear();
+      _activeSlot = -1;
+    }
+
+    /**
+     * Copy the current image out, e.g. to RTC memory before deep sleep
+     * Commit first: the copy does not carry unsaved changes.
+     * @return image length, 0 if out is too small
+     */
+    size_t snapshot(uint8_t* out, size_t outSize) const {
+      return _blob.encode(out, outSize, _blob.generation());
+    }
+
+    /**
+     * Take an image from snapshot() instead of reading NVS
+     * @param slot  activeSlot() when the snapshot was taken
+     * @return false if the image is damaged (call load() instead)
+     */
+    bool restore(const uint8_t* image, size_t len, int slot) {
+      ConfigTLV<Capacity> candidate;
+      if (slot < 0 || slot > 1 || !candidate.decode(image, len)) {
+        return false;
+      }
+      _blob = candidate;
+      _activeSlot = slot;
+      _lastLoadUs = 0;
+      return true;
+    }
+
+    int activeSlot() const { return _activeSlot; }
+    bool hasStoredImage() const { return _activeSlot >= 0; }
+    unsigned long lastLoadMicros() const { return _lastLoadUs; }
+
+  private:
+    Preferences _prefs;
+    const char* _namespace;
+    ConfigTLV<Capacity> _blob;
+    int _activeSlot;
+    unsigned long _lastLoadUs;
+
+    static const char* slotKey(int slot) { return slot == 0 ? "cfg_a" : "cfg_b"; }
+};
+
+#endif
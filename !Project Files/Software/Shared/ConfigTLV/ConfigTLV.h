@@ -0,0 +1,277 @@
+/*
+  Filename: ConfigTLV.h
+  Binary TLV Configuration Blob (header-only, no Arduino dependency)
+
+  Description: Versioned, CRC-protected configuration image made of
+               tag/length/value records. Each firmware defines its own tags;
+               unknown tags are kept untouched so older firmware does not
+               drop settings written by newer firmware. Setters only mark
+               the blob dirty when a value actually changes, so an
+               unchanged SETUP never triggers a flash write.
+
+  Image layout (little-endian):
+    u16 magic 'WC' | u8 format version | u8 reserved | u32 generation
+    u16 body length | u32 CRC-32 of body | body: { u8 tag, u8 len, len bytes }*
+*/
+
+#ifndef CONFIG_TLV_H
+#define CONFIG_TLV_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define CONFIG_TLV_MAGIC        0x4357  // "WC"
+#define CONFIG_TLV_VERSION      1
+#define CONFIG_TLV_HEADER_SIZE  14
+#define CONFIG_TLV_MAX_VALUE    255
+
+inline uint32_t configCrc32(const uint8_t* data, size_t len) {
+  uint32_t crc = 0xFFFFFFFFu;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (int b = 0; b < 8; b++) {
+      crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+  }
+  return ~crc;
+}
+
+template <size_t Capacity>
+class ConfigTLV {
+  public:
+    static const size_t IMAGE_SIZE = CONFIG_TLV_HEADER_SIZE + Capacity;
+
+    ConfigTLV() { clear(); }
+
+    void clear() {
+      _used = 0;
+      _generation = 0;
+      _dirty = false;
+    }
+
+    bool dirty() const { return _dirty; }
+    void markClean() { _dirty = false; }
+    uint32_t generation() const { return _generation; }
+    size_t bodySize() const { return _used; }
+
+    // ---- setters (return false only when the blob is full; the image is then unchanged) ----
+
+    bool setBytes(uint8_t tag, const void* value, size_t len) {
+      if (len > CONFIG_TLV_MAX_VALUE) {
+        return false;
+      }
+
+      size_t offset;
+      size_t freed = 0;
+      bool found = find(tag, offset);
+      if (found) {
+        uint8_t oldLen = _body[offset + 1];
+        if (oldLen == len && memcmp(_body + offset + 2, value, len) == 0) {
+          return true;  // Unchanged
+        }
+        if (oldLen == len) {
+          memcpy(_body + offset + 2, value, len);
+          _dirty = true;
+          return true;
+        }
+        freed = 2 + oldLen;
+      }
+
+      // Check before erasing: a value that does not fit leaves the old one in place
+      if (_used - freed + 2 + len > Capacity) {
+        return false;
+      }
+      if (found) {
+        erase(offset);
+      }
+      _body[_used] = tag;
+      _body[_used + 1] = (uint8_t)len;
+      memcpy(_body + _used + 2, value, len);
+      _used += 2 + len;
+      _dirty = true;
+      return true;
+    }
+
+    bool setU32(uint8_t tag, uint32_t value) {
+      uint8_t raw[4] = {(uint8_t)value, (uint8_t)(value >> 8), (uint8_t)(value >> 16), (uint8_t)(value >> 24)};
+      return setBytes(tag, raw, sizeof(raw));
+    }
+
+    bool setFloat(uint8_t tag, float value) {
+      uint32_t bits;
+      memcpy(&bits, &value, sizeof(bits));
+      return setU32(tag, bits);
+    }
+
+    bool setBool(uint8_t tag, bool value) {
+      uint8_t raw = value ? 1 : 0;
+      return setBytes(tag, &raw, 1);
+    }
+
+    bool setString(uint8_t tag, const char* text, size_t len) {
+      return setBytes(tag, text, len);
+    }
+
+    void remove(uint8_t tag) {
+      size_t offset;
+      if (find(tag, offset)) {
+        erase(offset);
+        _dirty = true;
+      }
+    }
+
+    // ---- getters (leave out untouched when the tag is absent or malformed) ----
+
+    bool getBytes(uint8_t tag, const uint8_t*& value, size_t& len) const {
+      size_t offset;
+      if (!find(tag, offset)) {
+        return false;
+      }
+      len = _body[offset + 1];
+      value = _body + offset + 2;
+      return true;
+    }
+
+    bool getU32(uint8_t tag, uint32_t& out) const {
+      const uint8_t* raw;
+      size_t len;
+      if (!getBytes(tag, raw, len) || len != 4) {
+        return false;
+      }
+      out = (uint32_t)raw[0] | ((uint32_t)raw[1] << 8) | ((uint32_t)raw[2] << 16) | ((uint32_t)raw[3] << 24);
+      return true;
+    }
+
+    bool getFloat(uint8_t tag, float& out) const {
+      uint32_t bits;
+      if (!getU32(tag, bits)) {
+        return false;
+      }
+      memcpy(&out, &bits, sizeof(out));
+      return true;
+    }
+
+    bool getBool(uint8_t tag, bool& out) const {
+      const uint8_t* raw;
+      size_t len;
+      if (!getBytes(tag, raw, len) || len != 1) {
+        return false;
+      }
+      out = (raw[0] != 0);
+      return true;
+    }
+
+    // NUL-terminated copy, truncated to fit
+    bool getString(uint8_t tag, char* out, size_t outSize) const {
+      const uint8_t* raw;
+      size_t len;
+      if (outSize == 0 || !getBytes(tag, raw, len)) {
+        return false;
+      }
+      size_t n = len < (outSize - 1) ? len : (outSize - 1);
+      memcpy(out, raw, n);
+      out[n] = '\0';
+      return true;
+    }
+
+    // ---- image encode/decode ----
+
+    /**
+     * Serialise with the given generation
+     * @return image size, or 0 if out is too small
+     */
+    size_t encode(uint8_t* out, size_t outSize, uint32_t generation) const {
+      size_t total = CONFIG_TLV_HEADER_SIZE + _used;
+      if (outSize < total) {
+        return 0;
+      }
+      uint32_t crc = configCrc32(_body, _used);
+      out[0] = (uint8_t)(CONFIG_TLV_MAGIC & 0xFF);
+      out[1] = (uint8_t)(CONFIG_TLV_MAGIC >> 8);
+      out[2] = CONFIG_TLV_VERSION;
+      out[3] = 0;
+      putU32(out + 4, generation);
+      out[8] = (uint8_t)(_used & 0xFF);
+      out[9] = (uint8_t)(_used >> 8);
+      putU32(out + 10, crc);
+      memcpy(out + CONFIG_TLV_HEADER_SIZE, _body, _used);
+      return total;
+    }
+
+    /**
+     * Load an image; the current contents are kept if it is invalid
+     * @return true if magic, version, length and CRC all check out
+     */
+    bool decode(const uint8_t* in, size_t len) {
+      if (len < CONFIG_TLV_HEADER_SIZE) {
+        return false;
+      }
+      uint16_t magic = (uint16_t)(in[0] | (in[1] << 8));
+      size_t bodyLen = (size_t)(in[8] | (in[9] << 8));
+      if (magic != CONFIG_TLV_MAGIC || in[2] != CONFIG_TLV_VERSION ||
+          bodyLen > Capacity || CONFIG_TLV_HEADER_SIZE + bodyLen > len) {
+        return false;
+      }
+      const uint8_t* body = in + CONFIG_TLV_HEADER_SIZE;
+      if (configCrc32(body, bodyLen) != getU32Raw(in + 10) || !wellFormed(body, bodyLen)) {
+        return false;
+      }
+
+      memcpy(_body, body, bodyLen);
+      _used = bodyLen;
+      _generation = getU32Raw(in + 4);
+      _dirty = false;
+      return true;
+    }
+
+    static uint32_t imageGeneration(const uint8_t* in) { return getU32Raw(in + 4); }
+
+  private:
+    uint8_t _body[Capacity];
+    size_t _used;
+    uint32_t _generation;
+    bool _dirty;
+
+    static void putU32(uint8_t* p, uint32_t v) {
+      p[0] = (uint8_t)v;
+      p[1] = (uint8_t)(v >> 8);
+      p[2] = (uint8_t)(v >> 16);
+      p[3] = (uint8_t)(v >> 24);
+    }
+
+    static uint32_t getU32Raw(const uint8_t* p) {
+      return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    static bool wellFormed(const uint8_t* body, size_t len) {
+      size_t offset = 0;
+      while (offset < len) {
+        if (offset + 2 > len || offset + 2 + body[offset + 1] > len) {
+          return false;
+        }
+        offset += 2 + body[offset + 1];
+      }
+      return true;
+    }
+
+    bool find(uint8_t tag, size_t& offset) const {
+      size_t pos = 0;
+      while (pos + 2 <= _used) {
+        if (_body[pos] == tag) {
+          offset = pos;
+          return true;
+        }
+        pos += 2 + _body[pos + 1];
+      }
+      return false;
+    }
+
+    void erase(size_t offset) {
+      size_t recordLen = 2 + _body[offset + 1];
+      memmove(_body + offset, _body + offset + recordLen, _used - offset - recordLen);
+      _used -= recordLen;
+    }
+};
+
+#endif
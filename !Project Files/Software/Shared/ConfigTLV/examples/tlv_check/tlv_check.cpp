@@ -0,0 +1,132 @@
+/*
+  Filename: tlv_check.cpp
+  ConfigTLV checks and decode benchmark (Linux host)
+
+  Description: Round-trips a receiver-sized configuration, checks that
+               unchanged setters leave the image clean, that a resize too
+               big for the blob keeps the old value, that corrupted or
+               truncated images are rejected, and that the A/B slot rule
+               (highest valid generation wins) survives a torn write.
+               Then times decode() of a full image.
+               Exits non-zero if any check fails.
+
+  Build/run (from this folder):
+    g++ -O2 -std=c++17 -I../.. tlv_check.cpp -o tlv_check
+    ./tlv_check
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "ConfigTLV.h"
+
+typedef ConfigTLV<768> Config;
+
+static int g_failures = 0;
+
+static void expect(bool ok, const char* what) {
+  if (!ok) {
+    g_failures++;
+    printf("FAIL: %s\n", what);
+  }
+}
+
+static void fill(Config& cfg) {
+  cfg.setU32(0x01, 100);
+  cfg.setFloat(0x02, 2.0f);
+  cfg.setU32(0x03, 2000);
+  cfg.setU32(0x04, 20);
+  cfg.setBool(0x05, true);
+  cfg.setString(0x06, "TRK-042", 7);
+  cfg.setBool(0x07, true);
+  cfg.setString(0x08, "Left rear axle strain gauge", 27);
+  cfg.setString(0x10, "Wabash Yard", 11);
+  cfg.setString(0x18, "yard-pass-2026", 14);
+  cfg.setString(0x11, "Maintenance Shop", 16);
+  cfg.setString(0x19, "shop-pass", 9);
+}
+
+int main() {
+  Config cfg;
+  fill(cfg);
+  expect(cfg.dirty(), "new values mark the image dirty");
+
+  uint8_t image[Config::IMAGE_SIZE];
+  size_t len = cfg.encode(image, sizeof(image), 7);
+  expect(len == CONFIG_TLV_HEADER_SIZE + cfg.bodySize(), "encoded size");
+
+  Config loaded;
+  expect(loaded.decode(image, len), "decode valid image");
+  expect(loaded.generation() == 7, "generation round-trips");
+  expect(!loaded.dirty(), "decoded image starts clean");
+
+  uint32_t u = 0;
+  float f = 0;
+  char text[32];
+  expect(loaded.getU32(0x03, u) && u == 2000, "u32 round-trips");
+  expect(loaded.getFloat(0x02, f) && f == 2.0f, "float round-trips");
+  expect(loaded.getString(0x06, text, sizeof(text)) && strcmp(text, "TRK-042") == 0, "string round-trips");
+  expect(!loaded.getU32(0x42, u), "missing tag reports absent");
+
+  // Re-applying identical settings must not trigger a flash write
+  fill(loaded);
+  expect(!loaded.dirty(), "identical values leave the image clean");
+  loaded.setString(0x06, "TRK-043", 7);
+  expect(loaded.dirty(), "same-length change marks dirty");
+  loaded.markClean();
+  loaded.setString(0x06, "TRK-1000", 8);
+  expect(loaded.dirty() && loaded.getString(0x06, text, sizeof(text)) && strcmp(text, "TRK-1000") == 0,
+         "resized value replaces the old record");
+
+  // A resize that does not fit must leave the old record in place, not erase it
+  ConfigTLV<48> small;
+  small.setString(0x18, "yard-pass", 9);
+  small.setString(0x01, "filler-filler-filler", 20);
+  small.markClean();
+  char longValue[40];
+  memset(longValue, 'x', sizeof(longValue));
+  expect(!small.setString(0x18, longValue, sizeof(longValue)), "oversized resize refused");
+  expect(small.getString(0x18, text, sizeof(text)) && strcmp(text, "yard-pass") == 0 && !small.dirty(),
+         "refused resize keeps the old value and the image clean");
+  expect(small.setString(0x18, "yard-pass-2026-b", 16), "resize that fits only once the old record is freed");
+
+  // Corruption and truncation
+  uint8_t bad[Config::IMAGE_SIZE];
+  memcpy(bad, image, len);
+  bad[len - 1] ^= 0x01;
+  Config rejected;
+  expect(!rejected.decode(bad, len), "flipped body bit fails CRC");
+  expect(!rejected.decode(image, len - 1), "truncated image rejected");
+  memcpy(bad, image, len);
+  bad[2] = CONFIG_TLV_VERSION + 1;
+  expect(!rejected.decode(bad, len), "unknown format version rejected");
+
+  // Torn write into slot B: loader must fall back to slot A
+  uint8_t slotA[Config::IMAGE_SIZE];
+  uint8_t slotB[Config::IMAGE_SIZE];
+  size_t lenA = cfg.encode(slotA, sizeof(slotA), 7);
+  size_t lenB = loaded.encode(slotB, sizeof(slotB), 8);
+  memset(slotB + lenB / 2, 0xFF, lenB - lenB / 2);
+  Config a;
+  Config b;
+  bool okA = a.decode(slotA, lenA);
+  bool okB = b.decode(slotB, lenB);
+  expect(okA && !okB, "torn newer slot ignored, older slot still valid");
+
+  // Decode timing for a full image
+  const int iterations = 200000;
+  auto t0 = std::chrono::steady_clock::now();
+  uint32_t sink = 0;
+  for (int i = 0; i < iterations; i++) {
+    Config c;
+    c.decode(image, len);
+    sink += c.generation();
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / iterations;
+
+  printf("checks: %s (%d failure%s)\n", g_failures ? "FAIL" : "ok", g_failures, g_failures == 1 ? "" : "s");
+  printf("decode: %zu-byte image in %.0f ns (sink=%u)\n", len, ns, sink);
+  return g_failures ? 1 : 0;
+}
@@ -0,0 +1,140 @@
+/*
+  Filename: CsvChunker.h
+  Streaming CSV-to-LoRa Chunker (header-only, no Arduino dependency)
+
+  Description: Splits CSV file contents into LoRa-sized payloads while the
+               file is being read in blocks, so a multi-kilobyte event row
+               never has to sit in a String. Lines are cleaned the same way
+               the old readStringUntil()/trim() loop did: '\r' is dropped,
+               leading and trailing whitespace is trimmed, empty lines and
+               lines starting with the skip prefix (the CSV header) are
+               ignored. Each line is emitted as zero or more non-final chunks
+               (DATC:) followed by one final chunk (DATA:).
+
+  Usage:
+    CsvChunker<180> chunker("timestamp,");
+    while ((n = file.read(block, sizeof(block))) > 0) {
+      chunker.push(block, n, emit);   // emit(const char* data, size_t len, bool finalChunk)
+    }
+    chunker.finish(emit);             // last line without a trailing '\n'
+
+  Whitespace runs of more than HELD_WS_MAX characters that straddle a chunk
+  boundary at the very end of a line are sent rather than trimmed.
+*/
+
+#ifndef CSV_CHUNKER_H
+#define CSV_CHUNKER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+template <size_t ChunkSize>
+class CsvChunker {
+  public:
+    static const size_t HELD_WS_MAX = 16;
+
+    explicit CsvChunker(const char* skipPrefix = nullptr)
+      : _skipPrefix(skipPrefix), _skipPrefixLen(skipPrefix ? strlen(skipPrefix) : 0) {
+      static_assert(ChunkSize > HELD_WS_MAX, "chunk must hold the held whitespace run");
+      reset();
+    }
+
+    void reset() {
+      _len = 0;
+      _held = 0;
+      _lineStarted = false;
+      _sentPart = false;
+      _skipLine = false;
+      _lines = 0;
+    }
+
+    /**
+     * Number of lines emitted since reset()
+     */
+    uint32_t lines() const { return _lines; }
+
+    template <typename Emit>
+    void push(const char* data, size_t len, Emit emit) {
+      for (size_t i = 0; i < len; i++) {
+        char c = data[i];
+        if (c == '\n') {
+          endLine(emit);
+        } else if (c != '\r' && !_skipLine) {
+          append(c, emit);
+        }
+      }
+    }
+
+    template <typename Emit>
+    void finish(Emit emit) {
+      endLine(emit);
+    }
+
+  private:
+    const char* _skipPrefix;
+    size_t _skipPrefixLen;
+    char _buf[ChunkSize];
+    size_t _len;
+    char _heldWs[HELD_WS_MAX];   // Whitespace seen after a full chunk; dropped if the line ends
+    size_t _held;
+    bool _lineStarted;           // Seen a non-whitespace character
+    bool _sentPart;              // A DATC: chunk of this line already went out
+    bool _skipLine;
+    uint32_t _lines;
+
+    static bool isSpace(char c) {
+      return c == ' ' || c == '\t' || c == '\v' || c == '\f';
+    }
+
+    template <typename Emit>
+    void append(char c, Emit emit) {
+      bool space = isSpace(c);
+      if (!_lineStarted) {
+        if (space) {
+          return;
+        }
+        _lineStarted = true;
+      }
+
+      if (_len == ChunkSize) {
+        if (space && _held < HELD_WS_MAX) {
+          _heldWs[_held++] = c;
+          return;
+        }
+        emit(_buf, _len, false);
+        _sentPart = true;
+        _len = 0;
+        memcpy(_buf, _heldWs, _held);
+        _len = _held;
+        _held = 0;
+      }
+
+      _buf[_len++] = c;
+
+      if (!_sentPart && _skipPrefixLen > 0 && _len == _skipPrefixLen &&
+          memcmp(_buf, _skipPrefix, _skipPrefixLen) == 0) {
+        _skipLine = true;
+      }
+    }
+
+    template <typename Emit>
+    void endLine(Emit emit) {
+      if (!_skipLine) {
+        while (_len > 0 && isSpace(_buf[_len - 1])) {
+          _len--;
+        }
+        if (_len > 0 || _sentPart) {
+          emit(_buf, _len, true);
+          _lines++;
+        }
+      }
+      _len = 0;
+      _held = 0;
+      _lineStarted = false;
+      _sentPart = false;
+      _skipLine = false;
+    }
+};
+
+#endif
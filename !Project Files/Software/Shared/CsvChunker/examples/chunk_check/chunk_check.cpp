@@ -0,0 +1,188 @@
+/*
+  Filename: chunk_check.cpp
+  CsvChunker checks and allocation count (Linux host)
+
+  Description: 1) Checks CsvChunker against a reference that mirrors the old
+                  readStringUntil()/trim()/substring() loop in
+                  streamStoredEventsOverLoRa() on fixed and random files,
+                  fed in random block sizes.
+               2) Counts heap allocations per line for both, through the
+                  same malloc wrappers the firmware links with.
+               Exits non-zero if any check fails.
+
+  Build/run (from this folder):
+    g++ -O2 -std=c++17 -DALLOC_COUNTER_HOOKS -I../.. -I../../../AllocCounter \
+        chunk_check.cpp ../../../AllocCounter/AllocCounter.cpp -pthread \
+        -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free -o chunk_check
+    ./chunk_check [files=2000]
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "AllocCounter.h"
+#include "CsvChunker.h"
+
+#define CHUNK_SIZE 180
+
+// Route std::string through malloc in this object so the --wrap counters see it
+void* operator new(size_t n) {
+  void* p = malloc(n);
+  if (p == nullptr) throw std::bad_alloc();
+  return p;
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+struct Packet {
+  bool finalChunk;
+  std::string data;
+  bool operator==(const Packet& o) const { return finalChunk == o.finalChunk && data == o.data; }
+};
+
+static std::string trimCopy(const std::string& s) {
+  size_t b = s.find_first_not_of(" \t\r\n\v\f");
+  if (b == std::string::npos) return std::string();
+  size_t e = s.find_last_not_of(" \t\r\n\v\f");
+  return s.substr(b, e - b + 1);
+}
+
+// Mirrors the original String loop plus sendCsvLineOverLoRa()
+static void chunkReference(const std::string& file, std::vector<Packet>& out) {
+  size_t start = 0;
+  while (start < file.size()) {
+    size_t nl = file.find('\n', start);
+    if (nl == std::string::npos) nl = file.size();
+    std::string line = file.substr(start, nl - start);
+    start = nl + 1;
+
+    std::string clean;
+    for (char c : line) {
+      if (c != '\r') clean += c;
+    }
+    clean = trimCopy(clean);
+    if (clean.empty() || clean.compare(0, 10, "timestamp,") == 0) {
+      continue;
+    }
+    for (size_t i = 0; i < clean.size(); i += CHUNK_SIZE) {
+      size_t take = clean.size() - i > CHUNK_SIZE ? CHUNK_SIZE : clean.size() - i;
+      out.push_back({i + take >= clean.size(), clean.substr(i, take)});
+    }
+  }
+}
+
+static void chunkStreaming(const std::string& file, std::mt19937& rng, std::vector<Packet>& out) {
+  CsvChunker<CHUNK_SIZE> chunker("timestamp,");
+  auto emit = [&](const char* data, size_t len, bool finalChunk) {
+    out.push_back({finalChunk, std::string(data, len)});
+  };
+  size_t pos = 0;
+  while (pos < file.size()) {
+    size_t block = 1 + rng() % 300;
+    if (block > file.size() - pos) block = file.size() - pos;
+    chunker.push(file.data() + pos, block, emit);
+    pos += block;
+  }
+  chunker.finish(emit);
+}
+
+static std::string randomRow(std::mt19937& rng) {
+  std::string row = "\"2026-03-14 09:26:53 EST\",21.50,40.10";
+  int samples = rng() % 60;
+  char value[64];
+  for (int i = 0; i < samples; i++) {
+    snprintf(value, sizeof(value), ",%.3f,%.3f,%.3f,%.2f",
+             (int)(rng() % 4000) / 1000.0 - 2.0, (int)(rng() % 4000) / 1000.0 - 2.0,
+             (int)(rng() % 4000) / 1000.0 - 2.0, (int)(rng() % 200000) / 100.0 - 1000.0);
+    row += value;
+  }
+  return row;
+}
+
+static std::string randomFile(std::mt19937& rng) {
+  static const char* decorations[] = {"", "\r", "  ", "\t", " \r", "   \t  "};
+  std::string file;
+  int lines = 1 + rng() % 6;
+  for (int i = 0; i < lines; i++) {
+    switch (rng() % 8) {
+      case 0: file += "timestamp,temp,humidity,x,y,z,strain"; break;
+      case 1: break;  // blank line
+      case 2: file += std::string(CHUNK_SIZE, 'x'); break;
+      case 3: file += std::string(CHUNK_SIZE * 2, 'y'); break;
+      default: file += randomRow(rng); break;
+    }
+    file = std::string(decorations[rng() % 6]) + file;
+    file += decorations[rng() % 6];
+    if (i + 1 < lines || rng() % 2) file += '\n';
+  }
+  return file;
+}
+
+static int g_failures = 0;
+
+static void check(const std::string& file, std::mt19937& rng) {
+  std::vector<Packet> a, b;
+  chunkReference(file, a);
+  chunkStreaming(file, rng, b);
+  if (a != b) {
+    g_failures++;
+    if (g_failures <= 5) printf("MISMATCH (%zu vs %zu packets) in %zu-byte file\n", a.size(), b.size(), file.size());
+  }
+}
+
+int main(int argc, char** argv) {
+  int files = (argc > 1) ? atoi(argv[1]) : 2000;
+  allocCounterWatchCurrentTask();
+  std::mt19937 rng(12345);
+
+  check("", rng);
+  check("\n\n", rng);
+  check("timestamp,a,b\n\"t\",1,2\n", rng);
+  check(std::string(CHUNK_SIZE, 'a') + "\n", rng);
+  check(std::string(CHUNK_SIZE, 'a') + "   \n", rng);
+  check(std::string(CHUNK_SIZE + 1, 'a'), rng);
+  check("  lead and trail  \r\n", rng);
+  for (int i = 0; i < files; i++) {
+    check(randomFile(rng), rng);
+  }
+
+  // Allocations per streamed line: old String path vs chunker
+  std::string file;
+  for (int i = 0; i < 50; i++) file += randomRow(rng) + "\r\n";
+
+  std::vector<Packet> sink;
+  sink.reserve(4096);
+  AllocProbe reference("reference");
+  reference.begin();
+  chunkReference(file, sink);
+  reference.end();
+
+  CsvChunker<CHUNK_SIZE> chunker("timestamp,");
+  size_t sent = 0;
+  auto emit = [&](const char*, size_t len, bool) { sent += len; };
+  AllocProbe streaming("chunker");
+  streaming.begin();
+  for (size_t pos = 0; pos < file.size(); pos += 512) {
+    size_t block = file.size() - pos < 512 ? file.size() - pos : 512;
+    chunker.push(file.data() + pos, block, emit);
+  }
+  chunker.finish(emit);
+  streaming.end();
+
+  if (!allocCounterActive()) {
+    printf("FAIL: built without ALLOC_COUNTER_HOOKS\n");
+    g_failures++;
+  } else if (streaming.last() != 0) {
+    printf("FAIL: chunker allocated %u times\n", (unsigned)streaming.last());
+    g_failures++;
+  }
+
+  printf("checks: %s (%d failure%s)\n", g_failures ? "FAIL" : "ok", g_failures, g_failures == 1 ? "" : "s");
+  printf("allocations per line: reference %.1f, chunker %.1f (%u lines, %zu bytes)\n",
+         reference.last() / 50.0, streaming.last() / 50.0, (unsigned)chunker.lines(), sent);
+  return g_failures ? 1 : 0;
+}
@@ -0,0 +1,190 @@
+/*
+  Filename: I2CProfiler.cpp
+  I2C Bus Traffic Profiler Implementation
+
+  Description: The row table and the __wrap_* entry points for the linker's
+               --wrap option. Each wrapper times the real HAL call and
+               records it under the bus, address and first byte written.
+*/
+
+#include "I2CProfiler.h"
+
+#include <algorithm>
+#include <mutex>
+#include <string.h>
+
+#if __has_include(<esp_timer.h>)
+  #include <esp_timer.h>
+  static inline int64_t nowUs() { return esp_timer_get_time(); }
+#else
+  #include <chrono>
+  static inline int64_t nowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+#endif
+
+struct NamedAddress {
+  uint8_t address;
+  const char* name;
+};
+
+static std::mutex s_mutex;
+static I2CProfileEntry s_entries[I2C_PROFILER_MAX_ENTRIES];
+static size_t s_entryCount = 0;
+static uint32_t s_transactions = 0;
+static uint32_t s_unrecorded = 0;
+static int64_t s_windowStartUs = 0;   // The first window runs from boot
+static NamedAddress s_names[I2C_PROFILER_MAX_NAMES];
+static size_t s_nameCount = 0;
+
+void i2cProfilerName(uint8_t address, const char* name) {
+  std::lock_guard<std::mutex> guard(s_mutex);
+  for (size_t i = 0; i < s_nameCount; i++) {
+    if (s_names[i].address == address) {
+      s_names[i].name = name;
+      return;
+    }
+  }
+  if (s_nameCount < I2C_PROFILER_MAX_NAMES) {
+    s_names[s_nameCount++] = {address, name};
+  }
+}
+
+const char* i2cProfilerNameOf(uint8_t address) {
+  std::lock_guard<std::mutex> guard(s_mutex);
+  for (size_t i = 0; i < s_nameCount; i++) {
+    if (s_names[i].address == address) {
+      return s_names[i].name;
+    }
+  }
+  return nullptr;
+}
+
+void i2cProfilerRecord(uint8_t bus, uint8_t address, int16_t reg, uint8_t op,
+                       size_t txBytes, size_t rxBytes, uint32_t us, uint8_t result) {
+  std::lock_guard<std::mutex> guard(s_mutex);
+  s_transactions++;
+
+  I2CProfileEntry* entry = nullptr;
+  for (size_t i = 0; i < s_entryCount; i++) {
+    I2CProfileEntry& e = s_entries[i];
+    if (e.bus == bus && e.address == address && e.reg == reg && e.op == op) {
+      entry = &e;
+      break;
+    }
+  }
+  if (entry == nullptr) {
+    if (s_entryCount >= I2C_PROFILER_MAX_ENTRIES) {
+      s_unrecorded++;
+      return;
+    }
+    entry = &s_entries[s_entryCount++];
+    memset(entry, 0, sizeof(*entry));
+    entry->bus = bus;
+    entry->address = address;
+    entry->reg = reg;
+    entry->op = op;
+  }
+  entry->count++;
+  entry->txBytes += (uint32_t)txBytes;
+  entry->rxBytes += (uint32_t)rxBytes;
+  entry->busUs += us;
+  if (us > entry->maxUs) {
+    entry->maxUs = us;
+  }
+  if (result == 1) {
+    entry->naks++;
+  } else if (result == 2) {
+    entry->timeouts++;
+  }
+}
+
+size_t i2cProfilerTake(I2CProfileEntry* out, size_t maxEntries, I2CProfileWindow& window) {
+  size_t count;
+  {
+    std::lock_guard<std::mutex> guard(s_mutex);
+    int64_t now = nowUs();
+    window.elapsedUs = (now > s_windowStartUs) ? (uint64_t)(now - s_windowStartUs) : 0;
+    window.transactions = s_transactions;
+    window.unrecorded = s_unrecorded;
+    count = (s_entryCount < maxEntries) ? s_entryCount : maxEntries;
+    memcpy(out, s_entries, count * sizeof(I2CProfileEntry));
+    s_entryCount = 0;
+    s_transactions = 0;
+    s_unrecorded = 0;
+    s_windowStartUs = now;
+  }
+  std::sort(out, out + count, [](const I2CProfileEntry& a, const I2CProfileEntry& b) { return a.busUs > b.busUs; });
+  return count;
+}
+
+const char* i2cProfilerOpName(uint8_t op) {
+  switch (op) {
+    case I2C_OP_PROBE:      return "probe";
+    case I2C_OP_WRITE:      return "wr";
+    case I2C_OP_READ:       return "rd";
+    case I2C_OP_WRITE_READ: return "wr+rd";
+    default:                return "?";
+  }
+}
+
+#ifdef I2C_PROFILER_HOOKS
+
+#include "esp32-hal-i2c.h"
+
+static inline uint8_t resultOf(esp_err_t err) {
+  return (err == ESP_OK) ? 0 : (err == ESP_ERR_TIMEOUT) ? 2 : 1;
+}
+
+extern "C" {
+  esp_err_t __real_i2cWrite(uint8_t i2c_num, uint16_t address, const uint8_t* buff, size_t size,
+                            uint32_t timeOutMillis);
+  esp_err_t __real_i2cRead(uint8_t i2c_num, uint16_t address, uint8_t* buff, size_t size,
+                           uint32_t timeOutMillis, size_t* readCount);
+  esp_err_t __real_i2cWriteReadNonStop(uint8_t i2c_num, uint16_t address, const uint8_t* wbuff, size_t wsize,
+                                       uint8_t* rbuff, size_t rsize, uint32_t timeOutMillis, size_t* readCount);
+
+  esp_err_t __wrap_i2cWrite(uint8_t i2c_num, uint16_t address, const uint8_t* buff, size_t size,
+                            uint32_t timeOutMillis) {
+    int64_t start = nowUs();
+    esp_err_t err = __real_i2cWrite(i2c_num, address, buff, size, timeOutMillis);
+    uint32_t us = (uint32_t)(nowUs() - start);
+    if (size == 0) {
+      i2cProfilerRecord(i2c_num, (uint8_t)address, I2C_PROFILER_NO_REG, I2C_OP_PROBE, 0, 0, us, resultOf(err));
+    } else {
+      i2cProfilerRecord(i2c_num, (uint8_t)address, buff[0], I2C_OP_WRITE, size - 1, 0, us, resultOf(err));
+    }
+    return err;
+  }
+
+  esp_err_t __wrap_i2cRead(uint8_t i2c_num, uint16_t address, uint8_t* buff, size_t size,
+                           uint32_t timeOutMillis, size_t* readCount) {
+    int64_t start = nowUs();
+    esp_err_t err = __real_i2cRead(i2c_num, address, buff, size, timeOutMillis, readCount);
+    i2cProfilerRecord(i2c_num, (uint8_t)address, I2C_PROFILER_NO_REG, I2C_OP_READ, 0, *readCount,
+                      (uint32_t)(nowUs() - start), resultOf(err));
+    return err;
+  }
+
+  esp_err_t __wrap_i2cWriteReadNonStop(uint8_t i2c_num, uint16_t address, const uint8_t* wbuff, size_t wsize,
+                                       uint8_t* rbuff, size_t rsize, uint32_t timeOutMillis, size_t* readCount) {
+    int64_t start = nowUs();
+    esp_err_t err = __real_i2cWriteReadNonStop(i2c_num, address, wbuff, wsize, rbuff, rsize, timeOutMillis, readCount);
+    i2cProfilerRecord(i2c_num, (uint8_t)address, (wsize > 0) ? wbuff[0] : I2C_PROFILER_NO_REG, I2C_OP_WRITE_READ,
+                      (wsize > 0) ? wsize - 1 : 0, *readCount, (uint32_t)(nowUs() - start), resultOf(err));
+    return err;
+  }
+}
+
+bool i2cProfilerActive() {
+  return true;
+}
+
+#else
+
+bool i2cProfilerActive() {
+  return false;
+}
+
+#endif
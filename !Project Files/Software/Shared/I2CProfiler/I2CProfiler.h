@@ -0,0 +1,106 @@
+/*
+  Filename: I2CProfiler.h
+  I2C Bus Traffic Profiler
+
+  Description: Counts every I2C transaction the firmware makes, per bus,
+               device, register and kind, with bytes moved, time on the bus
+               and NACK/timeout counts. TwoWire's transaction calls are not
+               virtual and the drivers hold a plain TwoWire*, so the wrapper
+               sits one level down: linker wrappers around the core's
+               esp32-hal-i2c calls that TwoWire makes for every transaction.
+               No driver changes are needed. Enable by adding to
+               platformio.ini:
+
+                 build_flags =
+                   -D I2C_PROFILER_HOOKS
+                   -Wl,--wrap=i2cWrite -Wl,--wrap=i2cRead
+                   -Wl,--wrap=i2cWriteReadNonStop
+
+               The register is the first byte written: the register pointer
+               of a register write or read, or the command of a command-set
+               device such as the SHT45. A plain read (no write first) has
+               none. Bus time is measured around the HAL call, so it includes
+               clock stretching and the driver's wait for the bus lock.
+
+               Without I2C_PROFILER_HOOKS nothing is recorded and
+               i2cProfilerActive() returns false.
+
+  Usage:
+    i2cProfilerName(0x2A, "NAU7802");
+    ...
+    I2CProfileEntry rows[I2C_PROFILER_MAX_ENTRIES];
+    I2CProfileWindow window;
+    size_t n = i2cProfilerTake(rows, I2C_PROFILER_MAX_ENTRIES, window);   // busiest first
+*/
+
+#ifndef I2C_PROFILER_H
+#define I2C_PROFILER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define I2C_PROFILER_MAX_ENTRIES  48    // Distinct bus/device/register/kind rows
+#define I2C_PROFILER_MAX_NAMES    8
+#define I2C_PROFILER_NO_REG       -1
+
+enum I2CProfileOp : uint8_t {
+  I2C_OP_PROBE = 0,         // Address only (beginTransmission + endTransmission)
+  I2C_OP_WRITE = 1,         // Register or command write
+  I2C_OP_READ = 2,          // Read with no register write first
+  I2C_OP_WRITE_READ = 3     // Register write, repeated START, read
+};
+
+struct I2CProfileEntry {
+  uint8_t bus;
+  uint8_t address;
+  int16_t reg;              // I2C_PROFILER_NO_REG for a plain read or a probe
+  uint8_t op;               // I2CProfileOp
+  uint32_t count;
+  uint32_t txBytes;         // Bytes written after the register byte
+  uint32_t rxBytes;
+  uint32_t naks;
+  uint32_t timeouts;
+  uint64_t busUs;
+  uint32_t maxUs;
+};
+
+struct I2CProfileWindow {
+  uint64_t elapsedUs;       // Since the previous take (or boot)
+  uint32_t transactions;
+  uint32_t unrecorded;      // Transactions that found the table full
+};
+
+/**
+ * True when the firmware was linked with the I2C HAL wrappers
+ */
+bool i2cProfilerActive();
+
+/**
+ * Label a 7-bit address in the report; name must outlive the profiler
+ */
+void i2cProfilerName(uint8_t address, const char* name);
+
+/**
+ * Label for an address, or nullptr
+ */
+const char* i2cProfilerNameOf(uint8_t address);
+
+/**
+ * Count one transaction; the HAL wrappers call this
+ * @param result 0 ok, 1 NACK, 2 timeout
+ */
+void i2cProfilerRecord(uint8_t bus, uint8_t address, int16_t reg, uint8_t op,
+                       size_t txBytes, size_t rxBytes, uint32_t us, uint8_t result);
+
+/**
+ * Copy the rows, busiest (most bus time) first, and start a new window
+ * @return rows copied
+ */
+size_t i2cProfilerTake(I2CProfileEntry* out, size_t maxEntries, I2CProfileWindow& window);
+
+/**
+ * "rd" / "wr" / "wr+rd" / "probe"
+ */
+const char* i2cProfilerOpName(uint8_t op);
+
+#endif
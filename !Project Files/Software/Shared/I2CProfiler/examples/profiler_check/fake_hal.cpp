@@ -0,0 +1,70 @@
+/*
+  Filename: fake_hal.cpp
+  Scripted I2C HAL for profiler_check
+
+  Description: Stands in for the core's esp32-hal-i2c calls and the
+               esp_timer clock the profiler times them with. Each call
+               sleeps for the time the check asked for and returns the
+               result it asked for. It lives in its own file on purpose:
+               the linker only wraps references that cross object files,
+               so the check's calls must reach i2cWrite() and friends from
+               a different object than the one that defines them.
+*/
+
+#include <chrono>
+#include <thread>
+
+#include "esp32-hal-i2c.h"
+#include "esp_timer.h"
+#include "fake_hal.h"
+
+static uint32_t s_delayUs = 0;
+static esp_err_t s_result = ESP_OK;
+static uint32_t s_calls = 0;
+
+void fakeHalScript(uint32_t delayUs, esp_err_t result) {
+  s_delayUs = delayUs;
+  s_result = result;
+}
+
+uint32_t fakeHalCalls() {
+  return s_calls;
+}
+
+static esp_err_t runScript() {
+  s_calls++;
+  if (s_delayUs > 0) {
+    std::this_thread::sleep_for(std::chrono::microseconds(s_delayUs));
+  }
+  return s_result;
+}
+
+int64_t esp_timer_get_time() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+extern "C" {
+  esp_err_t i2cWrite(uint8_t, uint16_t, const uint8_t*, size_t, uint32_t) {
+    return runScript();
+  }
+
+  esp_err_t i2cRead(uint8_t, uint16_t, uint8_t* buff, size_t size, uint32_t, size_t* readCount) {
+    esp_err_t err = runScript();
+    *readCount = (err == ESP_OK) ? size : 0;
+    for (size_t i = 0; i < *readCount; i++) {
+      buff[i] = 0;
+    }
+    return err;
+  }
+
+  esp_err_t i2cWriteReadNonStop(uint8_t, uint16_t, const uint8_t*, size_t, uint8_t* rbuff, size_t rsize,
+                                uint32_t, size_t* readCount) {
+    esp_err_t err = runScript();
+    *readCount = (err == ESP_OK) ? rsize : 0;
+    for (size_t i = 0; i < *readCount; i++) {
+      rbuff[i] = 0;
+    }
+    return err;
+  }
+}
@@ -0,0 +1,23 @@
+/*
+  Filename: fake_hal.h
+  Scripted I2C HAL for profiler_check
+*/
+
+#ifndef FAKE_HAL_H
+#define FAKE_HAL_H
+
+#include <stdint.h>
+
+#include "esp_system.h"
+
+/**
+ * Delay and result for every HAL call until the next script
+ */
+void fakeHalScript(uint32_t delayUs, esp_err_t result);
+
+/**
+ * HAL calls made so far (reached the fake, whether or not they were wrapped)
+ */
+uint32_t fakeHalCalls();
+
+#endif
@@ -0,0 +1,194 @@
+/*
+  Filename: profiler_check.cpp
+  I2CProfiler checks (Linux host)
+
+  Description: Drives the profiler the way the firmware does, through the
+               HAL calls with the linker's --wrap in place, against a
+               scripted HAL (fake_hal.cpp) that sleeps and fails on request.
+               Checks that every call kind is recorded under the right
+               register and byte counts, that rows come back busiest first,
+               that NACKs and timeouts are counted apart, that a take starts
+               a fresh window, and that a full table counts the overflow
+               instead of dropping it silently. A build that loses the wrap
+               (the hooks define missing, or a HAL call and its caller in
+               one object) still links and runs, so the first check is that
+               calls reach the profiler at all. Exits non-zero if any check
+               fails.
+
+  Build/run (from this folder):
+    g++ -O2 -std=c++17 -DI2C_PROFILER_HOOKS -I../.. -I../../../../Native/src \
+        profiler_check.cpp fake_hal.cpp ../../I2CProfiler.cpp -o profiler_check -pthread \
+        -Wl,--wrap=i2cWrite -Wl,--wrap=i2cRead -Wl,--wrap=i2cWriteReadNonStop
+    ./profiler_check
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#include "I2CProfiler.h"
+#include "esp32-hal-i2c.h"
+#include "fake_hal.h"
+
+static int g_failures = 0;
+
+static void expect(bool ok, const char* what) {
+  if (!ok) {
+    g_failures++;
+    printf("FAIL: %s\n", what);
+  }
+}
+
+static I2CProfileEntry g_rows[I2C_PROFILER_MAX_ENTRIES];
+static I2CProfileWindow g_window;
+
+static size_t take() {
+  return i2cProfilerTake(g_rows, I2C_PROFILER_MAX_ENTRIES, g_window);
+}
+
+static const I2CProfileEntry* find(size_t n, uint8_t address, int16_t reg, uint8_t op) {
+  for (size_t i = 0; i < n; i++) {
+    if (g_rows[i].address == address && g_rows[i].reg == reg && g_rows[i].op == op) {
+      return &g_rows[i];
+    }
+  }
+  return nullptr;
+}
+
+static void writeReg(uint8_t address, uint8_t reg, size_t dataBytes) {
+  uint8_t buff[8] = {reg};
+  i2cWrite(0, address, buff, 1 + dataBytes, 50);
+}
+
+static void checkWrapped() {
+  expect(i2cProfilerActive(), "built with I2C_PROFILER_HOOKS");
+  take();
+
+  uint32_t before = fakeHalCalls();
+  fakeHalScript(0, ESP_OK);
+  writeReg(0x2A, 0x12, 1);
+  size_t n = take();
+  expect(fakeHalCalls() == before + 1, "wrapper calls through to the real HAL");
+  expect(n == 1 && g_window.transactions == 1, "HAL call reaches the profiler (--wrap in effect)");
+}
+
+static void checkKinds() {
+  uint8_t rx[8];
+  size_t got = 0;
+  uint8_t cmd[2] = {0xFD, 0x00};
+  fakeHalScript(0, ESP_OK);
+  i2cWrite(1, 0x44, nullptr, 0, 50);                        // Probe
+  i2cWrite(1, 0x44, cmd, 1, 50);                            // Command
+  i2cRead(1, 0x44, rx, 6, 50, &got);                        // Plain read
+  i2cWriteReadNonStop(1, 0x2A, cmd, 2, rx, 3, 50, &got);    // Register write, read
+
+  size_t n = take();
+  expect(n == 4, "one row per bus/device/register/kind");
+  const I2CProfileEntry* probe = find(n, 0x44, I2C_PROFILER_NO_REG, I2C_OP_PROBE);
+  const I2CProfileEntry* command = find(n, 0x44, 0xFD, I2C_OP_WRITE);
+  const I2CProfileEntry* read = find(n, 0x44, I2C_PROFILER_NO_REG, I2C_OP_READ);
+  const I2CProfileEntry* writeRead = find(n, 0x2A, 0xFD, I2C_OP_WRITE_READ);
+  expect(probe && probe->bus == 1 && probe->txBytes == 0 && probe->rxBytes == 0, "empty write is a probe");
+  expect(command && command->txBytes == 0, "command byte is the register, not data");
+  expect(read && read->rxBytes == 6, "plain read has no register");
+  expect(writeRead && writeRead->txBytes == 1 && writeRead->rxBytes == 3, "write-read counts both directions");
+}
+
+static void checkRanking() {
+  fakeHalScript(0, ESP_OK);
+  for (int i = 0; i < 5; i++) {
+    writeReg(0x18, 0x20, 1);
+  }
+  fakeHalScript(500, ESP_OK);
+  for (int i = 0; i < 3; i++) {
+    writeReg(0x2A, 0x00, 1);
+  }
+  fakeHalScript(20000, ESP_OK);
+  writeReg(0x44, 0x24, 0);
+
+  size_t n = take();
+  expect(n == 3, "three rows");
+  expect(n == 3 && g_rows[0].address == 0x44 && g_rows[1].address == 0x2A && g_rows[2].address == 0x18,
+         "ranked by bus time, not by count");
+  expect(n == 3 && g_rows[0].maxUs >= 20000 && g_rows[0].busUs >= 20000, "slow call's time recorded");
+  expect(n == 3 && g_rows[1].count == 3 && g_rows[1].busUs >= 1500 && g_rows[1].maxUs < g_rows[1].busUs,
+         "bus time sums, max keeps the worst");
+  expect(n == 3 && g_rows[2].count == 5 && g_rows[2].txBytes == 5, "count and bytes sum");
+}
+
+static void checkFailures() {
+  uint8_t rx[4];
+  size_t got = 0;
+  fakeHalScript(0, ESP_FAIL);
+  writeReg(0x50, 0x00, 2);
+  writeReg(0x50, 0x00, 2);
+  fakeHalScript(0, ESP_ERR_TIMEOUT);
+  writeReg(0x50, 0x00, 2);
+  fakeHalScript(0, ESP_OK);
+  writeReg(0x50, 0x00, 2);
+  fakeHalScript(0, ESP_FAIL);
+  i2cRead(0, 0x51, rx, 4, 50, &got);
+
+  size_t n = take();
+  const I2CProfileEntry* write = find(n, 0x50, 0x00, I2C_OP_WRITE);
+  const I2CProfileEntry* read = find(n, 0x51, I2C_PROFILER_NO_REG, I2C_OP_READ);
+  expect(write && write->count == 4, "failed transactions still counted");
+  expect(write && write->naks == 2 && write->timeouts == 1, "NACKs and timeouts counted apart");
+  expect(read && read->naks == 1 && read->timeouts == 0 && read->rxBytes == 0, "NACKed read moves no bytes");
+}
+
+static void checkWindow() {
+  fakeHalScript(0, ESP_OK);
+  writeReg(0x2A, 0x12, 1);
+  expect(take() == 1, "window holds its traffic");
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  size_t n = take();
+  expect(n == 0 && g_window.transactions == 0 && g_window.unrecorded == 0, "take starts an empty window");
+  expect(g_window.elapsedUs >= 5000 && g_window.elapsedUs < 1000000, "window elapsed runs from the last take");
+
+  writeReg(0x2A, 0x12, 1);
+  n = take();
+  expect(n == 1 && g_rows[0].count == 1, "row restarts from zero in the new window");
+}
+
+static void checkFull() {
+  fakeHalScript(0, ESP_OK);
+  for (int reg = 0; reg < I2C_PROFILER_MAX_ENTRIES + 3; reg++) {
+    writeReg(0x2A, (uint8_t)reg, 0);
+  }
+  writeReg(0x2A, 0x00, 0);   // Existing row still counts when the table is full
+
+  size_t n = take();
+  expect(n == I2C_PROFILER_MAX_ENTRIES, "table fills to capacity");
+  expect(g_window.transactions == I2C_PROFILER_MAX_ENTRIES + 4, "every transaction counted");
+  expect(g_window.unrecorded == 3, "overflow counted, not dropped silently");
+  const I2CProfileEntry* first = find(n, 0x2A, 0x00, I2C_OP_WRITE);
+  expect(first && first->count == 2, "known row updated when full");
+  expect(take() == 0 && g_window.unrecorded == 0, "overflow count resets with the window");
+}
+
+static void checkNames() {
+  i2cProfilerName(0x2A, "NAU7802");
+  i2cProfilerName(0x44, "SHT45");
+  expect(i2cProfilerNameOf(0x2A) && strcmp(i2cProfilerNameOf(0x2A), "NAU7802") == 0, "named address");
+  expect(i2cProfilerNameOf(0x18) == nullptr, "unnamed address");
+  i2cProfilerName(0x2A, "scale");
+  expect(i2cProfilerNameOf(0x2A) && strcmp(i2cProfilerNameOf(0x2A), "scale") == 0, "rename replaces");
+  expect(strcmp(i2cProfilerOpName(I2C_OP_WRITE_READ), "wr+rd") == 0 && strcmp(i2cProfilerOpName(9), "?") == 0,
+         "op names");
+}
+
+int main() {
+  checkWrapped();
+  checkKinds();
+  checkRanking();
+  checkFailures();
+  checkWindow();
+  checkFull();
+  checkNames();
+
+  printf("checks: %s (%d failure%s)\n", g_failures ? "FAIL" : "ok", g_failures, g_failures == 1 ? "" : "s");
+  return g_failures ? 1 : 0;
+}
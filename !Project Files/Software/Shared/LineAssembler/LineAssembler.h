@@ -0,0 +1,178 @@
+/*
+  Filename: LineAssembler.h
+  Non-Blocking Command Line Assembler (header-only, no Arduino dependency)
+
+  Description: Builds command lines from a serial port one byte at a time,
+               so loop() takes whatever has arrived and moves on instead of
+               waiting in readStringUntil() for the rest of a line. A line
+               ends at '\r' or '\n', or when nothing has been added for the
+               idle timeout (terminals that send no newline). Bytes that are
+               not in the line-start set are handed back at once as
+               one-character lines, so single-key commands need no Enter.
+               Lines longer than the buffer are dropped whole and counted.
+
+  Usage:
+    static LineAssembler<512> serialLine("SGL", 1000);   // SETUP:/SET:, GET:, LIST
+    if (serialLine.poll(Serial, millis())) {
+      dispatch(serialLine.line(), serialLine.length());
+    }
+*/
+
+#ifndef LINE_ASSEMBLER_H
+#define LINE_ASSEMBLER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+template <size_t Capacity>
+class LineAssembler {
+  static_assert(Capacity >= 2, "LineAssembler needs room for one character and NUL");
+
+  public:
+    /**
+     * @param lineStarts  first characters that begin a multi-character line;
+     *                    nullptr treats every byte as part of a line
+     * @param idleMs      a partial line with no new byte for this long is
+     *                    completed as-is (0 = wait for a newline)
+     */
+    explicit LineAssembler(const char* lineStarts = nullptr, uint32_t idleMs = 0)
+      : _lineStarts(lineStarts), _idleMs(idleMs) {
+      clear();
+    }
+
+    void clear() {
+      _length = 0;
+      _ready = false;
+      _discarding = false;
+      _lastByteMs = 0;
+      _buffer[0] = '\0';
+    }
+
+    /**
+     * Add one received byte
+     * @return true when a line is complete; read it with line()/length()
+     *         before the next push()
+     */
+    bool push(char c, uint32_t nowMs) {
+      if (_ready) {
+        _length = 0;
+        _ready = false;
+      }
+      _lastByteMs = nowMs;
+
+      if (c == '\r' || c == '\n') {
+        if (_discarding) {
+          _discarding = false;
+          _length = 0;
+          return false;
+        }
+        return finish();
+      }
+      if (_discarding) {
+        return false;
+      }
+
+      if (_length == 0 && _lineStarts != nullptr && !isTrimChar(c) &&
+          strchr(_lineStarts, c) == nullptr) {
+        // Single-key command: complete on its own
+        _buffer[0] = c;
+        _length = 1;
+        return finish();
+      }
+
+      if (_length + 1 >= Capacity) {
+        _overflows++;
+        _discarding = true;
+        _length = 0;
+        return false;
+      }
+      _buffer[_length++] = c;
+      return false;
+    }
+
+    /**
+     * Complete a partial line that has been idle for idleMs
+     * @return true if a line was completed
+     */
+    bool expire(uint32_t nowMs) {
+      if (_ready || _idleMs == 0 || (_length == 0 && !_discarding) ||
+          nowMs - _lastByteMs < _idleMs) {
+        return false;
+      }
+      if (_discarding) {
+        _discarding = false;
+        _length = 0;
+        return false;
+      }
+      _timeouts++;
+      return finish();
+    }
+
+    /**
+     * Take what a stream has buffered, at most maxBytes, without waiting
+     * Stops after a complete line so the next one stays in the stream.
+     * @return true when a line is complete
+     */
+    template <typename StreamT>
+    bool poll(StreamT& in, uint32_t nowMs, size_t maxBytes = Capacity) {
+      while (maxBytes-- > 0 && in.available() > 0) {
+        int c = in.read();
+        if (c < 0) {
+          break;
+        }
+        if (push((char)c, nowMs)) {
+          return true;
+        }
+      }
+      return expire(nowMs);
+    }
+
+    const char* line() const { return _buffer; }
+    size_t length() const { return _ready ? _length : 0; }
+
+    // Bytes of a line still being received
+    bool pending() const { return !_ready && (_length > 0 || _discarding); }
+
+    uint32_t lineCount() const { return _lines; }
+    uint32_t overflowCount() const { return _overflows; }
+    uint32_t timeoutCount() const { return _timeouts; }
+
+  private:
+    char _buffer[Capacity];
+    size_t _length;
+    bool _ready;
+    bool _discarding;
+    uint32_t _lastByteMs;
+    const char* _lineStarts;
+    uint32_t _idleMs;
+    uint32_t _lines = 0;
+    uint32_t _overflows = 0;
+    uint32_t _timeouts = 0;
+
+    static bool isTrimChar(char c) {
+      return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+    }
+
+    // Trim like String::trim(); empty lines are not reported
+    bool finish() {
+      size_t begin = 0;
+      size_t end = _length;
+      while (begin < end && isTrimChar(_buffer[begin])) begin++;
+      while (end > begin && isTrimChar(_buffer[end - 1])) end--;
+      if (begin == end) {
+        _length = 0;
+        return false;
+      }
+      if (begin > 0) {
+        memmove(_buffer, _buffer + begin, end - begin);
+      }
+      _length = end - begin;
+      _buffer[_length] = '\0';
+      _ready = true;
+      _lines++;
+      return true;
+    }
+};
+
+#endif
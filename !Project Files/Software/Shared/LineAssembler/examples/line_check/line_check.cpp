@@ -0,0 +1,147 @@
+/*
+  Filename: line_check.cpp
+  LineAssembler checks (Linux host)
+
+  Description: Feeds the receiver's serial traffic through the assembler:
+               single-key commands with and without Enter, SETUP:/SET:/
+               GET:/LIST lines split across many polls, CR/LF variants,
+               idle completion of a bare 'S', oversize lines and a stream
+               holding several lines at once. Exits non-zero if any check
+               fails.
+
+  Build/run (from this folder):
+    g++ -O2 -std=c++17 -I../.. line_check.cpp -o line_check
+    ./line_check
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "LineAssembler.h"
+
+static int g_failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+      g_failures++; \
+      printf("FAIL line %d: %s\n", __LINE__, #cond); \
+    } \
+  } while (0)
+
+// Minimal Stream: available()/read() over a string
+struct FakeStream {
+  std::string data;
+  size_t pos = 0;
+  int available() const { return (int)(data.size() - pos); }
+  int read() { return pos < data.size() ? (unsigned char)data[pos++] : -1; }
+};
+
+// Poll until the stream is drained, collecting every completed line
+static std::vector<std::string> drain(LineAssembler<64>& lines, FakeStream& in, uint32_t nowMs) {
+  std::vector<std::string> out;
+  while (in.available() > 0) {
+    if (lines.poll(in, nowMs, 4)) {
+      out.push_back(std::string(lines.line(), lines.length()));
+    }
+  }
+  return out;
+}
+
+static void checkSingleKeys() {
+  LineAssembler<64> lines("SGL", 1000);
+  FakeStream in{"zm"};
+  std::vector<std::string> got = drain(lines, in, 0);
+  CHECK(got.size() == 2 && got[0] == "z" && got[1] == "m");
+
+  // The capture script stops a mode with "x\n"; the newline must not produce a line
+  FakeStream stop{"x\n\r\n"};
+  got = drain(lines, stop, 10);
+  CHECK(got.size() == 1 && got[0] == "x");
+  CHECK(!lines.pending());
+}
+
+static void checkSplitLines() {
+  LineAssembler<64> lines("SGL", 1000);
+  const char* text = "SET:nau.gain=64\r\n";
+  // One byte per poll, as if loop() ran between every UART byte
+  std::vector<std::string> got;
+  for (size_t i = 0; text[i] != '\0'; i++) {
+    FakeStream in{std::string(1, text[i])};
+    if (lines.poll(in, (uint32_t)i)) {
+      got.push_back(lines.line());
+    }
+    if (text[i] != '\r' && text[i] != '\n') {
+      CHECK(lines.pending());
+    }
+  }
+  CHECK(got.size() == 1 && got[0] == "SET:nau.gain=64");
+
+  FakeStream several{"GET:lora.sf\nLIST:nau\n  SETUP:TRUCK=12  \n"};
+  got = drain(lines, several, 100);
+  CHECK(got.size() == 3 && got[0] == "GET:lora.sf" && got[1] == "LIST:nau" && got[2] == "SETUP:TRUCK=12");
+}
+
+static void checkIdle() {
+  LineAssembler<64> lines("SGL", 1000);
+  FakeStream in{"S"};
+  CHECK(!lines.poll(in, 5000));
+  CHECK(lines.pending());
+  FakeStream empty{""};
+  CHECK(!lines.poll(empty, 5999));
+  CHECK(lines.poll(empty, 6000));
+  CHECK(std::string(lines.line()) == "S");
+  CHECK(lines.timeoutCount() == 1);
+  CHECK(!lines.poll(empty, 9000));
+
+  // Without an idle timeout a partial line waits for its newline
+  LineAssembler<64> noIdle("SGL", 0);
+  FakeStream partial{"LIST"};
+  CHECK(!noIdle.poll(partial, 0));
+  CHECK(!noIdle.poll(empty, 100000));
+  FakeStream newline{"\n"};
+  CHECK(noIdle.poll(newline, 100001) && std::string(noIdle.line()) == "LIST");
+}
+
+static void checkOverflow() {
+  LineAssembler<16> lines("SGL", 1000);
+  std::string longLine = "SETUP:" + std::string(40, 'A') + "\nGET:x\n";
+  FakeStream in{longLine};
+  std::vector<std::string> got;
+  while (in.available() > 0) {
+    if (lines.poll(in, 0)) got.push_back(lines.line());
+  }
+  CHECK(got.size() == 1 && got[0] == "GET:x");
+  CHECK(lines.overflowCount() == 1);
+
+  // 15 characters fit exactly (plus NUL)
+  FakeStream exact{"S" + std::string(14, 'b') + "\n"};
+  CHECK(lines.poll(exact, 0) && lines.length() == 15);
+
+  // An oversize line that never ends is dropped by the idle timeout, not dispatched
+  FakeStream runaway{"S" + std::string(30, 'c')};
+  CHECK(!lines.poll(runaway, 0, 100));
+  FakeStream empty{""};
+  CHECK(!lines.poll(empty, 2000));
+  CHECK(!lines.pending());
+  CHECK(lines.overflowCount() == 2);
+}
+
+static void checkNoLineStarts() {
+  // Without a line-start set every byte belongs to a line (transmitter host commands)
+  LineAssembler<64> lines(nullptr, 0);
+  FakeStream in{"SCAN\nmemstat\n"};
+  std::vector<std::string> got = drain(lines, in, 0);
+  CHECK(got.size() == 2 && got[0] == "SCAN" && got[1] == "memstat");
+}
+
+int main() {
+  checkSingleKeys();
+  checkSplitLines();
+  checkIdle();
+  checkOverflow();
+  checkNoLineStarts();
+  printf("checks: %s (%d failure%s)\n", g_failures ? "FAIL" : "ok", g_failures, g_failures == 1 ? "" : "s");
+  return g_failures ? 1 : 0;
+}
@@ -0,0 +1,232 @@
+/*
+  Filename: LineRing.h
+  Incremental Line Parser (header-only, no Arduino dependency)
+
+  Description: Fixed-size ring buffer that socket/serial data is read into
+               in large blocks. Line boundaries are found in place with
+               memchr, and each line is handed back as a view of at most two
+               spans (the ring may wrap mid-line), so payloads can be
+               forwarded to a writer without copying or heap allocation.
+
+  Usage:
+    static LineRing<8192> ring;
+    size_t room;
+    char* dst = ring.writeSpan(room);
+    size_t n = client.read((uint8_t*)dst, room);
+    ring.commit(n);
+    LineView line;
+    while (ring.nextLine(line)) {
+      if (line.startsWith("DATA:")) forward(line.dropFront(5));
+    }
+
+  A LineView stays valid until the next writeSpan()/commit() call.
+*/
+
+#ifndef LINE_RING_H
+#define LINE_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+struct LineView {
+  const char* first;
+  size_t firstLen;
+  const char* second;
+  size_t secondLen;
+
+  size_t length() const { return firstLen + secondLen; }
+
+  char at(size_t i) const {
+    return (i < firstLen) ? first[i] : second[i - firstLen];
+  }
+
+  bool startsWith(const char* prefix) const {
+    size_t n = strlen(prefix);
+    if (n > length()) {
+      return false;
+    }
+    for (size_t i = 0; i < n; i++) {
+      if (at(i) != prefix[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool equals(const char* text) const {
+    return strlen(text) == length() && startsWith(text);
+  }
+
+  // Drop n bytes from the front (e.g. a "DATA:" prefix)
+  LineView dropFront(size_t n) const {
+    LineView v = *this;
+    if (n >= v.firstLen) {
+      n -= v.firstLen;
+      if (n > v.secondLen) n = v.secondLen;
+      v.first = v.second + n;
+      v.firstLen = v.secondLen - n;
+      v.second = nullptr;
+      v.secondLen = 0;
+    } else {
+      v.first += n;
+      v.firstLen -= n;
+    }
+    return v;
+  }
+
+  // Call fn(ptr, len) for each contiguous span; lets any writer consume the line in place
+  template <typename Fn>
+  void forEachSpan(Fn fn) const {
+    if (firstLen > 0) fn(first, firstLen);
+    if (secondLen > 0) fn(second, secondLen);
+  }
+
+  // Copy into a caller buffer (NUL-terminated, truncated to fit); for the rare slow paths
+  size_t copyTo(char* out, size_t outSize) const {
+    if (outSize == 0) {
+      return 0;
+    }
+    size_t n = length() < (outSize - 1) ? length() : (outSize - 1);
+    size_t a = n < firstLen ? n : firstLen;
+    memcpy(out, first, a);
+    if (n > a) {
+      memcpy(out + a, second, n - a);
+    }
+    out[n] = '\0';
+    return n;
+  }
+};
+
+template <size_t Capacity>
+class LineRing {
+  static_assert(Capacity >= 64 && (Capacity & (Capacity - 1)) == 0,
+                "LineRing capacity must be a power of two");
+
+  public:
+    LineRing() { clear(); }
+
+    void clear() {
+      _head = 0;
+      _tail = 0;
+      _scan = 0;
+      _discarding = false;
+      _lines = 0;
+      _bytesIn = 0;
+      _overflows = 0;
+    }
+
+    size_t size() const { return _tail - _head; }
+    size_t freeSpace() const { return Capacity - size(); }
+
+    /**
+     * Contiguous free region to read into; room is 0 when the ring is full
+     */
+    char* writeSpan(size_t& room) {
+      size_t start = _tail & MASK;
+      size_t contiguous = Capacity - start;
+      size_t free = freeSpace();
+      room = free < contiguous ? free : contiguous;
+      return _buffer + start;
+    }
+
+    void commit(size_t n) {
+      _tail += n;
+      _bytesIn += n;
+    }
+
+    /**
+     * Extract the next complete line (without \n, trimmed like String::trim())
+     * Empty lines are skipped. Returns false when no complete line is buffered.
+     */
+    bool nextLine(LineView& out) {
+      while (true) {
+        size_t nl;
+        if (!findNewline(nl)) {
+          if (size() == Capacity) {
+            // Line longer than the ring: drop it and resync on the next newline.
+            _overflows++;
+            _discarding = true;
+            _head = _tail;
+            _scan = _tail;
+          }
+          return false;
+        }
+
+        size_t lineStart = _head;
+        _head = nl + 1;
+        _scan = _head;
+
+        if (_discarding) {
+          _discarding = false;
+          continue;
+        }
+
+        size_t begin = lineStart;
+        size_t end = nl;
+        while (begin < end && isTrimChar(_buffer[begin & MASK])) begin++;
+        while (end > begin && isTrimChar(_buffer[(end - 1) & MASK])) end--;
+        if (begin == end) {
+          continue;
+        }
+
+        makeView(begin, end, out);
+        _lines++;
+        return true;
+      }
+    }
+
+    uint32_t lineCount() const { return _lines; }
+    uint32_t bytesIn() const { return _bytesIn; }
+    uint32_t overflowCount() const { return _overflows; }
+
+  private:
+    static const size_t MASK = Capacity - 1;
+
+    char _buffer[Capacity];
+    size_t _head;    // First unread byte (monotonic index)
+    size_t _tail;    // One past the last written byte (monotonic index)
+    size_t _scan;    // Bytes before this are known not to contain '\n'
+    bool _discarding;
+    uint32_t _lines;
+    uint32_t _bytesIn;
+    uint32_t _overflows;
+
+    static bool isTrimChar(char c) {
+      return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+    }
+
+    bool findNewline(size_t& pos) {
+      while (_scan < _tail) {
+        size_t start = _scan & MASK;
+        size_t contiguous = Capacity - start;
+        size_t pending = _tail - _scan;
+        size_t len = pending < contiguous ? pending : contiguous;
+        const char* hit = (const char*)memchr(_buffer + start, '\n', len);
+        if (hit != nullptr) {
+          pos = _scan + (size_t)(hit - (_buffer + start));
+          return true;
+        }
+        _scan += len;
+      }
+      return false;
+    }
+
+    void makeView(size_t begin, size_t end, LineView& out) const {
+      size_t start = begin & MASK;
+      size_t len = end - begin;
+      size_t contiguous = Capacity - start;
+      out.first = _buffer + start;
+      if (len <= contiguous) {
+        out.firstLen = len;
+        out.second = nullptr;
+        out.secondLen = 0;
+      } else {
+        out.firstLen = contiguous;
+        out.second = _buffer;
+        out.secondLen = len - contiguous;
+      }
+    }
+};
+
+#endif
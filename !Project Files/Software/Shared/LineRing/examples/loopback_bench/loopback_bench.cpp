@@ -0,0 +1,240 @@
+/*
+  Filename: loopback_bench.cpp
+  LineRing loopback benchmark (Linux host)
+
+  Description: Streams synthetic receiver offload traffic (EVENT_FILE markers,
+               DATA:/DATC: rows, END:D) over a TCP loopback socket and parses
+               it two ways:
+                 ring   - LineRing + large recv() blocks, payloads forwarded in place
+                 string - per-line std::string copies mirroring the old
+                          readStringUntil()/replace()/trim()/substring() path
+               Reports throughput, ns per line and heap allocations per line.
+
+  Build/run (from this folder):
+    g++ -O2 -std=c++17 -I../.. loopback_bench.cpp -o loopback_bench -pthread
+    ./loopback_bench [lines=200000] [row_bytes=600]
+*/
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <thread>
+
+#include "LineRing.h"
+
+// Only the parsing thread is counted; the writer thread allocates freely.
+static std::atomic<uint64_t> g_allocations{0};
+static thread_local bool t_countAllocations = false;
+
+void* operator new(size_t n) {
+  if (t_countAllocations) g_allocations.fetch_add(1, std::memory_order_relaxed);
+  void* p = malloc(n);
+  if (p == nullptr) throw std::bad_alloc();
+  return p;
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+struct Sink {
+  uint64_t bytes = 0;
+  uint64_t lines = 0;
+  uint32_t checksum = 0;
+
+  void write(const char* data, size_t len) {
+    bytes += len;
+    for (size_t i = 0; i < len; i++) checksum += (uint8_t)data[i];
+  }
+};
+
+static std::string makeRow(size_t rowBytes, unsigned seed) {
+  std::string row = "\"2026-03-12 10:15:00 EST\",21.50,40.10";
+  char sample[48];
+  while (row.size() < rowBytes) {
+    snprintf(sample, sizeof(sample), ",%.3f,%.3f,%.3f,%.2f",
+             0.01 * (seed % 97), -0.02 * (seed % 31), 1.0 + 0.001 * (seed % 7), 12.5 + seed % 50);
+    row += sample;
+    seed = seed * 1103515245u + 12345u;
+  }
+  return row;
+}
+
+// Whole stream is generated up front so the timed section measures parsing, not formatting
+static std::string buildStream(size_t lines, size_t rowBytes) {
+  std::string stream;
+  for (size_t i = 0; i < lines; i++) {
+    if (i % 50 == 0) {
+      stream += "DATA:EVENT_FILE:event " + std::to_string(i / 50 + 1) + ".csv\r\n";
+    }
+    std::string row = makeRow(rowBytes, (unsigned)i);
+    if (i % 10 == 9) {
+      // Exercise the chunked form the LoRa path produces
+      stream += "DATC:" + row.substr(0, row.size() / 2) + "\r\n";
+      stream += "DATA:" + row.substr(row.size() / 2) + "\r\n";
+    } else {
+      stream += "DATA:" + row + "\r\n";
+    }
+  }
+  stream += "END:D\r\n";
+  return stream;
+}
+
+static void writer(int port, const std::string* stream) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+    perror("connect");
+    exit(1);
+  }
+
+  size_t sent = 0;
+  while (sent < stream->size()) {
+    ssize_t n = send(fd, stream->data() + sent, stream->size() - sent, 0);
+    if (n <= 0) break;
+    sent += (size_t)n;
+  }
+  close(fd);
+}
+
+static int acceptOne(int listenFd) {
+  int fd = accept(listenFd, nullptr, nullptr);
+  if (fd < 0) {
+    perror("accept");
+    exit(1);
+  }
+  return fd;
+}
+
+static void parseRing(int fd, Sink& sink) {
+  static LineRing<8192> ring;
+  ring.clear();
+  auto forward = [&sink](const char* p, size_t n) { sink.write(p, n); };
+
+  while (true) {
+    size_t room;
+    char* dst = ring.writeSpan(room);
+    ssize_t n = (room > 0) ? recv(fd, dst, room, 0) : 0;
+    if (room > 0 && n <= 0) return;
+    ring.commit((size_t)(n > 0 ? n : 0));
+
+    LineView line;
+    while (ring.nextLine(line)) {
+      if (line.startsWith("DATA:")) {
+        line.dropFront(5).forEachSpan(forward);
+        sink.write("\n", 1);
+        sink.lines++;
+      } else if (line.startsWith("DATC:")) {
+        line.dropFront(5).forEachSpan(forward);
+      } else if (line.equals("END:D")) {
+        return;
+      }
+    }
+  }
+}
+
+static void parseString(int fd, Sink& sink) {
+  // Buffered reader so the comparison isolates per-line String handling
+  char buf[4096];
+  size_t len = 0;
+  size_t pos = 0;
+  std::string line;
+
+  while (true) {
+    if (pos == len) {
+      ssize_t n = recv(fd, buf, sizeof(buf), 0);
+      if (n <= 0) return;
+      len = (size_t)n;
+      pos = 0;
+    }
+    char c = buf[pos++];
+    if (c != '\n') {
+      line += c;  // readStringUntil() appends one char at a time
+      continue;
+    }
+
+    std::string work = line;  // String returned by value
+    line.clear();
+    size_t r;
+    while ((r = work.find('\r')) != std::string::npos) work.erase(r, 1);
+    size_t b = work.find_first_not_of(" \t");
+    size_t e = work.find_last_not_of(" \t");
+    work = (b == std::string::npos) ? std::string() : work.substr(b, e - b + 1);
+    if (work.empty()) continue;
+
+    if (work.compare(0, 5, "DATA:") == 0) {
+      std::string payload = work.substr(5);
+      sink.write(payload.data(), payload.size());
+      sink.write("\n", 1);
+      sink.lines++;
+    } else if (work.compare(0, 5, "DATC:") == 0) {
+      std::string payload = work.substr(5);
+      sink.write(payload.data(), payload.size());
+    } else if (work == "END:D") {
+      return;
+    }
+  }
+}
+
+static void runCase(const char* name, void (*parser)(int, Sink&), const std::string& stream) {
+  int listenFd = socket(AF_INET, SOCK_STREAM, 0);
+  int one = 1;
+  setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = 0;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  bind(listenFd, (sockaddr*)&addr, sizeof(addr));
+  listen(listenFd, 1);
+  socklen_t alen = sizeof(addr);
+  getsockname(listenFd, (sockaddr*)&addr, &alen);
+  int port = ntohs(addr.sin_port);
+
+  std::thread tx(writer, port, &stream);
+  int fd = acceptOne(listenFd);
+
+  Sink sink;
+  uint64_t allocBefore = g_allocations.load();
+  auto t0 = std::chrono::steady_clock::now();
+  t_countAllocations = true;
+  parser(fd, sink);
+  t_countAllocations = false;
+  auto t1 = std::chrono::steady_clock::now();
+  uint64_t allocs = g_allocations.load() - allocBefore;
+
+  tx.join();
+  close(fd);
+  close(listenFd);
+
+  double sec = std::chrono::duration<double>(t1 - t0).count();
+  printf("%-7s lines=%llu payload=%.1f MB time=%.3f s rate=%.1f MB/s %.0f ns/line allocs/line=%.2f checksum=%u\n",
+         name,
+         (unsigned long long)sink.lines,
+         sink.bytes / 1e6,
+         sec,
+         sink.bytes / 1e6 / sec,
+         sec * 1e9 / (double)(sink.lines ? sink.lines : 1),
+         (double)allocs / (double)(sink.lines ? sink.lines : 1),
+         sink.checksum);
+}
+
+int main(int argc, char** argv) {
+  size_t lines = argc > 1 ? strtoul(argv[1], nullptr, 10) : 200000;
+  size_t rowBytes = argc > 2 ? strtoul(argv[2], nullptr, 10) : 600;
+
+  std::string stream = buildStream(lines, rowBytes);
+  printf("stream: %zu lines, %.1f MB\n", lines, stream.size() / 1e6);
+  runCase("string", parseString, stream);
+  runCase("ring", parseRing, stream);
+  return 0;
+}
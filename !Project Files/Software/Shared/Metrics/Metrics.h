@@ -0,0 +1,334 @@
+/*
+  Filename: Metrics.h
+  Counters, Gauges and Latency Histograms (header-only, no Arduino dependency)
+
+  Description: Named metrics declared as globals next to the code they
+               measure. Every metric registers itself on construction, so a
+               dump or a LoRa snapshot walks one list. Histograms use fixed
+               log-linear buckets: values below 4 are exact, every power of
+               two above that is split into 4 linear buckets, so any 32-bit
+               value lands in one of 124 buckets and percentiles are within
+               12.5% with no allocation and O(1) record(). Counters and
+               gauges are lock-free; a histogram takes a short critical
+               section so record() is safe from any task. Metrics stay on
+               the list for good: declare them as globals or statics, never
+               on the stack.
+
+               metricsFormat() writes one metric for a serial dump;
+               metricsPack() packs as many compact "name=value" entries as
+               fit in a LoRa payload and returns where the next packet
+               should resume.
+
+  Usage:
+    MetricHistogram g_captureMs("capture_ms");
+    MetricCounter g_events("events");
+
+    g_captureMs.record(millis() - start);
+    g_events.add();
+    ...
+    for (const Metric* m = Metric::first(); m != nullptr; m = m->next()) {
+      metricsFormat(*m, line, sizeof(line));
+    }
+*/
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(ESP_PLATFORM)
+  #include <freertos/FreeRTOS.h>
+#else
+  #include <mutex>
+#endif
+
+#define METRIC_SUB_BITS   2                                   // Linear buckets per octave = 4
+#define METRIC_SUB_COUNT  (1u << METRIC_SUB_BITS)
+#define METRIC_BUCKETS    ((32 - METRIC_SUB_BITS + 1) * METRIC_SUB_COUNT)   // 124
+
+enum MetricKind : uint8_t {
+  METRIC_COUNTER,     // Monotonic count (events, bytes)
+  METRIC_GAUGE,       // Last value set (a rate, a level)
+  METRIC_HISTOGRAM    // Distribution of recorded values
+};
+
+class Metric {
+  public:
+    const char* name() const { return _name; }
+    MetricKind kind() const { return _kind; }
+
+    static Metric* first() { return head(); }
+    Metric* next() const { return _next; }
+
+  protected:
+    Metric(const char* name, MetricKind kind) : _name(name), _kind(kind), _next(nullptr) {
+      // Append so dumps list metrics in declaration order
+      Metric** link = &head();
+      while (*link != nullptr) {
+        link = &(*link)->_next;
+      }
+      *link = this;
+    }
+
+  private:
+    const char* _name;
+    MetricKind _kind;
+    Metric* _next;
+
+    static Metric*& head() {
+      static Metric* list = nullptr;
+      return list;
+    }
+};
+
+class MetricCounter : public Metric {
+  public:
+    explicit MetricCounter(const char* name) : Metric(name, METRIC_COUNTER), _value(0) {}
+
+    void add(uint32_t n = 1) { __atomic_fetch_add(&_value, n, __ATOMIC_RELAXED); }
+    uint32_t value() const { return __atomic_load_n(&_value, __ATOMIC_RELAXED); }
+    void reset() { __atomic_store_n(&_value, 0, __ATOMIC_RELAXED); }
+
+  private:
+    uint32_t _value;
+};
+
+class MetricGauge : public Metric {
+  public:
+    explicit MetricGauge(const char* name) : Metric(name, METRIC_GAUGE), _value(0) {}
+
+    void set(int32_t value) { __atomic_store_n(&_value, value, __ATOMIC_RELAXED); }
+    int32_t value() const { return __atomic_load_n(&_value, __ATOMIC_RELAXED); }
+    void reset() { set(0); }
+
+  private:
+    int32_t _value;
+};
+
+struct HistogramStats {
+  uint32_t count;
+  uint32_t min;
+  uint32_t max;
+  uint32_t mean;
+  uint32_t p50;
+  uint32_t p90;
+  uint32_t p99;
+};
+
+class MetricHistogram : public Metric {
+  public:
+    explicit MetricHistogram(const char* name) : Metric(name, METRIC_HISTOGRAM) { reset(); }
+
+    void record(uint32_t value) {
+      size_t index = bucketIndex(value);
+      lock();
+      _buckets[index]++;
+      _count++;
+      _sum += value;
+      if (value < _min) {
+        _min = value;
+      }
+      if (value > _max) {
+        _max = value;
+      }
+      unlock();
+    }
+
+    void reset() {
+      lock();
+      memset(_buckets, 0, sizeof(_buckets));
+      _count = 0;
+      _sum = 0;
+      _min = UINT32_MAX;
+      _max = 0;
+      unlock();
+    }
+
+    /**
+     * Consistent copy of the headline numbers (percentiles are bucket midpoints,
+     * clamped to the recorded min/max)
+     */
+    HistogramStats stats() const {
+      HistogramStats s = {};
+      lock();
+      s.count = _count;
+      if (_count > 0) {
+        s.min = _min;
+        s.max = _max;
+        s.mean = (uint32_t)(_sum / _count);
+        s.p50 = percentileLocked(50);
+        s.p90 = percentileLocked(90);
+        s.p99 = percentileLocked(99);
+      }
+      unlock();
+      return s;
+    }
+
+    uint32_t bucketCount(size_t index) const { return index < METRIC_BUCKETS ? _buckets[index] : 0; }
+
+    static size_t bucketIndex(uint32_t value) {
+      if (value < METRIC_SUB_COUNT) {
+        return value;
+      }
+      unsigned msb = 31 - (unsigned)__builtin_clz(value);
+      unsigned shift = msb - METRIC_SUB_BITS;
+      return (size_t)(shift + 1) * METRIC_SUB_COUNT + ((value >> shift) & (METRIC_SUB_COUNT - 1));
+    }
+
+    // Smallest value that lands in a bucket
+    static uint32_t bucketLow(size_t index) {
+      if (index < METRIC_SUB_COUNT) {
+        return (uint32_t)index;
+      }
+      unsigned shift = (unsigned)(index / METRIC_SUB_COUNT) - 1;
+      return (uint32_t)((METRIC_SUB_COUNT + index % METRIC_SUB_COUNT) << shift);
+    }
+
+    // Largest value that lands in a bucket
+    static uint32_t bucketHigh(size_t index) {
+      if (index < METRIC_SUB_COUNT) {
+        return (uint32_t)index;
+      }
+      unsigned shift = (unsigned)(index / METRIC_SUB_COUNT) - 1;
+      return bucketLow(index) + (uint32_t)((1ULL << shift) - 1);
+    }
+
+  private:
+    uint32_t _buckets[METRIC_BUCKETS];
+    uint32_t _count;
+    uint64_t _sum;
+    uint32_t _min;
+    uint32_t _max;
+
+    uint32_t percentileLocked(uint32_t pct) const {
+      // Rank of the sample at or above pct percent (1-based)
+      uint64_t rank = ((uint64_t)_count * pct + 99) / 100;
+      if (rank == 0) {
+        rank = 1;
+      }
+      uint64_t seen = 0;
+      for (size_t i = 0; i < METRIC_BUCKETS; i++) {
+        seen += _buckets[i];
+        if (seen >= rank) {
+          uint32_t mid = bucketLow(i) + (bucketHigh(i) - bucketLow(i)) / 2;
+          return mid < _min ? _min : (mid > _max ? _max : mid);
+        }
+      }
+      return _max;
+    }
+
+#if defined(ESP_PLATFORM)
+    mutable portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+    void lock() const { portENTER_CRITICAL(&_mux); }
+    void unlock() const { portEXIT_CRITICAL(&_mux); }
+#else
+    mutable std::mutex _mutex;
+    void lock() const { _mutex.lock(); }
+    void unlock() const { _mutex.unlock(); }
+#endif
+};
+
+/**
+ * One metric for a dump:
+ *   counter:   "name 12"
+ *   histogram: "name n=40 min=3 mean=5 p50=5 p90=9 p99=12 max=12"
+ * @return characters written (truncated to size - 1)
+ */
+inline size_t metricsFormat(const Metric& metric, char* out, size_t size) {
+  int n = 0;
+  switch (metric.kind()) {
+    case METRIC_COUNTER:
+      n = snprintf(out, size, "%s %lu", metric.name(),
+                   (unsigned long)static_cast<const MetricCounter&>(metric).value());
+      break;
+    case METRIC_GAUGE:
+      n = snprintf(out, size, "%s %ld", metric.name(), (long)static_cast<const MetricGauge&>(metric).value());
+      break;
+    case METRIC_HISTOGRAM: {
+      HistogramStats s = static_cast<const MetricHistogram&>(metric).stats();
+      n = snprintf(out, size, "%s n=%lu min=%lu mean=%lu p50=%lu p90=%lu p99=%lu max=%lu", metric.name(),
+                   (unsigned long)s.count, (unsigned long)s.min, (unsigned long)s.mean, (unsigned long)s.p50,
+                   (unsigned long)s.p90, (unsigned long)s.p99, (unsigned long)s.max);
+      break;
+    }
+  }
+  if (n < 0) {
+    return 0;
+  }
+  return (size_t)n < size ? (size_t)n : size - 1;
+}
+
+/**
+ * Compact entry: "name=12" or, for a histogram, "name=count/p50/p90/max"
+ */
+inline int metricsCompact(const Metric& metric, char* out, size_t size) {
+  switch (metric.kind()) {
+    case METRIC_COUNTER:
+      return snprintf(out, size, "%s=%lu", metric.name(),
+                      (unsigned long)static_cast<const MetricCounter&>(metric).value());
+    case METRIC_GAUGE:
+      return snprintf(out, size, "%s=%ld", metric.name(), (long)static_cast<const MetricGauge&>(metric).value());
+    case METRIC_HISTOGRAM: {
+      HistogramStats s = static_cast<const MetricHistogram&>(metric).stats();
+      return snprintf(out, size, "%s=%lu/%lu/%lu/%lu", metric.name(), (unsigned long)s.count,
+                      (unsigned long)s.p50, (unsigned long)s.p90, (unsigned long)s.max);
+    }
+  }
+  return 0;
+}
+
+/**
+ * Append comma-separated compact entries to out (which may already hold a
+ * prefix) until the next one would not fit. A single entry too long for an
+ * empty payload is skipped so packing always makes progress.
+ * @param from first metric to pack (Metric::first() for a new snapshot)
+ * @return the metric the next payload should start from, nullptr when done
+ */
+inline const Metric* metricsPack(const Metric* from, char* out, size_t size) {
+  size_t len = strlen(out);
+  size_t prefix = len;
+  char entry[96];
+  const Metric* metric = from;
+  while (metric != nullptr) {
+    int n = metricsCompact(*metric, entry, sizeof(entry));
+    size_t need = (size_t)n + (len > prefix ? 1 : 0);
+    if (n < 0 || (size_t)n >= sizeof(entry) || len + need >= size) {
+      if (len == prefix) {
+        metric = metric->next();   // Would never fit: skip rather than stall
+        continue;
+      }
+      break;
+    }
+    if (len > prefix) {
+      out[len++] = ',';
+    }
+    memcpy(out + len, entry, (size_t)n + 1);
+    len += (size_t)n;
+    metric = metric->next();
+  }
+  return metric;
+}
+
+/**
+ * Zero every registered metric
+ */
+inline void metricsResetAll() {
+  for (Metric* m = Metric::first(); m != nullptr; m = m->next()) {
+    switch (m->kind()) {
+      case METRIC_COUNTER:
+        static_cast<MetricCounter*>(m)->reset();
+        break;
+      case METRIC_GAUGE:
+        static_cast<MetricGauge*>(m)->reset();
+        break;
+      case METRIC_HISTOGRAM:
+        static_cast<MetricHistogram*>(m)->reset();
+        break;
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,177 @@
+/*
+  Filename: metrics_check.cpp
+  Metrics checks (Linux host)
+
+  Description: Checks the log-linear bucket mapping over the whole 32-bit
+               range, histogram percentiles against a sorted copy of the
+               same samples, compact packing into LoRa-sized payloads (every
+               metric sent exactly once), and concurrent record()/add() from
+               several threads. Exits non-zero if any check fails.
+
+  Build/run (from this folder):
+    g++ -O2 -std=c++17 -I../.. metrics_check.cpp -o metrics_check -pthread
+    ./metrics_check
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Metrics.h"
+
+static int g_failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+      g_failures++; \
+      printf("FAIL line %d: %s\n", __LINE__, #cond); \
+    } \
+  } while (0)
+
+// Registered in declaration order, like the firmware globals
+MetricCounter g_events("events");
+MetricGauge g_rate("rate_bps");
+MetricHistogram g_latency("latency_us");
+MetricHistogram g_threads("threads_us");
+MetricHistogram g_one("one");
+
+static void checkBuckets() {
+  // Every bucket's bounds map back to it, and buckets tile the range with no gaps
+  for (size_t i = 0; i < METRIC_BUCKETS; i++) {
+    CHECK(MetricHistogram::bucketIndex(MetricHistogram::bucketLow(i)) == i);
+    CHECK(MetricHistogram::bucketIndex(MetricHistogram::bucketHigh(i)) == i);
+    if (i + 1 < METRIC_BUCKETS) {
+      CHECK(MetricHistogram::bucketHigh(i) + 1 == MetricHistogram::bucketLow(i + 1));
+    }
+  }
+  CHECK(MetricHistogram::bucketIndex(0) == 0);
+  CHECK(MetricHistogram::bucketIndex(3) == 3);
+  CHECK(MetricHistogram::bucketIndex(4) == 4);
+  CHECK(MetricHistogram::bucketIndex(UINT32_MAX) == METRIC_BUCKETS - 1);
+  CHECK(MetricHistogram::bucketHigh(METRIC_BUCKETS - 1) == UINT32_MAX);
+
+  // Relative bucket width stays within the documented 25% (midpoint error 12.5%)
+  for (size_t i = METRIC_SUB_COUNT; i < METRIC_BUCKETS; i++) {
+    double low = MetricHistogram::bucketLow(i);
+    double width = (double)MetricHistogram::bucketHigh(i) - low + 1;
+    CHECK(width / low <= 0.25 + 1e-9);
+  }
+}
+
+static void checkPercentiles() {
+  std::mt19937 rng(7);
+  std::lognormal_distribution<double> dist(8.0, 1.0);   // Latency-like: median ~3 ms in us
+  std::vector<uint32_t> samples;
+  for (int i = 0; i < 20000; i++) {
+    uint32_t v = (uint32_t)dist(rng);
+    samples.push_back(v);
+    g_latency.record(v);
+  }
+  std::sort(samples.begin(), samples.end());
+  HistogramStats s = g_latency.stats();
+  CHECK(s.count == samples.size());
+  CHECK(s.min == samples.front());
+  CHECK(s.max == samples.back());
+
+  const int pcts[] = {50, 90, 99};
+  const uint32_t got[] = {s.p50, s.p90, s.p99};
+  for (int i = 0; i < 3; i++) {
+    uint32_t exact = samples[(samples.size() * pcts[i] + 99) / 100 - 1];
+    double error = (double)got[i] / exact - 1.0;
+    CHECK(error > -0.125 && error < 0.125);
+    printf("p%d: exact %u, histogram %u (%+.1f%%)\n", pcts[i], exact, got[i], error * 100);
+  }
+
+  char line[128];
+  metricsFormat(g_latency, line, sizeof(line));
+  CHECK(strncmp(line, "latency_us n=20000 min=", 23) == 0);
+
+  // A single value reports itself everywhere
+  g_one.record(1000);
+  HistogramStats o = g_one.stats();
+  CHECK(o.min == 1000 && o.max == 1000 && o.p50 == 1000 && o.p99 == 1000 && o.mean == 1000);
+  g_one.reset();
+  CHECK(g_one.stats().count == 0);
+}
+
+static void checkPack() {
+  g_events.add(3);
+  g_rate.set(1234);
+
+  // Pack everything into 60-byte payloads behind a prefix; each metric appears once
+  std::vector<std::string> seen;
+  const Metric* next = Metric::first();
+  int packets = 0;
+  while (next != nullptr && packets < 20) {
+    char payload[60] = "RSP:MET:";
+    next = metricsPack(next, payload, sizeof(payload));
+    CHECK(strlen(payload) < sizeof(payload));
+    std::string body(payload + 8);
+    size_t start = 0;
+    while (start < body.size()) {
+      size_t comma = body.find(',', start);
+      std::string entry = body.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+      seen.push_back(entry.substr(0, entry.find('=')));
+      start = comma == std::string::npos ? body.size() : comma + 1;
+    }
+    packets++;
+  }
+  CHECK(next == nullptr);
+  std::vector<std::string> names;
+  for (const Metric* m = Metric::first(); m != nullptr; m = m->next()) {
+    names.push_back(m->name());
+  }
+  CHECK(seen == names);
+
+  char payload[80] = "";
+  metricsPack(Metric::first(), payload, sizeof(payload));
+  CHECK(strncmp(payload, "events=3,rate_bps=1234,latency_us=20000/", 40) == 0);
+
+  // Packing stops at the first entry that does not fit; one that never fits is skipped
+  char tiny[12] = "";
+  CHECK(metricsPack(Metric::first(), tiny, sizeof(tiny)) == &g_rate);
+  CHECK(strcmp(tiny, "events=3") == 0);
+  tiny[0] = '\0';
+  CHECK(metricsPack(&g_rate, tiny, sizeof(tiny)) == nullptr);
+  CHECK(strcmp(tiny, "one=0/0/0/0") == 0);
+}
+
+static void checkThreads() {
+  const int threads = 4;
+  const int perThread = 100000;
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; t++) {
+    workers.emplace_back([t]() {
+      for (int i = 0; i < perThread; i++) {
+        g_threads.record((uint32_t)(t * 1000 + i % 1000));
+        g_events.add();
+      }
+    });
+  }
+  for (std::thread& w : workers) {
+    w.join();
+  }
+  uint64_t total = 0;
+  for (size_t i = 0; i < METRIC_BUCKETS; i++) {
+    total += g_threads.bucketCount(i);
+  }
+  CHECK(g_threads.stats().count == (uint32_t)(threads * perThread));
+  CHECK(total == (uint64_t)threads * perThread);
+  CHECK(g_events.value() == 3u + threads * perThread);
+
+  metricsResetAll();
+  CHECK(g_events.value() == 0 && g_rate.value() == 0 && g_threads.stats().count == 0);
+}
+
+int main() {
+  checkBuckets();
+  checkPercentiles();
+  checkPack();
+  checkThreads();
+  printf("checks: %s (%d failure%s)\n", g_failures ? "FAIL" : "ok", g_failures, g_failures == 1 ? "" : "s");
+  return g_failures ? 1 : 0;
+}
@@ -0,0 +1,178 @@
+/*
+  Filename: MicroBench.h
+  Kernel Microbenchmark Harness (header-only, no Arduino dependency)
+
+  Description: Times a small piece of code the way Google Benchmark does:
+               the iteration count doubles (or jumps by the measured ratio)
+               until one run takes MICROBENCH_MIN_RUN_US, then
+               MICROBENCH_RUNS timed runs of that many iterations give the
+               fastest and median time per iteration. On Xtensa (ESP32,
+               ESP32-S3) the CCOUNT register also gives CPU cycles per
+               iteration; on a Linux host that column is 0.
+
+               The same kernels and the same report therefore come out of
+               the board and out of a Linux build, and
+               examples/bench_compare puts two reports side by side
+               (board vs host, or before vs after a change).
+
+               A report is:
+                 === MICROBENCH target=<target> cpu_mhz=<n> ===
+                 kernel                    iters   ns/op_min   ns/op_med   cycles/op
+                 <name>                   <n>     <ns>        <ns>        <cycles>
+                 ...
+                 ===============
+
+               cpu_mhz is whatever clock the caller reports (a step the
+               native build only simulates).
+
+               Kernels feed results to microBenchKeep() so the compiler
+               cannot drop the work, and vary their input per iteration so
+               it cannot hoist it.
+
+  Usage:
+    uint32_t i = 0;
+    MicroBenchResult r = microBenchRun("sht45_crc", [&]() {
+      uint8_t data[2] = {(uint8_t)i, (uint8_t)(i >> 8)};
+      microBenchKeep(SHT45_Module::calculateCRC(data, 2));
+      i++;
+    });
+    microBenchFormat(r, line, sizeof(line));
+*/
+
+#ifndef MICRO_BENCH_H
+#define MICRO_BENCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#if defined(ESP_PLATFORM)
+  #include <sdkconfig.h>
+  #include <esp_timer.h>
+  #define MICROBENCH_TARGET  CONFIG_IDF_TARGET
+#else
+  #include <chrono>
+  #define MICROBENCH_TARGET  "linux"
+#endif
+
+#define MICROBENCH_RUNS        5         // Timed runs per kernel; min and median are reported
+#define MICROBENCH_MIN_RUN_US  20000     // Calibrate until one run takes at least this long
+#define MICROBENCH_MAX_ITERS   (1u << 24)
+#define MICROBENCH_LINE_MAX    96
+
+struct MicroBenchResult {
+  const char* name;
+  uint32_t iterations;    // Per timed run
+  float nsMin;            // Per iteration, fastest run
+  float nsMedian;         // Per iteration, median run
+  float cyclesMin;        // Per iteration, fastest run; 0 without a cycle counter
+};
+
+/**
+ * Make the compiler treat value as used (Google Benchmark's DoNotOptimize)
+ */
+template <typename T>
+inline void microBenchKeep(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+inline uint64_t microBenchNowNs() {
+#if defined(ESP_PLATFORM)
+  return (uint64_t)esp_timer_get_time() * 1000ULL;
+#else
+  return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+inline uint32_t microBenchCycles() {
+#if defined(__XTENSA__)
+  uint32_t ccount;
+  asm volatile("rsr %0, ccount" : "=a"(ccount));
+  return ccount;
+#else
+  return 0;
+#endif
+}
+
+template <typename Body>
+inline MicroBenchResult microBenchRun(const char* name, Body body) {
+  const uint64_t targetNs = (uint64_t)MICROBENCH_MIN_RUN_US * 1000ULL;
+
+  // Calibration: also warms caches and branch predictors
+  uint32_t iterations = 1;
+  for (;;) {
+    uint64_t start = microBenchNowNs();
+    for (uint32_t i = 0; i < iterations; i++) {
+      body();
+    }
+    uint64_t elapsed = microBenchNowNs() - start;
+    if (elapsed >= targetNs || iterations >= MICROBENCH_MAX_ITERS) {
+      break;
+    }
+    // Aim 20% past the target from the measured rate; never less than double, at most 10x
+    uint64_t next = (elapsed > 0) ? iterations * targetNs * 12 / (elapsed * 10) : (uint64_t)iterations * 10;
+    if (next < (uint64_t)iterations * 2) {
+      next = (uint64_t)iterations * 2;
+    }
+    if (next > (uint64_t)iterations * 10) {
+      next = (uint64_t)iterations * 10;
+    }
+    iterations = (next > MICROBENCH_MAX_ITERS) ? MICROBENCH_MAX_ITERS : (uint32_t)next;
+  }
+
+  float ns[MICROBENCH_RUNS];
+  float cyclesMin = 0.0f;
+  for (size_t run = 0; run < MICROBENCH_RUNS; run++) {
+    uint32_t startCycles = microBenchCycles();
+    uint64_t start = microBenchNowNs();
+    for (uint32_t i = 0; i < iterations; i++) {
+      body();
+    }
+    uint64_t elapsed = microBenchNowNs() - start;
+    uint32_t cycles = microBenchCycles() - startCycles;   // Wraps after 17 s at 240 MHz; runs are far shorter
+    ns[run] = (float)elapsed / iterations;
+    float perOp = (float)cycles / iterations;
+    if (run == 0 || perOp < cyclesMin) {
+      cyclesMin = perOp;
+    }
+  }
+
+  // Insertion sort: MICROBENCH_RUNS values
+  for (size_t i = 1; i < MICROBENCH_RUNS; i++) {
+    float v = ns[i];
+    size_t j = i;
+    while (j > 0 && ns[j - 1] > v) {
+      ns[j] = ns[j - 1];
+      j--;
+    }
+    ns[j] = v;
+  }
+
+  MicroBenchResult result;
+  result.name = name;
+  result.iterations = iterations;
+  result.nsMin = ns[0];
+  result.nsMedian = ns[MICROBENCH_RUNS / 2];
+  result.cyclesMin = cyclesMin;
+  return result;
+}
+
+/**
+ * Report header: the title line, then the column line
+ */
+inline void microBenchFormatHeader(unsigned cpuMhz, char* title, size_t titleSize, char* columns, size_t columnsSize) {
+  snprintf(title, titleSize, "=== MICROBENCH target=%s cpu_mhz=%u ===", MICROBENCH_TARGET, cpuMhz);
+  snprintf(columns, columnsSize, "%-24s %9s %11s %11s %11s", "kernel", "iters", "ns/op_min", "ns/op_med", "cycles/op");
+}
+
+/**
+ * One report row
+ */
+inline size_t microBenchFormat(const MicroBenchResult& result, char* out, size_t outSize) {
+  int n = snprintf(out, outSize, "%-24s %9lu %11.1f %11.1f %11.1f", result.name, (unsigned long)result.iterations,
+                   result.nsMin, result.nsMedian, result.cyclesMin);
+  return (n > 0) ? (size_t)n : 0;
+}
+
+#endif
@@ -0,0 +1,131 @@
+/*
+  Filename: bench_compare.cpp
+  MicroBench report comparison (Linux host)
+
+  Description: Puts two MicroBench reports side by side, kernel by kernel:
+               a board capture against a Linux one, or a capture from
+               before a change against one from after. Each file may be a
+               whole serial log; the last "=== MICROBENCH" block in it is
+               used. The ratio is new/base on the fastest run, so below 1.00
+               is faster. Kernels present in only one report are listed
+               with a dash.
+
+  Build/run (from this folder):
+    g++ -O2 -std=c++17 bench_compare.cpp -o bench_compare
+    ./bench_compare before.txt after.txt
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+struct Row {
+  std::string name;
+  unsigned long iterations;
+  double nsMin;
+  double nsMedian;
+  double cycles;
+};
+
+struct Report {
+  std::string title;
+  std::vector<Row> rows;
+};
+
+static bool loadReport(const char* path, Report& report) {
+  FILE* f = fopen(path, "r");
+  if (f == nullptr) {
+    fprintf(stderr, "cannot open %s\n", path);
+    return false;
+  }
+  char line[512];
+  bool inReport = false;
+  bool found = false;
+  while (fgets(line, sizeof(line), f) != nullptr) {
+    line[strcspn(line, "\r\n")] = '\0';
+    const char* title = strstr(line, "=== MICROBENCH");
+    if (title != nullptr) {
+      report.title = title;
+      report.rows.clear();
+      inReport = true;
+      found = true;
+      continue;
+    }
+    if (!inReport) {
+      continue;
+    }
+    if (strncmp(line, "===", 3) == 0) {
+      inReport = false;
+      continue;
+    }
+    char name[64];
+    Row row;
+    if (sscanf(line, "%63s %lu %lf %lf %lf", name, &row.iterations, &row.nsMin, &row.nsMedian, &row.cycles) == 5) {
+      row.name = name;
+      report.rows.push_back(row);
+    }
+  }
+  fclose(f);
+  if (!found) {
+    fprintf(stderr, "%s: no MICROBENCH report\n", path);
+  }
+  return found;
+}
+
+static const Row* findRow(const Report& report, const std::string& name) {
+  for (const Row& row : report.rows) {
+    if (row.name == name) {
+      return &row;
+    }
+  }
+  return nullptr;
+}
+
+static void printRow(const std::string& name, const Row* base, const Row* next) {
+  char baseNs[16] = "-";
+  char nextNs[16] = "-";
+  char ratio[16] = "-";
+  char baseCycles[16] = "-";
+  char nextCycles[16] = "-";
+  if (base != nullptr) {
+    snprintf(baseNs, sizeof(baseNs), "%.1f", base->nsMin);
+    if (base->cycles > 0) {
+      snprintf(baseCycles, sizeof(baseCycles), "%.1f", base->cycles);
+    }
+  }
+  if (next != nullptr) {
+    snprintf(nextNs, sizeof(nextNs), "%.1f", next->nsMin);
+    if (next->cycles > 0) {
+      snprintf(nextCycles, sizeof(nextCycles), "%.1f", next->cycles);
+    }
+  }
+  if (base != nullptr && next != nullptr && base->nsMin > 0) {
+    snprintf(ratio, sizeof(ratio), "%.2f", next->nsMin / base->nsMin);
+  }
+  printf("%-24s %12s %12s %7s %12s %12s\n", name.c_str(), baseNs, nextNs, ratio, baseCycles, nextCycles);
+}
+
+int main(int argc, char** argv) {
+  if (argc != 3) {
+    fprintf(stderr, "usage: %s <base report> <new report>\n", argv[0]);
+    return 2;
+  }
+  Report base;
+  Report next;
+  if (!loadReport(argv[1], base) || !loadReport(argv[2], next)) {
+    return 2;
+  }
+
+  printf("base: %s\nnew:  %s\n\n", base.title.c_str(), next.title.c_str());
+  printf("%-24s %12s %12s %7s %12s %12s\n", "kernel", "base ns/op", "new ns/op", "ratio", "base cyc/op", "new cyc/op");
+  for (const Row& row : base.rows) {
+    printRow(row.name, &row, findRow(next, row.name));
+  }
+  for (const Row& row : next.rows) {
+    if (findRow(base, row.name) == nullptr) {
+      printRow(row.name, nullptr, &row);
+    }
+  }
+  return 0;
+}
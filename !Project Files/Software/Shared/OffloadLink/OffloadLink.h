@@ -0,0 +1,48 @@
+/*
+  Filename: OffloadLink.h
+  Offload Link Limits (header-only, no Arduino dependency)
+
+  Description: Sizes and names both ends of an event offload must agree
+               on. The receiver formats each event as one CSV row of at most
+               EVENT_CSV_ROW_CAPACITY bytes (buildCsvDataRow() refuses
+               anything longer) and sends it over TCP as one
+               "DATA:<row>\r\n" line. The transmitter's line ring must hold
+               OFFLOAD_TCP_LINE_MAX bytes or the row is dropped, so it checks
+               its ring size against this header at compile time.
+
+               Fleet sweeps without site Wi-Fi offload over a SoftAP the
+               transmitter hosts and the receiver joins. Its SSID and
+               password are set per deployment with the SETUP aps=/app=
+               fields (Wi-Fi group), which both firmwares store in NVS; with
+               none set the SoftAP path is off.
+*/
+
+#ifndef OFFLOAD_LINK_H
+#define OFFLOAD_LINK_H
+
+#include <stddef.h>
+
+#define EVENT_SAMPLE_CAPACITY   200   // Compile-time ceiling on paired samples per event
+#define EVENT_CSV_SAMPLE_CHARS  48    // Worst case for ",x,y,z,strain"
+#define EVENT_CSV_ROW_CAPACITY  (96 + EVENT_SAMPLE_CAPACITY * EVENT_CSV_SAMPLE_CHARS)
+
+#define OFFLOAD_TCP_FRAMING     7     // "DATA:" prefix and "\r\n"
+#define OFFLOAD_TCP_LINE_MAX    (EVENT_CSV_ROW_CAPACITY + OFFLOAD_TCP_FRAMING)
+
+#define SOFTAP_SSID_MAX         32    // 802.11 SSID limit
+#define SOFTAP_PASSWORD_MIN     8     // WPA2-PSK passphrase limits
+#define SOFTAP_PASSWORD_MAX     63
+
+/**
+ * SETUP aps=/app= lengths both ends accept: both empty (SoftAP off) or a
+ * usable WPA2 network
+ */
+inline bool softApCredentialsValid(size_t ssidLen, size_t passwordLen) {
+  if (ssidLen == 0 && passwordLen == 0) {
+    return true;
+  }
+  return ssidLen > 0 && ssidLen <= SOFTAP_SSID_MAX &&
+         passwordLen >= SOFTAP_PASSWORD_MIN && passwordLen <= SOFTAP_PASSWORD_MAX;
+}
+
+#endif
@@ -0,0 +1,298 @@
+/*
+  Filename: ParamRegistry.h
+  Runtime Parameter Registry (header-only, no Arduino dependency)
+
+  Description: Typed table of tunable parameters. Each entry points at the
+               live variable and carries its range, an optional apply hook
+               (to push the new value into a sensor or the radio), flags and
+               the ConfigTLV tag used when the value is persisted. Firmware
+               exposes the table through GET:/SET:/LIST: so units can be
+               tuned in the field without a rebuild.
+
+  Usage:
+    static const ParamDef PARAMS[] = {
+      {"sensor.interval_ms", PARAM_ULONG, &SENSOR_READ_INTERVAL, 1, 10000, PARAM_PERSIST, 0x01, nullptr},
+      ...
+    };
+    ParamRegistry params(PARAMS, sizeof(PARAMS) / sizeof(PARAMS[0]));
+    ParamResult r = params.set("sensor.interval_ms", 18, "250", 3);
+
+  A failed apply hook restores the previous value.
+*/
+
+#ifndef PARAM_REGISTRY_H
+#define PARAM_REGISTRY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum ParamType : uint8_t {
+  PARAM_UINT8,    // uint8_t
+  PARAM_UINT,     // unsigned int
+  PARAM_ULONG,    // unsigned long
+  PARAM_INT,      // int
+  PARAM_FLOAT,    // float
+  PARAM_BOOL      // bool
+};
+
+enum ParamFlags : uint8_t {
+  PARAM_PERSIST   = 1 << 0,   // Saved to NVS on SET and restored at boot
+  PARAM_READ_ONLY = 1 << 1    // GET/LIST only
+};
+
+enum ParamResult : uint8_t {
+  PARAM_OK,
+  PARAM_UNKNOWN,
+  PARAM_BAD_VALUE,
+  PARAM_OUT_OF_RANGE,
+  PARAM_NOT_WRITABLE,
+  PARAM_APPLY_FAILED
+};
+
+struct ParamDef;
+typedef bool (*ParamApplyFn)(const ParamDef& def);
+
+struct ParamDef {
+  const char* name;
+  ParamType type;
+  void* value;          // Live variable of the matching C++ type
+  float minValue;
+  float maxValue;
+  uint8_t flags;
+  uint8_t cfgTag;       // ConfigTLV tag when PARAM_PERSIST is set
+  ParamApplyFn apply;   // Optional; return false to reject (value is rolled back)
+};
+
+class ParamRegistry {
+  public:
+    ParamRegistry(const ParamDef* defs, size_t count) : _defs(defs), _count(count) {}
+
+    size_t count() const { return _count; }
+    const ParamDef& at(size_t i) const { return _defs[i]; }
+
+    const ParamDef* find(const char* name, size_t nameLen) const {
+      for (size_t i = 0; i < _count; i++) {
+        if (strlen(_defs[i].name) == nameLen && memcmp(_defs[i].name, name, nameLen) == 0) {
+          return &_defs[i];
+        }
+      }
+      return nullptr;
+    }
+
+    /**
+     * Current value as a double (every supported type fits exactly)
+     */
+    static double read(const ParamDef& def) {
+      switch (def.type) {
+        case PARAM_UINT8: return *(const uint8_t*)def.value;
+        case PARAM_UINT:  return *(const unsigned int*)def.value;
+        case PARAM_ULONG: return *(const unsigned long*)def.value;
+        case PARAM_INT:   return *(const int*)def.value;
+        case PARAM_FLOAT: return *(const float*)def.value;
+        case PARAM_BOOL:  return *(const bool*)def.value ? 1.0 : 0.0;
+      }
+      return 0.0;
+    }
+
+    /**
+     * Store a value without range checks or apply hooks (used when restoring from NVS)
+     */
+    static void write(const ParamDef& def, double v) {
+      switch (def.type) {
+        case PARAM_UINT8: *(uint8_t*)def.value = (uint8_t)v; break;
+        case PARAM_UINT:  *(unsigned int*)def.value = (unsigned int)v; break;
+        case PARAM_ULONG: *(unsigned long*)def.value = (unsigned long)v; break;
+        case PARAM_INT:   *(int*)def.value = (int)v; break;
+        case PARAM_FLOAT: *(float*)def.value = (float)v; break;
+        case PARAM_BOOL:  *(bool*)def.value = (v != 0.0); break;
+      }
+    }
+
+    static bool inRange(const ParamDef& def, double v) {
+      return v >= def.minValue && v <= def.maxValue;
+    }
+
+    /**
+     * Parse, range-check, store and apply one value
+     */
+    ParamResult set(const char* name, size_t nameLen, const char* text, size_t textLen,
+                    const ParamDef** out = nullptr) const {
+      const ParamDef* def = find(name, nameLen);
+      if (out != nullptr) {
+        *out = def;
+      }
+      if (def == nullptr) {
+        return PARAM_UNKNOWN;
+      }
+      if (def->flags & PARAM_READ_ONLY) {
+        return PARAM_NOT_WRITABLE;
+      }
+
+      double v;
+      if (!parseValue(*def, text, textLen, v)) {
+        return PARAM_BAD_VALUE;
+      }
+      if (!inRange(*def, v)) {
+        return PARAM_OUT_OF_RANGE;
+      }
+
+      double previous = read(*def);
+      write(*def, v);
+      if (def->apply != nullptr && !def->apply(*def)) {
+        write(*def, previous);
+        return PARAM_APPLY_FAILED;
+      }
+      return PARAM_OK;
+    }
+
+    /**
+     * "name=value"
+     */
+    static size_t format(const ParamDef& def, char* out, size_t outSize) {
+      char value[24];
+      formatValue(def, value, sizeof(value));
+      int n = snprintf(out, outSize, "%s=%s", def.name, value);
+      return (n < 0) ? 0 : (size_t)n;
+    }
+
+    /**
+     * "name=value type min..max [persist] [ro]" for LIST
+     */
+    static size_t describe(const ParamDef& def, char* out, size_t outSize) {
+      char value[24];
+      formatValue(def, value, sizeof(value));
+      int n = snprintf(out, outSize, "%s=%s %s %g..%g%s%s",
+                       def.name, value, typeName(def.type),
+                       (double)def.minValue, (double)def.maxValue,
+                       (def.flags & PARAM_PERSIST) ? " persist" : "",
+                       (def.flags & PARAM_READ_ONLY) ? " ro" : "");
+      return (n < 0) ? 0 : (size_t)n;
+    }
+
+    static const char* typeName(ParamType type) {
+      switch (type) {
+        case PARAM_UINT8: return "u8";
+        case PARAM_UINT:  return "uint";
+        case PARAM_ULONG: return "ulong";
+        case PARAM_INT:   return "int";
+        case PARAM_FLOAT: return "float";
+        case PARAM_BOOL:  return "bool";
+      }
+      return "?";
+    }
+
+    static const char* resultText(ParamResult result) {
+      switch (result) {
+        case PARAM_OK:           return "OK";
+        case PARAM_UNKNOWN:      return "UNKNOWN";
+        case PARAM_BAD_VALUE:    return "BAD_VALUE";
+        case PARAM_OUT_OF_RANGE: return "OUT_OF_RANGE";
+        case PARAM_NOT_WRITABLE: return "READ_ONLY";
+        case PARAM_APPLY_FAILED: return "APPLY_FAILED";
+      }
+      return "ERROR";
+    }
+
+  private:
+    const ParamDef* _defs;
+    size_t _count;
+
+    static void formatValue(const ParamDef& def, char* out, size_t outSize) {
+      if (def.type == PARAM_FLOAT) {
+        snprintf(out, outSize, "%.6g", read(def));
+      } else if (def.type == PARAM_INT) {
+        snprintf(out, outSize, "%d", *(const int*)def.value);
+      } else {
+        snprintf(out, outSize, "%lu", (unsigned long)read(def));
+      }
+    }
+
+    static bool parseValue(const ParamDef& def, const char* text, size_t textLen, double& out) {
+      char buffer[24];
+      if (textLen == 0 || textLen >= sizeof(buffer)) {
+        return false;
+      }
+      memcpy(buffer, text, textLen);
+      buffer[textLen] = '\0';
+
+      if (def.type == PARAM_BOOL) {
+        if (strcmp(buffer, "1") == 0 || strcmp(buffer, "true") == 0 || strcmp(buffer, "on") == 0) {
+          out = 1.0;
+          return true;
+        }
+        if (strcmp(buffer, "0") == 0 || strcmp(buffer, "false") == 0 || strcmp(buffer, "off") == 0) {
+          out = 0.0;
+          return true;
+        }
+        return false;
+      }
+
+      char* end = nullptr;
+      if (def.type == PARAM_FLOAT) {
+        out = strtod(buffer, &end);
+      } else {
+        out = (double)strtol(buffer, &end, 10);
+      }
+      return end != buffer && *end == '\0';
+    }
+};
+
+/**
+ * Restore PARAM_PERSIST entries from a ConfigTLV image (see Shared/ConfigTLV)
+ * Out-of-range stored values are skipped; apply hooks are not run.
+ * @return number of parameters restored
+ */
+template <typename Config>
+size_t loadParams(const ParamRegistry& registry, const Config& cfg) {
+  size_t restored = 0;
+  for (size_t i = 0; i < registry.count(); i++) {
+    const ParamDef& def = registry.at(i);
+    if (!(def.flags & PARAM_PERSIST)) {
+      continue;
+    }
+    double v;
+    if (def.type == PARAM_FLOAT) {
+      float f;
+      if (!cfg.getFloat(def.cfgTag, f)) continue;
+      v = f;
+    } else {
+      uint32_t u;
+      if (!cfg.getU32(def.cfgTag, u)) continue;
+      v = (def.type == PARAM_INT) ? (double)(int32_t)u : (double)u;
+    }
+    if (ParamRegistry::inRange(def, v)) {
+      ParamRegistry::write(def, v);
+      restored++;
+    }
+  }
+  return restored;
+}
+
+/**
+ * Stage PARAM_PERSIST entries into a ConfigTLV image (only changed values mark it dirty)
+ * @return false if the image ran out of space
+ */
+template <typename Config>
+bool storeParams(const ParamRegistry& registry, Config& cfg) {
+  bool fits = true;
+  for (size_t i = 0; i < registry.count(); i++) {
+    const ParamDef& def = registry.at(i);
+    if (!(def.flags & PARAM_PERSIST)) {
+      continue;
+    }
+    double v = ParamRegistry::read(def);
+    if (def.type == PARAM_FLOAT) {
+      fits &= cfg.setFloat(def.cfgTag, (float)v);
+    } else if (def.type == PARAM_INT) {
+      fits &= cfg.setU32(def.cfgTag, (uint32_t)(int32_t)v);
+    } else {
+      fits &= cfg.setU32(def.cfgTag, (uint32_t)v);
+    }
+  }
+  return fits;
+}
+
+#endif
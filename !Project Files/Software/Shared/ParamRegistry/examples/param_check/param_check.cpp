@@ -0,0 +1,98 @@
+/*
+  Filename: param_check.cpp
+  ParamRegistry checks (Linux host)
+
+  Description: Exercises parsing, range checks, read-only entries, apply
+               hook rollback and the ConfigTLV load/store round trip.
+               Exits non-zero if any check fails.
+
+  Build/run (from this folder):
+    g++ -O2 -std=c++17 -I../.. -I../../../ConfigTLV param_check.cpp -o param_check
+    ./param_check
+*/
+
+#include <cstdio>
+#include <cstring>
+
+#include "ConfigTLV.h"
+#include "ParamRegistry.h"
+
+static unsigned long intervalMs = 100;
+static float thresholdG = 2.0f;
+static uint8_t spreadingFactor = 9;
+static int powerDbm = 14;
+static unsigned int capacity = 200;
+static bool rejectNextApply = false;
+static int applyCalls = 0;
+
+static bool applyRadio(const ParamDef&) {
+  applyCalls++;
+  return !rejectNextApply;
+}
+
+static const ParamDef PARAMS[] = {
+  {"sensor.interval_ms", PARAM_ULONG, &intervalMs,      1,     10000, PARAM_PERSIST,   0x01, nullptr},
+  {"event.threshold_g",  PARAM_FLOAT, &thresholdG,      0.01f, 10,    PARAM_PERSIST,   0x02, nullptr},
+  {"lora.sf",            PARAM_UINT8, &spreadingFactor, 7,     12,    PARAM_PERSIST,   0x24, applyRadio},
+  {"lora.power_dbm",     PARAM_INT,   &powerDbm,        -9,    22,    PARAM_PERSIST,   0x27, applyRadio},
+  {"event.capacity",     PARAM_UINT,  &capacity,        0,     200,   PARAM_READ_ONLY, 0,    nullptr},
+};
+
+static int g_failures = 0;
+
+static void expect(bool ok, const char* what) {
+  if (!ok) {
+    g_failures++;
+    printf("FAIL: %s\n", what);
+  }
+}
+
+static ParamResult set(const ParamRegistry& reg, const char* name, const char* value) {
+  return reg.set(name, strlen(name), value, strlen(value));
+}
+
+int main() {
+  ParamRegistry reg(PARAMS, sizeof(PARAMS) / sizeof(PARAMS[0]));
+  char text[96];
+
+  expect(set(reg, "sensor.interval_ms", "250") == PARAM_OK && intervalMs == 250, "ulong set");
+  expect(set(reg, "event.threshold_g", "1.5") == PARAM_OK && thresholdG == 1.5f, "float set");
+  expect(set(reg, "lora.power_dbm", "-3") == PARAM_OK && powerDbm == -3, "negative int set");
+  expect(set(reg, "sensor.interval_ms", "0") == PARAM_OUT_OF_RANGE && intervalMs == 250, "below range rejected");
+  expect(set(reg, "sensor.interval_ms", "12x") == PARAM_BAD_VALUE, "trailing junk rejected");
+  expect(set(reg, "sensor.interval_ms", "") == PARAM_BAD_VALUE, "empty value rejected");
+  expect(set(reg, "nope", "1") == PARAM_UNKNOWN, "unknown name");
+  expect(set(reg, "event.capacity", "10") == PARAM_NOT_WRITABLE && capacity == 200, "read-only entry");
+
+  applyCalls = 0;
+  expect(set(reg, "lora.sf", "10") == PARAM_OK && spreadingFactor == 10 && applyCalls == 1, "apply hook runs");
+  rejectNextApply = true;
+  expect(set(reg, "lora.sf", "12") == PARAM_APPLY_FAILED && spreadingFactor == 10, "failed apply rolls back");
+  rejectNextApply = false;
+
+  ParamRegistry::format(*reg.find("event.threshold_g", 17), text, sizeof(text));
+  expect(strcmp(text, "event.threshold_g=1.5") == 0, "format");
+  ParamRegistry::describe(*reg.find("lora.power_dbm", 14), text, sizeof(text));
+  expect(strcmp(text, "lora.power_dbm=-3 int -9..22 persist") == 0, "describe");
+
+  // Persist, clobber, restore
+  ConfigTLV<256> cfg;
+  expect(storeParams(reg, cfg) && cfg.dirty(), "store marks dirty");
+  cfg.markClean();
+  expect(storeParams(reg, cfg) && !cfg.dirty(), "unchanged store stays clean");
+  intervalMs = 1;
+  thresholdG = 9.0f;
+  spreadingFactor = 7;
+  powerDbm = 0;
+  expect(loadParams(reg, cfg) == 4, "four persisted params restored");
+  expect(intervalMs == 250 && thresholdG == 1.5f && spreadingFactor == 10 && powerDbm == -3, "restored values");
+
+  // Out-of-range stored value is ignored on load
+  cfg.setU32(0x24, 99);
+  spreadingFactor = 8;
+  loadParams(reg, cfg);
+  expect(spreadingFactor == 8, "out-of-range stored value skipped");
+
+  printf("checks: %s (%d failure%s)\n", g_failures ? "FAIL" : "ok", g_failures, g_failures == 1 ? "" : "s");
+  return g_failures ? 1 : 0;
+}
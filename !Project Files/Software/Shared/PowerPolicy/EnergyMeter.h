@@ -0,0 +1,108 @@
+/*
+  Filename: EnergyMeter.h
+  Per-Subsystem Energy Meter (header-only, no Arduino dependency)
+
+  Description: Charge drawn by one subsystem (CPU, radio, Wi-Fi, SD card,
+               strain bridge) from its time in each state and a current
+               table in mA. Charge is banked at every transition with the
+               current of the state being left, so a table entry can be
+               changed (e.g. LoRa TX current after a power change) without
+               re-pricing time already spent. Timestamps are 64-bit
+               microseconds, as for TimeInState.
+
+               batteryLifeHours() projects how long a battery lasts at the
+               average current of a ledger window.
+
+  Usage:
+    const float radioMa[] = {4.6f, 118.0f};           // RX, TX
+    EnergyMeter<2> radio(radioMa);
+    radio.enter(RADIO_TX, esp_timer_get_time());
+    ...
+    double mAh = radio.mAh(esp_timer_get_time());
+*/
+
+#ifndef ENERGY_METER_H
+#define ENERGY_METER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "TimeInState.h"
+
+#define ENERGY_US_PER_HOUR 3600000000.0
+
+template <size_t States>
+class EnergyMeter {
+  public:
+    explicit EnergyMeter(const float (&currentMa)[States]) {
+      for (size_t i = 0; i < States; i++) {
+        _currentMa[i] = currentMa[i];
+      }
+      reset(0, 0);
+    }
+
+    void reset(size_t state, uint64_t nowUs) {
+      _time.reset(state, nowUs);
+      _chargeMaUs = 0;
+      _bankedUs = nowUs;
+    }
+
+    /**
+     * Switch to state (out-of-range states are ignored)
+     */
+    void enter(size_t state, uint64_t nowUs) {
+      if (state >= States || state == _time.current()) {
+        return;
+      }
+      bank(nowUs);
+      _time.enter(state, nowUs);
+    }
+
+    /**
+     * Change one state's current from now on
+     */
+    void setCurrent(size_t state, float currentMa, uint64_t nowUs) {
+      if (state >= States) {
+        return;
+      }
+      bank(nowUs);
+      _currentMa[state] = currentMa;
+    }
+
+    float currentMa(size_t state) const { return state < States ? _currentMa[state] : 0.0f; }
+    float presentMa() const { return _currentMa[_time.current()]; }
+
+    double mAh(uint64_t nowUs) const {
+      return (_chargeMaUs + _currentMa[_time.current()] * (double)(nowUs - _bankedUs)) / ENERGY_US_PER_HOUR;
+    }
+
+    const TimeInState<States>& time() const { return _time; }
+
+  private:
+    void bank(uint64_t nowUs) {
+      _chargeMaUs += _currentMa[_time.current()] * (double)(nowUs - _bankedUs);
+      _bankedUs = nowUs;
+    }
+
+    TimeInState<States> _time;
+    float _currentMa[States];
+    double _chargeMaUs;
+    uint64_t _bankedUs;
+};
+
+/**
+ * Battery life at the average current of a window
+ * @param capacityMah usable battery capacity
+ * @param windowMah charge drawn during the window
+ * @param windowUs window length
+ * @return hours from full, or 0 if the window is empty
+ */
+inline float batteryLifeHours(float capacityMah, double windowMah, uint64_t windowUs) {
+  if (windowUs == 0 || windowMah <= 0) {
+    return 0.0f;
+  }
+  double averageMa = windowMah * ENERGY_US_PER_HOUR / (double)windowUs;
+  return (float)(capacityMah / averageMa);
+}
+
+#endif
@@ -0,0 +1,171 @@
+/*
+  Filename: PowerPolicy.h
+  Sensor Power Policy (header-only, no Arduino dependency)
+
+  Description: Decides from the unit's activity state when each sensor
+               should be powered and how it should run. Recent activity
+               (an event, a command, a diagnostic mode) keeps the unit
+               ACTIVE: strain gauge powered, accelerometer in high
+               resolution, temperature/humidity on the short period. After
+               idleAfterMs without activity the unit goes IDLE: the strain
+               gauge only powers up for a burst every strainPeriodMs, the
+               accelerometer drops to low-power mode and the temperature/
+               humidity period lengthens. DutyMeter keeps each sensor's
+               on-time so the firmware can report its duty cycle.
+
+  Usage:
+    PowerPolicy policy(config);
+    policy.noteActivity(millis());                 // events, commands
+    PowerState state = policy.update(millis());
+    bool wantStrain = policy.strainWanted(millis());
+    ...
+    policy.strainBurstDone(millis());              // after an idle burst
+*/
+
+#ifndef POWER_POLICY_H
+#define POWER_POLICY_H
+
+#include <stdint.h>
+
+enum PowerState : uint8_t {
+  POWER_ACTIVE,
+  POWER_IDLE
+};
+
+struct PowerPolicyConfig {
+  uint32_t idleAfterMs;        // No activity for this long: ACTIVE -> IDLE
+  uint32_t strainPeriodMs;     // IDLE: one strain burst this often (0 = none)
+  uint32_t shtActiveMs;        // Temperature/humidity period while ACTIVE
+  uint32_t shtIdleMs;          // ... and while IDLE
+};
+
+/**
+ * On-time of one power domain since reset(), in milliseconds
+ * Times are 32-bit millis() values; differences survive wrap-around.
+ */
+class DutyMeter {
+  public:
+    DutyMeter() { reset(0); }
+
+    void reset(uint32_t nowMs) {
+      _startMs = nowMs;
+      _sinceMs = nowMs;
+      _onMs = 0;
+      _on = false;
+      _transitions = 0;
+    }
+
+    // Record the domain switching on or off (repeats are ignored)
+    void set(bool on, uint32_t nowMs) {
+      if (on == _on) {
+        return;
+      }
+      if (_on) {
+        _onMs += nowMs - _sinceMs;
+      }
+      _on = on;
+      _sinceMs = nowMs;
+      _transitions++;
+    }
+
+    // Add on-time directly (short measurements timed by the caller)
+    void addBusy(uint32_t ms) { _onMs += ms; }
+
+    uint64_t onMs(uint32_t nowMs) const {
+      return _onMs + (_on ? (uint64_t)(nowMs - _sinceMs) : 0);
+    }
+
+    float dutyPercent(uint32_t nowMs) const {
+      uint32_t elapsed = nowMs - _startMs;
+      return elapsed > 0 ? (float)(onMs(nowMs) * 100.0 / elapsed) : (_on ? 100.0f : 0.0f);
+    }
+
+    bool on() const { return _on; }
+    uint32_t transitions() const { return _transitions; }
+
+  private:
+    uint32_t _startMs;
+    uint32_t _sinceMs;
+    uint64_t _onMs;
+    bool _on;
+    uint32_t _transitions;
+};
+
+class PowerPolicy {
+  public:
+    explicit PowerPolicy(const PowerPolicyConfig& config)
+      : _config(config), _state(POWER_ACTIVE), _lastActivityMs(0),
+        _lastBurstMs(0), _burstActive(false), _lastShtMs(0), _shtTaken(false) {}
+
+    PowerPolicyConfig& config() { return _config; }
+
+    void noteActivity(uint32_t nowMs) {
+      _lastActivityMs = nowMs;
+      _state = POWER_ACTIVE;
+    }
+
+    /**
+     * Re-evaluate the activity state
+     * @return the state after this call
+     */
+    PowerState update(uint32_t nowMs) {
+      if (_state == POWER_ACTIVE && nowMs - _lastActivityMs >= _config.idleAfterMs) {
+        _state = POWER_IDLE;
+        // First idle burst a full period after the unit went quiet
+        _lastBurstMs = nowMs;
+        _burstActive = false;
+      }
+      return _state;
+    }
+
+    PowerState state() const { return _state; }
+
+    /**
+     * Should the strain gauge be powered now?
+     * ACTIVE: always. IDLE: while a burst is due or running.
+     */
+    bool strainWanted(uint32_t nowMs) {
+      if (_state == POWER_ACTIVE) {
+        return true;
+      }
+      if (!_burstActive && _config.strainPeriodMs > 0 && nowMs - _lastBurstMs >= _config.strainPeriodMs) {
+        _burstActive = true;
+        _lastBurstMs = nowMs;
+      }
+      return _burstActive;
+    }
+
+    // True while an idle burst has been started and not finished
+    bool burstActive() const { return _state == POWER_IDLE && _burstActive; }
+
+    void strainBurstDone(uint32_t nowMs) {
+      _burstActive = false;
+      _lastBurstMs = nowMs;
+    }
+
+    bool accelLowPower() const { return _state == POWER_IDLE; }
+
+    /**
+     * Is a temperature/humidity measurement due? Marks it taken when true.
+     */
+    bool shtDue(uint32_t nowMs) {
+      uint32_t period = (_state == POWER_ACTIVE) ? _config.shtActiveMs : _config.shtIdleMs;
+      if (_shtTaken && nowMs - _lastShtMs < period) {
+        return false;
+      }
+      _shtTaken = true;
+      _lastShtMs = nowMs;
+      return true;
+    }
+
+  private:
+    PowerPolicyConfig _config;
+    PowerState _state;
+    uint32_t _lastActivityMs;
+    uint32_t _lastBurstMs;
+    bool _burstActive;
+    uint32_t _lastShtMs;
+    bool _shtTaken;
+};
+
+#endif
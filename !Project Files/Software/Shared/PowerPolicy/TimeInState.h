@@ -0,0 +1,79 @@
+/*
+  Filename: TimeInState.h
+  Time-in-State Ledger (header-only, no Arduino dependency)
+
+  Description: Accumulates how long a component has spent in each of N
+               states (CPU clock steps, light sleep, radio modes). The
+               caller reports every transition with a 64-bit microsecond
+               timestamp (esp_timer_get_time() keeps counting through light
+               sleep); totals include the time in the current state.
+
+  Usage:
+    TimeInState<4> cpu;
+    cpu.enter(CLOCK_240, esp_timer_get_time());
+    ...
+    uint64_t us = cpu.totalUs(CLOCK_240, esp_timer_get_time());
+*/
+
+#ifndef TIME_IN_STATE_H
+#define TIME_IN_STATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+template <size_t States>
+class TimeInState {
+  static_assert(States > 0, "TimeInState needs at least one state");
+
+  public:
+    TimeInState() { reset(0, 0); }
+
+    void reset(size_t state, uint64_t nowUs) {
+      for (size_t i = 0; i < States; i++) {
+        _totalUs[i] = 0;
+        _entries[i] = 0;
+      }
+      _startUs = nowUs;
+      _sinceUs = nowUs;
+      _current = state < States ? state : 0;
+    }
+
+    /**
+     * Switch to state (out-of-range states are ignored)
+     */
+    void enter(size_t state, uint64_t nowUs) {
+      if (state >= States || state == _current) {
+        return;
+      }
+      _totalUs[_current] += nowUs - _sinceUs;
+      _current = state;
+      _sinceUs = nowUs;
+      _entries[state]++;
+    }
+
+    size_t current() const { return _current; }
+    uint32_t entries(size_t state) const { return state < States ? _entries[state] : 0; }
+
+    uint64_t totalUs(size_t state, uint64_t nowUs) const {
+      if (state >= States) {
+        return 0;
+      }
+      return _totalUs[state] + (state == _current ? nowUs - _sinceUs : 0);
+    }
+
+    float percent(size_t state, uint64_t nowUs) const {
+      uint64_t elapsed = nowUs - _startUs;
+      return elapsed > 0 ? (float)(totalUs(state, nowUs) * 100.0 / elapsed) : 0.0f;
+    }
+
+    uint64_t elapsedUs(uint64_t nowUs) const { return nowUs - _startUs; }
+
+  private:
+    uint64_t _totalUs[States];
+    uint32_t _entries[States];
+    uint64_t _startUs;
+    uint64_t _sinceUs;
+    size_t _current;
+};
+
+#endif
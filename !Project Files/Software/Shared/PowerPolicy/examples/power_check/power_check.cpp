@@ -0,0 +1,198 @@
+/*
+  Filename: power_check.cpp
+  PowerPolicy checks (Linux host)
+
+  Description: Walks the policy through a simulated hour: activity keeps it
+               ACTIVE, silence moves it to IDLE with periodic strain bursts
+               and the long temperature/humidity period, and new activity
+               brings it back. Checks the duty meters against the expected
+               on-time, including across a millis() wrap, the TimeInState
+               ledger over a clock/light-sleep schedule, and the energy
+               meter and battery projection against hand-computed charge.
+               Exits non-zero if any check fails.
+
+  Build/run (from this folder):
+    g++ -O2 -std=c++17 -I../.. power_check.cpp -o power_check
+    ./power_check
+*/
+
+#include <cmath>
+#include <cstdio>
+
+#include "EnergyMeter.h"
+#include "PowerPolicy.h"
+#include "TimeInState.h"
+
+static int g_failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+      g_failures++; \
+      printf("FAIL line %d: %s\n", __LINE__, #cond); \
+    } \
+  } while (0)
+
+static const PowerPolicyConfig kConfig = {
+  30000,    // idle after 30 s
+  60000,    // strain burst every 60 s
+  10000,    // SHT45 every 10 s while active
+  300000    // ... every 5 min while idle
+};
+
+static void checkStates() {
+  PowerPolicy policy(kConfig);
+  policy.noteActivity(0);
+  CHECK(policy.update(1000) == POWER_ACTIVE);
+  CHECK(policy.strainWanted(1000));
+  CHECK(!policy.accelLowPower());
+  CHECK(policy.update(29999) == POWER_ACTIVE);
+  CHECK(policy.update(30000) == POWER_IDLE);
+  CHECK(policy.accelLowPower());
+
+  // No burst until a full period after going idle
+  CHECK(!policy.strainWanted(30001));
+  CHECK(!policy.strainWanted(89999));
+  CHECK(policy.strainWanted(90000));
+  CHECK(policy.burstActive());
+  CHECK(policy.strainWanted(90400));     // Still running until reported done
+  policy.strainBurstDone(90500);
+  CHECK(!policy.strainWanted(90600));
+  CHECK(!policy.strainWanted(150499));
+  CHECK(policy.strainWanted(150500));
+
+  // Activity cancels the burst bookkeeping and powers everything up
+  policy.noteActivity(151000);
+  CHECK(policy.update(151000) == POWER_ACTIVE);
+  CHECK(!policy.burstActive());
+  CHECK(policy.strainWanted(151001));
+  CHECK(!policy.accelLowPower());
+}
+
+static void checkShtSchedule() {
+  PowerPolicy policy(kConfig);
+  policy.noteActivity(0);
+  policy.update(0);
+  CHECK(policy.shtDue(0));               // First measurement straight away
+  CHECK(!policy.shtDue(9999));
+  CHECK(policy.shtDue(10000));
+
+  int idleReads = 0;
+  for (uint32_t t = 40000; t < 40000 + 3600000; t += 1000) {
+    policy.update(t);
+    if (policy.shtDue(t)) idleReads++;
+  }
+  CHECK(policy.state() == POWER_IDLE);
+  CHECK(idleReads == 12);                // 1 h at 5 min
+}
+
+static void checkDuty() {
+  DutyMeter meter;
+  meter.reset(1000);
+  meter.set(true, 1000);
+  meter.set(true, 2000);                 // Repeat ignored
+  meter.set(false, 3000);
+  meter.set(true, 9000);
+  CHECK(meter.onMs(10000) == 3000);
+  CHECK(std::fabs(meter.dutyPercent(11000) - 40.0f) < 0.01f);
+  CHECK(meter.transitions() == 3);
+  meter.addBusy(1000);
+  CHECK(meter.onMs(10000) == 4000);
+
+  // Wrap: on from 2^32 - 500 ms to 500 ms after the wrap
+  DutyMeter wrap;
+  wrap.reset(0xFFFFF000u);
+  wrap.set(true, 0xFFFFFE0Cu);
+  wrap.set(false, 500u);
+  CHECK(wrap.onMs(1000u) == 1000);
+  CHECK(std::fabs(wrap.dutyPercent(0xFFFFF000u + 10000u) - 10.0f) < 0.01f);
+}
+
+static void checkDutyOverHour() {
+  // Idle hour: 2 s strain bursts every 60 s should give about 3.3 % on-time
+  PowerPolicy policy(kConfig);
+  DutyMeter strain;
+  policy.noteActivity(0);
+  strain.reset(0);
+  uint32_t burstStart = 0;
+  for (uint32_t t = 0; t <= 3600000; t += 100) {
+    policy.update(t);
+    bool want = policy.strainWanted(t);
+    strain.set(want, t);
+    if (policy.burstActive()) {
+      if (burstStart == 0) burstStart = t;
+      if (t - burstStart >= 2000) {
+        policy.strainBurstDone(t);
+        burstStart = 0;
+      }
+    }
+  }
+  float duty = strain.dutyPercent(3600000);
+  printf("idle hour: strain on %.2f %% (%lu transitions)\n", duty, (unsigned long)strain.transitions());
+  // 30 s active at the start, then 59 bursts of 2 s
+  CHECK(duty > 3.8f && duty < 4.3f);
+}
+
+static void checkTimeInState() {
+  enum { MHZ_240, MHZ_80, SLEEP, STATES };
+  TimeInState<STATES> cpu;
+  cpu.reset(MHZ_240, 1000000);
+  cpu.enter(MHZ_240, 1500000);           // Same state: no entry counted
+  cpu.enter(MHZ_80, 2000000);
+  cpu.enter(7, 2100000);                 // Out of range: ignored
+  CHECK(cpu.current() == MHZ_80);
+
+  // 100 ms cycles: 5 ms awake at 80 MHz, 95 ms light sleep, for 10 s
+  uint64_t t = 2000000;
+  for (int i = 0; i < 100; i++) {
+    cpu.enter(SLEEP, t + 5000);
+    cpu.enter(MHZ_80, t + 100000);
+    t += 100000;
+  }
+  CHECK(cpu.totalUs(MHZ_240, t) == 1000000);
+  CHECK(cpu.totalUs(SLEEP, t) == 9500000);
+  CHECK(cpu.totalUs(MHZ_80, t) == 500000);
+  CHECK(cpu.entries(SLEEP) == 100);
+  CHECK(cpu.elapsedUs(t) == 11000000);
+  CHECK(std::fabs(cpu.percent(SLEEP, t) - 86.36f) < 0.01f);
+
+  // The current state's time counts up to "now"
+  CHECK(cpu.totalUs(MHZ_80, t + 250000) == 750000);
+}
+
+static void checkEnergy() {
+  enum { RX, TX, STATES };
+  const float radioMa[] = {5.0f, 100.0f};
+  EnergyMeter<STATES> radio(radioMa);
+  radio.reset(RX, 0);
+
+  // One hour in RX, then 36 s of TX: 5 mAh + 1 mAh
+  const uint64_t hourUs = 3600000000ULL;
+  radio.enter(TX, hourUs);
+  radio.enter(RX, hourUs + 36000000);
+  CHECK(std::fabs(radio.mAh(hourUs + 36000000) - 6.0) < 1e-6);
+  CHECK(radio.time().entries(TX) == 1);
+
+  // A new TX current applies from now on; the 36 s already spent stay at 100 mA
+  radio.setCurrent(TX, 200.0f, hourUs + 36000000);
+  radio.enter(TX, hourUs + 36000000);
+  radio.enter(RX, hourUs + 54000000);
+  CHECK(std::fabs(radio.mAh(hourUs + 54000000) - 7.0) < 1e-6);
+  CHECK(radio.presentMa() == 5.0f);
+  CHECK(radio.currentMa(TX) == 200.0f);
+
+  // 10 mAh over 2 h is 5 mA average: 2000 mAh lasts 400 h
+  CHECK(std::fabs(batteryLifeHours(2000.0f, 10.0, 2 * hourUs) - 400.0f) < 0.01f);
+  CHECK(batteryLifeHours(2000.0f, 0.0, hourUs) == 0.0f);
+  CHECK(batteryLifeHours(2000.0f, 1.0, 0) == 0.0f);
+}
+
+int main() {
+  checkStates();
+  checkShtSchedule();
+  checkDuty();
+  checkDutyOverHour();
+  checkTimeInState();
+  checkEnergy();
+  printf("checks: %s (%d failure%s)\n", g_failures ? "FAIL" : "ok", g_failures, g_failures == 1 ? "" : "s");
+  return g_failures ? 1 : 0;
+}
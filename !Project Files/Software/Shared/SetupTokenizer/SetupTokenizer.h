@@ -0,0 +1,243 @@
+/*
+  Filename: SetupTokenizer.h
+  SETUP Packet Tokenizer (header-only, no Arduino dependency)
+
+  Description: Splits the key=value;key=value body of a SETUP: packet into
+               fields without copying or heap allocation. Keys are resolved
+               against a compile-time sorted table with a binary search, and
+               values are handed back as views into the original packet.
+               Shared by the receiver (parseSetupPacket) and transmitter
+               (parseAndStoreWifiProfiles) so both firmwares agree on the
+               wire format.
+
+  Usage:
+    SetupTokenizer tok(packet.c_str(), packet.length());   // "SETUP:" prefix optional
+    SetupField field;
+    while (tok.next(field)) {
+      switch (field.key) {
+        case SETUP_KEY_SI:        interval = field.value.toLong(); break;
+        case SETUP_KEY_WIFI_SSID: ssids[field.index] = ...;         break;
+        default: break;
+      }
+    }
+
+  Values stay valid for as long as the packet buffer does.
+*/
+
+#ifndef SETUP_TOKENIZER_H
+#define SETUP_TOKENIZER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum SetupKey : uint8_t {
+  SETUP_KEY_UNKNOWN = 0,
+  SETUP_KEY_AP_PASS,    // app   sweep SoftAP password
+  SETUP_KEY_AP_SSID,    // aps   sweep SoftAP SSID
+  SETUP_KEY_DESC,       // desc  event description text
+  SETUP_KEY_DI,         // di    include description (0/1)
+  SETUP_KEY_DUR,        // dur   event capture duration (ms)
+  SETUP_KEY_M,          // m     setup mask (which groups to apply)
+  SETUP_KEY_SI,         // si    sensor read interval (ms)
+  SETUP_KEY_SR,         // sr    lab sample rate (Hz)
+  SETUP_KEY_THR,        // thr   event trigger threshold (g)
+  SETUP_KEY_TI,         // ti    include truck ID (0/1)
+  SETUP_KEY_TID,        // tid   truck ID text
+  SETUP_KEY_WIFI_SSID,  // w<n>s Wi-Fi profile n SSID (index in SetupField::index)
+  SETUP_KEY_WIFI_PASS   // w<n>p Wi-Fi profile n password
+};
+
+struct SetupSpan {
+  const char* ptr;
+  size_t len;
+
+  bool empty() const { return len == 0; }
+
+  bool equals(const char* text) const {
+    return strlen(text) == len && memcmp(ptr, text, len) == 0;
+  }
+
+  // Same result as Arduino String::toInt() (atol) without needing a terminator
+  long toLong() const {
+    size_t i = 0;
+    bool negative = false;
+    if (i < len && (ptr[i] == '-' || ptr[i] == '+')) {
+      negative = (ptr[i] == '-');
+      i++;
+    }
+    long v = 0;
+    while (i < len && ptr[i] >= '0' && ptr[i] <= '9') {
+      v = v * 10 + (ptr[i] - '0');
+      i++;
+    }
+    return negative ? -v : v;
+  }
+
+  // Same result as String::toFloat(); copies into a small stack buffer for strtof
+  float toFloat() const {
+    char buffer[32];
+    copyTo(buffer, sizeof(buffer));
+    return strtof(buffer, nullptr);
+  }
+
+  // NUL-terminated copy, truncated to fit
+  size_t copyTo(char* out, size_t outSize) const {
+    if (outSize == 0) {
+      return 0;
+    }
+    size_t n = len < (outSize - 1) ? len : (outSize - 1);
+    memcpy(out, ptr, n);
+    out[n] = '\0';
+    return n;
+  }
+};
+
+struct SetupField {
+  SetupKey key;
+  uint8_t index;      // Wi-Fi profile slot for SETUP_KEY_WIFI_*; 0 otherwise
+  SetupSpan name;     // Raw key text (useful for logging unknown keys)
+  SetupSpan value;
+};
+
+namespace setup_tokenizer_detail {
+
+struct KeyEntry {
+  const char* name;
+  SetupKey key;
+};
+
+// Must stay sorted by strcmp order; checked at compile time below.
+static constexpr KeyEntry KEY_TABLE[] = {
+  {"app",  SETUP_KEY_AP_PASS},
+  {"aps",  SETUP_KEY_AP_SSID},
+  {"desc", SETUP_KEY_DESC},
+  {"di",   SETUP_KEY_DI},
+  {"dur",  SETUP_KEY_DUR},
+  {"m",    SETUP_KEY_M},
+  {"si",   SETUP_KEY_SI},
+  {"sr",   SETUP_KEY_SR},
+  {"thr",  SETUP_KEY_THR},
+  {"ti",   SETUP_KEY_TI},
+  {"tid",  SETUP_KEY_TID},
+};
+static constexpr size_t KEY_COUNT = sizeof(KEY_TABLE) / sizeof(KEY_TABLE[0]);
+
+constexpr int constexprCompare(const char* a, const char* b) {
+  return (*a != *b || *a == '\0') ? (int)(unsigned char)*a - (int)(unsigned char)*b
+                                  : constexprCompare(a + 1, b + 1);
+}
+
+constexpr bool tableSorted(size_t i) {
+  return (i + 1 >= KEY_COUNT) ? true
+                              : (constexprCompare(KEY_TABLE[i].name, KEY_TABLE[i + 1].name) < 0 && tableSorted(i + 1));
+}
+
+static_assert(tableSorted(0), "SETUP key table must be sorted");
+
+// strcmp() between a NUL-terminated table name and a length-bounded span
+inline int compareKey(const char* name, const char* key, size_t keyLen) {
+  for (size_t i = 0; i < keyLen; i++) {
+    unsigned char a = (unsigned char)name[i];
+    unsigned char b = (unsigned char)key[i];
+    if (a != b || a == '\0') {
+      return (int)a - (int)b;
+    }
+  }
+  return (unsigned char)name[keyLen];
+}
+
+inline bool isSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+inline SetupSpan trimmed(const char* begin, const char* end) {
+  while (begin < end && isSpace(*begin)) begin++;
+  while (end > begin && isSpace(*(end - 1))) end--;
+  SetupSpan span = {begin, (size_t)(end - begin)};
+  return span;
+}
+
+}  // namespace setup_tokenizer_detail
+
+/**
+ * Resolve a key name to its SetupKey (Wi-Fi profile keys set index)
+ */
+inline SetupKey lookupSetupKey(const char* key, size_t keyLen, uint8_t& index) {
+  using namespace setup_tokenizer_detail;
+  index = 0;
+
+  // w<digit>s / w<digit>p are a family rather than table entries
+  if (keyLen == 3 && key[0] == 'w' && key[1] >= '0' && key[1] <= '9') {
+    index = (uint8_t)(key[1] - '0');
+    if (key[2] == 's') return SETUP_KEY_WIFI_SSID;
+    if (key[2] == 'p') return SETUP_KEY_WIFI_PASS;
+    index = 0;
+    return SETUP_KEY_UNKNOWN;
+  }
+
+  size_t lo = 0;
+  size_t hi = KEY_COUNT;
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    int cmp = compareKey(KEY_TABLE[mid].name, key, keyLen);
+    if (cmp == 0) {
+      return KEY_TABLE[mid].key;
+    }
+    if (cmp < 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return SETUP_KEY_UNKNOWN;
+}
+
+class SetupTokenizer {
+  public:
+    /**
+     * @param data SETUP packet, with or without the "SETUP:" prefix
+     * @param len Packet length in bytes
+     */
+    SetupTokenizer(const char* data, size_t len) {
+      if (len >= 6 && memcmp(data, "SETUP:", 6) == 0) {
+        data += 6;
+        len -= 6;
+      }
+      _pos = data;
+      _end = data + len;
+    }
+
+    /**
+     * Advance to the next key=value token; tokens without '=' or with an
+     * empty key are skipped, matching the old String parser
+     * @return false once the packet is exhausted
+     */
+    bool next(SetupField& out) {
+      using namespace setup_tokenizer_detail;
+      while (_pos < _end) {
+        const char* tokenStart = _pos;
+        const char* sep = (const char*)memchr(_pos, ';', (size_t)(_end - _pos));
+        const char* tokenEnd = (sep != nullptr) ? sep : _end;
+        _pos = (sep != nullptr) ? sep + 1 : _end;
+
+        const char* eq = (const char*)memchr(tokenStart, '=', (size_t)(tokenEnd - tokenStart));
+        if (eq == nullptr || eq == tokenStart) {
+          continue;
+        }
+
+        out.name = trimmed(tokenStart, eq);
+        out.value = trimmed(eq + 1, tokenEnd);
+        out.key = lookupSetupKey(out.name.ptr, out.name.len, out.index);
+        return true;
+      }
+      return false;
+    }
+
+  private:
+    const char* _pos;
+    const char* _end;
+};
+
+#endif
@@ -0,0 +1,206 @@
+/*
+  Filename: setup_bench.cpp
+  SetupTokenizer checks and benchmark (Linux host)
+
+  Description: 1) Checks SetupTokenizer against a reference parser that
+                  mirrors the old String code (substring/trim/== chain) on
+                  fixed cases and randomly generated packets.
+               2) Times both parsers on a realistic full SETUP packet and
+                  reports ns per packet and heap allocations per packet.
+               Exits non-zero if any check fails.
+
+  Build/run (from this folder):
+    g++ -O2 -std=c++17 -I../.. setup_bench.cpp -o setup_bench
+    ./setup_bench [iterations=200000]
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "SetupTokenizer.h"
+
+static std::atomic<uint64_t> g_allocations{0};
+static bool g_countAllocations = false;
+
+void* operator new(size_t n) {
+  if (g_countAllocations) g_allocations.fetch_add(1, std::memory_order_relaxed);
+  void* p = malloc(n);
+  if (p == nullptr) throw std::bad_alloc();
+  return p;
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+// Parsed result both parsers fill in, compared field by field
+struct SetupResult {
+  long si = -1, m = -1, sr = -1, dur = -1;
+  float thr = -1.0f;
+  int ti = -1, di = -1;
+  std::string tid = "<unset>", desc = "<unset>";
+  std::string ssid[3] = {"<unset>", "<unset>", "<unset>"};
+  std::string pass[3] = {"<unset>", "<unset>", "<unset>"};
+  std::string apSsid = "<unset>", apPass = "<unset>";
+
+  bool operator==(const SetupResult& o) const {
+    if (si != o.si || m != o.m || sr != o.sr || dur != o.dur || thr != o.thr) return false;
+    if (ti != o.ti || di != o.di || tid != o.tid || desc != o.desc) return false;
+    if (apSsid != o.apSsid || apPass != o.apPass) return false;
+    for (int i = 0; i < 3; i++) {
+      if (ssid[i] != o.ssid[i] || pass[i] != o.pass[i]) return false;
+    }
+    return true;
+  }
+};
+
+static std::string trimCopy(const std::string& s) {
+  size_t b = s.find_first_not_of(" \t\r\n\v\f");
+  if (b == std::string::npos) return std::string();
+  size_t e = s.find_last_not_of(" \t\r\n\v\f");
+  return s.substr(b, e - b + 1);
+}
+
+// Mirrors the original String-based loop in parseSetupPacket()
+static void parseReference(const std::string& packet, SetupResult& r) {
+  std::string data = trimCopy(packet.substr(6));
+  size_t start = 0;
+  while (start < data.size()) {
+    size_t sep = data.find(';', start);
+    if (sep == std::string::npos) sep = data.size();
+    std::string token = data.substr(start, sep - start);
+    size_t eq = token.find('=');
+    if (eq != std::string::npos && eq > 0) {
+      std::string key = trimCopy(token.substr(0, eq));
+      std::string value = trimCopy(token.substr(eq + 1));
+      if (key == "si") r.si = atol(value.c_str());
+      else if (key == "m") r.m = atol(value.c_str());
+      else if (key == "thr") r.thr = (float)atof(value.c_str());
+      else if (key == "sr") r.sr = atol(value.c_str());
+      else if (key == "dur") r.dur = atol(value.c_str());
+      else if (key == "ti") r.ti = (value == "1");
+      else if (key == "tid") r.tid = value;
+      else if (key == "di") r.di = (value == "1");
+      else if (key == "desc") r.desc = value;
+      else if (key == "aps") r.apSsid = value;
+      else if (key == "app") r.apPass = value;
+      else if (key.size() == 3 && key[0] == 'w' && isdigit((unsigned char)key[1])) {
+        int idx = key[1] - '0';
+        if (idx < 3) {
+          if (key[2] == 's') r.ssid[idx] = value;
+          else if (key[2] == 'p') r.pass[idx] = value;
+        }
+      }
+    }
+    start = sep + 1;
+  }
+}
+
+static void parseTokenizer(const std::string& packet, SetupResult& r) {
+  SetupTokenizer tokenizer(packet.data(), packet.size());
+  SetupField field;
+  while (tokenizer.next(field)) {
+    switch (field.key) {
+      case SETUP_KEY_SI:   r.si = field.value.toLong(); break;
+      case SETUP_KEY_M:    r.m = field.value.toLong(); break;
+      case SETUP_KEY_THR:  r.thr = field.value.toFloat(); break;
+      case SETUP_KEY_SR:   r.sr = field.value.toLong(); break;
+      case SETUP_KEY_DUR:  r.dur = field.value.toLong(); break;
+      case SETUP_KEY_TI:   r.ti = field.value.equals("1"); break;
+      case SETUP_KEY_DI:   r.di = field.value.equals("1"); break;
+      case SETUP_KEY_TID:  r.tid.assign(field.value.ptr, field.value.len); break;
+      case SETUP_KEY_DESC: r.desc.assign(field.value.ptr, field.value.len); break;
+      case SETUP_KEY_AP_SSID: r.apSsid.assign(field.value.ptr, field.value.len); break;
+      case SETUP_KEY_AP_PASS: r.apPass.assign(field.value.ptr, field.value.len); break;
+      case SETUP_KEY_WIFI_SSID:
+        if (field.index < 3) r.ssid[field.index].assign(field.value.ptr, field.value.len);
+        break;
+      case SETUP_KEY_WIFI_PASS:
+        if (field.index < 3) r.pass[field.index].assign(field.value.ptr, field.value.len);
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+static int g_failures = 0;
+
+static void check(const std::string& packet) {
+  SetupResult a, b;
+  parseReference(packet, a);
+  parseTokenizer(packet, b);
+  if (!(a == b)) {
+    g_failures++;
+    if (g_failures <= 5) printf("MISMATCH: \"%s\"\n", packet.c_str());
+  }
+}
+
+static std::string randomPacket(std::mt19937& rng) {
+  static const char* keys[] = {"si", "m", "thr", "sr", "dur", "ti", "tid", "di", "desc", "aps", "app",
+                               "w0s", "w0p", "w1s", "w2p", "w9s", "wxs", "w1q", "x", "sii", "d", "t", "ap", ""};
+  static const char* values[] = {"100", "-5", "0.25", "1", "0", "TRK 12", " spaced ", "", "abc=def", "+7", "3.5e-1"};
+  std::string packet = "SETUP:";
+  int fields = rng() % 12;
+  for (int i = 0; i < fields; i++) {
+    if (rng() % 4 == 0) packet += " ";
+    packet += keys[rng() % (sizeof(keys) / sizeof(keys[0]))];
+    if (rng() % 8 != 0) packet += "=";
+    packet += values[rng() % (sizeof(values) / sizeof(values[0]))];
+    if (rng() % 4 == 0) packet += "\t";
+    packet += (rng() % 10 == 0) ? ";;" : ";";
+  }
+  return packet;
+}
+
+template <typename Fn>
+static void bench(const char* name, const std::string& packet, long iterations, Fn fn) {
+  SetupResult sink;
+  g_allocations = 0;
+  g_countAllocations = true;
+  auto t0 = std::chrono::steady_clock::now();
+  for (long i = 0; i < iterations; i++) {
+    fn(packet, sink);
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  g_countAllocations = false;
+  double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / iterations;
+  printf("%-9s %.0f ns/packet allocs/packet=%.2f (si=%ld)\n",
+         name, ns, (double)g_allocations.load() / iterations, sink.si);
+}
+
+int main(int argc, char** argv) {
+  long iterations = argc > 1 ? strtol(argv[1], nullptr, 10) : 200000;
+
+  const char* fixed[] = {
+    "SETUP:si=100;m=127;thr=0.25;sr=20;dur=1500;ti=1;tid=TRK-042;di=1;desc=Left axle",
+    "SETUP: si = 250 ; m=3 ;",
+    "SETUP:m=64;w0s=Yard AP;w0p=secret pw;w1s=Shop;w1p=;w2s=Guest;w2p=guest123",
+    "SETUP:m=64;aps=Yard Sweep 7;app=per-site secret;apss=ignored",
+    "SETUP:=5;si;thr=abc;tid=;desc=a=b",
+    "SETUP:",
+    "SETUP:w5s=ignored;w0x=ignored;sii=1",
+  };
+  for (const char* p : fixed) {
+    check(p);
+  }
+
+  std::mt19937 rng(1234);
+  for (int i = 0; i < 100000; i++) {
+    check(randomPacket(rng));
+  }
+  printf("checks: %s (%d mismatch%s)\n", g_failures ? "FAIL" : "ok", g_failures, g_failures == 1 ? "" : "es");
+
+  // Full setup from the GUI: every group selected, three Wi-Fi profiles
+  std::string packet = "SETUP:si=100;m=127;thr=0.250;sr=20;dur=1500;ti=1;tid=TRK-042;di=1;"
+                       "desc=Left rear axle strain gauge;w0s=Wabash Yard;w0p=yard-pass-2026;"
+                       "w1s=Maintenance Shop;w1p=shop-pass;w2s=Guest;w2p=guest123";
+  bench("string", packet, iterations, parseReference);
+  bench("tokenizer", packet, iterations, parseTokenizer);
+
+  return g_failures ? 1 : 0;
+}
@@ -0,0 +1,98 @@
+/*
+  Filename: MemStatus.h
+  Heap, Stack and Pool Status Report (header-only, ESP32 Arduino)
+
+  Description: Prints what a unit has left before a configuration change
+               lands it in trouble: free heap, the lowest free heap since
+               boot, the largest free block and the resulting fragmentation,
+               the stack high-water mark of each named task, and the use of
+               every StaticPool. memStatusSummary() packs the headline
+               numbers into one line for a LoRa reply.
+*/
+
+#ifndef MEM_STATUS_H
+#define MEM_STATUS_H
+
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "StaticPool.h"
+
+struct HeapStatus {
+  uint32_t freeBytes;
+  uint32_t minFreeBytes;      // Low-water mark since boot
+  uint32_t largestBlock;
+  uint8_t fragmentationPct;   // 100 - largest block as a share of free heap
+};
+
+inline HeapStatus memStatusHeap() {
+  HeapStatus h;
+  h.freeBytes = (uint32_t)heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  h.minFreeBytes = (uint32_t)heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+  h.largestBlock = (uint32_t)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+  h.fragmentationPct = (h.freeBytes > 0)
+                         ? (uint8_t)(100 - (uint64_t)h.largestBlock * 100 / h.freeBytes)
+                         : 0;
+  return h;
+}
+
+/**
+ * Unused stack of a task by name, in bytes
+ * @return -1 if no task has that name (e.g. Wi-Fi is off)
+ */
+inline int32_t memStatusStackFree(const char* taskName) {
+  TaskHandle_t task = xTaskGetHandle(taskName);
+  if (task == nullptr) {
+    return -1;
+  }
+  // ESP-IDF reports the high-water mark in bytes
+  return (int32_t)uxTaskGetStackHighWaterMark(task);
+}
+
+/**
+ * Print heap, the listed tasks' stack high-water marks and all pools
+ */
+inline void memStatusPrint(Print& out, const char* const* taskNames, size_t taskCount) {
+  HeapStatus h = memStatusHeap();
+  out.printf("Heap:   free=%lu min=%lu largest=%lu frag=%u%%\n",
+             (unsigned long)h.freeBytes, (unsigned long)h.minFreeBytes,
+             (unsigned long)h.largestBlock, h.fragmentationPct);
+
+  out.println("Stack high-water (bytes never used):");
+  for (size_t i = 0; i < taskCount; i++) {
+    int32_t stackFree = memStatusStackFree(taskNames[i]);
+    if (stackFree < 0) {
+      out.printf("  %-10s not running\n", taskNames[i]);
+    } else {
+      out.printf("  %-10s %ld\n", taskNames[i], (long)stackFree);
+    }
+  }
+
+  out.println("Pools (block x count, in use, peak, failed):");
+  for (StaticPoolBase* pool = StaticPoolBase::first(); pool != nullptr; pool = pool->next()) {
+    PoolStats s = pool->stats();
+    out.printf("  %-10s %6lu x %-3u used=%u peak=%u fail=%lu\n",
+               s.name, (unsigned long)s.blockSize, s.blocks, s.inUse, s.peak,
+               (unsigned long)s.failures);
+  }
+}
+
+/**
+ * One-line summary: heap, fragmentation, stack high-water of taskName, pool failures
+ * @return characters written
+ */
+inline size_t memStatusSummary(char* out, size_t outSize, const char* taskName) {
+  HeapStatus h = memStatusHeap();
+  uint32_t failures = 0;
+  for (StaticPoolBase* pool = StaticPoolBase::first(); pool != nullptr; pool = pool->next()) {
+    failures += pool->stats().failures;
+  }
+  int n = snprintf(out, outSize, "free=%lu,min=%lu,largest=%lu,frag=%u,stack=%ld,pool_fail=%lu",
+                   (unsigned long)h.freeBytes, (unsigned long)h.minFreeBytes,
+                   (unsigned long)h.largestBlock, h.fragmentationPct,
+                   (long)memStatusStackFree(taskName), (unsigned long)failures);
+  return (n < 0) ? 0 : (size_t)n;
+}
+
+#endif
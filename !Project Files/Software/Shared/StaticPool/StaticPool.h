@@ -0,0 +1,191 @@
+/*
+  Filename: StaticPool.h
+  Fixed-Size Block Pools (header-only, no Arduino dependency)
+
+  Description: Named pools of equal-sized blocks carved from static storage,
+               so event, packet and line buffers are sized at link time
+               instead of coming from the heap. Every pool registers itself
+               on construction; MemStatus.h walks the list to report block
+               size, blocks in use, peak use and failed acquisitions.
+
+  Usage:
+    StaticPool<LORA_MAX_PACKET_SIZE + 1, 3> g_packetPool("packet");
+
+    PoolBlock packet(g_packetPool);      // released when it goes out of scope
+    if (!packet) {
+      return;                            // pool exhausted; counted as a failure
+    }
+    size_t len = radio.read(packet.bytes(), packet.size());
+*/
+
+#ifndef STATIC_POOL_H
+#define STATIC_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(ESP_PLATFORM)
+  #include <freertos/FreeRTOS.h>
+#else
+  #include <mutex>
+#endif
+
+struct PoolStats {
+  const char* name;
+  uint32_t blockSize;
+  uint16_t blocks;
+  uint16_t inUse;
+  uint16_t peak;
+  uint32_t failures;      // acquire() calls that found the pool empty
+};
+
+class StaticPoolBase {
+  public:
+    /**
+     * Take a free block
+     * @return block pointer, nullptr if the pool is exhausted
+     */
+    void* acquire() {
+      lock();
+      void* block = nullptr;
+      if (_freeCount > 0) {
+        block = _storage + (size_t)_freeList[--_freeCount] * _blockSize;
+        uint16_t inUse = _blocks - _freeCount;
+        if (inUse > _peak) {
+          _peak = inUse;
+        }
+      } else {
+        _failures++;
+      }
+      unlock();
+      return block;
+    }
+
+    /**
+     * Return a block taken with acquire()
+     * @return false if block does not belong to this pool
+     */
+    bool release(void* block) {
+      uint8_t* p = (uint8_t*)block;
+      if (p < _storage || p >= _storage + (size_t)_blocks * _blockSize ||
+          (size_t)(p - _storage) % _blockSize != 0) {
+        return false;
+      }
+      lock();
+      bool ok = _freeCount < _blocks;
+      if (ok) {
+        _freeList[_freeCount++] = (uint8_t)((size_t)(p - _storage) / _blockSize);
+      }
+      unlock();
+      return ok;
+    }
+
+    PoolStats stats() const {
+      PoolStats s;
+      s.name = _name;
+      s.blockSize = (uint32_t)_blockSize;
+      s.blocks = _blocks;
+      s.inUse = _blocks - _freeCount;
+      s.peak = _peak;
+      s.failures = _failures;
+      return s;
+    }
+
+    const char* name() const { return _name; }
+    size_t blockSize() const { return _blockSize; }
+
+    /**
+     * Registered pools, in construction order
+     */
+    static StaticPoolBase* first() { return head(); }
+    StaticPoolBase* next() const { return _next; }
+
+  protected:
+    StaticPoolBase(const char* name, uint8_t* storage, uint8_t* freeList, size_t blockSize, uint16_t blocks)
+      : _name(name), _storage(storage), _freeList(freeList), _blockSize(blockSize),
+        _blocks(blocks), _freeCount(0), _peak(0), _failures(0), _next(nullptr) {
+      // Append so reports list pools in declaration order
+      StaticPoolBase** link = &head();
+      while (*link != nullptr) {
+        link = &(*link)->_next;
+      }
+      *link = this;
+    }
+
+    void fillFreeList() {
+      // Highest index first so the first acquire() gets block 0
+      for (uint16_t i = 0; i < _blocks; i++) {
+        _freeList[i] = (uint8_t)(_blocks - 1 - i);
+      }
+      _freeCount = _blocks;
+    }
+
+  private:
+    const char* _name;
+    uint8_t* _storage;
+    uint8_t* _freeList;
+    size_t _blockSize;
+    uint16_t _blocks;
+    uint16_t _freeCount;
+    uint16_t _peak;
+    uint32_t _failures;
+    StaticPoolBase* _next;
+
+    static StaticPoolBase*& head() {
+      static StaticPoolBase* list = nullptr;
+      return list;
+    }
+
+#if defined(ESP_PLATFORM)
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+    void lock() { portENTER_CRITICAL(&_mux); }
+    void unlock() { portEXIT_CRITICAL(&_mux); }
+#else
+    std::mutex _mutex;
+    void lock() { _mutex.lock(); }
+    void unlock() { _mutex.unlock(); }
+#endif
+};
+
+template <size_t BlockSize, size_t Blocks>
+class StaticPool : public StaticPoolBase {
+  public:
+    explicit StaticPool(const char* name)
+      : StaticPoolBase(name, &_storage[0][0], _freeListStorage, Stride, (uint16_t)Blocks) {
+      static_assert(Blocks > 0 && Blocks <= 255, "free list indexes are 8-bit");
+      static_assert(BlockSize > 0, "empty blocks");
+      fillFreeList();
+    }
+
+  private:
+    static const size_t Stride = (BlockSize + 7) & ~(size_t)7;   // Keeps every block 8-byte aligned
+    alignas(8) uint8_t _storage[Blocks][Stride];
+    uint8_t _freeListStorage[Blocks];
+};
+
+/**
+ * Scoped block: acquired on construction, released on destruction
+ */
+class PoolBlock {
+  public:
+    explicit PoolBlock(StaticPoolBase& pool) : _pool(pool), _data(pool.acquire()) {}
+    ~PoolBlock() {
+      if (_data != nullptr) {
+        _pool.release(_data);
+      }
+    }
+    PoolBlock(const PoolBlock&) = delete;
+    PoolBlock& operator=(const PoolBlock&) = delete;
+
+    explicit operator bool() const { return _data != nullptr; }
+    uint8_t* bytes() const { return (uint8_t*)_data; }
+    char* chars() const { return (char*)_data; }
+    template <typename T> T* as() const { return (T*)_data; }
+    size_t size() const { return _pool.blockSize(); }
+
+  private:
+    StaticPoolBase& _pool;
+    void* _data;
+};
+
+#endif
@@ -0,0 +1,128 @@
+/*
+  Filename: pool_check.cpp
+  StaticPool checks (Linux host)
+
+  Description: Checks block alignment and separation, exhaustion and failure
+               counting, peak tracking, rejection of foreign pointers and
+               double releases, scoped PoolBlock release and the pool
+               registry order, then hammers one pool from several threads.
+               Exits non-zero if any check fails.
+
+  Build/run (from this folder):
+    g++ -O2 -std=c++17 -I../.. pool_check.cpp -o pool_check -pthread
+    ./pool_check
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "StaticPool.h"
+
+static StaticPool<13, 4> g_small("small");
+static StaticPool<257, 3> g_packet("packet");
+static StaticPool<1024, 1> g_single("single");
+
+static int g_failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+      g_failures++; \
+      printf("FAIL line %d: %s\n", __LINE__, #cond); \
+    } \
+  } while (0)
+
+static void checkBlocks() {
+  void* blocks[4];
+  std::set<uintptr_t> seen;
+  for (int i = 0; i < 4; i++) {
+    blocks[i] = g_small.acquire();
+    CHECK(blocks[i] != nullptr);
+    CHECK(((uintptr_t)blocks[i] & 7) == 0);
+    seen.insert((uintptr_t)blocks[i]);
+    memset(blocks[i], 0xA0 + i, 13);
+  }
+  CHECK(seen.size() == 4);
+  for (int i = 0; i < 4; i++) {
+    // Writing one block must not touch its neighbours
+    for (int b = 0; b < 13; b++) CHECK(((uint8_t*)blocks[i])[b] == 0xA0 + i);
+  }
+
+  CHECK(g_small.acquire() == nullptr);
+  CHECK(g_small.stats().failures == 1);
+  CHECK(g_small.stats().inUse == 4);
+  CHECK(g_small.stats().peak == 4);
+
+  int local = 0;
+  CHECK(!g_small.release(&local));
+  CHECK(!g_small.release((uint8_t*)blocks[1] + 1));
+  for (int i = 0; i < 4; i++) CHECK(g_small.release(blocks[i]));
+  CHECK(!g_small.release(blocks[3]));              // pool already full: double release rejected
+  CHECK(g_small.stats().inUse == 0);
+  CHECK(g_small.stats().peak == 4);
+}
+
+static void checkScoped() {
+  {
+    PoolBlock a(g_single);
+    CHECK((bool)a);
+    CHECK(a.size() >= 1024);
+    PoolBlock b(g_single);
+    CHECK(!b);
+    CHECK(g_single.stats().inUse == 1);
+  }
+  CHECK(g_single.stats().inUse == 0);
+  CHECK(g_single.stats().failures == 1);
+
+  PoolBlock c(g_single);
+  CHECK((bool)c);
+}
+
+static void checkRegistry() {
+  const char* expected[] = {"small", "packet", "single"};
+  size_t i = 0;
+  for (StaticPoolBase* pool = StaticPoolBase::first(); pool != nullptr; pool = pool->next(), i++) {
+    CHECK(i < 3 && strcmp(pool->name(), expected[i]) == 0);
+  }
+  CHECK(i == 3);
+}
+
+static void checkThreads() {
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([t]() {
+      for (int i = 0; i < 100000; i++) {
+        PoolBlock block(g_packet);
+        if (block) {
+          block.bytes()[0] = (uint8_t)t;
+          block.bytes()[256] = (uint8_t)t;
+          if (block.bytes()[0] != (uint8_t)t || block.bytes()[256] != (uint8_t)t) {
+            g_failures++;
+          }
+        }
+      }
+    });
+  }
+  for (std::thread& th : threads) th.join();
+  PoolStats s = g_packet.stats();
+  CHECK(s.inUse == 0);
+  CHECK(s.peak <= 3);
+  printf("threads: peak=%u failed acquisitions=%lu\n", s.peak, (unsigned long)s.failures);
+}
+
+int main() {
+  checkBlocks();
+  checkScoped();
+  checkRegistry();
+  checkThreads();
+
+  for (StaticPoolBase* pool = StaticPoolBase::first(); pool != nullptr; pool = pool->next()) {
+    PoolStats s = pool->stats();
+    printf("  %-8s %5lu x %u used=%u peak=%u fail=%lu\n", s.name, (unsigned long)s.blockSize,
+           s.blocks, s.inUse, s.peak, (unsigned long)s.failures);
+  }
+  printf("checks: %s (%d failure%s)\n", g_failures ? "FAIL" : "ok", g_failures, g_failures == 1 ? "" : "s");
+  return g_failures ? 1 : 0;
+}
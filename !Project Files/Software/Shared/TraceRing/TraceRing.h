@@ -0,0 +1,181 @@
+/*
+  Filename: TraceRing.h
+  Execution Trace Ring (header-only, no Arduino dependency)
+
+  Description: Begin/end/instant events with a microsecond timestamp, a
+               trace point ID, a task ID and one 32-bit argument, 12 bytes
+               each, kept in a fixed RAM ring so the last few seconds of
+               "what was every task doing" survive until someone asks. A
+               record is one atomic slot claim and a 12-byte store, so trace
+               points can sit in the capture loop; when the ring is full the
+               oldest events are overwritten.
+
+               The caller supplies the timestamp and task ID, so the ring
+               knows nothing about clocks or schedulers. IDs are small
+               integers the firmware names in the dump header; the host
+               converter (examples/trace_convert) turns a serial capture
+               into Chrome trace JSON for Perfetto or chrome://tracing.
+
+               A dump is a block of text lines:
+                 #TR:BEGIN events=<n> dropped=<n>
+                 #TR:NAME <id> <name>          one per trace point
+                 #TR:TASK <id> <name>          one per task
+                 #TR:<24 hex digits>           one per event, oldest first
+                 #TR:END
+
+               Stop recording (setEnabled(false)) before reading the ring;
+               a writer that claimed a slot just before that finishes its
+               store within a few instructions.
+
+  Usage:
+    TraceRing<1024> g_trace;
+
+    g_trace.record(micros(), TRACE_SD_WRITE, TRACE_PHASE_BEGIN, taskId, 0);
+    ...
+    g_trace.setEnabled(false);
+    for (size_t i = 0; i < g_trace.count(); i++) {
+      traceFrameEvent(g_trace.at(i), line, sizeof(line));
+    }
+*/
+
+#ifndef TRACE_RING_H
+#define TRACE_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define TRACE_FRAME_BYTES  12
+#define TRACE_FRAME_CHARS  (4 + 2 * TRACE_FRAME_BYTES + 1)   // "#TR:" + hex + terminator
+
+enum TracePhase : uint8_t {
+  TRACE_PHASE_BEGIN = 'B',
+  TRACE_PHASE_END = 'E',
+  TRACE_PHASE_INSTANT = 'i'
+};
+
+struct TraceEvent {
+  uint32_t timestampUs;   // Wraps after 71 minutes; the converter unwraps
+  uint16_t id;            // Trace point
+  uint8_t phase;          // TracePhase
+  uint8_t task;
+  uint32_t arg;           // Bytes, a length, a result: whatever the point records
+};
+
+static_assert(sizeof(TraceEvent) == TRACE_FRAME_BYTES, "TraceEvent must pack to 12 bytes");
+
+template <size_t Capacity>
+class TraceRing {
+  static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+  public:
+    TraceRing() : _head(0), _enabled(true) {}
+
+    void record(uint32_t timestampUs, uint16_t id, uint8_t phase, uint8_t task, uint32_t arg) {
+      if (!__atomic_load_n(&_enabled, __ATOMIC_RELAXED)) {
+        return;
+      }
+      uint32_t slot = __atomic_fetch_add(&_head, 1, __ATOMIC_RELAXED);
+      TraceEvent& e = _events[slot & (Capacity - 1)];
+      e.timestampUs = timestampUs;
+      e.id = id;
+      e.phase = phase;
+      e.task = task;
+      e.arg = arg;
+    }
+
+    void setEnabled(bool enabled) { __atomic_store_n(&_enabled, enabled, __ATOMIC_RELEASE); }
+    bool enabled() const { return __atomic_load_n(&_enabled, __ATOMIC_RELAXED); }
+
+    /**
+     * Events recorded since the last clear(), including overwritten ones
+     */
+    uint32_t recorded() const { return __atomic_load_n(&_head, __ATOMIC_ACQUIRE); }
+
+    /**
+     * Events still in the ring
+     */
+    size_t count() const {
+      uint32_t head = recorded();
+      return (head < Capacity) ? head : Capacity;
+    }
+
+    /**
+     * Events overwritten before they were read
+     */
+    uint32_t dropped() const { return recorded() - (uint32_t)count(); }
+
+    /**
+     * i-th event still in the ring, oldest first
+     */
+    const TraceEvent& at(size_t i) const {
+      uint32_t head = recorded();
+      uint32_t first = head - (uint32_t)count();
+      return _events[(first + i) & (Capacity - 1)];
+    }
+
+    void clear() { __atomic_store_n(&_head, 0, __ATOMIC_RELEASE); }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+  private:
+    TraceEvent _events[Capacity];
+    uint32_t _head;
+    bool _enabled;
+};
+
+/**
+ * Write one event as a "#TR:" hex frame (little-endian fields in struct order)
+ * @return characters written, 0 if out is too small
+ */
+inline size_t traceFrameEvent(const TraceEvent& event, char* out, size_t outSize) {
+  if (outSize < TRACE_FRAME_CHARS) {
+    return 0;
+  }
+  uint8_t raw[TRACE_FRAME_BYTES];
+  memcpy(raw, &event.timestampUs, 4);
+  memcpy(raw + 4, &event.id, 2);
+  raw[6] = event.phase;
+  raw[7] = event.task;
+  memcpy(raw + 8, &event.arg, 4);
+
+  static const char hex[] = "0123456789ABCDEF";
+  memcpy(out, "#TR:", 4);
+  size_t n = 4;
+  for (size_t i = 0; i < TRACE_FRAME_BYTES; i++) {
+    out[n++] = hex[raw[i] >> 4];
+    out[n++] = hex[raw[i] & 0x0F];
+  }
+  out[n] = '\0';
+  return n;
+}
+
+/**
+ * Parse the 24 hex digits after "#TR:"
+ * @return false if the text is not an event frame
+ */
+inline bool traceParseFrame(const char* hexText, TraceEvent& event) {
+  uint8_t raw[TRACE_FRAME_BYTES];
+  for (size_t i = 0; i < TRACE_FRAME_BYTES; i++) {
+    int value = 0;
+    for (size_t k = 0; k < 2; k++) {
+      char c = hexText[2 * i + k];
+      int digit = (c >= '0' && c <= '9') ? c - '0'
+                : (c >= 'A' && c <= 'F') ? c - 'A' + 10
+                : (c >= 'a' && c <= 'f') ? c - 'a' + 10 : -1;
+      if (digit < 0) {
+        return false;
+      }
+      value = (value << 4) | digit;
+    }
+    raw[i] = (uint8_t)value;
+  }
+  memcpy(&event.timestampUs, raw, 4);
+  memcpy(&event.id, raw + 4, 2);
+  event.phase = raw[6];
+  event.task = raw[7];
+  memcpy(&event.arg, raw + 8, 4);
+  return event.phase == TRACE_PHASE_BEGIN || event.phase == TRACE_PHASE_END || event.phase == TRACE_PHASE_INSTANT;
+}
+
+#endif
@@ -0,0 +1,154 @@
+/*
+  Filename: trace_check.cpp
+  TraceRing checks (Linux host)
+
+  Description: Checks that the ring keeps the newest Capacity events oldest
+               first once it wraps, with the overwritten ones counted as
+               dropped; that disable and clear behave as the dump relies on;
+               that "#TR:" frames are byte-exact little-endian hex and parse
+               back (with traceParseFrame, as trace_convert does) to the
+               same events, rejecting bad hex and unknown phases; and that
+               concurrent writers lose no slot claims.
+               Exits non-zero if any check fails.
+
+  Build/run (from this folder):
+    g++ -O2 -std=c++17 -I../.. trace_check.cpp -o trace_check -pthread
+    ./trace_check
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "TraceRing.h"
+
+static int g_failures = 0;
+
+static void expect(bool ok, const char* what) {
+  if (!ok) {
+    g_failures++;
+    printf("FAIL: %s\n", what);
+  }
+}
+
+static bool sameEvent(const TraceEvent& a, const TraceEvent& b) {
+  return a.timestampUs == b.timestampUs && a.id == b.id && a.phase == b.phase && a.task == b.task && a.arg == b.arg;
+}
+
+static void checkWraparound() {
+  TraceRing<8> ring;
+  for (uint32_t i = 0; i < 5; i++) {
+    ring.record(1000 + i, (uint16_t)i, TRACE_PHASE_INSTANT, 1, i * 10);
+  }
+  expect(ring.count() == 5 && ring.dropped() == 0, "partly filled ring keeps everything");
+  expect(ring.at(0).id == 0 && ring.at(4).id == 4, "partly filled ring reads oldest first");
+
+  for (uint32_t i = 5; i < 13; i++) {
+    ring.record(1000 + i, (uint16_t)i, TRACE_PHASE_INSTANT, 1, i * 10);
+  }
+  expect(ring.recorded() == 13, "recorded counts overwritten events");
+  expect(ring.count() == 8 && ring.dropped() == 5, "wrapped ring holds capacity, rest dropped");
+  bool ordered = true;
+  for (size_t i = 0; i < ring.count(); i++) {
+    const TraceEvent& e = ring.at(i);
+    ordered = ordered && e.id == 5 + i && e.timestampUs == 1005 + i && e.arg == (5 + i) * 10;
+  }
+  expect(ordered, "wrapped ring keeps the newest events, oldest first");
+
+  ring.setEnabled(false);
+  ring.record(9999, 99, TRACE_PHASE_INSTANT, 1, 0);
+  expect(ring.recorded() == 13 && ring.at(7).id == 12, "disabled ring ignores records");
+  ring.clear();
+  ring.setEnabled(true);
+  expect(ring.count() == 0 && ring.dropped() == 0, "clear empties the ring");
+  ring.record(5, 7, TRACE_PHASE_BEGIN, 2, 0);
+  expect(ring.count() == 1 && ring.at(0).id == 7, "ring records again after clear");
+}
+
+static void checkFrames() {
+  TraceEvent event = {0x12345678u, 0x0102, TRACE_PHASE_BEGIN, 3, 0xA0B0C0D0u};
+  char line[TRACE_FRAME_CHARS];
+  size_t n = traceFrameEvent(event, line, sizeof(line));
+  expect(n == TRACE_FRAME_CHARS - 1 && strlen(line) == n, "frame length");
+  expect(strcmp(line, "#TR:7856341202014203D0C0B0A0") == 0, "frame is little-endian hex in struct order");
+  expect(traceFrameEvent(event, line, sizeof(line) - 1) == 0, "short buffer writes nothing");
+
+  // Every phase, with the timestamp just before the 32-bit rollover
+  const uint8_t phases[] = {TRACE_PHASE_BEGIN, TRACE_PHASE_END, TRACE_PHASE_INSTANT};
+  for (uint8_t phase : phases) {
+    TraceEvent in = {0xFFFFFFF0u, 0xBEEF, phase, 255, 0xFFFFFFFFu};
+    TraceEvent out = {};
+    traceFrameEvent(in, line, sizeof(line));
+    expect(traceParseFrame(line + 4, out) && sameEvent(in, out), "frame round-trips");
+  }
+
+  TraceEvent out = {};
+  expect(traceParseFrame("7856341202014203d0c0b0a0", out) && out.arg == 0xA0B0C0D0u, "lower-case hex parses");
+  expect(!traceParseFrame("7856341202014203D0C0B0AZ", out), "bad hex digit rejected");
+  expect(!traceParseFrame("78563412020142", out), "truncated frame rejected");
+  expect(!traceParseFrame("7856341202015803D0C0B0A0", out), "unknown phase rejected");
+}
+
+static void checkDump() {
+  // What the receiver prints for a wrapped ring, and what trace_convert reads back
+  TraceRing<16> ring;
+  for (uint32_t i = 0; i < 40; i++) {
+    uint8_t phase = (i % 3 == 0) ? TRACE_PHASE_BEGIN : (i % 3 == 1) ? TRACE_PHASE_END : TRACE_PHASE_INSTANT;
+    ring.record(0xFFFFFF00u + i * 8, (uint16_t)(i % 5), phase, (uint8_t)(i % 4), i);
+  }
+  ring.setEnabled(false);
+  std::vector<std::string> dump;
+  char line[TRACE_FRAME_CHARS];
+  for (size_t i = 0; i < ring.count(); i++) {
+    traceFrameEvent(ring.at(i), line, sizeof(line));
+    dump.push_back(line);
+  }
+
+  bool intact = dump.size() == 16;
+  uint32_t expectedArg = 40 - 16;
+  for (const std::string& text : dump) {
+    TraceEvent e = {};
+    intact = intact && text.compare(0, 4, "#TR:") == 0 && text.size() == 4 + 2 * TRACE_FRAME_BYTES &&
+             traceParseFrame(text.c_str() + 4, e) && e.arg == expectedArg &&
+             e.timestampUs == 0xFFFFFF00u + expectedArg * 8;
+    expectedArg++;
+  }
+  expect(intact, "dump of a wrapped ring parses back oldest first, across the timestamp rollover");
+}
+
+static void checkThreads() {
+  const int threads = 4;
+  const uint32_t perThread = 5000;
+  static TraceRing<1024> ring;
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; t++) {
+    workers.emplace_back([t]() {
+      for (uint32_t i = 0; i < perThread; i++) {
+        ring.record(i, (uint16_t)t, TRACE_PHASE_INSTANT, (uint8_t)t, i);
+      }
+    });
+  }
+  for (std::thread& w : workers) {
+    w.join();
+  }
+  expect(ring.recorded() == threads * perThread, "no slot claim lost between writers");
+  expect(ring.count() == 1024 && ring.dropped() == threads * perThread - 1024, "concurrent wrap counts");
+  bool valid = true;
+  for (size_t i = 0; i < ring.count(); i++) {
+    const TraceEvent& e = ring.at(i);
+    valid = valid && e.phase == TRACE_PHASE_INSTANT && e.task < threads && e.id < threads && e.arg < perThread;
+  }
+  expect(valid, "every kept slot holds a written event");
+}
+
+int main() {
+  checkWraparound();
+  checkFrames();
+  checkDump();
+  checkThreads();
+
+  printf("checks: %s (%d failure%s)\n", g_failures ? "FAIL" : "ok", g_failures, g_failures == 1 ? "" : "s");
+  return g_failures ? 1 : 0;
+}
@@ -0,0 +1,182 @@
+/*
+  Filename: trace_convert.cpp
+  TraceRing dump to Chrome trace JSON (Linux host)
+
+  Description: Reads a serial capture containing one or more "#TR:" dumps
+               (see TraceRing.h) and writes the Chrome trace event format,
+               which ui.perfetto.dev and chrome://tracing open directly.
+               Each firmware task becomes a thread named after it; each
+               trace point becomes a slice (begin/end) or an instant, with
+               its argument under "arg". Other lines are ignored, so a
+               whole monitor session can be fed in.
+
+               Timestamps are unwrapped across the 32-bit microsecond
+               rollover and across consecutive dumps. An end whose begin
+               was overwritten in the ring is dropped; a begin still open
+               at the end of the capture is closed at the last timestamp.
+
+  Build/run (from this folder):
+    g++ -O2 -std=c++17 -I../.. trace_convert.cpp -o trace_convert
+    ./trace_convert < capture.txt > trace.json
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "TraceRing.h"
+
+struct OpenSlice {
+  uint16_t id;
+  uint64_t ts;
+};
+
+static std::map<uint16_t, std::string> g_names;
+static std::map<uint8_t, std::string> g_tasks;
+static std::map<uint8_t, std::vector<OpenSlice>> g_open;
+static bool g_firstEvent = true;
+
+static std::string jsonEscape(const std::string& text) {
+  std::string out;
+  for (char c : text) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += c;
+    } else if ((unsigned char)c >= 0x20) {
+      out += c;
+    }
+  }
+  return out;
+}
+
+static std::string nameOf(uint16_t id) {
+  auto it = g_names.find(id);
+  if (it != g_names.end()) {
+    return it->second;
+  }
+  char fallback[16];
+  snprintf(fallback, sizeof(fallback), "trace_%u", (unsigned)id);
+  return fallback;
+}
+
+static void emit(const char* phase, uint16_t id, uint8_t task, uint64_t ts, const uint32_t* arg) {
+  printf("%s\n    {\"name\":\"%s\",\"ph\":\"%s\",\"ts\":%llu,\"pid\":1,\"tid\":%u",
+         g_firstEvent ? "" : ",", jsonEscape(nameOf(id)).c_str(), phase, (unsigned long long)ts, (unsigned)task);
+  if (phase[0] == 'i') {
+    printf(",\"s\":\"t\"");
+  }
+  if (arg != nullptr) {
+    printf(",\"args\":{\"arg\":%lu}", (unsigned long)*arg);
+  }
+  printf("}");
+  g_firstEvent = false;
+}
+
+static void emitMetadata(const char* kind, uint8_t task, const std::string& name) {
+  printf("%s\n    {\"name\":\"%s\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+         g_firstEvent ? "" : ",", kind, (unsigned)task, jsonEscape(name).c_str());
+  g_firstEvent = false;
+}
+
+int main() {
+  uint64_t epoch = 0;          // Added to the raw 32-bit timestamps
+  uint32_t lastRaw = 0;
+  uint64_t lastTs = 0;
+  bool haveLast = false;
+  unsigned long events = 0;
+  unsigned long orphanEnds = 0;
+  unsigned long dumps = 0;
+  unsigned long dropped = 0;
+
+  printf("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+  emitMetadata("process_name", 0, "receiver");
+
+  char line[512];
+  while (fgets(line, sizeof(line), stdin) != nullptr) {
+    const char* tag = strstr(line, "#TR:");
+    if (tag == nullptr) {
+      continue;
+    }
+    const char* body = tag + 4;
+    line[strcspn(line, "\r\n")] = '\0';
+
+    if (strncmp(body, "BEGIN", 5) == 0) {
+      dumps++;
+      const char* d = strstr(body, "dropped=");
+      if (d != nullptr) {
+        dropped += strtoul(d + 8, nullptr, 10);
+      }
+      continue;
+    }
+    if (strncmp(body, "END", 3) == 0) {
+      continue;
+    }
+    if (strncmp(body, "NAME ", 5) == 0 || strncmp(body, "TASK ", 5) == 0) {
+      char* rest = nullptr;
+      unsigned long id = strtoul(body + 5, &rest, 10);
+      while (rest != nullptr && *rest == ' ') {
+        rest++;
+      }
+      std::string name = (rest != nullptr) ? rest : "";
+      if (body[0] == 'N') {
+        g_names[(uint16_t)id] = name;
+      } else if (g_tasks[(uint8_t)id] != name) {
+        g_tasks[(uint8_t)id] = name;
+        emitMetadata("thread_name", (uint8_t)id, name);
+      }
+      continue;
+    }
+
+    TraceEvent event;
+    if (strlen(body) < 2 * TRACE_FRAME_BYTES || !traceParseFrame(body, event)) {
+      continue;
+    }
+    // Events from different tasks can land a few µs out of order; only a
+    // jump back of more than half the range is a rollover
+    if (haveLast && event.timestampUs < lastRaw && lastRaw - event.timestampUs > 0x80000000u) {
+      epoch += 0x100000000ull;
+    } else if (haveLast && event.timestampUs > lastRaw && event.timestampUs - lastRaw > 0x80000000u &&
+               epoch >= 0x100000000ull) {
+      epoch -= 0x100000000ull;
+    }
+    lastRaw = event.timestampUs;
+    haveLast = true;
+    uint64_t ts = epoch + event.timestampUs;
+    if (ts > lastTs) {
+      lastTs = ts;
+    }
+    events++;
+
+    std::vector<OpenSlice>& open = g_open[event.task];
+    if (event.phase == TRACE_PHASE_BEGIN) {
+      open.push_back({event.id, ts});
+      emit("B", event.id, event.task, ts, nullptr);
+    } else if (event.phase == TRACE_PHASE_END) {
+      if (open.empty() || open.back().id != event.id) {
+        orphanEnds++;
+        continue;
+      }
+      open.pop_back();
+      emit("E", event.id, event.task, ts, &event.arg);
+    } else {
+      emit("i", event.id, event.task, ts, &event.arg);
+    }
+  }
+
+  unsigned long unclosed = 0;
+  for (auto& entry : g_open) {
+    while (!entry.second.empty()) {
+      emit("E", entry.second.back().id, entry.first, lastTs, nullptr);
+      entry.second.pop_back();
+      unclosed++;
+    }
+  }
+  printf("\n]}\n");
+
+  fprintf(stderr, "%lu dump(s), %lu events, %lu overwritten on device, %lu orphan end(s), %lu slice(s) left open\n",
+          dumps, events, dropped, orphanEnds, unclosed);
+  return (events > 0) ? 0 : 1;
+}
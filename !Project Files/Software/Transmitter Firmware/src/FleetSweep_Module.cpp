@@ -0,0 +1,473 @@
+/*
+  Filename: FleetSweep_Module.cpp
+  Fleet Sweep Job Queue Module Implementation
+
+  Description: Discovers receivers, orders them by backlog and offloads
+               each one over the fastest link it can currently sustain.
+*/
+
+#include "FleetSweep_Module.h"
+
+FleetSweep_Module::FleetSweep_Module()
+  : _send(nullptr),
+    _startOffload(nullptr),
+    _releaseLink(nullptr),
+    _out(&Serial),
+    _state(SWEEP_IDLE),
+    _order(ORDER_BYTES),
+    _stopRequested(false),
+    _siteWifiAvailable(false),
+    _softApAvailable(false),
+    _unitCount(0),
+    _discoveryRound(0),
+    _discoveryStartMs(0),
+    _current(-1),
+    _currentPath(SWEEP_PATH_LORA),
+    _fellBack(false),
+    _jobStartMs(0),
+    _lastActivityMs(0),
+    _lastProgressMs(0),
+    _jobBytes(0),
+    _sweepStartMs(0),
+    _sweepBytes(0) {}
+
+void FleetSweep_Module::begin(SweepSendFn send, SweepOffloadFn startOffload, SweepReleaseFn releaseLink, Print& out) {
+  _send = send;
+  _startOffload = startOffload;
+  _releaseLink = releaseLink;
+  _out = &out;
+}
+
+int FleetSweep_Module::pathIndex(char path) {
+  switch (path) {
+    case SWEEP_PATH_WIFI:   return 0;
+    case SWEEP_PATH_SOFTAP: return 1;
+    default:                return 2;
+  }
+}
+
+bool FleetSweep_Module::handleHostCommand(const String& line) {
+  if (!line.startsWith("SWEEP")) {
+    return false;
+  }
+
+  if (line == "SWEEP" || line == "SWEEP:BYTES") {
+    startSweep(ORDER_BYTES);
+  } else if (line == "SWEEP:AGE") {
+    startSweep(ORDER_AGE);
+  } else if (line == "SWEEP:STOP") {
+    if (_state == SWEEP_RUNNING) {
+      _stopRequested = true;
+      _out->println("[SWEEP] Stopping after the current job");
+    } else if (_state != SWEEP_IDLE) {
+      finishSweep();
+    }
+  } else if (line == "SWEEP:STAT") {
+    printStatus();
+  } else {
+    _out->println("[SWEEP] Unknown command (SWEEP, SWEEP:BYTES, SWEEP:AGE, SWEEP:STOP, SWEEP:STAT)");
+  }
+  return true;
+}
+
+void FleetSweep_Module::startSweep(SweepOrder order) {
+  if (_state != SWEEP_IDLE) {
+    _out->println("[SWEEP] Sweep already running (SWEEP:STOP to abandon)");
+    return;
+  }
+  if (_send == nullptr || _startOffload == nullptr) {
+    _out->println("[SWEEP] Not initialised");
+    return;
+  }
+
+  // Keep link history from earlier sweeps; only the backlog is re-queried.
+  for (uint8_t i = 0; i < _unitCount; i++) {
+    _units[i].state = UNIT_DONE;
+    _units[i].attempts = 0;
+    _units[i].retryAtMs = 0;
+  }
+
+  _order = order;
+  _stopRequested = false;
+  _sweepStartMs = millis();
+  _sweepBytes = 0;
+  _discoveryRound = 0;
+  _out->printf("[SWEEP] Start order=%s\n", order == ORDER_AGE ? "age" : "bytes");
+  startDiscoveryRound();
+}
+
+void FleetSweep_Module::startDiscoveryRound() {
+  _discoveryRound++;
+  _discoveryStartMs = millis();
+  _state = SWEEP_DISCOVER;
+  _send("CMD:q");
+}
+
+int FleetSweep_Module::findUnit(const char* id) const {
+  for (uint8_t i = 0; i < _unitCount; i++) {
+    if (strcmp(_units[i].id, id) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+void FleetSweep_Module::recordQueueSummary(const char* payload, float rssi, float snr) {
+  // payload: <id>,<events>,<bytes>,<age s>; parsed from the right so the id may hold anything
+  char buffer[64];
+  snprintf(buffer, sizeof(buffer), "%s", payload);
+
+  char* fields[3];
+  for (int i = 2; i >= 0; i--) {
+    char* comma = strrchr(buffer, ',');
+    if (comma == nullptr) {
+      _out->printf("[SWEEP] Malformed queue summary: %s\n", payload);
+      return;
+    }
+    *comma = '\0';
+    fields[i] = comma + 1;
+  }
+  // Stored ids are truncated to the table's size; look up the same truncation
+  if (strlen(buffer) >= SWEEP_UNIT_ID_SIZE) {
+    buffer[SWEEP_UNIT_ID_SIZE - 1] = '\0';
+  }
+
+  int index = findUnit(buffer);
+  if (index < 0) {
+    if (_unitCount >= SWEEP_MAX_UNITS) {
+      _out->printf("[SWEEP] Unit table full, ignoring %s\n", buffer);
+      return;
+    }
+    index = _unitCount++;
+    SweepUnit& fresh = _units[index];
+    memset(&fresh, 0, sizeof(fresh));
+    snprintf(fresh.id, sizeof(fresh.id), "%s", buffer);
+  }
+
+  SweepUnit& unit = _units[index];
+  unit.events = strtoul(fields[0], nullptr, 10);
+  unit.bytes = strtoul(fields[1], nullptr, 10);
+  unit.ageSec = strtoul(fields[2], nullptr, 10);
+  unit.rssi = rssi;
+  unit.snr = snr;
+  if (_state == SWEEP_DISCOVER) {
+    unit.state = (unit.bytes > 0) ? UNIT_PENDING : UNIT_DONE;
+  }
+
+  _out->printf("[SWEEP_UNIT] id=%s events=%lu bytes=%lu age_s=%lu rssi=%.1f snr=%.1f\n",
+               unit.id,
+               (unsigned long)unit.events,
+               (unsigned long)unit.bytes,
+               (unsigned long)unit.ageSec,
+               rssi,
+               snr);
+}
+
+bool FleetSweep_Module::onLoRaPacket(const char* packet, float rssi, float snr) {
+  if (_state == SWEEP_RUNNING && _current >= 0) {
+    // Only the addressed unit talks during a job, so any packet is a sign of life
+    _lastActivityMs = millis();
+    _units[_current].rssi = rssi;
+    _units[_current].snr = snr;
+  }
+
+  if (strncmp(packet, "RSP:Q:", 6) == 0) {
+    recordQueueSummary(packet + 6, rssi, snr);
+    return true;
+  }
+  return false;
+}
+
+void FleetSweep_Module::onTransferData(size_t bytes) {
+  if (_state != SWEEP_RUNNING) {
+    return;
+  }
+
+  unsigned long now = millis();
+  _jobBytes += bytes;
+  _lastActivityMs = now;
+
+  if ((now - _lastProgressMs) >= SWEEP_PROGRESS_INTERVAL_MS) {
+    _lastProgressMs = now;
+    unsigned long elapsedMs = now - _jobStartMs;
+    float rate = (elapsedMs > 0) ? (_jobBytes * 1000.0f / elapsedMs) : 0.0f;
+    _out->printf("[SWEEP_PROGRESS] id=%s bytes=%u elapsed_ms=%lu rate=%.1f B/s\n",
+                 _units[_current].id, (unsigned int)_jobBytes, elapsedMs, rate);
+  }
+}
+
+void FleetSweep_Module::onTransferEnd(size_t bytes, unsigned long elapsedMs) {
+  if (_state != SWEEP_RUNNING || _current < 0) {
+    return;
+  }
+
+  SweepUnit& unit = _units[_current];
+  int idx = pathIndex(_currentPath);
+  if (bytes > 0 && elapsedMs > 0) {
+    float rate = bytes * 1000.0f / elapsedMs;
+    unit.rate[idx] = (unit.rate[idx] > 0.0f)
+                       ? (SWEEP_RATE_EWMA_WEIGHT * rate + (1.0f - SWEEP_RATE_EWMA_WEIGHT) * unit.rate[idx])
+                       : rate;
+  }
+  if (!_fellBack) {
+    unit.failures[idx] = 0;
+  }
+
+  unsigned long jobMs = millis() - _jobStartMs;
+  float jobRate = (jobMs > 0) ? (bytes * 1000.0f / jobMs) : 0.0f;
+  _out->printf("[SWEEP_DONE] id=%s path=%c bytes=%u duration=%lums rate=%.1f B/s\n",
+               unit.id, _currentPath, (unsigned int)bytes, jobMs, jobRate);
+
+  _sweepBytes += bytes;
+  unit.state = UNIT_DONE;
+  unit.bytes = 0;
+  unit.events = 0;
+  _current = -1;
+  if (_releaseLink != nullptr) {
+    _releaseLink();
+  }
+  _state = SWEEP_SELECT;
+}
+
+void FleetSweep_Module::onTransferFailed(const char* reason) {
+  if (_state != SWEEP_RUNNING || _current < 0) {
+    return;
+  }
+  failJob(reason);
+}
+
+void FleetSweep_Module::onPathFallback(const char* reason) {
+  if (_state != SWEEP_RUNNING || _current < 0 || _currentPath == SWEEP_PATH_LORA) {
+    return;
+  }
+
+  SweepUnit& unit = _units[_current];
+  int idx = pathIndex(_currentPath);
+  if (unit.failures[idx] < 255) {
+    unit.failures[idx]++;
+  }
+  _out->printf("[SWEEP_FALLBACK] id=%s path=%c reason=%s -> L\n", unit.id, _currentPath, reason);
+
+  // The receiver streams the same job over LoRa; account the rest of it there
+  _currentPath = SWEEP_PATH_LORA;
+  _fellBack = true;
+  _lastActivityMs = millis();
+}
+
+float FleetSweep_Module::expectedSeconds(const SweepUnit& unit, char path) const {
+  int idx = pathIndex(path);
+  float rate;
+  float setup;
+  if (path == SWEEP_PATH_LORA) {
+    rate = SWEEP_DEFAULT_RATE_LORA;
+    setup = SWEEP_SETUP_S_LORA;
+  } else {
+    rate = SWEEP_DEFAULT_RATE_WIFI;
+    setup = (path == SWEEP_PATH_SOFTAP) ? SWEEP_SETUP_S_SOFTAP : SWEEP_SETUP_S_WIFI;
+  }
+  if (unit.rate[idx] > 0.0f) {
+    rate = unit.rate[idx];
+  }
+
+  // A failed WiFi attempt costs its setup time and then the LoRa transfer anyway
+  float seconds = setup + unit.bytes / rate;
+  return seconds * (1.0f + unit.failures[idx]);
+}
+
+char FleetSweep_Module::choosePath(const SweepUnit& unit, float& expectedSec) const {
+  char best = SWEEP_PATH_LORA;
+  expectedSec = expectedSeconds(unit, SWEEP_PATH_LORA);
+
+  if (_siteWifiAvailable) {
+    float t = expectedSeconds(unit, SWEEP_PATH_WIFI);
+    if (t < expectedSec) {
+      best = SWEEP_PATH_WIFI;
+      expectedSec = t;
+    }
+  }
+
+  if (_softApAvailable && unit.rssi >= SWEEP_SOFTAP_MIN_RSSI) {
+    float t = expectedSeconds(unit, SWEEP_PATH_SOFTAP);
+    if (t < expectedSec) {
+      best = SWEEP_PATH_SOFTAP;
+      expectedSec = t;
+    }
+  }
+  return best;
+}
+
+void FleetSweep_Module::selectNextJob() {
+  if (_stopRequested) {
+    finishSweep();
+    return;
+  }
+
+  unsigned long now = millis();
+  int next = -1;
+  bool waiting = false;
+
+  for (uint8_t i = 0; i < _unitCount; i++) {
+    SweepUnit& unit = _units[i];
+    if (unit.state != UNIT_PENDING) {
+      continue;
+    }
+    if (unit.retryAtMs != 0 && (long)(now - unit.retryAtMs) < 0) {
+      waiting = true;
+      continue;
+    }
+    if (next < 0) {
+      next = i;
+      continue;
+    }
+
+    const SweepUnit& best = _units[next];
+    bool better = (_order == ORDER_AGE)
+                    ? (unit.ageSec > best.ageSec || (unit.ageSec == best.ageSec && unit.bytes > best.bytes))
+                    : (unit.bytes > best.bytes);
+    if (better) {
+      next = i;
+    }
+  }
+
+  if (next < 0) {
+    if (!waiting) {
+      finishSweep();
+    }
+    return;  // Only backoff timers left; poll() comes back here
+  }
+
+  SweepUnit& unit = _units[next];
+  if (strcmp(unit.id, "UNNAMED") == 0) {
+    // Without a truck ID the unit can't be addressed individually
+    _out->println("[SWEEP_FAIL] id=UNNAMED path=- reason=unaddressable retry_in_ms=0");
+    unit.state = UNIT_FAILED;
+    return;
+  }
+
+  float expectedSec;
+  _currentPath = choosePath(unit, expectedSec);
+  _current = next;
+  _fellBack = false;
+  _jobBytes = 0;
+  _jobStartMs = now;
+  _lastActivityMs = now;
+  _lastProgressMs = now;
+  unit.attempts++;
+
+  _out->printf("[SWEEP_JOB] id=%s path=%c attempt=%u expected_s=%.1f bytes=%lu\n",
+               unit.id, _currentPath, (unsigned int)unit.attempts, expectedSec, (unsigned long)unit.bytes);
+
+  _state = SWEEP_RUNNING;
+  if (!_startOffload(unit.id, _currentPath)) {
+    failJob("start_failed");
+  }
+}
+
+void FleetSweep_Module::failJob(const char* reason) {
+  SweepUnit& unit = _units[_current];
+  int idx = pathIndex(_currentPath);
+  if (unit.failures[idx] < 255) {
+    unit.failures[idx]++;
+  }
+
+  unsigned long retryIn = 0;
+  if (unit.attempts >= SWEEP_MAX_ATTEMPTS) {
+    unit.state = UNIT_FAILED;
+  } else {
+    retryIn = (unsigned long)SWEEP_RETRY_BASE_MS << (unit.attempts - 1);
+    unit.retryAtMs = millis() + retryIn;
+    if (unit.retryAtMs == 0) {
+      unit.retryAtMs = 1;
+    }
+  }
+
+  _out->printf("[SWEEP_FAIL] id=%s path=%c reason=%s retry_in_ms=%lu\n",
+               unit.id, _currentPath, reason, retryIn);
+
+  _current = -1;
+  if (_releaseLink != nullptr) {
+    _releaseLink();
+  }
+  _state = SWEEP_SELECT;
+}
+
+void FleetSweep_Module::finishSweep() {
+  uint8_t done = 0;
+  uint8_t failed = 0;
+  uint8_t pending = 0;
+  for (uint8_t i = 0; i < _unitCount; i++) {
+    if (_units[i].state == UNIT_DONE) done++;
+    else if (_units[i].state == UNIT_FAILED) failed++;
+    else pending++;
+  }
+
+  _out->printf("[SWEEP_SUMMARY] units=%u done=%u failed=%u skipped=%u bytes=%lu duration=%lums\n",
+               (unsigned int)_unitCount,
+               (unsigned int)done,
+               (unsigned int)failed,
+               (unsigned int)pending,
+               (unsigned long)_sweepBytes,
+               millis() - _sweepStartMs);
+
+  _current = -1;
+  _stopRequested = false;
+  _state = SWEEP_IDLE;
+}
+
+void FleetSweep_Module::poll() {
+  switch (_state) {
+    case SWEEP_IDLE:
+      break;
+
+    case SWEEP_DISCOVER:
+      if ((millis() - _discoveryStartMs) >= SWEEP_DISCOVERY_WINDOW_MS) {
+        if (_discoveryRound < SWEEP_DISCOVERY_ROUNDS && !_stopRequested) {
+          startDiscoveryRound();
+        } else {
+          _state = SWEEP_SELECT;
+        }
+      }
+      break;
+
+    case SWEEP_SELECT:
+      selectNextJob();
+      break;
+
+    case SWEEP_RUNNING:
+      if ((millis() - _lastActivityMs) >= SWEEP_IDLE_TIMEOUT_MS) {
+        failJob("timeout");
+      }
+      break;
+  }
+}
+
+void FleetSweep_Module::printStatus() {
+  static const char* stateNames[] = {"idle", "discover", "select", "running"};
+  _out->printf("[SWEEP_STAT] state=%s order=%s units=%u site_wifi=%d softap=%d bytes=%lu current=%s\n",
+               stateNames[_state],
+               _order == ORDER_AGE ? "age" : "bytes",
+               (unsigned int)_unitCount,
+               _siteWifiAvailable ? 1 : 0,
+               _softApAvailable ? 1 : 0,
+               (unsigned long)_sweepBytes,
+               _current >= 0 ? _units[_current].id : "-");
+
+  for (uint8_t i = 0; i < _unitCount; i++) {
+    const SweepUnit& unit = _units[i];
+    const char* state = (unit.state == UNIT_PENDING) ? "pending" : (unit.state == UNIT_DONE) ? "done" : "failed";
+    _out->printf("[SWEEP_STAT_UNIT] id=%s state=%s bytes=%lu age_s=%lu rssi=%.1f "
+                 "rate_w=%.0f rate_a=%.0f rate_l=%.0f fail_w=%u fail_a=%u fail_l=%u attempts=%u\n",
+                 unit.id,
+                 state,
+                 (unsigned long)unit.bytes,
+                 (unsigned long)unit.ageSec,
+                 unit.rssi,
+                 unit.rate[0],
+                 unit.rate[1],
+                 unit.rate[2],
+                 (unsigned int)unit.failures[0],
+                 (unsigned int)unit.failures[1],
+                 (unsigned int)unit.failures[2],
+                 (unsigned int)unit.attempts);
+  }
+}
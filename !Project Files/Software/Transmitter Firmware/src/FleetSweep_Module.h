@@ -0,0 +1,191 @@
+/*
+  Filename: FleetSweep_Module.h
+  Fleet Sweep Job Queue Module Header
+
+  Description: Unattended "offload the whole yard" job queue. A sweep
+               discovers receivers with a broadcast queue query (CMD:q),
+               then offloads each unit in turn, largest backlog (or oldest
+               data) first. For every job the link with the lowest expected
+               transfer time is chosen from site WiFi, the transmitter's own
+               SoftAP or LoRa, using per-unit throughput history, RSSI and
+               recent failures. Failed jobs are retried with exponential
+               backoff.
+
+  Host protocol (USB serial):
+    SWEEP / SWEEP:BYTES     sweep all units, largest pending bytes first
+    SWEEP:AGE               sweep all units, oldest pending data first
+    SWEEP:STOP              abandon the sweep after the current job
+    SWEEP:STAT              print per-unit sweep state
+
+  Reports:
+    [SWEEP_UNIT] id=.. events=.. bytes=.. age_s=.. rssi=.. snr=..
+    [SWEEP_JOB] id=.. path=W|A|L attempt=n expected_s=..
+    [SWEEP_PROGRESS] id=.. bytes=.. elapsed_ms=.. rate=.. B/s
+    [SWEEP_DONE] id=.. path=.. bytes=.. duration=..ms rate=.. B/s
+    [SWEEP_FAIL] id=.. path=.. reason=.. retry_in_ms=..
+    [SWEEP_SUMMARY] units=.. done=.. failed=.. bytes=.. duration=..ms
+*/
+
+#ifndef FLEETSWEEP_MODULE_H
+#define FLEETSWEEP_MODULE_H
+
+#include <Arduino.h>
+
+#define SWEEP_MAX_UNITS             16
+#define SWEEP_UNIT_ID_SIZE          24
+#define SWEEP_DISCOVERY_ROUNDS      2       // Repeat CMD:q to catch replies lost to collisions
+#define SWEEP_DISCOVERY_WINDOW_MS   4000    // Receivers jitter their reply by up to 1.5 s
+#define SWEEP_IDLE_TIMEOUT_MS       45000   // No packet from the unit for this long fails the job
+#define SWEEP_PROGRESS_INTERVAL_MS  2000
+#define SWEEP_MAX_ATTEMPTS          3
+#define SWEEP_RETRY_BASE_MS         5000    // Backoff doubles per failed attempt
+#define SWEEP_SOFTAP_MIN_RSSI       -80.0f  // Below this the unit is unlikely to hold a WiFi link
+
+// Starting estimates until a unit has history (bytes/s and fixed setup seconds)
+#define SWEEP_DEFAULT_RATE_LORA     150.0f
+#define SWEEP_DEFAULT_RATE_WIFI     8000.0f
+#define SWEEP_SETUP_S_LORA          2.0f
+#define SWEEP_SETUP_S_WIFI          15.0f
+#define SWEEP_SETUP_S_SOFTAP        10.0f
+#define SWEEP_RATE_EWMA_WEIGHT      0.5f
+
+// Offload paths (match the receiver's CMD:d#<path> codes)
+#define SWEEP_PATH_WIFI             'W'
+#define SWEEP_PATH_SOFTAP           'A'
+#define SWEEP_PATH_LORA             'L'
+
+typedef bool (*SweepSendFn)(const char* packet);
+typedef bool (*SweepOffloadFn)(const char* unitId, char path);
+typedef void (*SweepReleaseFn)();
+
+class FleetSweep_Module {
+  public:
+    FleetSweep_Module();
+
+    /**
+     * Attach radio/link hooks
+     * @param send Transmit a LoRa packet
+     * @param startOffload Prepare the link (e.g. SoftAP) and send CMD:d@<id>#<path>
+     * @param releaseLink Tear down anything startOffload brought up
+     * @param out Host output for sweep reports
+     */
+    void begin(SweepSendFn send, SweepOffloadFn startOffload, SweepReleaseFn releaseLink, Print& out);
+
+    /**
+     * Handle SWEEP* lines from the host
+     * @return true if the line was a sweep command
+     */
+    bool handleHostCommand(const String& line);
+
+    /**
+     * Feed every received LoRa packet (with link quality) to the sweep
+     * @return true if the packet was consumed (queue summaries during discovery)
+     */
+    bool onLoRaPacket(const char* packet, float rssi, float snr);
+
+    /**
+     * Payload bytes arrived for the current job
+     */
+    void onTransferData(size_t bytes);
+
+    /**
+     * END:D reached for the current job
+     */
+    void onTransferEnd(size_t bytes, unsigned long elapsedMs);
+
+    /**
+     * The current job's stream ended without END:D; fail it now rather than at the idle timeout
+     */
+    void onTransferFailed(const char* reason);
+
+    /**
+     * The chosen WiFi/SoftAP path failed; the receiver falls back to LoRa
+     */
+    void onPathFallback(const char* reason);
+
+    /**
+     * Advance discovery, job selection, timeouts and backoff; call every loop() pass
+     */
+    void poll();
+
+    void printStatus();
+
+    bool isActive() const { return _state != SWEEP_IDLE; }
+    void setSiteWifiAvailable(bool available) { _siteWifiAvailable = available; }
+    void setSoftApAvailable(bool available) { _softApAvailable = available; }
+
+  private:
+    enum SweepState {
+      SWEEP_IDLE,
+      SWEEP_DISCOVER,
+      SWEEP_SELECT,
+      SWEEP_RUNNING
+    };
+
+    enum UnitState {
+      UNIT_PENDING,
+      UNIT_DONE,
+      UNIT_FAILED
+    };
+
+    enum SweepOrder {
+      ORDER_BYTES,
+      ORDER_AGE
+    };
+
+    struct SweepUnit {
+      char id[SWEEP_UNIT_ID_SIZE];
+      uint32_t events;
+      uint32_t bytes;
+      uint32_t ageSec;
+      float rssi;
+      float snr;
+      float rate[3];          // Observed bytes/s per path (0 = no history)
+      uint8_t failures[3];    // Recent failures per path
+      uint8_t attempts;
+      UnitState state;
+      unsigned long retryAtMs;
+    };
+
+    SweepSendFn _send;
+    SweepOffloadFn _startOffload;
+    SweepReleaseFn _releaseLink;
+    Print* _out;
+
+    SweepState _state;
+    SweepOrder _order;
+    bool _stopRequested;
+    bool _siteWifiAvailable;
+    bool _softApAvailable;      // SoftAP credentials are configured
+
+    // Units persist across sweeps so link history carries forward
+    SweepUnit _units[SWEEP_MAX_UNITS];
+    uint8_t _unitCount;
+
+    uint8_t _discoveryRound;
+    unsigned long _discoveryStartMs;
+
+    int8_t _current;
+    char _currentPath;
+    bool _fellBack;
+    unsigned long _jobStartMs;
+    unsigned long _lastActivityMs;
+    unsigned long _lastProgressMs;
+    size_t _jobBytes;
+
+    unsigned long _sweepStartMs;
+    uint32_t _sweepBytes;
+
+    void startSweep(SweepOrder order);
+    void startDiscoveryRound();
+    void selectNextJob();
+    void finishSweep();
+    void failJob(const char* reason);
+    void recordQueueSummary(const char* payload, float rssi, float snr);
+    int findUnit(const char* id) const;
+    char choosePath(const SweepUnit& unit, float& expectedSec) const;
+    float expectedSeconds(const SweepUnit& unit, char path) const;
+    static int pathIndex(char path);
+};
+
+#endif
@@ -0,0 +1,418 @@
+/*
+  Filename: StoreForward_Module.cpp
+  Store-and-Forward Queue Module Implementation
+
+  Description: Flash-backed (LittleFS) spool for offloaded event data.
+*/
+
+#include "StoreForward_Module.h"
+
+StoreForward_Module::StoreForward_Module()
+  : _mounted(false),
+    _hold(false),
+    _paused(false),
+    _fullReported(false),
+    _writeSeq(0),
+    _writeBytes(0),
+    _lastWriteMs(0),
+    _atLineStart(true),
+    _writeBufferLen(0),
+    _headSeq(1),
+    _nextSeq(1),
+    _drainState(DRAIN_IDLE),
+    _drainSeq(0),
+    _drainPad(false),
+    _ackWaitStartMs(0),
+    _live(*this),
+    _liveLen(0),
+    _segmentsDrained(0),
+    _bytesDrained(0),
+    _ackTimeouts(0) {}
+
+bool StoreForward_Module::begin() {
+  // Format on first use so a fresh board gets a usable queue.
+  if (!LittleFS.begin(true)) {
+    _live.println("[SF] LittleFS mount failed - forwarding live to USB");
+    _mounted = false;
+    return false;
+  }
+
+  if (!LittleFS.exists(SF_DIR)) {
+    LittleFS.mkdir(SF_DIR);
+  }
+
+  _mounted = true;
+  _hold = LittleFS.exists(SF_HOLD_FILE);
+  scanSegments();
+
+  _live.printf("[SF] Queue ready: %lu segment(s) pending%s\n",
+               (unsigned long)pendingSegments(), _hold ? " (hold)" : "");
+  return true;
+}
+
+void StoreForward_Module::segmentPath(uint32_t seq, bool open, char* out, size_t outSize) const {
+  snprintf(out, outSize, SF_DIR "/%08lu.%s", (unsigned long)seq, open ? "tmp" : "seg");
+}
+
+void StoreForward_Module::scanSegments() {
+  uint32_t minSeq = 0;
+  uint32_t maxSeq = 0;
+
+  File root = LittleFS.open(SF_DIR);
+  if (!root || !root.isDirectory()) {
+    _headSeq = 1;
+    _nextSeq = 1;
+    return;
+  }
+
+  File file = root.openNextFile();
+  while (file) {
+    if (!file.isDirectory()) {
+      const char* name = file.name();
+      const char* slash = strrchr(name, '/');
+      if (slash != nullptr) {
+        name = slash + 1;
+      }
+
+      char* end = nullptr;
+      uint32_t seq = strtoul(name, &end, 10);
+      bool isOpen = (end != nullptr && strcmp(end, ".tmp") == 0);
+      bool isClosed = (end != nullptr && strcmp(end, ".seg") == 0);
+      file.close();
+
+      if (seq > 0 && (isOpen || isClosed)) {
+        if (isOpen) {
+          // Segment was still being written when power dropped; keep what reached flash.
+          char fromPath[32];
+          char toPath[32];
+          segmentPath(seq, true, fromPath, sizeof(fromPath));
+          segmentPath(seq, false, toPath, sizeof(toPath));
+          LittleFS.rename(fromPath, toPath);
+        }
+        if (minSeq == 0 || seq < minSeq) minSeq = seq;
+        if (seq > maxSeq) maxSeq = seq;
+      }
+    } else {
+      file.close();
+    }
+    file = root.openNextFile();
+  }
+  root.close();
+
+  _headSeq = (minSeq == 0) ? 1 : minSeq;
+  _nextSeq = maxSeq + 1;
+}
+
+uint32_t StoreForward_Module::pendingSegments() const {
+  uint32_t closedLimit = _writeFile ? _writeSeq : _nextSeq;
+  return (closedLimit > _headSeq) ? (closedLimit - _headSeq) : 0;
+}
+
+bool StoreForward_Module::hasFreeSpace() const {
+  size_t total = LittleFS.totalBytes();
+  size_t used = LittleFS.usedBytes();
+  return total > used && (total - used) > SF_FREE_MARGIN_BYTES;
+}
+
+bool StoreForward_Module::openSegment() {
+  if (!hasFreeSpace()) {
+    if (!_fullReported) {
+      _live.println("[SF_FULL] Flash queue full - forwarding live to USB");
+      _fullReported = true;
+    }
+    return false;
+  }
+  _fullReported = false;
+
+  char path[32];
+  segmentPath(_nextSeq, true, path, sizeof(path));
+  _writeFile = LittleFS.open(path, FILE_WRITE);
+  if (!_writeFile) {
+    _live.printf("[SF] Failed to open %s\n", path);
+    return false;
+  }
+
+  _writeSeq = _nextSeq++;
+  _writeBytes = 0;
+  _writeBufferLen = 0;
+  _atLineStart = true;
+  return true;
+}
+
+void StoreForward_Module::flushBuffer() {
+  if (_writeBufferLen == 0 || !_writeFile) {
+    return;
+  }
+  _writeFile.write((const uint8_t*)_writeBuffer, _writeBufferLen);
+  _writeBufferLen = 0;
+}
+
+void StoreForward_Module::append(const char* data, size_t len) {
+  if (len == 0) {
+    return;
+  }
+
+  if (!_mounted || (!_writeFile && !openSegment())) {
+    // Pass-through keeps the old live behaviour when flash is unavailable.
+    writeLive((const uint8_t*)data, len);
+    return;
+  }
+
+  size_t offset = 0;
+  while (offset < len) {
+    size_t room = SF_WRITE_BUFFER_SIZE - _writeBufferLen;
+    size_t take = (len - offset) < room ? (len - offset) : room;
+    memcpy(_writeBuffer + _writeBufferLen, data + offset, take);
+    _writeBufferLen += take;
+    offset += take;
+    if (_writeBufferLen == SF_WRITE_BUFFER_SIZE) {
+      flushBuffer();
+    }
+  }
+
+  _writeBytes += len;
+  _lastWriteMs = millis();
+  _atLineStart = (data[len - 1] == '\n');
+
+  // Only roll on a line boundary so every segment holds whole lines.
+  if (_atLineStart && _writeBytes >= SF_SEGMENT_MAX_BYTES) {
+    closeSegment();
+  }
+}
+
+void StoreForward_Module::print(const char* text) {
+  append(text, strlen(text));
+}
+
+void StoreForward_Module::print(const char* data, size_t len) {
+  append(data, len);
+}
+
+void StoreForward_Module::println(const char* line) {
+  append(line, strlen(line));
+  append("\n", 1);
+}
+
+void StoreForward_Module::println(const char* data, size_t len) {
+  append(data, len);
+  append("\n", 1);
+}
+
+void StoreForward_Module::closeSegment() {
+  if (!_writeFile) {
+    return;
+  }
+
+  flushBuffer();
+  _writeFile.close();
+
+  char openPath[32];
+  segmentPath(_writeSeq, true, openPath, sizeof(openPath));
+  if (_writeBytes == 0) {
+    LittleFS.remove(openPath);
+    if (_writeSeq + 1 == _nextSeq) {
+      _nextSeq = _writeSeq;
+    }
+    return;
+  }
+
+  char closedPath[32];
+  segmentPath(_writeSeq, false, closedPath, sizeof(closedPath));
+  if (!LittleFS.rename(openPath, closedPath)) {
+    _live.printf("[SF] Failed to close segment %lu\n", (unsigned long)_writeSeq);
+  }
+}
+
+void StoreForward_Module::poll() {
+  if (!_mounted) {
+    return;
+  }
+
+  // Close a quiet, line-aligned segment so the host sees data without waiting for END:D.
+  if (_writeFile && _writeBytes > 0 && _atLineStart &&
+      (millis() - _lastWriteMs) > SF_SEGMENT_IDLE_MS) {
+    closeSegment();
+  }
+
+  switch (_drainState) {
+    case DRAIN_IDLE:
+      if (!_hold && !_paused && pendingSegments() > 0) {
+        startDrain();
+      }
+      break;
+
+    case DRAIN_SENDING:
+      continueDrain(false);
+      break;
+
+    case DRAIN_WAIT_ACK:
+      if ((millis() - _ackWaitStartMs) > SF_ACK_TIMEOUT_MS) {
+        _ackTimeouts++;
+        _live.printf("[SF_ACK_TIMEOUT] seq=%lu (send SFDRAIN to resume)\n", (unsigned long)_drainSeq);
+        _paused = true;
+        _drainState = DRAIN_IDLE;
+      }
+      break;
+  }
+}
+
+void StoreForward_Module::startDrain() {
+  char path[32];
+  segmentPath(_headSeq, false, path, sizeof(path));
+  _drainFile = LittleFS.open(path, FILE_READ);
+  if (!_drainFile) {
+    // Missing segment (removed externally) - skip it rather than stall the queue.
+    _headSeq++;
+    return;
+  }
+
+  // A segment recovered after power loss can end mid-line; bytes= counts the newline added after it
+  size_t size = _drainFile.size();
+  _drainPad = false;
+  if (size > 0 && _drainFile.seek(size - 1)) {
+    _drainPad = (_drainFile.read() != '\n');
+    _drainFile.seek(0);
+  }
+
+  _drainSeq = _headSeq;
+  Serial.printf("[SF_SEG_BEGIN] seq=%lu bytes=%u\n",
+                (unsigned long)_drainSeq, (unsigned int)(size + (_drainPad ? 1 : 0)));
+  _drainState = DRAIN_SENDING;
+}
+
+void StoreForward_Module::continueDrain(bool block) {
+  uint8_t chunk[SF_DRAIN_CHUNK_SIZE];
+  do {
+    // Unless told to finish the segment, never block on a full UART FIFO; send only what fits right now.
+    size_t want = sizeof(chunk);
+    if (!block) {
+      int room = Serial.availableForWrite();
+      if (room <= 0) {
+        return;
+      }
+      want = (size_t)room < sizeof(chunk) ? (size_t)room : sizeof(chunk);
+    }
+    size_t got = _drainFile.read(chunk, want);
+    if (got > 0) {
+      Serial.write(chunk, got);
+      _bytesDrained += got;
+    }
+  } while (block && _drainFile.available() > 0);
+
+  if (_drainFile.available() > 0) {
+    return;
+  }
+
+  _drainFile.close();
+  if (_drainPad) {
+    Serial.write((uint8_t)'\n');
+  }
+  Serial.printf("[SF_SEG_END] seq=%lu\n", (unsigned long)_drainSeq);
+  _ackWaitStartMs = millis();
+  _drainState = DRAIN_WAIT_ACK;
+  releaseLive();
+}
+
+size_t StoreForward_Module::writeLive(const uint8_t* data, size_t len) {
+  if (_drainState != DRAIN_SENDING) {
+    return Serial.write(data, len);
+  }
+
+  if (_liveLen + len > sizeof(_liveBuffer)) {
+    // More than can be held: finish the segment now rather than split it
+    continueDrain(true);
+    return Serial.write(data, len);
+  }
+  memcpy(_liveBuffer + _liveLen, data, len);
+  _liveLen += len;
+  return len;
+}
+
+void StoreForward_Module::releaseLive() {
+  if (_liveLen > 0) {
+    Serial.write(_liveBuffer, _liveLen);
+    _liveLen = 0;
+  }
+}
+
+void StoreForward_Module::finishAck(uint32_t seq) {
+  if (_drainState != DRAIN_WAIT_ACK || seq != _drainSeq) {
+    return;
+  }
+
+  char path[32];
+  segmentPath(seq, false, path, sizeof(path));
+  LittleFS.remove(path);
+
+  _headSeq = seq + 1;
+  _segmentsDrained++;
+  _paused = false;
+  _drainState = DRAIN_IDLE;
+}
+
+void StoreForward_Module::resendSegment(uint32_t seq) {
+  if (_drainState != DRAIN_WAIT_ACK || seq != _drainSeq) {
+    return;
+  }
+
+  // Host counted a different size; the segment stays at the head and drains again
+  _paused = false;
+  _drainState = DRAIN_IDLE;
+}
+
+bool StoreForward_Module::handleHostCommand(const String& line) {
+  if (line.startsWith("SFACK:")) {
+    finishAck((uint32_t)line.substring(6).toInt());
+    return true;
+  }
+
+  if (line.startsWith("SFNAK:")) {
+    resendSegment((uint32_t)line.substring(6).toInt());
+    return true;
+  }
+
+  if (line == "SFDRAIN") {
+    _paused = false;
+    _live.printf("[SF_DRAIN] pending=%lu\n", (unsigned long)pendingSegments());
+    return true;
+  }
+
+  if (line.startsWith("SFHOLD:")) {
+    _hold = (line.substring(7).toInt() != 0);
+    if (_mounted) {
+      if (_hold) {
+        File f = LittleFS.open(SF_HOLD_FILE, FILE_WRITE);
+        f.close();
+      } else {
+        LittleFS.remove(SF_HOLD_FILE);
+      }
+    }
+    _live.printf("[SF_HOLD] %s\n", _hold ? "on" : "off");
+    return true;
+  }
+
+  if (line == "SFSTAT") {
+    printStatus();
+    return true;
+  }
+
+  return false;
+}
+
+void StoreForward_Module::printStatus() {
+  size_t total = _mounted ? LittleFS.totalBytes() : 0;
+  size_t used = _mounted ? LittleFS.usedBytes() : 0;
+  _live.printf("[SF_STAT] mounted=%d hold=%d paused=%d pending=%lu head=%lu next=%lu "
+               "flash_used=%u flash_total=%u drained_segments=%lu drained_bytes=%lu ack_timeouts=%lu\n",
+               _mounted ? 1 : 0,
+               _hold ? 1 : 0,
+               _paused ? 1 : 0,
+               (unsigned long)pendingSegments(),
+               (unsigned long)_headSeq,
+               (unsigned long)_nextSeq,
+               (unsigned int)used,
+               (unsigned int)total,
+               (unsigned long)_segmentsDrained,
+               (unsigned long)_bytesDrained,
+               (unsigned long)_ackTimeouts);
+}
@@ -0,0 +1,162 @@
+/*
+  Filename: StoreForward_Module.h
+  Store-and-Forward Queue Module Header
+
+  Description: Flash-backed (LittleFS) spool for offloaded event data.
+               Everything that used to be printed straight to USB serial
+               during an offload is appended to segment files first, then
+               drained to the host one segment at a time. A segment is only
+               deleted once the host acknowledges it with SFACK:<seq>, so a
+               sleeping laptop or pulled cable no longer loses data.
+
+               All other host output goes through live() instead of Serial.
+               While a segment is on the wire that output is held in RAM and
+               released after [SF_SEG_END], so nothing can land inside a
+               segment.
+
+  Host protocol (USB serial):
+    [SF_SEG_BEGIN] seq=<n> bytes=<size>   exactly <size> payload bytes follow
+    [SF_SEG_END] seq=<n>                  host counts the bytes, then replies
+                                          SFACK:<n> (match) or SFNAK:<n> (resend)
+    SFDRAIN                               resume draining after a timeout
+    SFHOLD:1 / SFHOLD:0                   hold data on flash (handheld mode)
+    SFSTAT                                print queue status
+*/
+
+#ifndef STOREFORWARD_MODULE_H
+#define STOREFORWARD_MODULE_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <LittleFS.h>
+
+#define SF_DIR                  "/sf"
+#define SF_HOLD_FILE            "/sf/hold"
+#define SF_SEGMENT_MAX_BYTES    8192    // Roll to a new segment once this size is passed
+#define SF_SEGMENT_IDLE_MS      1000    // Close a partially filled segment after this much quiet
+#define SF_WRITE_BUFFER_SIZE    1024    // RAM staging buffer in front of flash writes
+#define SF_DRAIN_CHUNK_SIZE     512     // Bytes copied to USB per poll() call
+#define SF_ACK_TIMEOUT_MS       5000    // Wait this long for SFACK before pausing the drain
+#define SF_FREE_MARGIN_BYTES    32768   // Stop spooling when flash free space drops below this
+#define SF_LIVE_BUFFER_SIZE     1024    // Live output held back while a segment is on the wire
+
+class StoreForward_Module {
+  public:
+    StoreForward_Module();
+
+    /**
+     * Mount LittleFS and recover segments left from a previous boot
+     * @return true if the flash queue is usable; false means pass-through mode
+     */
+    bool begin();
+
+    /**
+     * Spool raw bytes (no newline added)
+     */
+    void print(const char* text);
+    void print(const char* data, size_t len);
+
+    /**
+     * Spool one line (newline appended)
+     */
+    void println(const char* line);
+    void println(const char* data, size_t len);
+
+    /**
+     * Close the open segment so it becomes eligible for draining
+     * Called at the end of each offload session (END:D)
+     */
+    void closeSegment();
+
+    /**
+     * Service the queue: flush idle writes and push the next drain chunk to USB
+     * Call every loop() pass; never blocks for more than one chunk
+     */
+    void poll();
+
+    /**
+     * Host output that is not spooled data ([TX], [RX], replies to commands)
+     * Held back while a segment drains; use it instead of Serial. Output that
+     * outgrows SF_LIVE_BUFFER_SIZE first sends the rest of the segment, blocking
+     */
+    Print& live() { return _live; }
+
+    /**
+     * Handle SFACK/SFNAK/SFDRAIN/SFHOLD/SFSTAT lines from the host
+     * @return true if the line was a store-and-forward command
+     */
+    bool handleHostCommand(const String& line);
+
+    /**
+     * Print queue depth, flash usage and drain state
+     */
+    void printStatus();
+
+    bool isAvailable() const { return _mounted; }
+    uint32_t pendingSegments() const;
+
+  private:
+    enum DrainState {
+      DRAIN_IDLE,
+      DRAIN_SENDING,
+      DRAIN_WAIT_ACK
+    };
+
+    class LiveOutput : public Print {
+      public:
+        explicit LiveOutput(StoreForward_Module& queue) : _queue(queue) {}
+        size_t write(uint8_t c) override { return _queue.writeLive(&c, 1); }
+        size_t write(const uint8_t* data, size_t len) override { return _queue.writeLive(data, len); }
+
+      private:
+        StoreForward_Module& _queue;
+    };
+
+    bool _mounted;
+    bool _hold;
+    bool _paused;
+    bool _fullReported;
+
+    // Write side (tail)
+    File _writeFile;
+    uint32_t _writeSeq;
+    uint32_t _writeBytes;
+    unsigned long _lastWriteMs;
+    bool _atLineStart;
+    char _writeBuffer[SF_WRITE_BUFFER_SIZE];
+    size_t _writeBufferLen;
+
+    // Read side (head)
+    uint32_t _headSeq;
+    uint32_t _nextSeq;
+    DrainState _drainState;
+    File _drainFile;
+    uint32_t _drainSeq;
+    bool _drainPad;                 // Segment ends mid-line; a newline is sent (and counted) after it
+    unsigned long _ackWaitStartMs;
+
+    // Live output held back while a segment is on the wire
+    LiveOutput _live;
+    uint8_t _liveBuffer[SF_LIVE_BUFFER_SIZE];
+    size_t _liveLen;
+
+    // Counters for SFSTAT
+    uint32_t _segmentsDrained;
+    uint32_t _bytesDrained;
+    uint32_t _ackTimeouts;
+
+    void segmentPath(uint32_t seq, bool open, char* out, size_t outSize) const;
+    bool openSegment();
+    void flushBuffer();
+    void append(const char* data, size_t len);
+    bool hasFreeSpace() const;
+    void startDrain();
+    void continueDrain(bool block);
+    void finishAck(uint32_t seq);
+    void resendSegment(uint32_t seq);
+    size_t writeLive(const uint8_t* data, size_t len);
+    void releaseLive();
+    void scanSegments();
+};
+
+#endif
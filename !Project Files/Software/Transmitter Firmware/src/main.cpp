@@ -2,10 +2,36 @@
 #include <RadioLib.h>
 #include <WiFi.h>
 #include <EEPROM.h>
+#include "StoreForward_Module.h"
+#include "FleetSweep_Module.h"
+#include "LineRing.h"
+#include "SetupTokenizer.h"
+#include "ConfigStore.h"
+#include "ParamRegistry.h"
+#include "AllocCounter.h"
+#include "StaticPool.h"
+#include "MemStatus.h"
+#include "LineAssembler.h"
+#include "Metrics.h"
+#include "OffloadLink.h"     // Event row limits and SoftAP credential rules, shared with the receiver
 
 #define SERIAL_BAUD_RATE      115200
-
-// EEPROM storage for Wi-Fi profiles (32 bytes per SSID + 64 bytes per password = 288 bytes total)
+#define SERIAL_LINE_MAX       512     // Longest host command line (SETUP: with Wi-Fi profiles)
+#define SERIAL_LINE_IDLE_MS   1000    // Partial line with no new byte completes after this (old Stream timeout)
+
+// Persistent configuration (binary TLV image in NVS, see Shared/ConfigTLV)
+#define CFG_NVS_NAMESPACE        "wabash_tx"
+#define CFG_CAPACITY             512     // Three Wi-Fi profiles and the sweep SoftAP at full length
+#define CFG_TAG_WIFI_SSID_BASE   0x10   // + profile index (same tags as the receiver)
+#define CFG_TAG_WIFI_PASS_BASE   0x18   // + profile index
+#define CFG_TAG_LORA_SF          0x24   // lora.* tags match the receiver
+#define CFG_TAG_LORA_BW          0x25
+#define CFG_TAG_LORA_CR          0x26
+#define CFG_TAG_LORA_POWER       0x27
+#define CFG_TAG_SOFTAP_SSID      0x38   // Sweep SoftAP (SETUP aps=/app=), same tags as the receiver
+#define CFG_TAG_SOFTAP_PASS      0x39
+
+// Legacy EEPROM layout for Wi-Fi profiles; only read once to migrate into NVS
 #define EEPROM_SIZE 512
 #define EEPROM_OFFSET_WIFI 0
 #define EEPROM_SSID_SIZE 32
@@ -17,7 +43,7 @@
 #define LORA_RST              12
 #define LORA_BUSY             13
 
-// LoRa Radio Link Configuration (must match receiver)
+// LoRa Radio Link Configuration (must match receiver; SF/BW/CR/power tunable via TXSET:lora.*)
 #define LORA_FREQUENCY_MHZ    915.0
 #define LORA_BANDWIDTH_KHZ    125.0
 #define LORA_SPREADING_FACTOR 9
@@ -25,12 +51,41 @@
 #define LORA_SYNC_WORD        0x34
 #define LORA_TX_POWER_DBM     14
 #define LORA_PREAMBLE_LEN     8
+#define LORA_MAX_PACKET_SIZE  256   // SX1262 FIFO; RX packets are read into a buffer this size
+#define PACKET_POOL_BLOCKS    2     // RX packet + sweep command sent while handling it
 
 #define SETUP_MASK_WIFI       (1 << 6)
 
 SX1262 loraRadio = new Module(LORA_NSS, LORA_DIO1, LORA_RST, LORA_BUSY);
+
+// LoRa packet buffers; MEMSTAT reports use, peak and failures
+StaticPool<LORA_MAX_PACKET_SIZE + 1, PACKET_POOL_BLOCKS> g_packetPool("packet");
+
+uint8_t g_loraSpreadingFactor = LORA_SPREADING_FACTOR;
+float g_loraBandwidthKhz = LORA_BANDWIDTH_KHZ;
+uint8_t g_loraCodingRate = LORA_CODING_RATE;
+int g_loraTxPowerDbm = LORA_TX_POWER_DBM;
 volatile bool loraPacketReceived = false;
 
+// Offload data is spooled to flash first and drained to the host on acknowledgement
+StoreForward_Module storeForward;
+
+// Every other line for the host; held back while a spooled segment is on the wire
+Print& hostSerial = storeForward.live();
+
+// Unattended yard offload queue (SWEEP commands)
+FleetSweep_Module fleetSweep;
+bool softApActive = false;
+
+// Link and offload metrics since boot (METRICS); see Shared/Metrics
+MetricHistogram g_metLoraTxMs("lora_tx_ms");        // Airtime plus SPI, per packet
+MetricCounter g_metLoraTxFail("lora_tx_fail");
+MetricCounter g_metLoraRxPackets("lora_rx");
+MetricCounter g_metLoraRxFail("lora_rx_fail");
+MetricHistogram g_metTransferMs("transfer_ms");     // One offload, CMD:d to END:D
+MetricHistogram g_metTransferBps("transfer_bps");   // Same rate as the [TRANSFER] line
+MetricCounter g_metTransferBytes("transfer_bytes");
+
 bool dataTransferActive = false;
 unsigned long dataTransferStartMs = 0;
 size_t dataTransferBytes = 0;
@@ -39,9 +94,14 @@ size_t dataTransferLines = 0;
 #define MAX_WIFI_PROFILES 3
 String t_wifiSsids[MAX_WIFI_PROFILES];
 String t_wifiPasswords[MAX_WIFI_PROFILES];
+String t_softApSsid;       // Sweep SoftAP; empty (path off) until set by SETUP aps=/app=
+String t_softApPassword;
 
 // Allow extra headroom for receiver SD/Wi-Fi jitter before declaring transfer timeout.
 #define WIFI_TCP_IDLE_TIMEOUT_MS 30000UL
+// TCP ingest ring (power of two); must hold the longest DATA: line a receiver can send
+#define WIFI_TCP_RING_SIZE       16384
+static_assert(WIFI_TCP_RING_SIZE >= OFFLOAD_TCP_LINE_MAX, "WIFI_TCP_RING_SIZE must hold one full event row");
 
 #if defined(ESP8266) || defined(ESP32)
   ICACHE_RAM_ATTR
@@ -53,24 +113,54 @@ void setLoRaFlag(void) {
 void restartLoRaReceive() {
   int rxState = loraRadio.startReceive();
   if (rxState != RADIOLIB_ERR_NONE) {
-    Serial.printf("LoRa RX start failed (%d)\n", rxState);
+    hostSerial.printf("LoRa RX start failed (%d)\n", rxState);
+  }
+}
+
+bool applyLoRaParam(const ParamDef& def) {
+  if (def.value == &g_loraBandwidthKhz) {
+    // SX1262 only supports these bandwidths
+    static const float validBw[] = {7.8f, 10.4f, 15.6f, 20.8f, 31.25f, 41.7f, 62.5f, 125.0f, 250.0f, 500.0f};
+    bool valid = false;
+    for (size_t i = 0; i < sizeof(validBw) / sizeof(validBw[0]); i++) {
+      if (fabsf(validBw[i] - g_loraBandwidthKhz) < 0.01f) valid = true;
+    }
+    if (!valid) return false;
   }
+
+  int state = loraRadio.setSpreadingFactor(g_loraSpreadingFactor);
+  if (state == RADIOLIB_ERR_NONE) state = loraRadio.setBandwidth(g_loraBandwidthKhz);
+  if (state == RADIOLIB_ERR_NONE) state = loraRadio.setCodingRate(g_loraCodingRate);
+  if (state == RADIOLIB_ERR_NONE) state = loraRadio.setOutputPower(g_loraTxPowerDbm);
+  restartLoRaReceive();
+  return state == RADIOLIB_ERR_NONE;
 }
 
-bool sendLoRaPacket(const String& packet) {
-  int txState = loraRadio.transmit(packet.c_str());
+const ParamDef PARAM_TABLE[] = {
+  {"lora.sf",        PARAM_UINT8, &g_loraSpreadingFactor, 7,    12,  PARAM_PERSIST, CFG_TAG_LORA_SF,    applyLoRaParam},
+  {"lora.bw_khz",    PARAM_FLOAT, &g_loraBandwidthKhz,    7.8f, 500, PARAM_PERSIST, CFG_TAG_LORA_BW,    applyLoRaParam},
+  {"lora.cr",        PARAM_UINT8, &g_loraCodingRate,      5,    8,   PARAM_PERSIST, CFG_TAG_LORA_CR,    applyLoRaParam},
+  {"lora.power_dbm", PARAM_INT,   &g_loraTxPowerDbm,      -9,   22,  PARAM_PERSIST, CFG_TAG_LORA_POWER, applyLoRaParam},
+};
+ParamRegistry params(PARAM_TABLE, sizeof(PARAM_TABLE) / sizeof(PARAM_TABLE[0]));
+
+bool sendLoRaPacket(const char* packet) {
+  uint32_t txStartUs = micros();
+  int txState = loraRadio.transmit(packet);
   if (txState != RADIOLIB_ERR_NONE) {
-    Serial.printf("LoRa TX failed (%d)\n", txState);
+    g_metLoraTxFail.add();
+    hostSerial.printf("LoRa TX failed (%d)\n", txState);
     return false;
   }
+  g_metLoraTxMs.record((micros() - txStartUs + 500) / 1000);
 
-  Serial.printf("[TX] %s\n", packet.c_str());
+  hostSerial.printf("[TX] %s\n", packet);
   restartLoRaReceive();
   return true;
 }
 
 bool sendLoRaCommand(char command) {
-  String packet = "CMD:" + String(command);
+  char packet[] = {'C', 'M', 'D', ':', command, '\0'};
   if (!sendLoRaPacket(packet)) {
     return false;
   }
@@ -84,28 +174,40 @@ bool sendLoRaCommand(char command) {
   return true;
 }
 
-void saveWiFiProfilesToEEPROM() {
+bool hasTransmitterWifiProfiles() {
   for (int i = 0; i < MAX_WIFI_PROFILES; i++) {
-    int16_t ssidLen = t_wifiSsids[i].length();
-    int ssidAddr = EEPROM_OFFSET_WIFI + (i * (2 + EEPROM_SSID_SIZE + 2 + EEPROM_PASS_SIZE));
-    
-    EEPROM.writeShort(ssidAddr, ssidLen);
-    for (size_t j = 0; j < EEPROM_SSID_SIZE; j++) {
-      EEPROM.writeByte(ssidAddr + 2 + j, (j < t_wifiSsids[i].length()) ? t_wifiSsids[i][j] : 0);
-    }
-    
-    int16_t passLen = t_wifiPasswords[i].length();
-    int passAddr = ssidAddr + 2 + EEPROM_SSID_SIZE;
-    EEPROM.writeShort(passAddr, passLen);
-    for (size_t j = 0; j < EEPROM_PASS_SIZE; j++) {
-      EEPROM.writeByte(passAddr + 2 + j, (j < t_wifiPasswords[i].length()) ? t_wifiPasswords[i][j] : 0);
-    }
+    if (t_wifiSsids[i].length() > 0) return true;
+  }
+  return false;
+}
+
+ConfigStore<CFG_CAPACITY> configStore(CFG_NVS_NAMESPACE);
+
+void saveConfigToNvs() {
+  ConfigTLV<CFG_CAPACITY>& cfg = configStore.blob();
+  storeParams(params, cfg);
+  for (int i = 0; i < MAX_WIFI_PROFILES; i++) {
+    cfg.setString(CFG_TAG_WIFI_SSID_BASE + i, t_wifiSsids[i].c_str(), t_wifiSsids[i].length());
+    cfg.setString(CFG_TAG_WIFI_PASS_BASE + i, t_wifiPasswords[i].c_str(), t_wifiPasswords[i].length());
+  }
+  cfg.setString(CFG_TAG_SOFTAP_SSID, t_softApSsid.c_str(), t_softApSsid.length());
+  cfg.setString(CFG_TAG_SOFTAP_PASS, t_softApPassword.c_str(), t_softApPassword.length());
+  fleetSweep.setSiteWifiAvailable(hasTransmitterWifiProfiles());
+  fleetSweep.setSoftApAvailable(t_softApSsid.length() > 0);
+
+  // Unchanged settings leave the image clean and skip the flash write
+  if (!cfg.dirty() && configStore.hasStoredImage()) {
+    return;
+  }
+  if (configStore.commit()) {
+    hostSerial.printf("[CFG] Configuration saved (gen=%lu)\n", (unsigned long)cfg.generation());
+  } else {
+    hostSerial.println("[CFG] NVS commit failed");
   }
-  EEPROM.commit();
-  Serial.println("[EEPROM] Wi-Fi profiles saved");
 }
 
 void loadWiFiProfilesFromEEPROM() {
+  // Pre-NVS firmware stored profiles here; EEPROM is left untouched after migration
   EEPROM.begin(EEPROM_SIZE);
   for (int i = 0; i < MAX_WIFI_PROFILES; i++) {
     int ssidAddr = EEPROM_OFFSET_WIFI + (i * (2 + EEPROM_SSID_SIZE + 2 + EEPROM_PASS_SIZE));
@@ -133,61 +235,118 @@ void loadWiFiProfilesFromEEPROM() {
     if (t_wifiSsids[i].length() > 0) configuredProfiles++;
   }
   if (configuredProfiles > 0) {
-    Serial.printf("[EEPROM] Loaded %d Wi-Fi profile(s)\n", configuredProfiles);
+    hostSerial.printf("[EEPROM] Loaded %d Wi-Fi profile(s)\n", configuredProfiles);
+  }
+}
+
+void loadConfigFromNvs() {
+  if (configStore.load()) {
+    const ConfigTLV<CFG_CAPACITY>& cfg = configStore.blob();
+    loadParams(params, cfg);
+    const uint8_t* text;
+    size_t textLen;
+    int configuredProfiles = 0;
+    for (int i = 0; i < MAX_WIFI_PROFILES; i++) {
+      t_wifiSsids[i] = "";
+      t_wifiPasswords[i] = "";
+      if (cfg.getBytes(CFG_TAG_WIFI_SSID_BASE + i, text, textLen)) {
+        t_wifiSsids[i].concat((const char*)text, textLen);
+      }
+      if (cfg.getBytes(CFG_TAG_WIFI_PASS_BASE + i, text, textLen)) {
+        t_wifiPasswords[i].concat((const char*)text, textLen);
+      }
+      if (t_wifiSsids[i].length() > 0) configuredProfiles++;
+    }
+    t_softApSsid = "";
+    t_softApPassword = "";
+    if (cfg.getBytes(CFG_TAG_SOFTAP_SSID, text, textLen)) {
+      t_softApSsid.concat((const char*)text, textLen);
+    }
+    if (cfg.getBytes(CFG_TAG_SOFTAP_PASS, text, textLen)) {
+      t_softApPassword.concat((const char*)text, textLen);
+    }
+    hostSerial.printf("[CFG] Loaded %d Wi-Fi profile(s) from NVS in %lu us\n",
+                      configuredProfiles, configStore.lastLoadMicros());
+  } else {
+    // First boot on NVS firmware: carry the old EEPROM profiles across once
+    loadWiFiProfilesFromEEPROM();
+    saveConfigToNvs();
   }
+  fleetSweep.setSiteWifiAvailable(hasTransmitterWifiProfiles());
+  fleetSweep.setSoftApAvailable(t_softApSsid.length() > 0);
 }
 
 void parseAndStoreWifiProfiles(const String& packet) {
   if (!packet.startsWith("SETUP:")) return;
-  String data = packet.substring(6);
 
+  // Single pass: stage the Wi-Fi fields, then apply only if the mask selects Wi-Fi.
   bool maskProvided = false;
   unsigned int setupMask = 0;
-  int start = 0;
-  while (start < (int)data.length()) {
-    int sep = data.indexOf(';', start);
-    if (sep < 0) sep = (int)data.length();
-    String token = data.substring(start, sep);
-    int eq = token.indexOf('=');
-    if (eq > 0) {
-      String key = token.substring(0, eq);
-      String value = token.substring(eq + 1);
-      key.trim(); value.trim();
-      if (key == "m") {
-        setupMask = (unsigned int)value.toInt();
-        maskProvided = true;
-      }
+  SetupSpan ssids[MAX_WIFI_PROFILES] = {};
+  SetupSpan passwords[MAX_WIFI_PROFILES] = {};
+  bool sawSsid[MAX_WIFI_PROFILES] = {};
+  bool sawPassword[MAX_WIFI_PROFILES] = {};
+  SetupSpan apSsid = {};
+  SetupSpan apPassword = {};
+  bool sawApSsid = false;
+  bool sawApPassword = false;
+
+  SetupTokenizer tokenizer(packet.c_str(), packet.length());
+  SetupField field;
+  while (tokenizer.next(field)) {
+    if (field.key == SETUP_KEY_M) {
+      setupMask = (unsigned int)field.value.toLong();
+      maskProvided = true;
+    } else if (field.key == SETUP_KEY_WIFI_SSID && field.index < MAX_WIFI_PROFILES) {
+      ssids[field.index] = field.value;
+      sawSsid[field.index] = true;
+    } else if (field.key == SETUP_KEY_WIFI_PASS && field.index < MAX_WIFI_PROFILES) {
+      passwords[field.index] = field.value;
+      sawPassword[field.index] = true;
+    } else if (field.key == SETUP_KEY_AP_SSID) {
+      apSsid = field.value;
+      sawApSsid = true;
+    } else if (field.key == SETUP_KEY_AP_PASS) {
+      apPassword = field.value;
+      sawApPassword = true;
     }
-    start = sep + 1;
   }
 
   if (maskProvided && (setupMask & SETUP_MASK_WIFI) == 0) {
     return;
   }
 
-  start = 0;
-  while (start < (int)data.length()) {
-    int sep = data.indexOf(';', start);
-    if (sep < 0) sep = (int)data.length();
-    String token = data.substring(start, sep);
-    int eq = token.indexOf('=');
-    if (eq > 0) {
-      String key = token.substring(0, eq);
-      String value = token.substring(eq + 1);
-      key.trim(); value.trim();
-      if (key.length() == 3 && key.charAt(0) == 'w' && isDigit(key.charAt(1))) {
-        int idx = key.charAt(1) - '0';
-        if (idx >= 0 && idx < MAX_WIFI_PROFILES) {
-          if (key.charAt(2) == 's') t_wifiSsids[idx] = value;
-          else if (key.charAt(2) == 'p') t_wifiPasswords[idx] = value;
-        }
+  for (int i = 0; i < MAX_WIFI_PROFILES; i++) {
+    if (sawSsid[i]) {
+      t_wifiSsids[i] = "";
+      t_wifiSsids[i].concat(ssids[i].ptr, ssids[i].len);
+    }
+    if (sawPassword[i]) {
+      t_wifiPasswords[i] = "";
+      t_wifiPasswords[i].concat(passwords[i].ptr, passwords[i].len);
+    }
+  }
+
+  // Same rule as the receiver, so both ends keep the same SoftAP or neither changes
+  if (sawApSsid || sawApPassword) {
+    size_t ssidLen = sawApSsid ? apSsid.len : t_softApSsid.length();
+    size_t passwordLen = sawApPassword ? apPassword.len : t_softApPassword.length();
+    if (softApCredentialsValid(ssidLen, passwordLen)) {
+      if (sawApSsid) {
+        t_softApSsid = "";
+        t_softApSsid.concat(apSsid.ptr, apSsid.len);
+      }
+      if (sawApPassword) {
+        t_softApPassword = "";
+        t_softApPassword.concat(apPassword.ptr, apPassword.len);
       }
+    } else {
+      hostSerial.println("[SOFTAP] Rejected: needs an SSID of 1-32 chars and a password of 8-63 (or both empty)");
     }
-    start = sep + 1;
   }
   
-  // Persist the new profiles to EEPROM
-  saveWiFiProfilesToEEPROM();
+  // Persist the new profiles to NVS
+  saveConfigToNvs();
 }
 
 bool connectTransmitterWiFi() {
@@ -196,13 +355,13 @@ bool connectTransmitterWiFi() {
     if (t_wifiSsids[i].length() > 0) configuredProfiles++;
   }
   if (configuredProfiles == 0) {
-    Serial.println("[WIFI_TX_FAIL] No WiFi profiles loaded on transmitter. Send setup with Wi-Fi selected.");
+    hostSerial.println("[WIFI_TX_FAIL] No WiFi profiles loaded on transmitter. Send setup with Wi-Fi selected.");
     return false;
   }
 
   for (int i = 0; i < MAX_WIFI_PROFILES; i++) {
     if (t_wifiSsids[i].length() == 0) continue;
-    Serial.printf("[WIFI_TRY] %s\n", t_wifiSsids[i].c_str());
+    hostSerial.printf("[WIFI_TRY] %s\n", t_wifiSsids[i].c_str());
     WiFi.mode(WIFI_STA);
     WiFi.begin(t_wifiSsids[i].c_str(), t_wifiPasswords[i].c_str());
     int timeout = 8;
@@ -210,160 +369,272 @@ bool connectTransmitterWiFi() {
       delay(1000);
       timeout--;
       if (timeout > 0 && timeout < 8) {
-        Serial.printf("[WIFI_WAIT:%d] %s\n", timeout, t_wifiSsids[i].c_str());
+        hostSerial.printf("[WIFI_WAIT:%d] %s\n", timeout, t_wifiSsids[i].c_str());
       }
     }
     if (WiFi.status() == WL_CONNECTED) {
-      Serial.printf("[WIFI_CONNECTED] %s\n", t_wifiSsids[i].c_str());
+      hostSerial.printf("[WIFI_CONNECTED] %s\n", t_wifiSsids[i].c_str());
       return true;
     }
-    Serial.printf("[WIFI_FAIL] %s\n", t_wifiSsids[i].c_str());
+    hostSerial.printf("[WIFI_FAIL] %s\n", t_wifiSsids[i].c_str());
     WiFi.disconnect(true);
     WiFi.mode(WIFI_OFF);
   }
   return false;
 }
 
-void handleWifiServerMessage(const String& packet) {
+void endWifiClientSession() {
+  // Leave the SoftAP up for the sweep; it is torn down when the job ends
+  if (softApActive) {
+    return;
+  }
+  WiFi.disconnect(true);
+  WiFi.mode(WIFI_OFF);
+}
+
+bool sweepStartOffload(const char* unitId, char path) {
+  if (path == SWEEP_PATH_SOFTAP && !softApActive) {
+    if (t_softApSsid.length() == 0) {
+      hostSerial.println("[SWEEP] SoftAP not configured (SETUP aps=/app=)");
+      return false;
+    }
+    WiFi.mode(WIFI_AP);
+    if (!WiFi.softAP(t_softApSsid.c_str(), t_softApPassword.c_str())) {
+      hostSerial.println("[SWEEP] SoftAP start failed");
+      WiFi.mode(WIFI_OFF);
+      return false;
+    }
+    softApActive = true;
+    hostSerial.printf("[SOFTAP] %s up at %s\n", t_softApSsid.c_str(), WiFi.softAPIP().toString().c_str());
+  }
+
+  PoolBlock packet(g_packetPool);
+  if (!packet) {
+    hostSerial.println("[SWEEP] Packet pool exhausted");
+    return false;
+  }
+  snprintf(packet.chars(), packet.size(), "CMD:d@%s#%c", unitId, path);
+  if (!sendLoRaPacket(packet.chars())) {
+    return false;
+  }
+  dataTransferActive = true;
+  dataTransferStartMs = millis();
+  dataTransferBytes = 0;
+  dataTransferLines = 0;
+  return true;
+}
+
+void sweepReleaseLink() {
+  if (!softApActive) {
+    return;
+  }
+  WiFi.softAPdisconnect(true);
+  WiFi.mode(WIFI_OFF);
+  softApActive = false;
+}
+
+// One finished offload (Wi-Fi or LoRa path)
+void recordTransferMetrics(unsigned long elapsedMs, float bytesPerSec) {
+  g_metTransferMs.record(elapsedMs);
+  g_metTransferBps.record((uint32_t)(bytesPerSec + 0.5f));
+  g_metTransferBytes.add(dataTransferBytes);
+}
+
+void handleWifiServerMessage(const char* packet) {
   // Packet format: RSP:WIFI_SERVER:<IP>:<PORT>
-  String payload = packet.substring(16);  // strip "RSP:WIFI_SERVER:"
-  int colonPos = payload.lastIndexOf(':');
-  if (colonPos < 0) {
-    Serial.println("[WIFI_SERVER] Malformed packet");
+  const char* payload = packet + 16;  // strip "RSP:WIFI_SERVER:"
+  const char* colon = strrchr(payload, ':');
+  if (colon == nullptr || (size_t)(colon - payload) >= 40) {
+    hostSerial.println("[WIFI_SERVER] Malformed packet");
     return;
   }
-  String ip = payload.substring(0, colonPos);
-  int port = payload.substring(colonPos + 1).toInt();
+  char ip[40];
+  snprintf(ip, sizeof(ip), "%.*s", (int)(colon - payload), payload);
+  int port = atoi(colon + 1);
 
-  if (!connectTransmitterWiFi()) {
-    Serial.println("[WIFI_TX_FAIL] No WiFi profiles or connection failed after all attempts");
+  // During a SoftAP sweep job the receiver has joined our own network; no station link needed
+  if (!softApActive && !connectTransmitterWiFi()) {
+    hostSerial.println("[WIFI_TX_FAIL] No WiFi profiles or connection failed after all attempts");
+    fleetSweep.onPathFallback("tx_wifi");
     return;
   }
 
   WiFiClient client;
   bool tcpConnected = false;
   for (int attempt = 0; attempt < 3 && !tcpConnected; attempt++) {
-    if (client.connect(ip.c_str(), port)) {
+    if (client.connect(ip, port)) {
       tcpConnected = true;
     } else {
       delay(2000);
     }
   }
   if (!tcpConnected) {
-    Serial.println("[WIFI_TX_FAIL] TCP connect failed");
-    WiFi.disconnect(true);
-    WiFi.mode(WIFI_OFF);
+    hostSerial.println("[WIFI_TX_FAIL] TCP connect failed");
+    endWifiClientSession();
+    fleetSweep.onPathFallback("tcp_connect");
     return;
   }
 
-  Serial.printf("[WIFI_TX_CONNECTED] %s:%d\n", ip.c_str(), port);
+  hostSerial.printf("[WIFI_TX_CONNECTED] %s:%d\n", ip, port);
   unsigned long startMs = millis();
   dataTransferBytes = 0;
   dataTransferLines = 0;
 
+  // Socket data is read in large blocks into a ring and split into lines in place;
+  // payload slices go straight to the flash spool without any String copies.
+  static LineRing<WIFI_TCP_RING_SIZE> tcpRing;
+  tcpRing.clear();
+  auto spool = [](const char* data, size_t len) { storeForward.print(data, len); };
+
   unsigned long lastActivity = millis();
-  while (client.connected() && (millis() - lastActivity) < WIFI_TCP_IDLE_TIMEOUT_MS) {
-    if (!client.available()) continue;
-    String line = client.readStringUntil('\n');
-    line.replace("\r", "");
-    line.trim();
-    if (line.length() == 0) continue;
-    lastActivity = millis();
-
-    if (line.startsWith("DATA:")) {
-      String payload = line.substring(5);
-      dataTransferBytes += payload.length();
-      dataTransferLines++;
-      Serial.println(payload);
-    } else if (line.startsWith("DATC:")) {
-      String payload = line.substring(5);
-      dataTransferBytes += payload.length();
-      Serial.print(payload);
-    } else if (line == "END:D") {
-      client.stop();
-      WiFi.disconnect(true);
-      WiFi.mode(WIFI_OFF);
-      unsigned long elapsedMs = millis() - startMs;
-      float elapsedSec = elapsedMs / 1000.0f;
-      float rate = (elapsedSec > 0.0f) ? (dataTransferBytes / elapsedSec) : 0.0f;
-      Serial.println("END:D");
-      Serial.printf("[TRANSFER] duration=%lums lines=%u bytes=%u rate=%.1f B/s\n",
-                    elapsedMs, (unsigned int)dataTransferLines,
-                    (unsigned int)dataTransferBytes, rate);
-      return;
-    } else {
-      Serial.printf("[WIFI_RX] %s\n", line.c_str());
+  while ((client.connected() || client.available() > 0) &&
+         (millis() - lastActivity) < WIFI_TCP_IDLE_TIMEOUT_MS) {
+    size_t room;
+    char* dst = tcpRing.writeSpan(room);
+    int avail = client.available();
+    if (avail > 0 && room > 0) {
+      int got = client.read((uint8_t*)dst, (size_t)avail < room ? (size_t)avail : room);
+      if (got > 0) {
+        tcpRing.commit((size_t)got);
+        lastActivity = millis();
+      }
+    }
+
+    LineView line;
+    while (tcpRing.nextLine(line)) {
+      if (line.startsWith("DATA:")) {
+        LineView payload = line.dropFront(5);
+        dataTransferBytes += payload.length();
+        dataTransferLines++;
+        payload.forEachSpan(spool);
+        storeForward.print("\n", 1);
+        fleetSweep.onTransferData(payload.length());
+      } else if (line.startsWith("DATC:")) {
+        LineView payload = line.dropFront(5);
+        dataTransferBytes += payload.length();
+        payload.forEachSpan(spool);
+        fleetSweep.onTransferData(payload.length());
+      } else if (line.equals("END:D")) {
+        client.stop();
+        endWifiClientSession();
+        unsigned long elapsedMs = millis() - startMs;
+        float elapsedSec = elapsedMs / 1000.0f;
+        float rate = (elapsedSec > 0.0f) ? (dataTransferBytes / elapsedSec) : 0.0f;
+        recordTransferMetrics(elapsedMs, rate);
+        char summary[96];
+        snprintf(summary, sizeof(summary), "[TRANSFER] duration=%lums lines=%u bytes=%u rate=%.1f B/s",
+                 elapsedMs, (unsigned int)dataTransferLines,
+                 (unsigned int)dataTransferBytes, rate);
+        storeForward.println("END:D");
+        storeForward.println(summary);
+        storeForward.closeSegment();
+        dataTransferActive = false;
+        fleetSweep.onTransferEnd(dataTransferBytes, elapsedMs);
+        if (tcpRing.overflowCount() > 0) {
+          hostSerial.printf("[WIFI_RX] %u over-long line(s) dropped\n", (unsigned int)tcpRing.overflowCount());
+        }
+        return;
+      } else {
+        hostSerial.print("[WIFI_RX] ");
+        line.forEachSpan([](const char* data, size_t len) { hostSerial.write((const uint8_t*)data, len); });
+        hostSerial.println();
+      }
     }
   }
 
-  // Timeout or connection closed before END:D
+  // Timeout or connection closed before END:D - keep whatever was spooled
+  storeForward.closeSegment();
   client.stop();
-  WiFi.disconnect(true);
-  WiFi.mode(WIFI_OFF);
-  Serial.println("[WIFI_TX_TIMEOUT] Transfer ended without END:D");
+  endWifiClientSession();
+  dataTransferActive = false;
+  hostSerial.println("[WIFI_TX_TIMEOUT] Transfer ended without END:D");
+  fleetSweep.onTransferFailed("tcp_incomplete");
 }
 
-void handleLoRaMessage(const String& packet) {
-  if (packet.startsWith("SETUP:")) {
-    Serial.printf("[SETUP_ACK] Setup echoed from receiver: %s\n", packet.c_str());
+// Heap allocations per received packet (reported by ALLOCSTAT)
+AllocProbe loraPacketProbe("lora_rx");
+
+void finishLoRaTransfer() {
+  unsigned long elapsedMs = millis() - dataTransferStartMs;
+  float elapsedSec = elapsedMs / 1000.0f;
+  float bytesPerSec = (elapsedSec > 0.0f) ? (dataTransferBytes / elapsedSec) : 0.0f;
+  recordTransferMetrics(elapsedMs, bytesPerSec);
+  char summary[96];
+  snprintf(summary, sizeof(summary), "[TRANSFER] duration=%lums lines=%u bytes=%u rate=%.1f B/s",
+           elapsedMs,
+           (unsigned int)dataTransferLines,
+           (unsigned int)dataTransferBytes,
+           bytesPerSec);
+  storeForward.println("END:D");  // bare END:D so UI session_events counter fires
+  storeForward.println(summary);
+  storeForward.closeSegment();
+  dataTransferActive = false;
+  fleetSweep.onTransferEnd(dataTransferBytes, elapsedMs);
+}
+
+/**
+ * Route one received packet; packet is NUL-terminated, trimmed and len bytes long
+ */
+void handleLoRaMessage(const char* packet, size_t len) {
+  if (strncmp(packet, "SETUP:", 6) == 0) {
+    hostSerial.printf("[SETUP_ACK] Setup echoed from receiver: %s\n", packet);
     return;
   }
 
-  if (packet.startsWith("DATC:")) {
-    String chunk = packet.substring(5);
+  if (strncmp(packet, "DATC:", 5) == 0) {
+    size_t chunkLen = len - 5;
     if (dataTransferActive) {
-      dataTransferBytes += chunk.length();
+      dataTransferBytes += chunkLen;
     }
-    Serial.print(chunk);
+    fleetSweep.onTransferData(chunkLen);
+    storeForward.print(packet + 5, chunkLen);
     return;
   }
 
-  if (packet.startsWith("DATA:")) {
-    String chunk = packet.substring(5);
+  if (strncmp(packet, "DATA:", 5) == 0) {
+    size_t chunkLen = len - 5;
     if (dataTransferActive) {
-      dataTransferBytes += chunk.length();
+      dataTransferBytes += chunkLen;
       dataTransferLines++;
     }
-    Serial.println(chunk);
+    fleetSweep.onTransferData(chunkLen);
+    storeForward.println(packet + 5, chunkLen);
     return;
   }
 
-  if (packet.startsWith("END:")) {
-    if (packet == "END:D" && dataTransferActive) {
-      unsigned long elapsedMs = millis() - dataTransferStartMs;
-      float elapsedSec = elapsedMs / 1000.0f;
-      float bytesPerSec = (elapsedSec > 0.0f) ? (dataTransferBytes / elapsedSec) : 0.0f;
-      Serial.println("END:D");  // bare END:D so UI session_events counter fires
-      Serial.printf("[TRANSFER] duration=%lums lines=%u bytes=%u rate=%.1f B/s\n",
-                    elapsedMs,
-                    (unsigned int)dataTransferLines,
-                    (unsigned int)dataTransferBytes,
-                    bytesPerSec);
-      dataTransferActive = false;
+  if (strncmp(packet, "END:", 4) == 0) {
+    if (strcmp(packet, "END:D") == 0 && dataTransferActive) {
+      finishLoRaTransfer();
     } else {
-      Serial.printf("[%s]\n", packet.c_str());
+      hostSerial.printf("[%s]\n", packet);
     }
     return;
   }
 
-  if (packet.startsWith("RSP:WIFI_SERVER:")) {
+  if (strncmp(packet, "RSP:WIFI_SERVER:", 16) == 0) {
     handleWifiServerMessage(packet);
     return;
   }
 
-  if (packet.startsWith("RSP:ID:")) {
-    String truckId = packet.substring(7);
-    truckId.trim();
-    Serial.printf("[SCAN_RESULT]:%s\n", truckId.c_str());
+  if (strncmp(packet, "RSP:ID:", 7) == 0) {
+    const char* truckId = packet + 7;
+    while (*truckId == ' ') {
+      truckId++;
+    }
+    hostSerial.printf("[SCAN_RESULT]:%s\n", truckId);
     return;
   }
 
-  if (packet.startsWith("RSP:")) {
-    Serial.printf("[%s]\n", packet.c_str());
+  if (strcmp(packet, "RSP:WIFI_FALLBACK_LORA") == 0 || strcmp(packet, "RSP:WIFI_NONE_CONFIGURED") == 0) {
+    fleetSweep.onPathFallback("rx_wifi");
+  }
+
+  if (strncmp(packet, "RSP:", 4) == 0) {
+    hostSerial.printf("[%s]\n", packet);
     return;
   }
 
-  Serial.printf("[RX] %s\n", packet.c_str());
+  hostSerial.printf("[RX] %s\n", packet);
 }
 
 void processLoRaPackets() {
@@ -372,29 +643,169 @@ void processLoRaPackets() {
   }
 
   loraPacketReceived = false;
+  loraPacketProbe.begin();
 
-  String packet;
-  int rxState = loraRadio.readData(packet);
+  // Fixed receive buffer instead of readData(String&); one spare byte for the terminator
+  PoolBlock block(g_packetPool);
+  if (!block) {
+    hostSerial.println("[RX] Packet pool exhausted, packet dropped");
+    restartLoRaReceive();
+    loraPacketProbe.end();
+    return;
+  }
+  char* packet = block.chars();
+  size_t len = loraRadio.getPacketLength();
+  if (len > LORA_MAX_PACKET_SIZE) {
+    len = LORA_MAX_PACKET_SIZE;
+  }
+  int rxState = loraRadio.readData((uint8_t*)packet, len);
   if (rxState == RADIOLIB_ERR_NONE) {
-    packet.trim();
-    if (packet.length() > 0) {
-      handleLoRaMessage(packet);
+    size_t start = 0;
+    while (start < len && isspace((unsigned char)packet[start])) {
+      start++;
+    }
+    while (len > start && isspace((unsigned char)packet[len - 1])) {
+      len--;
+    }
+    packet[len] = '\0';
+    const char* text = packet + start;
+    len -= start;
+    g_metLoraRxPackets.add();
+    if (len > 0 && !fleetSweep.onLoRaPacket(text, loraRadio.getRSSI(), loraRadio.getSNR())) {
+      handleLoRaMessage(text, len);
     }
   } else {
-    Serial.printf("LoRa RX read failed (%d)\n", rxState);
+    g_metLoraRxFail.add();
+    hostSerial.printf("LoRa RX read failed (%d)\n", rxState);
   }
 
   restartLoRaReceive();
+  loraPacketProbe.end();
+}
+
+/**
+ * ALLOCSTAT: heap allocation counters for the loop task
+ */
+bool handleAllocCommand(const String& line) {
+  if (line != "ALLOCSTAT") {
+    return false;
+  }
+  if (!allocCounterActive()) {
+    hostSerial.println("[ALLOC] disabled (build without ALLOC_COUNTER_HOOKS)");
+    return true;
+  }
+  AllocCounts total = allocCounterTotal();
+  AllocCounts watched = allocCounterWatched();
+  char report[96];
+  loraPacketProbe.format(report, sizeof(report));
+  hostSerial.printf("[ALLOC] all_tasks=%lu loop_task=%lu free_heap=%lu largest_block=%lu\n",
+                    (unsigned long)total.allocs, (unsigned long)watched.allocs,
+                    (unsigned long)ESP.getFreeHeap(), (unsigned long)ESP.getMaxAllocHeap());
+  hostSerial.printf("[ALLOC] %s\n", report);
+  return true;
+}
+
+// Tasks whose stack high-water MEMSTAT reports (absent ones print "not running")
+const char* const kStatusTasks[] = {"loopTask", "tiT", "wifi", "esp_timer", "sys_evt"};
+
+/**
+ * METRICS: every counter and histogram, one [METRICS] line each
+ * (the receiver's own snapshot comes back as RSP:MET: after sending p)
+ */
+bool handleMetricsCommand(const String& line) {
+  if (line != "METRICS") {
+    return false;
+  }
+  char report[128];
+  for (const Metric* m = Metric::first(); m != nullptr; m = m->next()) {
+    metricsFormat(*m, report, sizeof(report));
+    hostSerial.printf("[METRICS] %s\n", report);
+  }
+  return true;
+}
+
+/**
+ * MEMSTAT: heap, fragmentation, stack high-water and pool use
+ */
+bool handleMemCommand(const String& line) {
+  if (line != "MEMSTAT") {
+    return false;
+  }
+  hostSerial.println("[MEM]");
+  memStatusPrint(hostSerial, kStatusTasks, sizeof(kStatusTasks) / sizeof(kStatusTasks[0]));
+  return true;
 }
 
+/**
+ * Transmitter-local parameters: TXGET:<name> | TXSET:<name>=<value> | TXLIST
+ * (GET:/SET:/LIST: without the TX prefix are forwarded to the receiver)
+ */
+bool handleLocalParamCommand(const String& line) {
+  char reply[128];
+  const char* text = line.c_str();
+
+  if (line.startsWith("TXGET:")) {
+    const ParamDef* def = params.find(text + 6, strlen(text + 6));
+    if (def == nullptr) {
+      hostSerial.printf("[TX_PARAM_ERR] %s:%s\n", text + 6, ParamRegistry::resultText(PARAM_UNKNOWN));
+    } else {
+      ParamRegistry::format(*def, reply, sizeof(reply));
+      hostSerial.printf("[TX_PARAM] %s\n", reply);
+    }
+    return true;
+  }
+
+  if (line.startsWith("TXSET:")) {
+    const char* name = text + 6;
+    const char* eq = strchr(name, '=');
+    const ParamDef* def = nullptr;
+    ParamResult result = (eq == nullptr)
+                           ? PARAM_BAD_VALUE
+                           : params.set(name, (size_t)(eq - name), eq + 1, strlen(eq + 1), &def);
+    if (result != PARAM_OK) {
+      hostSerial.printf("[TX_PARAM_ERR] %s:%s\n", name, ParamRegistry::resultText(result));
+      return true;
+    }
+    saveConfigToNvs();
+    ParamRegistry::format(*def, reply, sizeof(reply));
+    hostSerial.printf("[TX_PARAM] %s\n", reply);
+    return true;
+  }
+
+  if (line == "TXLIST") {
+    for (size_t i = 0; i < params.count(); i++) {
+      ParamRegistry::describe(params.at(i), reply, sizeof(reply));
+      hostSerial.printf("[TX_PARAM] %s\n", reply);
+    }
+    return true;
+  }
+
+  return false;
+}
+
+// Host lines are assembled a byte at a time so a partial line never stalls loop()
+LineAssembler<SERIAL_LINE_MAX> serialLine(nullptr, SERIAL_LINE_IDLE_MS);
+
 void processSerialInput() {
-  if (Serial.available() <= 0) {
+  if (!serialLine.poll(Serial, millis())) {
+    return;
+  }
+
+  String line(serialLine.line());
+
+  if (storeForward.handleHostCommand(line)) {
     return;
   }
 
-  String line = Serial.readStringUntil('\n');
-  line.trim();
-  if (line.length() == 0) {
+  if (fleetSweep.handleHostCommand(line)) {
+    return;
+  }
+
+  if (handleLocalParamCommand(line)) {
+    return;
+  }
+
+  if (handleAllocCommand(line) || handleMemCommand(line) || handleMetricsCommand(line)) {
     return;
   }
 
@@ -405,7 +816,7 @@ void processSerialInput() {
 
   if (line.startsWith("SETUP:")) {
     parseAndStoreWifiProfiles(line);  // cache Wi-Fi profiles for TCP client step
-    sendLoRaPacket(line);
+    sendLoRaPacket(line.c_str());
     return;
   }
 
@@ -415,37 +826,52 @@ void processSerialInput() {
   }
 
   // Fallback: transmit arbitrary packet payload as-is.
-  sendLoRaPacket(line);
+  sendLoRaPacket(line.c_str());
 }
 
 void setup() {
   Serial.begin(SERIAL_BAUD_RATE);
   delay(1000);
-  Serial.println("\n=== Heltec LoRa Transmitter Bridge ===");
-  Serial.println("Type a command character and press Enter.");
-  Serial.println("Example: d  (request receiver event data)");
+  hostSerial.println("\n=== Heltec LoRa Transmitter Bridge ===");
+  hostSerial.println("Type a command character and press Enter.");
+  hostSerial.println("Example: d  (request receiver event data)");
+  hostSerial.println("SWEEP: offload every discovered receiver (SWEEP:AGE, SWEEP:STOP, SWEEP:STAT)");
+  hostSerial.println("GET:/SET:/LIST: tune the receiver; TXGET:/TXSET:/TXLIST tune this radio");
+  hostSerial.println("ALLOCSTAT: heap allocations per received packet");
+  hostSerial.println("MEMSTAT: heap, stack high-water and buffer pool use");
+  hostSerial.println("METRICS: LoRa airtime and offload throughput histograms (p: the receiver's)");
+
+  // Allocation probes count the loop task only (Wi-Fi/LwIP tasks allocate on their own)
+  allocCounterWatchCurrentTask();
   
-  // Load saved Wi-Fi profiles from EEPROM
-  loadWiFiProfilesFromEEPROM();
+  // Load Wi-Fi profiles and radio parameters (NVS, migrating from EEPROM on first boot)
+  loadConfigFromNvs();
+
+  // Mount the flash queue; anything left from a previous session drains once the host acks
+  storeForward.begin();
+
+  fleetSweep.begin(sendLoRaPacket, sweepStartOffload, sweepReleaseLink, hostSerial);
 
   int loraState = loraRadio.begin(LORA_FREQUENCY_MHZ,
-                                  LORA_BANDWIDTH_KHZ,
-                                  LORA_SPREADING_FACTOR,
-                                  LORA_CODING_RATE,
+                                  g_loraBandwidthKhz,
+                                  g_loraSpreadingFactor,
+                                  g_loraCodingRate,
                                   LORA_SYNC_WORD,
-                                  LORA_TX_POWER_DBM,
+                                  g_loraTxPowerDbm,
                                   LORA_PREAMBLE_LEN);
 
   if (loraState == RADIOLIB_ERR_NONE) {
     loraRadio.setDio1Action(setLoRaFlag);
     restartLoRaReceive();
-    Serial.println("LoRa: OK");
+    hostSerial.println("LoRa: OK");
   } else {
-    Serial.printf("LoRa: FAILED (%d)\n", loraState);
+    hostSerial.printf("LoRa: FAILED (%d)\n", loraState);
   }
 }
 
 void loop() {
   processSerialInput();
   processLoRaPackets();
+  storeForward.poll();
+  fleetSweep.poll();
 }
\ No newline at end of file
@@ -67,6 +67,9 @@ class SerialService:
         self.send_text(command)
 
     def _read_loop(self) -> None:
+        # Raw bytes seen inside the store-and-forward segment on the wire (None outside one);
+        # reported on its end marker as received=<n> so the UI can check them against bytes=
+        segment_bytes: Optional[int] = None
         while not self._stop_event.is_set():
             if self._serial is None or not self._serial.is_open:
                 break
@@ -76,6 +79,15 @@ class SerialService:
                 continue
 
             message = raw.decode("utf-8", errors="replace").rstrip("\r\n")
+            if raw.startswith(b"[SF_SEG_BEGIN]"):
+                segment_bytes = 0
+            elif raw.startswith(b"[SF_SEG_END]"):
+                if segment_bytes is not None:
+                    message += f" received={segment_bytes}"
+                segment_bytes = None
+            elif segment_bytes is not None:
+                segment_bytes += len(raw)
+
             if message:
                 self.messages.put(message)
 
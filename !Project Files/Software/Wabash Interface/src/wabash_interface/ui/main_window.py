@@ -168,6 +168,8 @@ class MainWindow:
         self.text_scale_var  = tk.DoubleVar(value=1.0)
         self.search_placeholder_active = False
         self._scan_results: list[str] = []
+        self._store_forward_segment: tuple[int, int] | None = None  # (seq, bytes) announced by [SF_SEG_BEGIN]
+        self._store_forward_lines: list[str] | None = None  # Held until [SF_SEG_END]; None outside a segment
 
         # Unit Setup configuration variables
         self.sensor_interval_var = tk.StringVar(value="100")
@@ -188,6 +190,9 @@ class MainWindow:
         # Wi-Fi credential slot (sent to receiver for Wi-Fi-first offload)
         self.wifi1_ssid_var = tk.StringVar(value="")
         self.wifi1_password_var = tk.StringVar(value="")
+        # Fleet-sweep SoftAP, set per deployment on the transmitter and every receiver
+        self.softap_ssid_var = tk.StringVar(value="")
+        self.softap_password_var = tk.StringVar(value="")
 
         self.send_config_button: ctk.CTkButton | None = None
         self.unit_setup_help_label: ctk.CTkLabel | None = None
@@ -2381,6 +2386,9 @@ class MainWindow:
             self.serial_service.connect(SerialConfig(port=port, baudrate=baud))
             connection_role = detected_role if detected_role in {"transmitter", "unknown"} else "unknown"
             self._set_connected_state(True, port, role=connection_role)
+            # Pull anything the transmitter spooled to flash while no host was attached
+            if connection_role == "transmitter":
+                self._request_store_forward_drain()
             return True
         except Exception as exc:
             self._set_connected_state(False, "-", role="disconnected")
@@ -2396,6 +2404,10 @@ class MainWindow:
         self.connected = is_connected
         self.connected_role = role if is_connected else "disconnected"
         self.connected_port = port_text if is_connected else "-"
+        if not is_connected:
+            # A segment cut off by the disconnect is never acked; the transmitter resends it
+            self._store_forward_segment = None
+            self._store_forward_lines = None
 
         connect_fg = BTN_GREY if is_connected else WABASH_BLUE
         connect_hover = BTN_GREY_HOVER if is_connected else WABASH_BLUE_HOVER
@@ -2428,6 +2440,46 @@ class MainWindow:
         self._update_send_config_button()
         self._update_active_unit_display()
 
+    def _request_store_forward_drain(self) -> None:
+        try:
+            self.serial_service.send_text("SFDRAIN\n")
+        except Exception:
+            pass
+
+    @staticmethod
+    def _store_forward_field(line: str, name: str) -> int | None:
+        try:
+            return int(line.split(f"{name}=")[1].split()[0])
+        except (IndexError, ValueError):
+            return None
+
+    def _begin_store_forward_segment(self, line: str) -> None:
+        # Format: [SF_SEG_BEGIN] seq=<n> bytes=<size>
+        seq = self._store_forward_field(line, "seq")
+        size = self._store_forward_field(line, "bytes")
+        self._store_forward_segment = (seq, size) if seq is not None and size is not None else None
+        self._store_forward_lines = []
+
+    def _ack_store_forward_segment(self, line: str) -> list[str]:
+        # Format: [SF_SEG_END] seq=<n> received=<n> (received= added by SerialService)
+        # The transmitter deletes an acknowledged segment, so only ack one that arrived whole.
+        # Returns the segment's held lines when it is acked; a NAKed copy is dropped and resent.
+        seq = self._store_forward_field(line, "seq")
+        received = self._store_forward_field(line, "received")
+        announced = self._store_forward_segment
+        held = self._store_forward_lines or []
+        self._store_forward_segment = None
+        self._store_forward_lines = None
+        if seq is None:
+            return []
+        whole = announced == (seq, received)
+        if self.serial_service.is_connected:
+            try:
+                self.serial_service.send_text(f"{'SFACK' if whole else 'SFNAK'}:{seq}\n")
+            except Exception:
+                pass
+        return held if whole else []
+
     def _send_quick(self, command: str) -> None:
         self._send_payload(command)
 
@@ -2507,12 +2559,17 @@ class MainWindow:
                 truck_id = line[14:].strip()
                 if truck_id and truck_id not in self._scan_results:
                     self._scan_results.append(truck_id)
-            # Track offload progress
-            self._process_offload_message(line)
-
-        # Each END:D marks a completed data offload from the receiver
-        if line.startswith("END:D"):
-            self.session_events += 1
+            # Acknowledge drained store-and-forward segments so the transmitter frees flash;
+            # a segment's lines are acted on only once it is known to have arrived whole
+            if line.startswith("[SF_SEG_BEGIN]"):
+                self._begin_store_forward_segment(line)
+            elif line.startswith("[SF_SEG_END]"):
+                for held in self._ack_store_forward_segment(line):
+                    self._process_received_line(held)
+            elif self._store_forward_lines is not None:
+                self._store_forward_lines.append(line)
+            else:
+                self._process_received_line(line)
 
         if not defer_ui:
             self._refresh_log_widgets()
@@ -2659,6 +2716,13 @@ class MainWindow:
         # Last message
         self.offload_message_label.configure(text=f"Last: {self.offload_last_status}")
 
+    def _process_received_line(self, line: str) -> None:
+        # Track offload progress
+        self._process_offload_message(line)
+        # Each END:D marks a completed data offload from the receiver
+        if line.startswith("END:D"):
+            self.session_events += 1
+
     def _process_offload_message(self, line: str) -> None:
         """Parse offload-related messages and update tracking stats."""
         # Offload start markers
@@ -3197,14 +3261,33 @@ class MainWindow:
         ).grid(row=1, column=1, sticky="ew", padx=(6, 16), pady=6)
 
         ctk.CTkLabel(wifi_card, text="Password", text_color=("#475569", "#94A3B8")).grid(
-            row=2, column=0, sticky="w", padx=16, pady=(6, 14)
+            row=2, column=0, sticky="w", padx=16, pady=6
         )
         ctk.CTkEntry(
             wifi_card,
             textvariable=self.wifi1_password_var,
             placeholder_text="Wi-Fi Password",
             show="*",
-        ).grid(row=2, column=1, sticky="ew", padx=(6, 16), pady=(6, 14))
+        ).grid(row=2, column=1, sticky="ew", padx=(6, 16), pady=6)
+
+        ctk.CTkLabel(wifi_card, text="Sweep SoftAP SSID", text_color=("#475569", "#94A3B8")).grid(
+            row=3, column=0, sticky="w", padx=16, pady=6
+        )
+        ctk.CTkEntry(
+            wifi_card,
+            textvariable=self.softap_ssid_var,
+            placeholder_text="Leave blank to keep the current SoftAP",
+        ).grid(row=3, column=1, sticky="ew", padx=(6, 16), pady=6)
+
+        ctk.CTkLabel(wifi_card, text="Sweep SoftAP Password", text_color=("#475569", "#94A3B8")).grid(
+            row=4, column=0, sticky="w", padx=16, pady=(6, 14)
+        )
+        ctk.CTkEntry(
+            wifi_card,
+            textvariable=self.softap_password_var,
+            placeholder_text="8-63 characters",
+            show="*",
+        ).grid(row=4, column=1, sticky="ew", padx=(6, 16), pady=(6, 14))
 
         desc_card = ctk.CTkFrame(page, corner_radius=14, fg_color=(CARD_LIGHT, CARD_DARK))
         desc_card.grid(row=5, column=0, sticky="ew", pady=(0, 12))
@@ -3213,7 +3296,7 @@ class MainWindow:
         self.unit_setup_desc_card = desc_card
         self.unit_setup_help_label = ctk.CTkLabel(
             desc_card,
-            text="Select the fields to include above. Unselected values are left unchanged on the receiver. Selecting Wi-Fi with blank SSID/password clears the stored Wi-Fi network. To send a configuration, at least one field must be selected and you must be connected to a transmitter.",
+            text="Select the fields to include above. Unselected values are left unchanged on the receiver. Selecting Wi-Fi with blank SSID/password clears the stored Wi-Fi network; a blank Sweep SoftAP keeps the current one. To send a configuration, at least one field must be selected and you must be connected to a transmitter.",
             wraplength=800,
             justify="left",
             text_color=("#334155", "#CBD5E1"),
@@ -3602,6 +3685,18 @@ class MainWindow:
                 "w2p=",
             ]
 
+            # Sweep SoftAP: sent to the transmitter and the receiver in the same SETUP
+            softap_ssid = self.softap_ssid_var.get().replace(";", " ").replace("=", " ").replace("\n", " ").replace("\r", " ").strip()
+            softap_password = self.softap_password_var.get().replace(";", " ").replace("=", " ").replace("\n", " ").replace("\r", " ").strip()
+            if self.apply_wifi_var.get() and (softap_ssid or softap_password):
+                if not softap_ssid or len(softap_ssid) > 32 or not 8 <= len(softap_password) <= 63:
+                    messagebox.showwarning(
+                        "Wi-Fi Setup Error",
+                        "Sweep SoftAP needs an SSID of 1-32 characters and a password of 8-63 characters.",
+                    )
+                    return
+                wifi_fields += [f"aps={softap_ssid}", f"app={softap_password}"]
+
             packet = (
                 f"SETUP:m={setup_mask};si={interval};thr={threshold};sr={sample_rate};dur={duration};"
                 f"tid={truck_id};desc={description};"